@@ -29,10 +29,13 @@
 #include "nitf/BandSource.h"
 #include "nitf/RowSource.h"
 #include "nitf/DirectBlockSource.h"
+#include "nitf/Overview.h"
 #include "nitf/DataSource.hpp"
 #include "nitf/IOHandle.hpp"
 #include "nitf/System.hpp"
 #include "nitf/ImageReader.hpp"
+#include "nitf/ImageSubheader.hpp"
+#include "nitf/DownSampler.hpp"
 
 /*!
  *  \file BandSource.hpp
@@ -102,6 +105,30 @@ public:
                int pixelSkip) throw (nitf::NITFException);
 };
 
+/*!
+ *  \class OverviewSource
+ *  \brief  The C++ wrapper for the nitf_OverviewSource
+ *
+ *  The OverviewSource class is a BandSource that reduces the band data of
+ *  a base image for an overview segment (see Record::newOverviewSegment).
+ *  The base source is owned by the new source, the down-sampler must
+ *  remain valid until the overview has been written.
+ */
+class OverviewSource : public BandSource
+{
+public:
+    /*!
+     *  Constructor
+     *  \param baseSource  The source of the base band
+     *  \param baseSubheader  The subheader of the base image
+     *  \param downSampler  The reduction method
+     */
+    OverviewSource(BandSource& baseSource,
+                   nitf::ImageSubheader& baseSubheader,
+                   nitf::DownSampler& downSampler)
+        throw (nitf::NITFException);
+};
+
 struct RowSourceCallback
 {
     virtual ~RowSourceCallback()
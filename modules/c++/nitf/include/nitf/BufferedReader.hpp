@@ -23,8 +23,16 @@
 #ifndef __NITF_BUFFERED_READER_HPP__
 #define __NITF_BUFFERED_READER_HPP__
 
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
 #include <sys/File.h>
+#include <sys/Mutex.h>
+#include <sys/ConditionVar.h>
+#include <sys/Thread.h>
 #include <mem/ScopedArray.h>
+#include <mt/CriticalSection.h>
 #include <nitf/CustomIO.hpp>
 
 namespace nitf
@@ -48,6 +56,24 @@ public:
      */
     BufferedReader(const std::string& pathname, size_t bufferSize);
 
+    /*
+     *  \func Constructor
+     *  \brief Sets up a BufferedReader that reads ahead.
+     *
+     *  With more than one buffer, a background thread reads the chunks
+     *  following the current one into the other buffers, so reading
+     *  overlaps with whatever the caller does with the data.  A seek
+     *  into a chunk that has already been read is satisfied from memory,
+     *  any other seek restarts the read-ahead at the new offset.
+     *
+     *  \param pathname The input pathname to read from.
+     *  \param bufferSize The size of each chunk that should be read.
+     *  \param numBuffers The number of chunks held in memory.
+     */
+    BufferedReader(const std::string& pathname,
+                   size_t bufferSize,
+                   size_t numBuffers);
+
     /*
      *  \func Constructor
      *  \brief Same as above but allows you to pass in a buffer.
@@ -66,25 +92,51 @@ public:
 
     size_t getTotalRead() const
     {
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
         return mTotalRead;
     }
 
     size_t getNumBlocksRead() const
     {
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
         return mBlocksRead;
     }
 
     size_t getNumPartialBlocksRead() const
     {
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
         return mPartialBlocks;
     }
 
     //! Time spent reading
     double getTotalWriteTime()
     {
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
         return mElapsedTime;
     }
 
+    //! Number of chunks that were already in memory when needed
+    size_t getNumPrefetchHits() const
+    {
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+        return mPrefetchHits;
+    }
+
+    //! Number of chunks the caller had to wait for
+    size_t getNumPrefetchMisses() const
+    {
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+        return mPrefetchMisses;
+    }
+
+    //! Fraction of the chunks that were already in memory when needed
+    double getPrefetchHitRate() const
+    {
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+        const size_t total = mPrefetchHits + mPrefetchMisses;
+        return total ? static_cast<double>(mPrefetchHits) / total : 0.;
+    }
+
 protected:
 
     virtual void readImpl(void* buf, size_t size);
@@ -104,17 +156,74 @@ protected:
     virtual void closeImpl();
 
 private:
+    //! Runs the background reads
+    class ReadThread : public sys::Runnable
+    {
+    public:
+        ReadThread(BufferedReader* reader) :
+            mReader(reader)
+        {
+        }
+
+        virtual void run()
+        {
+            mReader->readBuffers();
+        }
+
+    private:
+        BufferedReader* const mReader;
+    };
+
+    //! A chunk that has been read ahead
+    struct Chunk
+    {
+        Chunk(char* buffer, nitf::Off offset, size_t size) :
+            buffer(buffer),
+            offset(offset),
+            size(size)
+        {
+        }
+
+        char* buffer;
+        nitf::Off offset;
+        size_t size;
+    };
+
     void readNextBuffer();
 
+    void takeBuffer(nitf::Off offset);
+
+    void stopThread();
+
+    void readBuffers();
+
     const size_t mBufferSize;
     const mem::ScopedArray<char> mScopedBuffer;
-    char* const mBuffer;
+    char* mBuffer;
 
+    nitf::Off mBufferOffset;
+    size_t mBufferLength;
     size_t mPosition;
     size_t mTotalRead;
     size_t mBlocksRead;
     size_t mPartialBlocks;
     double mElapsedTime;
+    size_t mPrefetchHits;
+    size_t mPrefetchMisses;
+
+    // Background reads, guarded by mMutex
+    mutable sys::Mutex mMutex;
+    sys::ConditionVar mCondition;
+    std::deque<Chunk> mReady;
+    std::vector<char*> mFree;
+    nitf::Off mReadOffset;
+    nitf::Off mInFlight;
+    nitf::Off mLength;
+    size_t mGeneration;
+    bool mStop;
+    std::string mError;
+    std::auto_ptr<sys::Thread> mThread;
+
     mutable sys::File mFile;
 };
 
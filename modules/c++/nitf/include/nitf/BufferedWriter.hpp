@@ -23,8 +23,16 @@
 #ifndef __NITF_BUFFERED_WRITER_HPP__
 #define __NITF_BUFFERED_WRITER_HPP__
 
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
 #include <sys/File.h>
+#include <sys/Mutex.h>
+#include <sys/ConditionVar.h>
+#include <sys/Thread.h>
 #include <mem/ScopedArray.h>
+#include <mt/CriticalSection.h>
 #include <nitf/CustomIO.hpp>
 
 namespace nitf
@@ -34,6 +42,17 @@ class BufferedWriter : public CustomIO
 public:
     BufferedWriter(const std::string& file, size_t bufferSize);
 
+    /*!
+     *  Write through numBuffers buffers of bufferSize bytes each.  With
+     *  more than one buffer, full buffers are written to disk by a
+     *  background thread while the caller fills the next one, so the
+     *  caller only waits when every buffer is waiting to be written.
+     *  A single buffer behaves as the constructor above.
+     */
+    BufferedWriter(const std::string& file,
+                   size_t bufferSize,
+                   size_t numBuffers);
+
     BufferedWriter(const std::string& file,
                    char* buffer,
                    size_t size,
@@ -41,29 +60,44 @@ public:
 
     virtual ~BufferedWriter();
 
+    //! Write out the buffered data, waiting until it is written
     void flushBuffer();
 
     nitf::Uint64 getTotalWritten() const
     {
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
         return mTotalWritten;
     }
 
     nitf::Uint64 getNumBlocksWritten() const
     {
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
         return mBlocksWritten;
     }
 
     nitf::Uint64 getNumPartialBlocksWritten() const
     {
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
         return mPartialBlocks;
     }
 
     //! Time spent writing to disk in seconds
     double getTotalWriteTime()
     {
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
         return mElapsedTime;
     }
 
+    /*!
+     *  Time in seconds the caller spent waiting for data to be written.
+     *  Without a background thread this is the same as the write time.
+     */
+    double getTotalStallTime()
+    {
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+        return mStallTime;
+    }
+
 protected:
 
     virtual void readImpl(void* buf, size_t size);
@@ -83,21 +117,74 @@ protected:
     virtual void closeImpl();
 
 private:
+    //! Runs the background writes
+    class WriteThread : public sys::Runnable
+    {
+    public:
+        WriteThread(BufferedWriter* writer) :
+            mWriter(writer)
+        {
+        }
+
+        virtual void run()
+        {
+            mWriter->writeBuffers();
+        }
+
+    private:
+        BufferedWriter* const mWriter;
+    };
+
+    //! A full buffer waiting to be written
+    struct Pending
+    {
+        Pending(char* buffer, size_t size) :
+            buffer(buffer),
+            size(size)
+        {
+        }
+
+        char* buffer;
+        size_t size;
+    };
+
     const size_t mBufferSize;
     const mem::ScopedArray<char> mScopedBuffer;
-    char* const mBuffer;
+    char* mBuffer;
 
     nitf::Uint64 mPosition;
+    nitf::Uint64 mOffset;
     nitf::Uint64 mTotalWritten;
     nitf::Uint64 mBlocksWritten;
     nitf::Uint64 mPartialBlocks;
     double mElapsedTime;
+    mutable double mStallTime;
+
+    // Background writes, guarded by mMutex
+    mutable sys::Mutex mMutex;
+    mutable sys::ConditionVar mCondition;
+    std::deque<Pending> mPending;
+    std::vector<char*> mFree;
+    bool mWriting;
+    bool mStop;
+    std::string mError;
+    std::auto_ptr<sys::Thread> mThread;
 
     // NOTE: This is at the end to give us a chance to adopt the buffer
     //       in ScopedArray in case sys::File's constructor throws
     mutable sys::File mFile;
 
     void flushBuffer(const char* buf);
+
+    void queueBuffer();
+
+    void waitForWrites() const;
+
+    void stopThread();
+
+    double writeBuffer(const char* buf, size_t size);
+
+    void writeBuffers();
 };
 
 }
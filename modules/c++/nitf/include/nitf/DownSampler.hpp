@@ -227,5 +227,51 @@ public:
     //! Destructor
     ~Select2DownSample();
 };
+
+/*!
+ *  \class BoxDownSample
+ *  \brief Averages the pixels of each window.
+ *  The row and column skip factors divide the sub-window
+ *  into non-overlapping sample windows.  The mean of the
+ *  pixels in each sample window, rounded for integer pixel
+ *  types, is the down sampled value for that window.
+ */
+class BoxDownSample : public DownSampler
+{
+public:
+    /*!
+     *  Constructor
+     *  \param rowSkip  The number of rows to skip
+     *  \param colSkip  The number of cols to skip
+     */
+    BoxDownSample(nitf::Uint32 rowSkip,
+                  nitf::Uint32 colSkip) throw (nitf::NITFException);
+    //! Destructor
+    ~BoxDownSample();
+};
+
+/*!
+ *  \class GaussianDownSample
+ *  \brief Takes a Gaussian weighted average of the pixels of
+ *  each window.
+ *  The weights are separable and centered on the sample
+ *  window, and the kernel does not extend past the window.
+ */
+class GaussianDownSample : public DownSampler
+{
+public:
+    /*!
+     *  Constructor
+     *  \param rowSkip  The number of rows to skip
+     *  \param colSkip  The number of cols to skip
+     *  \param sigma  The standard deviation of the kernel in full
+     *  resolution pixels, or zero for half the window size
+     */
+    GaussianDownSample(nitf::Uint32 rowSkip,
+                       nitf::Uint32 colSkip,
+                       double sigma = 0) throw (nitf::NITFException);
+    //! Destructor
+    ~GaussianDownSample();
+};
 }
 #endif
@@ -46,30 +46,28 @@ public:
     virtual ~Handle() {}
 
     //! Get the ref count
-    int getRef() { return refCount; }
+    int getRef() { return refCount.get(); }
 
     //! Increment the ref count
     int incRef()
     {
-        mutex.lock();
-        refCount++;
-        mutex.unlock();
-        return refCount;
+        return refCount.incrementThenGet();
     }
 
-    //! Decrement the ref count
+    //! Decrement the ref count (it does not go below zero)
     int decRef()
     {
-        mutex.lock();
-        if (refCount > 0)
-            refCount--;
-        mutex.unlock();
-        return refCount;
+        int count = refCount.decrementThenGet();
+        if (count < 0)
+        {
+            refCount.increment();
+            count = 0;
+        }
+        return count;
     }
 
 protected:
-    static sys::Mutex mutex;
-    int refCount;
+    sys::AtomicCounter refCount;
 };
 
 
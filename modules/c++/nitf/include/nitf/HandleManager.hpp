@@ -31,13 +31,37 @@
 
 namespace nitf
 {
+/*!
+ *  \class HandleManager
+ *  \brief Maps native objects to the handles that share them
+ *
+ *  The map is split into shards by the address of the native object, each
+ *  with its own lock, so that threads working on unrelated objects seldom
+ *  wait for each other.
+ */
 class HandleManager
 {
 private:
 typedef void* CAddress;
+typedef std::map<CAddress, Handle*> HandleMap;
 
-    std::map<CAddress, Handle*> mHandleMap; //! map for storing the handles
-    sys::Mutex mMutex; //! mutex used for locking the map
+    enum { NUM_SHARDS = 64 };
+
+    struct Shard
+    {
+        HandleMap handles; //! map for storing the handles
+        sys::Mutex mutex; //! mutex used for locking the map
+        char padding[64]; //! keeps neighboring shards off the same cache line
+    };
+
+    Shard mShards[NUM_SHARDS];
+
+    Shard& getShard(CAddress object)
+    {
+        // Allocations are aligned, so the low bits say little
+        const size_t address = reinterpret_cast<size_t>(object);
+        return mShards[((address >> 4) ^ (address >> 12)) % NUM_SHARDS];
+    }
 
 public:
     HandleManager() {}
@@ -47,25 +71,29 @@ public:
     bool hasHandle(T* object)
     {
         if (!object) return false;
-        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
-        return mHandleMap.find(object) != mHandleMap.end();
+        Shard& shard = getShard(object);
+        mt::CriticalSection<sys::Mutex> obtainLock(&shard.mutex);
+        return shard.handles.find(object) != shard.handles.end();
     }
 
     template <typename T, typename DestructFunctor_T>
     BoundHandle<T, DestructFunctor_T>* acquireHandle(T* object)
     {
         if (!object) return NULL;
-        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
-        if (mHandleMap.find(object) == mHandleMap.end())
+        Shard& shard = getShard(object);
+        mt::CriticalSection<sys::Mutex> obtainLock(&shard.mutex);
+        HandleMap::iterator it = shard.handles.find(object);
+        if (it == shard.handles.end())
         {
             BoundHandle<T, DestructFunctor_T>* handle =
                 new BoundHandle<T, DestructFunctor_T>(object);
-            mHandleMap[object] = handle;
+            it = shard.handles.insert(
+                HandleMap::value_type(object, handle)).first;
         }
         BoundHandle<T, DestructFunctor_T>* handle =
-            (BoundHandle<T, DestructFunctor_T>*)mHandleMap[object];
-        obtainLock.manualUnlock();
+            (BoundHandle<T, DestructFunctor_T>*)it->second;
 
+        // take the reference before a release can drop the handle
         handle->incRef();
         return handle;
     }
@@ -73,14 +101,15 @@ public:
     template <typename T>
     void releaseHandle(T* object)
     {
-        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
-        std::map<CAddress, Handle*>::iterator it = mHandleMap.find(object);
-        if (it != mHandleMap.end())
+        Shard& shard = getShard(object);
+        mt::CriticalSection<sys::Mutex> obtainLock(&shard.mutex);
+        HandleMap::iterator it = shard.handles.find(object);
+        if (it != shard.handles.end())
         {
             Handle* handle = (Handle*)it->second;
             if (handle->decRef() <= 0)
             {
-                mHandleMap.erase(it);
+                shard.handles.erase(it);
                 obtainLock.manualUnlock();
                 delete handle;
             }
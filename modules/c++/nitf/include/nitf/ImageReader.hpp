@@ -59,6 +59,7 @@ public:
 
     /*!
      *  Read a sub-window.  See ImageIO::read for more details.
+     *  Several threads may read from one ImageReader at once.
      *  \param  subWindow  The sub-window to read
      *  \param  user  User-defined data buffers for read
      *  \param  padded  Returns TRUE if pad pixels may have been read
@@ -67,7 +68,8 @@ public:
         throw (nitf::NITFException);
 
     /*!
-     *  Read a block directly from file
+     *  Read a block directly from file.  Uncompressed blocks of a
+     *  MappedIO are not copied, the result points into the mapping.
      *  \param blockNumber
      *  \param blockSize  Returns block size
      *  \return The read block 
@@ -80,6 +82,33 @@ public:
     //!  Set read caching
     void setReadCaching();
 
+    /*!
+     *  Set read caching with a block cache size limit.
+     *  See nitf_ImageReader_setReadCacheSize for more details.
+     *  \param maxSize  Cache size limit in bytes
+     */
+    void setReadCaching(nitf::Uint64 maxSize);
+
+    //!  Get the number of block cache hits
+    nitf::Uint64 getReadCacheHits();
+
+    //!  Get the number of block cache misses
+    nitf::Uint64 getReadCacheMisses();
+
+    /*!
+     *  Set the number of threads used to decompress blocks.
+     *  See nitf_ImageReader_setReadThreads for more details.
+     *  \param numThreads  Number of threads, 0 for one per CPU
+     */
+    void setReadThreads(nitf::Uint32 numThreads);
+
+    /*!
+     *  Enable or disable reduced resolution decompression of down-sampled
+     *  reads. See nitf_ImageReader_setScaledDecode for more details.
+     *  \param enable  Enable if true
+     */
+    void setScaledDecode(bool enable);
+
 private:
     nitf_Error error;
     ImageReader() throw(nitf::NITFException){}
@@ -71,6 +71,18 @@ public:
     //! Enable/disable direct block writes (if you don't know what this means, don't use it)
     void setDirectBlockWrite(int enable);
 
+    /*!
+     *  Set the number of threads used to write the image, 0 for one per
+     *  CPU (see nitf_ImageWriter_setWriteThreads)
+     */
+    void setWriteThreads(nitf::Uint32 numThreads);
+
+    /*!
+     *  Set the length of the compressed image data, for a streaming write
+     *  (see nitf_ImageWriter_setDataLength)
+     */
+    void setDataLength(nitf::Off length);
+
     /*!
      *  Function allows the user access to the product's pad pixels.
      *  For example, if you wanted transparent pixels for fill, you would
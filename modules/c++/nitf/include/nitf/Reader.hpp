@@ -90,6 +90,21 @@ public:
      */
     nitf::Record readIO(nitf::IOInterface & io) throw (nitf::NITFException);
 
+    /*!
+     *  Allocate the fields of the records read from an arena that is
+     *  released with the record.
+     *  See nitf_Reader_setUseArena for more details.
+     *  \param useArena  Whether to use an arena
+     */
+    void setUseArena(bool useArena);
+
+    /*!
+     *  Defer the parsing of each TRE until it is first used.
+     *  See nitf_Reader_setLazyTREs for more details.
+     *  \param lazyTREs  Whether to defer TRE parsing
+     */
+    void setLazyTREs(bool lazyTREs);
+
     /*!
      *  Get a new image reader for the segment
      *  \param imageSegmentNumber  The image segment number
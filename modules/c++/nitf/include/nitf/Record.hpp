@@ -24,6 +24,7 @@
 #define __NITF_RECORD_HPP__
 
 #include "nitf/Record.h"
+#include "nitf/Overview.h"
 #include "nitf/System.hpp"
 #include "nitf/List.hpp"
 #include "nitf/FileHeader.hpp"
@@ -119,6 +120,22 @@ public:
     //! Make and return a new DESegment
     nitf::DESegment newDataExtensionSegment(int index = -1);
 
+    /*!
+     *  Make and return a new overview (reduced resolution) segment of the
+     *  image segment at imageIndex (see nitf_Overview_newSegment)
+     */
+    nitf::ImageSegment newOverviewSegment(nitf::Uint32 imageIndex,
+                                          nitf::Uint32 factor);
+
+    /*!
+     *  Select the segment to read for a down-sample factor of the image
+     *  segment at imageIndex and return its index, the reduction factor of
+     *  the selected segment is returned in overviewFactor (see
+     *  nitf_Overview_select)
+     */
+    nitf::Uint32 selectOverview(nitf::Uint32 imageIndex, nitf::Uint32 factor,
+                                nitf::Uint32& overviewFactor);
+
     //! Remove the image segment at the given index
     void removeImageSegment(nitf::Uint32 index);
 
@@ -75,6 +75,18 @@ public:
     //! Write the record to disk
     void write();
 
+    /*!
+     *  Write the record front to back, for outputs that cannot seek
+     *  (see nitf_Writer_setStreaming)
+     */
+    void setStreaming(bool enable);
+
+    /*!
+     *  Set the number of threads used to write the image segments
+     *  (see nitf_Writer_setWriteThreads)
+     */
+    void setWriteThreads(nitf::Uint32 numThreads);
+
     /*!
      *  Prepare the writer
      *  \param io  The IO handle to use
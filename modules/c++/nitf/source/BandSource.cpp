@@ -54,6 +54,23 @@ nitf::FileSource::FileSource(const std::string& fname,
     setManaged(false);
 }
 
+nitf::OverviewSource::OverviewSource(nitf::BandSource& baseSource,
+                                     nitf::ImageSubheader& baseSubheader,
+                                     nitf::DownSampler& downSampler)
+    throw(nitf::NITFException)
+{
+    nitf_BandSource* x =
+        nitf_OverviewSource_construct(baseSource.getNativeOrThrow(),
+                                      baseSubheader.getNativeOrThrow(),
+                                      downSampler.getNativeOrThrow(),
+                                      &error);
+    if (!x)
+        throw nitf::NITFException(&error);
+    setNative(x);
+    setManaged(false);
+    baseSource.setManaged(true);
+}
+
 nitf::RowSource::RowSource(
     nitf::Uint32 band,
     nitf::Uint32 numRows,
@@ -8,11 +8,21 @@ BufferedReader::BufferedReader(const std::string& file, size_t bufferSize) :
     mBufferSize(bufferSize),
     mScopedBuffer(new char[bufferSize]),
     mBuffer(mScopedBuffer.get()),
+    mBufferOffset(0),
+    mBufferLength(0),
     mPosition(0),
     mTotalRead(0),
     mBlocksRead(0),
     mPartialBlocks(0),
     mElapsedTime(0),
+    mPrefetchHits(0),
+    mPrefetchMisses(0),
+    mCondition(&mMutex),
+    mReadOffset(0),
+    mInFlight(-1),
+    mLength(0),
+    mGeneration(0),
+    mStop(false),
     mFile(file, sys::File::READ_ONLY, sys::File::EXISTING)
 {
     if (mBufferSize == 0)
@@ -25,6 +35,56 @@ BufferedReader::BufferedReader(const std::string& file, size_t bufferSize) :
     readNextBuffer();
 }
 
+BufferedReader::BufferedReader(const std::string& file,
+                               size_t bufferSize,
+                               size_t numBuffers) :
+    mBufferSize(bufferSize),
+    mScopedBuffer(new char[bufferSize * numBuffers]),
+    mBuffer(mScopedBuffer.get()),
+    mBufferOffset(0),
+    mBufferLength(0),
+    mPosition(0),
+    mTotalRead(0),
+    mBlocksRead(0),
+    mPartialBlocks(0),
+    mElapsedTime(0),
+    mPrefetchHits(0),
+    mPrefetchMisses(0),
+    mCondition(&mMutex),
+    mReadOffset(0),
+    mInFlight(-1),
+    mLength(0),
+    mGeneration(0),
+    mStop(false),
+    mFile(file, sys::File::READ_ONLY, sys::File::EXISTING)
+{
+    if (mBufferSize == 0)
+    {
+        throw except::Exception(Ctxt(
+            "BufferedReaders must have a buffer size greater than zero"));
+    }
+    if (numBuffers == 0)
+    {
+        throw except::Exception(Ctxt(
+            "BufferedReaders must have at least one buffer"));
+    }
+
+    if (numBuffers > 1)
+    {
+        for (size_t ii = 0; ii < numBuffers; ++ii)
+        {
+            mFree.push_back(mBuffer + ii * mBufferSize);
+        }
+        mBuffer = NULL;
+        mLength = mFile.length();
+        mThread.reset(new sys::Thread(new ReadThread(this)));
+        mThread->start();
+    }
+
+    //! Start off by reading a block
+    readNextBuffer();
+}
+
 BufferedReader::BufferedReader(const std::string& file,
                                char* buffer,
                                size_t size,
@@ -32,11 +92,21 @@ BufferedReader::BufferedReader(const std::string& file,
     mBufferSize(size),
     mScopedBuffer(adopt ? buffer : NULL),
     mBuffer(buffer),
+    mBufferOffset(0),
+    mBufferLength(0),
     mPosition(0),
     mTotalRead(0),
     mBlocksRead(0),
     mPartialBlocks(0),
     mElapsedTime(0),
+    mPrefetchHits(0),
+    mPrefetchMisses(0),
+    mCondition(&mMutex),
+    mReadOffset(0),
+    mInFlight(-1),
+    mLength(0),
+    mGeneration(0),
+    mStop(false),
     mFile(file, sys::File::READ_ONLY, sys::File::EXISTING)
 {
     if (mBufferSize == 0)
@@ -51,21 +121,38 @@ BufferedReader::BufferedReader(const std::string& file,
 
 BufferedReader::~BufferedReader()
 {
+    // The read thread must be finished before the buffers go away
+    try
+    {
+        stopThread();
+    }
+    catch (...)
+    {
+    }
 }
 
 void BufferedReader::readNextBuffer()
 {
+    if (mThread.get())
+    {
+        takeBuffer(mBufferOffset + static_cast<nitf::Off>(mBufferLength));
+        return;
+    }
+
     const sys::Size_T bufferSize = mFile.getCurrentOffset() +
             static_cast<sys::SSize_T>(mBufferSize) > mFile.length() ?
                     mFile.length() - mFile.getCurrentOffset() :
                     static_cast<sys::SSize_T>(mBufferSize);
 
+    mBufferOffset = mFile.getCurrentOffset();
+
     sys::RealTimeStopWatch sw;
     sw.start();
     mFile.readInto(mBuffer, bufferSize);
     mElapsedTime += (sw.stop() / 1000.0);
 
     mPosition = 0;
+    mBufferLength = bufferSize;
     mTotalRead += bufferSize;
     mBlocksRead += 1;
     if (mBufferSize != static_cast<size_t>(bufferSize))
@@ -74,6 +161,176 @@ void BufferedReader::readNextBuffer()
     }
 }
 
+void BufferedReader::takeBuffer(nitf::Off offset)
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+
+    // The current chunk is no longer needed
+    if (mBuffer)
+    {
+        mFree.push_back(mBuffer);
+        mBuffer = NULL;
+    }
+
+    mBufferOffset = offset;
+    mBufferLength = 0;
+    mPosition = 0;
+    if (offset >= mLength)
+    {
+        mCondition.broadcast();
+        return;
+    }
+
+    bool waited = false;
+    while (true)
+    {
+        // Skip over chunks that end before the offset
+        while (!mReady.empty() &&
+               mReady.front().offset +
+                   static_cast<nitf::Off>(mReady.front().size) <= offset)
+        {
+            mFree.push_back(mReady.front().buffer);
+            mReady.pop_front();
+        }
+        if (!mReady.empty() && mReady.front().offset <= offset)
+        {
+            break;
+        }
+        if (!mError.empty())
+        {
+            throw except::Exception(Ctxt(mError));
+        }
+
+        // Restart the read-ahead unless it is already headed here
+        const nitf::Off first = !mReady.empty() ? mReady.front().offset :
+                (mInFlight >= 0 ? mInFlight : mReadOffset);
+        if (offset < first || offset > mReadOffset)
+        {
+            while (!mReady.empty())
+            {
+                mFree.push_back(mReady.front().buffer);
+                mReady.pop_front();
+            }
+            ++mGeneration;
+            mInFlight = -1;
+            mReadOffset = offset;
+        }
+        mCondition.broadcast();
+        mCondition.wait();
+        waited = true;
+    }
+    mCondition.broadcast();
+
+    if (waited)
+    {
+        ++mPrefetchMisses;
+    }
+    else
+    {
+        ++mPrefetchHits;
+    }
+
+    const Chunk chunk = mReady.front();
+    mReady.pop_front();
+    mBuffer = chunk.buffer;
+    mBufferOffset = chunk.offset;
+    mBufferLength = chunk.size;
+    mPosition = static_cast<size_t>(offset - chunk.offset);
+}
+
+void BufferedReader::stopThread()
+{
+    if (mThread.get())
+    {
+        {
+            mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+            mStop = true;
+            mCondition.broadcast();
+        }
+        mThread->join();
+        mThread.reset();
+    }
+}
+
+void BufferedReader::readBuffers()
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    while (true)
+    {
+        while (!mStop &&
+               (mFree.empty() || mReadOffset >= mLength || !mError.empty()))
+        {
+            mCondition.wait();
+        }
+        if (mStop)
+        {
+            break;
+        }
+
+        char* const buffer = mFree.back();
+        mFree.pop_back();
+        const nitf::Off offset = mReadOffset;
+        const size_t size = static_cast<size_t>(
+                std::min<nitf::Off>(mLength - offset, mBufferSize));
+        const size_t generation = mGeneration;
+        mReadOffset += size;
+        mInFlight = offset;
+
+        std::string error;
+        double elapsed = 0;
+        obtainLock.manualUnlock();
+        try
+        {
+            sys::RealTimeStopWatch sw;
+            sw.start();
+            mFile.seekTo(offset, sys::File::FROM_START);
+            mFile.readInto(buffer, size);
+            elapsed = sw.stop() / 1000.0;
+        }
+        catch (const except::Throwable& t)
+        {
+            error = t.getMessage();
+        }
+        catch (const std::exception& ex)
+        {
+            error = ex.what();
+        }
+        catch (...)
+        {
+            error = "Unknown error reading buffer";
+        }
+        obtainLock.manualLock();
+        mInFlight = -1;
+
+        if (!error.empty())
+        {
+            mError = error;
+            mFree.push_back(buffer);
+        }
+        else
+        {
+            mElapsedTime += elapsed;
+            mTotalRead += size;
+            mBlocksRead += 1;
+            if (mBufferSize != size)
+            {
+                mPartialBlocks += 1;
+            }
+
+            // Chunks read before a restart are of no use
+            if (generation == mGeneration)
+            {
+                mReady.push_back(Chunk(buffer, offset, size));
+            }
+            else
+            {
+                mFree.push_back(buffer);
+            }
+        }
+        mCondition.broadcast();
+    }
+}
+
 void BufferedReader::readImpl(void* buf, size_t size)
 {
     //! Ensure there is enough data to read
@@ -90,14 +347,14 @@ void BufferedReader::readImpl(void* buf, size_t size)
     while (amountLeftToRead)
     {
         const size_t readSize =
-                std::min<size_t>(amountLeftToRead, mBufferSize - mPosition);
+                std::min<size_t>(amountLeftToRead, mBufferLength - mPosition);
 
         memcpy(bufPtr + offset, mBuffer + mPosition, readSize);
         mPosition += readSize;
         offset += readSize;
         amountLeftToRead -= readSize;
 
-        if (mPosition >= mBufferSize)
+        if (mPosition >= mBufferLength)
         {
             readNextBuffer();
         }
@@ -117,14 +374,38 @@ bool BufferedReader::canSeekImpl() const
 
 nitf::Off BufferedReader::seekImpl(nitf::Off offset, int whence)
 {
-    const sys::Off_T newOffset = mFile.seekTo(offset, whence);
+    nitf::Off newOffset = offset;
+    if (whence == NITF_SEEK_CUR)
+    {
+        newOffset += tell();
+    }
+    else if (whence == NITF_SEEK_END)
+    {
+        newOffset += getSize();
+    }
+
+    // Seeks within the current chunk need no read
+    if (newOffset >= mBufferOffset &&
+        newOffset < mBufferOffset + static_cast<nitf::Off>(mBufferLength))
+    {
+        mPosition = static_cast<size_t>(newOffset - mBufferOffset);
+        return newOffset;
+    }
+
+    if (mThread.get())
+    {
+        takeBuffer(newOffset);
+        return newOffset;
+    }
+
+    newOffset = mFile.seekTo(newOffset, sys::File::FROM_START);
     readNextBuffer();
     return newOffset;
 }
 
 nitf::Off BufferedReader::tellImpl() const
 {
-    return (mFile.getCurrentOffset() - mBufferSize + mPosition);
+    return (mBufferOffset + mPosition);
 }
 
 nitf::Off BufferedReader::getSizeImpl() const
@@ -139,6 +420,7 @@ int BufferedReader::getModeImpl() const
 
 void BufferedReader::closeImpl()
 {
+    stopThread();
     mFile.close();
 }
 }
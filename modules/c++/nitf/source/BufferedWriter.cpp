@@ -9,10 +9,15 @@ BufferedWriter::BufferedWriter(const std::string& file, size_t bufferSize) :
     mScopedBuffer(new char[bufferSize]),
     mBuffer(mScopedBuffer.get()),
     mPosition(0),
+    mOffset(0),
     mTotalWritten(0),
     mBlocksWritten(0),
     mPartialBlocks(0),
     mElapsedTime(0),
+    mStallTime(0),
+    mCondition(&mMutex),
+    mWriting(false),
+    mStop(false),
     mFile(file, sys::File::WRITE_ONLY, sys::File::CREATE | sys::File::TRUNCATE)
 {
     if (mBufferSize == 0)
@@ -22,6 +27,47 @@ BufferedWriter::BufferedWriter(const std::string& file, size_t bufferSize) :
     }
 }
 
+BufferedWriter::BufferedWriter(const std::string& file,
+                               size_t bufferSize,
+                               size_t numBuffers) :
+    mBufferSize(bufferSize),
+    mScopedBuffer(new char[bufferSize * numBuffers]),
+    mBuffer(mScopedBuffer.get()),
+    mPosition(0),
+    mOffset(0),
+    mTotalWritten(0),
+    mBlocksWritten(0),
+    mPartialBlocks(0),
+    mElapsedTime(0),
+    mStallTime(0),
+    mCondition(&mMutex),
+    mWriting(false),
+    mStop(false),
+    mFile(file, sys::File::WRITE_ONLY, sys::File::CREATE | sys::File::TRUNCATE)
+{
+    if (mBufferSize == 0)
+    {
+        throw except::Exception(Ctxt(
+            "BufferedWriters must have a buffer size greater than zero"));
+    }
+    if (numBuffers == 0)
+    {
+        throw except::Exception(Ctxt(
+            "BufferedWriters must have at least one buffer"));
+    }
+
+    if (numBuffers > 1)
+    {
+        // The first buffer is the one being filled
+        for (size_t ii = 1; ii < numBuffers; ++ii)
+        {
+            mFree.push_back(mBuffer + ii * mBufferSize);
+        }
+        mThread.reset(new sys::Thread(new WriteThread(this)));
+        mThread->start();
+    }
+}
+
 BufferedWriter::BufferedWriter(const std::string& file,
                                char* buffer,
                                size_t size,
@@ -30,10 +76,15 @@ BufferedWriter::BufferedWriter(const std::string& file,
     mScopedBuffer(adopt ? buffer : NULL),
     mBuffer(buffer),
     mPosition(0),
+    mOffset(0),
     mTotalWritten(0),
     mBlocksWritten(0),
     mPartialBlocks(0),
     mElapsedTime(0),
+    mStallTime(0),
+    mCondition(&mMutex),
+    mWriting(false),
+    mStop(false),
     mFile(file, sys::File::WRITE_ONLY, sys::File::CREATE)
 {
     if (mBufferSize == 0)
@@ -61,32 +112,176 @@ BufferedWriter::~BufferedWriter()
     catch (...)
     {
     }
+
+    // The write thread must be finished before the buffers go away
+    try
+    {
+        stopThread();
+    }
+    catch (...)
+    {
+    }
 }
 
 void BufferedWriter::flushBuffer()
 {
     flushBuffer(mBuffer);
+    waitForWrites();
 }
 
 void BufferedWriter::flushBuffer(const char* buf)
 {
     if (mPosition > 0)
+    {
+        if (mThread.get())
+        {
+            queueBuffer();
+        }
+        else
+        {
+            const double elapsed = writeBuffer(buf, mPosition);
+
+            mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+            mStallTime += elapsed;
+        }
+
+        mOffset += mPosition;
+        mPosition = 0;
+    }
+}
+
+void BufferedWriter::queueBuffer()
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    mPending.push_back(Pending(mBuffer, mPosition));
+    mCondition.broadcast();
+
+    // Wait for a buffer to fill next
+    while (mFree.empty())
+    {
+        mCondition.wait();
+    }
+    mBuffer = mFree.back();
+    mFree.pop_back();
+    mStallTime += (sw.stop() / 1000.);
+
+    if (!mError.empty())
+    {
+        throw except::Exception(Ctxt(mError));
+    }
+}
+
+void BufferedWriter::waitForWrites() const
+{
+    if (mThread.get())
     {
         sys::RealTimeStopWatch sw;
         sw.start();
-        mFile.writeFrom(buf, mPosition);
-        mElapsedTime += (sw.stop() / 1000.);
 
-        mTotalWritten += mPosition;
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+        while (!mPending.empty() || mWriting)
+        {
+            mCondition.wait();
+        }
+        mStallTime += (sw.stop() / 1000.);
 
-        ++mBlocksWritten;
+        if (!mError.empty())
+        {
+            throw except::Exception(Ctxt(mError));
+        }
+    }
+}
 
-        if (mPosition != mBufferSize)
+void BufferedWriter::stopThread()
+{
+    if (mThread.get())
+    {
         {
-            ++mPartialBlocks;
+            mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+            mStop = true;
+            mCondition.broadcast();
         }
+        mThread->join();
+        mThread.reset();
+    }
+}
 
-        mPosition = 0;
+double BufferedWriter::writeBuffer(const char* buf, size_t size)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    mFile.writeFrom(buf, size);
+    const double elapsed = sw.stop() / 1000.;
+
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    mElapsedTime += elapsed;
+
+    mTotalWritten += size;
+
+    ++mBlocksWritten;
+
+    if (size != mBufferSize)
+    {
+        ++mPartialBlocks;
+    }
+
+    return elapsed;
+}
+
+void BufferedWriter::writeBuffers()
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    while (true)
+    {
+        while (mPending.empty() && !mStop)
+        {
+            mCondition.wait();
+        }
+        if (mPending.empty())
+        {
+            break;
+        }
+
+        const Pending pending = mPending.front();
+        mPending.pop_front();
+        mWriting = true;
+
+        // Once a write fails the rest are dropped, the error is reported
+        // to the caller
+        const bool failed = !mError.empty();
+        std::string error;
+        obtainLock.manualUnlock();
+        if (!failed)
+        {
+            try
+            {
+                writeBuffer(pending.buffer, pending.size);
+            }
+            catch (const except::Throwable& t)
+            {
+                error = t.getMessage();
+            }
+            catch (const std::exception& ex)
+            {
+                error = ex.what();
+            }
+            catch (...)
+            {
+                error = "Unknown error writing buffer";
+            }
+        }
+        obtainLock.manualLock();
+
+        if (!error.empty())
+        {
+            mError = error;
+        }
+        mFree.push_back(pending.buffer);
+        mWriting = false;
+        mCondition.broadcast();
     }
 }
 
@@ -111,8 +306,9 @@ void BufferedWriter::writeImpl(const void* buf, size_t size)
             bytes = mBufferSize - mPosition;
         }
 
-        // copy bytes to internal buffer
-        if (bytes < mBufferSize)
+        // copy bytes to internal buffer (always, when the buffer is
+        // written in the background, since the caller may reuse buf)
+        if (bytes < mBufferSize || mThread.get())
         {
             // Copy over and subtract bytes from the size left
             memcpy(mBuffer + mPosition, bufPtr + from, bytes);
@@ -122,10 +318,11 @@ void BufferedWriter::writeImpl(const void* buf, size_t size)
             size -= bytes;
             from += bytes;
 
-            // check the internal buffer
+            // check the internal buffer (in the background, if there is
+            // a write thread, so the caller only waits for a free buffer)
             if (mPosition == mBufferSize)
             {
-                flushBuffer();
+                flushBuffer(mBuffer);
             }
         }
         // flush using the input buffer directly
@@ -149,19 +346,22 @@ bool BufferedWriter::canSeekImpl() const
 
 nitf::Off BufferedWriter::seekImpl(nitf::Off offset, int whence)
 {
-    // This is very unfortunate, since it creates a partial block
+    // This is very unfortunate, since it creates a partial block.  The
+    // background writes use the file offset, so they must finish first.
     flushBuffer();
 
-    return mFile.seekTo(offset, whence);
+    mOffset = mFile.seekTo(offset, whence);
+    return mOffset;
 }
 
 nitf::Off BufferedWriter::tellImpl() const
 {
-    return (mFile.getCurrentOffset() + mPosition);
+    return (mOffset + mPosition);
 }
 
 nitf::Off BufferedWriter::getSizeImpl() const
 {
+    waitForWrites();
     return (mFile.length() + mPosition);
 }
 
@@ -181,8 +381,13 @@ void BufferedWriter::closeImpl()
     sys::RealTimeStopWatch sw;
     sw.start();
     mFile.flush();
-    mElapsedTime += (sw.stop() / 1000.);
+    const double elapsed = sw.stop() / 1000.;
 
     mFile.close();
+    stopThread();
+
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    mElapsedTime += elapsed;
+    mStallTime += elapsed;
 }
 }
@@ -98,3 +98,26 @@ nitf::Select2DownSample::Select2DownSample(nitf::Uint32 rowSkip,
 nitf::Select2DownSample::~Select2DownSample()
 {
 }
+
+nitf::BoxDownSample::BoxDownSample(nitf::Uint32 rowSkip,
+        nitf::Uint32 colSkip) throw (nitf::NITFException)
+{
+    setNative(nitf_BoxDownSample_construct(rowSkip, colSkip, &error));
+    setManaged(false);
+}
+
+nitf::BoxDownSample::~BoxDownSample()
+{
+}
+
+nitf::GaussianDownSample::GaussianDownSample(nitf::Uint32 rowSkip,
+        nitf::Uint32 colSkip, double sigma) throw (nitf::NITFException)
+{
+    setNative(nitf_GaussianDownSample_construct(rowSkip, colSkip, sigma,
+                                                &error));
+    setManaged(false);
+}
+
+nitf::GaussianDownSample::~GaussianDownSample()
+{
+}
@@ -51,15 +51,17 @@ nitf::BlockingInfo ImageReader::getBlockingInfo() throw (nitf::NITFException)
 
 void ImageReader::read(nitf::SubWindow & subWindow, nitf::Uint8 ** user, int * padded) throw (nitf::NITFException)
 {
-    NITF_BOOL x = nitf_ImageReader_read(getNativeOrThrow(), subWindow.getNative(), user, padded, &error);
+    // Use a local error, reads may be made from several threads at once
+    nitf_Error readError;
+    NITF_BOOL x = nitf_ImageReader_read(getNativeOrThrow(), subWindow.getNative(), user, padded, &readError);
     if (!x)
-        throw nitf::NITFException(&error);
+        throw nitf::NITFException(&readError);
 }
 
 const nitf::Uint8* ImageReader::readBlock(nitf::Uint32 blockNumber, nitf::Uint64* blockSize)  
     throw (nitf::NITFException)
 {
-    const nitf::Uint8* x = nitf_ImageReader_readBlock(
+    const nitf::Uint8* x = nitf_ImageReader_getBlock(
         getNativeOrThrow(), blockNumber, blockSize, &error);
     if (!x)
         throw nitf::NITFException(&error);
@@ -70,3 +72,32 @@ void ImageReader::setReadCaching()
 {
     nitf_ImageReader_setReadCaching(getNativeOrThrow());
 }
+
+void ImageReader::setReadCaching(nitf::Uint64 maxSize)
+{
+    nitf_ImageReader_setReadCacheSize(getNativeOrThrow(), maxSize);
+}
+
+nitf::Uint64 ImageReader::getReadCacheHits()
+{
+    nitf::Uint64 hits;
+    nitf_ImageReader_getReadCacheStats(getNativeOrThrow(), &hits, NULL);
+    return hits;
+}
+
+nitf::Uint64 ImageReader::getReadCacheMisses()
+{
+    nitf::Uint64 misses;
+    nitf_ImageReader_getReadCacheStats(getNativeOrThrow(), NULL, &misses);
+    return misses;
+}
+
+void ImageReader::setReadThreads(nitf::Uint32 numThreads)
+{
+    nitf_ImageReader_setReadThreads(getNativeOrThrow(), numThreads);
+}
+
+void ImageReader::setScaledDecode(bool enable)
+{
+    nitf_ImageReader_setScaledDecode(getNativeOrThrow(), enable ? 1 : 0);
+}
@@ -61,6 +61,16 @@ void ImageWriter::setDirectBlockWrite(int enable)
     nitf_ImageWriter_setDirectBlockWrite(getNativeOrThrow(), enable);
 }
 
+void ImageWriter::setWriteThreads(nitf::Uint32 numThreads)
+{
+    nitf_ImageWriter_setWriteThreads(getNativeOrThrow(), numThreads);
+}
+
+void ImageWriter::setDataLength(nitf::Off length)
+{
+    nitf_ImageWriter_setDataLength(getNativeOrThrow(), length);
+}
+
 void ImageWriter::setPadPixel(nitf::Uint8* value, nitf::Uint32 length)
 {
     if (!nitf_ImageWriter_setPadPixel(getNativeOrThrow(), value, length, &error))
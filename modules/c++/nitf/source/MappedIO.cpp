@@ -20,5 +20,35 @@
  *
  */
 
-#include "nitf/Handle.hpp"
-sys::Mutex nitf::Handle::mutex;
+
+#include <nitf/MappedIO.hpp>
+
+namespace nitf
+{
+MappedIO::MappedIO(const std::string& fname) throw (nitf::NITFException) :
+    IOInterface(open(fname.c_str()))
+{
+    setManaged(false);
+}
+
+MappedIO::MappedIO(const char* fname) throw (nitf::NITFException) :
+    IOInterface(open(fname))
+{
+    setManaged(false);
+}
+
+nitf_IOInterface* MappedIO::open(const char* fname)
+        throw (nitf::NITFException)
+{
+    nitf_Error error;
+    nitf_IOInterface* const interface =
+            nitf_MappedAdapter_open(fname, &error);
+
+    if (!interface)
+    {
+        throw nitf::NITFException(&error);
+    }
+
+    return interface;
+}
+}
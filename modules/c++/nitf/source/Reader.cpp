@@ -116,6 +116,16 @@ nitf::Record Reader::readIO(nitf::IOInterface & io) throw (nitf::NITFException)
     return rec;
 }
 
+void Reader::setUseArena(bool useArena)
+{
+    nitf_Reader_setUseArena(getNativeOrThrow(), useArena ? 1 : 0);
+}
+
+void Reader::setLazyTREs(bool lazyTREs)
+{
+    nitf_Reader_setLazyTREs(getNativeOrThrow(), lazyTREs ? 1 : 0);
+}
+
 nitf::ImageReader Reader::newImageReader(int imageSegmentNumber)
         throw (nitf::NITFException)
 {
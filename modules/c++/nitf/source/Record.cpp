@@ -186,6 +186,28 @@ nitf::ImageSegment Record::newImageSegment(int index)
     return nitf::ImageSegment(x);
 }
 
+nitf::ImageSegment Record::newOverviewSegment(nitf::Uint32 imageIndex,
+                                              nitf::Uint32 factor)
+{
+    nitf_ImageSegment* x = nitf_Overview_newSegment(getNativeOrThrow(),
+                                                    imageIndex, factor,
+                                                    &error);
+    if (!x)
+        throw nitf::NITFException(&error);
+    return nitf::ImageSegment(x);
+}
+
+nitf::Uint32 Record::selectOverview(nitf::Uint32 imageIndex,
+                                    nitf::Uint32 factor,
+                                    nitf::Uint32& overviewFactor)
+{
+    nitf::Uint32 overviewIndex;
+    if (!nitf_Overview_select(getNativeOrThrow(), imageIndex, factor,
+                              &overviewIndex, &overviewFactor, &error))
+        throw nitf::NITFException(&error);
+    return overviewIndex;
+}
+
 nitf::GraphicSegment Record::newGraphicSegment(int index)
 {
     nitf_GraphicSegment* x = nitf_Record_newGraphicSegment(getNativeOrThrow(), &error);
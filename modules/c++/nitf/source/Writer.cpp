@@ -82,6 +82,16 @@ void Writer::write()
         throw nitf::NITFException(&error);
 }
 
+void Writer::setStreaming(bool enable)
+{
+    nitf_Writer_setStreaming(getNativeOrThrow(), enable ? 1 : 0);
+}
+
+void Writer::setWriteThreads(nitf::Uint32 numThreads)
+{
+    nitf_Writer_setWriteThreads(getNativeOrThrow(), numThreads);
+}
+
 void Writer::prepare(nitf::IOHandle & io, nitf::Record & record)
         throw (nitf::NITFException)
 {
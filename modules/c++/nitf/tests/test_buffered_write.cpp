@@ -66,12 +66,14 @@ nitf::ImageSource setupBands(int nbands, int imageNum, const std::string& inRoot
 void doWrite(nitf::Record record,
              const std::string& inRootFile,
              const std::string& outFile,
-             size_t bufferSize)
+             size_t bufferSize,
+             size_t numBuffers)
 {
     std::cout << "Preparing to write file in " << bufferSize
-              << " size blocks" << std::endl;
+              << " size blocks through " << numBuffers << " buffer(s)"
+              << std::endl;
 
-    nitf::BufferedWriter output(outFile, bufferSize);
+    nitf::BufferedWriter output(outFile, bufferSize, numBuffers);
     nitf::Writer writer;
     writer.prepareIO(output, record);
 
@@ -95,6 +97,7 @@ void doWrite(nitf::Record record,
     std::cout << "------------------------------------" << std::endl;
     std::cout << "Total number of blocks written: " << output.getNumBlocksWritten() << std::endl;
     std::cout << "Of those, " << output.getNumPartialBlocksWritten() << " were less than buffer size " << bufferSize << std::endl;
+    std::cout << "Time writing: " << output.getTotalWriteTime() << "s, time stalled: " << output.getTotalStallTime() << "s" << std::endl;
 
 
 
@@ -105,16 +108,20 @@ int main(int argc, char **argv)
     try
     {
         //  Check argv and make sure we are happy
-        if (argc < 3 || argc > 4)
+        if (argc < 3 || argc > 5)
         {
-            std::cout << "Usage: %s <input-file> <output-file> (block-size - default is 8192)\n" << argv[0] << std::endl;
+            std::cout << "Usage: %s <input-file> <output-file> (block-size - default is 8192) (number of buffers - default is 1)\n" << argv[0] << std::endl;
             exit(EXIT_FAILURE);
         }
 
         size_t blockSize = 8192;
-        if (argc == 4)
+        if (argc >= 4)
             blockSize = str::toType<int>(argv[3]);
 
+        size_t numBuffers = 1;
+        if (argc == 5)
+            numBuffers = str::toType<int>(argv[4]);
+
         // Check that wew have a valid NITF
         if (nitf::Reader::getNITFVersion(argv[1]) == NITF_VER_UNKNOWN )
         {
@@ -123,7 +130,7 @@ int main(int argc, char **argv)
         }
 
         nitf::Record record = doRead(argv[1]);
-        doWrite(record, argv[1], argv[2], blockSize);
+        doWrite(record, argv[1], argv[2], blockSize, numBuffers);
         return 0;
     }
     catch (except::Throwable & t)
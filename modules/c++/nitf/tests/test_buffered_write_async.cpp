@@ -0,0 +1,231 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nitf.hpp>
+#include <import/sys.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifndef WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+ * This test checks the asynchronous mode of the BufferedWriter.  The
+ * output is a FIFO that is not read until the caller has written more than
+ * one full buffer, so the background writes cannot finish: the caller
+ * must still get back control after each full buffer.  Then the FIFO is
+ * drained and the bytes are checked against what was written.
+ *
+ * This needs a POSIX FIFO, so it is skipped on Windows.
+ */
+
+#ifndef WIN32
+
+namespace
+{
+const size_t BUFFER_SIZE = 1024 * 1024;
+const size_t NUM_BUFFERS = 3;
+
+// Two full buffers (all that fit while one is being filled) and a partial
+const size_t TOTAL_SIZE = 2 * BUFFER_SIZE + 12345;
+
+char byteAt(size_t offset)
+{
+    return static_cast<char>((offset * 7 + offset / 251) & 0xff);
+}
+
+class Drain : public sys::Runnable
+{
+public:
+    Drain(int fd, sys::Mutex& mutex, bool& started) :
+        mFd(fd),
+        mMutex(mutex),
+        mStarted(started),
+        mBytesRead(0),
+        mMismatches(0)
+    {
+    }
+
+    virtual void run()
+    {
+        // Give the writer time to block, if it is going to
+        sys::OS().millisleep(2000);
+        {
+            mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+            mStarted = true;
+        }
+
+        std::vector<char> buffer(64 * 1024);
+        while (mBytesRead < TOTAL_SIZE)
+        {
+            const ssize_t count = ::read(mFd, &buffer[0], buffer.size());
+            if (count < 0 && (errno == EAGAIN || errno == EINTR))
+            {
+                sys::OS().millisleep(1);
+                continue;
+            }
+            if (count <= 0)
+            {
+                break;
+            }
+            for (ssize_t ii = 0; ii < count; ++ii)
+            {
+                if (buffer[ii] != byteAt(mBytesRead + ii))
+                {
+                    ++mMismatches;
+                }
+            }
+            mBytesRead += count;
+        }
+    }
+
+    size_t getBytesRead() const
+    {
+        return mBytesRead;
+    }
+
+    size_t getMismatches() const
+    {
+        return mMismatches;
+    }
+
+private:
+    const int mFd;
+    sys::Mutex& mMutex;
+    bool& mStarted;
+    size_t mBytesRead;
+    size_t mMismatches;
+};
+}
+
+int main(int argc, char **argv)
+{
+    const std::string fifoName = argc > 1 ? argv[1] :
+            "test_buffered_write_async.fifo";
+    int fd = -1;
+    int status = EXIT_FAILURE;
+
+    try
+    {
+        ::unlink(fifoName.c_str());
+        if (::mkfifo(fifoName.c_str(), 0600) != 0)
+        {
+            throw except::Exception(Ctxt("Unable to create " + fifoName));
+        }
+
+        // The FIFO must have a reader for the writer to open it
+        fd = ::open(fifoName.c_str(), O_RDONLY | O_NONBLOCK);
+        if (fd < 0)
+        {
+            throw except::Exception(Ctxt("Unable to open " + fifoName));
+        }
+
+        std::vector<char> data(TOTAL_SIZE);
+        for (size_t ii = 0; ii < TOTAL_SIZE; ++ii)
+        {
+            data[ii] = byteAt(ii);
+        }
+
+        sys::Mutex mutex;
+        bool drainStarted = false;
+        Drain* drain = new Drain(fd, mutex, drainStarted);
+        sys::Thread drainThread(drain);
+
+        bool blocked;
+        {
+            nitf::BufferedWriter output(fifoName, BUFFER_SIZE, NUM_BUFFERS);
+            drainThread.start();
+
+            // Odd sized writes, so buffers fill part way through a write
+            for (size_t offset = 0; offset < TOTAL_SIZE; )
+            {
+                const size_t size = std::min<size_t>(100000,
+                                                     TOTAL_SIZE - offset);
+                output.write(&data[offset], size);
+                offset += size;
+            }
+
+            {
+                mt::CriticalSection<sys::Mutex> obtainLock(&mutex);
+                blocked = drainStarted;
+            }
+
+            // Now wait for everything to reach the FIFO.  This is not
+            // close(), since a FIFO cannot be synced.
+            output.flushBuffer();
+
+            std::cout << "Blocks written: " << output.getNumBlocksWritten()
+                      << ", partial: " << output.getNumPartialBlocksWritten()
+                      << std::endl;
+            if (output.getTotalWritten() != TOTAL_SIZE ||
+                output.getNumBlocksWritten() != 3 ||
+                output.getNumPartialBlocksWritten() != 1)
+            {
+                throw except::Exception(Ctxt("Wrong write statistics"));
+            }
+        }
+        drainThread.join();
+
+        if (blocked)
+        {
+            throw except::Exception(Ctxt(
+                "The caller waited for the background writes"));
+        }
+        if (drain->getBytesRead() != TOTAL_SIZE ||
+            drain->getMismatches() != 0)
+        {
+            std::cout << drain->getBytesRead() << " bytes read, "
+                      << drain->getMismatches() << " wrong" << std::endl;
+            throw except::Exception(Ctxt("The written bytes are wrong"));
+        }
+
+        std::cout << "Asynchronous write: PASSED" << std::endl;
+        status = EXIT_SUCCESS;
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cout << t.getMessage() << std::endl;
+    }
+
+    if (fd >= 0)
+    {
+        ::close(fd);
+    }
+    ::unlink(fifoName.c_str());
+    return status;
+}
+
+#else
+
+int main(int, char**)
+{
+    std::cout << "Asynchronous write: SKIPPED (no FIFO)" << std::endl;
+    return 0;
+}
+
+#endif
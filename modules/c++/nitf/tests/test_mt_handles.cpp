@@ -0,0 +1,137 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ *  Acquires and releases handles to a few shared objects from several
+ *  threads at once.  A handle must never be deleted while a thread is
+ *  acquiring it, and every handle must be gone once all are released.
+ *
+ *  Usage: test_mt_handles [threads] [iterations]
+ */
+
+#include <import/sys.h>
+#include <import/nitf.hpp>
+
+namespace
+{
+const int NUM_OBJECTS = 16;
+int objects[NUM_OBJECTS];
+
+typedef nitf::BoundHandle<int, nitf::MemoryDestructor<int> > IntHandle;
+
+IntHandle* acquire(int* object)
+{
+    return nitf::HandleRegistry::getInstance().acquireHandle<int,
+        nitf::MemoryDestructor<int> >(object);
+}
+
+void release(int* object)
+{
+    nitf::HandleRegistry::getInstance().releaseHandle(object);
+}
+
+class HandleThread : public sys::Thread
+{
+public:
+    HandleThread(int id, int iterations) :
+        mId(id), mIterations(iterations), mFailures(0)
+    {
+    }
+
+    virtual void run()
+    {
+        for (int i = 0; i < mIterations; ++i)
+        {
+            int* object = &objects[(i * 7 + mId) % NUM_OBJECTS];
+            IntHandle* handle = acquire(object);
+            if (handle->get() != object || handle->getRef() < 1)
+                ++mFailures;
+            release(object);
+        }
+    }
+
+    int getFailures() const
+    {
+        return mFailures;
+    }
+
+private:
+    int mId;
+    int mIterations;
+    int mFailures;
+};
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const int numThreads = argc > 1 ? str::toType<int>(argv[1]) : 4;
+        const int iterations = argc > 2 ? str::toType<int>(argv[2]) : 100000;
+
+        // Hold every other object for the whole run, so some handles are
+        // shared with the threads and some come and go
+        for (int i = 0; i < NUM_OBJECTS; i += 2)
+            acquire(&objects[i]);
+
+        std::vector<HandleThread*> threads;
+        for (int i = 0; i < numThreads; ++i)
+        {
+            threads.push_back(new HandleThread(i, iterations));
+            threads.back()->start();
+        }
+
+        int failures = 0;
+        for (int i = 0; i < numThreads; ++i)
+        {
+            threads[i]->join();
+            failures += threads[i]->getFailures();
+            delete threads[i];
+        }
+
+        for (int i = 0; i < NUM_OBJECTS; ++i)
+        {
+            const bool held = i % 2 == 0;
+            if (nitf::HandleRegistry::getInstance().hasHandle(&objects[i])
+                    != held)
+                ++failures;
+            else if (held && acquire(&objects[i])->getRef() != 2)
+                ++failures;
+            if (held)
+            {
+                release(&objects[i]);
+                release(&objects[i]);
+            }
+            if (nitf::HandleRegistry::getInstance().hasHandle(&objects[i]))
+                ++failures;
+        }
+
+        std::cout << numThreads << " threads, " << iterations
+                  << " iterations: " << failures << " failures" << std::endl;
+        return failures == 0 ? 0 : 1;
+    }
+    catch (except::Throwable& t)
+    {
+        std::cout << t.getTrace() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,902 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nitf.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <setjmp.h>
+#include <jpeglib.h>
+#include <jerror.h>
+
+/* borrowed from ImageIO.c */
+#ifndef NITF_IMAGE_IO_NO_BLOCK
+#   define NITF_IMAGE_IO_NO_BLOCK             ((nitf_Uint32) 0xffffffff)
+#endif
+
+/* libjpeg's default quality */
+#define DEFAULT_QUALITY     75
+
+/* Blocks handed to each worker thread per batch */
+#define BLOCKS_PER_THREAD   4
+
+/* Upper limit on the uncompressed size of one batch */
+#define MAX_BATCH_SIZE      (32 * 1024 * 1024)
+
+/* Smallest compressed block buffer */
+#define MIN_OUTPUT_SIZE     4096
+
+NITF_CXX_GUARD
+
+NITFPRIV(nitf_CompressionControl*) implOpen(nitf_ImageSubheader* subheader,
+                                            nrt_HashTable* options,
+                                            nitf_Error* error);
+
+NITFPRIV(NITF_BOOL) implStart(nitf_CompressionControl* control,
+                              nitf_Uint64 offset,
+                              nitf_Uint64 dataLength,
+                              nitf_Uint64* blockMask,
+                              nitf_Uint64* padMask,
+                              nitf_Error* error);
+
+NITFPRIV(NITF_BOOL) implWriteBlock(nitf_CompressionControl* control,
+                                   nitf_IOInterface* io,
+                                   const nitf_Uint8* data,
+                                   NITF_BOOL pad,
+                                   NITF_BOOL noData,
+                                   nitf_Error* error);
+
+NITFPRIV(NITF_BOOL) implEnd(nitf_CompressionControl* control,
+                            nitf_IOInterface* io,
+                            nitf_Error* error);
+
+NITFPRIV(void) implDestroy(nitf_CompressionControl** control);
+
+/*!
+ *  This plugin compresses C3 and M3 (JPEG DCT) images with libjpeg. The
+ *  decompression side is LibjpegDecompress.
+ */
+static const char *ident[] =
+    {
+        NITF_PLUGIN_COMPRESSION_KEY,
+        "C3",
+        "M3",
+        NULL
+    };
+
+static nitf_CompressionInterface interfaceTable =
+    {
+        implOpen, implStart, implWriteBlock, implEnd, implDestroy, NULL
+    };
+
+/*!
+ *  \struct JPEGCompressSlot
+ *  \brief One block on its way from the caller to the file
+ *
+ *  \ar data  Copy of the uncompressed block
+ *  \ar output  The compressed block (grown as needed, reused)
+ *  \ar outputSize  The allocated size of output
+ *  \ar length  The length of the compressed block
+ *  \ar blockNumber  The block's entry in the block mask
+ *  \ar pad  Set if the block contains pad pixels
+ */
+typedef struct _JPEGCompressSlot
+{
+    nitf_Uint8*  data;
+    nitf_Uint8*  output;
+    size_t       outputSize;
+    size_t       length;
+    nitf_Uint32  blockNumber;
+    NITF_BOOL    pad;
+}
+JPEGCompressSlot;
+
+/*!
+ *  \struct JPEGCompressBatch
+ *  \brief A set of blocks that are encoded together
+ *
+ *  The workers take the blocks in turn (next is protected by the control's
+ *  lock). The first failure is kept in error.
+ */
+typedef struct _JPEGCompressBatch
+{
+    JPEGCompressSlot* slots;
+    nitf_Uint32       count;
+    nitf_Uint32       next;
+    NITF_BOOL         running;
+    NITF_BOOL         failed;
+    nitf_Error        error;
+}
+JPEGCompressBatch;
+
+struct _JPEGImplControl;
+
+/*!
+ *  \struct JPEGCompressWorker
+ *  \brief A thread encoding blocks of each batch it is given
+ *
+ *  \ar jobSerial  The serial number of the last batch taken
+ */
+typedef struct _JPEGCompressWorker
+{
+    struct _JPEGImplControl* control;
+    nitf_Thread              thread;
+    nitf_Uint32              jobSerial;
+}
+JPEGCompressWorker;
+
+/*!
+ *  \struct JPEGImplControl
+ *  \brief The actual implementation beneath the opaque control pointer
+ *
+ *  Blocks are copied into a batch as they arrive. When the batch is full
+ *  it is encoded by the worker threads while the caller fills the other
+ *  batch, and written out (in order) once the other batch is full in turn
+ *  or the image is done. With one thread the blocks are encoded by the
+ *  caller. The workers are started for the first batch and wait for the
+ *  next one until the control is destroyed.
+ *
+ *  \ar numRowsPerBlock, numColsPerBlock  Block dimensions
+ *  \ar numComponents  Samples per pixel in a block (1)
+ *  \ar colorSpace  libjpeg input color space
+ *  \ar quality  JPEG quality (1 - 100)
+ *  \ar restartInterval  Restart interval in MCUs (0 for none)
+ *  \ar blockSize  The uncompressed length of a block in bytes
+ *  \ar masked  Set for M3, the block and pad masks are updated
+ *  \ar offset  File offset of the image data
+ *  \ar written  Number of bytes written so far
+ *  \ar blockMask, padMask  The masks (from the start function)
+ *  \ar numBlocks  The number of blocks in the masks
+ *  \ar nextBlock  The mask entry of the next block to arrive
+ *  \ar batches  The batch being filled and the batch being encoded
+ *  \ar current  Index of the batch being filled
+ *  \ar batchSize  Number of blocks in a full batch
+ *  \ar numThreads  Number of worker threads
+ *  \ar workers  The workers (numThreads)
+ *  \ar numRunning  Number of workers with a running thread
+ *  \ar workersTried  Set once the worker threads have been started
+ *  \ar lock  Protects the next and failed fields of the batches
+ *  \ar workerLock  Protects the job fields and stopWorkers
+ *  \ar workReady  Signalled when there is a new batch (or on stop)
+ *  \ar workDone  Signalled when the workers are done with the batch
+ *  \ar job  The batch being encoded by the workers
+ *  \ar jobSerial  Incremented for each batch given to the workers
+ *  \ar jobWorkers  Workers still on the current batch
+ *  \ar stopWorkers  Worker threads exit if set
+ */
+typedef struct _JPEGImplControl
+{
+    nitf_Uint32        numRowsPerBlock;
+    nitf_Uint32        numColsPerBlock;
+    nitf_Uint32        numComponents;
+    J_COLOR_SPACE      colorSpace;
+    int                quality;
+    unsigned int       restartInterval;
+    size_t             blockSize;
+    NITF_BOOL          masked;
+    nitf_Uint64        offset;
+    nitf_Uint64        written;
+    nitf_Uint64*       blockMask;
+    nitf_Uint64*       padMask;
+    nitf_Uint32        numBlocks;
+    nitf_Uint32        nextBlock;
+    JPEGCompressBatch  batches[2];
+    nitf_Uint32        current;
+    nitf_Uint32        batchSize;
+    nitf_Uint32        numThreads;
+    JPEGCompressWorker* workers;
+    nitf_Uint32        numRunning;
+    NITF_BOOL          workersTried;
+    nitf_Mutex         lock;
+    nitf_Mutex         workerLock;
+    nitf_Condition     workReady;
+    nitf_Condition     workDone;
+    JPEGCompressBatch* job;
+    nitf_Uint32        jobSerial;
+    nitf_Uint32        jobWorkers;
+    NITF_BOOL          stopWorkers;
+}
+JPEGImplControl;
+
+/*!
+ *  libjpeg error manager that returns to the encoder instead of exiting
+ */
+typedef struct _JPEGErrorManager
+{
+    struct jpeg_error_mgr pub;
+    jmp_buf               jump;
+}
+JPEGErrorManager;
+
+/*!
+ *  libjpeg destination manager writing to a slot's output buffer
+ */
+typedef struct _JPEGDestination
+{
+    struct jpeg_destination_mgr pub;
+    JPEGCompressSlot*           slot;
+}
+JPEGDestination;
+
+NITF_CXX_ENDGUARD
+
+
+NITFAPI(const char**) LibjpegCompress_init(nitf_Error *error)
+{
+    /*  Return the identifier structure  */
+    return ident;
+}
+
+NITFAPI(void) C3_cleanup(void)
+{
+}
+
+NITFAPI(void*) C3_construct(char *compressionType,
+                            nitf_Error* error)
+{
+    if (strcmp(compressionType, "C3") != 0)
+    {
+        nitf_Error_init(error,
+                        "Unsupported compression type",
+                        NITF_CTXT,
+                        NITF_ERR_COMPRESSION);
+
+        return NULL;
+    }
+    return((void *) &interfaceTable);
+}
+
+NITFAPI(void) M3_cleanup(void)
+{
+}
+
+NITFAPI(void*) M3_construct(char *compressionType,
+                            nitf_Error* error)
+{
+    if (strcmp(compressionType, "M3") != 0)
+    {
+        nitf_Error_init(error,
+                        "Unsupported compression type",
+                        NITF_CTXT,
+                        NITF_ERR_COMPRESSION);
+
+        return NULL;
+    }
+    return((void *) &interfaceTable);
+}
+
+
+NITFPRIV(void) JPEGErrorExit(j_common_ptr cinfo)
+{
+    longjmp(((JPEGErrorManager*) cinfo->err)->jump, 1);
+}
+
+NITFPRIV(void) JPEGInitDestination(j_compress_ptr cinfo)
+{
+    JPEGDestination* dest = (JPEGDestination*) cinfo->dest;
+
+    dest->pub.next_output_byte = dest->slot->output;
+    dest->pub.free_in_buffer = dest->slot->outputSize;
+}
+
+/*
+ *  The buffer is full, double it
+ */
+NITFPRIV(boolean) JPEGEmptyOutputBuffer(j_compress_ptr cinfo)
+{
+    JPEGDestination* dest = (JPEGDestination*) cinfo->dest;
+    JPEGCompressSlot* slot = dest->slot;
+    nitf_Uint8* output;
+
+    output = (nitf_Uint8*) NITF_REALLOC(slot->output, 2 * slot->outputSize);
+    if (output == NULL)
+        ERREXIT1(cinfo, JERR_OUT_OF_MEMORY, 0);
+
+    dest->pub.next_output_byte = output + slot->outputSize;
+    dest->pub.free_in_buffer = slot->outputSize;
+    slot->output = output;
+    slot->outputSize *= 2;
+    return TRUE;
+}
+
+NITFPRIV(void) JPEGTermDestination(j_compress_ptr cinfo)
+{
+    JPEGDestination* dest = (JPEGDestination*) cinfo->dest;
+
+    dest->slot->length = dest->slot->outputSize - dest->pub.free_in_buffer;
+}
+
+/*!
+ *  Encode one block as a complete JPEG stream (SOI to EOI) into the slot's
+ *  output buffer
+ */
+NITFPRIV(NITF_BOOL) encodeBlock(JPEGImplControl* implControl,
+                                JPEGCompressSlot* slot,
+                                nitf_Error* error)
+{
+    struct jpeg_compress_struct cinfo;
+    JPEGErrorManager jerr;
+    JPEGDestination dest;
+    JSAMPROW row;
+    size_t rowLength;
+    char message[JMSG_LENGTH_MAX];
+
+    cinfo.err = jpeg_std_error(&jerr.pub);
+    jerr.pub.error_exit = JPEGErrorExit;
+    if (setjmp(jerr.jump))
+    {
+        (*cinfo.err->format_message)((j_common_ptr) &cinfo, message);
+        jpeg_destroy_compress(&cinfo);
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_COMPRESSION,
+                         "JPEG compression failed: %s", message);
+        return NITF_FAILURE;
+    }
+    jpeg_create_compress(&cinfo);
+
+    dest.pub.init_destination = JPEGInitDestination;
+    dest.pub.empty_output_buffer = JPEGEmptyOutputBuffer;
+    dest.pub.term_destination = JPEGTermDestination;
+    dest.slot = slot;
+    cinfo.dest = &dest.pub;
+
+    cinfo.image_width = implControl->numColsPerBlock;
+    cinfo.image_height = implControl->numRowsPerBlock;
+    cinfo.input_components = implControl->numComponents;
+    cinfo.in_color_space = implControl->colorSpace;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, implControl->quality, TRUE);
+    cinfo.restart_interval = implControl->restartInterval;
+
+    jpeg_start_compress(&cinfo, TRUE);
+    rowLength = (size_t) implControl->numColsPerBlock *
+        implControl->numComponents;
+    while (cinfo.next_scanline < cinfo.image_height)
+    {
+        row = (JSAMPROW) (slot->data + cinfo.next_scanline * rowLength);
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+    return NITF_SUCCESS;
+}
+
+/*!
+ *  Encode blocks of the batch until there are none left
+ */
+NITFPRIV(void) encodeBatch(JPEGImplControl* implControl,
+                           JPEGCompressBatch* batch)
+{
+    nitf_Uint32 i;
+    nitf_Error error;
+
+    for (;;)
+    {
+        nitf_Mutex_lock(&(implControl->lock));
+        if (batch->failed || batch->next >= batch->count)
+        {
+            nitf_Mutex_unlock(&(implControl->lock));
+            break;
+        }
+        i = batch->next++;
+        nitf_Mutex_unlock(&(implControl->lock));
+
+        if (!encodeBlock(implControl, &(batch->slots[i]), &error))
+        {
+            nitf_Mutex_lock(&(implControl->lock));
+            if (!batch->failed)
+            {
+                batch->failed = 1;
+                batch->error = error;
+            }
+            nitf_Mutex_unlock(&(implControl->lock));
+        }
+    }
+}
+
+/*!
+ *  Worker thread, encode each batch given to the workers until they are
+ *  stopped
+ */
+NITFPRIV(NRT_DATA *) runWorker(NRT_DATA * data)
+{
+    JPEGCompressWorker* worker = (JPEGCompressWorker*) data;
+    JPEGImplControl* implControl = worker->control;
+    JPEGCompressBatch* batch;
+
+    nitf_Mutex_lock(&(implControl->workerLock));
+    for (;;)
+    {
+        while (!implControl->stopWorkers &&
+               worker->jobSerial == implControl->jobSerial)
+            nitf_Condition_wait(&(implControl->workReady),
+                                &(implControl->workerLock));
+        if (implControl->stopWorkers)
+            break;
+
+        worker->jobSerial = implControl->jobSerial;
+        batch = implControl->job;
+        nitf_Mutex_unlock(&(implControl->workerLock));
+
+        encodeBatch(implControl, batch);
+
+        nitf_Mutex_lock(&(implControl->workerLock));
+        implControl->jobWorkers -= 1;
+        if (implControl->jobWorkers == 0)
+            nitf_Condition_broadcast(&(implControl->workDone));
+    }
+    nitf_Mutex_unlock(&(implControl->workerLock));
+    return NULL;
+}
+
+/*!
+ *  Start the worker threads, once. A thread that cannot be started is not
+ *  an error, the batches are encoded by the ones that did start (or by
+ *  the caller if none did)
+ */
+NITFPRIV(void) startWorkers(JPEGImplControl* implControl)
+{
+    nitf_Error threadError;
+    nitf_Uint32 i;
+
+    if (implControl->workersTried)
+        return;
+    implControl->workersTried = 1;
+
+    for (i = 0; i < implControl->numThreads; ++i)
+    {
+        JPEGCompressWorker* worker = &(implControl->workers[i]);
+
+        worker->control = implControl;
+        worker->jobSerial = implControl->jobSerial;
+        if (!nitf_Thread_create(&(worker->thread), runWorker, worker,
+                                &threadError))
+            break;
+        implControl->numRunning += 1;
+    }
+}
+
+/*!
+ *  Stop the worker threads, they finish the batch they are on first
+ */
+NITFPRIV(void) destroyWorkers(JPEGImplControl* implControl)
+{
+    nitf_Uint32 i;
+
+    nitf_Mutex_lock(&(implControl->workerLock));
+    implControl->stopWorkers = 1;
+    nitf_Condition_broadcast(&(implControl->workReady));
+    nitf_Mutex_unlock(&(implControl->workerLock));
+    for (i = 0; i < implControl->numRunning; ++i)
+        nitf_Thread_join(&(implControl->workers[i].thread));
+    implControl->numRunning = 0;
+}
+
+/*!
+ *  Start encoding a full batch. With more than one thread the workers run
+ *  in the background (see finishBatch), otherwise the batch is encoded now
+ */
+NITFPRIV(NITF_BOOL) startBatch(JPEGImplControl* implControl,
+                               JPEGCompressBatch* batch,
+                               nitf_Error* error)
+{
+    (void) error;
+
+    batch->next = 0;
+    batch->failed = 0;
+    batch->running = 1;
+
+    if (implControl->numThreads > 1 && batch->count > 1)
+        startWorkers(implControl);
+
+    /* One thread, or no thread could be started, work here */
+    if (implControl->numRunning == 0 || batch->count == 1)
+    {
+        encodeBatch(implControl, batch);
+        return NITF_SUCCESS;
+    }
+
+    nitf_Mutex_lock(&(implControl->workerLock));
+    implControl->job = batch;
+    implControl->jobSerial += 1;
+    implControl->jobWorkers = implControl->numRunning;
+    nitf_Condition_broadcast(&(implControl->workReady));
+    nitf_Mutex_unlock(&(implControl->workerLock));
+    return NITF_SUCCESS;
+}
+
+/*!
+ *  Wait for the batch to be encoded and write its blocks to the file,
+ *  setting their block mask entries
+ */
+NITFPRIV(NITF_BOOL) finishBatch(JPEGImplControl* implControl,
+                                JPEGCompressBatch* batch,
+                                nitf_IOInterface* io,
+                                nitf_Error* error)
+{
+    nitf_Uint32 i;
+
+    if (!batch->running)
+        return NITF_SUCCESS;
+
+    /* Wait for the workers if the batch was given to them */
+    nitf_Mutex_lock(&(implControl->workerLock));
+    if (implControl->job == batch)
+    {
+        while (implControl->jobWorkers > 0)
+            nitf_Condition_wait(&(implControl->workDone),
+                                &(implControl->workerLock));
+        implControl->job = NULL;
+    }
+    nitf_Mutex_unlock(&(implControl->workerLock));
+    batch->running = 0;
+
+    if (batch->failed)
+    {
+        *error = batch->error;
+        return NITF_FAILURE;
+    }
+
+    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(io,
+                                               implControl->offset +
+                                               implControl->written,
+                                               NITF_SEEK_SET, error)))
+        return NITF_FAILURE;
+
+    for (i = 0; i < batch->count; ++i)
+    {
+        JPEGCompressSlot* slot = &(batch->slots[i]);
+
+        if (!nitf_IOInterface_write(io, (const char*) slot->output,
+                                    slot->length, error))
+            return NITF_FAILURE;
+
+        if (implControl->masked)
+        {
+            implControl->blockMask[slot->blockNumber] = implControl->written;
+            if (slot->pad)
+                implControl->padMask[slot->blockNumber] =
+                    implControl->written;
+        }
+        implControl->written += slot->length;
+    }
+    batch->count = 0;
+    return NITF_SUCCESS;
+}
+
+/*!
+ *  Get an unsigned option, def if the option is not set
+ */
+NITFPRIV(nitf_Uint32) getOption(nrt_HashTable* options, const char* key,
+                                nitf_Uint32 def)
+{
+    nrt_Pair* pair;
+
+    if (options == NULL)
+        return def;
+    pair = nrt_HashTable_find(options, key);
+    if (pair == NULL || pair->data == NULL)
+        return def;
+    return *((nitf_Uint32*) pair->data);
+}
+
+NITFPRIV(nitf_CompressionControl*) implOpen(nitf_ImageSubheader* subheader,
+                                            nrt_HashTable* options,
+                                            nitf_Error* error)
+{
+    JPEGImplControl* implControl = NULL;
+    nitf_Uint32 numRows;
+    nitf_Uint32 numCols;
+    nitf_Uint32 numRowsPerBlock;
+    nitf_Uint32 numColsPerBlock;
+    nitf_Uint32 numBlocksPerRow;
+    nitf_Uint32 numBlocksPerCol;
+    nitf_Uint32 numBands;
+    nitf_Uint32 nbpp;
+    nitf_Uint32 quality;
+    nitf_Uint32 batchSize;
+    nitf_Uint32 i;
+    char imode[NITF_IMODE_SZ + 1];
+    char pvtype[NITF_PVTYPE_SZ + 1];
+    char compression[NITF_IC_SZ + 1];
+    char compressionRate[NITF_COMRAT_SZ + 1];
+
+    if (!nitf_ImageSubheader_getBlocking(subheader, &numRows, &numCols,
+                                         &numRowsPerBlock, &numColsPerBlock,
+                                         &numBlocksPerRow, &numBlocksPerCol,
+                                         imode, error))
+        return NULL;
+    if (!nitf_ImageSubheader_getCompression(subheader, compression,
+                                            compressionRate, error))
+        return NULL;
+    if (0 == (numBands = nitf_ImageSubheader_getBandCount(subheader, error)))
+        return NULL;
+    if (!nitf_Field_get(subheader->NITF_NBPP, &nbpp, NITF_CONV_INT,
+                        sizeof(nitf_Uint32), error))
+        return NULL;
+    if (!nitf_Field_get(subheader->NITF_PVTYPE, pvtype, NITF_CONV_STRING,
+                        NITF_PVTYPE_SZ + 1, error))
+        return NULL;
+    nitf_Field_trimString(pvtype);
+
+    if (nbpp != 8 || strcmp(pvtype, "INT") != 0)
+    {
+        nitf_Error_init(error,
+                "For JPEG compression, NBPP must be 8 and PVTYPE must be INT",
+                NITF_CTXT, NITF_ERR_COMPRESSION);
+        return NULL;
+    }
+
+    /*
+     *  Each block is one single band JPEG image. Three band RGB would need
+     *  the pixel interleaved (IMODE P) write path, which does not support
+     *  compression
+     */
+    if (numBands != 1)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_COMPRESSION,
+                         "JPEG compression of %u bands is not supported "
+                         "(the image must have one band)", numBands);
+        return NULL;
+    }
+
+    quality = getOption(options, C3_QUALITY_KEY, DEFAULT_QUALITY);
+    if (quality < 1 || quality > 100)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_COMPRESSION,
+                         "Invalid JPEG quality %u (must be 1 - 100)",
+                         quality);
+        return NULL;
+    }
+
+    /* The quantization tables are in the data, not the NITF defaults */
+    if (compressionRate[0] == '\0')
+    {
+        if (!nitf_Field_setString(subheader->NITF_COMRAT, "00.0", error))
+            return NULL;
+    }
+
+    implControl = (JPEGImplControl*) NITF_MALLOC(sizeof(JPEGImplControl));
+    if (implControl == NULL)
+    {
+        nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NULL;
+    }
+    memset(implControl, 0, sizeof(JPEGImplControl));
+    nitf_Mutex_init(&(implControl->lock));
+    nitf_Mutex_init(&(implControl->workerLock));
+    nitf_Condition_init(&(implControl->workReady));
+    nitf_Condition_init(&(implControl->workDone));
+
+    implControl->numRowsPerBlock = numRowsPerBlock;
+    implControl->numColsPerBlock = numColsPerBlock;
+    implControl->numComponents = numBands;
+    implControl->colorSpace = JCS_GRAYSCALE;
+    implControl->quality = (int) quality;
+    implControl->restartInterval =
+        getOption(options, C3_RESTART_INTERVAL_KEY, 0);
+    implControl->blockSize = (size_t) numRowsPerBlock * numColsPerBlock *
+        implControl->numComponents;
+    implControl->masked = (compression[0] == 'M');
+    implControl->numBlocks = numBlocksPerRow * numBlocksPerCol;
+
+    implControl->numThreads = getOption(options, C3_NUM_THREADS_KEY, 0);
+    if (implControl->numThreads == 0)
+        implControl->numThreads = (nitf_Uint32) nitf_Thread_getNumCPUs();
+
+    /* Keep every thread busy, within the memory limit */
+    batchSize = implControl->numThreads * BLOCKS_PER_THREAD;
+    if ((nitf_Uint64) batchSize * implControl->blockSize > MAX_BATCH_SIZE)
+        batchSize = (nitf_Uint32) (MAX_BATCH_SIZE / implControl->blockSize);
+    if (batchSize == 0)
+        batchSize = 1;
+    if (implControl->numThreads == 1)
+        batchSize = 1;
+    implControl->batchSize = batchSize;
+
+    implControl->workers = (JPEGCompressWorker*)
+        NITF_MALLOC(implControl->numThreads * sizeof(JPEGCompressWorker));
+    if (implControl->workers == NULL)
+        goto MEMORY_ERROR;
+    memset(implControl->workers, 0,
+           implControl->numThreads * sizeof(JPEGCompressWorker));
+
+    for (i = 0; i < 2; ++i)
+    {
+        JPEGCompressBatch* batch = &(implControl->batches[i]);
+        nitf_Uint32 j;
+
+        batch->slots = (JPEGCompressSlot*)
+            NITF_MALLOC(batchSize * sizeof(JPEGCompressSlot));
+        if (batch->slots == NULL)
+            goto MEMORY_ERROR;
+        memset(batch->slots, 0, batchSize * sizeof(JPEGCompressSlot));
+
+        for (j = 0; j < batchSize; ++j)
+        {
+            JPEGCompressSlot* slot = &(batch->slots[j]);
+
+            slot->outputSize = implControl->blockSize / 4;
+            if (slot->outputSize < MIN_OUTPUT_SIZE)
+                slot->outputSize = MIN_OUTPUT_SIZE;
+            slot->data = (nitf_Uint8*) NITF_MALLOC(implControl->blockSize);
+            slot->output = (nitf_Uint8*) NITF_MALLOC(slot->outputSize);
+            if (slot->data == NULL || slot->output == NULL)
+                goto MEMORY_ERROR;
+        }
+    }
+
+    return (nitf_CompressionControl*) implControl;
+
+MEMORY_ERROR:
+    nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
+                    NITF_CTXT, NITF_ERR_MEMORY);
+    implDestroy((nitf_CompressionControl**) &implControl);
+    return NULL;
+}
+
+NITFPRIV(NITF_BOOL) implStart(nitf_CompressionControl* control,
+                              nitf_Uint64 offset,
+                              nitf_Uint64 dataLength,
+                              nitf_Uint64* blockMask,
+                              nitf_Uint64* padMask,
+                              nitf_Error* error)
+{
+    JPEGImplControl* implControl = (JPEGImplControl*) control;
+
+    (void) dataLength;
+    (void) error;
+
+    implControl->offset = offset;
+    implControl->written = 0;
+    implControl->blockMask = blockMask;
+    implControl->padMask = padMask;
+    implControl->nextBlock = 0;
+    implControl->current = 0;
+
+    /* The masks are only needed (and only correct) for M3 */
+    if (blockMask == NULL || padMask == NULL)
+        implControl->masked = 0;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) implWriteBlock(nitf_CompressionControl* control,
+                                   nitf_IOInterface* io,
+                                   const nitf_Uint8* data,
+                                   NITF_BOOL pad,
+                                   NITF_BOOL noData,
+                                   nitf_Error* error)
+{
+    JPEGImplControl* implControl = (JPEGImplControl*) control;
+    JPEGCompressBatch* batch;
+    JPEGCompressSlot* slot;
+    nitf_Uint32 blockNumber = 0;
+
+    /*
+     *  The blocks arrive in order. Missing blocks of a masked image have
+     *  already been marked in the block mask (and are not passed here), so
+     *  this block goes in the next entry that is not marked
+     */
+    if (implControl->masked)
+    {
+        while (implControl->nextBlock < implControl->numBlocks &&
+               implControl->blockMask[implControl->nextBlock] ==
+               NITF_IMAGE_IO_NO_BLOCK)
+            implControl->nextBlock++;
+        if (implControl->nextBlock >= implControl->numBlocks)
+        {
+            nitf_Error_init(error, "Too many blocks for JPEG compression",
+                            NITF_CTXT, NITF_ERR_COMPRESSION);
+            return NITF_FAILURE;
+        }
+        blockNumber = implControl->nextBlock++;
+
+        if (noData)
+        {
+            implControl->blockMask[blockNumber] = NITF_IMAGE_IO_NO_BLOCK;
+            implControl->padMask[blockNumber] = NITF_IMAGE_IO_NO_BLOCK;
+            return NITF_SUCCESS;
+        }
+    }
+
+    batch = &(implControl->batches[implControl->current]);
+    slot = &(batch->slots[batch->count++]);
+    memcpy(slot->data, data, implControl->blockSize);
+    slot->blockNumber = blockNumber;
+    slot->pad = pad;
+
+    if (batch->count < implControl->batchSize)
+        return NITF_SUCCESS;
+
+    /* Write the batch encoded meanwhile and start on this one */
+    if (!finishBatch(implControl,
+                     &(implControl->batches[1 - implControl->current]),
+                     io, error))
+        return NITF_FAILURE;
+    if (!startBatch(implControl, batch, error))
+        return NITF_FAILURE;
+    implControl->current = 1 - implControl->current;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) implEnd(nitf_CompressionControl* control,
+                            nitf_IOInterface* io,
+                            nitf_Error* error)
+{
+    JPEGImplControl* implControl = (JPEGImplControl*) control;
+    JPEGCompressBatch* batch;
+
+    /* The batch being encoded, then the partial batch */
+    if (!finishBatch(implControl,
+                     &(implControl->batches[1 - implControl->current]),
+                     io, error))
+        return NITF_FAILURE;
+
+    batch = &(implControl->batches[implControl->current]);
+    if (batch->count > 0)
+    {
+        if (!startBatch(implControl, batch, error) ||
+            !finishBatch(implControl, batch, io, error))
+            return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(void) implDestroy(nitf_CompressionControl** control)
+{
+    JPEGImplControl* implControl;
+    nitf_Uint32 i;
+    nitf_Uint32 j;
+
+    if (control == NULL || *control == NULL)
+        return;
+    implControl = (JPEGImplControl*) *control;
+
+    if (implControl->workers != NULL)
+    {
+        destroyWorkers(implControl);
+        NITF_FREE(implControl->workers);
+    }
+
+    for (i = 0; i < 2; ++i)
+    {
+        JPEGCompressBatch* batch = &(implControl->batches[i]);
+
+        if (batch->slots == NULL)
+            continue;
+        for (j = 0; j < implControl->batchSize; ++j)
+        {
+            if (batch->slots[j].data != NULL)
+                NITF_FREE(batch->slots[j].data);
+            if (batch->slots[j].output != NULL)
+                NITF_FREE(batch->slots[j].output);
+        }
+        NITF_FREE(batch->slots);
+    }
+
+    nitf_Condition_delete(&(implControl->workDone));
+    nitf_Condition_delete(&(implControl->workReady));
+    nitf_Mutex_delete(&(implControl->workerLock));
+    nitf_Mutex_delete(&(implControl->lock));
+    NITF_FREE(implControl);
+    *control = NULL;
+}
@@ -26,12 +26,8 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <ctype.h>
-#ifdef WIN32
-    #include <Winsock2.h>
-#else
-    #include <netinet/in.h>
-#endif
 #define _BLOCK_SIZE(BLOCK) (BLOCK->rows * BLOCK->cols * BLOCK->bands)
 
 /* borrowed from ImageIO.c */
@@ -40,6 +36,7 @@
 #endif
 
 #define INPUT_BUF_SIZE  4096
+#define SCAN_BUF_SIZE   65536
 
 /*
       Zero Block enable
@@ -142,71 +139,6 @@ static int Q5[] =
         16,  14,  20,  21,  20,  27,  27,  36
     };
 
-typedef struct _JPEGMarkerItem
-{
-    char name[4];
-    nitf_Off off;
-    nitf_Uint32 block;
-
-}
-JPEGMarkerItem;
-
-NITFPRIV(JPEGMarkerItem*) JPEGMarkerItem_construct(nitf_Error* error)
-{
-    JPEGMarkerItem* item = (JPEGMarkerItem*)NITF_MALLOC(sizeof(JPEGMarkerItem));
-    if (! item )
-    {
-        nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
-                NITF_CTXT, NITF_ERR_DECOMPRESSION);
-        return NULL;
-    }
-    memset(item->name, 0, 4);
-    item->off = 0;
-    return item;
-}
-
-/* not used - the list destructor will NITF_FREE these */
-NITFPRIV(void) JPEGMarkerItem_destruct(JPEGMarkerItem** item)
-{
-    if (*item)
-    {
-        NITF_FREE( *item );
-        *item = NULL;
-    }
-}
-
-/* Added for diagnostics */
-
-NITFPRIV(void) JPEGMarkerItem_print(
-        JPEGMarkerItem* item, FILE *file)
-{
-    if (file == NULL)
-    {
-        file = stdout;
-    }
-
-    fprintf(file, "JPEG Marker: %s %lld\n", item->name, (long long)item->off);
-    return;
-}
-
-NITFPRIV(void) JPEGMarkerItem_printList(
-        nitf_List* markerList, FILE *file)
-{
-    nitf_ListIterator x; /* Iterator for walking list */
-    nitf_ListIterator end; /* End of list iterator */
-    JPEGMarkerItem* item; /* Current marker */
-
-    end = nitf_List_end(markerList);
-    for (x = nitf_List_begin(markerList);
-            nitf_ListIterator_notEqualTo(&x, &end);
-            nitf_ListIterator_increment(&x))
-    {
-        item = (JPEGMarkerItem*)nitf_ListIterator_get(&x);
-        JPEGMarkerItem_print(item, file);
-    }
-    return;
-}
-
 /*!
  *  This is called by the ImageIO controller whenever it is necessary to
  *  delete a block.  It is implemented as a counter function to
@@ -237,7 +169,8 @@ NITFPRIV(nitf_DecompressionControl*) implOpen(nitf_ImageSubheader* subheader,
  *  \param fileLength  The length of the image segment
  *  \param blockInfo A structure containing the blocking information
  *  \param blockMask The structure containing the block mask (if
- *  any exists).  This parameter is currently ignored.
+ *  any exists).  Blocks marked as missing are skipped and, for a masked
+ *  image, the mask gives the block offsets.
  *  \param error An error which will be populated on failure
  *  \return NULL on failure, an opaque pointer on success
  */
@@ -308,8 +241,16 @@ typedef nitf_Uint8* DATA_BUFFER;
  *  the decompression control.
  *
  *  \ar io The io handle (provided when we opened the interface)
- *  \ar markerList A list of SOI markers which we need to read blocks out
- *  of order
+ *  \ar blockOffsets The file offset of the SOI marker of each block, or
+ *  -1 if the block is not in the file, so blocks can be read out of order
+ *  \ar numBlocks The number of blocks (entries in blockOffsets)
+ *  \ar masked  Set if the image is masked (M3), the block mask then gives
+ *  the block offsets
+ *  \ar scale  Reduction factor of the decoded blocks (1, 2, 4 or 8), from
+ *  the NITF_DECOMPRESSION_SCALE_KEY option
+ *  \ar shared  A started control for the same image, from the
+ *  NITF_DECOMPRESSION_SHARED_KEY option, whose block offsets are copied
+ *  by the start function instead of scanning the data again
  *  \ar quantTable  Quantization table (currently not used)
  *  \ar length  The length of the block in bytes
  *
@@ -320,7 +261,11 @@ typedef nitf_Uint8* DATA_BUFFER;
 typedef struct _JPEGImplControl
 {
     nitf_IOInterface* ioInterface;
-    nitf_List*        markerList;
+    nitf_Off*         blockOffsets;
+    nitf_Uint32       numBlocks;
+    NITF_BOOL         masked;
+    nitf_Uint32       scale;
+    struct _JPEGImplControl* shared;
     int*              quantTable;
     nitf_Uint32       length;       /* Total length of the block in bytes */
 }
@@ -488,473 +433,286 @@ NITFPRIV(int) implFreeBlock(nitf_DecompressionControl* control,
     return 1;
 }
 
-typedef enum _JPEGMarker
-{
-    JPEG_NOT_MARKER,
-    JPEG_MARKER_ERROR,
-    JPEG_MARKER_FF_OCCURS_NATURALLY,
-    JPEG_MARKER_SOI,
-    JPEG_MARKER_DECL_QUANT_TABLE,
-    JPEG_MARKER_DECL_HUFF_TABLE,
-    JPEG_MARKER_SOF,
-    JPEG_MARKER_SOS,
-    JPEG_MARKER_COMMENT,
-    JPEG_MARKER_EOI,
-    JPEG_MARKER_APP6,
-    JPEG_MARKER_APP7,
-    JPEG_MARKER_DONT_CARE,
-} JPEGMarker;
-
-NITFPRIV(NITF_BOOL) readByte(nitf_IOInterface* io,
-        unsigned char* b,
-        nitf_Error* error)
+/*!
+ *  \struct JPEGScanner
+ *  \brief Buffered reader used to find the start of each block
+ *
+ *  The compressed data is searched for marker prefixes (0xFF) with memchr,
+ *  a buffer at a time, rather than a byte at a time. If the IO interface
+ *  holds the data in memory (see nitf_IOInterface_getBuffer), the data is
+ *  searched in place. Otherwise it is read in SCAN_BUF_SIZE pieces with
+ *  positional reads.
+ *
+ *  \ar io  The io handle
+ *  \ar data  The current piece of data
+ *  \ar buffer  The read buffer (NULL if the data is searched in place)
+ *  \ar base  The file offset of the first byte of data
+ *  \ar length  The number of bytes in data
+ *  \ar pos  The index in data of the next byte
+ *  \ar end  The file offset of the end of the compressed data
+ *  \ar failed  Set if a read failed (the error is set)
+ */
+typedef struct _JPEGScanner
 {
-    return nitf_IOInterface_read(io, (NITF_DATA *) b, 1, error);
+    nitf_IOInterface* io;
+    const nitf_Uint8* data;
+    nitf_Uint8*       buffer;
+    nitf_Off          base;
+    size_t            length;
+    size_t            pos;
+    nitf_Off          end;
+    NITF_BOOL         failed;
 }
+JPEGScanner;
 
-NITFPRIV(NITF_BOOL) readShort(nitf_IOInterface* io,
-        nitf_Uint16* native,
-        nitf_Error* error)
+/*
+   Start the scan at offset. The data is used in place if it is in
+   memory, otherwise the read buffer is allocated and the first piece is
+   read on demand.
+*/
+NITFPRIV(NITF_BOOL) JPEGScanner_init(JPEGScanner* scanner,
+                                     nitf_IOInterface* io,
+                                     nitf_Uint64 offset,
+                                     nitf_Uint64 fileLength,
+                                     nitf_Error* error)
 {
-    nitf_Uint16 raw;
-    if (!nitf_IOInterface_read(io, (char*)&raw, 2, error))
+    scanner->io = io;
+    scanner->data = NULL;
+    scanner->buffer = NULL;
+    scanner->base = (nitf_Off) offset;
+    scanner->length = 0;
+    scanner->pos = 0;
+    scanner->end = (nitf_Off) (offset + fileLength);
+    scanner->failed = 0;
+
+    if (fileLength <= (nitf_Uint64) ((size_t) -1))
     {
-        return NITF_FAILURE;
+        scanner->data = (const nitf_Uint8*)
+            nitf_IOInterface_getBuffer(io, (nitf_Off) offset,
+                                       (size_t) fileLength);
     }
-    *native = ntohs(raw);
-    return NITF_SUCCESS;
-}
-
-NITFPRIV(int) readMarker(nitf_IOInterface* io, nitf_Error* error)
-{
-    int markerEnum = JPEG_MARKER_ERROR;
-    unsigned char native = 0x0000;
-    if (readByte(io, &native, error) )
+    if (scanner->data != NULL)
     {
-        switch (native)
-        {
-        case 0x00:
-            markerEnum = JPEG_MARKER_FF_OCCURS_NATURALLY;
-            break;
-
-        case 0xD8:
-            markerEnum = JPEG_MARKER_SOI;
-            break;
-
-        case 0xD9:
-            markerEnum = JPEG_MARKER_EOI;
-            break;
-
-        case 0xDB:
-            markerEnum = JPEG_MARKER_DECL_QUANT_TABLE;
-            break;
-
-        case 0xC4:
-            markerEnum = JPEG_MARKER_DECL_HUFF_TABLE;
-            break;
-
-        case 0xC0:
-            markerEnum = JPEG_MARKER_SOF;
-            break;
-
-        case 0xDA:
-            markerEnum = JPEG_MARKER_SOS;
-            break;
-
-        case 0xFE:
-            markerEnum = JPEG_MARKER_COMMENT;
-            break;
-
-        case 0xE6:
-            markerEnum = JPEG_MARKER_APP6;
-            break;
-
-        case 0xE7:
-            markerEnum = JPEG_MARKER_APP7;
-            break;
-            /*
-            case 0xE9:
-            markerEnum = JPEG_MARKER_APP7;
-            break;
-            */
-        default:
-            markerEnum = JPEG_MARKER_DONT_CARE;
-        }
+        scanner->length = (size_t) fileLength;
+        return NITF_SUCCESS;
     }
-    /*  Then we already have an error!  */
-    return markerEnum;
-}
-
-
-NITFPRIV(NITF_BOOL) readSOI(nitf_IOInterface* io,
-        nitf_Uint64* bytesRead,
-        nitf_Error* error)
-{
-    unsigned char needFF;
-    int tokenType;
-
-    if (! readByte(io, &needFF, error) ) return NITF_FAILURE;
-    (*bytesRead)++;
 
-    if ( needFF != 0xFF )
+    scanner->buffer = (nitf_Uint8*) NITF_MALLOC(SCAN_BUF_SIZE);
+    if (scanner->buffer == NULL)
     {
-        nitf_Error_init(error,
-                "Missing mandatory APP6 marker indicator (FF)\n",
-                NITF_CTXT,
-                NITF_ERR_DECOMPRESSION);
-
+        nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
+                        NITF_CTXT, NITF_ERR_MEMORY);
         return NITF_FAILURE;
     }
-    tokenType = readMarker(io, error);
-    (*bytesRead)++;
-
-    if (tokenType == JPEG_MARKER_ERROR)
-    return NITF_FAILURE;
-
-    DPRINT("====================================\n");
-    DPRINT("Successful SOI read!\n");
-    DPRINT("====================================\n");
-
+    scanner->data = scanner->buffer;
     return NITF_SUCCESS;
 }
 
-/*
-    In order to get here, we must have read:
-    SOI, APP6, DQT
-
-NITFPRIV(NITF_BOOL) readSOF(nitf_IOInterface* io,
-                            nitf_Uint64* bytesRead,
-                            nitf_Error* error)
+NITFPRIV(void) JPEGScanner_release(JPEGScanner* scanner)
 {
-
-    char precision;
-    char nf;
-    nitf_Uint16 x;
-    nitf_Uint16 y;
-    nitf_Uint16 numBytesInHdr;
-    if (! readShort(io, &numBytesInHdr, error) )
-        return NITF_FAILURE;
-
-    (*bytesRead) += numBytesInHdr;
-    DPRINTA1("SOF: Header length: [%d]\n", numBytesInHdr);
-    numBytesInHdr -= 2;
-
-
-
-    nitf_IOInterface_read(io, &precision, 1, error);
-
-    DPRINTA1("SOF: Precision (usually 8): %d\n", (int)precision);
-
-    if (! readShort(io, &x, error ) )
-        return NITF_FAILURE;
-
-    if (! readShort(io, &y, error ) )
-        return NITF_FAILURE;
-
-    DPRINTA2("SOF: Frame is %d x %d\n", y, x);
-
-    nitf_IOInterface_read(io, &nf, 1, error);
-    DPRINTA1("SOF: Number of components in image: [%d]\n", (int)nf);
-
+    if (scanner->buffer != NULL)
     {
-        int i;
-        char cid;
-        char hvSampleF;
-        char qTableNum;
-        for (i = 0; i < (int)nf; i++)
-        {
-            nitf_IOInterface_read(io, &cid, 1, error);
-            DPRINTA2("SOF: Nf[%d]->cid [%x]: \n", i, (int)cid);
-            nitf_IOInterface_read(io, &hvSampleF, 1, error);
-            DPRINTA2("SOF: Nf[%d]->hvSampleF: [%x]\n", i, (int)hvSampleF);
-            nitf_IOInterface_read(io, &qTableNum, 1, error);
-            DPRINTA2("SOF: Nf[%d]->qTableNum: [%x]\n", i, (int)qTableNum);
-        }
+        NITF_FREE(scanner->buffer);
+        scanner->buffer = NULL;
     }
-
-    DPRINT("Successful SOF read!\n");
-    return NITF_SUCCESS;
 }
 
-*/
-
 /*
-    In order to get here, we must have read:
-    SOI, APP6, DQT, SOF0, DHT
+   Move to the next piece of data. Returns FALSE at the end of the data
+   or if the read fails (the failed flag is set).
 */
-NITFPRIV(NITF_BOOL) readSOS(nitf_IOInterface* io,
-                            nitf_Uint64* bytesRead,
-                            nitf_Error* error)
+NITFPRIV(NITF_BOOL) JPEGScanner_fill(JPEGScanner* scanner, nitf_Error* error)
 {
+    nitf_Off left;
 
-    /*  Need to read bytes in header  */
-    nitf_Uint16 numBytesInHdr;
-    /*  If this isnt happening, throw up  */
-    if (! readShort(io, &numBytesInHdr, error) )
+    scanner->base += (nitf_Off) scanner->length;
+    scanner->pos = 0;
+    scanner->length = 0;
+    if (scanner->buffer == NULL || scanner->base >= scanner->end)
         return NITF_FAILURE;
-    /*  Print  now     */
-    DPRINTA1("SOS: Header length: [%d]\n", numBytesInHdr);
-    /*  Markup now     */
-    (*bytesRead) += numBytesInHdr;
-    /*  Normalize now  */
-    numBytesInHdr -= 2;
-    /*  Skip for now   */
-    if (!  NITF_IO_SUCCESS(nitf_IOInterface_seek(io,
-                                                 numBytesInHdr,
-                                                 NITF_SEEK_CUR,
-                                                 error)))
-        return NITF_FAILURE;
-    /*  Be happy now   */
-    DPRINT("Successful SOS read!\n");
-    /*  Return success */
-    return NITF_SUCCESS;
-}
-/*
-    In order to get here, we must have read:
-    SOI, APP6, DQT, SOF0
-*/
-
 
-NITFPRIV(NITF_BOOL) readHuffTable(nitf_IOInterface* io,
-                                  nitf_Uint64* bytesRead,
-                                  nitf_Error* error)
-{
-    /*  Need to read a header length */
-    nitf_Uint16 numBytesInHdr;
-    /*  Read it or die  */
-    if (! readShort(io, &numBytesInHdr, error) )
-        return NITF_FAILURE;
-    /*  Print now  */
-    DPRINTA1("Huff Table: Header length: [%d]\n", numBytesInHdr);
-    /*  Markup now */
-    (*bytesRead) += numBytesInHdr;
-    /*  Adjust for what we have read already  */
-    numBytesInHdr -= 2;
-
-    if (! NITF_IO_SUCCESS(nitf_IOInterface_seek(io,
-                                                numBytesInHdr,
-                                                NITF_SEEK_CUR,
-                                                error)))
+    left = scanner->end - scanner->base;
+    scanner->length = left > SCAN_BUF_SIZE ? SCAN_BUF_SIZE : (size_t) left;
+    if (!nitf_IOInterface_readAt(scanner->io, scanner->base,
+                                 scanner->buffer, scanner->length, error))
+    {
+        scanner->length = 0;
+        scanner->failed = 1;
         return NITF_FAILURE;
-
-    /*  Rejoice!  */
-    DPRINT("Successful Huff Table read!\n");
-    /*  Return!  */
+    }
     return NITF_SUCCESS;
 }
 
-NITFPRIV(NITF_BOOL) readQuantTable(nitf_IOInterface* io,
-                                   nitf_Uint64* bytesRead,
-                                   nitf_Error* error)
+/*
+   Get the next byte, or -1 at the end of the data
+*/
+NITFPRIV(int) JPEGScanner_getByte(JPEGScanner* scanner, nitf_Error* error)
 {
-    /*  Declare something to read into  */
-    nitf_Uint16 numBytesInHdr;
-    /*  Now start reading... */
-    if (! readShort(io, &numBytesInHdr, error) )
-        return NITF_FAILURE;
-
-    /*  Print now   */
-    DPRINTA1("Quant Table: Header length: [%d]\n", numBytesInHdr);
-    /*  Markup now  */
-    (*bytesRead) += numBytesInHdr;
-
-    /*  Adjust now  */
-    numBytesInHdr -= 2;
-
-    if (! NITF_IO_SUCCESS(nitf_IOInterface_seek(io,
-                                                numBytesInHdr,
-                                                NITF_SEEK_CUR,
-                                                error)))
-        return NITF_FAILURE;
-
-    /*  Celebrate  */
-    DPRINT("Successful Quant Table read!\n");
-    /*  Go Home    */
-    return NITF_SUCCESS;
+    if (scanner->pos == scanner->length && !JPEGScanner_fill(scanner, error))
+        return -1;
+    return scanner->data[scanner->pos++];
 }
 
 /*
-   This method is currently used to push a marker and its
-   respective offset onto our list.
+   Skip count bytes. Returns FALSE if this runs past the end of the data
 */
-
-NITFPRIV(NITF_BOOL) pushMarker(nitf_List* markerList,
-                               const char* name,
-                               off_t where,
-                               nitf_Error* error)
+NITFPRIV(NITF_BOOL) JPEGScanner_skip(JPEGScanner* scanner,
+                                     nitf_Uint32 count,
+                                     nitf_Error* error)
 {
-    JPEGMarkerItem* item = JPEGMarkerItem_construct(error);
-    strcpy(item->name,  name);
-    item->off = where;
-    if (!item) return NITF_FAILURE;
-    if (!nitf_List_pushBack(markerList, item, error) )
-        return NITF_FAILURE;
-    return  NITF_SUCCESS;
+    while (count > scanner->length - scanner->pos)
+    {
+        count -= (nitf_Uint32) (scanner->length - scanner->pos);
+        scanner->pos = scanner->length;
+        if (!JPEGScanner_fill(scanner, error))
+            return NITF_FAILURE;
+    }
+    scanner->pos += count;
+    return NITF_SUCCESS;
 }
 
 /*
-  This gets called (for now) when we open the interface.
-  We then begin to apply that information later.
-
-  This is basically a book-keeping function (and not a
-  terribly efficient one at that...)
-
+   Find the SOI marker of each block and record its offset in the block
+   offset table. The blocks are in block order, blocks that are not in the
+   file (blockMask entry NITF_IMAGE_IO_NO_BLOCK) are skipped.
+
+   Marker segments with a length field (tables, headers, comments and
+   application data) are skipped as a unit so that their contents are
+   never mistaken for markers. In the entropy coded data, a 0xFF byte can
+   only be followed by a stuffed zero or a restart marker, so the search
+   resumes after those. The scan stops once every block has been found.
 */
-NITFPRIV(NITF_BOOL) scanOffsets(nitf_IOInterface* io,
-                                nitf_List* markerList,
+NITFPRIV(NITF_BOOL) scanOffsets(JPEGImplControl* implControl,
+                                nitf_IOInterface* io,
+                                nitf_Uint64 offset,
                                 nitf_Uint64 fileLength,
+                                nitf_Uint64* blockMask,
                                 nitf_Error* error)
 {
+    JPEGScanner scanner;
+    nitf_Uint32 nextBlock = 0;
+    int marker;
+    int lengthHigh;
+    int lengthLow;
 
-    nitf_Uint64 bytesRead = 0;
+    if (!JPEGScanner_init(&scanner, io, offset, fileLength, error))
+        return NITF_FAILURE;
 
-    /*  Book keeping block  */
-    nitf_Uint64 origin = nitf_IOInterface_tell(io, error);
-    assert(NITF_IO_SUCCESS(origin));
-    /*  End book keeping block  */
     DPRINTA1("File length: %ld\n",  fileLength);
-    while (bytesRead < fileLength)
+    while (1)
     {
+        const nitf_Uint8* ff;
+
+        /* Skip blocks that are not in the file */
+        while (nextBlock < implControl->numBlocks &&
+               blockMask[nextBlock] == NITF_IMAGE_IO_NO_BLOCK)
+            ++nextBlock;
+        if (nextBlock == implControl->numBlocks)
+            break;
 
-        unsigned char b;
-        if (! readByte(io, &b, error) )
+        ff = (const nitf_Uint8*) memchr(scanner.data + scanner.pos, 0xFF,
+                                        scanner.length - scanner.pos);
+        if (ff == NULL)
         {
+            scanner.pos = scanner.length;
+            if (!JPEGScanner_fill(&scanner, error))
+                break;
+            continue;
+        }
+        scanner.pos = (size_t) (ff - scanner.data) + 1;
 
-            DPRINTA1("Read byte failed on byte %ld!\n", bytesRead);
-            goto CATCH_ERROR;
+        /* Any number of fill bytes (0xFF) may precede a marker */
+        do
+        {
+            marker = JPEGScanner_getByte(&scanner, error);
         }
-        ++bytesRead;
+        while (marker == 0xFF);
 
+        if (marker < 0)
+            break;
 
-        if (b == 0xFF )
+        if (marker == 0x00 || marker == 0x01 || marker == 0xD9 ||
+            (marker >= 0xD0 && marker <= 0xD7))
+            continue;  /* Stuffed byte, TEM, EOI or RSTn (no segment) */
+
+        if (marker == 0xD8)
         {
-            int tokenType;
-            tokenType = readMarker(io, error);
-            ++bytesRead;
-
-            if (tokenType == JPEG_MARKER_ERROR)
-            {
-                DPRINT("tokenType is JPEG_MARKER_ERROR\n");
-                goto CATCH_ERROR;
-            }
-
-            else if (tokenType == JPEG_MARKER_FF_OCCURS_NATURALLY)
-            {
-                /*printf("Found naturally occuring ff sequence!\n");*/
-            }
-            else
-            {
-                off_t where = nitf_IOInterface_tell(io, error);
-
-                nitf_Uint64 totalBytes = (fileLength - bytesRead) +
-                    (where - origin);
-                assert( fileLength == totalBytes);
-                switch (tokenType)
-                {
-                case JPEG_MARKER_EOI:
-                    if (! pushMarker(markerList, "EOI", where, error) )
-                    {
-                        DPRINT("Failure EOI (pushMarker)\n");
-                        goto CATCH_ERROR;
-                    }
-
-                    DPRINT("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
-                    DPRINT("Successful EOI!\n");
-                    DPRINT("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
-                    break;
-                    /*return NITF_SUCCESS;
-                     */
-                case JPEG_NOT_MARKER:
-                    break;
-
-                    /*  If it is the start of image, I want to read an APP6  */
-                case JPEG_MARKER_SOI:
-                    if (! pushMarker(markerList, "SOI", where, error) )
-                    {
-                        DPRINT("Failure SOI (pushMarker)\n");
-                        goto CATCH_ERROR;
-                    }
-
-                    if (!readSOI(io, &bytesRead, error))
-                    {
-                        DPRINT("Failure SOF (readSOI)\n");
-                        goto CATCH_ERROR;
-                    }
-
-                    break;
-
-                case JPEG_MARKER_SOS:
-                    if (! pushMarker(markerList, "SOS", where, error) )
-                    {
-                        DPRINT("Failure SOS (pushMarker)\n");
-                        goto CATCH_ERROR;
-                    }
-
-                    if (!readSOS(io, &bytesRead, error))
-                    {
-                        DPRINT("Failure SOS (readSOS)\n");
-                        goto CATCH_ERROR;
-                    }
-                    break;
-
-
-                case JPEG_MARKER_DECL_QUANT_TABLE:
-                    if (! pushMarker(markerList, "DQT", where, error) )
-                    {
-                        DPRINT("Failure DQT (pushMarker)\n");
-                        goto CATCH_ERROR;
-                    }
-
-                    if (!readQuantTable(io, &bytesRead, error))
-                    {
-                        DPRINT("Failure DQT (readQuantTable)\n");
-                        goto CATCH_ERROR;
-                    }
-                    break;
-
-                case JPEG_MARKER_DECL_HUFF_TABLE:
-                    if (! pushMarker(markerList, "DHT", where, error) )
-                    {
-                        DPRINT("Failure DHT (pushMarker)\n");
-                        goto CATCH_ERROR;
-                    }
-
-                    if (!readHuffTable(io, &bytesRead, error))
-                    {
-                        DPRINT("Failure DHT (readHuffTable)\n");
-                        goto CATCH_ERROR;
-                    }
-
-                    break;
-
-                case JPEG_MARKER_SOF:
-                    if (! pushMarker(markerList, "SOF", where, error) )
-                    {
-                        DPRINT("Failure SOF (pushMarker)\n");
-                        goto CATCH_ERROR;
-                    }
-
-                    /* if (!readSOF(io, error)) */
-                    /*       goto CATCH_ERROR; */
-                    break;
-                }
-            }
+            implControl->blockOffsets[nextBlock++] =
+                scanner.base + (nitf_Off) scanner.pos - 2;
+            continue;
         }
+
+        /* Skip the marker segment, its length includes the length field */
+        lengthHigh = JPEGScanner_getByte(&scanner, error);
+        lengthLow = JPEGScanner_getByte(&scanner, error);
+        if (lengthLow < 0)
+            break;
+        if (((lengthHigh << 8) | lengthLow) > 2 &&
+            !JPEGScanner_skip(&scanner,
+                              (nitf_Uint32) (((lengthHigh << 8) | lengthLow)
+                                             - 2), error))
+            break;
     }
+    JPEGScanner_release(&scanner);
+
+    if (scanner.failed)
+        return NITF_FAILURE;
 
     /*  Well this is what I wanted to happen, although I didnt have
-    the guts to ask for it in the while loop, since I have seen
-    some pretty unfortunate JPEGs in NITF files 
+    the guts to ask for it, since I have seen some pretty unfortunate
+    JPEGs in NITF files. The missing blocks are reported when read
     */
-    if (bytesRead != fileLength)
+    if (nextBlock != implControl->numBlocks)
     {
-        DPRINT("Warning: couldnt equalize the number of bytes desired and those read\n");
+        DPRINT("Warning: couldnt find the start of every block\n");
     }
     return NITF_SUCCESS;
+}
+
+/*
+   Set the block offsets from the block mask of a masked (M3) image. This
+   avoids scanning the data but is only done if the mask holds the block
+   record from the file. The mask of an image without one holds the
+   offsets of uncompressed blocks, which are evenly spaced, so the mask is
+   only used if it is not and the first block starts with an SOI marker.
+*/
+NITFPRIV(NITF_BOOL) useBlockMask(JPEGImplControl* implControl,
+                                 nitf_IOInterface* io,
+                                 nitf_Uint64 offset,
+                                 nitf_Uint64 fileLength,
+                                 nitf_Uint64* blockMask,
+                                 nitf_Error* error)
+{
+    nitf_Uint32 i;
+    nitf_Uint32 first = NITF_IMAGE_IO_NO_BLOCK;
+    NITF_BOOL evenlySpaced = 1;
+    nitf_Uint8 soi[2];
 
-CATCH_ERROR:
-    nitf_Error_print(error, stdout, "While scanning offsets!");
-    return NITF_FAILURE;
+    for (i = 0; i < implControl->numBlocks; ++i)
+    {
+        if (blockMask[i] == NITF_IMAGE_IO_NO_BLOCK)
+        {
+            evenlySpaced = 0;
+            implControl->blockOffsets[i] = -1;
+            continue;
+        }
+        if (blockMask[i] >= fileLength)
+            return NITF_FAILURE;
+        if (first == NITF_IMAGE_IO_NO_BLOCK)
+            first = i;
+        if (implControl->numBlocks > 1 && blockMask[i] != i * blockMask[1])
+            evenlySpaced = 0;
+        implControl->blockOffsets[i] = (nitf_Off) (offset + blockMask[i]);
+    }
+
+    if (first == NITF_IMAGE_IO_NO_BLOCK ||
+        (evenlySpaced && implControl->numBlocks > 1))
+        return NITF_FAILURE;
+
+    if (!nitf_IOInterface_readAt(io, implControl->blockOffsets[first],
+                                 soi, 2, error))
+        return NITF_FAILURE;
+    return soi[0] == 0xFF && soi[1] == 0xD8;
 }
 
 NITFPRIV(nitf_DecompressionControl*) implOpen(nitf_ImageSubheader* subheader,
@@ -962,9 +720,26 @@ NITFPRIV(nitf_DecompressionControl*) implOpen(nitf_ImageSubheader* subheader,
                                               nitf_Error* error)
 {
     JPEGImplControl* implControl; /* This is our local storage  */
-
-    (void)options;
-    (void)error;
+    nitf_Uint32 numRows;
+    nitf_Uint32 numCols;
+    nitf_Uint32 numRowsPerBlock;
+    nitf_Uint32 numColsPerBlock;
+    nitf_Uint32 numBlocksPerRow;
+    nitf_Uint32 numBlocksPerCol;
+    char imode[NITF_IMODE_SZ + 1];
+    char compression[NITF_IC_SZ + 1];
+    char compressionRate[NITF_COMRAT_SZ + 1];
+    nrt_Pair* scalePair;
+    nrt_Pair* sharedPair;
+
+    if (!nitf_ImageSubheader_getBlocking(subheader, &numRows, &numCols,
+                                         &numRowsPerBlock, &numColsPerBlock,
+                                         &numBlocksPerRow, &numBlocksPerCol,
+                                         imode, error))
+        return NULL;
+    if (!nitf_ImageSubheader_getCompression(subheader, compression,
+                                            compressionRate, error))
+        return NULL;
 
     implControl = (JPEGImplControl*)NITF_MALLOC(sizeof(JPEGImplControl));
 
@@ -976,14 +751,42 @@ NITFPRIV(nitf_DecompressionControl*) implOpen(nitf_ImageSubheader* subheader,
                 NITF_ERR_DECOMPRESSION);
         return NULL;
     }
+    memset(implControl, 0, sizeof(JPEGImplControl));
+
+    /*  Band sequential images have a set of blocks for each band */
+    implControl->numBlocks = numBlocksPerRow * numBlocksPerCol;
+    if (imode[0] == 'S')
+    {
+        implControl->numBlocks *=
+            nitf_ImageSubheader_getBandCount(subheader, error);
+    }
+    implControl->masked = (compression[0] == 'M');
+
+    /*  A reduced resolution decode, libjpeg scales the IDCT by 1/2 - 1/8 */
+    implControl->scale = 1;
+    scalePair = (options != NULL) ?
+        nrt_HashTable_find(options, NITF_DECOMPRESSION_SCALE_KEY) : NULL;
+    if (scalePair != NULL && scalePair->data != NULL)
+    {
+        nitf_Uint32 scale = *((nitf_Uint32*) scalePair->data);
+        if (scale == 2 || scale == 4 || scale == 8)
+            implControl->scale = scale;
+    }
+
+    /*  Another control for this image has already found the blocks */
+    sharedPair = (options != NULL) ?
+        nrt_HashTable_find(options, NITF_DECOMPRESSION_SHARED_KEY) : NULL;
+    if (sharedPair != NULL)
+        implControl->shared = (JPEGImplControl*) sharedPair->data;
 
     return (nitf_DecompressionControl*)implControl;
 }
 
 /*!
  *  Open our interface up.  This thing saves a reference to our
- *  io, and sets us up to read.  We call fdopen() to get a FILE*
- *  back from our IOInterface.
+ *  io, and builds the table of block offsets, from the block mask
+ *  of a masked image or by scanning the data for the block SOI
+ *  markers.
  *
  *  \todo  This function needs to know Bits per pixel so that it
  *  can load the correct JPEG library
@@ -997,6 +800,7 @@ NITFPRIV(NITF_BOOL) implStart(nitf_DecompressionControl* control,
                               nitf_Error* error)
 {
     JPEGImplControl* implControl = (JPEGImplControl*) control;
+    nitf_Uint32 i;
 
     DPRINT("=============================================================\n");
     DPRINT("JPEG decompression\n");
@@ -1007,58 +811,34 @@ NITFPRIV(NITF_BOOL) implStart(nitf_DecompressionControl* control,
     DPRINTA1("[%d] blockInfo->numColsPerBlock\n", blockInfo->numColsPerBlock);
     DPRINTA1("[%d] blockInfo->length\n", blockInfo->length);
 
-    /*  For right now, we are storing this silly markerList.  I think
-     this will prove to be a useless mechanism  */
-    implControl->markerList = nitf_List_construct(error);
-    if (!implControl->markerList)
-    {
-        /*  If this fails, the error is already set  */
-        return NITF_FAILURE;
-    }
-
-    /*  Seek to our start point, just in case... */
-    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(io,
-                                               offset,
-                                               NITF_SEEK_SET,
-                                               error)))
+    implControl->blockOffsets = (nitf_Off*)
+        NITF_MALLOC((implControl->numBlocks + 1) * sizeof(nitf_Off));
+    if (!implControl->blockOffsets)
     {
-        nitf_Error_initf(error,
-                NITF_CTXT,
-                NITF_ERR_DECOMPRESSION,
-                "Error seeking to offset for JPEG block [%ld]",
-                offset);
+        nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
+                        NITF_CTXT, NITF_ERR_MEMORY);
         return NITF_FAILURE;
     }
 
-    /*  Find all marker offsets!!!!  */
-    if (!scanOffsets(io, implControl->markerList, fileLength, error))
+    /*  Find all block offsets, the mask tells us if there is one  */
+    if (implControl->shared != NULL &&
+        implControl->shared->blockOffsets != NULL &&
+        implControl->shared->numBlocks == implControl->numBlocks)
     {
-        return NITF_FAILURE;
+        memcpy(implControl->blockOffsets, implControl->shared->blockOffsets,
+               implControl->numBlocks * sizeof(nitf_Off));
     }
-
+    else if (!implControl->masked ||
+             !useBlockMask(implControl, io, offset, fileLength, blockMask,
+                           error))
     {
-        nitf_Uint32 nextBlock = 0;
-        nitf_ListIterator x = nitf_List_begin((implControl->markerList));
-        nitf_ListIterator e = nitf_List_end((implControl->markerList));
-        while (nitf_ListIterator_notEqualTo(&x, &e))
-
+        for (i = 0; i < implControl->numBlocks; ++i)
+            implControl->blockOffsets[i] = -1;
+        if (!scanOffsets(implControl, io, offset, fileLength,
+                         blockMask, error))
         {
-            JPEGMarkerItem *item = nitf_ListIterator_get(&x);
-            DPRINTA2("[%s:%d]", item->name, item->off );
-
-            if (strcmp(item->name, "SOI") == 0)
-            {
-                while(blockMask[nextBlock++] == NITF_IMAGE_IO_NO_BLOCK);
-                item->block = nextBlock - 1;
-            }
-            else
-            {
-                item->block = NITF_IMAGE_IO_NO_BLOCK;
-            }
-
-            nitf_ListIterator_increment(&x);
+            return NITF_FAILURE;
         }
-        DPRINT("\n");
     }
 
     /*  Seek to our start point, just in case... */
@@ -1074,8 +854,23 @@ NITFPRIV(NITF_BOOL) implStart(nitf_DecompressionControl* control,
         return NITF_FAILURE;
     }
 
+    /*  Tell the caller the size of the reduced blocks we return */
+    if (implControl->scale > 1)
+    {
+        if (blockInfo->numRowsPerBlock % implControl->scale == 0 &&
+            blockInfo->numColsPerBlock % implControl->scale == 0)
+        {
+            blockInfo->numRowsPerBlock /= implControl->scale;
+            blockInfo->numColsPerBlock /= implControl->scale;
+            blockInfo->length /= implControl->scale * implControl->scale;
+        }
+        else
+            implControl->scale = 1;
+    }
+
     implControl->ioInterface = io;
     implControl->length = blockInfo->length;
+    implControl->shared = NULL;
     return NITF_SUCCESS;
 }
 
@@ -1234,7 +1029,9 @@ NITFPRIV(NITF_BOOL) JPEGCreateIOSource(j_decompress_ptr cinfo,
     src->pub.bytes_in_buffer = 0; /* forces fill_input_buffer on first read */
     src->pub.next_input_byte = NULL; /* until buffer loaded */
     src->ioInterface = implControl->ioInterface;
-    src->blockLength = implControl->length;
+    /* The data read is bounded by the full resolution block length */
+    src->blockLength = implControl->length *
+        implControl->scale * implControl->scale;
     src->bytesRead = 0;
     src->ioStart = nitf_IOInterface_tell(src->ioInterface, error);
     src->ioEnd = nitf_IOInterface_getSize(src->ioInterface, error);
@@ -1247,36 +1044,15 @@ NITFPRIV(NITF_BOOL) JPEGCreateIOSource(j_decompress_ptr cinfo,
 /*!
  *  Returns a starting offset for the block number indicated.
  *  The information is in the control structure, which was
- *  generated during implOpen.
+ *  generated during implStart.
  */
 NITFPRIV(NITF_BOOL) findBlockSOI(JPEGImplControl* control,
                                  nitf_Uint32 blockNumber,
-                                 off_t* soi,
+                                 nitf_Off* soi,
                                  nitf_Error* error)
 {
-    nitf_ListIterator x = nitf_List_begin(control->markerList);
-    nitf_ListIterator end = nitf_List_end(control->markerList);
-    int j = -1;
-
-    for (x = nitf_List_begin(control->markerList);
-            nitf_ListIterator_notEqualTo(&x, &end);
-            nitf_ListIterator_increment(&x))
-    {
-        JPEGMarkerItem* item = (JPEGMarkerItem*)nitf_ListIterator_get(&x);
-        if (strcmp(item->name, "SOI") == 0 && 
-            ((j = item->block) == blockNumber))
-        {
-            *soi = item->off - 2;
-            break;
-        }
-        /*++j;
-        if (j == blockNumber)
-        {
-            *soi = item->off - 2;
-            break;
-        } */
-    }
-    if (j != blockNumber)
+    if (blockNumber >= control->numBlocks ||
+        control->blockOffsets[blockNumber] < 0)
     {
         nitf_Error_initf(error,
                          NITF_CTXT,
@@ -1284,6 +1060,7 @@ NITFPRIV(NITF_BOOL) findBlockSOI(JPEGImplControl* control,
                          "Invalid block (no offset found) [%d]", blockNumber);
         return NITF_FAILURE;
     }
+    *soi = control->blockOffsets[blockNumber];
     return NITF_SUCCESS;
 }
 
@@ -1300,7 +1077,7 @@ NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl* control,
 
     /*  Get out the read object from the opaque handle  */
     JPEGImplControl* implControl = (JPEGImplControl*)control;
-    off_t soi = 0;
+    nitf_Off soi = 0;
 
     struct jpeg_error_mgr jerr;
     struct jpeg_decompress_struct cinfo;
@@ -1395,6 +1172,8 @@ NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl* control,
     }
 #endif
 
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = implControl->scale;
     jpeg_start_decompress(&cinfo);
     DPRINT("Started decompress... \n");
     block =
@@ -1476,10 +1255,10 @@ NITFPRIV(void) implClose(nitf_DecompressionControl** control)
     DPRINT("Destroying compression object in JPEG plugin\n");
     implControl = (JPEGImplControl*) * control;
 
-    /* delete marker list */
-    if (implControl && implControl->markerList)
+    /* delete block offsets */
+    if (implControl && implControl->blockOffsets)
     {
-        nitf_List_destruct(&implControl->markerList);
+        NITF_FREE(implControl->blockOffsets);
     }
     if (implControl)
     {
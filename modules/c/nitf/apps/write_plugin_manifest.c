@@ -0,0 +1,61 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ *  Write the manifest of a plugin directory, so that programs loading it
+ *  only load each plugin when it is used.  Run this again whenever the
+ *  plugins change.
+ */
+
+#include <import/nitf.h>
+
+int main(int argc, char** argv)
+{
+    nitf_Error error;
+    const char* dirName;
+    const char* manifestName = NULL;
+
+    if (argc > 3)
+    {
+        fprintf(stdout, "Usage: %s [plugin-dir] [manifest]\n", argv[0]);
+        fprintf(stdout, "The plugin directory defaults to ${%s}\n",
+                NITF_PLUGIN_PATH);
+        exit(EXIT_FAILURE);
+    }
+
+    dirName = argc > 1 ? argv[1] : getenv(NITF_PLUGIN_PATH);
+    if (argc > 2)
+        manifestName = argv[2];
+    if (!dirName)
+    {
+        fprintf(stdout, "No plugin directory, and %s is not set\n",
+                NITF_PLUGIN_PATH);
+        exit(EXIT_FAILURE);
+    }
+
+    if (!nitf_PluginRegistry_writeManifest(dirName, manifestName, &error))
+    {
+        nitf_Error_print(&error, stderr, "Writing the manifest failed");
+        exit(EXIT_FAILURE);
+    }
+    return 0;
+}
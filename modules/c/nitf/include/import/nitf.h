@@ -45,7 +45,9 @@
 #include "nitf/ImageWriter.h"
 #include "nitf/LabelSegment.h"
 #include "nitf/LabelSubheader.h"
+#include "nitf/LazyTRE.h"
 #include "nitf/LookupTable.h"
+#include "nitf/Overview.h"
 #include "nitf/PluginIdentifier.h"
 #include "nitf/PluginRegistry.h"
 #include "nitf/RESegment.h"
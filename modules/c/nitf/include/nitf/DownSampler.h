@@ -325,6 +325,50 @@ NITFAPI(nitf_DownSampler *) nitf_Select2DownSample_construct(nitf_Uint32
         nitf_Error *
         error);
 
+/*!
+ *  The box down-sample method averages the pixels of each window
+ *
+ *  The row and column skip factors divide the sub-window into non-overlaping
+ *  sample windows. The mean of the pixels in each sample window is the
+ *  down-sampled value for that window, rounded to the nearest integer for
+ *  integer pixel types. Partial windows at the edge of the image are
+ *  averaged over the pixels they contain. Complex pixels are averaged by
+ *  component.
+ *
+ *  \param rowSkip  The number of rows to skip
+ *  \param colSkip  The number of columns to skip
+ *  \param error  An error to populate if something bad happened
+ *  \return This method returns an object on success, and NULL on
+ *          failure.
+ */
+NITFAPI(nitf_DownSampler *) nitf_BoxDownSample_construct(nitf_Uint32 rowSkip,
+        nitf_Uint32 colSkip,
+        nitf_Error * error);
+
+/*!
+ *  The Gaussian down-sample method takes a Gaussian weighted average of
+ *  the pixels of each window
+ *
+ *  This is the box method (see nitf_BoxDownSample_construct) with
+ *  separable Gaussian weights centered on the sample window. The
+ *  down-sampler only sees one window at a time, so the kernel does not
+ *  extend past the window. This smooths the result less than a box
+ *  average of the same window, and keeps more detail.
+ *
+ *  \param rowSkip  The number of rows to skip
+ *  \param colSkip  The number of columns to skip
+ *  \param sigma  The standard deviation of the kernel, in full resolution
+ *                pixels, or zero for half the window size
+ *  \param error  An error to populate if something bad happened
+ *  \return This method returns an object on success, and NULL on
+ *          failure.
+ */
+NITFAPI(nitf_DownSampler *) nitf_GaussianDownSample_construct(nitf_Uint32
+        rowSkip,
+        nitf_Uint32 colSkip,
+        double sigma,
+        nitf_Error * error);
+
 /*!
  *  The downsampler destructor is a management function.  While it does
  *  free the downsampler, it first destroys any user data using the
@@ -334,6 +378,21 @@ NITFAPI(nitf_DownSampler *) nitf_Select2DownSample_construct(nitf_Uint32
  */
 NITFAPI(void) nitf_DownSampler_destruct(nitf_DownSampler ** downsampler);
 
+/*!
+ *  Returns TRUE if the result of the down-sampler may be replaced by a
+ *  reduced resolution decode of a compressed image (see
+ *  NITF_DECOMPRESSION_SCALE_KEY). This is the case for the pixel skip and
+ *  box methods with equal row and column skips of 2, 4 or 8. The reduced
+ *  decode is a filtered version of the image, so the pixels are close to
+ *  the box average rather than exact samples of the full resolution image.
+ *
+ *  \param downsampler The downsampler to check
+ */
+NITFAPI(NITF_BOOL) nitf_DownSampler_allowsScaledDecode
+(
+    nitf_DownSampler * downsampler
+);
+
 /*!
     nitf_DownSampler_apply - Apply down-sample method
 
@@ -82,6 +82,8 @@ typedef struct _nitf_Field
     size_t length;
     NITF_BOOL resizable; /* private member that states whether the field
                             can be resized - default is false */
+    NITF_BOOL pooled;    /* private member that states whether the field
+                            was allocated from an arena */
 }
 nitf_Field;
 
@@ -95,6 +97,10 @@ nitf_Field;
  *  \return The newly created field, or NULL on failure.
  *
  *  Construct a new field.  Return the field, unless an error occurred.
+ *
+ *  If an arena is current for the calling thread (see
+ *  nitf_Arena_setCurrent), the field and its data are allocated from it,
+ *  and the memory is only released when the arena is destroyed.
  */
 NITFAPI(nitf_Field *) nitf_Field_construct(size_t length,
                                            nitf_FieldType type,
@@ -287,8 +293,8 @@ NITFAPI(NITF_BOOL) nitf_Field_setReal(nitf_Field * field,
 NITFAPI(void) nitf_Field_destruct(nitf_Field ** field);
 
 /*!
- *  Clone this object.  This is a deep copy operation.
- *  \todo IMPLEMENT THIS
+ *  Clone this object.  This is a deep copy operation.  The copy is never
+ *  allocated from an arena, so it may outlive the source.
  *  \param source The source object
  *  \param error  An error to populate upon failure
  *  \return A new object that is identical to the old
@@ -232,6 +232,50 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_writeRows(nitf_ImageIO * object,
                                            nitf_Error * error
                                           );
 
+/*!
+  \brief nitf_ImageIO_formatRows - Apply the write pixel format to rows
+ 
+  nitf_ImageIO_formatRows converts rows of user data, in place, to the
+  pixel format of the file (for example byte swapping). The "data" argument
+  is as for nitf_ImageIO_writeRows, with all bands. The rows are then
+  written with nitf_ImageIO_writeFormattedRows.
+ 
+  The function does not modify the object so different threads can format
+  different rows at the same time, including while rows are being written.
+ 
+  \param object Associated ImageIO object
+  \param numRows Number of rows in each buffer
+  \param data Row buffers, one per band
+  \return None
+*/
+
+NITFPROT(void) nitf_ImageIO_formatRows(nitf_ImageIO * object,
+                                       nitf_Uint32 numRows,
+                                       nitf_Uint8 ** data);
+
+/*!
+  \brief nitf_ImageIO_writeFormattedRows - Write rows that are already
+  formatted
+ 
+  nitf_ImageIO_writeFormattedRows is the same as nitf_ImageIO_writeRows
+  except that the rows have already been formatted by
+  nitf_ImageIO_formatRows.
+ 
+  \param object Associated ImageIO object
+  \param io Interface for writes
+  \param numRows Number of rows
+  \param data Row buffers, one per band
+  \param error For error reports
+  \return One error, FALSE is returned and the caller supplied error object
+  is set.
+*/
+
+NITFPROT(NITF_BOOL) nitf_ImageIO_writeFormattedRows(nitf_ImageIO * object,
+                                                    nitf_IOInterface* io,
+                                                    nitf_Uint32 numRows,
+                                                    nitf_Uint8 ** data,
+                                                    nitf_Error * error);
+
 /*!
   \brief nitf_ImageIO_flush - Complete deferred writes
  
@@ -599,6 +643,40 @@ typedef struct _nitf_DecompressionInterface
 }
 nitf_DecompressionInterface;
 
+/*!
+  \def NITF_DECOMPRESSION_SCALE_KEY - Decompression option requesting a
+  reduced resolution decode
+
+  When a read is down-sampled by a factor of 2, 4 or 8 (see
+  nitf_DownSampler_allowsScaledDecode), the image IO object opens a second
+  decompression control with this option added to the decompression options.
+  The value is a pointer to a nitf_Uint32 holding the reduction factor.
+
+  A decompressor that can decode blocks at reduced resolution (for example,
+  JPEG by scaling the inverse DCT) divides the block dimensions and length
+  in the blocking information passed to its start function by the factor and
+  returns the reduced blocks from readBlock. A decompressor that ignores the
+  option leaves the blocking information unchanged and the read falls back
+  to a full resolution decode followed by the down-sampler.
+*/
+#define NITF_DECOMPRESSION_SCALE_KEY "decompressionScale"
+
+/*!
+  \def NITF_DECOMPRESSION_SHARED_KEY - Decompression option giving a started
+  control for the same image
+
+  When blocks are decoded in parallel (see nitf_ImageReader_setReadThreads),
+  the image IO object opens a decompression control for each worker thread
+  with this option added to the decompression options. The value is the
+  object's own control, opened by the same decompressor and already
+  started. A decompressor may copy what that control's start function found
+  (for example, the offsets of the compressed blocks) in the worker's start
+  function rather than finding it again. The shared control outlives the
+  worker controls but may be in use on another thread, so it is only read.
+  A decompressor that ignores the option starts each control as usual.
+*/
+#define NITF_DECOMPRESSION_SHARED_KEY "decompressionShared"
+
 /*!
   \brief NITF_DOWN_SAMPLE_FUNCTION - Function pointer for down-sample
   function
@@ -732,8 +810,18 @@ NITFPROT(void) nitf_ImageIO_destruct(nitf_ImageIO ** nitf);
   \brief nitf_ImageIO_read - Read a sub-window
  
   \b nitf_ImageIO_read reads a sub-window. The user supplies the opened file
-  descriptor and data buffers. The file should allow seeks. The file is left in
-  the file position of the last read.
+  descriptor and data buffers. The file should allow seeks. Pixel data is
+  read with positional reads (nitf_IOInterface_readAt), so the file position
+  is not used for it.
+
+  Several threads may call nitf_ImageIO_read on the same object at once,
+  each with its own sub-window and buffers. Each call sets up its own I/O
+  control. If the IO interface supports positional reads, uncompressed data
+  is read concurrently, while access to the read block cache and to the
+  decompressor is serialized. If it does not, the calls are serialized.
+  A request that must revert the optimized RGB24 or IQ modes (i.e. reads
+  all of the bands of such an image) fails while other reads are in
+  progress.
  
   If the \em padded argument returns TRUE the request may include pad pixels.
   For blocked images, each block may contain pad pixels. It is possible to
@@ -761,6 +849,7 @@ NITFPROT(void) nitf_ImageIO_destruct(nitf_ImageIO ** nitf);
   Possible errors include:
  
     Write in progress
+    Mode change while other reads are in progress
     Invalid sub-set or band
     System I/O or memory allocation errors
 */
@@ -807,6 +896,19 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_setFileOffset(nitf_ImageIO * nitf,
                                                nitf_Error * error 
                                               );
 
+/*!
+  \brief nitf_ImageIO_getDataLength - Get the length of the written image
+
+  \b nitf_ImageIO_getDataLength returns the length in bytes of the image
+  data that a write will produce. This is only known before the write for
+  uncompressed (NC) images, for other images -1 is returned.
+
+  \param nitf The associated ImageIO object
+  \return The length or -1
+*/
+
+NITFPROT(nitf_Off) nitf_ImageIO_getDataLength(nitf_ImageIO * nitf);
+
 /*!
   \brief nitf_ImageIO_getBlockingInfo - Get blocking information
  
@@ -865,6 +967,81 @@ NITFPROT(void) nitf_ImageIO_setReadCaching
     nitf_ImageIO * nitf      /*!< Object to modify */
 );
 
+/*!
+  \brief nitf_ImageIO_setReadCacheSize - Enable cached reads with a size limit
+
+  See the documentation for nitf_ImageReader_setReadCacheSize
+
+  \return None
+*/
+
+NITFPROT(void) nitf_ImageIO_setReadCacheSize
+(
+    nitf_ImageIO * nitf,     /*!< Object to modify */
+    nitf_Uint64 maxSize      /*!< Cache size limit in bytes */
+);
+
+/*!
+  \brief nitf_ImageIO_setReadThreads - Set the number of threads used to
+  decompress blocks
+
+  See the documentation for nitf_ImageReader_setReadThreads
+
+  \return None
+*/
+
+NITFPROT(void) nitf_ImageIO_setReadThreads
+(
+    nitf_ImageIO * nitf,     /*!< Object to modify */
+    nitf_Uint32 numThreads   /*!< Number of threads, 0 for one per CPU */
+);
+
+/*!
+  \brief nitf_ImageIO_setScaledDecode - Enable or disable reduced resolution
+  decompression of down-sampled reads
+
+  Scaled decoding is disabled when the object is constructed. See the
+  documentation for nitf_ImageReader_setScaledDecode
+
+  \return None
+*/
+
+NITFPROT(void) nitf_ImageIO_setScaledDecode
+(
+    nitf_ImageIO * nitf,     /*!< Object to modify */
+    NITF_BOOL enable         /*!< Enable if TRUE */
+);
+
+/*!
+  \brief nitf_ImageIO_getReadCacheStats - Get read block cache statistics
+
+  See the documentation for nitf_ImageReader_getReadCacheStats
+
+  \return None
+*/
+
+NITFPROT(void) nitf_ImageIO_getReadCacheStats
+(
+    nitf_ImageIO * nitf,     /*!< Object to query */
+    nitf_Uint64 * hits,      /*!< Returns the hit count (may be NULL) */
+    nitf_Uint64 * misses     /*!< Returns the miss count (may be NULL) */
+);
+
+/*!
+  \brief nitf_ImageIO_setVectorLevel - Limit the vector instructions used
+  by the pixel formatters
+
+  The byte swap, sign extension and shift formatters pick the widest
+  vector instructions the processor supports: 0 (scalar only), 1 (SSE2)
+  or 2 (AVX2). This lowers that level for the whole process, which lets
+  the unit tests check each vector path against the scalar code. A level
+  above what the processor supports is reduced to the supported level.
+
+  \return The level now in effect
+*/
+
+NITFPROT(int) nitf_ImageIO_setVectorLevel(int level);
+
 /*!
   \brief nitf_BlockingInfo_print - Print blocking information
  
@@ -909,6 +1086,31 @@ NITFPROT(nitf_Uint8*) nitf_ImageIO_readBlockDirect(nitf_ImageIO* nitf,
                                                    nitf_Uint64* blockSize,
                                                    nitf_Error * error);
 
+/*!
+  \brief nitf_ImageIO_getBlockDirect - Get a block of data without
+  manipulation, in place if possible
+
+  \b nitf_ImageIO_getBlockDirect returns the same data as
+  nitf_ImageIO_readBlockDirect. If the block is stored uncompressed and the
+  IO interface's data is in memory (for example nitf_MappedAdapter_open),
+  the returned pointer is into that memory, so there is no read or copy.
+  Otherwise the block is read as by nitf_ImageIO_readBlockDirect.
+
+  The block must not be modified and, as for nitf_ImageIO_readBlockDirect,
+  is only valid until the next read.
+
+  \param nitf         Image handle
+  \param io           IO handle
+  \param blockNumber  The block to read
+  \param blockSize    The block size read
+  \param error        Error object
+ */
+NITFPROT(const nitf_Uint8*) nitf_ImageIO_getBlockDirect(nitf_ImageIO* nitf,
+                                                        nitf_IOInterface* io,
+                                                        nitf_Uint32 blockNumber,
+                                                        nitf_Uint64* blockSize,
+                                                        nitf_Error * error);
+
 /*!
   \brief nitf_ImageIO_writeBlockDirect - Write a block of data without manipulation
 
@@ -47,7 +47,9 @@ nitf_ImageReader_getBlockingInfo(nitf_ImageReader * imageReader,
                                  nitf_Error * error);
 
 /*!
- *  TODO: Add documentation
+ *  Read a sub-window of the image into the user's band buffers.
+ *  Several threads may read from one image reader at once, each with its
+ *  own sub-window and buffers (see nitf_ImageIO_read).
  */
 NITFAPI(NITF_BOOL) nitf_ImageReader_read(nitf_ImageReader * imageReader,
         nitf_SubWindow * subWindow,
@@ -62,6 +64,18 @@ NITFAPI(nitf_Uint8*) nitf_ImageReader_readBlock(nitf_ImageReader * imageReader,
                                                 nitf_Uint64* blockSize,
                                                 nitf_Error * error);
 
+/*!
+ *  Get a block directly from file, without a copy if possible.  The
+ *  result is the same as nitf_ImageReader_readBlock, but for uncompressed
+ *  blocks of a memory mapped input (see nitf_MappedAdapter_open) it points
+ *  into the mapping.  The block must not be modified, and is only valid
+ *  until the next read.
+ */
+NITFAPI(const nitf_Uint8*) nitf_ImageReader_getBlock(nitf_ImageReader * imageReader,
+                                                     nitf_Uint32 blockNumber,
+                                                     nitf_Uint64* blockSize,
+                                                     nitf_Error * error);
+
 /*!
  *  TODO: Add documentation
  */
@@ -84,6 +98,105 @@ NITFAPI(void) nitf_ImageReader_setReadCaching
     nitf_ImageReader * iReader  /*!< Object to modify */
 );
 
+/*!
+  \brief nitf_ImageReader_setReadCacheSize - Enable cached reads and set the
+  cache size
+
+  nitf_ImageReader_setReadCacheSize enables cached reads (see
+  nitf_ImageReader_setReadCaching) and sets the limit, in bytes, on the
+  memory held by the block cache. Blocks are retained in least recently
+  used order, so a read that straddles a block boundary, or a series of
+  reads that revisit nearby blocks, does not read or decompress the same
+  block more than once while it remains cached.
+
+  The most recently used block is always retained, so a size of zero
+  gives a cache of one block, which is the default.
+
+  \return None
+*/
+
+NITFAPI(void) nitf_ImageReader_setReadCacheSize
+(
+    nitf_ImageReader * iReader, /*!< Object to modify */
+    nitf_Uint64 maxSize         /*!< Cache size limit in bytes */
+);
+
+/*!
+  \brief nitf_ImageReader_getReadCacheStats - Get block cache statistics
+
+  nitf_ImageReader_getReadCacheStats returns the block cache hit and miss
+  counts. A miss is a block that had to be read or decompressed. A hit is
+  a switch to a block that was still in the cache. Successive accesses to
+  the same block (for example, successive rows of one block) are not
+  counted.
+
+  \return None
+*/
+
+NITFAPI(void) nitf_ImageReader_getReadCacheStats
+(
+    nitf_ImageReader * iReader, /*!< Object to query */
+    nitf_Uint64 * hits,         /*!< Returns the hit count (may be NULL) */
+    nitf_Uint64 * misses        /*!< Returns the miss count (may be NULL) */
+);
+
+/*!
+  \brief nitf_ImageReader_setReadThreads - Decompress blocks in parallel
+
+  nitf_ImageReader_setReadThreads sets the number of threads used to
+  decompress the blocks of compressed images (for example JPEG or JPEG
+  2000). With more than one thread, a read works out the blocks the
+  sub-window touches and decodes them on a pool of worker threads, each
+  with its own decompression control, before assembling them into the user
+  buffers. The read proceeds in strips of whole block rows, so the block
+  cache temporarily grows to hold one strip (see
+  nitf_ImageReader_setReadCacheSize).
+
+  The worker threads are started by the first parallel read and wait for
+  work until the reader is destroyed or the number of threads is changed.
+
+  A value of 1 (the default) decompresses blocks serially, 0 uses one
+  thread per processor. Parallel decompression requires an IO interface
+  with positional reads (see nitf_IOInterface_readAt) and does not apply
+  to down-sampled reads or uncompressed images. The options passed when
+  the reader was created must remain valid while the reader is used.
+
+  \return None
+*/
+
+NITFAPI(void) nitf_ImageReader_setReadThreads
+(
+    nitf_ImageReader * iReader, /*!< Object to modify */
+    nitf_Uint32 numThreads      /*!< Number of threads, 0 for one per CPU */
+);
+
+/*!
+  \brief nitf_ImageReader_setScaledDecode - Decompress down-sampled reads
+  at reduced resolution
+
+  When a read of a compressed single band image uses a pixel skip or box
+  down-sampler with equal row and column skips of 2, 4 or 8, and the
+  sub-window starts on a multiple of the skip, the read asks the
+  decompressor for blocks already reduced by the skip (for JPEG, a scaled
+  inverse DCT), instead of decompressing every full resolution block and
+  discarding most of it. The result is a filtered reduction close to the
+  box average, so a pixel skip read no longer returns the exact full
+  resolution samples. Multi-band images and decompressors without this
+  capability are read at full resolution as before.
+
+  Scaled decoding is disabled by default, since it changes the pixels a
+  down-sampled read returns. nitf_ImageReader_setScaledDecode with enable
+  TRUE turns it on for later reads.
+
+  \return None
+*/
+
+NITFAPI(void) nitf_ImageReader_setScaledDecode
+(
+    nitf_ImageReader * iReader, /*!< Object to modify */
+    NITF_BOOL enable            /*!< Enable if TRUE */
+);
+
 NITF_CXX_ENDGUARD
 
 #endif
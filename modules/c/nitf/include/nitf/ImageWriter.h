@@ -92,6 +92,44 @@ NITFAPI(void) nitf_ImageWriter_setDirectBlockWrite
     int enable                      /*!< Enable cached writes if true */
 );
 
+/*!
+ * \brief nitf_ImageWriter_setWriteThreads - Set the number of write threads
+ *
+ * nitf_ImageWriter_setWriteThreads sets the number of threads used to write
+ * the image. With more than one thread the image is written through a
+ * pipeline, in strips of one row of blocks: while the calling thread
+ * writes (and compresses) a strip, the next strip is formatted (byte
+ * swapped) on numThreads - 1 threads and the strip after that is read from
+ * the band sources on another thread. The band sources are still read in
+ * order, by one thread at a time, so they need not be thread safe.
+ *
+ * A value of 1 (the default) writes the image one row at a time on the
+ * calling thread, 0 uses one thread per processor. Direct block writes
+ * (see nitf_ImageWriter_setDirectBlockWrite) are not pipelined.
+ */
+NITFAPI(void) nitf_ImageWriter_setWriteThreads
+(
+    nitf_ImageWriter * iWriter,     /*!< Object to modify */
+    nitf_Uint32 numThreads          /*!< Number of threads, 0 for one per CPU */
+);
+
+/*!
+ * \brief nitf_ImageWriter_setDataLength - Set the length of the image data
+ *
+ * nitf_ImageWriter_setDataLength sets the length in bytes of the image data
+ * the writer will produce. A streaming writer (see nitf_Writer_setStreaming)
+ * writes the lengths in the file header before the image, so it needs the
+ * length of a compressed image, which the caller must know (for example
+ * from a previous compression of the same data). The write fails if the
+ * compressed data does not have this length. The length of an uncompressed
+ * image is known, and need not be set. A length of -1 clears the value.
+ */
+NITFAPI(void) nitf_ImageWriter_setDataLength
+(
+    nitf_ImageWriter * iWriter,     /*!< Object to modify */
+    nitf_Off length                 /*!< The image data length in bytes */
+);
+
 /*!
  *  Function allows the user access to the product's pad pixels.
  *  For example, if you wanted transparent pixels for fill, you would
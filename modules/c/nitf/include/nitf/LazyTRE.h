@@ -0,0 +1,83 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; if not, If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NITF_LAZY_TRE_H__
+#define __NITF_LAZY_TRE_H__
+
+#include "nitf/System.h"
+#include "nitf/TRE.h"
+
+NITF_CXX_GUARD
+
+struct _nitf_Record;
+
+/*!
+ *  \fn nitf_LazyTRE_handler
+ *  \brief The handler of a TRE whose parse has been deferred
+ *
+ *  When the reader is asked to defer TRE parsing (see
+ *  nitf_Reader_setLazyTREs), it keeps the raw bytes of each TRE along
+ *  with the handler that would have parsed it, and gives the TRE this
+ *  handler.  The first call through the TRE API (getting or setting a
+ *  field, find, begin, getID, getCurrentSize or write) parses the bytes
+ *  with the real handler, exactly as the reader would have, and the TRE
+ *  then behaves as if it had been parsed by the reader.
+ *
+ *  \param error The structure to populate if an error occurs
+ *  \return The handler
+ */
+NITFAPI(nitf_TREHandler*) nitf_LazyTRE_handler(nitf_Error * error);
+
+/*!
+ *  Defer the parse of a TRE.  The raw bytes are read from the IO
+ *  interface, and the TRE is given the lazy handler.
+ *
+ *  \param tre The TRE, with no handler yet
+ *  \param handler The plug-in handler to parse the TRE with, or NULL
+ *  for the default handler
+ *  \param io The IO interface, at the start of the TRE data
+ *  \param length The length of the TRE data
+ *  \param record The record the TRE belongs to
+ *  \param error The structure to populate if an error occurs
+ *  \return The status
+ */
+NITFPROT(NITF_BOOL) nitf_LazyTRE_defer(nitf_TRE * tre,
+                                       nitf_TREHandler * handler,
+                                       nitf_IOInterface * io,
+                                       nitf_Uint32 length,
+                                       struct _nitf_Record * record,
+                                       nitf_Error * error);
+
+/*!
+ *  Parse a deferred TRE now.  This does nothing if the TRE has been
+ *  parsed already.  If the plug-in fails to parse the TRE, the default
+ *  handler is used, as the reader does.
+ *
+ *  \param tre The TRE
+ *  \param error The structure to populate if an error occurs
+ *  \return The status
+ */
+NITFAPI(NITF_BOOL) nitf_LazyTRE_realize(nitf_TRE * tre, nitf_Error * error);
+
+NITF_CXX_ENDGUARD
+
+#endif
@@ -0,0 +1,160 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+  \file Overview - Reduced resolution overviews (R-sets) of image segments
+
+  An overview is an image segment holding a reduced resolution copy of
+  another (base) image segment of the same file. The overview is attached to
+  the base image (its IALVL is the display level of the base image), is
+  located at the origin of the base image (ILOC) and its magnification
+  (IMAG) is "/N", where N is the reduction factor. A set of overviews with
+  increasing factors (2, 4, 8, ...) forms a pyramid.
+
+  Overviews are written with the usual Writer and ImageWriter. The
+  overview segments are added to the record before nitf_Writer_prepare is
+  called (see nitf_Overview_newSegment), and the source of each overview
+  band is a down-sampling band source wrapping a second source of the base
+  band data (see nitf_OverviewSource_construct), for example:
+
+      overview = nitf_Overview_newSegment(record, 0, 4, error);
+      ...
+      nitf_Writer_prepare(writer, record, output, error);
+      ...
+      imageWriter = nitf_Writer_newImageWriter(writer, overviewIndex,
+                                               NULL, error);
+      downSampler = nitf_BoxDownSample_construct(4, 4, error);
+      bandSource = nitf_OverviewSource_construct(
+          nitf_MemorySource_construct(data, size, 0, bytes, 0, error),
+          baseSubheader, downSampler, error);
+      nitf_ImageSource_addBand(imageSource, bandSource, error);
+
+  When reading, nitf_Overview_select picks the overview to read for a
+  requested down-sample factor, so that a zoomed out read visits the
+  overview rather than every block of the full resolution image.
+*/
+
+#ifndef __NITF_OVERVIEW_H__
+#define __NITF_OVERVIEW_H__
+
+#include "nitf/BandSource.h"
+#include "nitf/DownSampler.h"
+#include "nitf/Record.h"
+
+NITF_CXX_GUARD
+
+/*!
+  \brief nitf_Overview_newSegment - Add an overview of an image segment
+
+  nitf_Overview_newSegment appends a new image segment to the record for an
+  overview of the image segment at index imageIndex, reduced by factor. The
+  base subheader must already have its pixel information and dimensions
+  set.
+
+  The overview subheader is a copy of the base subheader except for the
+  following:
+
+      NROWS and NCOLS are the base dimensions divided by the factor,
+          rounded up
+      The block size of the base is kept, unless it is larger than the
+          overview
+      IMAG is "/factor", IALVL is the display level of the base, ILOC is 0
+      IDLVL is one more than the largest display level in the record
+      IC is "NC" (the overview is not compressed)
+      The extension sections (TREs) are not copied, since they describe
+          the base image
+
+  The overview must be written with band sources that produce the reduced
+  image (see nitf_OverviewSource_construct).
+
+  \return The new segment or NULL on error. On error, the error object is
+  set
+*/
+NITFAPI(nitf_ImageSegment *) nitf_Overview_newSegment
+(
+    nitf_Record * record,       /*!< The record to add the overview to */
+    nitf_Uint32 imageIndex,     /*!< Index of the base image segment */
+    nitf_Uint32 factor,         /*!< The reduction factor (2 - 999) */
+    nitf_Error * error          /*!< For error returns */
+);
+
+/*!
+  \brief nitf_OverviewSource_construct - Band source for an overview band
+
+  nitf_OverviewSource_construct creates a band source that reads the full
+  resolution band from baseSource and reduces it with the down-sampler.
+  The base source is read sequentially, one row of sample windows at a
+  time, so the full image does not have to be in memory. Partial windows
+  at the right and bottom edges are passed to the down-sampler as such.
+
+  The down-sampler must have equal row and column skips (the reduction
+  factor of the overview) and must not be a multi-band method. Any of the
+  single band down-samplers can be used, the box down-sampler (see
+  nitf_BoxDownSample_construct) is the usual choice. The down-sampler is
+  not owned by the band source and may be shared by the bands of an image
+  but it must remain valid until the image has been written.
+
+  The base source supplies the pixels of the base image described by
+  baseSubheader, in the format used to write the base image. It is owned
+  by the new band source if the call succeeds. As with other band sources,
+  the object cannot be reused for a second write.
+
+  \return The new object or NULL on error. On error, the error object is
+  set
+*/
+NITFAPI(nitf_BandSource *) nitf_OverviewSource_construct
+(
+    nitf_BandSource * baseSource,        /*!< Source of the base band */
+    nitf_ImageSubheader * baseSubheader, /*!< Subheader of the base image */
+    nitf_DownSampler * downSampler,      /*!< The reduction method */
+    nitf_Error * error                   /*!< For error returns */
+);
+
+/*!
+  \brief nitf_Overview_select - Select the overview for a down-sample factor
+
+  nitf_Overview_select finds the overview of the image segment at index
+  imageIndex that has the largest reduction factor not greater than factor.
+  The overviews are the image segments attached to the base image with a
+  magnification of the form "/N" and the corresponding dimensions. If there
+  is no such overview, the base image itself is selected with a factor of
+  one.
+
+  A read of the base image down-sampled by factor is then a read of the
+  selected segment, with the sub-window start and size divided by the
+  overview factor and a down-sampler for the remaining factor (factor
+  divided by the overview factor, if this is more than one).
+
+  \return TRUE on success. On failure the error object is set
+*/
+NITFAPI(NITF_BOOL) nitf_Overview_select
+(
+    nitf_Record * record,           /*!< The record to search */
+    nitf_Uint32 imageIndex,         /*!< Index of the base image segment */
+    nitf_Uint32 factor,             /*!< The requested down-sample factor */
+    nitf_Uint32 * overviewIndex,    /*!< Returns the segment index to read */
+    nitf_Uint32 * overviewFactor,   /*!< Returns its reduction factor */
+    nitf_Error * error              /*!< For error returns */
+);
+
+NITF_CXX_ENDGUARD
+#endif
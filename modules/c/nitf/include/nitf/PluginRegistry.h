@@ -13,6 +13,10 @@
 /*  The environment variable for the plugin path  */
 #   define NITF_PLUGIN_PATH "NITF_PLUGIN_PATH"
 
+/*  The environment variable for the plugin manifest, and its default name  */
+#   define NITF_PLUGIN_MANIFEST "NITF_PLUGIN_MANIFEST"
+#   define NITF_PLUGIN_MANIFEST_FILE "nitf_plugins.manifest"
+
 NITF_CXX_GUARD
 
 /*!
@@ -38,6 +42,13 @@ typedef struct _protected_nitf_PluginRegistry
 
     nitf_List* dsos;
 
+    /*  Plugins named by a manifest, which are loaded on first use  */
+    nitf_HashTable *manifestHandlers;
+    nitf_List* manifestPlugins;
+
+    /*  Signalled, with the registry lock, when a manifest DSO is loaded  */
+    nitf_Condition pluginLoaded;
+
 }
 nitf_PluginRegistry;
 
@@ -73,7 +84,16 @@ NITFPROT(nitf_PluginRegistry *)
  *  Load the plugin registry.  This will walk the DLL path and search
  *  for plugins.  All DSOs are loaded, and queried for their purpose.
  *  Once this has occurred the object will be in memory, and will be
- *  deletable at nitf_PluginRegistry_unload() time.  Since this is normally
+ *  deletable at nitf_PluginRegistry_unload() time.
+ *
+ *  If the directory has a manifest, written by
+ *  nitf_PluginRegistry_writeManifest, it is read from the directory
+ *  (NITF_PLUGIN_MANIFEST_FILE) unless the ${NITF_PLUGIN_MANIFEST}
+ *  environment variable names another file.  Setting it to an empty
+ *  string disables the manifest.  While the manifest matches the DSOs in
+ *  the directory (their names, sizes and modification times), it is used
+ *  instead, and each DSO is only loaded when one of its handlers is first
+ *  retrieved.  A manifest is never written here.  Since this is normally
  *  called implicitly, if you use this method, you will need to synchronize
  *  any code that is threaded if you plan on calling these between threads.
  *
@@ -100,7 +120,9 @@ nitf_PluginRegistry_registerTREHandler(NITF_PLUGIN_INIT_FUNCTION init,
  *  This will walk the DLL path and search
  *  for plugins.  All DSOs are loaded, and queried for their purpose.
  *  Once this has occurred the object will be in memory, and will be
- *  deletable at nitf_PluginRegistry_unload() time.
+ *  deletable at nitf_PluginRegistry_unload() time.  As with
+ *  nitf_PluginRegistry_load, a manifest in the directory defers loading
+ *  each DSO until it is used.
  *  This call is thread safe.
  *
  *  \param dirName   The directory to read from and load
@@ -111,6 +133,25 @@ nitf_PluginRegistry_registerTREHandler(NITF_PLUGIN_INIT_FUNCTION init,
 NITFAPI(NITF_BOOL)
     nitf_PluginRegistry_loadDir(const char* dirName, nitf_Error * error);
 
+/*!
+ *  Write the manifest of a plugin directory, so that later loads of the
+ *  directory only load each DSO when it is used.  Each DSO is loaded and
+ *  asked what it handles, then closed again without its cleanup hook,
+ *  since the registry may share it.  The manifest must be rewritten when
+ *  the DSOs change; until then, the directory is loaded as if it had none.
+ *  The write_plugin_manifest app calls this.
+ *
+ *  \param dirName      The plugin directory
+ *  \param manifestName The manifest to write, or NULL for the one
+ *                      the directory would be loaded with
+ *  \param error        The error structure to populate on failure
+ *  \return 1 on success, 0 on failure
+ */
+NITFAPI(NITF_BOOL)
+    nitf_PluginRegistry_writeManifest(const char* dirName,
+                                      const char* manifestName,
+                                      nitf_Error * error);
+
 
 NITFAPI(NITF_BOOL)
     nitf_PluginRegistry_loadPlugin(const char* fullPathName, nitf_Error* error);
@@ -26,6 +26,7 @@
 #include "nitf/System.h"
 #include "nitf/PluginRegistry.h"
 #include "nitf/DefaultTRE.h"
+#include "nitf/LazyTRE.h"
 #include "nitf/Record.h"
 #include "nitf/FieldWarning.h"
 #include "nitf/ImageReader.h"
@@ -46,6 +47,8 @@ typedef struct _nitf_Reader
     nitf_IOInterface* input;
     nitf_Record *record;
     NITF_BOOL ownInput;
+    NITF_BOOL useArena;
+    NITF_BOOL lazyTREs;
 
 }
 nitf_Reader;
@@ -93,6 +96,39 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
                                           nitf_IOInterface* io,
                                           nitf_Error* error);
 
+/*!
+ *  Allocate the fields of the records read from here on from an arena
+ *  that belongs to the record.  Parsing makes a great many small
+ *  allocations, and an arena makes each of them cheap and releases all
+ *  of them at once when the record is destroyed.  The default is off.
+ *
+ *  The fields (including those of the TREs) must then not outlive their
+ *  record.  Clone any that are to be kept (see nitf_Field_clone), and do
+ *  not move segments or extensions from such a record to another one.
+ *
+ *  \param reader The reader object
+ *  \param useArena Whether to use an arena
+ */
+NITFAPI(void) nitf_Reader_setUseArena(nitf_Reader * reader,
+                                      NITF_BOOL useArena);
+
+/*!
+ *  Defer the parsing of TREs.  The reader keeps the raw bytes of each
+ *  TRE, and the TRE's plug-in parses them the first time the TRE is
+ *  used through the TRE API (see nitf_LazyTRE_handler).  The fields are
+ *  the same as if the reader had parsed them, but a record whose TREs
+ *  are mostly left alone is read faster and takes less memory.  The
+ *  default is off.
+ *
+ *  Since the first use of a TRE parses it, the TREs of such a record
+ *  must not be used from several threads at once without locking.
+ *
+ *  \param reader The reader object
+ *  \param lazyTREs Whether to defer TRE parsing
+ */
+NITFAPI(void) nitf_Reader_setLazyTREs(nitf_Reader * reader,
+                                      NITF_BOOL lazyTREs);
+
 
 /*!
  * This creates a new ImageReader object that can be used to access the
@@ -66,6 +66,9 @@ typedef struct _nitf_Record
 
     /* List of reserved segments (RES) */
     nitf_List *reservedExtensions;
+
+    /* The arena holding the fields of a parsed record, or NULL */
+    nitf_Arena *arena;
 }
 nitf_Record;
 
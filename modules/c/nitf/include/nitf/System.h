@@ -82,6 +82,15 @@
 #define NITF_REALLOC NRT_REALLOC
 #define NITF_FREE NRT_FREE
 
+#include "nrt/Arena.h"
+typedef nrt_Arena                   nitf_Arena;
+#define NITF_ARENA_CHUNK_SIZE       NRT_ARENA_CHUNK_SIZE
+#define nitf_Arena_construct        nrt_Arena_construct
+#define nitf_Arena_alloc            nrt_Arena_alloc
+#define nitf_Arena_destruct         nrt_Arena_destruct
+#define nitf_Arena_setCurrent       nrt_Arena_setCurrent
+#define nitf_Arena_getCurrent       nrt_Arena_getCurrent
+
 
 /******************************************************************************/
 /* TYPES                                                                      */
@@ -205,6 +214,16 @@ typedef nrt_DLL             nitf_DLL;
 #define nitf_Mutex_unlock   nrt_Mutex_unlock
 #define nitf_Mutex_init     nrt_Mutex_init
 #define nitf_Mutex_delete   nrt_Mutex_delete
+#define nitf_Condition      nrt_Condition
+#define nitf_Condition_init nrt_Condition_init
+#define nitf_Condition_wait nrt_Condition_wait
+#define nitf_Condition_broadcast nrt_Condition_broadcast
+#define nitf_Condition_delete nrt_Condition_delete
+#define nitf_Thread         nrt_Thread
+#define NITF_THREAD_RUN     NRT_THREAD_RUN
+#define nitf_Thread_create  nrt_Thread_create
+#define nitf_Thread_join    nrt_Thread_join
+#define nitf_Thread_getNumCPUs nrt_Thread_getNumCPUs
 
 
 /******************************************************************************/
@@ -228,11 +247,15 @@ typedef nrt_Directory                   nitf_Directory;
 
 #define nitf_IOHandle_create    nrt_IOHandle_create
 #define nitf_IOHandle_read      nrt_IOHandle_read
+#define nitf_IOHandle_readAt    nrt_IOHandle_readAt
 #define nitf_IOHandle_write     nrt_IOHandle_write
+#define nitf_IOHandle_writeAt   nrt_IOHandle_writeAt
 #define nitf_IOHandle_seek      nrt_IOHandle_seek
 #define nitf_IOHandle_tell      nrt_IOHandle_tell
 #define nitf_IOHandle_getSize   nrt_IOHandle_getSize
 #define nitf_IOHandle_close     nrt_IOHandle_close
+#define nitf_IOHandle_map       nrt_IOHandle_map
+#define nitf_IOHandle_unmap     nrt_IOHandle_unmap
 
 
 /******************************************************************************/
@@ -254,7 +277,12 @@ typedef nrt_IIOInterface                nitf_IIOInterface;
 typedef nrt_IOInterface                 nitf_IOInterface;
 
 #define nitf_IOInterface_read           nrt_IOInterface_read
+#define nitf_IOInterface_readAt         nrt_IOInterface_readAt
+#define nitf_IOInterface_canReadAt      nrt_IOInterface_canReadAt
+#define nitf_IOInterface_getBuffer      nrt_IOInterface_getBuffer
 #define nitf_IOInterface_write          nrt_IOInterface_write
+#define nitf_IOInterface_writeAt        nrt_IOInterface_writeAt
+#define nitf_IOInterface_canWriteAt     nrt_IOInterface_canWriteAt
 #define nitf_IOInterface_canSeek        nrt_IOInterface_canSeek
 #define nitf_IOInterface_seek           nrt_IOInterface_seek
 #define nitf_IOInterface_tell           nrt_IOInterface_tell
@@ -265,6 +293,7 @@ typedef nrt_IOInterface                 nitf_IOInterface;
 #define nitf_IOHandleAdapter_construct  nrt_IOHandleAdapter_construct
 #define nitf_IOHandleAdapter_open       nrt_IOHandleAdapter_open
 #define nitf_BufferAdapter_construct    nrt_BufferAdapter_construct
+#define nitf_MappedAdapter_open         nrt_MappedAdapter_open
 
 
 /******************************************************************************/
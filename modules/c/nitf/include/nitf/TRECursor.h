@@ -46,6 +46,7 @@ typedef struct _nitf_TRECursor
     nitf_IntStack *loop_rtn;    /* holds the endloop bookmark for each level of loops */
     nitf_TRE *tre;              /* the TRE associated with this cursor */
     nitf_TREDescription *end_ptr; /* holds a pointer to the end description */
+    struct _nitf_TREPlan *plan; /* the compiled description */
 
     /* YOU CAN REFER TO THE MEMBERS BELOW IN YOUR CODE */
     nitf_TREDescription *prev_ptr; /* holds the previous description */
@@ -108,6 +109,17 @@ NITFAPI(int) nitf_TRECursor_iterate(nitf_TRECursor * tre_cursor,
                               nitf_Error * error);
 
 
+/*!
+ *  Move a cursor that has just begun past the fixed section of its plan,
+ *  as if it had been iterated over each of those fields.  The caller
+ *  handles the fields itself, at the offsets in the plan.
+ *
+ *  \param tre_cursor The cursor to use
+ *  eturn The number of fields skipped, which may be 0
+ */
+NITFPROT(int) nitf_TRECursor_skipFixed(nitf_TRECursor * tre_cursor);
+
+
 NITF_CXX_ENDGUARD
 
 #endif
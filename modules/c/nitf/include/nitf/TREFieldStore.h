@@ -0,0 +1,227 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; if not, If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NITF_TRE_FIELD_STORE_H__
+#define __NITF_TRE_FIELD_STORE_H__
+
+#include "nitf/System.h"
+#include "nitf/Field.h"
+
+NITF_CXX_GUARD
+
+/*!
+ *  One field of a TRE.  The value lives in the raw buffer of the store
+ *  until the field is asked for as a nitf_Field, and from then on in
+ *  that field.
+ */
+typedef struct _nitf_TREFieldEntry
+{
+    const char *tag;        /* the tag of the description entry */
+    nitf_Uint32 hash;       /* the hash of the tag and loop indices */
+    nitf_Uint32 offset;     /* where the value is in the raw buffer */
+    nitf_Uint32 length;     /* the length of the value */
+    nitf_Uint32 indices;    /* where the loop indices are in the index table */
+    nitf_Uint8 depth;       /* the number of loop indices */
+    nitf_Uint8 type;        /* the nitf_FieldType of the value */
+    nitf_Uint8 resizable;   /* whether the field can be resized */
+    nitf_Pair *pair;        /* the qualified name and the field, or NULL */
+} nitf_TREFieldEntry;
+
+/*!
+ *  \struct nitf_TREFieldStore
+ *  \brief The fields of a TRE
+ *
+ *  The field store keeps the values of a TRE in one raw buffer, in the
+ *  order they were added, with a table of their offsets and lengths.  A
+ *  field is found by the tag of its description entry and its loop
+ *  indices, so the cursor can look one up without qualifying its name.
+ *  A name such as "RSMPCA_COEF[12]" is split into the same key.
+ *
+ *  A field is only constructed when it is asked for, with the name it
+ *  has always had.  The field and the name belong to the store, and are
+ *  valid until the store is cleared or destroyed.  If an arena was
+ *  current when the store was constructed (see nitf_Arena_setCurrent),
+ *  they are allocated from it, and the arena must outlive the store.
+ */
+typedef struct _nitf_TREFieldStore
+{
+    char *raw;                      /* the values, each null-terminated */
+    size_t rawLength;
+    size_t rawCapacity;
+    nitf_TREFieldEntry *entries;    /* the fields, in the order added */
+    nitf_Uint32 numEntries;
+    nitf_Uint32 entryCapacity;
+    nitf_Uint32 *indices;           /* the loop indices of all the fields */
+    nitf_Uint32 numIndices;
+    nitf_Uint32 indexCapacity;
+    nitf_Uint32 *table;             /* entry numbers plus one, hashed by key */
+    nitf_Uint32 tableSize;          /* a power of two, or zero */
+    nitf_Arena *arena;              /* where fields are constructed, or NULL */
+} nitf_TREFieldStore;
+
+/*! The deepest loop nesting a field key can have */
+#define NITF_TRE_FIELD_MAX_DEPTH 16
+
+/*!
+ *  Construct an empty field store.
+ *  \param error The error to populate on failure
+ *  \return The store, or NULL on failure
+ */
+NITFAPI(nitf_TREFieldStore *) nitf_TREFieldStore_construct(nitf_Error * error);
+
+/*!
+ *  Copy a field store.  The values of the fields that have been
+ *  constructed are copied into the raw buffer of the new store.
+ *  \param source The store to copy
+ *  \param error The error to populate on failure
+ *  \return The copy, or NULL on failure
+ */
+NITFAPI(nitf_TREFieldStore *) nitf_TREFieldStore_clone(
+        nitf_TREFieldStore * source, nitf_Error * error);
+
+/*!
+ *  Destroy a field store, with any fields constructed from it.
+ *  \param store The store to destroy and NULL-set
+ */
+NITFAPI(void) nitf_TREFieldStore_destruct(nitf_TREFieldStore ** store);
+
+/*!
+ *  Remove all of the fields, keeping the memory for reuse.
+ *  \param store The store
+ */
+NITFAPI(void) nitf_TREFieldStore_clear(nitf_TREFieldStore * store);
+
+/*!
+ *  Add a field to the end of the store.  An existing field with the same
+ *  key is not replaced, and continues to be the one found.
+ *
+ *  \param store The store
+ *  \param tag The tag of the description entry, which must remain valid
+ *  for the life of the store
+ *  \param idx The loop indices
+ *  \param depth The number of loop indices
+ *  \param type The type of the field
+ *  \param data The value, or NULL to fill it with the default for its type
+ *  \param length The length of the value
+ *  \param error The error to populate on failure
+ *  \return The entry number of the field, or -1 on failure
+ */
+NITFAPI(int) nitf_TREFieldStore_add(nitf_TREFieldStore * store,
+                                    const char *tag,
+                                    const int *idx,
+                                    int depth,
+                                    nitf_FieldType type,
+                                    const char *data,
+                                    size_t length,
+                                    nitf_Error * error);
+
+/*!
+ *  Find a field by its tag and loop indices.
+ *  \return The entry number of the field, or -1 if there is none
+ */
+NITFAPI(int) nitf_TREFieldStore_find(nitf_TREFieldStore * store,
+                                     const char *tag,
+                                     const int *idx,
+                                     int depth);
+
+/*!
+ *  Find a field by its qualified name, for example "BAND[2]".
+ *  \return The entry number of the field, or -1 if there is none
+ */
+NITFAPI(int) nitf_TREFieldStore_findName(nitf_TREFieldStore * store,
+                                         const char *name);
+
+/*!
+ *  Get a field without constructing it.  If the field has not been
+ *  constructed, the view is pointed at its value in the raw buffer, and
+ *  can be read or written in place.  It is only valid until the next
+ *  field is added.
+ *
+ *  \param store The store
+ *  \param n The entry number
+ *  \param view The field to fill in, if the field has not been constructed
+ *  \return The field, or the view
+ */
+NITFAPI(nitf_Field *) nitf_TREFieldStore_view(nitf_TREFieldStore * store,
+                                              int n,
+                                              nitf_Field * view);
+
+/*!
+ *  Get a field and its qualified name, constructing them the first time.
+ *  \param store The store
+ *  \param n The entry number
+ *  \param error The error to populate on failure
+ *  \return The pair, or NULL on failure
+ */
+NITFAPI(nitf_Pair *) nitf_TREFieldStore_getPair(nitf_TREFieldStore * store,
+                                                int n,
+                                                nitf_Error * error);
+
+/*!
+ *  Give the store a field that was constructed elsewhere.  The field
+ *  replaces the one with the same qualified name, or is added to the end
+ *  of the store.  The store owns the field from then on.
+ *  \param store The store
+ *  \param tag The tag of the description entry, used if the field is
+ *  added, which must remain valid for the life of the store
+ *  \param name The qualified name of the field, for example "BAND[2]"
+ *  \param field The field
+ *  \param error The error to populate on failure
+ *  \return The entry number of the field, or -1 on failure
+ */
+NITFAPI(int) nitf_TREFieldStore_adopt(nitf_TREFieldStore * store,
+                                      const char *tag,
+                                      const char *name,
+                                      nitf_Field * field,
+                                      nitf_Error * error);
+
+/*!
+ *  Set the value of a field, as nitf_Field_setRawData does.
+ *  \param store The store
+ *  \param n The entry number
+ *  \param data The value
+ *  \param dataLength The length of the value
+ *  \param error The error to populate on failure
+ *  \return NITF_SUCCESS, or NITF_FAILURE on failure
+ */
+NITFAPI(NITF_BOOL) nitf_TREFieldStore_set(nitf_TREFieldStore * store,
+                                          int n,
+                                          NITF_DATA * data,
+                                          size_t dataLength,
+                                          nitf_Error * error);
+
+/*!
+ *  Write the qualified name of a field, for example "BAND[2]", truncated
+ *  to the size of the buffer.
+ *  \param store The store
+ *  \param n The entry number
+ *  \param name The buffer
+ *  \param size The size of the buffer
+ */
+NITFAPI(void) nitf_TREFieldStore_getName(nitf_TREFieldStore * store,
+                                         int n,
+                                         char *name,
+                                         size_t size);
+
+NITF_CXX_ENDGUARD
+
+#endif
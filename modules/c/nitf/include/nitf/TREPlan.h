@@ -0,0 +1,133 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; if not, If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NITF_TRE_PLAN_H__
+#define __NITF_TRE_PLAN_H__
+
+#include "nitf/System.h"
+#include "nitf/TRE.h"
+#include "nitf/TREDescription.h"
+
+NITF_CXX_GUARD
+
+/*  What a plan entry or postfix token refers to  */
+enum
+{
+    NITF_TRE_PLAN_NONE = 0,     /* nothing to evaluate */
+    NITF_TRE_PLAN_CONST,        /* a constant value */
+    NITF_TRE_PLAN_FUNCTION,     /* a NITF_FUNCTION loop counter */
+    NITF_TRE_PLAN_FIELD,        /* the value of another field */
+    NITF_TRE_PLAN_OP            /* a postfix operator */
+};
+
+/*!
+ *  A reference from the description to a field that has been read already
+ */
+typedef struct _nitf_TREPlanRef
+{
+    char *tag;      /* the tag, without any braces */
+    int depth;      /* the loop indices to qualify it with, -1 to search */
+    int entry;      /* the store entry of a field in the fixed section */
+} nitf_TREPlanRef;
+
+/*!
+ *  One token of a postfix length expression
+ */
+typedef struct _nitf_TREPlanToken
+{
+    int kind;               /* NITF_TRE_PLAN_CONST, _FIELD or _OP */
+    int value;              /* the constant, or the operator character */
+    nitf_TREPlanRef ref;    /* the field, for NITF_TRE_PLAN_FIELD */
+} nitf_TREPlanToken;
+
+/*!
+ *  The compiled form of one nitf_TREDescription entry.  Loops and ifs
+ *  know where their matching end is, and their labels and the postfix
+ *  expressions of conditional lengths are parsed ahead of time.  A label
+ *  with an invalid operator is only reported when (and if) the cursor
+ *  reaches it, as it always has been.
+ */
+typedef struct _nitf_TREPlanEntry
+{
+    int end;                /* LOOP and IF: the matching ENDLOOP or ENDIF */
+    int depth;              /* the number of loops the entry is in */
+    int kind;               /* how the loop count or condition is found */
+    nitf_TREPlanRef ref;    /* the field a loop count or condition uses */
+    int op;                 /* the label operator, -1 if it is invalid */
+    int value;              /* the label operand, or the constant count */
+    const char *string;     /* the operand of an IF eq/ne, in the label */
+    nitf_TREPlanToken *postfix; /* the tokens of the special expression */
+    int numTokens;
+    int offset;             /* fixed section fields: the offset in the TRE */
+} nitf_TREPlanEntry;
+
+/*!
+ *  A TRE description, compiled for the cursor.  A description without
+ *  loops, ifs or length expressions has nothing to compile, and shares a
+ *  plan with no entries.
+ *
+ *  The fixed section is the run of fixed length fields the description
+ *  starts with.  They are always the first fields of a parsed TRE, so
+ *  they are read at the offsets in their entries, and a reference to one
+ *  of them is resolved to its entry number in the field store.
+ */
+typedef struct _nitf_TREPlan
+{
+    nitf_TREDescription *description;   /* the compiled description */
+    int numItems;                       /* the entries, before NITF_END */
+    nitf_TREPlanEntry *entries;         /* numItems entries, or NULL */
+    int numFixed;                       /* the fields in the fixed section */
+    int fixedLength;                    /* the length of the fixed section */
+    nitf_TREDescription first;          /* the first entry compiled */
+    struct _nitf_TREPlan *next;         /* the next plan in the cache */
+} nitf_TREPlan;
+
+
+/*!
+ *  Get the plan for a TRE description.  Each description is compiled the
+ *  first time it is used, and the plan is kept until nitf_TREPlan_cleanup.
+ *  Plans are found by the address of the description, and the first entry
+ *  is checked on each lookup, so a description that is built at run time,
+ *  freed, and replaced by another at the same address is compiled again.
+ *  The plan it had is retired rather than freed, as other threads may
+ *  still be using it.  The plan is shared, and must not be modified or
+ *  freed by the caller.
+ *
+ *  \param description The description, terminated by NITF_END
+ *  \param numItems Returns the number of entries before NITF_END
+ *  \param error The structure to populate if an error occurs
+ *  \return The plan, or NULL on failure
+ */
+NITFPROT(nitf_TREPlan *) nitf_TREPlan_get(nitf_TREDescription * description,
+                                          int *numItems,
+                                          nitf_Error * error);
+
+/*!
+ *  Free every plan, including the retired ones.  This is called when the
+ *  plugin registry is destroyed at exit, before the plugins that own the
+ *  descriptions are unloaded.  No cursor may be in use.
+ */
+NITFPROT(void) nitf_TREPlan_cleanup(void);
+
+NITF_CXX_ENDGUARD
+
+#endif
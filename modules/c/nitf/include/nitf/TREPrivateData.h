@@ -25,21 +25,32 @@
 
 #include "nitf/TRE.h"
 #include "nitf/TREDescription.h"
+#include "nitf/TREFieldStore.h"
 
 NITF_CXX_GUARD
 
 
 /*!
  * A structure meant to be used for the private data of the TRE structure.
- * It keeps track of the length (if given) as well as the Description
+ * It keeps track of the length (if given) as well as the Description,
+ * and holds the fields (see nitf_TREFieldStore).
+ *
+ * The hash is kept for handlers that construct fields themselves and
+ * insert them by their qualified names, as all handlers once did.  Such
+ * a field is adopted by the store the next time the fields are used (see
+ * nitf_TREPrivateData_sync), and stays in the hash, so the handler can
+ * still find it there.  A field whose tag is not in the description is
+ * only in the hash.  The fields the TRE utilities read are not put in
+ * the hash; use nitf_TREPrivateData_getField to find any field.
  */
 typedef struct _nitf_TREPrivateData
 {
     nitf_Uint32 length;
     char* descriptionName;   /* the name/ID of the TREDescription */
     nitf_TREDescription* description;
-    nitf_HashTable *hash;
+    nitf_HashTable *hash;   /* fields inserted by handlers, by name */
     NITF_DATA *userData;    /*! user-defined - meant for extending this */
+    nitf_TREFieldStore *fields;
 } nitf_TREPrivateData;
 
 
@@ -54,9 +65,43 @@ NITFAPI(void) nitf_TREPrivateData_destruct(nitf_TREPrivateData **priv);
 NITFPROT(NITF_BOOL) nitf_TREPrivateData_flush(nitf_TREPrivateData *priv,
                                               nitf_Error * error);
 
+/*!
+ * Give the store the fields a handler has inserted into the hash.  This
+ * is done by every function here and in nitf_TREUtils that uses the
+ * fields, and only needs to be called by a handler that reads the store
+ * itself.
+ *
+ * \param priv The private data
+ * \param error The error to populate on failure
+ * \return NITF_SUCCESS, or NITF_FAILURE on failure
+ */
+NITFPROT(NITF_BOOL) nitf_TREPrivateData_sync(nitf_TREPrivateData *priv,
+                                             nitf_Error * error);
+
 NITFPROT(NITF_BOOL) nitf_TREPrivateData_setDescriptionName(
         nitf_TREPrivateData *priv, const char* name, nitf_Error * error);
 
+/*!
+ * Get a field by its qualified name, for example "BAND[2]".
+ *
+ * \param priv The private data
+ * \param name The name of the field
+ * \return The field, or NULL if there is no such field
+ */
+NITFAPI(nitf_Field *) nitf_TREPrivateData_getField(
+        nitf_TREPrivateData *priv, const char* name);
+
+/*!
+ * Find the fields whose qualified names contain a pattern.
+ *
+ * \param priv The private data
+ * \param pattern The string to look for in the names
+ * \param error The error to populate on failure
+ * \return A list of the matching nitf_Pair objects, in order, or NULL
+ */
+NITFAPI(nitf_List *) nitf_TREPrivateData_find(
+        nitf_TREPrivateData *priv, const char* pattern, nitf_Error * error);
+
 
 
 NITF_CXX_ENDGUARD
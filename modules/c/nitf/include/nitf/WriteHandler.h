@@ -42,6 +42,15 @@ typedef NITF_BOOL(*NITF_IWRITEHANDLER_WRITE)(NITF_DATA *data,
  */
 typedef void (*NITF_IWRITEHANDLER_DESTRUCT)(NITF_DATA *);
 
+/*
+ *  Function pointer for the length of the data that will be written.
+ *  \param data     The ancillary "helper" data
+ *  \param error    populated on error
+ *  \return The length in bytes, or -1 if it is not known before the write
+ */
+typedef nitf_Off (*NITF_IWRITEHANDLER_GET_SIZE)(NITF_DATA *data,
+        nitf_Error *error);
+
 /*!
  *  \struct nitf_IWriteHandler
  *  \brief The "write handler" interface, which handles writing data
@@ -50,6 +59,9 @@ typedef struct _nitf_IWriteHandler
 {
     NITF_IWRITEHANDLER_WRITE write;
     NITF_IWRITEHANDLER_DESTRUCT destruct;
+
+    /* Optional, may be NULL (see nitf_WriteHandler_getSize) */
+    NITF_IWRITEHANDLER_GET_SIZE getSize;
 } nitf_IWriteHandler;
 
 typedef struct _nitf_WriteHandler
@@ -60,6 +72,19 @@ typedef struct _nitf_WriteHandler
 
 NITFAPI(void) nitf_WriteHandler_destruct(nitf_WriteHandler **writeHandler);
 
+/*!
+ *  Returns the number of bytes the handler will write, before the write.
+ *  This is needed to write to an output that cannot seek (see
+ *  nitf_Writer_setStreaming).
+ *
+ *  \param writeHandler The handler
+ *  \param error        populated on error
+ *  \return The length in bytes, or -1 if the handler does not know it (in
+ *  which case the error is set)
+ */
+NITFAPI(nitf_Off) nitf_WriteHandler_getSize(nitf_WriteHandler *writeHandler,
+                                            nitf_Error *error);
+
 NITF_CXX_ENDGUARD
 
 #endif
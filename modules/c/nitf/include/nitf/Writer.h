@@ -50,6 +50,8 @@ typedef struct _nitf_Writer
     int numGraphicWriters;
     int numDataExtensionWriters;
     NITF_BOOL ownOutput;
+    NITF_BOOL streaming;
+    nitf_Uint32 writeThreads;
 }
 nitf_Writer;
 
@@ -165,6 +167,45 @@ NITFAPI(nitf_SegmentWriter*) nitf_Writer_newDEWriter(nitf_Writer *writer,
         int index, nitf_Error * error);
 
 
+/*!
+ * Write the record strictly front to back, so that the output never has
+ * to seek or be read (a pipe or a socket, for instance).
+ *
+ * Normally the file header and the segment lengths are fixed up once the
+ * data has been written.  A streaming write works out every length first,
+ * which means that each WriteHandler has to know how much data it will
+ * write (see nitf_WriteHandler_getSize).  Uncompressed images know this
+ * already, compressed ones need nitf_ImageWriter_setDataLength.  Masked
+ * images (IC NM and M*) cannot be streamed.  The CLEVEL
+ * and FDT are filled in before the header is written, as usual.  The write
+ * fails if a segment writes more or less data than it said it would.
+ *
+ * \param writer    The Writer object
+ * \param enable    Enable streaming if TRUE
+ */
+NITFAPI(void) nitf_Writer_setStreaming(nitf_Writer * writer,
+                                       NITF_BOOL enable);
+
+
+/*!
+ * Set the number of threads used to write the image segments.
+ *
+ * If there is more than one image and the length of every segment's data
+ * is known before the write (see nitf_WriteHandler_getSize), the offset
+ * of each image in the file is worked out first and the images are
+ * written at once, one per thread, with positional writes on the output
+ * (see nrt_IOInterface_writeAt).  The file header, the subheaders and the
+ * other segments are written afterwards.  Otherwise, the segments are
+ * written one after another.  The band sources of different images must
+ * not share state, since they are read at the same time.
+ *
+ * \param writer        The Writer object
+ * \param numThreads    Number of threads, 0 for one per CPU
+ */
+NITFAPI(void) nitf_Writer_setWriteThreads(nitf_Writer * writer,
+                                          nitf_Uint32 numThreads);
+
+
 /*!
  * Performs the write operation
  *
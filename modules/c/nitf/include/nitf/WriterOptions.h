@@ -30,6 +30,15 @@ NITF_CXX_GUARD
 #define C8_COMPRESSION_RATIO_KEY "compressionRatio"
 #define C8_NUM_RESOLUTIONS_KEY   "numResolutions"
 
+/*
+ *  C3/M3 (JPEG) options, each a nitf_Uint32: the JPEG quality (1 - 100,
+ *  default 75), the restart interval in MCUs (default 0, no restart
+ *  markers) and the number of encoding threads (default 0, one per CPU)
+ */
+#define C3_QUALITY_KEY           "quality"
+#define C3_RESTART_INTERVAL_KEY  "restartInterval"
+#define C3_NUM_THREADS_KEY       "numThreads"
+
 NITF_CXX_ENDGUARD
 
 #endif
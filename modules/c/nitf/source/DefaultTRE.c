@@ -73,10 +73,11 @@ NITFPRIV(NITF_BOOL) defaultRead(nitf_IOInterface *io,
                                 struct _nitf_Record* record,
                                 nitf_Error * error)
 {
-    nitf_Field *field = NULL;
+    nitf_Field view;
     nitf_TREDescription *descr = NULL;
-    char *data = NULL;
+    nitf_TREFieldStore *fields;
     NITF_BOOL success;
+    int n;
 
     if (!tre)
     {
@@ -84,17 +85,6 @@ NITFPRIV(NITF_BOOL) defaultRead(nitf_IOInterface *io,
         goto CATCH_ERROR;
     }
 
-    /*  malloc the space for the raw data */
-    data = (char *) NITF_MALLOC(length + 1);
-    if (!data)
-    {
-        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
-                        NITF_CTXT, NITF_ERR_MEMORY);
-
-        goto CATCH_ERROR;
-    }
-    memset(data, 0, length + 1);
-
     descr =
         (nitf_TREDescription *) NITF_MALLOC(2 *
                                             sizeof(nitf_TREDescription));
@@ -121,26 +111,18 @@ NITFPRIV(NITF_BOOL) defaultRead(nitf_IOInterface *io,
     ((nitf_TREPrivateData*)tre->priv)->length = length;
     ((nitf_TREPrivateData*)tre->priv)->description = descr;
 
-    /*  Read the data extension into the tre  */
-    success = nitf_TREUtils_readField(io, data, (int) length, error);
-    if (!success)
+    /*  Make room for the field, and read the data straight into it  */
+    fields = ((nitf_TREPrivateData*)tre->priv)->fields;
+    n = nitf_TREFieldStore_add(fields, NITF_TRE_RAW, NULL, 0,
+                               NITF_BINARY, NULL, length, error);
+    if (n < 0)
         goto CATCH_ERROR;
 
-    field = nitf_Field_construct(length, NITF_BINARY, error);
-    if (field == NULL)
-    {
-        goto CATCH_ERROR;
-    }
-    /* TODO -- likely inefficient, since we end up copying the raw data here */
-    if (!nitf_Field_setRawData
-            (field, (NITF_DATA *) data, length, error))
-    {
+    success = nitf_TREUtils_readField(io,
+            nitf_TREFieldStore_view(fields, n, &view)->raw,
+            (int) length, error);
+    if (!success)
         goto CATCH_ERROR;
-    }
-    nitf_HashTable_insert(((nitf_TREPrivateData*)tre->priv)->hash,
-            NITF_TRE_RAW, field, error);
-
-    NITF_FREE(data);
 
 #ifdef NITF_PRINT_TRES
     printf
@@ -169,14 +151,15 @@ NITFPRIV(NITF_BOOL) defaultWrite(nitf_IOInterface* io,
 				 nitf_Error* error)
 {
     nitf_Field* field;
-    nitf_Pair* pair = nitf_HashTable_find(
-            ((nitf_TREPrivateData*)tre->priv)->hash, NITF_TRE_RAW);
-    if (pair == NULL)
+    nitf_Field view;
+    nitf_TREFieldStore* fields = ((nitf_TREPrivateData*)tre->priv)->fields;
+    int n = nitf_TREFieldStore_find(fields, NITF_TRE_RAW, NULL, 0);
+    if (n < 0)
     {
         nitf_Error_init(error, "No raw_data in default!", NITF_CTXT, NITF_ERR_INVALID_OBJECT);
         return NITF_FAILURE;
     }
-    field = (nitf_Field*)pair->data;
+    field = nitf_TREFieldStore_view(fields, n, &view);
 
     if (!nitf_IOInterface_write(io, field->raw, field->length, error))
         return NITF_FAILURE;
@@ -187,8 +170,11 @@ NITFPRIV(nitf_Pair*) defaultIncrement(nitf_TREEnumerator* it, nitf_Error* error)
 {
     if (it && it->data)
     {
-        nitf_Pair* data = nitf_HashTable_find(
-                ((nitf_TREPrivateData*)it->data)->hash, NITF_TRE_RAW);
+        nitf_TREFieldStore* fields =
+            ((nitf_TREPrivateData*)it->data)->fields;
+        int n = nitf_TREFieldStore_find(fields, NITF_TRE_RAW, NULL, 0);
+        nitf_Pair* data = n < 0 ? NULL :
+            nitf_TREFieldStore_getPair(fields, n, error);
         if (data)
         {
             it->data = NULL; /* set to NULL, since we only have one value */
@@ -244,8 +230,8 @@ NITFPRIV(nitf_TREEnumerator*) defaultBegin(nitf_TRE* tre, nitf_Error* error)
 	it->getFieldDescription = defaultGetFieldDescription;
 	it->data = tre->priv;
 
-	if (!it->data || !nitf_HashTable_find(
-	        ((nitf_TREPrivateData*)it->data)->hash, NITF_TRE_RAW))
+	if (!it->data || nitf_TREFieldStore_find(
+	        ((nitf_TREPrivateData*)it->data)->fields, NITF_TRE_RAW, NULL, 0) < 0)
 	{
 		nitf_Error_init(error, "No raw_data in default!", NITF_CTXT, NITF_ERR_INVALID_OBJECT);
 		return NITF_FAILURE;
@@ -258,29 +244,8 @@ NITFPRIV(nitf_List*) defaultFind(nitf_TRE* tre,
 				 const char* pattern,
 				 nitf_Error* error)
 {
-    nitf_List* list;
-
-    nitf_HashTableIterator it = nitf_HashTable_begin(
-            ((nitf_TREPrivateData*)tre->priv)->hash);
-    nitf_HashTableIterator end = nitf_HashTable_end(
-            ((nitf_TREPrivateData*)tre->priv)->hash);
-
-    list = nitf_List_construct(error);
-    if (!list) return NULL;
-
-    while (nitf_HashTableIterator_notEqualTo(&it, &end))
-    {
-        nitf_Pair* pair = nitf_HashTableIterator_get(&it);
-
-    	if (strstr(pair->key, pattern))
-    	{
-    	    /* Should check this, I suppose */
-    	    nitf_List_pushBack(list, pair, error);
-    	}
-    	nitf_HashTableIterator_increment(&it);
-    }
-
-    return list;
+    return nitf_TREPrivateData_find((nitf_TREPrivateData*)tre->priv,
+                                    pattern, error);
 }
 
 NITFPRIV(NITF_BOOL) defaultSetField(nitf_TRE * tre,
@@ -288,47 +253,41 @@ NITFPRIV(NITF_BOOL) defaultSetField(nitf_TRE * tre,
                                     NITF_DATA * data,
                                     size_t dataLength, nitf_Error * error)
 {
-	nitf_Field* field = NULL;
+    nitf_TREFieldStore* fields = ((nitf_TREPrivateData*)tre->priv)->fields;
+    NITF_BOOL exists;
 
-	if (strcmp(tag, NITF_TRE_RAW))
-	{
+    if (strcmp(tag, NITF_TRE_RAW))
+    {
         nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER, "Invalid param [%s]", tag);
         return NITF_FAILURE;
-	}
+    }
 
-	field = nitf_Field_construct(dataLength, NITF_BINARY, error);
-    if (!field)
+    if (!data || dataLength == 0)
+    {
+        nitf_Error_init(error, "Invalid raw data",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
         return NITF_FAILURE;
+    }
 
-    /* TODO -- likely inefficient, since we end up copying the raw data here */
-    if (!nitf_Field_setRawData(field, (NITF_DATA *) data, dataLength, error))
+    /* the raw data is the only field, so replace all of them */
+    exists = nitf_TREFieldStore_find(fields, NITF_TRE_RAW, NULL, 0) >= 0;
+    nitf_TREFieldStore_clear(fields);
+    if (nitf_TREFieldStore_add(fields, NITF_TRE_RAW, NULL, 0, NITF_BINARY,
+                               (const char *) data, dataLength, error) < 0)
         return NITF_FAILURE;
 
-	if (nitf_HashTable_exists(((nitf_TREPrivateData*)tre->priv)->hash, tag))
-	{
-        nitf_Field* oldValue;
-        nitf_Pair* pair = nitf_HashTable_find(
-                ((nitf_TREPrivateData*)tre->priv)->hash, tag);
-        oldValue = (nitf_Field*)pair->data;
-        nitf_Field_destruct(&oldValue);
-        pair->data = field;
-        return NITF_SUCCESS;
-	}
-
-	/* reset the lengths in two places */
-	((nitf_TREPrivateData*)tre->priv)->length = dataLength;
-	((nitf_TREPrivateData*)tre->priv)->description[0].data_count = dataLength;
-
-	return nitf_HashTable_insert(((nitf_TREPrivateData*)tre->priv)->hash,
-	        tag, field, error);
+    if (!exists)
+    {
+        /* reset the lengths in two places */
+        ((nitf_TREPrivateData*)tre->priv)->length = dataLength;
+        ((nitf_TREPrivateData*)tre->priv)->description[0].data_count = dataLength;
+    }
+    return NITF_SUCCESS;
 }
 
 NITFPRIV(nitf_Field*) defaultGetField(nitf_TRE* tre, const char* tag)
 {
-    nitf_Pair* pair = nitf_HashTable_find(
-            ((nitf_TREPrivateData*)tre->priv)->hash, tag);
-    if (!pair) return NULL;
-    return (nitf_Field*)pair->data;
+    return nitf_TREPrivateData_getField((nitf_TREPrivateData*)tre->priv, tag);
 }
 
 
@@ -351,7 +310,7 @@ NITFPRIV(NITF_BOOL) defaultClone(nitf_TRE *source,
 
     sourcePriv = (nitf_TREPrivateData*)source->priv;
 
-    /* this clones the hash */
+    /* this clones the fields */
     if (!(trePriv = nitf_TREPrivateData_clone(sourcePriv, error)))
         return NITF_FAILURE;
 
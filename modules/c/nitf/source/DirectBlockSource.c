@@ -70,10 +70,10 @@ NITFPRIV(NITF_BOOL) DirectBlockSource_read(NITF_DATA * data, void *buf, nitf_Off
     if (!directBlockSource)
         return NITF_FAILURE;
 
-    block = nitf_ImageIO_readBlockDirect(directBlockSource->imageReader->imageDeblocker, 
-                                         directBlockSource->imageReader->input, 
-                                         directBlockSource->blockNumber++, 
-                                         &blockSize, error);
+    block = nitf_ImageIO_getBlockDirect(directBlockSource->imageReader->imageDeblocker, 
+                                        directBlockSource->imageReader->input, 
+                                        directBlockSource->blockNumber++, 
+                                        &blockSize, error);
     if(!block)
         return NITF_FAILURE;
 
@@ -52,9 +52,42 @@ NITF_BOOL copyAndFillZeros(nitf_Field * field,
     return NITF_SUCCESS;
 }
 
-NITFAPI(nitf_Field *) nitf_Field_construct(size_t length,
-        nitf_FieldType type,
-        nitf_Error * error)
+/*  Fills the data of a field with the default for its type  */
+NITFPRIV(NITF_BOOL) fillField(nitf_Field * field, nitf_Error * error)
+{
+    char fill = 0;
+
+    field->raw[field->length] = 0; /* terminating null byte */
+    switch (field->type)
+    {
+        case NITF_BCS_A:
+            fill = ' ';
+            break;
+        case NITF_BCS_N:
+            fill = '0';
+            break;
+        case NITF_BINARY:
+            fill = 0;
+            break;
+        default:
+            nitf_Error_initf(error, NITF_CTXT,
+                             NITF_ERR_INVALID_PARAMETER,
+                             "Invalid type [%d]", field->type);
+            return NITF_FAILURE;
+    }
+
+    memset(field->raw, fill, field->length);
+    return NITF_SUCCESS;
+}
+
+/*  Is the data of the field the one allocated along with it?  */
+#define NITF_FIELD_INLINE_RAW(F) ((F)->pooled && \
+                                  (F)->raw == (char *) ((F) + 1))
+
+NITFPRIV(nitf_Field *) constructField(size_t length,
+                                      nitf_FieldType type,
+                                      nitf_Arena * arena,
+                                      nitf_Error * error)
 {
     nitf_Field *field = NULL;
 
@@ -65,6 +98,29 @@ NITFAPI(nitf_Field *) nitf_Field_construct(size_t length,
         goto CATCH_ERROR;
     }
 
+    if (arena)
+    {
+        /*  The field and its data come from one arena allocation  */
+        field = (nitf_Field *) nitf_Arena_alloc(arena,
+                sizeof(nitf_Field) + length + 1);
+        if (!field)
+        {
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                            NITF_CTXT, NITF_ERR_MEMORY);
+            goto CATCH_ERROR;
+        }
+
+        field->type = type;
+        field->raw = (char *) (field + 1);
+        field->length = length;
+        field->resizable = 0;
+        field->pooled = 1;
+
+        if (!fillField(field, error))
+            goto CATCH_ERROR;
+        return field;
+    }
+
     field = (nitf_Field *) NITF_MALLOC(sizeof(nitf_Field));
     if (!field)
     {
@@ -77,6 +133,7 @@ NITFAPI(nitf_Field *) nitf_Field_construct(size_t length,
     field->raw = NULL;
     field->length = 0; /* this gets set by resizeField */
     field->resizable = 1; /* set to 1 so we can use the resize code */
+    field->pooled = 0;
 
     if (!nitf_Field_resizeField(field, length, error))
         goto CATCH_ERROR;
@@ -91,6 +148,14 @@ NITFAPI(nitf_Field *) nitf_Field_construct(size_t length,
 }
 
 
+NITFAPI(nitf_Field *) nitf_Field_construct(size_t length,
+        nitf_FieldType type,
+        nitf_Error * error)
+{
+    return constructField(length, type, nitf_Arena_getCurrent(), error);
+}
+
+
 NITFAPI(NITF_BOOL) nitf_Field_setRawData(nitf_Field * field,
         NITF_DATA * data,
         size_t dataLength,
@@ -524,13 +589,15 @@ NITFAPI(void) nitf_Field_destruct(nitf_Field ** field)
 {
     if (*field)
     {
-        if ((*field)->raw)
+        if ((*field)->raw && !NITF_FIELD_INLINE_RAW(*field))
         {
             NITF_FREE((*field)->raw);
             (*field)->raw = NULL;
         }
 
-        NITF_FREE(*field);
+        /*  Arena memory is released with the arena  */
+        if (!(*field)->pooled)
+            NITF_FREE(*field);
         *field = NULL;
     }
 }
@@ -550,8 +617,8 @@ NITFAPI(nitf_Field *) nitf_Field_clone(nitf_Field * source,
 
     if (source)
     {
-        /* construct new one */
-        field = nitf_Field_construct(source->length, source->type, error);
+        /* construct new one, outside of any arena */
+        field = constructField(source->length, source->type, NULL, error);
         if (field)
         {
             field->resizable = source->resizable;
@@ -1048,7 +1115,8 @@ NITFPROT(NITF_BOOL) nitf_Field_resetLength(nitf_Field * field,
         }
 
         /* free the old memory */
-        NITF_FREE(raw);
+        if (raw != (char *) (field + 1) || !field->pooled)
+            NITF_FREE(raw);
     }
     else
     {
@@ -1089,15 +1157,13 @@ NITFAPI(NITF_BOOL) nitf_Field_resizeField(nitf_Field *field,
                                           size_t newLength,
                                           nitf_Error *error)
 {
-    char fill = 0;
-
     /* it must be resizable */
     if (!field->resizable)
         return NITF_FAILURE;
 
     if (field && newLength != field->length)
     {
-        if (field->raw)
+        if (field->raw && !NITF_FIELD_INLINE_RAW(field))
             NITF_FREE(field->raw);
 
         field->raw = NULL;
@@ -1114,26 +1180,8 @@ NITFAPI(NITF_BOOL) nitf_Field_resizeField(nitf_Field *field,
         /* set the new length */
         field->length = newLength;
 
-        field->raw[newLength] = 0; /* terminating null byte */
-        switch (field->type)
-        {
-            case NITF_BCS_A:
-                fill = ' ';
-                break;
-            case NITF_BCS_N:
-                fill = '0';
-                break;
-            case NITF_BINARY:
-                fill = 0;
-                break;
-            default:
-                nitf_Error_initf(error, NITF_CTXT,
-                                 NITF_ERR_INVALID_PARAMETER,
-                                 "Invalid type [%d]", field->type);
-                goto CATCH_ERROR;
-        }
-
-        memset(field->raw, fill, field->length);
+        if (!fillField(field, error))
+            goto CATCH_ERROR;
     }
 
     return NITF_SUCCESS;
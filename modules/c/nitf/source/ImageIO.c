@@ -22,6 +22,31 @@
 
 #include "nitf/ImageIO.h"
 
+/*
+ *  The byte swap, sign extension and shift unformatters use SSE2 (always
+ *  present on x86-64) and, when the processor supports it, AVX2. Both are
+ *  selected at run time, with the scalar loops as the fallback and for
+ *  the tails. Define NITF_IMAGE_IO_NO_SIMD to build the scalar code only.
+ */
+#if !defined(NITF_IMAGE_IO_NO_SIMD) && \
+    (defined(__SSE2__) || defined(_M_X64) || \
+     (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define NITF_IMAGE_IO_SSE2
+#include <emmintrin.h>
+#if (defined(__GNUC__) && \
+     (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))) || \
+    defined(__clang__)
+#define NITF_IMAGE_IO_AVX2
+#define NITF_IMAGE_IO_AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && _MSC_VER >= 1800
+#define NITF_IMAGE_IO_AVX2
+#define NITF_IMAGE_IO_AVX2_TARGET
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+#endif
+
 
 /*!
   \file
@@ -135,6 +160,25 @@ compression of a one byte unsigned image.\n
    in bytes */
 #define NITF_IMAGE_IO_PAD_MAX_LENGTH (16)
 
+/*! \def NITF_IMAGE_IO_READ_RUN_SIZE - Total size in bytes of the staging
+   buffers used to coalesce row reads (see nitf_ImageIO_coalescedReader) */
+#define NITF_IMAGE_IO_READ_RUN_SIZE (4 * 1024 * 1024)
+
+/*! \def NITF_IMAGE_IO_READ_RUN_GAP - Largest gap in bytes between the rows
+   of a coalesced read. Rows further apart are read one at a time */
+#define NITF_IMAGE_IO_READ_RUN_GAP (32 * 1024)
+
+/*! \def NITF_IMAGE_IO_NUM_SCALES - Number of reduced resolution decode
+   factors (2, 4 and 8, see nitf_ImageIO_getScaled) */
+#define NITF_IMAGE_IO_NUM_SCALES (3)
+
+/*! \def NITF_IMAGE_IO_VEC_* - Operations for nitf_ImageIO_vectorUnformat */
+#define NITF_IMAGE_IO_VEC_SWAP   (0x1)
+#define NITF_IMAGE_IO_VEC_EXTEND (0x2)
+#define NITF_IMAGE_IO_VEC_SHIFT  (0x4)
+#define NITF_IMAGE_IO_VEC_USHIFT (0x8)
+#define NITF_IMAGE_IO_VEC_LSHIFT (0x10)
+
 /*!
   \def NITF_IMAGE_IO_PAD_SCANNER - Macro to a create pad scan function
 
@@ -426,8 +470,8 @@ _nitf_ImageIOParameters;
 /*!
   \brief _nitf_ImageIOBlockCacheControl - Block cache control
 
-  The _nitf_ImageIOBlockCacheControl structure manages the block cache used by
-  the cached reader.
+  The _nitf_ImageIOBlockCacheControl structure manages the block buffer used
+  by the cached writer.
 
   If there is no block in a block buffer, the corresponding block number
   will be set to NITF_IMAGE_IO_NO_BLOCK.
@@ -437,7 +481,7 @@ _nitf_ImageIOParameters;
 
   The block buffers are allocated by the system memory allocation facility
 
-The current implementation supports a cache of one block
+The read side uses the multi-block _nitf_ImageIOBlockCache
 
 */
 
@@ -449,6 +493,70 @@ typedef struct
 }
 _nitf_ImageIOBlockCacheControl;
 
+/*!
+  \brief _nitf_ImageIOBlockCacheEntry - One block in the read block cache
+
+  Entries are kept in a doubly linked list ordered from most recently used
+  (the head) to least recently used (the tail).
+
+  The control is the decompression control whose readBlock function
+  returned the buffer, in which case it must be released via that control's
+  freeBlock function rather than NITF_FREE. Blocks decoded by the parallel
+  decompression workers belong to the worker's control, not the object's.
+*/
+
+typedef struct _nitf_ImageIOBlockCacheEntry_s
+{
+    nitf_Uint32 number;         /*!< Block number */
+    nitf_Uint8 *block;          /*!< Block buffer */
+    nitf_Uint64 size;           /*!< Block buffer size in bytes */
+    /*!< Control that decoded the buffer, NULL if allocated here */
+    nitf_DecompressionControl *control;
+    /*!< Next more recently used entry */
+    struct _nitf_ImageIOBlockCacheEntry_s *prev;
+    /*!< Next less recently used entry */
+    struct _nitf_ImageIOBlockCacheEntry_s *next;
+}
+_nitf_ImageIOBlockCacheEntry;
+
+/*!
+  \brief _nitf_ImageIOBlockCache - Read block cache
+
+  The _nitf_ImageIOBlockCache structure manages the block cache used by
+  the cached reader and direct block reads. Decoded (or, for uncompressed
+  data, raw) blocks are retained in least recently used order until the
+  total size of the cached buffers exceeds maxSize bytes. The most recently
+  used block is always retained so a maxSize of zero gives a cache of one
+  block, which was the original behavior.
+
+  The index is an array of nBlocksTotal + 1 entry pointers indexed by block
+  number. It is allocated on the first insertion.
+
+  The hit count is the number of times a block was found in the cache when
+  switching from one block to another (consecutive accesses to the same
+  block, as when reading successive rows of a block, are not counted). The
+  miss count is the number of blocks that had to be read or decompressed.
+
+  The reserved field is the space set aside for blocks decoded in parallel
+  ahead of a read (see nitf_ImageIO_readParallel). While it is non-zero
+  the cache is allowed to grow to the larger of maxSize and reserved.
+*/
+
+typedef struct
+{
+    nitf_Uint64 maxSize;        /*!< Cache size limit in bytes */
+    nitf_Uint64 reserved;       /*!< Space reserved for parallel decoding */
+    nitf_Uint64 size;           /*!< Current cache size in bytes */
+    nitf_Uint32 count;          /*!< Number of cached blocks */
+    _nitf_ImageIOBlockCacheEntry *head;  /*!< Most recently used block */
+    _nitf_ImageIOBlockCacheEntry *tail;  /*!< Least recently used block */
+    _nitf_ImageIOBlockCacheEntry **index;/*!< Block number to entry map */
+    nitf_Uint32 indexSize;      /*!< Number of entries in the index */
+    nitf_Uint64 hits;           /*!< Cache hit count */
+    nitf_Uint64 misses;         /*!< Cache miss count */
+}
+_nitf_ImageIOBlockCache;
+
 /*!
   \brief _nitf_ImageIO - Object private data structure
 
@@ -499,8 +607,8 @@ typedef struct
     nitf_Uint64 dataLength;     /*!< Length of the data including masks */
     /*!< Configuration parameters */
     _nitf_ImageIOParameters parameters;
-    /*!< Block control */
-    _nitf_ImageIOBlockCacheControl blockControl;
+    /*!< Read block cache */
+    _nitf_ImageIOBlockCache blockCache;
     /*!< Compression handler function */
     nitf_CompressionInterface *compressor;
     /*!< Decompression handler function */
@@ -518,9 +626,42 @@ typedef struct
     int oneBand;                /*!< Read/write one band at a time if TRUE */
     /*!< Control structure for current write */
     struct _nitf_ImageIOWriteControl_s *writeControl;
-    /*!< Control structure for current read */
-    struct _nitf_ImageIOReadControl_s *readControl;
+    /*!< Number of reads in progress */
+    int activeReads;
+    /*!< Signalled when activeReads drops to zero */
+    nitf_Condition readsDone;
+    /*!< Guards set-up, the read block cache and the decompressor */
+    nitf_Mutex lock;
+    /*!< Image subheader, for opening worker decompressors */
+    nitf_ImageSubheader *subheader;
+    /*!< Decompressor options, for opening worker decompressors */
+    nrt_HashTable *options;
+    /*!< Number of threads used to decompress blocks (1 is serial) */
+    nitf_Uint32 readThreads;
+    /*!< Parallel decompression workers (created on first use) */
+    struct _nitf_ImageIOWorker_s *workers;
+    nitf_Uint32 numWorkers;     /*!< Number of workers allocated */
+    nitf_Uint32 numRunning;     /*!< Number of worker threads running */
+    int workersBusy;            /*!< Workers in use by a read if TRUE */
+    /*!< Decompressor options of the workers, with the shared control */
+    nrt_HashTable *workerOptions;
+    /*!< Guards the fields below, which pass jobs to the worker threads */
+    nitf_Mutex workerLock;
+    nitf_Condition workReady;   /*!< Signalled for a new job or to stop */
+    nitf_Condition workDone;    /*!< Signalled when the job is finished */
+    struct _nitf_ImageIODecodeJob_s *job; /*!< The current job */
+    nitf_Uint32 jobSerial;      /*!< Incremented for each job */
+    nitf_Uint32 jobWorkers;     /*!< Workers still on the current job */
+    int stopWorkers;            /*!< Worker threads exit if TRUE */
     _NITF_IMAGE_IO_PAD_SCAN_FUNC padScanner; /*! Scans for pad pixels in write */
+    /*!< Decode down-sampled reads at reduced resolution if TRUE */
+    int scaledDecode;
+    /*!< Reduction factor of a reduced resolution decode object, else 1 */
+    nitf_Uint32 scale;
+    /*!< Reduced resolution decode objects by factor 2, 4, 8 (on first use) */
+    nitf_ImageIO *scaled[NITF_IMAGE_IO_NUM_SCALES];
+    /*!< Mask of the factors the decompressor cannot decode at */
+    nitf_Uint32 scalesDeclined;
 }
 _nitf_ImageIO;
 
@@ -632,6 +773,9 @@ typedef struct _nitf_ImageIOControl_s
     /*! Operation involved pad pixels */
     int padded;
 
+    /*! Parent's lock is held for the whole operation if TRUE */
+    int locked;
+
     /*! Total I/O count */
     size_t ioCount;
 
@@ -874,8 +1018,8 @@ _nitf_ImageIOWriteControl;
   Each of these functions configures the read control object for a
   particular writing method, such as sequential reads.
 
-  The ImageIO structure maintains a pointer to the current read control.
-  There can be only one active reader or writer for each ImageIO.
+  Each read creates its own read control, so several reads may be active
+  for one ImageIO at once (the ImageIO only counts them).
 
 This is an internal object and is not used directly by the user.
 
@@ -888,6 +1032,81 @@ typedef struct _nitf_ImageIOReadControl_s
 }
 _nitf_ImageIOReadControl;
 
+/*!
+  \brief _nitf_ImageIOCursor - Private file position over a shared IO
+  interface
+
+  The cursor is the data of an IO interface that reads from another
+  (shared) IO interface with positional reads while keeping its own file
+  position. It lets a decompressor, which seeks and reads, run on a thread
+  alongside other readers of the same file. The shared interface is not
+  owned, closing or destroying the cursor leaves it open.
+
+This is an internal object and is not used directly by the user.
+*/
+
+typedef struct
+{
+    nitf_IOInterface *io;       /*!< The shared interface */
+    nitf_Off offset;            /*!< This cursor's file position */
+}
+_nitf_ImageIOCursor;
+
+/*!
+  \brief _nitf_ImageIODecodeJob - A set of blocks to decode in parallel
+
+  The workers take block numbers from the job in order under the job's
+  lock and store the decoded block, its size and the control that decoded
+  it at the same index. On an error the first error is saved and the
+  remaining blocks are skipped.
+
+This is an internal object and is not used directly by the user.
+*/
+
+typedef struct _nitf_ImageIODecodeJob_s
+{
+    nitf_Uint32 *numbers;       /*!< Block numbers to decode */
+    nitf_Uint8 **blocks;        /*!< Decoded blocks (NULL until decoded) */
+    nitf_Uint64 *sizes;         /*!< Decoded block sizes */
+    /*!< Control that decoded each block, for freeing it */
+    nitf_DecompressionControl **controls;
+    nitf_Uint32 count;          /*!< Number of blocks */
+    nitf_Uint32 next;           /*!< Index of the next block to decode */
+    int failed;                 /*!< An error occurred if TRUE */
+    nitf_Error error;           /*!< The first error */
+    nitf_Mutex lock;            /*!< Guards next, failed and error */
+}
+_nitf_ImageIODecodeJob;
+
+/*!
+  \brief _nitf_ImageIOWorker - Parallel block decompression worker
+
+  Each worker has its own decompression control, started on its own
+  cursor over the image's IO interface, and its own copy of the blocking
+  information (which the decompressor may keep a pointer to). The control
+  is opened with the NITF_DECOMPRESSION_SHARED_KEY option, so it may take
+  over what the object's own, already started, control found instead of
+  scanning the data again. It is started the first time it is used.
+
+  The worker's thread is started with the worker and waits for jobs until
+  the workers are destroyed. A worker whose thread could not be started is
+  only used on the reading thread when no thread could be started.
+
+This is an internal object and is not used directly by the user.
+*/
+
+typedef struct _nitf_ImageIOWorker_s
+{
+    _nitf_ImageIO *nitf;        /*!< Parent _nitf_ImageIO object */
+    nitf_IOInterface *cursor;   /*!< Private position over the shared IO */
+    nitf_DecompressionControl *control; /*!< Decompression control */
+    nitf_BlockingInfo blockInfo; /*!< Blocking information for the control */
+    int started;                /*!< Control has been started if TRUE */
+    nitf_Thread thread;         /*!< The worker's thread */
+    nitf_Uint32 jobSerial;      /*!< Serial number of the last job taken */
+}
+_nitf_ImageIOWorker;
+
 /*!
   \brief nitf_ImageIO_BPixelControl - The actual implementation beneath the
   opaque decompression control pointer
@@ -1049,6 +1268,15 @@ NITFPRIV(int) nitf_ImageIO_decodeBlockingMode(_nitf_ImageIO* nitf,
 NITFPRIV(void) nitf_ImageIO_revertOptimizedModes(_nitf_ImageIO *nitfI,
                                                  int numBands);
 
+/*!
+ * Returns TRUE if nitf_ImageIO_revertOptimizedModes would change the object
+ * for the given number of bands.
+ * \param nitfI        the ImageIO structure
+ * \param numBands    the number of bands (when reading), or 0 when writing.
+ */
+NITFPRIV(NITF_BOOL) nitf_ImageIO_mustRevertOptimizedModes(_nitf_ImageIO *nitfI,
+                                                          int numBands);
+
 
 /*!
   \brief nitf_ImageIO_setIO - Set the reader and writer functions
@@ -1906,6 +2134,57 @@ I/O errors
 int nitf_ImageIO_uncachedReader(_nitf_ImageIOBlock * blockIO, nitf_IOInterface* io, nitf_Error * error    /*!< Error object */
                                );
 
+/*!
+  \brief _nitf_ImageIOReadRun - Coalesced read state for one block I/O
+
+  A read run holds the rows that nitf_ImageIO_coalescedReader has read
+  ahead for one block I/O structure. Rows that are contiguous in both the
+  file and the read buffer are read straight into the read buffer and
+  counted by rowsReady. Otherwise the rows of the block still to be read
+  are read, gaps and all, into the staging buffer and copied out one row
+  at a time. The staging buffer is allocated on first use.
+*/
+
+typedef struct
+{
+    nitf_Uint8 *buffer;         /*!< Staging buffer */
+    size_t capacity;            /*!< Staging buffer size in bytes */
+    nitf_Uint64 offset;         /*!< File offset of the staged data */
+    size_t length;              /*!< Length of the staged data in bytes */
+    nitf_Uint32 rowsReady;      /*!< Rows already in the read buffer */
+}
+_nitf_ImageIOReadRun;
+
+/*!
+  \brief nitf_ImageIO_coalescedReader - Read pixel data from a file,
+   merging the reads of successive rows
+
+  nitf_ImageIO_coalescedReader is used in place of
+  nitf_ImageIO_uncachedReader by nitf_ImageIO_readRequest. The rowsLeft
+  argument is the number of rows, including the current one, that the
+  request will read from the current block. When these rows are close
+  together in the file they are fetched with one read (see
+  _nitf_ImageIOReadRun) so that a request does a few large reads rather
+  than one read per row, band and block column.
+
+  \b Note:
+
+  This is an internal function and is not intended to be called
+directly by the user.
+
+\return Returns FALSE on error
+
+On error, the error object is set. Possible errors include:
+
+I/O errors
+*/
+
+NITFPRIV(int) nitf_ImageIO_coalescedReader(_nitf_ImageIOBlock * blockIO,
+                                           _nitf_ImageIOReadRun * run,
+                                           nitf_Uint32 rowsLeft,
+                                           nitf_IOInterface* io,
+                                           nitf_Error * error);
+
 /*!
   \brief nitf_ImageIO_cachedReader - Read pixel data from a file with
    block caching
@@ -1931,6 +2210,346 @@ I/O errors
 int nitf_ImageIO_cachedReader(_nitf_ImageIOBlock * blockIO, nitf_IOInterface* io, nitf_Error * error      /*!< Error object */
                              );
 
+/*!
+  \brief nitf_ImageIO_cacheGetBlock - Get a block via the read block cache
+
+  nitf_ImageIO_cacheGetBlock returns the requested block from the read block
+  cache, reading (uncompressed data) or decompressing the block and adding
+  it to the cache if it is not present. Least recently used blocks are
+  evicted to keep the cache within its size limit.
+
+  The block number is the index into the image's block mask (for blocking
+  mode "S" this includes the band offset).
+
+  The returned buffer belongs to the cache and remains valid until the
+  next call.
+
+  \b Note:
+
+  This is an internal function and is not intended to be called directly by
+the user.
+
+\return Returns the block buffer or NULL on error
+
+On error, the error object is set. Possible errors include:
+
+Memory allocation error\n
+I/O errors\n
+Decompression errors
+*/
+
+NITFPRIV(nitf_Uint8 *) nitf_ImageIO_cacheGetBlock
+(
+    _nitf_ImageIO * nitf,       /*!< The associated image I/O object */
+    nitf_IOInterface* io,       /*!< I/O handle */
+    nitf_Uint32 number,         /*!< Block number */
+    nitf_Uint64 * blockSize,    /*!< Returns the block size in bytes */
+    nitf_Error * error          /*!< Error object */
+);
+
+/*!
+  \brief nitf_ImageIO_cacheCheckIndex - Check a block number against the
+  read block cache index
+
+  nitf_ImageIO_cacheCheckIndex allocates the block index on first use and
+  checks that the block number is in range.
+
+  \return Returns FALSE on error
+
+  On error, the error object is set. Possible errors include:
+
+Memory allocation error\n
+Block number out of range
+*/
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_cacheCheckIndex(_nitf_ImageIO * nitf,
+                                                 nitf_Uint32 number,
+                                                 nitf_Error * error);
+
+/*!
+  \brief nitf_ImageIO_cacheInsert - Add a block to the read block cache
+
+  nitf_ImageIO_cacheInsert adds a block, which must not already be cached,
+  at the most recently used end of the cache and then trims the cache. The
+  cache takes ownership of the buffer. If the entry cannot be allocated the
+  buffer is freed.
+
+  \return Returns FALSE on error
+
+  On error, the error object is set. Possible errors include:
+
+Memory allocation error
+*/
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_cacheInsert
+(
+    _nitf_ImageIO * nitf,       /*!< The associated image I/O object */
+    nitf_Uint32 number,         /*!< Block number */
+    nitf_Uint8 * block,         /*!< The block buffer */
+    nitf_Uint64 size,           /*!< Block size in bytes */
+    /*!< Control that decoded the buffer, NULL if allocated with NITF_MALLOC */
+    nitf_DecompressionControl * control,
+    nitf_Error * error          /*!< Error object */
+);
+
+/*!
+  \brief nitf_ImageIO_cacheTrim - Evict blocks to honor the cache size limit
+
+  nitf_ImageIO_cacheTrim frees least recently used blocks until the cache
+  size is within its limit. The most recently used block is never evicted.
+
+  \return None
+*/
+
+NITFPRIV(void) nitf_ImageIO_cacheTrim(_nitf_ImageIO * nitf);
+
+/*!
+  \brief nitf_ImageIO_cacheFreeEntry - Free one read block cache entry
+
+  nitf_ImageIO_cacheFreeEntry frees the entry's block buffer, using the
+  decompression interface's freeBlock function with the control that
+  decoded it if the buffer came from the decompressor, and then the entry
+  itself. The entry must already have been removed from the cache's list
+  and index.
+
+  \return None
+*/
+
+NITFPRIV(void) nitf_ImageIO_cacheFreeEntry(_nitf_ImageIO * nitf,
+                                           _nitf_ImageIOBlockCacheEntry * entry);
+
+/*!
+  \brief nitf_ImageIO_cacheRelease - Free the cached blocks decoded by a
+  control
+
+  nitf_ImageIO_cacheRelease removes and frees the blocks decoded by the
+  given decompression control. It is called before the control is
+  destroyed. The caller must hold the object's lock.
+
+  \return None
+*/
+
+NITFPRIV(void) nitf_ImageIO_cacheRelease(_nitf_ImageIO * nitf,
+                                         nitf_DecompressionControl * control);
+
+/*!
+  \brief nitf_ImageIO_cacheClear - Free all blocks in the read block cache
+
+  nitf_ImageIO_cacheClear frees all cached blocks and the block index. The
+  size limit and the hit and miss counts are not changed.
+
+  \return None
+*/
+
+NITFPRIV(void) nitf_ImageIO_cacheClear(_nitf_ImageIO * nitf);
+
+/*!
+  \brief nitf_ImageIO_mappedBlock - Get a block in place from a memory
+  backed IO interface
+
+  nitf_ImageIO_mappedBlock returns a pointer to the block's data in the IO
+  interface's memory (see nitf_IOInterface_getBuffer) if the block is stored
+  uncompressed, in the form it is read in, and the interface supports
+  this. The block is not cached since it does not need to be read.
+
+  \return The block or NULL if the block must be read
+*/
+
+NITFPRIV(const nitf_Uint8 *) nitf_ImageIO_mappedBlock
+(
+    _nitf_ImageIO * nitf,       /*!< The associated image I/O object */
+    nitf_IOInterface* io,       /*!< I/O handle */
+    nitf_Uint32 number          /*!< Block number, including band offset */
+);
+
+/*!
+  \brief nitf_ImageIO_readSubWindow - Read a checked sub-window
+
+  nitf_ImageIO_readSubWindow does the work of nitf_ImageIO_read after the
+  object has been set-up. Each call creates its own I/O control. If the
+  locked argument is TRUE the caller holds the object's lock for the whole
+  request.
+
+  \return Returns FALSE on error
+*/
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_readSubWindow
+(
+    _nitf_ImageIO * nitfI,      /*!< The associated image I/O object */
+    nitf_IOInterface* io,       /*!< I/O handle */
+    nitf_SubWindow * subWindow, /*!< Sub-window to read */
+    nitf_Uint8 ** user,         /*!< User buffers, one per band */
+    int *padded,                /*!< Returns TRUE if pad pixels may be read */
+    int locked,                 /*!< Lock held for the request if TRUE */
+    nitf_Error * error          /*!< Error object */
+);
+
+/*!
+  \brief nitf_ImageIO_readParallel - Read a sub-window, decoding blocks on
+  the worker threads
+
+  nitf_ImageIO_readParallel reads the sub-window in strips of whole block
+  rows. The blocks of each strip that are not already cached are decoded
+  in parallel (see nitf_ImageIO_decodeParallel) and the strip is then read
+  through the block cache, which assembles the blocks into the user
+  buffers. Each strip holds enough blocks to keep the workers busy.
+
+  The sub-window must not be down-sampled.
+
+  \return Returns FALSE on error
+*/
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_readParallel
+(
+    _nitf_ImageIO * nitf,       /*!< The associated image I/O object */
+    nitf_IOInterface* io,       /*!< I/O handle */
+    nitf_SubWindow * subWindow, /*!< Sub-window to read */
+    nitf_Uint8 ** user,         /*!< User buffers, one per band */
+    int *padded,                /*!< Returns TRUE if pad pixels may be read */
+    nitf_Error * error          /*!< Error object */
+);
+
+/*!
+  \brief nitf_ImageIO_getScaled - Get the reduced resolution decode object
+  for a reduction factor
+
+  nitf_ImageIO_getScaled returns the object used for reads of a compressed
+  image that are down-sampled by scale (2, 4 or 8), creating it on first
+  use. The object is a clone of the caller with its own decompression
+  control, opened with the NITF_DECOMPRESSION_SCALE_KEY option, and with
+  the image and block dimensions divided by scale. The caller must hold the
+  object's lock.
+
+  NULL is returned if the decompressor does not reduce the blocks by scale
+  (or cannot be set up for it). This is remembered and the read is done at
+  full resolution.
+*/
+
+NITFPRIV(_nitf_ImageIO *) nitf_ImageIO_getScaled
+(
+    _nitf_ImageIO * nitf,       /*!< The associated image I/O object */
+    nitf_IOInterface* io,       /*!< I/O handle */
+    nitf_Uint32 scale           /*!< The reduction factor */
+);
+
+/*!
+  \brief nitf_ImageIO_decodeParallel - Decode blocks into the read block
+  cache on the worker threads
+
+  nitf_ImageIO_decodeParallel reserves reserve bytes in the block cache,
+  decodes the listed blocks that are not already cached (or pad blocks) on
+  the worker threads and adds them to the cache. The caller releases the
+  reservation after it has read the blocks. On error the reservation is
+  released here.
+
+  If the workers are in use by another read, nothing is decoded and the
+  blocks are decoded serially by the cached reader as usual. The numbers
+  array is modified.
+
+  \return Returns FALSE on error
+
+  On error, the error object is set. Possible errors include:
+
+Memory allocation error\n
+Thread creation errors\n
+I/O errors\n
+Decompression errors
+*/
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_decodeParallel
+(
+    _nitf_ImageIO * nitf,       /*!< The associated image I/O object */
+    nitf_IOInterface* io,       /*!< I/O handle */
+    nitf_Uint32 * numbers,      /*!< Block numbers to decode */
+    nitf_Uint32 count,          /*!< Number of blocks */
+    nitf_Uint64 reserve,        /*!< Cache space to reserve in bytes */
+    nitf_Error * error          /*!< Error object */
+);
+
+/*!
+  \brief nitf_ImageIO_getWorkers - Allocate the decompression workers
+
+  nitf_ImageIO_getWorkers (re)allocates readThreads workers if needed,
+  opening a decompression control and a cursor for each and starting its
+  thread. The caller must hold the object's lock and the workers must not
+  be in use.
+
+  \return Returns FALSE on error
+*/
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_getWorkers(_nitf_ImageIO * nitf,
+                                            nitf_IOInterface* io,
+                                            nitf_Error * error);
+
+/*!
+  \brief nitf_ImageIO_destroyWorkers - Free the decompression workers
+
+  nitf_ImageIO_destroyWorkers stops and joins the worker threads, frees the
+  cached blocks that the workers decoded and then the workers. The caller
+  must hold the object's lock (or be destroying the object).
+
+  \return None
+*/
+
+NITFPRIV(void) nitf_ImageIO_destroyWorkers(_nitf_ImageIO * nitf);
+
+/*!
+  \brief nitf_ImageIO_workerRun - Decompression worker thread function
+
+  nitf_ImageIO_workerRun waits for jobs and runs each one (see
+  nitf_ImageIO_workerDecode) until the workers are stopped.
+
+  \return NULL
+*/
+
+NITFPRIV(NRT_DATA *) nitf_ImageIO_workerRun(NRT_DATA * data);
+
+/*!
+  \brief nitf_ImageIO_workerDecode - Decode blocks of a job on a worker
+
+  nitf_ImageIO_workerDecode starts the worker's control if required and
+  then decodes blocks from the job until there are none left.
+
+  \return None
+*/
+
+NITFPRIV(void) nitf_ImageIO_workerDecode(_nitf_ImageIOWorker * worker,
+                                         _nitf_ImageIODecodeJob * job);
+
+/*!
+  \brief nitf_ImageIOCursor_construct - Create a cursor over a shared IO
+  interface
+
+  See _nitf_ImageIOCursor.
+
+  \return Returns the new interface or NULL on error
+*/
+
+NITFPRIV(nitf_IOInterface *) nitf_ImageIOCursor_construct(nitf_IOInterface* io,
+                                                          nitf_Error * error);
+
+/*!
+  \brief nitf_ImageIO_writeRowsFormat - Write rows, optionally formatting
+  them
+
+  nitf_ImageIO_writeRowsFormat does the work of nitf_ImageIO_writeRows and
+  nitf_ImageIO_writeFormattedRows. If format is FALSE, the pixel format
+  function is not applied since the caller has already done so (see
+  nitf_ImageIO_formatRows).
+
+  \return Returns FALSE on error
+*/
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_writeRowsFormat
+(
+    nitf_ImageIO * object,      /*!< Associated ImageIO object */
+    nitf_IOInterface* io,       /*!< Interface for writes */
+    nitf_Uint32 numRows,        /*!< Number of rows */
+    nitf_Uint8 ** data,         /*!< Row buffers, one per band */
+    int format,                 /*!< Apply the format function if TRUE */
+    nitf_Error * error          /*!< For error reports */
+);
+
 /*!
   \brief nitf_ImageIO_uncachedWriter - Write pixel data to a file without
    block caching
@@ -2091,6 +2710,44 @@ void nitf_ImageIO_pack_P_8(_nitf_ImageIOBlock * blockIO, nitf_Error * error);
 void nitf_ImageIO_pack_P_16(_nitf_ImageIOBlock * blockIO,
                             nitf_Error * error);
 
+/*!
+  \brief nitf_ImageIO_vectorUnformat - Vectorized byte swap, sign extension
+   and shift
+
+  The nitf_ImageIO_vectorUnformat function does the bulk of the work of the
+  2, 4 and 8 byte swap, extend and shift unformatters, and of the shift and
+  shift-swap formatters, using SSE2 or AVX2, as supported by the processor.
+  The operation is given by the op argument, a combination of a byte swap
+  (NITF_IMAGE_IO_VEC_SWAP) and one of the shifts:
+
+  NITF_IMAGE_IO_VEC_EXTEND - Sign extend (left shift then signed right)\\n
+NITF_IMAGE_IO_VEC_SHIFT  - Signed right shift\\n
+NITF_IMAGE_IO_VEC_USHIFT - Unsigned right shift\\n
+NITF_IMAGE_IO_VEC_LSHIFT - Left shift (formatters)\\n
+
+The swap is applied first, except for NITF_IMAGE_IO_VEC_LSHIFT which is
+applied before it, so that a shift-swap format undoes a swap-shift
+unformat. Only whole vectors are processed, the caller's scalar loop
+finishes the remaining values.
+
+\b Note:
+
+This is an internal function and is not intended to be called
+directly by the user.
+
+\return The number of values processed (zero if there is no vector support)
+
+*/
+
+NITFPRIV(size_t) nitf_ImageIO_vectorUnformat
+(
+    nitf_Uint8 * buffer,   /*!< Buffer holding the data to unformat */
+    size_t count,          /*!< Number of values to unformat */
+    int bytes,             /*!< Bytes per value (2, 4 or 8) */
+    int op,                /*!< Unformat operation */
+    nitf_Uint32 shiftCount /*!< Number of bits to shift */
+);
+
 /*!
   \brief nitf_ImageIO_unformatExtend - Do pixel unformats involving sign
    extensions
@@ -2939,6 +3596,129 @@ static nitf_CompressionInterface nitf_ImageIO_12PixelComInterface =
         NULL
     };
 
+/*!
+  \brief nitf_ImageIO_unpackB - Unpack B pixel type (NBPP == 1) data
+
+  nitf_ImageIO_unpackB expands count bits, most significant bit first, into
+  one byte per pixel with the value zero or one. The expansion is a table
+  lookup of eight pixels per input byte.
+
+  \return None
+*/
+
+NITFPRIV(void) nitf_ImageIO_unpackB
+(
+    const nitf_Uint8 *packed,  /*!< Packed input */
+    nitf_Uint8 *pixels,        /*!< Unpacked output */
+    size_t count               /*!< Number of pixels */
+);
+
+/*!
+  \brief nitf_ImageIO_packB - Pack B pixel type (NBPP == 1) data
+
+  nitf_ImageIO_packB is the inverse of nitf_ImageIO_unpackB. Any non-zero
+  pixel is a one bit, and the unused bits of a partial last byte are zero.
+
+  \return None
+*/
+
+NITFPRIV(void) nitf_ImageIO_packB
+(
+    const nitf_Uint8 *pixels,  /*!< Unpacked input */
+    nitf_Uint8 *packed,        /*!< Packed output */
+    size_t count               /*!< Number of pixels */
+);
+
+/*!
+  \brief nitf_ImageIO_unpack12 - Unpack 12-bit pixel type data
+
+  nitf_ImageIO_unpack12 expands count 12-bit pixels, packed two to three
+  bytes (the last pixel of an odd count in two bytes), into native 16-bit
+  values. The bulk of the pixels are done with AVX2 if the processor
+  supports it.
+
+  \return None
+*/
+
+NITFPRIV(void) nitf_ImageIO_unpack12
+(
+    const nitf_Uint8 *packed,  /*!< Packed input */
+    nitf_Uint16 *pixels,       /*!< Unpacked output */
+    size_t count               /*!< Number of pixels */
+);
+
+/*!
+  \brief nitf_ImageIO_pack12 - Pack 12-bit pixel type data
+
+  nitf_ImageIO_pack12 is the inverse of nitf_ImageIO_unpack12. Only the low
+  12 bits of each pixel are used.
+
+  \return None
+*/
+
+NITFPRIV(void) nitf_ImageIO_pack12
+(
+    const nitf_Uint16 *pixels, /*!< Unpacked input */
+    nitf_Uint8 *packed,        /*!< Packed output */
+    size_t count               /*!< Number of pixels */
+);
+
+/*!
+  \brief nitf_ImageIO_packedComWrite - Write a packed block for the B and
+  12-bit pixel type psuedo compressors
+
+  \return TRUE on success. On error, the error object is set
+*/
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_packedComWrite
+(
+    nitf_ImageIO_12PixelComControl *icntl,  /*!< Control holding the block */
+    nitf_IOInterface* io,                   /*!< IO handle for the write */
+    nitf_Error *error                       /*!< For error returns */
+);
+
+/*!
+    \brief nitf_ImageIO_bPixelComOpen - Open function for B pixel type
+    psuedo compression (NBPP == 1)
+
+    This function follows the NITF_COMPRESSION_INTERFACE_OPEN_FUNCTION calling
+    sequence. The control is a nitf_ImageIO_12PixelComControl, so the start,
+    end and destroy functions are those of the 12-bit pixel type.
+*/
+
+nitf_CompressionControl *nitf_ImageIO_bPixelComOpen
+(nitf_ImageSubheader * subheader, nrt_HashTable* options, nitf_Error * error);
+
+/*!
+    \brief nitf_ImageIO_bPixelComWriteBlock - Write block function for B
+    pixel type psuedo compression (NBPP == 1)
+
+    This function follows the NITF_COMPRESSION_INTERFACE_WRITE_BLOCK_FUNCTION
+    calling sequence
+*/
+
+NITF_BOOL nitf_ImageIO_bPixelComWriteBlock(nitf_CompressionControl* object,
+                                           nitf_IOInterface* io,
+                                           const nitf_Uint8 *data,
+                                           NITF_BOOL pad,
+                                           NITF_BOOL noData,
+                                           nitf_Error *error);
+
+/*!
+  \brief nitf_ImageIO_bPixelComInterface - Compression interface for B
+  pixel type psuedo compression.
+*/
+
+static nitf_CompressionInterface nitf_ImageIO_bPixelComInterface =
+    {
+        nitf_ImageIO_bPixelComOpen,
+        nitf_ImageIO_12PixelComStart,
+        nitf_ImageIO_bPixelComWriteBlock,
+        nitf_ImageIO_12PixelComEnd,
+        nitf_ImageIO_12PixelComDestroy,
+        NULL
+    };
+
 
 /*============================================================================*/
 /*==================== Function definitions ==================================*/
@@ -2999,6 +3779,16 @@ NITFPROT(nitf_ImageIO *) nitf_ImageIO_construct(
     }
     /* Initialize all fields to zero */
     memset(nitf, 0, sizeof(_nitf_ImageIO));
+    nitf_Mutex_init(&(nitf->lock));
+    nitf_Condition_init(&(nitf->readsDone));
+    nitf_Mutex_init(&(nitf->workerLock));
+    nitf_Condition_init(&(nitf->workReady));
+    nitf_Condition_init(&(nitf->workDone));
+    nitf->subheader = subheader;
+    nitf->options = options;
+    nitf->readThreads = 1;
+    nitf->scaledDecode = 0;
+    nitf->scale = 1;
 
     /*   Adjust block column and row counts for 2500C  */
     if ((nBlocksPerColumn == 1) && (numRowsPerBlock == 0))
@@ -3019,9 +3809,6 @@ NITFPROT(nitf_ImageIO *) nitf_ImageIO_construct(
     nitf->decompressor = decompressor;
     nitf->compressionControl = NULL;
     nitf->decompressionControl = NULL;
-    nitf->blockControl.number = NITF_IMAGE_IO_NO_BLOCK;
-    nitf->blockControl.freeFlag = 1;
-    nitf->blockControl.block = NULL;
     nitf->cachedWriteFlag = 0;
 
     nitf_ImageIO_setDefaultParameters(nitf);
@@ -3055,12 +3842,16 @@ NITFPROT(nitf_ImageIO *) nitf_ImageIO_construct(
 
     /*
      *      Check for pixel type B (binary), if there is no decompressor, set
-     *  The psuedo decompressor for B typ3 pixels
+     *  The psuedo decompressor for B typ3 pixels. Also set the compressor in
+     *  case this is a write
      */
 
     if ((nitf->pixel.type == NITF_IMAGE_IO_PIXEL_TYPE_B)
             && (nitf->compression & NITF_IMAGE_IO_NO_COMPRESSION))
+    {
         nitf->decompressor = &nitf_ImageIO_bPixelInterface;
+        nitf->compressor = &nitf_ImageIO_bPixelComInterface;
+    }
 
     /*
      *      Check for pixel NBPP == 12 and ABPP == 12, (pixel type 12) if
@@ -3142,11 +3933,29 @@ NITFPROT(nitf_ImageIO *) nitf_ImageIO_clone(nitf_ImageIO * image,
     /* Clear some fields */
 
     clone->blockInfoFlag = 0;
-
-    memset(&(clone->blockControl), 0,
-           sizeof(_nitf_ImageIOBlockCacheControl));
+    clone->activeReads = 0;
+    nitf_Mutex_init(&(clone->lock));
+    nitf_Condition_init(&(clone->readsDone));
+    nitf_Mutex_init(&(clone->workerLock));
+    nitf_Condition_init(&(clone->workReady));
+    nitf_Condition_init(&(clone->workDone));
+    clone->workers = NULL;
+    clone->numWorkers = 0;
+    clone->numRunning = 0;
+    clone->workersBusy = 0;
+    clone->workerOptions = NULL;
+    clone->job = NULL;
+    clone->jobWorkers = 0;
+    clone->stopWorkers = 0;
+    clone->blockCache.reserved = 0;
+
+    memset(&(clone->blockCache), 0, sizeof(_nitf_ImageIOBlockCache));
+    clone->blockCache.maxSize =
+        ((_nitf_ImageIO *) image)->blockCache.maxSize;
 
     clone->decompressionControl = NULL;
+    memset(clone->scaled, 0, sizeof(clone->scaled));
+    clone->scalesDeclined = 0;
 
     memset(&(clone->maskHeader), 0, sizeof(_nitf_ImageIO_MaskHeader));
     clone->blockMask = NULL;
@@ -3158,30 +3967,24 @@ NITFPROT(nitf_ImageIO *) nitf_ImageIO_clone(nitf_ImageIO * image,
 NITFPROT(void) nitf_ImageIO_destruct(nitf_ImageIO ** nitf)
 {
     _nitf_ImageIO *nitfp;       /* Pointer to internal type */
-    nitf_Error error;           /* For decompressor free block call */
+    int i;
 
     if (*nitf == NULL)
         return;
 
     nitfp = *((_nitf_ImageIO **) nitf);
 
+    for (i = 0; i < NITF_IMAGE_IO_NUM_SCALES; i++)
+        nitf_ImageIO_destruct(&(nitfp->scaled[i]));
+
     if (nitfp->blockMask != NULL)
         NITF_FREE(nitfp->blockMask);
 
     if (nitfp->padMask != NULL)
         NITF_FREE(nitfp->padMask);
 
-    if (nitfp->blockControl.block != NULL)
-    {
-        /* No plugin */
-        if (nitfp->decompressor == NULL)
-            NITF_FREE(nitfp->blockControl.block);
-        else
-            (*(nitfp->decompressor->freeBlock)) (nitfp->
-                                                 decompressionControl,
-                                                 nitfp->blockControl.block,
-                                                 &error);
-    }
+    nitf_ImageIO_destroyWorkers(nitfp);
+    nitf_ImageIO_cacheClear(nitfp);
 
     if (nitfp->decompressionControl != NULL)
         (*(nitfp->decompressor->destroyControl))(&(nitfp->decompressionControl));
@@ -3189,6 +3992,15 @@ NITFPROT(void) nitf_ImageIO_destruct(nitf_ImageIO ** nitf)
     if (nitfp->compressionControl != NULL)
         (*(nitfp->compressor->destroyControl))(&(nitfp->compressionControl));
 
+    /* A reduced resolution decode object owns its decompressor options */
+    if (nitfp->scale > 1 && nitfp->options != NULL)
+        nrt_HashTable_destruct(&(nitfp->options));
+
+    nitf_Condition_delete(&(nitfp->workDone));
+    nitf_Condition_delete(&(nitfp->workReady));
+    nitf_Mutex_delete(&(nitfp->workerLock));
+    nitf_Condition_delete(&(nitfp->readsDone));
+    nitf_Mutex_delete(&(nitfp->lock));
     NITF_FREE(nitfp);
     *nitf = NULL;
     return;
@@ -3203,27 +4015,66 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_read(nitf_ImageIO * nitf,
                                       int *padded, nitf_Error * error)
 {
     _nitf_ImageIO *nitfI;       /* Internal version of nitf */
-    int all;                    /* Full image read flag */
     nitf_BlockingInfo *blockInfo; /* For get blocking info call */
-    NITF_BOOL oneRead;          /* Complete request in one read flag */
-    int oneBand;                /* One band flag */
-    _nitf_ImageIOControl *cntl; /* IO control structure */
-    /* Read control structure */
-    _nitf_ImageIOReadControl *readCntl;
-    nitf_SubWindow tmpSub;      /* Temp sub-window structure for one band loop */
-    nitf_Uint32 band;           /* Current band */
+    int locked;                 /* Lock held for the whole request if TRUE */
     int ret;                    /* Return value */
 
-    ret = 1;                    /* To avoid warning */
     nitfI = (_nitf_ImageIO *) nitf;
 
-    if ((nitfI->writeControl != NULL) || (nitfI->readControl != NULL))
+    /*
+     *    Several reads may be in progress at once. The set-up below changes
+     *  the object and is done under the lock, the request itself is not
+     *  unless the I/O interface cannot do positional reads
+     */
+
+    locked = !nitf_IOInterface_canReadAt(io);
+    nitf_Mutex_lock(&(nitfI->lock));
+
+    if (nitfI->writeControl != NULL)
     {
+        nitf_Mutex_unlock(&(nitfI->lock));
         nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
                          "I/O operation in progress");
         return NITF_FAILURE;
     }
 
+    /*
+     *    A down-sampled read of a compressed image may be done by decoding
+     *  the blocks at reduced resolution instead (see nitf_ImageIO_getScaled)
+     */
+
+    if (nitfI->scaledDecode
+        && nitf_DownSampler_allowsScaledDecode(subWindow->downsampler)
+        && (subWindow->startRow % subWindow->downsampler->rowSkip == 0)
+        && (subWindow->startCol % subWindow->downsampler->colSkip == 0))
+    {
+        _nitf_ImageIO *scaled;  /* Reduced resolution decode object */
+        nitf_SubWindow reduced; /* Sub-window in reduced coordinates */
+
+        scaled = nitf_ImageIO_getScaled(nitfI, io,
+                                        subWindow->downsampler->rowSkip);
+        nitf_Mutex_unlock(&(nitfI->lock));
+        if (scaled != NULL)
+        {
+            reduced = *subWindow;
+            reduced.startRow /= subWindow->downsampler->rowSkip;
+            reduced.startCol /= subWindow->downsampler->colSkip;
+            reduced.downsampler = NULL;
+            return nitf_ImageIO_read((nitf_ImageIO *) scaled, io, &reduced,
+                                     user, padded, error);
+        }
+        nitf_Mutex_lock(&(nitfI->lock));
+    }
+
+    /*
+     *    Reverting an optimized mode changes the pixel layout, this cannot
+     *  be done under a read that is in progress so wait for those to finish
+     */
+
+    while ((nitfI->activeReads != 0) &&
+           nitf_ImageIO_mustRevertOptimizedModes(nitfI, subWindow->numBands))
+        nitf_Condition_wait(&(nitfI->readsDone), &(nitfI->lock));
+
     /* *possibly* revert the optimized modes */
     nitf_ImageIO_revertOptimizedModes(nitfI, subWindow->numBands);
 
@@ -3236,103 +4087,169 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_read(nitf_ImageIO * nitf,
 
     blockInfo = nitf_ImageIO_getBlockingInfo(nitf, io, error);
     if (blockInfo == NULL)
+    {
+        nitf_Mutex_unlock(&(nitfI->lock));
         return NITF_FAILURE;
+    }
 
     /* Not needed */
     nitf_BlockingInfo_destruct(&blockInfo);
 
-    if (!nitf_ImageIO_checkSubWindow(nitfI, subWindow, &all, error))
-        return 0;
+    nitfI->activeReads += 1;
+    if (!locked)
+        nitf_Mutex_unlock(&(nitfI->lock));
 
     /*
-     *   Look for single read cases (down-sampling never does a single read ori
-     * one band reads if the method is multi-band)
+     *    Compressed blocks are decoded on the worker threads if enabled, this
+     *  does not apply to down-sampled reads
      */
 
-    oneBand = nitfI->oneBand;
-    if ((subWindow->downsampler != NULL) &&
-            ((subWindow->downsampler->rowSkip != 1)
-             || (subWindow->downsampler->colSkip != 1)))
-    {
-        oneRead = 0;
-        if (subWindow->downsampler->multiBand)
-            oneBand = 0;
-    }
+    if (!locked && (nitfI->readThreads > 1) && (nitfI->decompressor != NULL)
+        && (nitfI->vtbl.reader == nitf_ImageIO_cachedReader)
+        && ((subWindow->downsampler == NULL) ||
+            ((subWindow->downsampler->rowSkip == 1)
+             && (subWindow->downsampler->colSkip == 1))))
+        ret = nitf_ImageIO_readParallel(nitfI, io, subWindow, user,
+                                        padded, error);
     else
-        oneRead = nitf_ImageIO_checkOneRead(nitfI, all);
+        ret = nitf_ImageIO_readSubWindow(nitfI, io, subWindow, user,
+                                         padded, locked, error);
 
-    /*      Set-up and do the read (one band at a time or all bands at once) */
+    if (!locked)
+        nitf_Mutex_lock(&(nitfI->lock));
+    nitfI->activeReads -= 1;
+    if (nitfI->activeReads == 0)
+        nitf_Condition_broadcast(&(nitfI->readsDone));
+    nitf_Mutex_unlock(&(nitfI->lock));
 
-    if (oneBand || oneRead)
-    {
-        tmpSub = *subWindow;
-        for (band = 0; band < subWindow->numBands; band++)
-        {
-            tmpSub.bandList = subWindow->bandList + band;
-            tmpSub.numBands = 1;
-            cntl = nitf_ImageIOControl_construct(nitfI,
-                                                 io,
-                                                 user + band,
-                                                 &tmpSub, 1 /* Reading */ ,
-                                                 error);
-            if (cntl == NULL)
-                return 0;
+    return ret;
+}
 
-            readCntl =
-                nitf_ImageIOReadControl_construct(cntl, subWindow, error);
-            if (readCntl == NULL)
-            {
-                nitf_ImageIOControl_destruct(&cntl);
-                return 0;
-            }
-            nitfI->readControl = readCntl;
-            if (oneRead)
-                ret = nitf_ImageIO_oneRead(cntl, io, error);
-            else
-            {
-                if (cntl->downSampling)
-                    ret =
-                        nitf_ImageIO_readRequestDownSample(cntl, subWindow,
-                                                           io, error);
-                else
-                    ret = nitf_ImageIO_readRequest(cntl, io, error);
-            }
 
-            nitf_ImageIOControl_destruct(&cntl);
-            nitf_ImageIOReadControl_destruct(&(nitfI->readControl));
-        }
-    }
+NITFPRIV(NRT_DATA *) nitf_ImageIO_shareOption(NRT_DATA * data,
+                                              nitf_Error * error)
+{
+    (void) error;
+    return data;
+}
+
+NITFPRIV(_nitf_ImageIO *) nitf_ImageIO_getScaled(_nitf_ImageIO * nitf,
+                                                 nitf_IOInterface* io,
+                                                 nitf_Uint32 scale)
+{
+    _nitf_ImageIO *scaled;      /* The result */
+    nitf_Uint32 index;          /* Index of the factor in the scaled array */
+    nitf_BlockingInfo expected; /* Blocking of the reduced blocks */
+    nitf_Error error;           /* Errors are not reported, see below */
+
+    index = (scale == 2) ? 0 : ((scale == 4) ? 1 : 2);
+    if ((nitf->scaled[index] != NULL) || (nitf->scalesDeclined & scale))
+        return (_nitf_ImageIO *) nitf->scaled[index];
+
+    /*
+     *    Only single band images with a decompression plugin qualify and the
+     *  blocks must reduce to a whole number of pixels. Any failure below just
+     *  means the read is done at full resolution, any real problem will be
+     *  reported by that read
+     */
+
+    nitf->scalesDeclined |= scale;
+    if ((nitf->scale != 1) || (nitf->numBands != 1)
+        || (nitf->decompressor == NULL)
+        || (nitf->compression & NITF_IMAGE_IO_NO_COMPRESSION)
+        || (nitf->numRowsPerBlock % scale != 0)
+        || (nitf->numColumnsPerBlock % scale != 0)
+        || (nitf->blockSize % ((size_t) scale * scale) != 0))
+        return NULL;
+
+    scaled = (_nitf_ImageIO *) nitf_ImageIO_clone((nitf_ImageIO *) nitf,
+                                                  &error);
+    if (scaled == NULL)
+        return NULL;
+
+    scaled->scale = scale;
+    scaled->options = NULL;
+    scaled->scalesDeclined = ~((nitf_Uint32) 0);
+    scaled->pixelBase = scaled->imageBase;  /* Masks are read again */
+    scaled->compressor = NULL;
+    scaled->compressionControl = NULL;
+    scaled->writeControl = NULL;
+    scaled->activeReads = 0;
+
+    /* The user's options plus the reduction factor */
+    if (nitf->options != NULL)
+        scaled->options = nrt_HashTable_clone(nitf->options,
+                                              nitf_ImageIO_shareOption,
+                                              &error);
     else
+        scaled->options = nrt_HashTable_construct(4, &error);
+    if (scaled->options == NULL)
     {
-        cntl = nitf_ImageIOControl_construct(nitfI, io,
-                                             user,
-                                             subWindow, 1 /* Reading */ ,
-                                             error);
-        if (cntl == NULL)
-            return 0;
+        nitf_ImageIO_destruct((nitf_ImageIO **) &scaled);
+        return NULL;
+    }
+    nrt_HashTable_setPolicy(scaled->options, NRT_DATA_RETAIN_OWNER);
+    if (!nrt_HashTable_insert(scaled->options, NITF_DECOMPRESSION_SCALE_KEY,
+                              &(scaled->scale), &error))
+    {
+        nitf_ImageIO_destruct((nitf_ImageIO **) &scaled);
+        return NULL;
+    }
 
-        readCntl =
-            nitf_ImageIOReadControl_construct(cntl, subWindow, error);
-        if (readCntl == NULL)
-        {
-            nitf_ImageIOControl_destruct(&cntl);
-            return 0;
-        }
-        nitfI->readControl = readCntl;
+    scaled->decompressionControl =
+        (*(scaled->decompressor->open))(scaled->subheader, scaled->options,
+                                        &error);
+    if ((scaled->decompressionControl == NULL)
+        || !nitf_ImageIO_mkMasks((nitf_ImageIO *) scaled, io, 1, &error))
+    {
+        nitf_ImageIO_destruct((nitf_ImageIO **) &scaled);
+        return NULL;
+    }
 
-        if (cntl->downSampling)
-            ret =
-                nitf_ImageIO_readRequestDownSample(cntl, subWindow, io,
-                                                   error);
-        else
-            ret = nitf_ImageIO_readRequest(cntl, io, error);
+    /*
+     *    Start the decompressor with the full resolution blocking, it
+     *  accepts the factor by reducing the blocks
+     */
 
-        *padded = cntl->padded;
-        nitf_ImageIOControl_destruct(&cntl);
-        nitf_ImageIOReadControl_destruct(&(nitfI->readControl));
+    scaled->blockInfo.numBlocksPerRow = scaled->nBlocksPerRow;
+    scaled->blockInfo.numBlocksPerCol = scaled->nBlocksPerColumn;
+    scaled->blockInfo.numRowsPerBlock = scaled->numRowsPerBlock;
+    scaled->blockInfo.numColsPerBlock = scaled->numColumnsPerBlock;
+    scaled->blockInfo.length = scaled->blockSize;
+
+    expected = scaled->blockInfo;
+    expected.numRowsPerBlock /= scale;
+    expected.numColsPerBlock /= scale;
+    expected.length /= (size_t) scale * scale;
+
+    if (!(*(scaled->decompressor->start)) (
+            scaled->decompressionControl, io, scaled->pixelBase,
+            scaled->dataLength - scaled->maskHeader.imageDataOffset,
+            &(scaled->blockInfo), scaled->blockMask, &error)
+        || (scaled->blockInfo.numBlocksPerRow != expected.numBlocksPerRow)
+        || (scaled->blockInfo.numBlocksPerCol != expected.numBlocksPerCol)
+        || (scaled->blockInfo.numRowsPerBlock != expected.numRowsPerBlock)
+        || (scaled->blockInfo.numColsPerBlock != expected.numColsPerBlock)
+        || (scaled->blockInfo.length != expected.length))
+    {
+        nitf_ImageIO_destruct((nitf_ImageIO **) &scaled);
+        return NULL;
     }
 
-    return ret;
+    /* Reduce the dimensions, the block counts are the same */
+
+    scaled->numRows = (nitf->numRows + scale - 1) / scale;
+    scaled->numColumns = (nitf->numColumns + scale - 1) / scale;
+    scaled->numRowsPerBlock /= scale;
+    scaled->numColumnsPerBlock /= scale;
+    scaled->numRowsActual /= scale;
+    scaled->numColumnsActual /= scale;
+    scaled->blockSize = scaled->blockInfo.length;
+    scaled->blockInfoFlag = 1;
+
+    nitf->scalesDeclined &= ~scale;
+    nitf->scaled[index] = (nitf_ImageIO *) scaled;
+    return scaled;
 }
 
 
@@ -3427,7 +4344,7 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_writeSequential(nitf_ImageIO * nitf,
 
     /*      Check for I/O in progress */
 
-    if ((nitfI->writeControl != NULL) || (nitfI->readControl != NULL))
+    if ((nitfI->writeControl != NULL) || (nitfI->activeReads != 0))
     {
         nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
                          "I/O operation in progress");
@@ -3473,6 +4390,46 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_writeRows(nitf_ImageIO * object,
                                            nitf_Uint32 numRows,
                                            nitf_Uint8 ** data,
                                            nitf_Error * error)
+{
+    return nitf_ImageIO_writeRowsFormat(object, io, numRows, data, 1, error);
+}
+
+
+NITFPROT(NITF_BOOL) nitf_ImageIO_writeFormattedRows(nitf_ImageIO * object,
+                                                    nitf_IOInterface* io,
+                                                    nitf_Uint32 numRows,
+                                                    nitf_Uint8 ** data,
+                                                    nitf_Error * error)
+{
+    return nitf_ImageIO_writeRowsFormat(object, io, numRows, data, 0, error);
+}
+
+
+NITFPROT(void) nitf_ImageIO_formatRows(nitf_ImageIO * object,
+                                       nitf_Uint32 numRows,
+                                       nitf_Uint8 ** data)
+{
+    _nitf_ImageIO *nitf;        /* Internal representation */
+    nitf_Uint32 band;           /* Current band */
+
+    nitf = (_nitf_ImageIO *) object;
+    if (nitf->vtbl.format == NULL)
+        return;
+
+    /* The format functions work pixel by pixel, so whole rows can be done */
+    for (band = 0; band < nitf->numBands; band++)
+        (*(nitf->vtbl.format)) (data[band],
+                                ((size_t) numRows) * (nitf->numColumns),
+                                nitf->pixel.shift);
+}
+
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_writeRowsFormat(nitf_ImageIO * object,
+                                                 nitf_IOInterface* io,
+                                                 nitf_Uint32 numRows,
+                                                 nitf_Uint8 ** data,
+                                                 int format,
+                                                 nitf_Error * error)
 {
     _nitf_ImageIO *nitf;        /* Parent _nitf_ImageIO object */
     /* Internal representation */
@@ -3550,7 +4507,7 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_writeRows(nitf_ImageIO * object,
 
                 if (blockIO->doIO)
                 {
-                    if (nitf->vtbl.format != NULL)
+                    if (format && nitf->vtbl.format != NULL)
                         (*(nitf->vtbl.format)) (blockIO->rwBuffer.buffer +
                                                 blockIO->rwBuffer.offset.mark,
                                                 blockIO->formatCount,
@@ -3685,6 +4642,22 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_setFileOffset(nitf_ImageIO * nitf,
 }
 
 
+NITFPROT(nitf_Off) nitf_ImageIO_getDataLength(nitf_ImageIO * nitf)
+{
+    _nitf_ImageIO *nitfI;       /* Internal version of the handle */
+
+    nitfI = (_nitf_ImageIO *) nitf;
+
+    /* Compressed (including 12-bit packed) and masked lengths vary */
+    if (!(nitfI->compression & NITF_IMAGE_IO_COMPRESSION_NC)
+        || nitfI->compressor != NULL)
+        return -1;
+
+    return (nitf_Off) (nitfI->pixelBase - nitfI->imageBase) +
+        (nitf_Off) nitfI->nBlocksTotal * (nitf_Off) nitfI->blockSize;
+}
+
+
 NITFPROT(nitf_BlockingInfo *) nitf_BlockingInfo_construct(nitf_Error *
         error)
 {
@@ -3805,21 +4778,117 @@ NITFPROT(int) nitf_ImageIO_setWriteCaching(nitf_ImageIO * nitf, int enable)
 NITFPROT(void) nitf_ImageIO_setReadCaching(nitf_ImageIO * nitf)
 {
     _nitf_ImageIO *initf;   /* Internal representation of object */
+    int i;
 
     initf = (_nitf_ImageIO *) nitf;
     initf->vtbl.reader = nitf_ImageIO_cachedReader;
+    for (i = 0; i < NITF_IMAGE_IO_NUM_SCALES; i++)
+    {
+        if (initf->scaled[i] != NULL)
+            nitf_ImageIO_setReadCaching(initf->scaled[i]);
+    }
 
     return;
 }
 
-/*=================== nitf_BlockingInfo_print ================================*/
+NITFPROT(void) nitf_ImageIO_setReadCacheSize(nitf_ImageIO * nitf,
+                                             nitf_Uint64 maxSize)
+{
+    _nitf_ImageIO *initf;   /* Internal representation of object */
 
-NITFPROT(void) nitf_BlockingInfo_print(nitf_BlockingInfo * info,
-                                       FILE * file)
+    int i;
+
+    initf = (_nitf_ImageIO *) nitf;
+    nitf_Mutex_lock(&(initf->lock));
+    initf->vtbl.reader = nitf_ImageIO_cachedReader;
+    initf->blockCache.maxSize = maxSize;
+    nitf_ImageIO_cacheTrim(initf);
+    for (i = 0; i < NITF_IMAGE_IO_NUM_SCALES; i++)
+    {
+        if (initf->scaled[i] != NULL)
+            nitf_ImageIO_setReadCacheSize(initf->scaled[i], maxSize);
+    }
+    nitf_Mutex_unlock(&(initf->lock));
+
+    return;
+}
+
+NITFPROT(void) nitf_ImageIO_setReadThreads(nitf_ImageIO * nitf,
+                                           nitf_Uint32 numThreads)
 {
-#ifdef NITF_DEBUG
-    if (file == NULL)
-        file = stdout;
+    _nitf_ImageIO *initf;   /* Internal representation of object */
+
+    int i;
+
+    initf = (_nitf_ImageIO *) nitf;
+    if (numThreads == 0)
+        numThreads = (nitf_Uint32) nitf_Thread_getNumCPUs();
+
+    nitf_Mutex_lock(&(initf->lock));
+    initf->readThreads = numThreads;
+    for (i = 0; i < NITF_IMAGE_IO_NUM_SCALES; i++)
+    {
+        if (initf->scaled[i] != NULL)
+            nitf_ImageIO_setReadThreads(initf->scaled[i], numThreads);
+    }
+    nitf_Mutex_unlock(&(initf->lock));
+
+    return;
+}
+
+NITFPROT(void) nitf_ImageIO_setScaledDecode(nitf_ImageIO * nitf,
+                                            NITF_BOOL enable)
+{
+    _nitf_ImageIO *initf;   /* Internal representation of object */
+
+    initf = (_nitf_ImageIO *) nitf;
+    nitf_Mutex_lock(&(initf->lock));
+    initf->scaledDecode = enable;
+    nitf_Mutex_unlock(&(initf->lock));
+
+    return;
+}
+
+NITFPROT(void) nitf_ImageIO_getReadCacheStats(nitf_ImageIO * nitf,
+                                              nitf_Uint64 * hits,
+                                              nitf_Uint64 * misses)
+{
+    _nitf_ImageIO *initf;   /* Internal representation of object */
+
+    nitf_Uint64 scaledHits;     /* Counts of a reduced resolution decode */
+    nitf_Uint64 scaledMisses;
+    int i;
+
+    initf = (_nitf_ImageIO *) nitf;
+    nitf_Mutex_lock(&(initf->lock));
+    if (hits != NULL)
+        *hits = initf->blockCache.hits;
+    if (misses != NULL)
+        *misses = initf->blockCache.misses;
+    for (i = 0; i < NITF_IMAGE_IO_NUM_SCALES; i++)
+    {
+        if (initf->scaled[i] == NULL)
+            continue;
+        nitf_ImageIO_getReadCacheStats(initf->scaled[i],
+                                       &scaledHits, &scaledMisses);
+        if (hits != NULL)
+            *hits += scaledHits;
+        if (misses != NULL)
+            *misses += scaledMisses;
+    }
+    nitf_Mutex_unlock(&(initf->lock));
+
+    return;
+}
+
+/*=================== nitf_BlockingInfo_print ================================*/
+
+NITFPROT(void) nitf_BlockingInfo_print(nitf_BlockingInfo * info,
+                                       FILE * file)
+{
+#ifdef NITF_DEBUG
+    if (file == NULL)
+        file = stdout;
 
     fprintf(file, "nitf_ImageIOBlockingInfo structure:\n");
     fprintf(file, "  Number of blocks per row: %ld\n",
@@ -3844,6 +4913,253 @@ NITFPROT(void) nitf_BlockingInfo_print(nitf_BlockingInfo * info,
 /*======================== Internal Functions ================================*/
 /*============================================================================*/
 
+NITFPRIV(NITF_BOOL) nitf_ImageIO_readSubWindow(_nitf_ImageIO * nitfI,
+                                               nitf_IOInterface* io,
+                                               nitf_SubWindow * subWindow,
+                                               nitf_Uint8 ** user,
+                                               int *padded, int locked,
+                                               nitf_Error * error)
+{
+    int all;                    /* Full image read flag */
+    NITF_BOOL oneRead;          /* Complete request in one read flag */
+    int oneBand;                /* One band flag */
+    _nitf_ImageIOControl *cntl; /* IO control structure */
+    /* Read control structure */
+    _nitf_ImageIOReadControl *readCntl;
+    nitf_SubWindow tmpSub;      /* Temp sub-window structure for one band loop */
+    nitf_Uint32 band;           /* Current band */
+    int ret;                    /* Return value */
+
+    ret = 1;                    /* To avoid warning */
+
+    if (!nitf_ImageIO_checkSubWindow(nitfI, subWindow, &all, error))
+        return NITF_FAILURE;
+
+    /*
+     *   Look for single read cases (down-sampling never does a single read ori
+     * one band reads if the method is multi-band)
+     */
+
+    oneBand = nitfI->oneBand;
+    if ((subWindow->downsampler != NULL) &&
+            ((subWindow->downsampler->rowSkip != 1)
+             || (subWindow->downsampler->colSkip != 1)))
+    {
+        oneRead = 0;
+        if (subWindow->downsampler->multiBand)
+            oneBand = 0;
+    }
+    else
+        oneRead = nitf_ImageIO_checkOneRead(nitfI, all);
+
+    /*      Set-up and do the read (one band at a time or all bands at once) */
+
+    if (oneBand || oneRead)
+    {
+        tmpSub = *subWindow;
+        for (band = 0; band < subWindow->numBands; band++)
+        {
+            tmpSub.bandList = subWindow->bandList + band;
+            tmpSub.numBands = 1;
+            cntl = nitf_ImageIOControl_construct(nitfI,
+                                                 io,
+                                                 user + band,
+                                                 &tmpSub, 1 /* Reading */ ,
+                                                 error);
+            if (cntl == NULL)
+                return NITF_FAILURE;
+            cntl->locked = locked;
+
+            readCntl =
+                nitf_ImageIOReadControl_construct(cntl, subWindow, error);
+            if (readCntl == NULL)
+            {
+                nitf_ImageIOControl_destruct(&cntl);
+                return NITF_FAILURE;
+            }
+            if (oneRead)
+                ret = nitf_ImageIO_oneRead(cntl, io, error);
+            else
+            {
+                if (cntl->downSampling)
+                    ret =
+                        nitf_ImageIO_readRequestDownSample(cntl, subWindow,
+                                                           io, error);
+                else
+                    ret = nitf_ImageIO_readRequest(cntl, io, error);
+            }
+
+            nitf_ImageIOControl_destruct(&cntl);
+            nitf_ImageIOReadControl_destruct(&readCntl);
+            if (!ret)
+                break;
+        }
+    }
+    else
+    {
+        cntl = nitf_ImageIOControl_construct(nitfI, io,
+                                             user,
+                                             subWindow, 1 /* Reading */ ,
+                                             error);
+        if (cntl == NULL)
+            return NITF_FAILURE;
+        cntl->locked = locked;
+
+        readCntl =
+            nitf_ImageIOReadControl_construct(cntl, subWindow, error);
+        if (readCntl == NULL)
+        {
+            nitf_ImageIOControl_destruct(&cntl);
+            return NITF_FAILURE;
+        }
+
+        if (cntl->downSampling)
+            ret =
+                nitf_ImageIO_readRequestDownSample(cntl, subWindow, io,
+                                                   error);
+        else
+            ret = nitf_ImageIO_readRequest(cntl, io, error);
+
+        *padded = cntl->padded;
+        nitf_ImageIOControl_destruct(&cntl);
+        nitf_ImageIOReadControl_destruct(&readCntl);
+    }
+
+    return ret;
+}
+
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_readParallel(_nitf_ImageIO * nitf,
+                                              nitf_IOInterface* io,
+                                              nitf_SubWindow * subWindow,
+                                              nitf_Uint8 ** user,
+                                              int *padded,
+                                              nitf_Error * error)
+{
+    int all;                    /* Full image read flag */
+    nitf_Uint32 nSets;          /* Block sets (bands for "S" mode, else 1) */
+    nitf_Uint32 startBlockCol;  /* First block column */
+    nitf_Uint32 endBlockCol;    /* Last block column */
+    nitf_Uint32 blocksPerRow;   /* Blocks per block row in the sub-window */
+    nitf_Uint32 stripBlockRows; /* Block rows per strip */
+    nitf_Uint32 blockRow;       /* First block row of the current strip */
+    nitf_Uint32 lastBlockRow;   /* Last block row of the current strip */
+    nitf_Uint32 endBlockRow;    /* Last block row of the sub-window */
+    nitf_Uint32 endRow;         /* Row after the end of the sub-window */
+    nitf_Uint32 stripEnd;       /* Row after the end of the strip */
+    nitf_Uint32 *numbers;       /* Block numbers for the strip */
+    nitf_Uint32 count;          /* Number of blocks in the strip */
+    nitf_Uint32 row, set, col;  /* Block row, set and column */
+    nitf_Uint32 band;           /* Current band */
+    nitf_Uint8 **stripUser;     /* User buffers for the strip */
+    nitf_SubWindow strip;       /* The current strip */
+    nitf_Uint64 reserve;        /* Cache space reserved for the strip */
+    nitf_Uint64 rowBytes;       /* Bytes per row in a user buffer */
+    int stripPadded;            /* Strip padded flag */
+    NITF_BOOL ret;              /* Return value */
+
+    if (!nitf_ImageIO_checkSubWindow(nitf, subWindow, &all, error))
+        return NITF_FAILURE;
+
+    nSets = (nitf->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_S) ?
+        subWindow->numBands : 1;
+    startBlockCol = subWindow->startCol / nitf->numColumnsPerBlock;
+    endBlockCol = (subWindow->startCol + subWindow->numCols - 1)
+        / nitf->numColumnsPerBlock;
+    blocksPerRow = (endBlockCol - startBlockCol + 1) * nSets;
+    stripBlockRows = (2 * nitf->readThreads + blocksPerRow - 1) / blocksPerRow;
+
+    numbers = (nitf_Uint32 *)
+        NITF_MALLOC(stripBlockRows * blocksPerRow * sizeof(nitf_Uint32));
+    stripUser = (nitf_Uint8 **)
+        NITF_MALLOC(subWindow->numBands * sizeof(nitf_Uint8 *));
+    if ((numbers == NULL) || (stripUser == NULL))
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                         "Memory allocation error: %s",
+                         NITF_STRERROR(NITF_ERRNO));
+        if (numbers != NULL)
+            NITF_FREE(numbers);
+        if (stripUser != NULL)
+            NITF_FREE(stripUser);
+        return NITF_FAILURE;
+    }
+
+    strip = *subWindow;
+    rowBytes = ((nitf_Uint64) subWindow->numCols) * nitf->pixel.bytes;
+    endRow = subWindow->startRow + subWindow->numRows;
+    endBlockRow = (endRow - 1) / nitf->numRowsPerBlock;
+    *padded = 0;
+    ret = NITF_SUCCESS;
+
+    for (blockRow = subWindow->startRow / nitf->numRowsPerBlock;
+         ret && (blockRow <= endBlockRow); blockRow += stripBlockRows)
+    {
+        lastBlockRow = blockRow + stripBlockRows - 1;
+        if (lastBlockRow > endBlockRow)
+            lastBlockRow = endBlockRow;
+
+        count = 0;
+        for (row = blockRow; row <= lastBlockRow; row++)
+            for (set = 0; set < nSets; set++)
+                for (col = startBlockCol; col <= endBlockCol; col++)
+                {
+                    numbers[count] = row * nitf->nBlocksPerRow + col;
+                    if (nitf->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_S)
+                        numbers[count] += subWindow->bandList[set] *
+                            nitf->nBlocksPerRow * nitf->nBlocksPerColumn;
+                    count++;
+                }
+
+        reserve = ((nitf_Uint64) count) * nitf->blockInfo.length;
+        if (!nitf_ImageIO_decodeParallel(nitf, io, numbers, count,
+                                         reserve, error))
+        {
+            ret = NITF_FAILURE;
+            break;
+        }
+
+        /* Read the strip through the cache */
+
+        strip.startRow = blockRow * nitf->numRowsPerBlock;
+        if (strip.startRow < subWindow->startRow)
+            strip.startRow = subWindow->startRow;
+        stripEnd = (lastBlockRow + 1) * nitf->numRowsPerBlock;
+        if (stripEnd > endRow)
+            stripEnd = endRow;
+        strip.numRows = stripEnd - strip.startRow;
+
+        for (band = 0; band < subWindow->numBands; band++)
+            stripUser[band] = user[band] +
+                (strip.startRow - subWindow->startRow) * rowBytes;
+
+        stripPadded = 0;
+        ret = nitf_ImageIO_readSubWindow(nitf, io, &strip, stripUser,
+                                         &stripPadded, 0, error);
+        *padded = *padded || stripPadded;
+
+        nitf_Mutex_lock(&(nitf->lock));
+        nitf->blockCache.reserved -= reserve;
+        nitf_ImageIO_cacheTrim(nitf);
+        nitf_Mutex_unlock(&(nitf->lock));
+    }
+
+    NITF_FREE(numbers);
+    NITF_FREE(stripUser);
+    return ret;
+}
+
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_mustRevertOptimizedModes(_nitf_ImageIO *nitfI,
+                                                          int numBands)
+{
+    if (nitfI->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_RGB24)
+        return numBands == 3 || numBands == 0;
+    if (nitfI->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_IQ)
+        return numBands == 2 || numBands == 0;
+    return 0;
+}
+
 NITFPRIV(void) nitf_ImageIO_revertOptimizedModes(_nitf_ImageIO *nitfI, int numBands)
 {
     if (nitfI->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_RGB24 &&
@@ -6263,7 +7579,7 @@ NITFPRIV(int) nitf_ImageIO_mkMasks(nitf_ImageIO * img,
         }
 
         /* The offsets are stored as big-endian binary */
-        if (nitf_ImageIO_bigEndian())
+        if (!nitf_ImageIO_bigEndian())
             nitf_ImageIO_swapOnly_4((nitf_Uint8 *) fileMask, nBlocksTotal, 0);
         
         for (i = 0; i < nBlocksTotal;i++)
@@ -6708,22 +8024,58 @@ NITFPRIV(int) nitf_ImageIO_readRequest(_nitf_ImageIOControl * cntl,
     nitf_Uint32 row;           /* Current row in sub-window */
     nitf_Uint32 band;          /* Current band in sub-window */
     _nitf_ImageIOBlock *blockIO; /* The current  block IO structure */
+    _nitf_ImageIOReadRun *runs;  /* Coalesced read state, one per block IO */
+    nitf_Uint32 rowsLeft;      /* Rows left to read in the current block */
+    nitf_Uint32 i;
+    int ret;
 
     nitf = cntl->nitf;
     numRows = cntl->numRows;
     numBands = cntl->numBandSubset;
     nBlockCols = cntl->nBlockIO / numBands;
 
-    for (col = 0; col < nBlockCols; col++)
+    /* Uncached reads of successive rows are merged */
+    runs = NULL;
+    if (nitf->vtbl.reader == nitf_ImageIO_uncachedReader)
     {
-        for (row = 0; row < numRows; row++)
+        runs = (_nitf_ImageIOReadRun *)
+            NITF_MALLOC(cntl->nBlockIO * sizeof(_nitf_ImageIOReadRun));
+        if (runs == NULL)
+        {
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                             "Error allocating read runs: %s",
+                             NITF_STRERROR(NITF_ERRNO));
+            return NITF_FAILURE;
+        }
+        memset(runs, 0, cntl->nBlockIO * sizeof(_nitf_ImageIOReadRun));
+        for (i = 0; i < cntl->nBlockIO; i++)
+            runs[i].capacity = NITF_IMAGE_IO_READ_RUN_SIZE / cntl->nBlockIO;
+    }
+
+    ret = NITF_SUCCESS;
+    for (col = 0; col < nBlockCols && ret; col++)
+    {
+        for (row = 0; row < numRows && ret; row++)
         {
             for (band = 0; band < numBands; band++)
             {
                 blockIO = &(cntl->blockIO[col][band]);
                 if (blockIO->doIO)
-                    if (!(*(nitf->vtbl.reader)) (blockIO, io, error))
-                        return NITF_FAILURE;
+                {
+                    if (runs != NULL)
+                    {
+                        rowsLeft = numRows - row;
+                        if (blockIO->rowsUntil + 1 < rowsLeft)
+                            rowsLeft = blockIO->rowsUntil + 1;
+                        ret = nitf_ImageIO_coalescedReader(blockIO,
+                                runs + col * numBands + band,
+                                rowsLeft, io, error);
+                    }
+                    else
+                        ret = (*(nitf->vtbl.reader)) (blockIO, io, error);
+                    if (!ret)
+                        break;
+                }
 
                 if (nitf->vtbl.unpack != NULL)
                     (*(nitf->vtbl.unpack)) (blockIO, error);
@@ -6756,7 +8108,15 @@ NITFPRIV(int) nitf_ImageIO_readRequest(_nitf_ImageIOControl * cntl,
         }
     }
 
-    return 1;
+    if (runs != NULL)
+    {
+        for (i = 0; i < cntl->nBlockIO; i++)
+            if (runs[i].buffer != NULL)
+                NITF_FREE(runs[i].buffer);
+        NITF_FREE(runs);
+    }
+
+    return ret;
 }
 
 /* This function is used when FR != DR (down-Sampling) */
@@ -7062,19 +8422,9 @@ NITFPRIV(int) nitf_ImageIO_readFromFile(nitf_IOInterface* io,
                                         size_t count,
                                         nitf_Error * error)
 {
-    size_t bytes;               /* Amount of current read */
-    char *bufp;                 /* pointer into the buffer */
-    /* Seek to the offset */
-    bytes = count;
-    bufp = (char *) buffer;
-
-    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(io,
-                                               (nitf_Off) fileOffset,
-                                               NITF_SEEK_SET, error)))
-    {
-        return NITF_FAILURE;
-    }
-    if (!nitf_IOInterface_read(io, bufp, bytes, error))
+    /* Positional read, the interface's offset is not used */
+    if (!nitf_IOInterface_readAt(io, (nitf_Off) fileOffset,
+                                 buffer, count, error))
     {
         return NITF_FAILURE;
     }
@@ -7331,12 +8681,111 @@ int nitf_ImageIO_uncachedReader(_nitf_ImageIOBlock * blockIO,
 }
 
 
+NITFPRIV(int) nitf_ImageIO_coalescedReader(_nitf_ImageIOBlock * blockIO,
+                                           _nitf_ImageIOReadRun * run,
+                                           nitf_Uint32 rowsLeft,
+                                           nitf_IOInterface* io,
+                                           nitf_Error * error)
+{
+    _nitf_ImageIOControl *cntl; /* Associated control object */
+    nitf_Uint64 fileOffset;     /* File offset of the current row */
+    nitf_Uint64 stride;         /* File offset increment between rows */
+    nitf_Uint8 *buffer;         /* Read buffer for the current row */
+    size_t count;               /* Bytes in the current row */
+    size_t length;              /* Bytes in the merged read */
+    nitf_Uint32 rows;           /* Rows in the merged read */
+
+    cntl = blockIO->cntl;
+
+    /* Pad pixel reads are never merged */
+    if (blockIO->imageDataOffset == NITF_IMAGE_IO_NO_OFFSET)
+    {
+        run->rowsReady = 0;
+        return nitf_ImageIO_uncachedReader(blockIO, io, error);
+    }
+
+    if (blockIO->padMask[blockIO->number] != NITF_IMAGE_IO_NO_OFFSET)
+        cntl->padded = 1;
+
+    /* Row already read by an earlier direct read */
+    if (run->rowsReady != 0)
+    {
+        run->rowsReady -= 1;
+        return NITF_SUCCESS;
+    }
+
+    fileOffset = cntl->nitf->pixelBase + blockIO->imageDataOffset
+        + blockIO->blockOffset.mark;
+    buffer = blockIO->rwBuffer.buffer + blockIO->rwBuffer.offset.mark;
+    count = blockIO->readCount;
+    stride = cntl->blockOffsetInc;
+
+    /* Row already staged */
+    if ((run->length != 0) && (fileOffset >= run->offset)
+        && (fileOffset + count <= run->offset + run->length))
+    {
+        memcpy(buffer, run->buffer + (fileOffset - run->offset), count);
+        return NITF_SUCCESS;
+    }
+
+    if ((rowsLeft <= 1) || (stride < count))
+        return nitf_ImageIO_readFromFile(io, fileOffset, buffer, count, error);
+
+    /*
+     * When the rows are contiguous in the file and in the read buffer, and
+     * the read buffer is the user buffer, read them all in place
+     */
+    if ((stride == count) && (cntl->bufferInc == count)
+        && blockIO->userEqBuffer && (cntl->nitf->vtbl.unpack == NULL))
+    {
+        if (!nitf_ImageIO_readFromFile(io, fileOffset, buffer,
+                                       count * (size_t) rowsLeft, error))
+            return NITF_FAILURE;
+        run->rowsReady = rowsLeft - 1;
+        return NITF_SUCCESS;
+    }
+
+    /* Otherwise stage as many rows as fit, unless they are too sparse */
+    if ((stride - count > NITF_IMAGE_IO_READ_RUN_GAP)
+        || (run->capacity < count + stride))
+        return nitf_ImageIO_readFromFile(io, fileOffset, buffer, count, error);
+
+    rows = (nitf_Uint32) ((run->capacity - count) / stride) + 1;
+    if (rows > rowsLeft)
+        rows = rowsLeft;
+    length = (size_t) ((rows - 1) * stride) + count;
+
+    if (run->buffer == NULL)
+    {
+        run->buffer = (nitf_Uint8 *) NITF_MALLOC(run->capacity);
+        if (run->buffer == NULL)
+        {
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                             "Error allocating read buffer: %s",
+                             NITF_STRERROR(NITF_ERRNO));
+            return NITF_FAILURE;
+        }
+    }
+
+    run->length = 0;
+    if (!nitf_ImageIO_readFromFile(io, fileOffset, run->buffer, length, error))
+        return NITF_FAILURE;
+    run->offset = fileOffset;
+    run->length = length;
+
+    memcpy(buffer, run->buffer, count);
+    return NITF_SUCCESS;
+}
+
+
 int nitf_ImageIO_cachedReader(_nitf_ImageIOBlock * blockIO,
                               nitf_IOInterface* io, 
                               nitf_Error * error)
 {
     _nitf_ImageIO *nitf;        /* Associated ImageIO object */
     _nitf_ImageIOControl *cntl; /* Associated control object */
+    nitf_Uint8 *block;          /* The cached block */
+    nitf_Uint32 number;         /* Block number including mode mask offset */
     nitf_Uint64 blockSize;
     
     cntl = blockIO->cntl;
@@ -7354,73 +8803,864 @@ int nitf_ImageIO_cachedReader(_nitf_ImageIOBlock * blockIO,
     }
     else
     {
-        if (nitf->blockControl.number != blockIO->number)
-        {
-            if ((nitf->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_B)
-                  && (nitf->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_12)
-                     && (nitf->compression & NITF_IMAGE_IO_NO_COMPRESSION))
+        /*
+         * The block I/O's mask pointer is offset by band for "S" mode, so
+         * include that offset to get a number that is unique across bands
+         */
+        number = (nitf_Uint32) (blockIO->blockMask - nitf->blockMask)
+            + blockIO->number;
+
+        /* Copy directly from memory if possible */
+        block = (nitf_Uint8 *) nitf_ImageIO_mappedBlock(nitf, io, number);
+        if (block != NULL)
+        {
+            memcpy(blockIO->rwBuffer.buffer + blockIO->rwBuffer.offset.mark,
+                   block + blockIO->blockOffset.mark,
+                   blockIO->readCount);
+
+            if (blockIO->padMask[blockIO->number] != NITF_IMAGE_IO_NO_OFFSET)
+                blockIO->cntl->padded = 1;
+
+            return NITF_SUCCESS;
+        }
+
+        /* The block is only valid while the lock is held */
+        if (!cntl->locked)
+            nitf_Mutex_lock(&(nitf->lock));
+
+        block = nitf_ImageIO_cacheGetBlock(nitf, io, number,
+                                           &blockSize, error);
+        if (block != NULL)
+            /* Get data from block */
+            memcpy(blockIO->rwBuffer.buffer + blockIO->rwBuffer.offset.mark,
+                   block + blockIO->blockOffset.mark,
+                   blockIO->readCount);
+
+        if (!cntl->locked)
+            nitf_Mutex_unlock(&(nitf->lock));
+
+        if (block == NULL)
+            return NITF_FAILURE;
+
+        if (blockIO->padMask[blockIO->number] != NITF_IMAGE_IO_NO_OFFSET)
+            blockIO->cntl->padded = 1;
+
+        return NITF_SUCCESS;
+    }
+}
+
+
+NITFPRIV(const nitf_Uint8 *) nitf_ImageIO_mappedBlock(_nitf_ImageIO * nitf,
+                                                       nitf_IOInterface* io,
+                                                       nitf_Uint32 number)
+{
+    /* Only blocks that are read as stored, see nitf_ImageIO_cacheGetBlock */
+    if ((nitf->pixel.type == NITF_IMAGE_IO_PIXEL_TYPE_B)
+        || (nitf->pixel.type == NITF_IMAGE_IO_PIXEL_TYPE_12)
+        || !(nitf->compression & NITF_IMAGE_IO_NO_COMPRESSION))
+        return NULL;
+
+    if (nitf->blockMask[number] == NITF_IMAGE_IO_NO_OFFSET)
+        return NULL;
+
+    return (const nitf_Uint8 *)
+        nitf_IOInterface_getBuffer(io, (nitf_Off) (nitf->pixelBase +
+                                                   nitf->blockMask[number]),
+                                   (size_t) nitf->blockSize);
+}
+
+
+NITFPRIV(nitf_Uint8 *) nitf_ImageIO_cacheGetBlock(_nitf_ImageIO * nitf,
+                                                  nitf_IOInterface* io,
+                                                  nitf_Uint32 number,
+                                                  nitf_Uint64 * blockSize,
+                                                  nitf_Error * error)
+{
+    _nitf_ImageIOBlockCache *cache;       /* The read block cache */
+    _nitf_ImageIOBlockCacheEntry *entry;  /* Entry for the requested block */
+    nitf_Uint8 *block;                    /* Newly read block */
+    nitf_Uint64 size;                     /* Size of the new block */
+    nitf_DecompressionControl *control;   /* Control that decoded the block */
+
+    cache = &(nitf->blockCache);
+
+    /* Continuing with the current block is the common case */
+
+    if ((cache->head != NULL) && (cache->head->number == number))
+    {
+        *blockSize = cache->head->size;
+        return cache->head->block;
+    }
+
+    if (!nitf_ImageIO_cacheCheckIndex(nitf, number, error))
+        return NULL;
+
+    /* Hit, move the block to the head of the list */
+
+    entry = cache->index[number];
+    if (entry != NULL)
+    {
+        cache->hits += 1;
+
+        entry->prev->next = entry->next; /* Not the head, so prev is set */
+        if (entry->next != NULL)
+            entry->next->prev = entry->prev;
+        else
+            cache->tail = entry->prev;
+
+        entry->prev = NULL;
+        entry->next = cache->head;
+        cache->head->prev = entry;
+        cache->head = entry;
+
+        *blockSize = entry->size;
+        return entry->block;
+    }
+
+    /* Miss, read or decompress the block */
+
+    cache->misses += 1;
+    if ((nitf->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_B)
+        && (nitf->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_12)
+        && (nitf->compression & NITF_IMAGE_IO_NO_COMPRESSION))
+    {
+        block = (nitf_Uint8 *) NITF_MALLOC(nitf->blockSize);
+        if (block == NULL)
+        {
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                             "Error allocating block buffer: %s",
+                             NITF_STRERROR(NITF_ERRNO));
+            return NULL;
+        }
+
+        if (!nitf_ImageIO_readFromFile(io,
+                                       nitf->pixelBase +
+                                       nitf->blockMask[number],
+                                       block, nitf->blockSize, error))
+        {
+            NITF_FREE(block);
+            return NULL;
+        }
+        size = nitf->blockSize;
+        control = NULL;
+    }
+    else
+    {
+        /* No plugin */
+        if (nitf->decompressor == NULL)
+        {
+            nitf_Error_initf(error, NITF_CTXT,
+                             NITF_ERR_DECOMPRESSION,
+                             "No decompression plugin for compressed type");
+            return NULL;
+        }
+
+        block = (*(nitf->decompressor->readBlock)) (nitf->decompressionControl,
+                                                    number, &size, error);
+        if (block == NULL)
+            return NULL;
+        control = nitf->decompressionControl;
+    }
+
+    if (!nitf_ImageIO_cacheInsert(nitf, number, block, size,
+                                  control, error))
+        return NULL;
+
+    *blockSize = size;
+    return block;
+}
+
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_cacheCheckIndex(_nitf_ImageIO * nitf,
+                                                 nitf_Uint32 number,
+                                                 nitf_Error * error)
+{
+    _nitf_ImageIOBlockCache *cache;       /* The read block cache */
+
+    cache = &(nitf->blockCache);
+
+    /* Allocate block index if required */
+
+    if (cache->index == NULL)
+    {
+        cache->indexSize = nitf->nBlocksTotal + 1;
+        cache->index = (_nitf_ImageIOBlockCacheEntry **)
+            NITF_MALLOC(cache->indexSize *
+                        sizeof(_nitf_ImageIOBlockCacheEntry *));
+        if (cache->index == NULL)
+        {
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                             "Error allocating block cache index: %s",
+                             NITF_STRERROR(NITF_ERRNO));
+            return NITF_FAILURE;
+        }
+        memset(cache->index, 0,
+               cache->indexSize * sizeof(_nitf_ImageIOBlockCacheEntry *));
+    }
+
+    if (number >= cache->indexSize)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                         "Block number %ld out of range", (long) number);
+        return NITF_FAILURE;
+    }
+
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_cacheInsert(_nitf_ImageIO * nitf,
+                                             nitf_Uint32 number,
+                                             nitf_Uint8 * block,
+                                             nitf_Uint64 size,
+                                             nitf_DecompressionControl *
+                                             control,
+                                             nitf_Error * error)
+{
+    _nitf_ImageIOBlockCache *cache;       /* The read block cache */
+    _nitf_ImageIOBlockCacheEntry *entry;  /* The new entry */
+
+    cache = &(nitf->blockCache);
+
+    entry = (_nitf_ImageIOBlockCacheEntry *)
+        NITF_MALLOC(sizeof(_nitf_ImageIOBlockCacheEntry));
+    if (entry == NULL)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                         "Error allocating block cache entry: %s",
+                         NITF_STRERROR(NITF_ERRNO));
+        if (control != NULL)
+            (*(nitf->decompressor->freeBlock)) (control, block, error);
+        else
+            NITF_FREE(block);
+        return NITF_FAILURE;
+    }
+
+    entry->number = number;
+    entry->block = block;
+    entry->size = size;
+    entry->control = control;
+    entry->prev = NULL;
+    entry->next = cache->head;
+    if (cache->head != NULL)
+        cache->head->prev = entry;
+    else
+        cache->tail = entry;
+    cache->head = entry;
+    cache->index[number] = entry;
+    cache->size += size;
+    cache->count += 1;
+
+    nitf_ImageIO_cacheTrim(nitf);
+
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(void) nitf_ImageIO_cacheFreeEntry(_nitf_ImageIO * nitf,
+                                           _nitf_ImageIOBlockCacheEntry * entry)
+{
+    nitf_Error error;           /* For decompressor free block call */
+
+    if (entry->control != NULL)
+        (*(nitf->decompressor->freeBlock)) (entry->control,
+                                            entry->block, &error);
+    else
+        NITF_FREE(entry->block);
+
+    NITF_FREE(entry);
+    return;
+}
+
+
+NITFPRIV(void) nitf_ImageIO_cacheRelease(_nitf_ImageIO * nitf,
+                                         nitf_DecompressionControl * control)
+{
+    _nitf_ImageIOBlockCache *cache;       /* The read block cache */
+    _nitf_ImageIOBlockCacheEntry *entry;  /* Current entry */
+    _nitf_ImageIOBlockCacheEntry *next;   /* Next entry */
+
+    cache = &(nitf->blockCache);
+    for (entry = cache->head; entry != NULL; entry = next)
+    {
+        next = entry->next;
+        if (entry->control != control)
+            continue;
+
+        if (entry->prev != NULL)
+            entry->prev->next = entry->next;
+        else
+            cache->head = entry->next;
+        if (entry->next != NULL)
+            entry->next->prev = entry->prev;
+        else
+            cache->tail = entry->prev;
+        cache->index[entry->number] = NULL;
+        cache->size -= entry->size;
+        cache->count -= 1;
+        nitf_ImageIO_cacheFreeEntry(nitf, entry);
+    }
+
+    return;
+}
+
+
+NITFPRIV(void) nitf_ImageIO_cacheTrim(_nitf_ImageIO * nitf)
+{
+    _nitf_ImageIOBlockCache *cache;       /* The read block cache */
+    _nitf_ImageIOBlockCacheEntry *entry;  /* Entry being evicted */
+    nitf_Uint64 limit;                    /* Effective size limit */
+
+    cache = &(nitf->blockCache);
+    limit = (cache->reserved > cache->maxSize) ?
+        cache->reserved : cache->maxSize;
+    while ((cache->count > 1) && (cache->size > limit))
+    {
+        entry = cache->tail;
+        cache->tail = entry->prev;
+        cache->tail->next = NULL;
+        cache->index[entry->number] = NULL;
+        cache->size -= entry->size;
+        cache->count -= 1;
+        nitf_ImageIO_cacheFreeEntry(nitf, entry);
+    }
+
+    return;
+}
+
+
+NITFPRIV(void) nitf_ImageIO_cacheClear(_nitf_ImageIO * nitf)
+{
+    _nitf_ImageIOBlockCache *cache;       /* The read block cache */
+    _nitf_ImageIOBlockCacheEntry *entry;  /* Current entry */
+    _nitf_ImageIOBlockCacheEntry *next;   /* Next entry */
+
+    cache = &(nitf->blockCache);
+    for (entry = cache->head; entry != NULL; entry = next)
+    {
+        next = entry->next;
+        nitf_ImageIO_cacheFreeEntry(nitf, entry);
+    }
+
+    if (cache->index != NULL)
+        NITF_FREE(cache->index);
+
+    cache->index = NULL;
+    cache->indexSize = 0;
+    cache->head = NULL;
+    cache->tail = NULL;
+    cache->size = 0;
+    cache->count = 0;
+    return;
+}
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_decodeParallel(_nitf_ImageIO * nitf,
+                                                nitf_IOInterface* io,
+                                                nitf_Uint32 * numbers,
+                                                nitf_Uint32 count,
+                                                nitf_Uint64 reserve,
+                                                nitf_Error * error)
+{
+    _nitf_ImageIOBlockCache *cache;  /* The read block cache */
+    _nitf_ImageIODecodeJob job;      /* The decode job */
+    nitf_Uint32 needed;              /* Number of blocks to decode */
+    nitf_Uint32 i;
+    NITF_BOOL ret;                   /* Return value */
+
+    cache = &(nitf->blockCache);
+    memset(&job, 0, sizeof(_nitf_ImageIODecodeJob));
+
+    nitf_Mutex_lock(&(nitf->lock));
+    cache->reserved += reserve;
+
+    /* Skip pad blocks and blocks that are already cached */
+
+    needed = 0;
+    for (i = 0; i < count; i++)
+    {
+        if (!nitf_ImageIO_cacheCheckIndex(nitf, numbers[i], error))
+        {
+            cache->reserved -= reserve;
+            nitf_Mutex_unlock(&(nitf->lock));
+            return NITF_FAILURE;
+        }
+        if ((cache->index[numbers[i]] == NULL)
+            && (nitf->blockMask[numbers[i]] != NITF_IMAGE_IO_NO_OFFSET))
+            numbers[needed++] = numbers[i];
+    }
+
+    /* Leave it to the cached reader if the workers are in use */
+
+    if ((needed == 0) || nitf->workersBusy)
+    {
+        nitf_Mutex_unlock(&(nitf->lock));
+        return NITF_SUCCESS;
+    }
+
+    if (!nitf_ImageIO_getWorkers(nitf, io, error))
+    {
+        cache->reserved -= reserve;
+        nitf_Mutex_unlock(&(nitf->lock));
+        return NITF_FAILURE;
+    }
+    nitf->workersBusy = 1;
+    nitf_Mutex_unlock(&(nitf->lock));
+
+    /* Decode */
+
+    job.numbers = numbers;
+    job.count = needed;
+    job.blocks = (nitf_Uint8 **) NITF_MALLOC(needed * sizeof(nitf_Uint8 *));
+    job.sizes = (nitf_Uint64 *) NITF_MALLOC(needed * sizeof(nitf_Uint64));
+    job.controls = (nitf_DecompressionControl **)
+        NITF_MALLOC(needed * sizeof(nitf_DecompressionControl *));
+    if ((job.blocks == NULL) || (job.sizes == NULL) || (job.controls == NULL))
+    {
+        nitf_Error_initf(&(job.error), NITF_CTXT, NITF_ERR_MEMORY,
+                         "Memory allocation error: %s",
+                         NITF_STRERROR(NITF_ERRNO));
+        job.failed = 1;
+        job.count = 0;
+    }
+    else
+        memset(job.blocks, 0, needed * sizeof(nitf_Uint8 *));
+    nitf_Mutex_init(&(job.lock));
+
+    /* Hand the job to the worker threads, or decode on this one */
+
+    if (nitf->numRunning == 0)
+    {
+        if (job.count != 0)
+            nitf_ImageIO_workerDecode(&(nitf->workers[0]), &job);
+    }
+    else
+    {
+        nitf_Mutex_lock(&(nitf->workerLock));
+        nitf->job = &job;
+        nitf->jobSerial += 1;
+        nitf->jobWorkers = nitf->numRunning;
+        nitf_Condition_broadcast(&(nitf->workReady));
+        while (nitf->jobWorkers != 0)
+            nitf_Condition_wait(&(nitf->workDone), &(nitf->workerLock));
+        nitf->job = NULL;
+        nitf_Mutex_unlock(&(nitf->workerLock));
+    }
+
+    nitf_Mutex_delete(&(job.lock));
+
+    /* Add the blocks to the cache */
+
+    ret = !job.failed;
+    if (job.failed)
+        *error = job.error;
+
+    nitf_Mutex_lock(&(nitf->lock));
+    nitf->workersBusy = 0;
+    for (i = 0; i < job.count; i++)
+    {
+        if (job.blocks[i] == NULL)
+            continue;
+
+        /* Another read may have cached the block meanwhile */
+        if (!ret || (cache->index[job.numbers[i]] != NULL))
+        {
+            (*(nitf->decompressor->freeBlock)) (job.controls[i],
+                                                job.blocks[i], error);
+            continue;
+        }
+
+        cache->misses += 1;
+        if (!nitf_ImageIO_cacheInsert(nitf, job.numbers[i], job.blocks[i],
+                                      job.sizes[i], job.controls[i], error))
+            ret = NITF_FAILURE;
+    }
+    if (!ret)
+        cache->reserved -= reserve;
+    nitf_Mutex_unlock(&(nitf->lock));
+
+    if (job.blocks != NULL)
+        NITF_FREE(job.blocks);
+    if (job.sizes != NULL)
+        NITF_FREE(job.sizes);
+    if (job.controls != NULL)
+        NITF_FREE(job.controls);
+    return ret;
+}
+
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_getWorkers(_nitf_ImageIO * nitf,
+                                            nitf_IOInterface* io,
+                                            nitf_Error * error)
+{
+    _nitf_ImageIOWorker *worker;     /* Current worker */
+    nitf_Error threadError;          /* A thread that fails is not an error */
+    nitf_Uint32 i;
+
+    if ((nitf->workers != NULL) && (nitf->numWorkers == nitf->readThreads)
+        && (((_nitf_ImageIOCursor *) nitf->workers[0].cursor->data)->io == io))
+        return NITF_SUCCESS;
+
+    nitf_ImageIO_destroyWorkers(nitf);
+
+    /* The user's options plus the object's started control */
+    if (nitf->options != NULL)
+        nitf->workerOptions = nrt_HashTable_clone(nitf->options,
+                                                  nitf_ImageIO_shareOption,
+                                                  error);
+    else
+        nitf->workerOptions = nrt_HashTable_construct(4, error);
+    if (nitf->workerOptions == NULL)
+        return NITF_FAILURE;
+    nrt_HashTable_setPolicy(nitf->workerOptions, NRT_DATA_RETAIN_OWNER);
+    if (!nrt_HashTable_insert(nitf->workerOptions,
+                              NITF_DECOMPRESSION_SHARED_KEY,
+                              nitf->decompressionControl, error))
+    {
+        nrt_HashTable_destruct(&(nitf->workerOptions));
+        return NITF_FAILURE;
+    }
+
+    nitf->workers = (_nitf_ImageIOWorker *)
+        NITF_MALLOC(nitf->readThreads * sizeof(_nitf_ImageIOWorker));
+    if (nitf->workers == NULL)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                         "Memory allocation error: %s",
+                         NITF_STRERROR(NITF_ERRNO));
+        nrt_HashTable_destruct(&(nitf->workerOptions));
+        return NITF_FAILURE;
+    }
+    memset(nitf->workers, 0, nitf->readThreads * sizeof(_nitf_ImageIOWorker));
+    nitf->numWorkers = nitf->readThreads;
+
+    for (i = 0; i < nitf->numWorkers; i++)
+    {
+        worker = &(nitf->workers[i]);
+        worker->nitf = nitf;
+        worker->cursor = nitf_ImageIOCursor_construct(io, error);
+        if (worker->cursor == NULL)
+        {
+            nitf_ImageIO_destroyWorkers(nitf);
+            return NITF_FAILURE;
+        }
+        worker->control = (*(nitf->decompressor->open)) (nitf->subheader,
+                                                         nitf->workerOptions,
+                                                         error);
+        if (worker->control == NULL)
+        {
+            nitf_ImageIO_destroyWorkers(nitf);
+            return NITF_FAILURE;
+        }
+    }
+
+    /* Start the threads, they wait for jobs until the workers are destroyed */
+
+    for (i = 0; i < nitf->numWorkers; i++)
+    {
+        worker = &(nitf->workers[i]);
+        worker->jobSerial = nitf->jobSerial;
+        if (!nitf_Thread_create(&(worker->thread), nitf_ImageIO_workerRun,
+                                worker, &threadError))
+            break;
+        nitf->numRunning += 1;
+    }
+
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(void) nitf_ImageIO_destroyWorkers(_nitf_ImageIO * nitf)
+{
+    nitf_Uint32 i;
+
+    if (nitf->workers == NULL)
+        return;
+
+    nitf_Mutex_lock(&(nitf->workerLock));
+    nitf->stopWorkers = 1;
+    nitf_Condition_broadcast(&(nitf->workReady));
+    nitf_Mutex_unlock(&(nitf->workerLock));
+    for (i = 0; i < nitf->numRunning; i++)
+        nitf_Thread_join(&(nitf->workers[i].thread));
+    nitf->stopWorkers = 0;
+    nitf->numRunning = 0;
+
+    for (i = 0; i < nitf->numWorkers; i++)
+    {
+        if (nitf->workers[i].control != NULL)
+        {
+            nitf_ImageIO_cacheRelease(nitf, nitf->workers[i].control);
+            (*(nitf->decompressor->destroyControl))
+                (&(nitf->workers[i].control));
+        }
+        if (nitf->workers[i].cursor != NULL)
+            nitf_IOInterface_destruct(&(nitf->workers[i].cursor));
+    }
+
+    NITF_FREE(nitf->workers);
+    nitf->workers = NULL;
+    nitf->numWorkers = 0;
+    if (nitf->workerOptions != NULL)
+        nrt_HashTable_destruct(&(nitf->workerOptions));
+    return;
+}
+
+
+NITFPRIV(NRT_DATA *) nitf_ImageIO_workerRun(NRT_DATA * data)
+{
+    _nitf_ImageIOWorker *worker;     /* This worker */
+    _nitf_ImageIO *nitf;             /* Parent _nitf_ImageIO object */
+    _nitf_ImageIODecodeJob *job;     /* The current job */
+
+    worker = (_nitf_ImageIOWorker *) data;
+    nitf = worker->nitf;
+
+    nitf_Mutex_lock(&(nitf->workerLock));
+    for (;;)
+    {
+        while (!nitf->stopWorkers && (worker->jobSerial == nitf->jobSerial))
+            nitf_Condition_wait(&(nitf->workReady), &(nitf->workerLock));
+        if (nitf->stopWorkers)
+            break;
+
+        worker->jobSerial = nitf->jobSerial;
+        job = nitf->job;
+        nitf_Mutex_unlock(&(nitf->workerLock));
+
+        nitf_ImageIO_workerDecode(worker, job);
+
+        nitf_Mutex_lock(&(nitf->workerLock));
+        nitf->jobWorkers -= 1;
+        if (nitf->jobWorkers == 0)
+            nitf_Condition_broadcast(&(nitf->workDone));
+    }
+    nitf_Mutex_unlock(&(nitf->workerLock));
+
+    return NULL;
+}
+
+
+NITFPRIV(void) nitf_ImageIO_workerDecode(_nitf_ImageIOWorker * worker,
+                                         _nitf_ImageIODecodeJob * job)
+{
+    _nitf_ImageIO *nitf;             /* Parent _nitf_ImageIO object */
+    nitf_Uint8 *block;               /* Decoded block */
+    nitf_Uint64 size;                /* Decoded block size */
+    nitf_Uint32 i;                   /* Index of the current block */
+    nitf_Error error;                /* This worker's error */
+
+    nitf = worker->nitf;
+
+    if (!worker->started)
+    {
+        /* A reduced resolution decoder is started with the full blocking */
+        worker->blockInfo = nitf->blockInfo;
+        worker->blockInfo.numRowsPerBlock *= nitf->scale;
+        worker->blockInfo.numColsPerBlock *= nitf->scale;
+        worker->blockInfo.length *= (size_t) nitf->scale * nitf->scale;
+        if (!(*(nitf->decompressor->start)) (
+            worker->control, worker->cursor, nitf->pixelBase,
+            nitf->dataLength - nitf->maskHeader.imageDataOffset,
+            &(worker->blockInfo), nitf->blockMask, &error))
+        {
+            nitf_Mutex_lock(&(job->lock));
+            if (!job->failed)
             {
-                /* Allocate block buffer if required */
-                if (nitf->blockControl.block == NULL)
-                {
-                    nitf->blockControl.block =
-                        (nitf_Uint8 *) NITF_MALLOC(nitf->blockSize);
-                    if (nitf->blockControl.block == NULL)
-                    {
-                        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
-                                         "Error allocating block buffer: %s",
-                                         NITF_STRERROR(NITF_ERRNO));
-                        return NITF_FAILURE;
-                    }
-                }
-                /* Read the block */
-
-                if (!nitf_ImageIO_readFromFile(io,
-                                               blockIO->cntl->nitf->
-                                               pixelBase +
-                                               blockIO->imageDataOffset,
-                                               nitf->blockControl.block,
-                                               nitf->blockSize, error))
-                    return NITF_FAILURE;
+                job->failed = 1;
+                job->error = error;
             }
-            else
+            nitf_Mutex_unlock(&(job->lock));
+            return;
+        }
+        worker->started = 1;
+    }
+
+    for (;;)
+    {
+        nitf_Mutex_lock(&(job->lock));
+        if (job->failed || (job->next >= job->count))
+        {
+            nitf_Mutex_unlock(&(job->lock));
+            break;
+        }
+        i = job->next++;
+        nitf_Mutex_unlock(&(job->lock));
+
+        block = (*(nitf->decompressor->readBlock)) (worker->control,
+                                                    job->numbers[i],
+                                                    &size, &error);
+        if (block == NULL)
+        {
+            nitf_Mutex_lock(&(job->lock));
+            if (!job->failed)
             {
-                /* Decompression interface structure */
-                nitf_DecompressionInterface *interface;
-                
-                /* No plugin */
-                if (nitf->decompressor == NULL)
-                {
-                    nitf_Error_initf(error, NITF_CTXT,
-                                     NITF_ERR_DECOMPRESSION,
-                                     "No decompression plugin for compressed type");
-                    return NITF_FAILURE;
-                }
-                
-                interface = nitf->decompressor;
-                if (nitf->blockControl.block != NULL)
-                    (*(interface->freeBlock)) (nitf->decompressionControl,
-                                               nitf->blockControl.block,
-                                               error);
-                nitf->blockControl.block = 
-                    (*(interface->readBlock)) (nitf->decompressionControl,
-                                               blockIO->number, &blockSize, error);
-                if (nitf->blockControl.block == NULL)
-                    return NITF_FAILURE;
+                job->failed = 1;
+                job->error = error;
             }
-            nitf->blockControl.number = blockIO->number;
+            nitf_Mutex_unlock(&(job->lock));
+            break;
         }
-        
-        /* Get data from block */
-        memcpy(blockIO->rwBuffer.buffer + blockIO->rwBuffer.offset.mark,
-               nitf->blockControl.block + blockIO->blockOffset.mark,
-               blockIO->readCount);
+        job->blocks[i] = block;
+        job->sizes[i] = size;
+        job->controls[i] = worker->control;
+    }
 
-        if (blockIO->padMask[blockIO->number] != NITF_IMAGE_IO_NO_OFFSET)
-            blockIO->cntl->padded = 1;
+    return;
+}
 
-        return NITF_SUCCESS;
+
+NITFPRIV(NITF_BOOL) nitf_ImageIOCursor_read(NITF_DATA * data, void *buf,
+                                            size_t size, nitf_Error * error)
+{
+    _nitf_ImageIOCursor *cursor = (_nitf_ImageIOCursor *) data;
+
+    if (!nitf_IOInterface_readAt(cursor->io, cursor->offset, buf, size, error))
+        return NITF_FAILURE;
+    cursor->offset += (nitf_Off) size;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) nitf_ImageIOCursor_write(NITF_DATA * data,
+                                             const void *buf, size_t size,
+                                             nitf_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)buf;
+    (void)size;
+
+    nitf_Error_init(error, "Cursor is read-only", NITF_CTXT,
+                    NITF_ERR_WRITING_TO_FILE);
+    return NITF_FAILURE;
+}
+
+NITFPRIV(NITF_BOOL) nitf_ImageIOCursor_canSeek(NITF_DATA * data,
+                                               nitf_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)error;
+
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(nitf_Off) nitf_ImageIOCursor_seek(NITF_DATA * data, nitf_Off offset,
+                                           int whence, nitf_Error * error)
+{
+    _nitf_ImageIOCursor *cursor = (_nitf_ImageIOCursor *) data;
+    nitf_Off size;
+
+    if (whence == NITF_SEEK_SET)
+        cursor->offset = offset;
+    else if (whence == NITF_SEEK_CUR)
+        cursor->offset += offset;
+    else
+    {
+        size = nitf_IOInterface_getSize(cursor->io, error);
+        if (size < 0)
+            return -1;
+        cursor->offset = size + offset;
+    }
+    return cursor->offset;
+}
+
+NITFPRIV(nitf_Off) nitf_ImageIOCursor_tell(NITF_DATA * data,
+                                           nitf_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)error;
+
+    return ((_nitf_ImageIOCursor *) data)->offset;
+}
+
+NITFPRIV(nitf_Off) nitf_ImageIOCursor_getSize(NITF_DATA * data,
+                                              nitf_Error * error)
+{
+    return nitf_IOInterface_getSize(((_nitf_ImageIOCursor *) data)->io,
+                                    error);
+}
+
+NITFPRIV(int) nitf_ImageIOCursor_getMode(NITF_DATA * data,
+                                         nitf_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)error;
+
+    return NITF_ACCESS_READONLY;
+}
+
+NITFPRIV(NITF_BOOL) nitf_ImageIOCursor_close(NITF_DATA * data,
+                                             nitf_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)error;
+
+    /* The shared interface is not owned */
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(void) nitf_ImageIOCursor_destruct(NITF_DATA * data)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+}
+
+NITFPRIV(NITF_BOOL) nitf_ImageIOCursor_readAt(NITF_DATA * data,
+                                              nitf_Off offset, void *buf,
+                                              size_t size, nitf_Error * error)
+{
+    return nitf_IOInterface_readAt(((_nitf_ImageIOCursor *) data)->io,
+                                   offset, buf, size, error);
+}
+
+NITFPRIV(const void *) nitf_ImageIOCursor_getBuffer(NITF_DATA * data,
+                                                    nitf_Off offset,
+                                                    size_t size)
+{
+    return nitf_IOInterface_getBuffer(((_nitf_ImageIOCursor *) data)->io,
+                                      offset, size);
+}
+
+NITFPRIV(nitf_IOInterface *) nitf_ImageIOCursor_construct(nitf_IOInterface* io,
+                                                          nitf_Error * error)
+{
+    static nitf_IIOInterface iCursor = {
+        &nitf_ImageIOCursor_read,
+        &nitf_ImageIOCursor_write,
+        &nitf_ImageIOCursor_canSeek,
+        &nitf_ImageIOCursor_seek,
+        &nitf_ImageIOCursor_tell,
+        &nitf_ImageIOCursor_getSize,
+        &nitf_ImageIOCursor_getMode,
+        &nitf_ImageIOCursor_close,
+        &nitf_ImageIOCursor_destruct,
+        &nitf_ImageIOCursor_readAt,
+        &nitf_ImageIOCursor_getBuffer
+    };
+    nitf_IOInterface *impl;
+    _nitf_ImageIOCursor *cursor;
+
+    impl = (nitf_IOInterface *) NITF_MALLOC(sizeof(nitf_IOInterface));
+    cursor = (_nitf_ImageIOCursor *) NITF_MALLOC(sizeof(_nitf_ImageIOCursor));
+    if ((impl == NULL) || (cursor == NULL))
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                         "Memory allocation error: %s",
+                         NITF_STRERROR(NITF_ERRNO));
+        if (impl != NULL)
+            NITF_FREE(impl);
+        if (cursor != NULL)
+            NITF_FREE(cursor);
+        return NULL;
     }
+
+    cursor->io = io;
+    cursor->offset = 0;
+    impl->data = (NITF_DATA *) cursor;
+    impl->iface = &iCursor;
+    return impl;
 }
 
 /*========================= Start Direct Block Reading  ================================*/
@@ -7434,8 +9674,10 @@ NITFPROT(NRT_BOOL) nitf_ImageIO_setupDirectBlockRead(nitf_ImageIO *nitf,
 
     nitfI = (_nitf_ImageIO *) nitf;
 
-    if ((nitfI->writeControl != NULL) || (nitfI->readControl != NULL))
+    nitf_Mutex_lock(&(nitfI->lock));
+    if ((nitfI->writeControl != NULL) || (nitfI->activeReads != 0))
     {
+        nitf_Mutex_unlock(&(nitfI->lock));
         nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
                          "I/O operation in progress");
         return NITF_FAILURE;
@@ -7451,6 +9693,7 @@ NITFPROT(NRT_BOOL) nitf_ImageIO_setupDirectBlockRead(nitf_ImageIO *nitf,
      *  check requires the block size
      */
     blockInfo = nitf_ImageIO_getBlockingInfo(nitf, io, error);
+    nitf_Mutex_unlock(&(nitfI->lock));
     if (blockInfo == NULL)
         return NITF_FAILURE;
 
@@ -7466,75 +9709,39 @@ NITFPROT(nitf_Uint8*) nitf_ImageIO_readBlockDirect(nitf_ImageIO* nitf,
                                                    nitf_Uint64* blockSize,
                                                    nitf_Error * error)
 {
-    _nitf_ImageIO *nitfI;        /* Associated ImageIO object */
-    nitf_Uint64 imageDataOffset;
-        
-    nitfI = (_nitf_ImageIO*) nitf;
-    imageDataOffset = nitfI->blockMask[blockNumber];
+    _nitf_ImageIO *nitfI;
+    nitf_Uint8 *block;
+
+    nitfI = (_nitf_ImageIO *) nitf;
+    nitf_Mutex_lock(&(nitfI->lock));
+    block = nitf_ImageIO_cacheGetBlock(nitfI, io, blockNumber,
+                                       blockSize, error);
+    nitf_Mutex_unlock(&(nitfI->lock));
+    return block;
+}
+
+NITFPROT(const nitf_Uint8*) nitf_ImageIO_getBlockDirect(nitf_ImageIO* nitf,
+                                                        nitf_IOInterface* io,
+                                                        nitf_Uint32 blockNumber,
+                                                        nitf_Uint64* blockSize,
+                                                        nitf_Error * error)
+{
+    _nitf_ImageIO *nitfI;
+    const nitf_Uint8 *block;
 
-    if (nitfI->blockControl.number != blockNumber)
+    nitfI = (_nitf_ImageIO *) nitf;
+    if (blockNumber < nitfI->nBlocksTotal)
     {
-        if ((nitfI->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_B)
-            && (nitfI->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_12)
-            && (nitfI->compression & NITF_IMAGE_IO_NO_COMPRESSION))
+        block = nitf_ImageIO_mappedBlock(nitfI, io, blockNumber);
+        if (block != NULL)
         {
-            /* Allocate block buffer if required */
-            if (nitfI->blockControl.block == NULL)
-            {
-                nitfI->blockControl.block =
-                    (nitf_Uint8 *) NITF_MALLOC(nitfI->blockSize);
-                if (nitfI->blockControl.block == NULL)
-                {
-                    nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
-                                     "Error allocating block buffer: %s",
-                                     NITF_STRERROR(NITF_ERRNO));
-                    return NULL;
-                }
-            }
-            /* Read the block */
-            
-            if (!nitf_ImageIO_readFromFile(io,
-                                           nitfI->pixelBase + imageDataOffset,
-                                           nitfI->blockControl.block,
-                                           nitfI->blockSize, error))
-            {
-                return NULL;
-            }
-
             *blockSize = nitfI->blockSize;
+            return block;
         }
-        else
-        {
-            /* Decompression interface structure */
-            nitf_DecompressionInterface *interface;
-            
-            /* No plugin */
-            if (nitfI->decompressor == NULL)
-            {
-                nitf_Error_initf(error, NITF_CTXT,
-                                 NITF_ERR_DECOMPRESSION,
-                                 "No decompression plugin for compressed type");
-                return NULL;
-            }
-            
-            interface = nitfI->decompressor;
-            if (nitfI->blockControl.block != NULL)
-                (*(interface->freeBlock)) (nitfI->decompressionControl,
-                                           nitfI->blockControl.block,
-                                           error);
-            nitfI->blockControl.block =
-                (*(interface->readBlock)) (nitfI->decompressionControl,
-                                           blockNumber, blockSize, 
-                                           error);
-            if (nitfI->blockControl.block == NULL)
-            {
-                return NULL;
-            }
-        }
-        nitfI->blockControl.number = blockNumber;
     }
-    
-    return nitfI->blockControl.block;
+
+    return nitf_ImageIO_readBlockDirect(nitf, io, blockNumber,
+                                        blockSize, error);
 }
 
 /*========================= End Direct Block Reading  ================================*/
@@ -7753,6 +9960,294 @@ void nitf_ImageIO_setDefaultParameters(_nitf_ImageIO * object)
 }
 
 
+/*======================== Vectorized unformatters ===========================*/
+
+#ifdef NITF_IMAGE_IO_SSE2
+
+/*
+ *  Vector support level: 0 none, 1 SSE2, 2 AVX2 (-1 until detected). The
+ *  detection always gives the same answer, so threads racing to set this
+ *  is harmless.
+ */
+static int nitf_ImageIO_vectorLevel = -1;
+
+NITFPRIV(int) nitf_ImageIO_getVectorLevel(void)
+{
+    int level = nitf_ImageIO_vectorLevel;
+
+    if (level >= 0)
+        return level;
+
+    level = 1;
+#if defined(NITF_IMAGE_IO_AVX2) && defined(_MSC_VER)
+    {
+        int info[4];
+
+        __cpuid(info, 0);
+        if (info[0] >= 7)
+        {
+            __cpuid(info, 1);
+            /* OSXSAVE and AVX, and the OS saves the YMM registers */
+            if ((info[2] & (1 << 27)) && (info[2] & (1 << 28))
+                    && (_xgetbv(0) & 6) == 6)
+            {
+                __cpuidex(info, 7, 0);
+                if (info[1] & (1 << 5))
+                    level = 2;
+            }
+        }
+    }
+#elif defined(NITF_IMAGE_IO_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        level = 2;
+#endif
+    nitf_ImageIO_vectorLevel = level;
+    return level;
+}
+
+NITFPROT(int) nitf_ImageIO_setVectorLevel(int level)
+{
+    int supported;
+
+    nitf_ImageIO_vectorLevel = -1;
+    supported = nitf_ImageIO_getVectorLevel();
+    if (level < supported)
+        nitf_ImageIO_vectorLevel = (level < 0) ? 0 : level;
+    return nitf_ImageIO_vectorLevel;
+}
+
+/* Arithmetic right shift of 64-bit lanes, which SSE2 does not have */
+NITFPRIV(__m128i) nitf_ImageIO_sra64SSE2(__m128i v, nitf_Uint32 shift)
+{
+    __m128i sign;
+
+    sign = _mm_shuffle_epi32(_mm_srai_epi32(v, 31), 0xF5);
+    return _mm_or_si128(_mm_srl_epi64(v, _mm_cvtsi32_si128(shift)),
+                        _mm_sll_epi64(sign,
+                                      _mm_cvtsi32_si128(64 - shift)));
+}
+
+NITFPRIV(size_t) nitf_ImageIO_vectorUnformatSSE2(nitf_Uint8 * buffer,
+                                                 size_t count,
+                                                 int bytes, int op,
+                                                 nitf_Uint32 shiftCount)
+{
+    size_t numVectors;   /* Number of whole vectors */
+    __m128i *vp;         /* Vector pointer */
+    __m128i v;           /* Current vector */
+    __m128i shift;       /* Shift count */
+    size_t i;
+
+    numVectors = (count * bytes) / sizeof(__m128i);
+    shift = _mm_cvtsi32_si128(shiftCount);
+    vp = (__m128i *) buffer;
+    for (i = 0; i < numVectors; i++)
+    {
+        v = _mm_loadu_si128(vp);
+
+        if (op & NITF_IMAGE_IO_VEC_LSHIFT)
+        {
+            if (bytes == 2)
+                v = _mm_sll_epi16(v, shift);
+            else if (bytes == 4)
+                v = _mm_sll_epi32(v, shift);
+            else
+                v = _mm_sll_epi64(v, shift);
+        }
+
+        if (op & NITF_IMAGE_IO_VEC_SWAP)
+        {
+            /* Reverse the 16-bit words of each value, then their bytes */
+            if (bytes == 4)
+                v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xB1), 0xB1);
+            else if (bytes == 8)
+                v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0x1B), 0x1B);
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        }
+
+        if (op & NITF_IMAGE_IO_VEC_EXTEND)
+        {
+            if (bytes == 2)
+                v = _mm_sra_epi16(_mm_sll_epi16(v, shift), shift);
+            else if (bytes == 4)
+                v = _mm_sra_epi32(_mm_sll_epi32(v, shift), shift);
+            else
+                v = nitf_ImageIO_sra64SSE2(_mm_sll_epi64(v, shift),
+                                           shiftCount);
+        }
+        else if (op & NITF_IMAGE_IO_VEC_SHIFT)
+        {
+            if (bytes == 2)
+                v = _mm_sra_epi16(v, shift);
+            else if (bytes == 4)
+                v = _mm_sra_epi32(v, shift);
+            else
+                v = nitf_ImageIO_sra64SSE2(v, shiftCount);
+        }
+        else if (op & NITF_IMAGE_IO_VEC_USHIFT)
+        {
+            if (bytes == 2)
+                v = _mm_srl_epi16(v, shift);
+            else if (bytes == 4)
+                v = _mm_srl_epi32(v, shift);
+            else
+                v = _mm_srl_epi64(v, shift);
+        }
+
+        _mm_storeu_si128(vp++, v);
+    }
+
+    return (numVectors * sizeof(__m128i)) / bytes;
+}
+
+#ifdef NITF_IMAGE_IO_AVX2
+
+NITF_IMAGE_IO_AVX2_TARGET
+NITFPRIV(__m256i) nitf_ImageIO_sra64AVX2(__m256i v, nitf_Uint32 shift)
+{
+    __m256i sign;
+
+    sign = _mm256_shuffle_epi32(_mm256_srai_epi32(v, 31), 0xF5);
+    return _mm256_or_si256(_mm256_srl_epi64(v, _mm_cvtsi32_si128(shift)),
+                           _mm256_sll_epi64(sign,
+                                            _mm_cvtsi32_si128(64 - shift)));
+}
+
+NITF_IMAGE_IO_AVX2_TARGET
+NITFPRIV(size_t) nitf_ImageIO_vectorUnformatAVX2(nitf_Uint8 * buffer,
+                                                 size_t count,
+                                                 int bytes, int op,
+                                                 nitf_Uint32 shiftCount)
+{
+    size_t numVectors;   /* Number of whole vectors */
+    __m256i *vp;         /* Vector pointer */
+    __m256i v;           /* Current vector */
+    __m256i swap;        /* Byte swap shuffle control */
+    __m128i shift;       /* Shift count */
+    size_t i;
+
+    numVectors = (count * bytes) / sizeof(__m256i);
+    shift = _mm_cvtsi32_si128(shiftCount);
+    if (bytes == 2)
+        swap = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6,
+                                9, 8, 11, 10, 13, 12, 15, 14,
+                                1, 0, 3, 2, 5, 4, 7, 6,
+                                9, 8, 11, 10, 13, 12, 15, 14);
+    else if (bytes == 4)
+        swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+                                11, 10, 9, 8, 15, 14, 13, 12,
+                                3, 2, 1, 0, 7, 6, 5, 4,
+                                11, 10, 9, 8, 15, 14, 13, 12);
+    else
+        swap = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0,
+                                15, 14, 13, 12, 11, 10, 9, 8,
+                                7, 6, 5, 4, 3, 2, 1, 0,
+                                15, 14, 13, 12, 11, 10, 9, 8);
+
+    vp = (__m256i *) buffer;
+    for (i = 0; i < numVectors; i++)
+    {
+        v = _mm256_loadu_si256(vp);
+
+        if (op & NITF_IMAGE_IO_VEC_LSHIFT)
+        {
+            if (bytes == 2)
+                v = _mm256_sll_epi16(v, shift);
+            else if (bytes == 4)
+                v = _mm256_sll_epi32(v, shift);
+            else
+                v = _mm256_sll_epi64(v, shift);
+        }
+
+        if (op & NITF_IMAGE_IO_VEC_SWAP)
+            v = _mm256_shuffle_epi8(v, swap);
+
+        if (op & NITF_IMAGE_IO_VEC_EXTEND)
+        {
+            if (bytes == 2)
+                v = _mm256_sra_epi16(_mm256_sll_epi16(v, shift), shift);
+            else if (bytes == 4)
+                v = _mm256_sra_epi32(_mm256_sll_epi32(v, shift), shift);
+            else
+                v = nitf_ImageIO_sra64AVX2(_mm256_sll_epi64(v, shift),
+                                           shiftCount);
+        }
+        else if (op & NITF_IMAGE_IO_VEC_SHIFT)
+        {
+            if (bytes == 2)
+                v = _mm256_sra_epi16(v, shift);
+            else if (bytes == 4)
+                v = _mm256_sra_epi32(v, shift);
+            else
+                v = nitf_ImageIO_sra64AVX2(v, shiftCount);
+        }
+        else if (op & NITF_IMAGE_IO_VEC_USHIFT)
+        {
+            if (bytes == 2)
+                v = _mm256_srl_epi16(v, shift);
+            else if (bytes == 4)
+                v = _mm256_srl_epi32(v, shift);
+            else
+                v = _mm256_srl_epi64(v, shift);
+        }
+
+        _mm256_storeu_si256(vp++, v);
+    }
+
+    return (numVectors * sizeof(__m256i)) / bytes;
+}
+
+#endif
+
+NITFPRIV(size_t) nitf_ImageIO_vectorUnformat(nitf_Uint8 * buffer,
+                                             size_t count,
+                                             int bytes, int op,
+                                             nitf_Uint32 shiftCount)
+{
+    switch (nitf_ImageIO_getVectorLevel())
+    {
+#ifdef NITF_IMAGE_IO_AVX2
+        case 2:
+            return nitf_ImageIO_vectorUnformatAVX2(buffer, count,
+                                                   bytes, op, shiftCount);
+#endif
+        case 1:
+            return nitf_ImageIO_vectorUnformatSSE2(buffer, count,
+                                                   bytes, op, shiftCount);
+        default:
+            return 0;
+    }
+}
+
+#else
+
+NITFPROT(int) nitf_ImageIO_setVectorLevel(int level)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)level;
+
+    return 0;
+}
+
+NITFPRIV(size_t) nitf_ImageIO_vectorUnformat(nitf_Uint8 * buffer,
+                                             size_t count,
+                                             int bytes, int op,
+                                             nitf_Uint32 shiftCount)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)buffer;
+    (void)count;
+    (void)bytes;
+    (void)op;
+    (void)shiftCount;
+
+    return 0;
+}
+
+#endif
+
+
 void nitf_ImageIO_unformatExtend_1(nitf_Uint8 * buffer,
                                    size_t count,
                                    nitf_Uint32 shiftCount)
@@ -7784,8 +10279,11 @@ void nitf_ImageIO_unformatExtend_2(nitf_Uint8 * buffer,
     size_t i;
     
     shift = (nitf_Int16) shiftCount;
-    bp16 = (nitf_Int16 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 2,
+                                    NITF_IMAGE_IO_VEC_EXTEND,
+                                    shiftCount);
+    bp16 = ((nitf_Int16 *) buffer) + i;
+    for (; i < count; i++)
     {
         tmp16 = *bp16 << shift;
         *(bp16++) = tmp16 >> shift;
@@ -7805,8 +10303,11 @@ void nitf_ImageIO_unformatExtend_4(nitf_Uint8 * buffer,
     size_t i;
     
     shift = (nitf_Int32) shiftCount;
-    bp32 = (nitf_Int32 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 4,
+                                    NITF_IMAGE_IO_VEC_EXTEND,
+                                    shiftCount);
+    bp32 = ((nitf_Int32 *) buffer) + i;
+    for (; i < count; i++)
     {
         tmp32 = *bp32 << shift;
         *(bp32++) = tmp32 >> shift;
@@ -7828,8 +10329,11 @@ void nitf_ImageIO_unformatExtend_8(nitf_Uint8 * buffer,
     size_t i;
     
     shift = (nitf_Int64) shiftCount;
-    bp64 = (nitf_Int64 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 8,
+                                    NITF_IMAGE_IO_VEC_EXTEND,
+                                    shiftCount);
+    bp64 = ((nitf_Int64 *) buffer) + i;
+    for (; i < count; i++)
     {
         tmp64 = *bp64 << shift;
         *(bp64++) = tmp64 >> shift;
@@ -7867,8 +10371,11 @@ void nitf_ImageIO_unformatShift_2(nitf_Uint8 * buffer,
     size_t i;
     
     shift = (nitf_Int16) shiftCount;
-    bp16 = (nitf_Int16 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 2,
+                                    NITF_IMAGE_IO_VEC_SHIFT,
+                                    shiftCount);
+    bp16 = ((nitf_Int16 *) buffer) + i;
+    for (; i < count; i++)
         *(bp16++) >>= shift;
     
     return;
@@ -7884,8 +10391,11 @@ void nitf_ImageIO_unformatShift_4(nitf_Uint8 * buffer,
     size_t i;
     
     shift = (nitf_Int32) shiftCount;
-    bp32 = (nitf_Int32 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 4,
+                                    NITF_IMAGE_IO_VEC_SHIFT,
+                                    shiftCount);
+    bp32 = ((nitf_Int32 *) buffer) + i;
+    for (; i < count; i++)
         *(bp32++) >>= shift;
     
     return;
@@ -7903,8 +10413,11 @@ void nitf_ImageIO_unformatShift_8(nitf_Uint8 * buffer,
     size_t i;
     
     shift = (nitf_Int64) shiftCount;
-    bp64 = (nitf_Int64 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 8,
+                                    NITF_IMAGE_IO_VEC_SHIFT,
+                                    shiftCount);
+    bp64 = ((nitf_Int64 *) buffer) + i;
+    for (; i < count; i++)
         *(bp64++) >>= shift;
     
     return;
@@ -7936,8 +10449,11 @@ void nitf_ImageIO_unformatUShift_2(nitf_Uint8 * buffer,
     size_t i;
     
     shift = (nitf_Uint16) shiftCount;
-    bp16 = (nitf_Uint16 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 2,
+                                    NITF_IMAGE_IO_VEC_USHIFT,
+                                    shiftCount);
+    bp16 = ((nitf_Uint16 *) buffer) + i;
+    for (; i < count; i++)
         *(bp16++) >>= shift;
     
     return;
@@ -7953,8 +10469,11 @@ void nitf_ImageIO_unformatUShift_4(nitf_Uint8 * buffer,
     size_t i;
     
     shift = (nitf_Uint32) shiftCount;
-    bp32 = (nitf_Uint32 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 4,
+                                    NITF_IMAGE_IO_VEC_USHIFT,
+                                    shiftCount);
+    bp32 = ((nitf_Uint32 *) buffer) + i;
+    for (; i < count; i++)
         *(bp32++) >>= shift;
     
     return;
@@ -7971,8 +10490,11 @@ void nitf_ImageIO_unformatUShift_8(nitf_Uint8 * buffer,
     size_t i;
     
     shift = (nitf_Uint64) shiftCount;
-    bp64 = (nitf_Uint64 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 8,
+                                    NITF_IMAGE_IO_VEC_USHIFT,
+                                    shiftCount);
+    bp64 = ((nitf_Uint64 *) buffer) + i;
+    for (; i < count; i++)
         *(bp64++) >>= shift;
     
     return;
@@ -7987,132 +10509,43 @@ void nitf_ImageIO_swapOnly_2(nitf_Uint8 * buffer,
     size_t i;
     
     /* Silence compiler warnings about unused variables */
-    (void)shiftCount;
-
-    bp16 = (nitf_Uint16 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp16++;
-        tmp8 = bp8[0];
-        bp8[0] = bp8[1];
-        bp8[1] = tmp8;
-    }
-    
-    return;
-}
-
-
-void nitf_ImageIO_swapOnly_4(nitf_Uint8 * buffer,
-        size_t count, nitf_Uint32 shiftCount)
-{
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint32 *bp32;          /* Buffer pointer, 32 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-    
-    /* Silence compiler warnings about unused variables */
-    (void)shiftCount;
-
-    bp32 = (nitf_Uint32 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) (bp32++);
-        
-        tmp8 = bp8[0];
-        bp8[0] = bp8[3];
-        bp8[3] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[2];
-        bp8[2] = tmp8;
-    }
-    
-    return;
-}
-
-void nitf_ImageIO_swapOnly_4c(nitf_Uint8 * buffer,
-        size_t count, nitf_Uint32 shiftCount)
-{
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint32 *bp32;          /* Buffer pointer, 32 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
-    /* Silence compiler warnings about unused variables */
-    (void)shiftCount;
-
-    bp32 = (nitf_Uint32 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) (bp32++);
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[1];
-        bp8[1] = tmp8;
-        tmp8 = bp8[2];
-        bp8[2] = bp8[3];
-        bp8[3] = tmp8;
-    }
-
-    return;
-}
-
-
-void nitf_ImageIO_swapOnly_8(nitf_Uint8 * buffer,
-        size_t count, nitf_Uint32 shiftCount)
-{
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint64 *bp64;          /* Buffer pointer, 64 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-    
-    /* Silence compiler warnings about unused variables */
-    (void)shiftCount;
-
-    bp64 = (nitf_Uint64 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) (bp64++);
-        
-        tmp8 = bp8[0];
-        bp8[0] = bp8[7];
-        bp8[7] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[6];
-        bp8[6] = tmp8;
-        tmp8 = bp8[2];
-        bp8[2] = bp8[5];
-        bp8[5] = tmp8;
-        tmp8 = bp8[3];
-        bp8[3] = bp8[4];
-        bp8[4] = tmp8;
+    (void)shiftCount;
+
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 2,
+                                    NITF_IMAGE_IO_VEC_SWAP,
+                                    shiftCount);
+    bp16 = ((nitf_Uint16 *) buffer) + i;
+    for (; i < count; i++)
+    {
+        bp8 = (nitf_Uint8 *) bp16++;
+        tmp8 = bp8[0];
+        bp8[0] = bp8[1];
+        bp8[1] = tmp8;
     }
     
     return;
 }
 
 
-void nitf_ImageIO_swapOnly_8c(nitf_Uint8 * buffer,
+void nitf_ImageIO_swapOnly_4(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
     nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint64 *bp64;          /* Buffer pointer, 64 bit */
+    nitf_Uint32 *bp32;          /* Buffer pointer, 32 bit */
     nitf_Uint8 tmp8;            /* Temp value, 8 bit */
     size_t i;
     
     /* Silence compiler warnings about unused variables */
     (void)shiftCount;
 
-    bp64 = (nitf_Uint64 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 4,
+                                    NITF_IMAGE_IO_VEC_SWAP,
+                                    shiftCount);
+    bp32 = ((nitf_Uint32 *) buffer) + i;
+    for (; i < count; i++)
     {
-        bp8 = (nitf_Uint8 *) (bp64++);
+        bp8 = (nitf_Uint8 *) (bp32++);
         
-        tmp8 = bp8[4];
-        bp8[4] = bp8[7];
-        bp8[7] = tmp8;
-        tmp8 = bp8[5];
-        bp8[5] = bp8[6];
-        bp8[6] = tmp8;
         tmp8 = bp8[0];
         bp8[0] = bp8[3];
         bp8[3] = tmp8;
@@ -8124,8 +10557,16 @@ void nitf_ImageIO_swapOnly_8c(nitf_Uint8 * buffer,
     return;
 }
 
+void nitf_ImageIO_swapOnly_4c(nitf_Uint8 * buffer,
+        size_t count, nitf_Uint32 shiftCount)
+{
+    /* Each complex value is two consecutive reals, swapped separately */
+    nitf_ImageIO_swapOnly_2(buffer, 2 * count, shiftCount);
+    return;
+}
+
 
-void nitf_ImageIO_swapOnly_16c(nitf_Uint8 * buffer,
+void nitf_ImageIO_swapOnly_8(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
     nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
@@ -8136,8 +10577,11 @@ void nitf_ImageIO_swapOnly_16c(nitf_Uint8 * buffer,
     /* Silence compiler warnings about unused variables */
     (void)shiftCount;
 
-    bp64 = (nitf_Uint64 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 8,
+                                    NITF_IMAGE_IO_VEC_SWAP,
+                                    shiftCount);
+    bp64 = ((nitf_Uint64 *) buffer) + i;
+    for (; i < count; i++)
     {
         bp8 = (nitf_Uint8 *) (bp64++);
         
@@ -8153,27 +10597,30 @@ void nitf_ImageIO_swapOnly_16c(nitf_Uint8 * buffer,
         tmp8 = bp8[3];
         bp8[3] = bp8[4];
         bp8[4] = tmp8;
-        
-        bp8 = (nitf_Uint8 *) (bp64++);
-        
-        tmp8 = bp8[0];
-        bp8[0] = bp8[7];
-        bp8[7] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[6];
-        bp8[6] = tmp8;
-        tmp8 = bp8[2];
-        bp8[2] = bp8[5];
-        bp8[5] = tmp8;
-        tmp8 = bp8[3];
-        bp8[3] = bp8[4];
-        bp8[4] = tmp8;
     }
     
     return;
 }
 
 
+void nitf_ImageIO_swapOnly_8c(nitf_Uint8 * buffer,
+        size_t count, nitf_Uint32 shiftCount)
+{
+    /* Each complex value is two consecutive reals, swapped separately */
+    nitf_ImageIO_swapOnly_4(buffer, 2 * count, shiftCount);
+    return;
+}
+
+
+void nitf_ImageIO_swapOnly_16c(nitf_Uint8 * buffer,
+        size_t count, nitf_Uint32 shiftCount)
+{
+    /* Each complex value is two consecutive reals, swapped separately */
+    nitf_ImageIO_swapOnly_8(buffer, 2 * count, shiftCount);
+    return;
+}
+
+
 void nitf_ImageIO_unformatSwapExtend_2(nitf_Uint8 * buffer,
                                        size_t count,
                                        nitf_Uint32 shiftCount)
@@ -8182,12 +10629,15 @@ void nitf_ImageIO_unformatSwapExtend_2(nitf_Uint8 * buffer,
     nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
     nitf_Int16 *bp16;           /* Buffer pointer, 16 bit */
     nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    nitf_Uint16 tmp16;          /* Temp value, 16 bit */
+    nitf_Int16 tmp16;           /* Temp value, 16 bit */
     size_t i;
     
     shift = (nitf_Int16) shiftCount;
-    bp16 = (nitf_Int16 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 2,
+                                    NITF_IMAGE_IO_VEC_SWAP | NITF_IMAGE_IO_VEC_EXTEND,
+                                    shiftCount);
+    bp16 = ((nitf_Int16 *) buffer) + i;
+    for (; i < count; i++)
     {
         bp8 = (nitf_Uint8 *) bp16;
         tmp8 = bp8[0];
@@ -8210,14 +10660,17 @@ void nitf_ImageIO_unformatSwapExtend_4(nitf_Uint8 * buffer,
     nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
     nitf_Int32 *bp32;           /* Buffer pointer, 32 bit */
     nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    nitf_Uint8 tmp32;           /* Temp value, 32 bit */
+    nitf_Int32 tmp32;           /* Temp value, 32 bit */
     size_t i;
     
     shift = (nitf_Int32) shiftCount;
-    bp32 = (nitf_Int32 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 4,
+                                    NITF_IMAGE_IO_VEC_SWAP | NITF_IMAGE_IO_VEC_EXTEND,
+                                    shiftCount);
+    bp32 = ((nitf_Int32 *) buffer) + i;
+    for (; i < count; i++)
     {
-        bp8 = (nitf_Uint8 *) (bp32++);
+        bp8 = (nitf_Uint8 *) bp32;
         
         tmp8 = bp8[0];
         bp8[0] = bp8[3];
@@ -8243,12 +10696,15 @@ void nitf_ImageIO_unformatSwapExtend_8(nitf_Uint8 * buffer,
     nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
     nitf_Int64 *bp64;           /* Buffer pointer, 64 bit */
     nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    nitf_Uint64 tmp64;          /* Temp value, 64 bit */
+    nitf_Int64 tmp64;           /* Temp value, 64 bit */
     size_t i;
     
     shift = (nitf_Int64) shiftCount;
-    bp64 = (nitf_Int64 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 8,
+                                    NITF_IMAGE_IO_VEC_SWAP | NITF_IMAGE_IO_VEC_EXTEND,
+                                    shiftCount);
+    bp64 = ((nitf_Int64 *) buffer) + i;
+    for (; i < count; i++)
     {
         bp8 = (nitf_Uint8 *) bp64;
         
@@ -8284,8 +10740,11 @@ void nitf_ImageIO_unformatSwapShift_2(nitf_Uint8 * buffer,
     size_t i;
     
     shift = (nitf_Int16) shiftCount;
-    bp16 = (nitf_Int16 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 2,
+                                    NITF_IMAGE_IO_VEC_SWAP | NITF_IMAGE_IO_VEC_SHIFT,
+                                    shiftCount);
+    bp16 = ((nitf_Int16 *) buffer) + i;
+    for (; i < count; i++)
     {
         bp8 = (nitf_Uint8 *) bp16;
         tmp8 = bp8[0];
@@ -8310,8 +10769,11 @@ void nitf_ImageIO_unformatSwapShift_4(nitf_Uint8 * buffer,
     size_t i;
     
     shift = (nitf_Int32) shiftCount;
-    bp32 = (nitf_Int32 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 4,
+                                    NITF_IMAGE_IO_VEC_SWAP | NITF_IMAGE_IO_VEC_SHIFT,
+                                    shiftCount);
+    bp32 = ((nitf_Int32 *) buffer) + i;
+    for (; i < count; i++)
     {
         bp8 = (nitf_Uint8 *) bp32;
         
@@ -8341,8 +10803,11 @@ void nitf_ImageIO_unformatSwapShift_8(nitf_Uint8 * buffer,
     size_t i;
     
     shift = (nitf_Int64) shiftCount;
-    bp64 = (nitf_Int64 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 8,
+                                    NITF_IMAGE_IO_VEC_SWAP | NITF_IMAGE_IO_VEC_SHIFT,
+                                    shiftCount);
+    bp64 = ((nitf_Int64 *) buffer) + i;
+    for (; i < count; i++)
     {
         bp8 = (nitf_Uint8 *) bp64;
         
@@ -8377,8 +10842,11 @@ void nitf_ImageIO_unformatSwapUShift_2(nitf_Uint8 * buffer,
     size_t i;
     
     shift = (nitf_Uint16) shiftCount;
-    bp16 = (nitf_Uint16 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 2,
+                                    NITF_IMAGE_IO_VEC_SWAP | NITF_IMAGE_IO_VEC_USHIFT,
+                                    shiftCount);
+    bp16 = ((nitf_Uint16 *) buffer) + i;
+    for (; i < count; i++)
     {
         bp8 = (nitf_Uint8 *) bp16;
         tmp8 = bp8[0];
@@ -8402,8 +10870,11 @@ void nitf_ImageIO_unformatSwapUShift_4(nitf_Uint8 * buffer,
     size_t i;
     
     shift = (nitf_Uint32) shiftCount;
-    bp32 = (nitf_Uint32 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 4,
+                                    NITF_IMAGE_IO_VEC_SWAP | NITF_IMAGE_IO_VEC_USHIFT,
+                                    shiftCount);
+    bp32 = ((nitf_Uint32 *) buffer) + i;
+    for (; i < count; i++)
     {
         bp8 = (nitf_Uint8 *) bp32;
         
@@ -8433,8 +10904,11 @@ void nitf_ImageIO_unformatSwapUShift_8(nitf_Uint8 * buffer,
     size_t i;
     
     shift = (nitf_Uint64) shiftCount;
-    bp64 = (nitf_Uint64 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 8,
+                                    NITF_IMAGE_IO_VEC_SWAP | NITF_IMAGE_IO_VEC_USHIFT,
+                                    shiftCount);
+    bp64 = ((nitf_Uint64 *) buffer) + i;
+    for (; i < count; i++)
     {
         bp8 = (nitf_Uint8 *) bp64;
         
@@ -8762,8 +11236,11 @@ void nitf_ImageIO_formatShift_2(nitf_Uint8 * buffer,
     size_t i;
     
     shift = (nitf_Int16) shiftCount;
-    bp16 = (nitf_Int16 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 2,
+                                    NITF_IMAGE_IO_VEC_LSHIFT,
+                                    shiftCount);
+    bp16 = ((nitf_Int16 *) buffer) + i;
+    for (; i < count; i++)
         *(bp16++) <<= shift;
     
     return;
@@ -8778,8 +11255,11 @@ void nitf_ImageIO_formatShift_4(nitf_Uint8 * buffer,
     size_t i;
     
     shift = (nitf_Int32) shiftCount;
-    bp32 = (nitf_Int32 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 4,
+                                    NITF_IMAGE_IO_VEC_LSHIFT,
+                                    shiftCount);
+    bp32 = ((nitf_Int32 *) buffer) + i;
+    for (; i < count; i++)
         *(bp32++) <<= shift;
     
     return;
@@ -8796,8 +11276,11 @@ void nitf_ImageIO_formatShift_8(nitf_Uint8 * buffer,
     size_t i;
     
     shift = (nitf_Int64) shiftCount;
-    bp64 = (nitf_Int64 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 8,
+                                    NITF_IMAGE_IO_VEC_LSHIFT,
+                                    shiftCount);
+    bp64 = ((nitf_Int64 *) buffer) + i;
+    for (; i < count; i++)
         *(bp64++) <<= shift;
     
     return;
@@ -8879,15 +11362,18 @@ void nitf_ImageIO_formatShiftSwap_2(nitf_Uint8 * buffer,
     size_t i;
     
     shift = (nitf_Int16) shiftCount;
-    bp16 = (nitf_Int16 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 2,
+                                    NITF_IMAGE_IO_VEC_LSHIFT | NITF_IMAGE_IO_VEC_SWAP,
+                                    shiftCount);
+    bp16 = ((nitf_Int16 *) buffer) + i;
+    for (; i < count; i++)
     {
-        bp8 = (nitf_Uint8 *) bp16;
+        *bp16 <<= shift;
+
+        bp8 = (nitf_Uint8 *) (bp16++);
         tmp8 = bp8[0];
         bp8[0] = bp8[1];
         bp8[1] = tmp8;
-        
-        *(bp16++) >>= shift;
     }
     
     return;
@@ -8905,19 +11391,21 @@ void nitf_ImageIO_formatShiftSwap_4(nitf_Uint8 * buffer,
     size_t i;
     
     shift = (nitf_Int32) shiftCount;
-    bp32 = (nitf_Int32 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 4,
+                                    NITF_IMAGE_IO_VEC_LSHIFT | NITF_IMAGE_IO_VEC_SWAP,
+                                    shiftCount);
+    bp32 = ((nitf_Int32 *) buffer) + i;
+    for (; i < count; i++)
     {
-        bp8 = (nitf_Uint8 *) bp32;
-        
+        *bp32 <<= shift;
+
+        bp8 = (nitf_Uint8 *) (bp32++);
         tmp8 = bp8[0];
         bp8[0] = bp8[3];
         bp8[3] = tmp8;
         tmp8 = bp8[1];
         bp8[1] = bp8[2];
         bp8[2] = tmp8;
-        
-        *(bp32++) >>= shift;
     }
     
     return;
@@ -8936,11 +11424,15 @@ void nitf_ImageIO_formatShiftSwap_8(nitf_Uint8 * buffer,
     size_t i;
     
     shift = (nitf_Int64) shiftCount;
-    bp64 = (nitf_Int64 *) buffer;
-    for (i = 0; i < count; i++)
+    i = nitf_ImageIO_vectorUnformat(buffer, count, 8,
+                                    NITF_IMAGE_IO_VEC_LSHIFT | NITF_IMAGE_IO_VEC_SWAP,
+                                    shiftCount);
+    bp64 = ((nitf_Int64 *) buffer) + i;
+    for (; i < count; i++)
     {
-        bp8 = (nitf_Uint8 *) bp64;
-        
+        *bp64 <<= shift;
+
+        bp8 = (nitf_Uint8 *) (bp64++);
         tmp8 = bp8[0];
         bp8[0] = bp8[7];
         bp8[7] = tmp8;
@@ -8953,8 +11445,6 @@ void nitf_ImageIO_formatShiftSwap_8(nitf_Uint8 * buffer,
         tmp8 = bp8[3];
         bp8[3] = bp8[4];
         bp8[4] = tmp8;
-
-        *(bp64++) >>= shift;
     }
     
     return;
@@ -9054,6 +11544,281 @@ void nitf_ImageIO_formatMaskSwap_8(nitf_Uint8 * buffer,
 }
 
 
+/*============================================================================*/
+/*======================== B and 12-bit pixel packing ========================*/
+/*============================================================================*/
+
+/* Table of the eight pixels (most significant bit first) of each byte */
+
+#define NITF_IMAGE_IO_BITS_1(n) \
+    { ((n) >> 7) & 1, ((n) >> 6) & 1, ((n) >> 5) & 1, ((n) >> 4) & 1, \
+      ((n) >> 3) & 1, ((n) >> 2) & 1, ((n) >> 1) & 1, (n) & 1 }
+#define NITF_IMAGE_IO_BITS_4(n) \
+    NITF_IMAGE_IO_BITS_1(n), NITF_IMAGE_IO_BITS_1((n) + 1), \
+    NITF_IMAGE_IO_BITS_1((n) + 2), NITF_IMAGE_IO_BITS_1((n) + 3)
+#define NITF_IMAGE_IO_BITS_16(n) \
+    NITF_IMAGE_IO_BITS_4(n), NITF_IMAGE_IO_BITS_4((n) + 4), \
+    NITF_IMAGE_IO_BITS_4((n) + 8), NITF_IMAGE_IO_BITS_4((n) + 12)
+#define NITF_IMAGE_IO_BITS_64(n) \
+    NITF_IMAGE_IO_BITS_16(n), NITF_IMAGE_IO_BITS_16((n) + 16), \
+    NITF_IMAGE_IO_BITS_16((n) + 32), NITF_IMAGE_IO_BITS_16((n) + 48)
+
+static const nitf_Uint8 nitf_ImageIO_bitsTable[256][8] =
+{
+    NITF_IMAGE_IO_BITS_64(0), NITF_IMAGE_IO_BITS_64(64),
+    NITF_IMAGE_IO_BITS_64(128), NITF_IMAGE_IO_BITS_64(192)
+};
+
+NITFPRIV(void) nitf_ImageIO_unpackB(const nitf_Uint8 *packed,
+                                    nitf_Uint8 *pixels, size_t count)
+{
+    size_t numBytes;   /* Number of whole input bytes */
+    size_t i;
+
+    numBytes = count / 8;
+    for (i = 0; i < numBytes; i++)
+    {
+        memcpy(pixels, nitf_ImageIO_bitsTable[packed[i]], 8);
+        pixels += 8;
+    }
+
+    if (count % 8)
+        memcpy(pixels, nitf_ImageIO_bitsTable[packed[numBytes]], count % 8);
+
+    return;
+}
+
+#ifdef NITF_IMAGE_IO_SSE2
+
+/* Bit reversal table, converts a movemask result to NITF bit order */
+
+#define NITF_IMAGE_IO_REVERSE_1(n) \
+    ((((n) & 0x01) << 7) | (((n) & 0x02) << 5) | (((n) & 0x04) << 3) | \
+     (((n) & 0x08) << 1) | (((n) & 0x10) >> 1) | (((n) & 0x20) >> 3) | \
+     (((n) & 0x40) >> 5) | (((n) & 0x80) >> 7))
+#define NITF_IMAGE_IO_REVERSE_4(n) \
+    NITF_IMAGE_IO_REVERSE_1(n), NITF_IMAGE_IO_REVERSE_1((n) + 1), \
+    NITF_IMAGE_IO_REVERSE_1((n) + 2), NITF_IMAGE_IO_REVERSE_1((n) + 3)
+#define NITF_IMAGE_IO_REVERSE_16(n) \
+    NITF_IMAGE_IO_REVERSE_4(n), NITF_IMAGE_IO_REVERSE_4((n) + 4), \
+    NITF_IMAGE_IO_REVERSE_4((n) + 8), NITF_IMAGE_IO_REVERSE_4((n) + 12)
+#define NITF_IMAGE_IO_REVERSE_64(n) \
+    NITF_IMAGE_IO_REVERSE_16(n), NITF_IMAGE_IO_REVERSE_16((n) + 16), \
+    NITF_IMAGE_IO_REVERSE_16((n) + 32), NITF_IMAGE_IO_REVERSE_16((n) + 48)
+
+static const nitf_Uint8 nitf_ImageIO_reverseTable[256] =
+{
+    NITF_IMAGE_IO_REVERSE_64(0), NITF_IMAGE_IO_REVERSE_64(64),
+    NITF_IMAGE_IO_REVERSE_64(128), NITF_IMAGE_IO_REVERSE_64(192)
+};
+
+#endif
+
+NITFPRIV(void) nitf_ImageIO_packB(const nitf_Uint8 *pixels,
+                                  nitf_Uint8 *packed, size_t count)
+{
+    size_t i;
+    nitf_Uint8 current;  /* Current output byte */
+#ifdef NITF_IMAGE_IO_SSE2
+    __m128i zero;        /* Zero vector for the comparison */
+    int mask;            /* Zero pixel mask, one bit per pixel */
+#endif
+
+    i = 0;
+#ifdef NITF_IMAGE_IO_SSE2
+    zero = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16)
+    {
+        mask = _mm_movemask_epi8(_mm_cmpeq_epi8(
+            _mm_loadu_si128((const __m128i *) (pixels + i)), zero)) ^ 0xffff;
+        *(packed++) = nitf_ImageIO_reverseTable[mask & 0xff];
+        *(packed++) = nitf_ImageIO_reverseTable[mask >> 8];
+    }
+#endif
+
+    current = 0;
+    for (; i < count; i++)
+    {
+        current = (nitf_Uint8) ((current << 1) | (pixels[i] != 0));
+        if (i % 8 == 7)
+        {
+            *(packed++) = current;
+            current = 0;
+        }
+    }
+
+    if (count % 8)
+        *packed = (nitf_Uint8) (current << (8 - count % 8));
+
+    return;
+}
+
+#ifdef NITF_IMAGE_IO_AVX2
+
+/*
+ *  Each 128-bit lane holds four pairs of pixels (12 bytes) when packed, and
+ *  eight pixels when unpacked. The byte shuffle puts bytes (a, b) and
+ *  (b, c) of each pair (a b c) into big endian order in two 16-bit words,
+ *  the first pixel is the first word shifted down and the second the low
+ *  12 bits of the second word. Packing reverses this through 32-bit
+ *  (a b c) values.
+ *
+ *  The 16 byte loads and stores go 4 bytes past the 24 used, so the loops
+ *  leave room for this at the end of the packed buffer.
+ */
+
+#define NITF_IMAGE_IO_PACK12_VECTORS(pairs) \
+    ((3 * (pairs) >= 28) ? (3 * (pairs) - 28) / 24 + 1 : 0)
+
+NITF_IMAGE_IO_AVX2_TARGET
+NITFPRIV(size_t) nitf_ImageIO_unpack12AVX2(const nitf_Uint8 *packed,
+                                           nitf_Uint16 *pixels,
+                                           size_t count)
+{
+    size_t numVectors;   /* Number of 16 pixel vectors */
+    __m256i shuffle;     /* Byte shuffle control */
+    __m256i firstMask;   /* Selects the first pixel of each pair */
+    __m256i secondMask;  /* Selects the second pixel of each pair */
+    __m256i v;
+    size_t i;
+
+    numVectors = NITF_IMAGE_IO_PACK12_VECTORS(count / 2);
+    shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4,
+                               7, 6, 8, 7, 10, 9, 11, 10,
+                               1, 0, 2, 1, 4, 3, 5, 4,
+                               7, 6, 8, 7, 10, 9, 11, 10);
+    firstMask = _mm256_set1_epi32(0x0000ffff);
+    secondMask = _mm256_set1_epi32(0x0fff0000);
+    for (i = 0; i < numVectors; i++)
+    {
+        v = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *) packed)),
+            _mm_loadu_si128((const __m128i *) (packed + 12)), 1);
+        v = _mm256_shuffle_epi8(v, shuffle);
+        v = _mm256_or_si256(
+            _mm256_and_si256(_mm256_srli_epi16(v, 4), firstMask),
+            _mm256_and_si256(v, secondMask));
+        _mm256_storeu_si256((__m256i *) pixels, v);
+        packed += 24;
+        pixels += 16;
+    }
+
+    return numVectors * 16;
+}
+
+NITF_IMAGE_IO_AVX2_TARGET
+NITFPRIV(size_t) nitf_ImageIO_pack12AVX2(const nitf_Uint16 *pixels,
+                                         nitf_Uint8 *packed,
+                                         size_t count)
+{
+    size_t numVectors;   /* Number of 16 pixel vectors */
+    __m256i shuffle;     /* Byte shuffle control */
+    __m256i mask;        /* 12 bit pixel mask */
+    __m256i v;
+    size_t i;
+
+    numVectors = NITF_IMAGE_IO_PACK12_VECTORS(count / 2);
+    shuffle = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9,
+                               8, 14, 13, 12, -1, -1, -1, -1,
+                               2, 1, 0, 6, 5, 4, 10, 9,
+                               8, 14, 13, 12, -1, -1, -1, -1);
+    mask = _mm256_set1_epi32(0x00000fff);
+    for (i = 0; i < numVectors; i++)
+    {
+        v = _mm256_loadu_si256((const __m256i *) pixels);
+        v = _mm256_or_si256(
+            _mm256_slli_epi32(_mm256_and_si256(v, mask), 12),
+            _mm256_and_si256(_mm256_srli_epi32(v, 16), mask));
+        v = _mm256_shuffle_epi8(v, shuffle);
+        _mm_storeu_si128((__m128i *) packed, _mm256_castsi256_si128(v));
+        _mm_storeu_si128((__m128i *) (packed + 12),
+                         _mm256_extracti128_si256(v, 1));
+        pixels += 16;
+        packed += 24;
+    }
+
+    return numVectors * 16;
+}
+
+#endif
+
+NITFPRIV(void) nitf_ImageIO_unpack12(const nitf_Uint8 *packed,
+                                     nitf_Uint16 *pixels, size_t count)
+{
+    nitf_Uint16 a;       /* Components of compressed pixel */
+    nitf_Uint16 b;
+    nitf_Uint16 c;
+    size_t i;
+
+    i = 0;
+#ifdef NITF_IMAGE_IO_AVX2
+    if (nitf_ImageIO_getVectorLevel() >= 2)
+    {
+        i = nitf_ImageIO_unpack12AVX2(packed, pixels, count);
+        packed += 3 * (i / 2);
+        pixels += i;
+    }
+#endif
+
+    for (; i + 1 < count; i += 2)
+    {
+        a = *(packed++);
+        b = *(packed++);
+        c = *(packed++);
+
+        *(pixels++) = (a << 4) + (b >> 4);
+        *(pixels++) = ((b << 8) & 0xf00) + c;
+    }
+
+    if (count & 1)   /* Odd count, the last pixel is in two bytes */
+    {
+        a = *(packed++);
+        b = *(packed++);
+
+        *pixels = (a << 4) + (b >> 4);
+    }
+
+    return;
+}
+
+NITFPRIV(void) nitf_ImageIO_pack12(const nitf_Uint16 *pixels,
+                                   nitf_Uint8 *packed, size_t count)
+{
+    nitf_Uint16 i1;      /* First pixel in input pair */
+    nitf_Uint16 i2;      /* Second pixel in input pair */
+    size_t i;
+
+    i = 0;
+#ifdef NITF_IMAGE_IO_AVX2
+    if (nitf_ImageIO_getVectorLevel() >= 2)
+    {
+        i = nitf_ImageIO_pack12AVX2(pixels, packed, count);
+        pixels += i;
+        packed += 3 * (i / 2);
+    }
+#endif
+
+    for (; i + 1 < count; i += 2)
+    {
+        i1 = *(pixels++);
+        i2 = *(pixels++);
+
+        *(packed++) = (i1 >> 4) & 0xff;
+        *(packed++) = ((i1 & 0x0f) << 4) + ((i2 >> 8) & 0x0f);
+        *(packed++) = i2 & 0xff;
+    }
+
+    if (count & 1)  /* Handle last pixel in odd block length case */
+    {
+        i1 = *pixels;
+        *(packed++) = (i1 >> 4) & 0xff;
+        *packed = (i1 & 0x0f) << 4;
+    }
+
+    return;
+}
+
+
 /*============================================================================*/
 /*======================== B pixel type psuedo decompressor ==================*/
 /*============================================================================*/
@@ -9089,6 +11854,8 @@ nitf_ImageIO_bPixelOpen(nitf_ImageSubheader * subheader,
                         NITF_CTXT, NITF_ERR_DECOMPRESSION);
         return NULL;
     }
+    /* The buffer is allocated by the start function */
+    memset(icntl, 0, sizeof(nitf_ImageIO_BPixelControl));
 
     return (nitf_DecompressionControl *) icntl;
 }
@@ -9136,28 +11903,26 @@ nitf_ImageIO_bPixelReadBlock(nitf_DecompressionControl * control,
     nitf_ImageIO_BPixelControl *icntl;
     size_t uncompressedLen;     /* Length of uncompressed block */
     nitf_Uint8 *block;          /* Uncompressed result */
-    nitf_Uint8 *blockPtr;       /* Pointer in uncompressed result */
-    nitf_Uint8 *compPtr;        /* Pointer in compressed input */
-    nitf_Uint8 current;         /* Current byte of compressed data */
-    size_t i;
+    const nitf_Uint8 *compPtr;  /* Compressed input */
+    nitf_Off offset;            /* File offset of the block */
     
     icntl = (nitf_ImageIO_BPixelControl *) control;
     uncompressedLen = icntl->blockInfo->length;
     
-    /* Read the data */
+    /* Use the data in place if the IO is memory mapped, otherwise read it */
     
-    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(icntl->io,
-                                               (nitf_Off) (icntl->offset +
-                                                           icntl->
-                                                           blockMask
-                                                           [blockNumber]),
-                                               NITF_SEEK_SET, error)))
-        return NULL;
-    
-    if (!nitf_IOInterface_read(icntl->io,
-                               (char *) (icntl->buffer),
-                               icntl->blockSizeCompressed, error))
-        return NULL;
+    offset = (nitf_Off) (icntl->offset + icntl->blockMask[blockNumber]);
+    compPtr = (const nitf_Uint8 *)
+        nitf_IOInterface_getBuffer(icntl->io, offset,
+                                   icntl->blockSizeCompressed);
+    if (compPtr == NULL)
+    {
+        if (!nitf_IOInterface_readAt(icntl->io, offset,
+                                     (char *) (icntl->buffer),
+                                     icntl->blockSizeCompressed, error))
+            return NULL;
+        compPtr = icntl->buffer;
+    }
     
     /* Allocate block */
     
@@ -9171,16 +11936,7 @@ nitf_ImageIO_bPixelReadBlock(nitf_DecompressionControl * control,
 
     /* Decompress the result */
 
-    blockPtr = block;
-    compPtr = icntl->buffer;
-    current = 0;                /* Avoids uninitialized variable warning */
-    for (i = 0; i < uncompressedLen; i++)
-    {
-        if (i % 8 == 0)
-            current = *(compPtr++);
-        *(blockPtr++) = (current & 0x80) ? 1 : 0;
-        current <<= 1;
-    }
+    nitf_ImageIO_unpackB(compPtr, block, uncompressedLen);
 
     *blockSize = uncompressedLen;
     return block;
@@ -9236,6 +11992,8 @@ nitf_ImageIO_12PixelOpen(nitf_ImageSubheader * subheader,
                         NITF_CTXT, NITF_ERR_DECOMPRESSION);
         return NULL;
     }
+    /* The buffer is allocated by the start function */
+    memset(icntl, 0, sizeof(nitf_ImageIO_12PixelControl));
 
     return (nitf_DecompressionControl *) icntl;
 }
@@ -9295,27 +12053,26 @@ nitf_ImageIO_12PixelReadBlock(nitf_DecompressionControl* control,
     nitf_ImageIO_12PixelControl *icntl;
     size_t uncompressedLen;        /* Length of uncompressed block */
     nitf_Uint8 *block;             /* Uncompressed result */
-    nitf_Uint16 *blockPtr;         /* Pointer in uncompressed result */
-    nitf_Uint8 *compPtr;           /* Pointer in compressed input */
-    nitf_Uint16 a;                 /* Components of compressed pixel */
-    nitf_Uint16 b;
-    nitf_Uint16 c;
-    size_t i;
+    const nitf_Uint8 *compPtr;     /* Compressed input */
+    nitf_Off offset;               /* File offset of the block */
 
     icntl = (nitf_ImageIO_12PixelControl *) control;
     uncompressedLen = icntl->blockInfo->length;
 
-    /* Read the data */
-
-    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(icntl->io,
-                 (nitf_Off) (icntl->offset + icntl->blockMask[blockNumber]),
-                                               NITF_SEEK_SET, error)))
-        return NULL;
+    /* Use the data in place if the IO is memory mapped, otherwise read it */
 
-    if (!nitf_IOInterface_read(icntl->io,
-                               (char *) (icntl->buffer),
-                               icntl->blockSizeCompressed, error))
-        return NULL;
+    offset = (nitf_Off) (icntl->offset + icntl->blockMask[blockNumber]);
+    compPtr = (const nitf_Uint8 *)
+        nitf_IOInterface_getBuffer(icntl->io, offset,
+                                   icntl->blockSizeCompressed);
+    if (compPtr == NULL)
+    {
+        if (!nitf_IOInterface_readAt(icntl->io, offset,
+                                     (char *) (icntl->buffer),
+                                     icntl->blockSizeCompressed, error))
+            return NULL;
+        compPtr = icntl->buffer;
+    }
 
     /* Allocate block */
 
@@ -9329,25 +12086,8 @@ nitf_ImageIO_12PixelReadBlock(nitf_DecompressionControl* control,
 
     /* Decompress the result */
 
-    blockPtr = (nitf_Uint16 *) block;
-    compPtr = icntl->buffer;
-    for (i = 0; i < icntl->blockPixelCount/2; i++)
-    {
-      a = *(compPtr++);
-      b = *(compPtr++);
-      c = *(compPtr++);
-
-      *(blockPtr++) = (a << 4) + (b >> 4);
-      *(blockPtr++) = ((b << 8) & 0xf00) + c;
-    }
-
-    if(icntl->odd)   /* Look for odd count and handle last pixel */
-    {
-      a = *(compPtr++);
-      b = *(compPtr++);
-
-      *(blockPtr++) = (a << 4) + (b >>4);
-    }
+    nitf_ImageIO_unpack12(compPtr, (nitf_Uint16 *) block,
+                          icntl->blockPixelCount);
 
     *blockSize = icntl->blockPixelCount * sizeof(nitf_Uint16);
 
@@ -9441,12 +12181,12 @@ nitf_ImageIO_12PixelComStart(nitf_CompressionControl *object,
   icntl->offset = offset;
   icntl->blockMask = blockMask;
   icntl->padMask = padMask;
-  icntl->buffer = NULL;
   icntl->written = 0;
 
-/* Allocate compressed block buffer */
+/* Allocate compressed block buffer, unless open already has */
 
-  icntl->buffer = (nitf_Uint8 *) NITF_MALLOC(icntl->blockSizeCompressed);
+  if(icntl->buffer == NULL)
+    icntl->buffer = (nitf_Uint8 *) NITF_MALLOC(icntl->blockSizeCompressed);
   if(icntl->buffer == NULL)
     return(NITF_FAILURE);
 
@@ -9462,13 +12202,6 @@ nitf_ImageIO_12PixelComWriteBlock(nitf_CompressionControl * object,
                                   nitf_Error *error)
 {
   nitf_ImageIO_12PixelComControl *icntl;  /* The internal data structure */
-  size_t pairs;                /* Number of pixel pairs */
-  nitf_Uint16 *dp;             /* Pointer into input buffer */
-  nitf_Uint8 *bp;              /* Pointer into output buffer */
-  nitf_Uint16 i1;              /* First pixel in input pair */
-  nitf_Uint16 i2;              /* Second pixel in input pair */
-  nitf_Off fileOffset;         /* File offset for write */
-  size_t i;
 
   /* Silence compiler warnings about unused variables */
   (void)pad;
@@ -9476,29 +12209,22 @@ nitf_ImageIO_12PixelComWriteBlock(nitf_CompressionControl * object,
 
   icntl = (nitf_ImageIO_12PixelComControl *) object;
 
-  icntl->io = io;
-
 /* Compress block into buffer */
 
-  pairs = icntl->blockPixelCount/2;
-  bp = icntl->buffer;
-  dp = (nitf_Uint16 *) data;
-  for(i=0;i<pairs;i++)
-  {
-    i1 = *(dp++);
-    i2 = *(dp++);
+  nitf_ImageIO_pack12((const nitf_Uint16 *) data, icntl->buffer,
+                      icntl->blockPixelCount);
 
-    *(bp++) = (i1 >> 4) & 0xff;
-    *(bp++) = ((i1 & 0x0f) << 4) + ((i2 >> 8) & 0x0f);
-    *(bp++) = i2 & 0xff;
-  }
+  return nitf_ImageIO_packedComWrite(icntl, io, error);
+}
 
-  if(icntl->odd)  /* Handle last pixel in odd block length case */
-  {
-    i1 = *dp;
-    *(bp++) = (i1 >> 4) & 0xff;
-    *(bp++) = (i1 & 0x0f) << 4;
-  }
+NITFPRIV(NITF_BOOL)
+nitf_ImageIO_packedComWrite(nitf_ImageIO_12PixelComControl *icntl,
+                            nitf_IOInterface* io,
+                            nitf_Error *error)
+{
+  nitf_Off fileOffset;         /* File offset for write */
+
+  icntl->io = io;
 
 /* Do the write */
 
@@ -9517,6 +12243,48 @@ nitf_ImageIO_12PixelComWriteBlock(nitf_CompressionControl * object,
   return(NITF_SUCCESS);
 }
 
+nitf_CompressionControl *nitf_ImageIO_bPixelComOpen
+( nitf_ImageSubheader * subheader, nrt_HashTable* options, nitf_Error * error)
+{
+  nitf_ImageIO_12PixelComControl *icntl;   /* The result */
+
+  icntl = (nitf_ImageIO_12PixelComControl *)
+      nitf_ImageIO_12PixelComOpen(subheader, options, error);
+  if (icntl == NULL)
+    return(NULL);
+
+/* Same block as the 12-bit pixel type, packed eight pixels per byte */
+
+  icntl->odd = 0;
+  icntl->blockSizeCompressed = (icntl->blockPixelCount + 7)/8;
+  icntl->blockSizeUncompressed = icntl->blockPixelCount;
+
+  return((nitf_CompressionControl *) icntl);
+}
+
+NITF_BOOL
+nitf_ImageIO_bPixelComWriteBlock(nitf_CompressionControl * object,
+                                 nitf_IOInterface* io,
+                                 const nitf_Uint8 *data,
+                                 NITF_BOOL pad,
+                                 NITF_BOOL noData,
+                                 nitf_Error *error)
+{
+  nitf_ImageIO_12PixelComControl *icntl;  /* The internal data structure */
+
+  /* Silence compiler warnings about unused variables */
+  (void)pad;
+  (void)noData;
+
+  icntl = (nitf_ImageIO_12PixelComControl *) object;
+
+/* Compress block into buffer */
+
+  nitf_ImageIO_packB(data, icntl->buffer, icntl->blockPixelCount);
+
+  return nitf_ImageIO_packedComWrite(icntl, io, error);
+}
+
 NITF_BOOL nitf_ImageIO_12PixelComEnd
 ( nitf_CompressionControl * object,nitf_IOInterface* io, nitf_Error *error)
 {
@@ -64,6 +64,29 @@ NITFAPI(nitf_Uint8*) nitf_ImageReader_readBlock(nitf_ImageReader * imageReader,
                                         error);
 }
 
+NITFAPI(const nitf_Uint8*) nitf_ImageReader_getBlock(nitf_ImageReader * imageReader,
+                                                     nitf_Uint32 blockNumber,
+                                                     nitf_Uint64* blockSize,
+                                                     nitf_Error * error)
+{
+    if(!imageReader->directBlockRead)
+    {
+        if(!nitf_ImageIO_setupDirectBlockRead(imageReader->imageDeblocker,
+                                              imageReader->input,
+                                              1,
+                                              error))
+            return NULL;
+        
+        imageReader->directBlockRead = 1;
+    }
+
+    return nitf_ImageIO_getBlockDirect(imageReader->imageDeblocker,
+                                       imageReader->input,
+                                       blockNumber,
+                                       blockSize,
+                                       error);
+}
+
 NITFAPI(void) nitf_ImageReader_destruct(nitf_ImageReader ** imageReader)
 {
     if (*imageReader)
@@ -99,3 +122,32 @@ NITFPROT(void) nitf_ImageReader_setReadCaching(nitf_ImageReader * iReader)
     nitf_ImageIO_setReadCaching(iReader->imageDeblocker);
     return;
 }
+
+NITFAPI(void) nitf_ImageReader_setReadCacheSize(nitf_ImageReader * iReader,
+                                                nitf_Uint64 maxSize)
+{
+    nitf_ImageIO_setReadCacheSize(iReader->imageDeblocker, maxSize);
+    return;
+}
+
+NITFAPI(void) nitf_ImageReader_getReadCacheStats(nitf_ImageReader * iReader,
+                                                 nitf_Uint64 * hits,
+                                                 nitf_Uint64 * misses)
+{
+    nitf_ImageIO_getReadCacheStats(iReader->imageDeblocker, hits, misses);
+    return;
+}
+
+NITFAPI(void) nitf_ImageReader_setReadThreads(nitf_ImageReader * iReader,
+                                              nitf_Uint32 numThreads)
+{
+    nitf_ImageIO_setReadThreads(iReader->imageDeblocker, numThreads);
+    return;
+}
+
+NITFAPI(void) nitf_ImageReader_setScaledDecode(nitf_ImageReader * iReader,
+                                               NITF_BOOL enable)
+{
+    nitf_ImageIO_setScaledDecode(iReader->imageDeblocker, enable);
+    return;
+}
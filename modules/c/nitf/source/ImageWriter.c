@@ -37,9 +37,50 @@ typedef struct _ImageWriterImpl
     nitf_ImageSource *imageSource;
     nitf_ImageIO *imageBlocker;
     NRT_BOOL directBlockWrite;
+    nitf_Uint32 numRowsPerBlock;
+    nitf_Uint32 writeThreads;
+    nitf_Off dataLength;        /* Set by the caller, -1 if not set */
+    NRT_BOOL masked;            /* Block mask written after the data */
 
 } ImageWriterImpl;
 
+/*
+ *  Upper limit on the size of one strip of the write pipeline. Strips are
+ *  normally one row of blocks
+ */
+#define IMAGE_WRITER_MAX_STRIP_SIZE (16 * 1024 * 1024)
+
+/*
+ *  Number of strips in flight in the write pipeline, one per stage
+ */
+#define IMAGE_WRITER_NUM_STRIPS 3
+
+/*
+ *  One strip of rows, all bands, moving through the write pipeline
+ */
+typedef struct _ImageWriterStrip
+{
+    nitf_Uint8 **user;          /* Row buffers, one per band */
+    nitf_Uint32 numRows;        /* Number of rows in the strip */
+} ImageWriterStrip;
+
+/*
+ *  The work of one pipeline thread. The read stage fills the strip from
+ *  the band sources, the format stage formats the given rows of the strip
+ */
+typedef struct _ImageWriterTask
+{
+    ImageWriterImpl *impl;
+    ImageWriterStrip *strip;
+    nitf_Uint32 startRow;       /* First row of the strip to format */
+    nitf_Uint32 numRows;        /* Number of rows to format */
+    nitf_Uint8 **rows;          /* Band pointers to the first row to format */
+    nitf_Thread thread;
+    NITF_BOOL started;          /* Running on its own thread */
+    NITF_BOOL status;
+    nitf_Error error;
+} ImageWriterTask;
+
 
 
 NITFPRIV(void) ImageWriter_destruct(NITF_DATA * data)
@@ -57,6 +98,253 @@ NITFPRIV(void) ImageWriter_destruct(NITF_DATA * data)
 }
 
 
+NITFPRIV(NITF_DATA *) ImageWriter_readStrip(NITF_DATA * data)
+{
+    ImageWriterTask *task = (ImageWriterTask *) data;
+    ImageWriterImpl *impl = task->impl;
+    nitf_BandSource *bandSrc;
+    nitf_Uint32 numImageBands;
+    nitf_Uint32 band;
+    size_t stripSize;
+
+    numImageBands = impl->numImageBands + impl->numMultispectralImageBands;
+    stripSize = (size_t) task->strip->numRows * impl->numCols *
+        NITF_NBPP_TO_BYTES(impl->numBitsPerPixel);
+
+    task->status = NITF_SUCCESS;
+    for (band = 0; band < numImageBands; ++band)
+    {
+        bandSrc = nitf_ImageSource_getBand(impl->imageSource, band,
+                                           &task->error);
+        if (bandSrc == NULL ||
+            !(*(bandSrc->iface->read)) (bandSrc->data,
+                                        (char *) task->strip->user[band],
+                                        stripSize, &task->error))
+        {
+            task->status = NITF_FAILURE;
+            break;
+        }
+    }
+    return NULL;
+}
+
+
+NITFPRIV(NITF_DATA *) ImageWriter_formatStrip(NITF_DATA * data)
+{
+    ImageWriterTask *task = (ImageWriterTask *) data;
+    ImageWriterImpl *impl = task->impl;
+    nitf_Uint32 numImageBands;
+    nitf_Uint32 band;
+    size_t offset;
+
+    numImageBands = impl->numImageBands + impl->numMultispectralImageBands;
+    offset = (size_t) task->startRow * impl->numCols *
+        NITF_NBPP_TO_BYTES(impl->numBitsPerPixel);
+
+    for (band = 0; band < numImageBands; ++band)
+        task->rows[band] = task->strip->user[band] + offset;
+
+    nitf_ImageIO_formatRows(impl->imageBlocker, task->numRows, task->rows);
+    task->status = NITF_SUCCESS;
+    return NULL;
+}
+
+
+/*
+ *  Run a pipeline task on its own thread or, if a thread cannot be
+ *  created, on the calling thread
+ */
+NITFPRIV(void) ImageWriter_startTask(ImageWriterTask *task,
+                                     NITF_THREAD_RUN run)
+{
+    nitf_Error error;
+
+    task->started = nitf_Thread_create(&task->thread, run, task, &error);
+    if (!task->started)
+        (*run)(task);
+}
+
+
+/*
+ *  Wait for a pipeline task. The task's error is copied to error, if it
+ *  is not NULL
+ */
+NITFPRIV(NITF_BOOL) ImageWriter_finishTask(ImageWriterTask *task,
+                                           nitf_Error * error)
+{
+    if (task->started)
+    {
+        nitf_Thread_join(&task->thread);
+        task->started = 0;
+    }
+    if (!task->status)
+    {
+        if (error != NULL)
+            memcpy(error, &task->error, sizeof(nitf_Error));
+        return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+
+/*
+ *  Write the image through a three stage pipeline. While the calling thread
+ *  writes (and compresses) one strip, the next strip is formatted on the
+ *  format threads and the one after that is read from the band sources on
+ *  another thread. The stages run in lock step, a step ends when all three
+ *  are done with their strip
+ */
+NITFPRIV(NITF_BOOL) ImageWriter_writePipelined(ImageWriterImpl *impl,
+                                               nitf_IOInterface* output,
+                                               nitf_Error * error)
+{
+    ImageWriterStrip strips[IMAGE_WRITER_NUM_STRIPS];
+    ImageWriterTask *tasks = NULL;  /* The read task then the format tasks */
+    nitf_Uint32 numFormatTasks;
+    nitf_Uint32 numImageBands;
+    nitf_Uint32 stripRows, numStrips;
+    nitf_Uint32 step, i, band, rows, start;
+    size_t rowSize, stripSize;
+    NITF_BOOL rc = NITF_SUCCESS;
+
+    numImageBands = impl->numImageBands + impl->numMultispectralImageBands;
+    rowSize = (size_t) impl->numCols *
+        NITF_NBPP_TO_BYTES(impl->numBitsPerPixel);
+
+    /* Strips are a row of blocks, if that is not too large */
+    stripRows = impl->numRowsPerBlock;
+    if (stripRows == 0 || stripRows > impl->numRows)
+        stripRows = impl->numRows;
+    if ((nitf_Uint64) stripRows * rowSize * numImageBands >
+        IMAGE_WRITER_MAX_STRIP_SIZE)
+    {
+        stripRows = (nitf_Uint32) (IMAGE_WRITER_MAX_STRIP_SIZE /
+                                   (rowSize * numImageBands));
+        if (stripRows == 0)
+            stripRows = 1;
+    }
+    numStrips = (impl->numRows + stripRows - 1) / stripRows;
+    stripSize = stripRows * rowSize;
+
+    numFormatTasks = impl->writeThreads - 1;
+    if (numFormatTasks > stripRows)
+        numFormatTasks = stripRows;
+
+    memset(strips, 0, sizeof(strips));
+    tasks = (ImageWriterTask *) NITF_MALLOC(sizeof(ImageWriterTask) *
+                                            (numFormatTasks + 1));
+    if (!tasks)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+    memset(tasks, 0, sizeof(ImageWriterTask) * (numFormatTasks + 1));
+
+    for (i = 0; i < IMAGE_WRITER_NUM_STRIPS; ++i)
+    {
+        strips[i].user = (nitf_Uint8 **) NITF_MALLOC(sizeof(nitf_Uint8*) *
+                                                     numImageBands);
+        if (!strips[i].user)
+            goto MEMORY_ERROR;
+        memset(strips[i].user, 0, sizeof(nitf_Uint8*) * numImageBands);
+        for (band = 0; band < numImageBands; ++band)
+        {
+            strips[i].user[band] = (nitf_Uint8 *) NITF_MALLOC(stripSize);
+            if (!strips[i].user[band])
+                goto MEMORY_ERROR;
+        }
+    }
+    for (i = 0; i <= numFormatTasks; ++i)
+    {
+        tasks[i].impl = impl;
+        tasks[i].rows = (nitf_Uint8 **) NITF_MALLOC(sizeof(nitf_Uint8*) *
+                                                    numImageBands);
+        if (!tasks[i].rows)
+            goto MEMORY_ERROR;
+    }
+
+    /*
+     * At each step strip "step" is read, strip step - 1 is formatted and
+     * strip step - 2 is written
+     */
+    for (step = 0; step < numStrips + 2 && rc; ++step)
+    {
+        if (step < numStrips)
+        {
+            tasks[0].strip = &strips[step % IMAGE_WRITER_NUM_STRIPS];
+            tasks[0].strip->numRows = (step == numStrips - 1) ?
+                impl->numRows - step * stripRows : stripRows;
+            ImageWriter_startTask(&tasks[0], &ImageWriter_readStrip);
+        }
+
+        if (step >= 1 && step - 1 < numStrips)
+        {
+            ImageWriterStrip *strip =
+                &strips[(step - 1) % IMAGE_WRITER_NUM_STRIPS];
+
+            start = 0;
+            for (i = 1; i <= numFormatTasks; ++i)
+            {
+                rows = strip->numRows / numFormatTasks +
+                    ((i - 1) < strip->numRows % numFormatTasks ? 1 : 0);
+                tasks[i].strip = strip;
+                tasks[i].startRow = start;
+                tasks[i].numRows = rows;
+                start += rows;
+                ImageWriter_startTask(&tasks[i], &ImageWriter_formatStrip);
+            }
+        }
+
+        if (step >= 2)
+        {
+            ImageWriterStrip *strip =
+                &strips[(step - 2) % IMAGE_WRITER_NUM_STRIPS];
+
+            if (!nitf_ImageIO_writeFormattedRows(impl->imageBlocker, output,
+                                                 strip->numRows, strip->user,
+                                                 error))
+                rc = NITF_FAILURE;
+        }
+
+        /* Wait for the other stages, the first error is reported */
+        if (step < numStrips &&
+            !ImageWriter_finishTask(&tasks[0], rc ? error : NULL))
+            rc = NITF_FAILURE;
+
+        if (step >= 1 && step - 1 < numStrips)
+        {
+            for (i = 1; i <= numFormatTasks; ++i)
+                if (!ImageWriter_finishTask(&tasks[i], rc ? error : NULL))
+                    rc = NITF_FAILURE;
+        }
+    }
+    goto CLEANUP;
+
+MEMORY_ERROR:
+    nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                    NITF_ERR_MEMORY);
+    rc = NITF_FAILURE;
+
+CLEANUP:
+    for (i = 0; i < IMAGE_WRITER_NUM_STRIPS; ++i)
+    {
+        if (strips[i].user != NULL)
+        {
+            for (band = 0; band < numImageBands; ++band)
+                if (strips[i].user[band] != NULL)
+                    NITF_FREE(strips[i].user[band]);
+            NITF_FREE(strips[i].user);
+        }
+    }
+    for (i = 0; i <= numFormatTasks; ++i)
+        if (tasks[i].rows != NULL)
+            NITF_FREE(tasks[i].rows);
+    NITF_FREE(tasks);
+    return rc;
+}
+
+
 NITFPRIV(NITF_BOOL) ImageWriter_write(NITF_DATA * data,
                                       nitf_IOInterface* output, 
                                       nitf_Error * error)
@@ -84,6 +372,10 @@ NITFPRIV(NITF_BOOL) ImageWriter_write(NITF_DATA * data,
     if (!nitf_ImageIO_setFileOffset(impl->imageBlocker, offset, error))
         goto CATCH_ERROR;
 
+    /* An output that cannot seek must be written in order, a block at a time */
+    if (!nitf_IOInterface_canSeek(output, error))
+        nitf_ImageIO_setWriteCaching(impl->imageBlocker, 1);
+
     if (!nitf_ImageIO_writeSequential(impl->imageBlocker, output, error))
         goto CATCH_ERROR;
 
@@ -137,6 +429,11 @@ NITFPRIV(NITF_BOOL) ImageWriter_write(NITF_DATA * data,
                 goto CATCH_ERROR;
         }
     }
+    else if (impl->writeThreads > 1)
+    {
+        if (!ImageWriter_writePipelined(impl, output, error))
+            goto CATCH_ERROR;
+    }
     else
     {
         user = (nitf_Uint8 **) NITF_MALLOC(sizeof(nitf_Uint8*) * numImageBands);
@@ -198,6 +495,30 @@ CLEANUP:
     return rc;
 }
 
+NITFPRIV(nitf_Off) ImageWriter_getSize(NITF_DATA * data, nitf_Error * error)
+{
+    ImageWriterImpl *impl = (ImageWriterImpl *) data;
+    nitf_Off length = impl->dataLength;
+
+    /* The mask table goes in front of the blocks, but is only known after */
+    if (impl->masked)
+    {
+        nitf_Error_init(error,
+                "The length of a masked image is not known before the write",
+                NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        return -1;
+    }
+
+    if (length < 0)
+        length = nitf_ImageIO_getDataLength(impl->imageBlocker);
+    if (length < 0)
+        nitf_Error_init(error,
+                "The length of compressed image data is not known before "
+                "the write (see nitf_ImageWriter_setDataLength)",
+                NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+    return length;
+}
+
 NITFAPI(nitf_ImageWriter *) nitf_ImageWriter_construct(
     nitf_ImageSubheader *subheader, 
     nrt_HashTable* options, 
@@ -206,7 +527,8 @@ NITFAPI(nitf_ImageWriter *) nitf_ImageWriter_construct(
     static nitf_IWriteHandler iWriteHandler =
     {
         &ImageWriter_write,
-        &ImageWriter_destruct
+        &ImageWriter_destruct,
+        &ImageWriter_getSize
     };
 
     ImageWriterImpl *impl = NULL;
@@ -228,9 +550,14 @@ NITFAPI(nitf_ImageWriter *) nitf_ImageWriter_construct(
     NITF_TRY_GET_UINT32(subheader->numMultispectralImageBands, &impl->numMultispectralImageBands, error);
     NITF_TRY_GET_UINT32(subheader->numRows, &impl->numRows, error);
     NITF_TRY_GET_UINT32(subheader->numCols, &impl->numCols, error);
+    NITF_TRY_GET_UINT32(subheader->numPixelsPerVertBlock,
+                        &impl->numRowsPerBlock, error);
 
     impl->imageSource = NULL;
     impl->directBlockWrite = 0;
+    impl->writeThreads = 1;
+    impl->dataLength = -1;
+    impl->masked = 0;
     
 
     /* Check for compression and get compression interface */
@@ -239,6 +566,8 @@ NITFAPI(nitf_ImageWriter *) nitf_ImageWriter_construct(
     nitf_Field_get(subheader->NITF_IC,
             compBuf, NITF_CONV_STRING, NITF_IC_SZ + 1, error);
 
+    impl->masked = compBuf[0] == 'M' || memcmp(compBuf, "NM", 2) == 0;
+
     if(memcmp(compBuf, "NC", 2) != 0 && memcmp(compBuf, "NM", 2) != 0)
     {
         /* get the compression interface */
@@ -310,6 +639,22 @@ NITFAPI(void) nitf_ImageWriter_setDirectBlockWrite(nitf_ImageWriter *imageWriter
     impl->directBlockWrite = enable;
 }
 
+NITFAPI(void) nitf_ImageWriter_setWriteThreads(nitf_ImageWriter *imageWriter,
+        nitf_Uint32 numThreads)
+{
+    ImageWriterImpl *impl = (ImageWriterImpl*)imageWriter->data;
+    if (numThreads == 0)
+        numThreads = nitf_Thread_getNumCPUs();
+    impl->writeThreads = numThreads;
+}
+
+NITFAPI(void) nitf_ImageWriter_setDataLength(nitf_ImageWriter *imageWriter,
+        nitf_Off length)
+{
+    ImageWriterImpl *impl = (ImageWriterImpl*)imageWriter->data;
+    impl->dataLength = length;
+}
+
 NITFAPI(NITF_BOOL) nitf_ImageWriter_setPadPixel(nitf_ImageWriter* imageWriter,
                                                 nitf_Uint8* value,
                                                 nitf_Uint32 length,
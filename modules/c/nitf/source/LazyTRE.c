@@ -0,0 +1,296 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; if not, If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nitf/LazyTRE.h"
+#include "nitf/DefaultTRE.h"
+
+/*  The private data of a TRE whose parse is deferred  */
+typedef struct _nitf_LazyTREData
+{
+    nitf_TREHandler *handler;       /* The handler to parse with */
+    char *data;                     /* The raw TRE data */
+    nitf_Uint32 length;             /* The length of the data */
+    struct _nitf_Record *record;    /* The record, for the handler */
+} nitf_LazyTREData;
+
+
+NITFPRIV(void) lazyFreeData(nitf_LazyTREData * lazy)
+{
+    if (lazy)
+    {
+        if (lazy->data)
+            NITF_FREE(lazy->data);
+        NITF_FREE(lazy);
+    }
+}
+
+
+NITFAPI(NITF_BOOL) nitf_LazyTRE_realize(nitf_TRE * tre, nitf_Error * error)
+{
+    nitf_LazyTREData *lazy = NULL;
+    nitf_IOInterface *io = NULL;
+    NITF_BOOL ok = NITF_FAILURE;
+
+    if (!tre || tre->handler != nitf_LazyTRE_handler(error))
+        return NITF_SUCCESS;
+
+    lazy = (nitf_LazyTREData *) tre->priv;
+    io = nitf_BufferAdapter_construct(lazy->data, lazy->length, 0, error);
+    if (!io)
+        return NITF_FAILURE;
+
+    /*  The same fall back to the default handler as the reader  */
+    tre->priv = NULL;
+    if (lazy->handler)
+    {
+        tre->handler = lazy->handler;
+        ok = tre->handler->read(io, lazy->length, tre, lazy->record, error);
+        if (!ok)
+            nitf_IOInterface_seek(io, 0, NITF_SEEK_SET, error);
+    }
+    if (!ok)
+    {
+        tre->handler = nitf_DefaultTRE_handler(error);
+        ok = tre->handler->read(io, lazy->length, tre, lazy->record, error);
+    }
+    nitf_IOInterface_destruct(&io);
+
+    if (!ok)
+    {
+        /*  Leave it deferred  */
+        tre->handler = nitf_LazyTRE_handler(error);
+        tre->priv = lazy;
+        return NITF_FAILURE;
+    }
+
+    lazyFreeData(lazy);
+    return NITF_SUCCESS;
+}
+
+
+NITFPROT(NITF_BOOL) nitf_LazyTRE_defer(nitf_TRE * tre,
+                                       nitf_TREHandler * handler,
+                                       nitf_IOInterface * io,
+                                       nitf_Uint32 length,
+                                       struct _nitf_Record * record,
+                                       nitf_Error * error)
+{
+    nitf_LazyTREData *lazy =
+        (nitf_LazyTREData *) NITF_MALLOC(sizeof(nitf_LazyTREData));
+    if (!lazy)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+
+    lazy->handler = handler;
+    lazy->length = length;
+    lazy->record = record;
+    lazy->data = (char *) NITF_MALLOC(length ? length : 1);
+    if (!lazy->data)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        lazyFreeData(lazy);
+        return NITF_FAILURE;
+    }
+
+    if (length > 0 && !nitf_IOInterface_read(io, lazy->data, length, error))
+    {
+        lazyFreeData(lazy);
+        return NITF_FAILURE;
+    }
+
+    tre->handler = nitf_LazyTRE_handler(error);
+    tre->priv = lazy;
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(NITF_BOOL) lazyInit(nitf_TRE * tre, const char *id,
+                             nitf_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)tre;
+    (void)id;
+
+    nitf_Error_init(error, "Lazy TREs are only created by the reader",
+                    NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+    return NITF_FAILURE;
+}
+
+
+NITFPRIV(const char*) lazyGetID(nitf_TRE * tre)
+{
+    nitf_Error error;
+    if (!nitf_LazyTRE_realize(tre, &error))
+        return NULL;
+    return tre->handler->getID(tre);
+}
+
+
+NITFPRIV(NITF_BOOL) lazyRead(nitf_IOInterface * io,
+                             nitf_Uint32 length,
+                             nitf_TRE * tre,
+                             struct _nitf_Record * record,
+                             nitf_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)io;
+    (void)length;
+    (void)tre;
+    (void)record;
+
+    nitf_Error_init(error, "Lazy TREs are only read by the reader",
+                    NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+    return NITF_FAILURE;
+}
+
+
+NITFPRIV(NITF_BOOL) lazySetField(nitf_TRE * tre,
+                                 const char *tag,
+                                 NITF_DATA * data,
+                                 size_t dataLength,
+                                 nitf_Error * error)
+{
+    if (!nitf_LazyTRE_realize(tre, error))
+        return NITF_FAILURE;
+    return tre->handler->setField(tre, tag, data, dataLength, error);
+}
+
+
+NITFPRIV(nitf_Field*) lazyGetField(nitf_TRE * tre, const char *tag)
+{
+    nitf_Error error;
+    if (!nitf_LazyTRE_realize(tre, &error))
+        return NULL;
+    return tre->handler->getField(tre, tag);
+}
+
+
+NITFPRIV(nitf_List*) lazyFind(nitf_TRE * tre,
+                              const char *pattern,
+                              nitf_Error * error)
+{
+    if (!nitf_LazyTRE_realize(tre, error))
+        return NULL;
+    return tre->handler->find(tre, pattern, error);
+}
+
+
+NITFPRIV(NITF_BOOL) lazyWrite(nitf_IOInterface * io,
+                              nitf_TRE * tre,
+                              struct _nitf_Record * record,
+                              nitf_Error * error)
+{
+    if (!nitf_LazyTRE_realize(tre, error))
+        return NITF_FAILURE;
+    return tre->handler->write(io, tre, record, error);
+}
+
+
+NITFPRIV(nitf_TREEnumerator*) lazyBegin(nitf_TRE * tre, nitf_Error * error)
+{
+    if (!nitf_LazyTRE_realize(tre, error))
+        return NULL;
+    return tre->handler->begin(tre, error);
+}
+
+
+NITFPRIV(int) lazyGetCurrentSize(nitf_TRE * tre, nitf_Error * error)
+{
+    if (!nitf_LazyTRE_realize(tre, error))
+        return -1;
+    return tre->handler->getCurrentSize(tre, error);
+}
+
+
+NITFPRIV(NITF_BOOL) lazyClone(nitf_TRE * source,
+                              nitf_TRE * tre,
+                              nitf_Error * error)
+{
+    nitf_LazyTREData *sourceData = (nitf_LazyTREData *) source->priv;
+    nitf_LazyTREData *lazy = NULL;
+
+    tre->priv = NULL;
+    if (!sourceData)
+        return NITF_SUCCESS;
+
+    /*  The clone is deferred too  */
+    lazy = (nitf_LazyTREData *) NITF_MALLOC(sizeof(nitf_LazyTREData));
+    if (!lazy)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+
+    memcpy(lazy, sourceData, sizeof(nitf_LazyTREData));
+    lazy->data = (char *) NITF_MALLOC(lazy->length ? lazy->length : 1);
+    if (!lazy->data)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        NITF_FREE(lazy);
+        return NITF_FAILURE;
+    }
+    memcpy(lazy->data, sourceData->data, lazy->length);
+
+    tre->priv = lazy;
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(void) lazyDestruct(nitf_TRE * tre)
+{
+    if (tre && tre->priv)
+    {
+        lazyFreeData((nitf_LazyTREData *) tre->priv);
+        tre->priv = NULL;
+    }
+}
+
+
+NITFAPI(nitf_TREHandler*) nitf_LazyTRE_handler(nitf_Error * error)
+{
+    static nitf_TREHandler handler =
+    {
+        lazyInit,
+        lazyGetID,
+        lazyRead,
+        lazySetField,
+        lazyGetField,
+        lazyFind,
+        lazyWrite,
+        lazyBegin,
+        lazyGetCurrentSize,
+        lazyClone,
+        lazyDestruct,
+        NULL    /* data - We don't need this! */
+    };
+
+    /* Silence compiler warnings about unused variables */
+    (void)error;
+
+    return &handler;
+}
@@ -0,0 +1,519 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ *    Implementation of the overview (R-set) functions and band source
+ */
+
+#include "nitf/Overview.h"
+
+/* Largest reduction factor that fits in the IMAG field ("/999") */
+#define OVERVIEW_MAX_FACTOR 999
+
+/*   The instance data for the overview source object */
+
+typedef struct _OverviewSourceImpl
+{
+    nitf_BandSource *base;          /* Source of the base band */
+    nitf_DownSampler *downSampler;  /* The reduction method */
+    nitf_Uint32 pixelType;          /* Down-sampler pixel type */
+    nitf_Uint32 pixelSize;          /* Bytes per pixel */
+    nitf_Uint32 factor;             /* The reduction factor */
+    nitf_Uint32 baseRows;           /* Number of base rows */
+    nitf_Uint32 baseCols;           /* Number of base columns */
+    nitf_Uint32 numRows;            /* Number of overview rows */
+    nitf_Uint32 numCols;            /* Number of overview columns */
+    nitf_Uint32 rowsRead;           /* Base rows read so far */
+
+    nitf_Uint8 *strip;              /* One row of windows of the base */
+    nitf_Uint8 *rowBuffer;          /* One overview row */
+    nitf_Uint8 *nextPtr;            /* Points to next byte to be transfered */
+    nitf_Uint64 bytesLeft;          /* Bytes left in the row buffer */
+}
+OverviewSourceImpl;
+
+/*
+ *  Get the image segment at the given index, with an error if there is
+ *  no such segment
+ */
+NITFPRIV(nitf_ImageSegment *) getImageSegment(nitf_Record * record,
+                                              nitf_Uint32 index,
+                                              nitf_Error * error)
+{
+    if (index >= nitf_List_size(record->images))
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                         "Invalid image segment index %d", index);
+        return NULL;
+    }
+    return (nitf_ImageSegment *) nitf_List_get(record->images, (int) index,
+                                               error);
+}
+
+/*
+ *  Get the reduction factor of an overview from its magnification,
+ *  zero if it is not of the form "/N"
+ */
+NITFPRIV(NITF_BOOL) getFactor(nitf_ImageSubheader * subhdr,
+                              nitf_Uint32 * factor, nitf_Error * error)
+{
+    char imag[NITF_IMAG_SZ + 1];
+    nitf_Uint32 value = 0;
+    char *ptr;
+
+    if (!nitf_Field_get(subhdr->NITF_IMAG, imag, NITF_CONV_STRING,
+                        NITF_IMAG_SZ + 1, error))
+        return NITF_FAILURE;
+
+    *factor = 0;
+    if (imag[0] != '/' || !isdigit((unsigned char) imag[1]))
+        return NITF_SUCCESS;
+
+    for (ptr = imag + 1; isdigit((unsigned char) *ptr); ++ptr)
+        value = value * 10 + (*ptr - '0');
+    while (*ptr == ' ')
+        ++ptr;
+    if (*ptr == 0 && value > 1)
+        *factor = value;
+    return NITF_SUCCESS;
+}
+
+/*
+ *  Get the largest display level of the image and graphic segments, which
+ *  must be unique within a file
+ */
+NITFPRIV(NITF_BOOL) getMaxDisplayLevel(nitf_Record * record,
+                                       nitf_Uint32 * maxLevel,
+                                       nitf_Error * error)
+{
+    nitf_ListIterator iter;
+    nitf_ListIterator end;
+    nitf_Uint32 level;
+
+    *maxLevel = 0;
+
+    iter = nitf_List_begin(record->images);
+    end = nitf_List_end(record->images);
+    while (nitf_ListIterator_notEqualTo(&iter, &end))
+    {
+        nitf_ImageSegment *segment =
+            (nitf_ImageSegment *) nitf_ListIterator_get(&iter);
+        NITF_TRY_GET_UINT32(segment->subheader->NITF_IDLVL, &level, error);
+        if (level > *maxLevel)
+            *maxLevel = level;
+        nitf_ListIterator_increment(&iter);
+    }
+
+    iter = nitf_List_begin(record->graphics);
+    end = nitf_List_end(record->graphics);
+    while (nitf_ListIterator_notEqualTo(&iter, &end))
+    {
+        nitf_GraphicSegment *segment =
+            (nitf_GraphicSegment *) nitf_ListIterator_get(&iter);
+        NITF_TRY_GET_UINT32(segment->subheader->NITF_SDLVL, &level, error);
+        if (level > *maxLevel)
+            *maxLevel = level;
+        nitf_ListIterator_increment(&iter);
+    }
+    return NITF_SUCCESS;
+
+CATCH_ERROR:
+    return NITF_FAILURE;
+}
+
+/*
+ *  Block dimension of an overview, the base block dimension unless it is
+ *  larger than the overview (or the base is a single 2500C block)
+ */
+NITFPRIV(nitf_Uint32) overviewBlockSize(nitf_Uint32 baseBlockSize,
+                                        nitf_Uint32 size)
+{
+    return (baseBlockSize == 0 || baseBlockSize > size) ?
+        size : baseBlockSize;
+}
+
+NITFAPI(nitf_ImageSegment *) nitf_Overview_newSegment(nitf_Record * record,
+                                                      nitf_Uint32 imageIndex,
+                                                      nitf_Uint32 factor,
+                                                      nitf_Error * error)
+{
+    nitf_ImageSegment *base;
+    nitf_ImageSegment *segment;
+    nitf_ImageSubheader *subhdr;
+    nitf_Uint32 numRows, numCols;
+    nitf_Uint32 numRowsPerBlock, numColsPerBlock;
+    nitf_Uint32 numBlocksPerRow, numBlocksPerCol;
+    nitf_Uint32 baseLevel, maxLevel;
+    char imode[NITF_IMODE_SZ + 1];
+    char imag[NITF_IMAG_SZ + 1];
+
+    if (factor < 2 || factor > OVERVIEW_MAX_FACTOR)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                         "Invalid overview factor %d", factor);
+        return NULL;
+    }
+
+    base = getImageSegment(record, imageIndex, error);
+    if (!base)
+        return NULL;
+
+    if (!nitf_ImageSubheader_getBlocking(base->subheader, &numRows, &numCols,
+                                         &numRowsPerBlock, &numColsPerBlock,
+                                         &numBlocksPerRow, &numBlocksPerCol,
+                                         imode, error))
+        return NULL;
+    if (numRows == 0 || numCols == 0)
+    {
+        nitf_Error_init(error, "Base image dimensions are not set",
+                        NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        return NULL;
+    }
+
+    if (!nitf_Field_get(base->subheader->NITF_IDLVL, &baseLevel,
+                        NITF_CONV_UINT, NITF_INT32_SZ, error))
+        return NULL;
+    if (!getMaxDisplayLevel(record, &maxLevel, error))
+        return NULL;
+
+    subhdr = nitf_ImageSubheader_clone(base->subheader, error);
+    if (!subhdr)
+        return NULL;
+
+    /* The TREs describe the base image */
+    nitf_Extensions_destruct(&subhdr->userDefinedSection);
+    nitf_Extensions_destruct(&subhdr->extendedSection);
+    subhdr->userDefinedSection = nitf_Extensions_construct(error);
+    subhdr->extendedSection = nitf_Extensions_construct(error);
+    if (!subhdr->userDefinedSection || !subhdr->extendedSection)
+        goto CATCH_ERROR;
+
+    numRows = (numRows + factor - 1) / factor;
+    numCols = (numCols + factor - 1) / factor;
+    if (!nitf_ImageSubheader_setBlocking(subhdr, numRows, numCols,
+            overviewBlockSize(numRowsPerBlock, numRows),
+            overviewBlockSize(numColsPerBlock, numCols), imode, error))
+        goto CATCH_ERROR;
+
+    NITF_SNPRINTF(imag, sizeof(imag), "/%d", factor);
+    if (!nitf_Field_setString(subhdr->NITF_IMAG, imag, error)
+        || !nitf_Field_setUint32(subhdr->NITF_IALVL, baseLevel, error)
+        || !nitf_Field_setUint32(subhdr->NITF_IDLVL, maxLevel + 1, error)
+        || !nitf_Field_setString(subhdr->NITF_ILOC, "0000000000", error)
+        || !nitf_ImageSubheader_setCompression(subhdr, "NC", "", error))
+        goto CATCH_ERROR;
+
+    segment = nitf_Record_newImageSegment(record, error);
+    if (!segment)
+        goto CATCH_ERROR;
+
+    nitf_ImageSubheader_destruct(&segment->subheader);
+    segment->subheader = subhdr;
+    return segment;
+
+CATCH_ERROR:
+    nitf_ImageSubheader_destruct(&subhdr);
+    return NULL;
+}
+
+/*
+ *  Read and reduce the next row of windows of the base band
+ */
+NITFPRIV(NITF_BOOL) OverviewSource_nextRow(OverviewSourceImpl * impl,
+                                           nitf_Error * error)
+{
+    nitf_Uint32 rowsInStrip;
+    NITF_DATA *input[1];
+    NITF_DATA *output[1];
+
+    if (impl->rowsRead >= impl->baseRows)
+    {
+        nitf_Error_init(error, "Attempt to read past the end of the overview",
+                        NITF_CTXT, NITF_ERR_READING_FROM_FILE);
+        return NITF_FAILURE;
+    }
+
+    rowsInStrip = impl->baseRows - impl->rowsRead;
+    if (rowsInStrip > impl->factor)
+        rowsInStrip = impl->factor;
+
+    if (!impl->base->iface->read(impl->base->data, impl->strip,
+                                 (nitf_Off) rowsInStrip * impl->baseCols
+                                 * impl->pixelSize, error))
+        return NITF_FAILURE;
+    impl->rowsRead += rowsInStrip;
+
+    input[0] = impl->strip;
+    output[0] = impl->rowBuffer;
+    return nitf_DownSampler_apply(impl->downSampler, input, output, 1, 1,
+                                  impl->numCols, impl->baseCols,
+                                  impl->numCols, impl->pixelType,
+                                  impl->pixelSize, rowsInStrip,
+                                  impl->baseCols
+                                  - (impl->numCols - 1) * impl->factor,
+                                  error);
+}
+
+/*
+ *     OverviewSource_read - Read data function for overview source
+ */
+NITFPRIV(NITF_BOOL) OverviewSource_read(NITF_DATA * data, void *buf,
+                                        nitf_Off size, nitf_Error * error)
+{
+    OverviewSourceImpl *impl = (OverviewSourceImpl *) data;
+    nitf_Uint64 xfrCount;       /* Transfer count */
+    nitf_Uint64 remainder;      /* Amount left to transfer */
+    nitf_Uint8 *bufPtr;         /* Current location in output buffer */
+
+    remainder = size;
+    bufPtr = (nitf_Uint8 *) buf;
+    while (remainder > 0)
+    {
+        if (impl->bytesLeft == 0)       /* Need more data */
+        {
+            if (!OverviewSource_nextRow(impl, error))
+                return NITF_FAILURE;
+            impl->bytesLeft = (nitf_Uint64) impl->numCols * impl->pixelSize;
+            impl->nextPtr = impl->rowBuffer;
+        }
+
+        xfrCount =
+            (remainder <= impl->bytesLeft) ? remainder : impl->bytesLeft;
+        memcpy(bufPtr, impl->nextPtr, (size_t) xfrCount);
+
+        impl->nextPtr += xfrCount;
+        bufPtr += xfrCount;
+        impl->bytesLeft -= xfrCount;
+        remainder -= xfrCount;
+    }
+
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(void) OverviewSource_destruct(NITF_DATA * data)
+{
+    OverviewSourceImpl *impl = (OverviewSourceImpl *) data;
+    if (impl)
+    {
+        if (impl->base)
+            nitf_BandSource_destruct(&impl->base);
+        if (impl->strip)
+            NITF_FREE(impl->strip);
+        if (impl->rowBuffer)
+            NITF_FREE(impl->rowBuffer);
+        NITF_FREE(impl);
+    }
+}
+
+NITFPRIV(nitf_Off) OverviewSource_getSize(NITF_DATA * data, nitf_Error * e)
+{
+    OverviewSourceImpl *impl = (OverviewSourceImpl *) data;
+    return (nitf_Off) impl->numRows * impl->numCols * impl->pixelSize;
+}
+
+NITFPRIV(NITF_BOOL) OverviewSource_setSize(NITF_DATA * data, nitf_Off size,
+                                           nitf_Error * e)
+{
+    return NITF_SUCCESS;
+}
+
+/*   BandSource interface structure, static is ok since this is read-only */
+
+static nitf_IDataSource iOverviewSource =
+    {
+        OverviewSource_read,
+        OverviewSource_destruct,
+        OverviewSource_getSize,
+        OverviewSource_setSize
+    };
+
+NITFAPI(nitf_BandSource *) nitf_OverviewSource_construct(
+        nitf_BandSource * baseSource,
+        nitf_ImageSubheader * baseSubheader,
+        nitf_DownSampler * downSampler,
+        nitf_Error * error)
+{
+    nitf_BandSource *source;
+    OverviewSourceImpl *impl;
+    char pvtype[NITF_PVTYPE_SZ + 1];
+    nitf_Uint32 nbpp;
+
+    if (!baseSource || !downSampler)
+    {
+        nitf_Error_init(error, "Null pointer reference",
+                        NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        return NULL;
+    }
+    if (downSampler->rowSkip != downSampler->colSkip
+        || downSampler->rowSkip < 2 || downSampler->multiBand)
+    {
+        nitf_Error_init(error,
+                        "Overview down-samplers must be single band, "
+                        "with equal row and column skips",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+        return NULL;
+    }
+
+    impl = (OverviewSourceImpl *) NITF_MALLOC(sizeof(OverviewSourceImpl));
+    if (impl == NULL)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NULL;
+    }
+    memset(impl, 0, sizeof(OverviewSourceImpl));
+    impl->downSampler = downSampler;
+    impl->factor = downSampler->rowSkip;
+
+    if (!nitf_ImageSubheader_getDimensions(baseSubheader, &impl->baseRows,
+                                           &impl->baseCols, error)
+        || !nitf_Field_get(baseSubheader->NITF_PVTYPE, pvtype,
+                           NITF_CONV_STRING, NITF_PVTYPE_SZ + 1, error)
+        || !nitf_Field_get(baseSubheader->NITF_NBPP, &nbpp,
+                           NITF_CONV_UINT, NITF_INT32_SZ, error))
+        goto CATCH_ERROR;
+
+    if (strncmp(pvtype, "INT", 3) == 0)
+        impl->pixelType = NITF_PIXEL_TYPE_INT;
+    else if (pvtype[0] == 'B')
+        impl->pixelType = NITF_PIXEL_TYPE_B;
+    else if (pvtype[0] == 'S' && pvtype[1] == 'I')
+        impl->pixelType = NITF_PIXEL_TYPE_SI;
+    else if (pvtype[0] == 'R')
+        impl->pixelType = NITF_PIXEL_TYPE_R;
+    else if (pvtype[0] == 'C')
+        impl->pixelType = NITF_PIXEL_TYPE_C;
+    else
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                         "Invalid pixel type %s", pvtype);
+        goto CATCH_ERROR;
+    }
+    impl->pixelSize = NITF_NBPP_TO_BYTES(nbpp);
+
+    if (impl->baseRows == 0 || impl->baseCols == 0)
+    {
+        nitf_Error_init(error, "Base image dimensions are not set",
+                        NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        goto CATCH_ERROR;
+    }
+    impl->numRows = (impl->baseRows + impl->factor - 1) / impl->factor;
+    impl->numCols = (impl->baseCols + impl->factor - 1) / impl->factor;
+
+    impl->strip = (nitf_Uint8 *) NITF_MALLOC((size_t) impl->factor
+                                             * impl->baseCols
+                                             * impl->pixelSize);
+    impl->rowBuffer = (nitf_Uint8 *) NITF_MALLOC((size_t) impl->numCols
+                                                 * impl->pixelSize);
+    if (!impl->strip || !impl->rowBuffer)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    impl->nextPtr = impl->rowBuffer;
+    impl->bytesLeft = 0;
+
+    source = (nitf_BandSource *) NITF_MALLOC(sizeof(nitf_BandSource));
+    if (source == NULL)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+
+    /* The base source is only owned on success */
+    impl->base = baseSource;
+    source->data = impl;
+    source->iface = &iOverviewSource;
+    return source;
+
+CATCH_ERROR:
+    OverviewSource_destruct(impl);
+    return NULL;
+}
+
+NITFAPI(NITF_BOOL) nitf_Overview_select(nitf_Record * record,
+                                        nitf_Uint32 imageIndex,
+                                        nitf_Uint32 factor,
+                                        nitf_Uint32 * overviewIndex,
+                                        nitf_Uint32 * overviewFactor,
+                                        nitf_Error * error)
+{
+    nitf_ImageSegment *base;
+    nitf_ListIterator iter;
+    nitf_ListIterator end;
+    nitf_Uint32 baseLevel, baseRows, baseCols;
+    nitf_Uint32 index;
+
+    base = getImageSegment(record, imageIndex, error);
+    if (!base)
+        return NITF_FAILURE;
+
+    *overviewIndex = imageIndex;
+    *overviewFactor = 1;
+
+    NITF_TRY_GET_UINT32(base->subheader->NITF_IDLVL, &baseLevel, error);
+    if (!nitf_ImageSubheader_getDimensions(base->subheader, &baseRows,
+                                           &baseCols, error))
+        return NITF_FAILURE;
+
+    iter = nitf_List_begin(record->images);
+    end = nitf_List_end(record->images);
+    for (index = 0; nitf_ListIterator_notEqualTo(&iter, &end);
+         ++index, nitf_ListIterator_increment(&iter))
+    {
+        nitf_ImageSubheader *subhdr =
+            ((nitf_ImageSegment *) nitf_ListIterator_get(&iter))->subheader;
+        nitf_Uint32 level, numRows, numCols, levelFactor;
+
+        if (index == imageIndex)
+            continue;
+
+        NITF_TRY_GET_UINT32(subhdr->NITF_IALVL, &level, error);
+        if (level != baseLevel)
+            continue;
+
+        if (!getFactor(subhdr, &levelFactor, error))
+            return NITF_FAILURE;
+        if (levelFactor == 0 || levelFactor > factor
+            || levelFactor <= *overviewFactor)
+            continue;
+
+        /* The overview must cover the base image (allow for rounding) */
+        if (!nitf_ImageSubheader_getDimensions(subhdr, &numRows, &numCols,
+                                               error))
+            return NITF_FAILURE;
+        if (numRows < baseRows / levelFactor
+            || numRows > (baseRows + levelFactor - 1) / levelFactor
+            || numCols < baseCols / levelFactor
+            || numCols > (baseCols + levelFactor - 1) / levelFactor)
+            continue;
+
+        *overviewIndex = index;
+        *overviewFactor = levelFactor;
+    }
+    return NITF_SUCCESS;
+
+CATCH_ERROR:
+    return NITF_FAILURE;
+}
@@ -20,7 +20,45 @@
  *
  */
 
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef WIN32
+#   include <process.h>
+#   define getpid _getpid
+#else
+#   include <unistd.h>
+#endif
+
 #include "nitf/PluginRegistry.h"
+#include "nitf/TREPlan.h"
+
+/*
+ *  The manifest is a text file.  After the header, each DSO is listed
+ *  on a line "PLUGIN <size> <mtime> <name>", followed by a line
+ *  "<key> <identifier>" for each identifier it handles (the fields are
+ *  separated by tabs).  The list ends with an END line, so that a
+ *  partly written file is never used.
+ */
+#define MANIFEST_HEADER "NITF_PLUGIN_MANIFEST\t1"
+#define MANIFEST_PLUGIN "PLUGIN\t"
+#define MANIFEST_END    "END"
+#define MANIFEST_LINE   (NITF_MAX_PATH + 64)
+
+/*
+ *  A DSO named by a manifest.  It is loaded the first time one of its
+ *  handlers is retrieved, and only that time, even if it fails.  While
+ *  one thread loads it, others that want it wait for pluginLoaded.
+ */
+#define MANIFEST_UNTRIED 0
+#define MANIFEST_LOADING 1
+#define MANIFEST_TRIED   2
+
+typedef struct _ManifestPlugin
+{
+    char *path;
+    int state;
+}
+ManifestPlugin;
 
 NITFPRIV(nitf_PluginRegistry *) implicitConstruct(nitf_Error * error);
 NITFPRIV(void) implicitDestruct(nitf_PluginRegistry ** reg);
@@ -125,9 +163,43 @@ NITFPROT(nitf_PluginRegistry *)
     return theInstance;
 }
 
+/*
+ *  Map a plugin key to the character that prefixes its identifiers in
+ *  the manifest handler table, or 0 if the key is not supported
+ */
+NITFPRIV(char) pluginKind(const char *key)
+{
+    if (strcmp(key, NITF_PLUGIN_TRE_KEY) == 0)
+        return 'T';
+    if (strcmp(key, NITF_PLUGIN_COMPRESSION_KEY) == 0)
+        return 'C';
+    if (strcmp(key, NITF_PLUGIN_DECOMPRESSION_KEY) == 0)
+        return 'D';
+    return 0;
+}
+
+/*
+ *  A manifest DSO provides an identifier unless the manifest gave it
+ *  to a DSO that came earlier in the directory (the first one wins,
+ *  as when all of them are loaded up front)
+ */
+NITFPRIV(NITF_BOOL) ownsHandler(nitf_PluginRegistry * reg,
+                                ManifestPlugin * owner,
+                                const char *key,
+                                const char *ident)
+{
+    char name[NITF_MAX_PATH];
+    nitf_Pair *pair;
+
+    NITF_SNPRINTF(name, NITF_MAX_PATH, "%c%s", pluginKind(key), ident);
+    pair = nitf_HashTable_find(reg->manifestHandlers, name);
+    return !pair || pair->data == (NITF_DATA *) owner;
+}
+
 NITFPRIV(NITF_BOOL) insertPlugin(nitf_PluginRegistry * reg,
                                  const char **ident,
                                  nitf_DLL * dll, 
+                                 ManifestPlugin * owner,
                                  nitf_Error * error)
 {
     nitf_HashTable *hash = NULL;
@@ -174,6 +246,9 @@ NITFPRIV(NITF_BOOL) insertPlugin(nitf_PluginRegistry * reg,
             break;
 
         /* no more */
+        if (owner && !ownsHandler(reg, owner, ident[0], key))
+            continue;
+
         ok = insertCreator(dll, hash, key, suffix, error);
         if (!ok)
         {
@@ -208,6 +283,9 @@ NITFPRIV(nitf_PluginRegistry *) implicitConstruct(nitf_Error * error)
     reg->treHandlers = NULL;
     reg->decompressionHandlers = NULL;
     reg->dsos = NULL;
+    reg->manifestHandlers = NULL;
+    reg->manifestPlugins = NULL;
+    nitf_Condition_init(&reg->pluginLoaded);
 
     reg->dsos = nitf_List_construct(error);
     if (!reg->dsos)
@@ -258,6 +336,17 @@ NITFPRIV(nitf_PluginRegistry *) implicitConstruct(nitf_Error * error)
     nitf_HashTable_setPolicy(reg->decompressionHandlers, 
                              NITF_DATA_RETAIN_OWNER);
 
+    /* the manifest plugins are owned by their list */
+    reg->manifestPlugins = nitf_List_construct(error);
+    reg->manifestHandlers =
+        nitf_HashTable_construct(NITF_TRE_HASH_SIZE, error);
+    if (!reg->manifestPlugins || !reg->manifestHandlers)
+    {
+        implicitDestruct(&reg);
+        return NULL;
+    }
+    nitf_HashTable_setPolicy(reg->manifestHandlers, NITF_DATA_RETAIN_OWNER);
+
     /*  Start with a clean slate  */
     memset(reg->path, 0, NITF_MAX_PATH);
 
@@ -307,7 +396,11 @@ NITFPRIV(void) exitListener(void)
     nitf_PluginRegistry *single = nitf_PluginRegistry_getInstance(&error);
     if (single)
     {
-        int unloadRet = nitf_PluginRegistry_unload(single, &error);
+        int unloadRet;
+
+        /* the plans point into the descriptions of the plugins */
+        nitf_TREPlan_cleanup();
+        unloadRet = nitf_PluginRegistry_unload(single, &error);
         if (unloadRet)
         {
             implicitDestruct(&single);
@@ -331,6 +424,11 @@ NITFPRIV(void) implicitDestruct(nitf_PluginRegistry ** reg)
             nitf_HashTable_destruct(&(*reg)->compressionHandlers);
         if ((*reg)->decompressionHandlers)
             nitf_HashTable_destruct(&(*reg)->decompressionHandlers);
+        if ((*reg)->manifestHandlers)
+            nitf_HashTable_destruct(&(*reg)->manifestHandlers);
+        if ((*reg)->manifestPlugins)
+            nitf_List_destruct(&(*reg)->manifestPlugins);
+        nitf_Condition_delete(&(*reg)->pluginLoaded);
         NITF_FREE(*reg);
         *reg = NULL;
     }
@@ -455,22 +553,27 @@ NITFPROT(NITF_BOOL) nitf_PluginRegistry_unload(nitf_PluginRegistry * reg,
 }
 
 
-NITFAPI(NITF_BOOL)
-    nitf_PluginRegistry_loadPlugin(const char* fullName, nitf_Error * error)
+/*
+ *  Load and init a DSO, without touching the registry.  Returns the
+ *  identity of the DSO, or NULL on failure.  The DSO is given back if
+ *  it loaded, even if its init failed.
+ */
+NITFPRIV(const char **) openPluginFile(const char *fullName,
+                                       nitf_DLL ** dllOut,
+                                       nitf_Error * error)
 {
     
     /*  For now, the key is the dll name minus the extension  */
     char keyName[NITF_MAX_PATH] = "";
-    int ok;
     nitf_DLL *dll;
     const char **ident;
-    nitf_PluginRegistry* reg = nitf_PluginRegistry_getInstance(error);
 
     /*  Construct the DLL object  */
+    *dllOut = NULL;
     dll = nitf_DLL_construct(error);
     if (!dll)
     {
-        return NITF_FAILURE;
+        return NULL;
     }
     /*  Otherwise we can load the DLL  */
     if (!nitf_DLL_load(dll, fullName, error))
@@ -479,35 +582,62 @@ NITFAPI(NITF_BOOL)
          * If the load failed, we have a set error
          *  So all we have to do is close shop, go home
          */
-        return NITF_FAILURE;
+        nitf_DLL_destruct(&dll);
+        return NULL;
     }
     nitf_Utils_baseName(keyName, fullName, NITF_DLL_EXTENSION);
     
     /* Now init the plugin!!!  */
     ident = doInit(dll, keyName, error);
+    *dllOut = dll;
+#if NITF_DEBUG_PLUGIN_REG
+    if (ident)
+        printf("Successfully loaded plugin: [%s] at [%p]\n",
+               keyName, dll);
+#endif
+    return ident;
+}
+
+/*
+ *  Load a DSO and insert its handlers.  If the DSO came from a manifest,
+ *  the owner is given, and only the handlers the manifest gave it are
+ *  inserted.  Returns the identity of the DSO, or NULL on failure.
+ */
+NITFPRIV(const char **) loadPluginFile(nitf_PluginRegistry * reg,
+                                       const char *fullName,
+                                       ManifestPlugin * owner,
+                                       nitf_Error * error)
+{
+    int ok;
+    nitf_DLL *dll;
+    const char **ident = openPluginFile(fullName, &dll, error);
     
     /*  If no ident, we have a set error and an invalid plugin  */
     if (ident)
     {
         /*  I expect to have problems with this now and then  */
-        ok = insertPlugin(reg, ident, dll, error);
+        ok = insertPlugin(reg, ident, dll, owner, error);
         
         /*  If insertion failed, take our toys and leave  */
         if (!ok)
         {
-            return NITF_FAILURE;
+            return NULL;
         }
-#if NITF_DEBUG_PLUGIN_REG
-        printf("Successfully loaded plugin: [%s] at [%p]\n",
-               keyName, dll);
-#endif
-        return NITF_SUCCESS;
     }
-    return NITF_FAILURE;
+    return ident;
     
 }
 
 
+NITFAPI(NITF_BOOL)
+    nitf_PluginRegistry_loadPlugin(const char* fullName, nitf_Error * error)
+{
+    nitf_PluginRegistry* reg = nitf_PluginRegistry_getInstance(error);
+
+    return loadPluginFile(reg, fullName, NULL, error) != NULL;
+}
+
+
 
 NITFAPI(NITF_BOOL)
 nitf_PluginRegistry_registerTREHandler(NITF_PLUGIN_INIT_FUNCTION init,
@@ -538,6 +668,7 @@ nitf_PluginRegistry_registerTREHandler(NITF_PLUGIN_INIT_FUNCTION init,
         return NITF_FAILURE;
     }
 
+    nitf_Mutex_lock( GET_MUTEX() );
     for (; ident[i] != NULL; ++i)
     {
 #if NITF_DEBUG_PLUGIN_REG
@@ -548,20 +679,263 @@ nitf_PluginRegistry_registerTREHandler(NITF_PLUGIN_INIT_FUNCTION init,
 #endif
         ok &= nitf_HashTable_insert(reg->treHandlers, ident[i], (NITF_DATA*)handle, error);
     }
+    nitf_Mutex_unlock( GET_MUTEX() );
 
     return ok;
 
 }
 
 
+/*
+ *  Join a directory and a file name into the full name buffer
+ */
+NITFPRIV(void) joinPath(char *fullName, const char *dirName, const char *name)
+{
+    size_t sizePath = strlen(dirName);
+    if (sizePath > 0 && !isDelimiter(dirName[sizePath - 1]))
+        NITF_SNPRINTF(fullName, NITF_MAX_PATH, "%s%c%s",
+                      dirName, DIR_DELIMITER, name);
+    else
+        NITF_SNPRINTF(fullName, NITF_MAX_PATH, "%s%s", dirName, name);
+}
+
+/*  See if we have .so or .dll extensions  */
+NITFPRIV(NITF_BOOL) isPluginFile(const char *name)
+{
+    return strstr(name, NITF_DLL_EXTENSION) != NULL;
+}
+
+/*
+ *  Get the size and modification time that identify a DSO in the manifest
+ */
+NITFPRIV(NITF_BOOL) statPlugin(const char *fullName, long *size, long *mtime)
+{
+    struct stat info;
+    if (stat(fullName, &info) != 0)
+        return NITF_FAILURE;
+    *size = (long) info.st_size;
+    *mtime = (long) info.st_mtime;
+    return NITF_SUCCESS;
+}
+
+/*
+ *  Read a line of the manifest, without its line ending
+ */
+NITFPRIV(NITF_BOOL) readManifestLine(char *line, FILE *file)
+{
+    size_t length;
+    if (!fgets(line, MANIFEST_LINE, file))
+        return NITF_FAILURE;
+    length = strlen(line);
+    while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r'))
+        line[--length] = '\0';
+    return NITF_SUCCESS;
+}
+
+/*
+ *  Check a manifest line naming a DSO against the DSO in the directory.
+ *  On success, fullName holds the path of the DSO.
+ */
+NITFPRIV(NITF_BOOL) checkManifestPlugin(const char *line,
+                                        const char *dirName,
+                                        char *fullName)
+{
+    long size, mtime, actualSize, actualMtime;
+    int nameStart = 0;
+
+    if (sscanf(line + strlen(MANIFEST_PLUGIN), "%ld\t%ld\t%n",
+               &size, &mtime, &nameStart) != 2 || nameStart == 0)
+        return NITF_FAILURE;
+
+    joinPath(fullName, dirName, line + strlen(MANIFEST_PLUGIN) + nameStart);
+    return statPlugin(fullName, &actualSize, &actualMtime) &&
+           size == actualSize && mtime == actualMtime;
+}
+
+/*
+ *  Turn a manifest line naming an identifier into the key of the manifest
+ *  handler table, which is the identifier prefixed by its kind
+ */
+NITFPRIV(NITF_BOOL) manifestHandlerKey(const char *line, char *key)
+{
+    char kind;
+    char pluginKey[NITF_MAX_PATH];
+    const char *tab = strchr(line, '\t');
+
+    if (!tab || tab == line || (size_t)(tab - line) >= NITF_MAX_PATH)
+        return NITF_FAILURE;
+    memcpy(pluginKey, line, tab - line);
+    pluginKey[tab - line] = '\0';
+
+    kind = pluginKind(pluginKey);
+    if (!kind || !tab[1])
+        return NITF_FAILURE;
+    NITF_SNPRINTF(key, NITF_MAX_PATH, "%c%s", kind, tab + 1);
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(int) countPlugins(const char *dirName, nitf_Error * error)
+{
+    int count = 0;
+    const char *name;
+    nitf_Directory *dir = nitf_Directory_construct(error);
+    if (!dir)
+        return -1;
+
+    for (name = nitf_Directory_findFirstFile(dir, dirName); name;
+         name = nitf_Directory_findNextFile(dir))
+    {
+        if (isPluginFile(name))
+            ++count;
+    }
+    nitf_Directory_destruct(&dir);
+    return count;
+}
+
+/*
+ *  Register the DSOs of a directory from its manifest, without loading
+ *  them.  This fails, leaving the registry as it was, unless the manifest
+ *  lists exactly the DSOs in the directory, unchanged since it was written.
+ */
+NITFPRIV(NITF_BOOL) readManifest(nitf_PluginRegistry * reg,
+                                 const char *dirName,
+                                 const char *manifestName,
+                                 nitf_Error * error)
+{
+    char line[MANIFEST_LINE];
+    char fullName[NITF_MAX_PATH];
+    char key[NITF_MAX_PATH];
+    ManifestPlugin *plugin = NULL;
+    int numPlugins = 0;
+    NITF_BOOL valid = NITF_FAILURE;
+    FILE *file = fopen(manifestName, "r");
+
+    if (!file)
+        return NITF_FAILURE;
+
+    /*  First, make sure the manifest still describes the directory  */
+    if (readManifestLine(line, file) && strcmp(line, MANIFEST_HEADER) == 0)
+    {
+        while (readManifestLine(line, file))
+        {
+            if (strcmp(line, MANIFEST_END) == 0)
+            {
+                valid = numPlugins == countPlugins(dirName, error);
+                break;
+            }
+            if (strncmp(line, MANIFEST_PLUGIN, strlen(MANIFEST_PLUGIN)) == 0)
+            {
+                if (!checkManifestPlugin(line, dirName, fullName))
+                    break;
+                ++numPlugins;
+            }
+            else if (numPlugins == 0 || !manifestHandlerKey(line, key))
+                break;
+        }
+    }
+
+    /*  Then add its DSOs.  The first DSO to name an identifier gets it.  */
+    if (valid)
+    {
+        rewind(file);
+        readManifestLine(line, file);
+        while (valid && readManifestLine(line, file) &&
+               strcmp(line, MANIFEST_END) != 0)
+        {
+            if (strncmp(line, MANIFEST_PLUGIN, strlen(MANIFEST_PLUGIN)) == 0)
+            {
+                size_t length;
+                checkManifestPlugin(line, dirName, fullName);
+                length = strlen(fullName);
+
+                plugin = (ManifestPlugin *)
+                    NITF_MALLOC(sizeof(ManifestPlugin) + length + 1);
+                if (!plugin)
+                {
+                    nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                                    NITF_CTXT, NITF_ERR_MEMORY);
+                    valid = NITF_FAILURE;
+                    break;
+                }
+                plugin->path = (char *) (plugin + 1);
+                memcpy(plugin->path, fullName, length + 1);
+                plugin->state = MANIFEST_UNTRIED;
+                if (!nitf_List_pushBack(reg->manifestPlugins, plugin, error))
+                {
+                    NITF_FREE(plugin);
+                    valid = NITF_FAILURE;
+                }
+            }
+            else
+            {
+                manifestHandlerKey(line, key);
+                if (!nitf_HashTable_exists(reg->manifestHandlers, key))
+                    valid = nitf_HashTable_insert(reg->manifestHandlers, key,
+                                                  plugin, error);
+            }
+        }
+    }
+    fclose(file);
+
+#if NITF_DEBUG_PLUGIN_REG
+    printf("Plugin manifest [%s] %s\n", manifestName,
+           valid ? "is current" : "is missing or out of date");
+#endif
+    return valid;
+}
+
+/*
+ *  List a DSO, and the identifiers it handles, in a new manifest
+ */
+NITFPRIV(NITF_BOOL) writeManifestPlugin(FILE *file,
+                                        const char *fullName,
+                                        const char *name,
+                                        const char **ident)
+{
+    long size, mtime;
+    int i;
+
+    if (!statPlugin(fullName, &size, &mtime))
+        return NITF_FAILURE;
+
+    fprintf(file, "%s%ld\t%ld\t%s\n", MANIFEST_PLUGIN, size, mtime, name);
+    if (ident && pluginKind(ident[0]))
+    {
+        for (i = 1; ident[i] != NULL; i++)
+            fprintf(file, "%s\t%s\n", ident[0], ident[i]);
+    }
+    return !ferror(file);
+}
+
+/*
+ *  Get the manifest name for a plugin directory.  This fails if the
+ *  manifest is disabled.  A manifest named by the environment is only
+ *  used for the directory it lists, since it is rejected as stale for
+ *  any other.
+ */
+NITFPRIV(NITF_BOOL) getManifestName(const char *dirName, char *manifestName)
+{
+    const char *manifestEnvVar = getenv(NITF_PLUGIN_MANIFEST);
+
+    if (manifestEnvVar)
+    {
+        if (!*manifestEnvVar)
+            return NITF_FAILURE;
+        NITF_SNPRINTF(manifestName, NITF_MAX_PATH, "%s", manifestEnvVar);
+        return NITF_SUCCESS;
+    }
+    joinPath(manifestName, dirName, NITF_PLUGIN_MANIFEST_FILE);
+    return NITF_SUCCESS;
+}
+
 NITFPROT(NITF_BOOL) 
     nitf_PluginRegistry_internalLoadDir(nitf_PluginRegistry * reg,
                                         const char *dirName,
                                         nitf_Error * error)
 {
     const char *name;
-    size_t sizePath;
     nitf_Directory *dir = NULL;
+    char manifestName[NITF_MAX_PATH];
     
     if (!dirName)
     {
@@ -576,30 +950,28 @@ NITFPROT(NITF_BOOL)
         return NITF_FAILURE;
     }
     
-    sizePath = strlen(dirName);
-    
     if (nitf_Directory_exists(dirName))
     {
+        if (getManifestName(dirName, manifestName) &&
+            readManifest(reg, dirName, manifestName, error))
+        {
+            nitf_Directory_destruct(&dir);
+            return NITF_SUCCESS;
+        }
+
         name = nitf_Directory_findFirstFile(dir, dirName);
         if (name)
         {
             do
             {
-
-                char *end;
                 char fullName[NITF_MAX_PATH];
-                int pathSize = sizePath;
-                memset(fullName, 0, NITF_MAX_PATH);
-                memcpy(fullName, dirName, sizePath);
-                if (!isDelimiter(dirName[pathSize - 1]))
-                    fullName[pathSize++] = DIR_DELIMITER;
-                memcpy(fullName + pathSize, name, strlen(name));
-
-                /*  See if we have .so or .dll extensions  */
-                if ((end =
-                     (char *) strstr(name, NITF_DLL_EXTENSION)) != NULL)
+                joinPath(fullName, dirName, name);
+
+                if (isPluginFile(name))
                 {
-                    if (!nitf_PluginRegistry_loadPlugin(fullName, error))
+                    const char **ident =
+                        loadPluginFile(reg, fullName, NULL, error);
+                    if (!ident)
                     {
 #if NITF_DEBUG_PLUGIN_REG
                         printf("Warning: plugin [%s] failed to load!\n", name);
@@ -663,6 +1035,160 @@ NITFAPI(NITF_BOOL) nitf_PluginRegistry_loadDir(const char *dirName,
 }
 
 
+NITFAPI(NITF_BOOL) nitf_PluginRegistry_writeManifest(const char *dirName,
+                                                     const char *manifestName,
+                                                     nitf_Error * error)
+{
+    const char *name;
+    nitf_Directory *dir = NULL;
+    char defaultName[NITF_MAX_PATH];
+    /*  Room for the process id after the manifest name  */
+    char tempName[NITF_MAX_PATH + 24];
+    FILE *manifest;
+    NITF_BOOL written = NITF_SUCCESS;
+
+    if (!dirName || !nitf_Directory_exists(dirName))
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_OPENING_FILE,
+                         "Plugin directory [%s] does not exist",
+                         dirName ? dirName : "");
+        return NITF_FAILURE;
+    }
+    if (!manifestName)
+    {
+        if (!getManifestName(dirName, defaultName))
+        {
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                             "The plugin manifest is disabled by %s",
+                             NITF_PLUGIN_MANIFEST);
+            return NITF_FAILURE;
+        }
+        manifestName = defaultName;
+    }
+
+    dir = nitf_Directory_construct(error);
+    if (!dir)
+        return NITF_FAILURE;
+
+    /*
+     *  Write the new manifest under a name of our own, so that
+     *  no one reads it until it is complete
+     */
+    NITF_SNPRINTF(tempName, sizeof(tempName), "%s.%d",
+                  manifestName, (int) getpid());
+    manifest = fopen(tempName, "w");
+    if (!manifest)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_OPENING_FILE);
+        nitf_Directory_destruct(&dir);
+        return NITF_FAILURE;
+    }
+    fprintf(manifest, "%s\n", MANIFEST_HEADER);
+
+    for (name = nitf_Directory_findFirstFile(dir, dirName); name && written;
+         name = nitf_Directory_findNextFile(dir))
+    {
+        char fullName[NITF_MAX_PATH];
+        nitf_DLL *dll;
+        const char **ident;
+        nitf_Error loadError;
+
+        if (!isPluginFile(name))
+            continue;
+
+        /*  Failed plugins are listed too, with no handlers  */
+        joinPath(fullName, dirName, name);
+        ident = openPluginFile(fullName, &dll, &loadError);
+        written = writeManifestPlugin(manifest, fullName, name, ident);
+        if (dll)
+            nitf_DLL_destruct(&dll);
+    }
+    nitf_Directory_destruct(&dir);
+
+    fprintf(manifest, "%s\n", MANIFEST_END);
+    written &= !ferror(manifest);
+    written &= fclose(manifest) == 0;
+    if (written && rename(tempName, manifestName) != 0)
+    {
+        /*  Windows will not rename over an existing file  */
+        remove(manifestName);
+        written = rename(tempName, manifestName) == 0;
+    }
+    if (!written)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_WRITING_TO_FILE,
+                         "Unable to write the plugin manifest [%s]",
+                         manifestName);
+        remove(tempName);
+    }
+    return written;
+}
+
+
+
+/*
+ *  Find a handler in one of the handler tables.  If it is not there, but
+ *  a manifest names the DSO that provides it, that DSO is loaded first.
+ *  The handler tables change as DSOs are loaded, so they are only used
+ *  under the registry lock, but the DSO itself is loaded without it.
+ *  Another thread that wants the same DSO meanwhile waits for it.
+ */
+NITFPRIV(nitf_Pair *) findHandler(nitf_PluginRegistry * reg,
+                                  nitf_HashTable * handlers,
+                                  char kind,
+                                  const char *ident,
+                                  nitf_Error * error)
+{
+    char key[NITF_MAX_PATH];
+    nitf_Pair *pair;
+    ManifestPlugin *plugin = NULL;
+    nitf_DLL *dll;
+    const char **pluginIdent;
+
+    nitf_Mutex_lock( GET_MUTEX() );
+
+    pair = nitf_HashTable_find(handlers, ident);
+    if (!pair)
+    {
+        NITF_SNPRINTF(key, NITF_MAX_PATH, "%c%s", kind, ident);
+        pair = nitf_HashTable_find(reg->manifestHandlers, key);
+        plugin = pair ? (ManifestPlugin *) pair->data : NULL;
+        pair = NULL;
+
+        while (plugin && plugin->state == MANIFEST_LOADING)
+            nitf_Condition_wait(&reg->pluginLoaded, GET_MUTEX());
+
+        if (plugin && plugin->state == MANIFEST_UNTRIED)
+        {
+            plugin->state = MANIFEST_LOADING;
+            nitf_Mutex_unlock( GET_MUTEX() );
+
+            pluginIdent = openPluginFile(plugin->path, &dll, error);
+
+            nitf_Mutex_lock( GET_MUTEX() );
+            if (!pluginIdent)
+            {
+                if (dll)
+                    nitf_DLL_destruct(&dll);
+            }
+            else if (!insertPlugin(reg, pluginIdent, dll, plugin, error))
+                pluginIdent = NULL;
+#if NITF_DEBUG_PLUGIN_REG
+            if (!pluginIdent)
+                printf("Warning: plugin [%s] failed to load!\n",
+                       plugin->path);
+#endif
+            plugin->state = MANIFEST_TRIED;
+            nitf_Condition_broadcast(&reg->pluginLoaded);
+        }
+        if (plugin)
+            pair = nitf_HashTable_find(handlers, ident);
+    }
+
+    nitf_Mutex_unlock( GET_MUTEX() );
+    return pair;
+}
 
 NITFPROT(NITF_PLUGIN_DECOMPRESSION_CONSTRUCT_FUNCTION)
 nitf_PluginRegistry_retrieveDecompConstructor(nitf_PluginRegistry * reg,
@@ -677,21 +1203,14 @@ nitf_PluginRegistry_retrieveDecompConstructor(nitf_PluginRegistry * reg,
     /*  No error has occurred (yet)  */
     *hadError = 0;
     
-    if (!nitf_HashTable_exists(reg->decompressionHandlers, ident))
-    {
-        *hadError = 1;
-        nitf_Error_init(error, "Decompression handlers not set", NRT_CTXT,
-        		        NRT_ERR_DECOMPRESSION);
-        return NULL;
-    }
-    pair = nitf_HashTable_find(reg->decompressionHandlers, ident);
+    pair = findHandler(reg, reg->decompressionHandlers, 'D', ident, error);
     
     /*  If nothing is there, we don't have a handler, plain and simple  */
     if (!pair)
     {
-        nitf_Error_initf(error, NRT_CTXT, NRT_ERR_DECOMPRESSION,
-        		         "Don't have a handler for '%s'",
-        		         ident);
+        *hadError = 1;
+        nitf_Error_init(error, "Decompression handlers not set", NRT_CTXT,
+        		        NRT_ERR_DECOMPRESSION);
         return NULL;
     }
     
@@ -711,21 +1230,14 @@ nitf_PluginRegistry_retrieveCompConstructor(nitf_PluginRegistry * reg,
     /*  No error has occurred (yet)  */
     *hadError = 0;
     
-    if (!nitf_HashTable_exists(reg->compressionHandlers, ident))
-    {
-        *hadError = 1;
-        nitf_Error_init(error, "Compression handlers not set", NRT_CTXT,
-        		        NRT_ERR_COMPRESSION);
-        return NULL;
-    }
-    pair = nitf_HashTable_find(reg->compressionHandlers, ident);
+    pair = findHandler(reg, reg->compressionHandlers, 'C', ident, error);
     
     /*  If nothing is there, we don't have a handler, plain and simple  */
     if (!pair)
     {
-        nitf_Error_initf(error, NRT_CTXT, NRT_ERR_COMPRESSION,
-        		         "Don't have a handler for '%s'",
-        		         ident);
+        *hadError = 1;
+        nitf_Error_init(error, "Compression handlers not set", NRT_CTXT,
+        		        NRT_ERR_COMPRESSION);
         return NULL;
     }
     
@@ -788,7 +1300,8 @@ NITFPRIV(NITF_BOOL) insertCreator(nitf_DLL* dso,
 
 /*
  *  Function is now greatly simplified.  We only retrieve TREs from
- *  the hash table.  If they are there, we are good, if not fail
+ *  the hash table (loading their DSO if a manifest names it).  If they
+ *  are there, we are good, if not fail
  *
  *  No more talking to the DSOs directly
  */
@@ -807,12 +1320,8 @@ nitf_PluginRegistry_retrieveTREHandler(nitf_PluginRegistry * reg,
     /*  No error has occurred (yet)  */
     *hadError = 0;
 
-    if (!nitf_HashTable_exists(reg->treHandlers, treIdent))
-    {
-        return NULL;
-    }
     /*  Lookup the pair from the hash table, by the tre_id  */
-    pair = nitf_HashTable_find(reg->treHandlers, treIdent);
+    pair = findHandler(reg, reg->treHandlers, 'T', treIdent, error);
 
     /*  If nothing is there, we dont have a handler, plain and simple  */
     if (!pair)
@@ -239,6 +239,330 @@ CATCH_ERROR:
 
 /*  This is a simple read method.  Note that this is NOT a finalized  */
 /*  method.                                         */
+/*
+ *  Headers are parsed from a buffer over the input, so that a subheader
+ *  is fetched in one read rather than one read per field.  The reader
+ *  sets the extent of each header region as it learns it (from HL and
+ *  the subheader lengths of the file header), and the buffer is filled
+ *  with the rest of the region at once.  Outside of a known region it
+ *  reads ahead a little.  TRE handlers read through the buffer as well.
+ */
+#define NITF_READER_READ_AHEAD 4096
+
+typedef struct _HeaderBuffer
+{
+    nitf_IOInterface *io;   /* The input, which is not owned */
+    char *data;             /* The buffered bytes */
+    size_t capacity;        /* The size of data */
+    size_t filled;          /* The number of buffered bytes */
+    nitf_Off start;         /* The file offset of data */
+    nitf_Off offset;        /* The current file offset */
+    nitf_Off ioOffset;      /* The file offset of the input */
+    nitf_Off regionEnd;     /* The end of the current header region */
+    nitf_Off size;          /* The size of the input */
+} HeaderBuffer;
+
+NITFPRIV(NITF_BOOL) HeaderBuffer_fill(HeaderBuffer * buffer, size_t size,
+                                      nitf_Error * error)
+{
+    size_t amount = NITF_READER_READ_AHEAD;
+    nitf_Off remaining = buffer->size - buffer->offset;
+
+    if (buffer->regionEnd > buffer->offset)
+        amount = (size_t) (buffer->regionEnd - buffer->offset);
+    if ((nitf_Off) amount > remaining)
+        amount = remaining > 0 ? (size_t) remaining : 0;
+    if (amount < size)
+        amount = size; /* let the read report the end of the file */
+
+    if (amount > buffer->capacity)
+    {
+        char *data = (char *) NITF_REALLOC(buffer->data, amount);
+        if (!data)
+        {
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                            NITF_CTXT, NITF_ERR_MEMORY);
+            return NITF_FAILURE;
+        }
+        buffer->data = data;
+        buffer->capacity = amount;
+    }
+
+    buffer->filled = 0;
+    if (buffer->ioOffset != buffer->offset)
+    {
+        if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(buffer->io, buffer->offset,
+                                                   NITF_SEEK_SET, error)))
+            return NITF_FAILURE;
+        buffer->ioOffset = buffer->offset;
+    }
+    if (!nitf_IOInterface_read(buffer->io, buffer->data, amount, error))
+    {
+        buffer->ioOffset = -1;
+        return NITF_FAILURE;
+    }
+
+    buffer->start = buffer->offset;
+    buffer->filled = amount;
+    buffer->ioOffset += (nitf_Off) amount;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) HeaderBuffer_read(NITF_DATA * data, void *buf,
+                                      size_t size, nitf_Error * error)
+{
+    HeaderBuffer *buffer = (HeaderBuffer *) data;
+    char *out = (char *) buf;
+
+    while (size > 0)
+    {
+        size_t n;
+
+        if (buffer->offset < buffer->start || buffer->offset >=
+                buffer->start + (nitf_Off) buffer->filled)
+        {
+            /* Large reads outside of the headers are not buffered */
+            if (size >= NITF_READER_READ_AHEAD &&
+                    buffer->offset >= buffer->regionEnd)
+            {
+                if (buffer->ioOffset != buffer->offset &&
+                        !NITF_IO_SUCCESS(nitf_IOInterface_seek(buffer->io,
+                                buffer->offset, NITF_SEEK_SET, error)))
+                    return NITF_FAILURE;
+                buffer->ioOffset = -1;
+                if (!nitf_IOInterface_read(buffer->io, out, size, error))
+                    return NITF_FAILURE;
+                buffer->offset += (nitf_Off) size;
+                buffer->ioOffset = buffer->offset;
+                return NITF_SUCCESS;
+            }
+
+            if (!HeaderBuffer_fill(buffer, size, error))
+                return NITF_FAILURE;
+        }
+
+        n = (size_t) (buffer->start + (nitf_Off) buffer->filled -
+                      buffer->offset);
+        if (n > size)
+            n = size;
+        memcpy(out, buffer->data + (size_t) (buffer->offset - buffer->start),
+               n);
+        out += n;
+        size -= n;
+        buffer->offset += (nitf_Off) n;
+    }
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) HeaderBuffer_write(NITF_DATA * data, const void *buf,
+                                       size_t size, nitf_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)buf;
+    (void)size;
+
+    nitf_Error_init(error, "Header buffer is read-only", NITF_CTXT,
+                    NITF_ERR_WRITING_TO_FILE);
+    return NITF_FAILURE;
+}
+
+NITFPRIV(NITF_BOOL) HeaderBuffer_canSeek(NITF_DATA * data, nitf_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)error;
+
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(nitf_Off) HeaderBuffer_seek(NITF_DATA * data, nitf_Off offset,
+                                     int whence, nitf_Error * error)
+{
+    HeaderBuffer *buffer = (HeaderBuffer *) data;
+
+    /* Silence compiler warnings about unused variables */
+    (void)error;
+
+    if (whence == NITF_SEEK_SET)
+        buffer->offset = offset;
+    else if (whence == NITF_SEEK_CUR)
+        buffer->offset += offset;
+    else
+        buffer->offset = buffer->size + offset;
+    return buffer->offset;
+}
+
+NITFPRIV(nitf_Off) HeaderBuffer_tell(NITF_DATA * data, nitf_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)error;
+
+    return ((HeaderBuffer *) data)->offset;
+}
+
+NITFPRIV(nitf_Off) HeaderBuffer_getSize(NITF_DATA * data, nitf_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)error;
+
+    return ((HeaderBuffer *) data)->size;
+}
+
+NITFPRIV(int) HeaderBuffer_getMode(NITF_DATA * data, nitf_Error * error)
+{
+    return nitf_IOInterface_getMode(((HeaderBuffer *) data)->io, error);
+}
+
+NITFPRIV(NITF_BOOL) HeaderBuffer_close(NITF_DATA * data, nitf_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)error;
+
+    /* The input is not owned */
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(void) HeaderBuffer_destruct(NITF_DATA * data)
+{
+    HeaderBuffer *buffer = (HeaderBuffer *) data;
+    if (buffer->data)
+        NITF_FREE(buffer->data);
+    buffer->data = NULL;
+}
+
+NITFPRIV(NITF_BOOL) HeaderBuffer_readAt(NITF_DATA * data, nitf_Off offset,
+                                        void *buf, size_t size,
+                                        nitf_Error * error)
+{
+    return nitf_IOInterface_readAt(((HeaderBuffer *) data)->io, offset, buf,
+                                   size, error);
+}
+
+NITFPRIV(const void *) HeaderBuffer_getBuffer(NITF_DATA * data,
+                                              nitf_Off offset, size_t size)
+{
+    return nitf_IOInterface_getBuffer(((HeaderBuffer *) data)->io, offset,
+                                      size);
+}
+
+static nitf_IIOInterface headerBufferInterface = {
+    &HeaderBuffer_read,
+    &HeaderBuffer_write,
+    &HeaderBuffer_canSeek,
+    &HeaderBuffer_seek,
+    &HeaderBuffer_tell,
+    &HeaderBuffer_getSize,
+    &HeaderBuffer_getMode,
+    &HeaderBuffer_close,
+    &HeaderBuffer_destruct,
+    &HeaderBuffer_readAt,
+    &HeaderBuffer_getBuffer
+};
+
+/*
+ *  Start reading the headers of the reader's input through a buffer.
+ *  Inputs that are already in memory, or cannot seek, are read directly.
+ */
+NITFPRIV(NITF_BOOL) startHeaderBuffer(nitf_Reader * reader,
+                                      nitf_Error * error)
+{
+    nitf_IOInterface *impl = NULL;
+    HeaderBuffer *buffer = NULL;
+    nitf_Off offset;
+    nitf_Off size;
+
+    if (nitf_IOInterface_getBuffer(reader->input, 0, 1) != NULL ||
+            !nitf_IOInterface_canSeek(reader->input, error))
+        return NITF_SUCCESS;
+
+    offset = nitf_IOInterface_tell(reader->input, error);
+    size = nitf_IOInterface_getSize(reader->input, error);
+    if (offset < 0 || size < 0)
+        return NITF_FAILURE;
+
+    impl = (nitf_IOInterface *) NITF_MALLOC(sizeof(nitf_IOInterface));
+    buffer = (HeaderBuffer *) NITF_MALLOC(sizeof(HeaderBuffer));
+    if (!impl || !buffer)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        if (impl)
+            NITF_FREE(impl);
+        if (buffer)
+            NITF_FREE(buffer);
+        return NITF_FAILURE;
+    }
+
+    buffer->io = reader->input;
+    buffer->data = NULL;
+    buffer->capacity = 0;
+    buffer->filled = 0;
+    buffer->start = 0;
+    buffer->offset = offset;
+    buffer->ioOffset = offset;
+    buffer->regionEnd = 0;
+    buffer->size = size;
+
+    impl->data = (NITF_DATA *) buffer;
+    impl->iface = &headerBufferInterface;
+    reader->input = impl;
+    return NITF_SUCCESS;
+}
+
+/*
+ *  Set the end of the header region that is read from here on
+ */
+NITFPRIV(void) setHeaderEnd(nitf_Reader * reader, nitf_Off end)
+{
+    if (reader->input && reader->input->iface == &headerBufferInterface)
+        ((HeaderBuffer *) reader->input->data)->regionEnd = end;
+}
+
+/*
+ *  Set the header region from the current offset and a length field
+ */
+NITFPRIV(NITF_BOOL) setHeaderLength(nitf_Reader * reader,
+                                    nitf_Field * lengthField,
+                                    nitf_Error * error)
+{
+    nitf_Uint64 length;
+    nitf_Off offset;
+
+    NITF_TRY_GET_UINT64(lengthField, &length, error);
+    offset = nitf_IOInterface_tell(reader->input, error);
+    if (offset < 0)
+        goto CATCH_ERROR;
+
+    setHeaderEnd(reader, offset + (nitf_Off) length);
+    return NITF_SUCCESS;
+
+CATCH_ERROR:
+    return NITF_FAILURE;
+}
+
+/*
+ *  Stop buffering, leaving the input at the offset the parse reached
+ */
+NITFPRIV(void) endHeaderBuffer(nitf_Reader * reader)
+{
+    nitf_IOInterface *impl = reader->input;
+    HeaderBuffer *buffer;
+    nitf_Error error;
+
+    if (!impl || impl->iface != &headerBufferInterface)
+        return;
+
+    buffer = (HeaderBuffer *) impl->data;
+    reader->input = buffer->io;
+    if (buffer->ioOffset != buffer->offset)
+        nitf_IOInterface_seek(reader->input, buffer->offset, NITF_SEEK_SET,
+                              &error);
+    nitf_IOInterface_destruct(&impl);
+}
+
+
 NITFPRIV(NITF_BOOL) readField(nitf_Reader * reader,
                               char *fld, int length, nitf_Error * error)
 {
@@ -265,7 +589,36 @@ NITFPRIV(NITF_BOOL) readValue(nitf_Reader * reader,
                               nitf_Field * field,
                               int length, nitf_Error * error)
 {
-    char *buf = (char *) NITF_MALLOC(length);
+    char *buf = NULL;
+
+    /*
+     *  Fields are nearly always read at their own length, in which case
+     *  the value goes straight into the field, without a temporary
+     */
+    if ((size_t) length == field->length)
+    {
+        if (!readField(reader, field->raw, length, error))
+            goto CATCH_ERROR;
+
+        /* check to see if we need to swap bytes */
+        if (field->type == NITF_BINARY && length == NITF_INT16_SZ)
+        {
+            nitf_Int16 int16;
+            memcpy(&int16, field->raw, length);
+            int16 = (nitf_Int16)NITF_NTOHS(int16);
+            memcpy(field->raw, &int16, length);
+        }
+        else if (field->type == NITF_BINARY && length == NITF_INT32_SZ)
+        {
+            nitf_Int32 int32;
+            memcpy(&int32, field->raw, length);
+            int32 = (nitf_Int32)NITF_NTOHL(int32);
+            memcpy(field->raw, &int32, length);
+        }
+        return NITF_SUCCESS;
+    }
+
+    buf = (char *) NITF_MALLOC(length);
     if (!buf)
     {
         nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
@@ -443,6 +796,8 @@ NITFAPI(nitf_Reader *) nitf_Reader_construct(nitf_Error * error)
     reader->record = NULL;
     reader->input = NULL;
     reader->ownInput = 0;
+    reader->useArena = 0;
+    reader->lazyTREs = 0;
     resetIOInterface(reader);
 
     /*  Return our results  */
@@ -955,6 +1310,9 @@ NITFPRIV(NITF_BOOL) readHeader(nitf_Reader * reader, nitf_Error * error)
     char fileLenBuf[NITF_FL_SZ + 1];    /* File length buffer */
     char streamingBuf[NITF_FL_SZ];
 
+    /* Where the file header starts */
+    nitf_Off headerStart = nitf_IOInterface_tell(reader->input, error);
+
     /* FHDR */
     TRY_READ_MEMBER_VALUE(reader, fileHeader, NITF_FHDR);
     if ((strncmp(fileHeader->NITF_FHDR->raw, "NITF", 4) != 0)
@@ -1027,6 +1385,7 @@ NITFPRIV(NITF_BOOL) readHeader(nitf_Reader * reader, nitf_Error * error)
     /* HL */
     TRY_READ_MEMBER_VALUE(reader, fileHeader, NITF_HL);
     NITF_TRY_GET_UINT32(fileHeader->NITF_HL, &num32, error);
+    setHeaderEnd(reader, headerStart + (nitf_Off) num32);
 
     /* Read the image info section */
     TRY_READ_COMPONENT(reader,
@@ -1234,6 +1593,12 @@ NITFPRIV(NITF_BOOL) handleTRE(nitf_Reader * reader, nitf_Uint32 length,
                                                          &bad, error);
         if (bad)
             goto CATCH_ERROR;
+
+        /* keep the raw bytes, and parse them when the TRE is used */
+        if (reader->lazyTREs)
+            return nitf_LazyTRE_defer(tre, handler, reader->input, length,
+                                      reader->record, error);
+
         if (handler)
         {
             tre->handler = handler;
@@ -1382,9 +1747,9 @@ NITFAPI(nitf_Record *) nitf_Reader_read(nitf_Reader * reader,
 }
 
 
-NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
-                                          nitf_IOInterface* io,
-                                          nitf_Error* error)
+NITFPRIV(nitf_Record *) readRecord(nitf_Reader* reader,
+                                   nitf_IOInterface* io,
+                                   nitf_Error* error)
 {
     nitf_Uint32 i = 0;          /* iterator */
     nitf_Uint32 num32;          /* generic uint32 */
@@ -1404,6 +1769,9 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
     if (!reader->input)
         goto CATCH_ERROR;
 
+    if (!startHeaderBuffer(reader, error))
+        goto CATCH_ERROR;
+
     /*  This part is trivial thanks to our readHeader accessor  */
     if (!readHeader(reader, error))
         goto CATCH_ERROR;
@@ -1429,6 +1797,9 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
         }
 
         /* Read the sub-header */
+        if (!setHeaderLength(reader,
+                reader->record->header->NITF_LISH(i), error))
+            goto CATCH_ERROR;
         if (!readImageSubheader(reader, i, fver, error))
             goto CATCH_ERROR;
 
@@ -1472,6 +1843,9 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
             goto CATCH_ERROR;
         }
 
+        if (!setHeaderLength(reader,
+                reader->record->header->NITF_LSSH(i), error))
+            goto CATCH_ERROR;
         if (!readGraphicSubheader(reader, i, fver, error))
             goto CATCH_ERROR;
         graphicSegment->offset = nitf_IOInterface_tell(reader->input,
@@ -1510,6 +1884,9 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
             goto CATCH_ERROR;
         }
 
+        if (!setHeaderLength(reader,
+                reader->record->header->NITF_LLSH(i), error))
+            goto CATCH_ERROR;
         if (!readLabelSubheader(reader, i, fver, error))
             goto CATCH_ERROR;
         labelSegment->offset = nitf_IOInterface_tell(reader->input,
@@ -1546,6 +1923,9 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
             goto CATCH_ERROR;
         }
 
+        if (!setHeaderLength(reader,
+                reader->record->header->NITF_LTSH(i), error))
+            goto CATCH_ERROR;
         if (!readTextSubheader(reader, i, fver, error))
             goto CATCH_ERROR;
         textSegment->offset = nitf_IOInterface_tell(reader->input,
@@ -1584,6 +1964,9 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
             goto CATCH_ERROR;
         }
 
+        if (!setHeaderLength(reader,
+                reader->record->header->NITF_LDSH(i), error))
+            goto CATCH_ERROR;
         if (!readDESubheader(reader, i, fver, error))
             goto CATCH_ERROR;
 
@@ -1608,6 +1991,9 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
             goto CATCH_ERROR;
         }
 
+        if (!setHeaderLength(reader,
+                reader->record->header->NITF_LRESH(i), error))
+            goto CATCH_ERROR;
         if (!readRESubheader(reader, i, fver, error))
             goto CATCH_ERROR;
 
@@ -1622,15 +2008,62 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
         }
     }
 
+    endHeaderBuffer(reader);
     return reader->record;
 
 CATCH_ERROR:
+    endHeaderBuffer(reader);
     nitf_Record_destruct(&reader->record);
     resetIOInterface(reader);
     return NULL;
 }
 
 
+NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
+                                          nitf_IOInterface* io,
+                                          nitf_Error* error)
+{
+    nitf_Arena *arena = NULL;
+    nitf_Arena *previous = NULL;
+    nitf_Record *record = NULL;
+
+    if (!reader->useArena)
+        return readRecord(reader, io, error);
+
+    /*
+     *  The fields of the record are allocated from an arena that is
+     *  current while parsing, and released with the record
+     */
+    arena = nitf_Arena_construct(NITF_ARENA_CHUNK_SIZE, error);
+    if (!arena)
+        return NULL;
+
+    previous = nitf_Arena_setCurrent(arena);
+    record = readRecord(reader, io, error);
+    nitf_Arena_setCurrent(previous);
+
+    if (record)
+        record->arena = arena;
+    else
+        nitf_Arena_destruct(&arena);
+    return record;
+}
+
+
+NITFAPI(void) nitf_Reader_setUseArena(nitf_Reader * reader,
+                                      NITF_BOOL useArena)
+{
+    reader->useArena = useArena;
+}
+
+
+NITFAPI(void) nitf_Reader_setLazyTREs(nitf_Reader * reader,
+                                      NITF_BOOL lazyTREs)
+{
+    reader->lazyTREs = lazyTREs;
+}
+
+
 NITFPRIV(nitf_DecompressionInterface *) getDecompIface(const char *comp,
         int *bad,
         nitf_Error * error)
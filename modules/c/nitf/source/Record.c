@@ -597,6 +597,7 @@ NITFAPI(nitf_Record *) nitf_Record_construct(nitf_Version version,
     record->texts = NULL;
     record->dataExtensions = NULL;
     record->reservedExtensions = NULL;
+    record->arena = NULL;
 
     /*
      * This block does the children creations
@@ -678,6 +679,7 @@ NITFAPI(nitf_Record *) nitf_Record_clone(const nitf_Record * source,
     record->texts = NULL;
     record->dataExtensions = NULL;
     record->reservedExtensions = NULL;
+    record->arena = NULL;
     
     /* Right now, we are only doing the header and image setup  */
     record->header = nitf_FileHeader_clone(source->header, error);
@@ -821,6 +823,9 @@ NITFAPI(void) nitf_Record_destruct(nitf_Record ** record)
             nitf_List_destruct(&(*record)->reservedExtensions);
         }
 
+        /* Last, since the fields above may live in it */
+        nitf_Arena_destruct(&(*record)->arena);
+
         NITF_FREE(*record);
         *record = NULL;
     }
@@ -100,12 +100,29 @@ CATCH_ERROR:
 
 
 
+NITFPRIV(nitf_Off) SegmentWriter_getSize(NITF_DATA * data,
+                                         nitf_Error * error)
+{
+    SegmentWriterImpl *impl = (SegmentWriterImpl *) data;
+
+    if (!impl->segmentSource)
+    {
+        nitf_Error_init(error, "No segment source attached",
+                        NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        return -1;
+    }
+    return (*impl->segmentSource->iface->getSize)(impl->segmentSource->data,
+                                                  error);
+}
+
+
 NITFAPI(nitf_SegmentWriter *) nitf_SegmentWriter_construct(nitf_Error *error)
 {
     static nitf_IWriteHandler iWriteHandler =
     {
         &SegmentWriter_write,
-        &SegmentWriter_destruct
+        &SegmentWriter_destruct,
+        &SegmentWriter_getSize
     };
 
     SegmentWriterImpl *impl = NULL;
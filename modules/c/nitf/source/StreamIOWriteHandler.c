@@ -105,6 +105,15 @@ NITFPRIV(void) WriteHandler_destruct(NITF_DATA * data)
 }
 
 
+NITFPRIV(nitf_Off) WriteHandler_getSize(NITF_DATA * data, nitf_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)error;
+
+    return (nitf_Off) ((WriteHandlerImpl *) data)->bytes;
+}
+
+
 NITFAPI(nitf_WriteHandler*)
 nitf_StreamIOWriteHandler_construct(nitf_IOInterface *ioHandle,
                                     nitf_Uint64 offset,
@@ -117,7 +126,8 @@ nitf_StreamIOWriteHandler_construct(nitf_IOInterface *ioHandle,
     /* make the interface */
     static nitf_IWriteHandler iWriteHandler = {
         &WriteHandler_write,
-        &WriteHandler_destruct
+        &WriteHandler_destruct,
+        &WriteHandler_getSize
     };
 
     /* construct the persisent one */
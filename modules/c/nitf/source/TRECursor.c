@@ -20,23 +20,26 @@
  *
  */
 
+
 #include "nitf/TRECursor.h"
 #include "nitf/TREPrivateData.h"
+#include "nitf/TREPlan.h"
+#include "nitf/LazyTRE.h"
 
 
 #define TAG_BUF_LEN 256
 
 
 
-NITFPRIV(nitf_Pair *) nitf_TRECursor_getTREPair(nitf_TRE * tre,
-                                               char *descTag,
-                                               char idx_str[10][10],
+NITFPRIV(nitf_Field *) nitf_TRECursor_getField(nitf_TRE * tre,
+                                               nitf_TREPlanRef * ref,
+                                               const int *idx,
                                                int looping,
-                                               nitf_Error * error);
+                                               nitf_Field * view);
 
 NITFPRIV(int) nitf_TRECursor_evalIf(nitf_TRE * tre,
-                                   nitf_TREDescription * desc_ptr,
-                                   char idx_str[10][10],
+                                   nitf_TREPlanEntry * entry,
+                                   const int *idx,
                                    int looping,
                                    nitf_Error * error);
 
@@ -46,33 +49,28 @@ NITFPRIV(int) nitf_TRECursor_evalIf(nitf_TRE * tre,
  */
 NITFPRIV(int) nitf_TRECursor_evalLoops(nitf_TRE * tre,
                                       nitf_TREDescription * desc_ptr,
-                                      char idx_str[10][10],
+                                      nitf_TREPlanEntry * entry,
+                                      const int *idx,
                                       int looping,
                                       nitf_Error * error);
 
 
-NITFPRIV(int) nitf_TRECursor_evalCondLength(nitf_TRE * tre,
-                                           nitf_TREDescription * desc_ptr,
-                                           char idx_str[10][10],
-                                           int looping,
-                                           nitf_Error * error);
-
-
 /*!
- *  Evaluates the given postfix expression, looking up fields in the TRE, or
- *  using constant integers.
+ *  Evaluates the postfix expression of a field's length, looking up fields
+ *  in the TRE, or using constant integers.  The expression was split into
+ *  tokens when the description was compiled.
  *
  *  \param tre      The TRE to use
- *  \param idx      The loop index/values
+ *  \param entry    The plan entry of the field
+ *  \param idx      The loop indexes
  *  \param looping  The current loop level
- *  \param expression The postfix expression
  *  \param error The error to populate on failure
- *  \return NITF_SUCCESS on sucess or NITF_FAILURE otherwise
+ *  \return The value, or -1 on failure
  */
 NITFPRIV(int) nitf_TRECursor_evaluatePostfix(nitf_TRE *tre,
-                                             char idx[10][10],
+                                             nitf_TREPlanEntry *entry,
+                                             const int *idx,
                                              int looping,
-                                             char *expression,
                                              nitf_Error *error);
 
 typedef unsigned int (*NITF_TRE_CURSOR_COUNT_FUNCTION) (nitf_TRE *,
@@ -96,23 +94,24 @@ NITFAPI(nitf_TRECursor) nitf_TRECursor_begin(nitf_TRE * tre)
     tre_cursor.looping = 0;
     /* init the pointers */
     tre_cursor.end_ptr = NULL;
+    tre_cursor.plan = NULL;
     tre_cursor.prev_ptr = NULL;
     tre_cursor.desc_ptr = NULL;
 
+    /* a deferred TRE has no description until it is parsed */
+    if (tre && !nitf_LazyTRE_realize(tre, &error))
+        tre = NULL;
+
     if (tre)
     {
         /* set the start index */
         tre_cursor.index = -1;
-        /* count how many descriptions there are */
+        /* find the compiled description, which counts the items */
 		dptr = ((nitf_TREPrivateData*)tre->priv)->description;
+        tre_cursor.plan =
+            nitf_TREPlan_get(dptr, &tre_cursor.numItems, &error);
 
-        while (dptr && (dptr->data_type != NITF_END))
-        {
-            tre_cursor.numItems++;
-            dptr++;
-        }
-        tre_cursor.end_ptr = dptr;
-        memset(tre_cursor.tag_str, 0, TAG_BUF_LEN);
+        tre_cursor.end_ptr = dptr + tre_cursor.numItems;
 		NITF_SNPRINTF(tre_cursor.tag_str, TAG_BUF_LEN, "%s",
 		        ((nitf_TREPrivateData*)tre->priv)->description->tag);
         tre_cursor.tre = tre;
@@ -133,6 +132,7 @@ NITFAPI(nitf_TRECursor) nitf_TRECursor_clone(nitf_TRECursor *tre_cursor,
     cursor.loop_rtn = nitf_IntStack_clone(tre_cursor->loop_rtn, error);
     cursor.tre = tre_cursor->tre;
     cursor.end_ptr = tre_cursor->end_ptr;
+    cursor.plan = tre_cursor->plan;
 
     cursor.prev_ptr = tre_cursor->prev_ptr;
     cursor.desc_ptr = tre_cursor->desc_ptr;
@@ -143,65 +143,109 @@ NITFAPI(nitf_TRECursor) nitf_TRECursor_clone(nitf_TRECursor *tre_cursor,
 
 
 /*!
- * Normalizes the tag, which could be in a loop, and returns the nitf_Pair* from
- * the TRE hash that corresponds to the current normalized tag.
+ * Writes the tag, qualified with the indexes of the first depth loops,
+ * as in "TAG[1][0]", into tag_str.
  */
-NITFPRIV(nitf_Pair *) nitf_TRECursor_getTREPair(nitf_TRE * tre,
-                                                char *descTag,
-                                                char idx_str[10][10],
-                                                int looping, nitf_Error * error)
+NITFPRIV(void) nitf_TRECursor_qualify(char *tag_str,
+                                      const char *tag,
+                                      const int *idx,
+                                      int depth)
 {
-    /* temp buf used for storing the qualified tag */
-    char tag_str[TAG_BUF_LEN];         
-
-    /* pointer for brace position */
-    char *bracePtr;             
+    char digits[16];
+    size_t pos = 0;
+    size_t n;
+    unsigned int value;
+    int i;
 
-    /* used as in iterator */
-    int index = 0;
+    while (*tag && pos < TAG_BUF_LEN - 1)
+        tag_str[pos++] = *tag++;
 
-    /* temp used for looping */
-    int i;                      
+    for (i = 0; i < depth; ++i)
+    {
+        n = 0;
+        value = (unsigned int) idx[i];
+        do
+        {
+            digits[n++] = (char) ('0' + value % 10);
+            value /= 10;
+        }
+        while (value);
+
+        if (pos + n + 2 > TAG_BUF_LEN - 1)
+            break;
+        tag_str[pos++] = '[';
+        while (n)
+            tag_str[pos++] = digits[--n];
+        tag_str[pos++] = ']';
+    }
+    tag_str[pos] = 0;
+}
 
-    /* the pair to return */
-    nitf_Pair *pair = NULL;
 
-    strncpy(tag_str, descTag, sizeof(tag_str));
+/*!
+ * Finds the entry of the field a reference is to, or -1.
+ */
+NITFPRIV(int) nitf_TRECursor_findRef(nitf_TREFieldStore * fields,
+                                     nitf_TREPlanRef * ref,
+                                     const int *idx,
+                                     int looping)
+{
+    int n = -1;
+    int depth;
 
-    /* deal with braces */
-    if (strchr(descTag, '['))
+    if (ref->depth >= 0)
     {
-        index = 0;
-        bracePtr = descTag;
-        /* split the string */
-        *(strchr(tag_str, '[')) = 0;
-        bracePtr--;
-        while ((bracePtr = strchr(bracePtr + 1, '[')) != NULL)
-        {
-            /* tack on the depth */
-            strcat(tag_str, idx_str[index++]);
-        }
+        /* the plan knows which loop the field is in */
+        if (ref->depth > looping)
+            return -1;
+        n = nitf_TREFieldStore_find(fields, ref->tag, idx, ref->depth);
     }
     else
     {
         /* it is dependent on something in another loop,
          * so, we need to figure out what level.
-         * since tags are unique, we are ok checking like this 
+         * since tags are unique, we are ok checking like this
          */
-        pair = nitf_HashTable_find(
-                ((nitf_TREPrivateData*)tre->priv)->hash, tag_str);
-        for (i = 0; i < looping && !pair; ++i)
-        {
-            strcat(tag_str, idx_str[i]);
-            pair = nitf_HashTable_find(
-                    ((nitf_TREPrivateData*)tre->priv)->hash, tag_str);
-        }
+        for (depth = 0; depth <= looping && n < 0; ++depth)
+            n = nitf_TREFieldStore_find(fields, ref->tag, idx, depth);
     }
+    return n;
+}
 
-    /* pull the data from the hash about the dependent loop value */
-    pair = nitf_HashTable_find(((nitf_TREPrivateData*)tre->priv)->hash,
-                               tag_str);
-    return pair;
+
+/*!
+ * Finds the field a description refers to, which could be in a loop.
+ * A field that has not been constructed is returned in the view.
+ */
+NITFPRIV(nitf_Field *) nitf_TRECursor_getField(nitf_TRE * tre,
+                                               nitf_TREPlanRef * ref,
+                                               const int *idx,
+                                               int looping,
+                                               nitf_Field * view)
+{
+    nitf_TREPrivateData *priv = (nitf_TREPrivateData*)tre->priv;
+    nitf_TREFieldStore *fields = priv->fields;
+    nitf_Error error;
+    int n;
+
+    if (!ref->tag)
+        return NULL;
+
+    /* a field in the fixed section is found by its entry number */
+    if (ref->entry >= 0 && (nitf_Uint32) ref->entry < fields->numEntries &&
+        fields->entries[ref->entry].depth == 0 &&
+        fields->entries[ref->entry].tag == priv->description[ref->entry].tag)
+    {
+        return nitf_TREFieldStore_view(fields, ref->entry, view);
+    }
+
+    n = nitf_TRECursor_findRef(fields, ref, idx, looping);
+
+    /* a handler that parses the TRE itself may have put it in the hash */
+    if (n < 0 && nitf_TREPrivateData_sync(priv, &error))
+        n = nitf_TRECursor_findRef(fields, ref, idx, looping);
+
+    return n >= 0 ? nitf_TREFieldStore_view(fields, n, view) : NULL;
 }
 
 
@@ -231,24 +275,42 @@ NITFAPI(NITF_BOOL) nitf_TRECursor_isDone(nitf_TRECursor * tre_cursor)
     return isDone;
 }
 
+NITFPROT(int) nitf_TRECursor_skipFixed(nitf_TRECursor * tre_cursor)
+{
+    nitf_TREDescription *dptr;
+    int numFixed;
+
+    if (!tre_cursor->plan || tre_cursor->index != -1 ||
+        tre_cursor->plan->numFixed == 0)
+        return 0;
+
+    numFixed = tre_cursor->plan->numFixed;
+    dptr = ((nitf_TREPrivateData*)tre_cursor->tre->priv)->description;
+
+    /* the fixed section is never in a loop, so only the position moves */
+    tre_cursor->index = numFixed - 1;
+    tre_cursor->prev_ptr = numFixed > 1 ? &dptr[numFixed - 2] : NULL;
+    tre_cursor->desc_ptr = &dptr[numFixed - 1];
+    tre_cursor->length = tre_cursor->desc_ptr->data_count;
+    nitf_TRECursor_qualify(tre_cursor->tag_str, tre_cursor->desc_ptr->tag,
+                           NULL, 0);
+    return numFixed;
+}
+
+
 NITFAPI(int) nitf_TRECursor_iterate(nitf_TRECursor * tre_cursor,
                                     nitf_Error * error)
 {
     nitf_TREDescription *dptr;
-
-    int *stack;                 /* used for in conjuction with the stacks */
-    int index;                  /* used for in conjuction with the stacks */
+    nitf_TREPlanEntry *entry;   /* the compiled description item */
+    int *idx;                   /* the indexes for each level of loops */
 
     int loopCount = 0;          /* tells how many times to loop */
     int loop_rtni = 0;          /* used for temp storage */
     int loop_idxi = 0;          /* used for temp storage */
 
-    int numIfs = 0;             /* used to keep track of nested Ifs */
-    int numLoops = 0;           /* used to keep track of nested Loops */
     int done = 0;               /* flag used for special cases */
 
-    char idx_str[10][10];       /* used for keeping track of indexes */
-
     if (!tre_cursor->loop || !tre_cursor->loop_idx
         || !tre_cursor->loop_rtn)
     {
@@ -258,7 +320,12 @@ NITFAPI(int) nitf_TRECursor_iterate(nitf_TRECursor * tre_cursor,
         return NITF_FAILURE;
     }
 
-    /* count how many descriptions there are */
+    if (!tre_cursor->plan)
+    {
+        nitf_Error_init(error, "The TRE description could not be compiled",
+                        NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        return NITF_FAILURE;
+    }
 
 	dptr = ((nitf_TREPrivateData*)tre_cursor->tre->priv)->description;
 
@@ -271,24 +338,18 @@ NITFAPI(int) nitf_TRECursor_iterate(nitf_TRECursor * tre_cursor,
 
         if (tre_cursor->index < tre_cursor->numItems)
         {
-            memset(tre_cursor->tag_str, 0, TAG_BUF_LEN);
+            tre_cursor->tag_str[0] = 0;
 
             tre_cursor->prev_ptr = tre_cursor->desc_ptr;
             tre_cursor->desc_ptr = &dptr[tre_cursor->index];
 
-            /* if already in a loop, prepare the array of values */
-            if (tre_cursor->looping)
-            {
-                stack = tre_cursor->loop_idx->st;
-                /* assert, because we only prepare for 10 */
-                assert(tre_cursor->looping <= 10);
+            /* a description with nothing to compile has no entries */
+            entry = tre_cursor->plan->entries ?
+                &tre_cursor->plan->entries[tre_cursor->index] : NULL;
 
-                for (index = 0; index < tre_cursor->looping; index++)
-                {
-                    NITF_SNPRINTF(idx_str[index], TAG_BUF_LEN,
-                                  "[%d]", stack[index]);
-                }
-            }
+            /* assert, because we only prepare for 10 */
+            assert(tre_cursor->looping <= 10);
+            idx = tre_cursor->loop_idx->st;
 
             /* check if it is an actual item now */
             /* ASCII string */
@@ -298,19 +359,10 @@ NITFAPI(int) nitf_TRECursor_iterate(nitf_TRECursor * tre_cursor,
                     /* raw bytes */
                     (tre_cursor->desc_ptr->data_type == NITF_BINARY))
             {
-                NITF_SNPRINTF(tre_cursor->tag_str, TAG_BUF_LEN, "%s",
-                        tre_cursor->desc_ptr->tag);
-                /* check if data is part of an array */
-                if (tre_cursor->looping)
-                {
-                    stack = tre_cursor->loop_idx->st;
-                    for (index = 0; index < tre_cursor->looping; index++)
-                    {
-                        char entry[64];
-                        NITF_SNPRINTF(entry, 64, "[%d]", stack[index]);
-                        strcat(tre_cursor->tag_str, entry);
-                    }
-                }
+                /* qualify the tag if the data is part of an array */
+                nitf_TRECursor_qualify(tre_cursor->tag_str,
+                                       tre_cursor->desc_ptr->tag,
+                                       idx, tre_cursor->looping);
 
                 /* check to see if we don't know the length */
                 if (tre_cursor->desc_ptr->data_count ==
@@ -320,12 +372,12 @@ NITFAPI(int) nitf_TRECursor_iterate(nitf_TRECursor * tre_cursor,
                     if (tre_cursor->desc_ptr->special)
                     {
                         /* evaluate the special string as a postfix expression */
-                        tre_cursor->length = 
+                        tre_cursor->length =
                             nitf_TRECursor_evaluatePostfix(
-                                tre_cursor->tre, 
-                                idx_str, 
+                                tre_cursor->tre,
+                                entry,
+                                idx,
                                 tre_cursor->looping,
-                                tre_cursor->desc_ptr->special, 
                                 error);
 
                         if (tre_cursor->length < 0)
@@ -366,7 +418,7 @@ NITFAPI(int) nitf_TRECursor_iterate(nitf_TRECursor * tre_cursor,
                 {
                     loopCount =
                         nitf_TRECursor_evalLoops(tre_cursor->tre,
-                                       tre_cursor->desc_ptr, idx_str,
+                                       tre_cursor->desc_ptr, entry, idx,
                                        tre_cursor->looping, error);
                     if (loopCount > 0)
                     {
@@ -382,21 +434,11 @@ NITFAPI(int) nitf_TRECursor_iterate(nitf_TRECursor * tre_cursor,
                     }
                     else
                     {
-                        numLoops = 1;
-                        /* skip until we see the matching ENDLOOP */
-                        while (numLoops
-                                && (++tre_cursor->index <
-                                    tre_cursor->numItems))
-                        {
-                            tre_cursor->desc_ptr =
-                                &dptr[tre_cursor->index];
-                            if (tre_cursor->desc_ptr->data_type ==
-                                    NITF_LOOP)
-                                numLoops++;
-                            else if (tre_cursor->desc_ptr->data_type ==
-                                     NITF_ENDLOOP)
-                                numLoops--;
-                        }
+                        /* skip to the matching ENDLOOP */
+                        tre_cursor->index = entry->end;
+                        tre_cursor->desc_ptr = &dptr[
+                            entry->end < tre_cursor->numItems ?
+                            entry->end : tre_cursor->numItems - 1];
                     }
                 }
                 /* end of a loop */
@@ -434,25 +476,16 @@ NITFAPI(int) nitf_TRECursor_iterate(nitf_TRECursor * tre_cursor,
                 else if (tre_cursor->desc_ptr->data_type == NITF_IF)
                 {
                     if (!nitf_TRECursor_evalIf
-                            (tre_cursor->tre, 
-                             tre_cursor->desc_ptr, 
-                             idx_str,
+                            (tre_cursor->tre,
+                             entry,
+                             idx,
                              tre_cursor->looping, error))
                     {
-                        numIfs = 1;
-                        /* skip until we see the matching ENDIF */
-                        while (numIfs
-                                && (++tre_cursor->index <
-                                    tre_cursor->numItems))
-                        {
-                            tre_cursor->desc_ptr =
-                                &dptr[tre_cursor->index];
-                            if (tre_cursor->desc_ptr->data_type == NITF_IF)
-                                numIfs++;
-                            else if (tre_cursor->desc_ptr->data_type ==
-                                     NITF_ENDIF)
-                                numIfs--;
-                        }
+                        /* skip to the matching ENDIF */
+                        tre_cursor->index = entry->end;
+                        tre_cursor->desc_ptr = &dptr[
+                            entry->end < tre_cursor->numItems ?
+                            entry->end : tre_cursor->numItems - 1];
                     }
                 }
             }
@@ -479,34 +512,32 @@ NITFAPI(int) nitf_TRECursor_iterate(nitf_TRECursor * tre_cursor,
  */
 NITFPRIV(int) nitf_TRECursor_evalLoops(nitf_TRE* tre,
                                       nitf_TREDescription* desc_ptr,
-                                      char idx_str[10][10],
+                                      nitf_TREPlanEntry* entry,
+                                      const int *idx,
                                       int looping, nitf_Error* error)
 {
     int loops;
-
-    /* temp buf used for manipulating the loop label */
-    char str[TAG_BUF_LEN];   
-
-    nitf_Pair *pair;
     nitf_Field *field;
-
-    char *op;
-    char *valPtr;
-    
-    /* used for the possible data in the loop label */
-    int loopVal;
+    nitf_Field view;
 
     /* if the user wants a constant value */
-    if (desc_ptr->label && strcmp(desc_ptr->label, NITF_CONST_N) == 0)
+    if (entry->kind == NITF_TRE_PLAN_CONST)
     {
-        loops = NITF_ATO32(desc_ptr->tag);
+        loops = entry->value;
     }
 
-    else if (desc_ptr->label && strcmp(desc_ptr->label, NITF_FUNCTION) == 0)
+    else if (entry->kind == NITF_TRE_PLAN_FUNCTION)
     {
         NITF_TRE_CURSOR_COUNT_FUNCTION fn =
             (NITF_TRE_CURSOR_COUNT_FUNCTION)desc_ptr->tag;
 
+        /* the function is given the indexes as strings */
+        char idx_str[10][10];
+        int i;
+        for (i = 0; i < looping; i++)
+        {
+            NITF_SNPRINTF(idx_str[i], sizeof(idx_str[i]), "[%d]", idx[i]);
+        }
 
         loops = (*fn)(tre, idx_str, looping, error);
 
@@ -516,16 +547,15 @@ NITFPRIV(int) nitf_TRECursor_evalLoops(nitf_TRE* tre,
 
     else
     {
-        pair = nitf_TRECursor_getTREPair(tre, desc_ptr->tag,
-                                         idx_str, looping, error);
-        if (!pair)
+        field = nitf_TRECursor_getField(tre, &entry->ref, idx, looping,
+                                        &view);
+        if (!field)
         {
             nitf_Error_init(error,
                             "nitf_TRECursor_evalLoops: invalid TRE loop counter",
                             NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
             return NITF_FAILURE;
         }
-        field = (nitf_Field *) pair->data;
 
         /* get the int value */
         if (!nitf_Field_get
@@ -534,62 +564,40 @@ NITFPRIV(int) nitf_TRECursor_evalLoops(nitf_TRE* tre,
             return NITF_FAILURE;
         }
 
-        /* if the label is not empty, then apply some functionality */
-        if (desc_ptr->label && strlen(desc_ptr->label) != 0)
+        /* if the label had an operator, apply it */
+        switch (entry->op)
         {
-            assert(strlen(desc_ptr->label) < sizeof(str));
-
-            strcpy(str, desc_ptr->label);
-            op = str;
-            while (isspace(*op))
-                op++;
-
-            if ((*op == '+') ||
-                    (*op == '-') ||
-                    (*op == '*') || (*op == '/') || (*op == '%'))
-            {
-                valPtr = op + 1;
-                while (isspace(*valPtr))
-                    valPtr++;
-
-                loopVal = NITF_ATO32(valPtr);
-
-                switch (*op)
+            case 0:
+                break;
+            case '+':
+                loops += entry->value;
+                break;
+            case '-':
+                loops -= entry->value;
+                break;
+            case '*':
+                loops *= entry->value;
+                break;
+            case '/':
+            case '%':
+                /* check for divide by zero */
+                if (entry->value == 0)
                 {
-                    case '+':
-                        loops += loopVal;
-                        break;
-                    case '-':
-                        loops -= loopVal;
-                        break;
-                    case '*':
-                        loops *= loopVal;
-                        break;
-                    case '/':
-                        /* check for divide by zero */
-                        if (loopVal == 0)
-                        {
-                            nitf_Error_init(error,
-                                            "nitf_TRECursor_evalLoops: attempt to divide by zero",
-                                            NITF_CTXT,
-                                            NITF_ERR_INVALID_PARAMETER);
-                            return NITF_FAILURE;
-                        }
-                        loops /= loopVal;
-                        break;
-                    case '%':
-                        loops %= loopVal;
-                        break;
-                    default:
-                        break;
+                    nitf_Error_init(error,
+                                    "nitf_TRECursor_evalLoops: attempt to divide by zero",
+                                    NITF_CTXT,
+                                    NITF_ERR_INVALID_PARAMETER);
+                    return NITF_FAILURE;
                 }
-            }
-            else
-            {
+                if (entry->op == '/')
+                    loops /= entry->value;
+                else
+                    loops %= entry->value;
+                break;
+            default:
                 nitf_Error_init(error, "nitf_TRECursor_evalLoops: invalid operator",
                                 NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
                 return NITF_FAILURE;
-            }
         }
     }
     return loops < 0 ? 0 : loops;
@@ -597,62 +605,34 @@ NITFPRIV(int) nitf_TRECursor_evalLoops(nitf_TRE* tre,
 
 
 NITFPRIV(int) nitf_TRECursor_evalIf(nitf_TRE* tre,
-                                   nitf_TREDescription* desc_ptr,
-                                   char idx_str[10][10],
-                                   int looping, 
+                                   nitf_TREPlanEntry* entry,
+                                   const int *idx,
+                                   int looping,
                                    nitf_Error* error)
 {
     nitf_Field *field;
-    nitf_Pair *pair;
-
-    /* temp buf for the label */
-    char str[TAG_BUF_LEN];      
-    char *emptyPtr;
-    char *op;
-    char *valPtr;
+    nitf_Field view;
 
     /* the return status */
     int status = 0;
 
     /* used as the value for comparing */
     int fieldData;
-    
-    /* the value defined int the TRE descrip */
-    int treData;
 
     /* the bit-field for comparing */
     unsigned int bitFieldData;
 
-    /* the bit-field defined in the TRE descrip */
-    unsigned int treBitField;
-
-    /* get the data out of the hashtable */
-    pair = nitf_TRECursor_getTREPair(tre, desc_ptr->tag, idx_str, 
-                                     looping, error);
-    if (!pair)
+    /* get the data out of the TRE */
+    field = nitf_TRECursor_getField(tre, &entry->ref, idx, looping, &view);
+    if (!field)
     {
         nitf_Error_init(error, "Unable to find tag in TRE hash",
                         NITF_CTXT, NITF_ERR_UNK);
         return NITF_FAILURE;
     }
-    field = (nitf_Field *) pair->data;
-    assert(strlen(desc_ptr->label) < sizeof(str));
-
-    strcpy(str, desc_ptr->label);
-    op = str;
-
-    while (isspace(*op))
-        op++;
-
-    /* split the string at the space */
-    emptyPtr = strchr(op, ' ');
-    *emptyPtr = 0;
-
-    /* remember where the operand is */
-    valPtr = emptyPtr + 1;
 
     /* check if it is a string comparison of either 'eq' or 'ne' */
-    if ((strcmp(op, "eq") == 0) || (strcmp(op, "ne") == 0))
+    if (entry->op == 'e' || entry->op == 'n')
     {
         /* must be a string */
         if (field->type == NITF_BCS_N)
@@ -662,15 +642,13 @@ NITFPRIV(int) nitf_TRECursor_evalIf(nitf_TRE* tre,
                             NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
             return NITF_FAILURE;
         }
-        status = strncmp(field->raw, valPtr, field->length);
-        status = strcmp(op, "eq") == 0 ? !status : status;
+        status = strncmp(field->raw, entry->string, field->length);
+        status = entry->op == 'e' ? !status : status;
     }
     /* check if it is a logical operator for ints */
-    else if ((strcmp(op, "<") == 0) ||
-             (strcmp(op, ">") == 0) ||
-             (strcmp(op, ">=") == 0) ||
-             (strcmp(op, "<=") == 0) ||
-             (strcmp(op, "==") == 0) || (strcmp(op, "!=") == 0))
+    else if (entry->op == '<' || entry->op == '>' ||
+             entry->op == 'G' || entry->op == 'L' ||
+             entry->op == '=' || entry->op == '!')
     {
         /* make sure it is a number */
         if (field->type != NITF_BCS_N)
@@ -681,7 +659,6 @@ NITFPRIV(int) nitf_TRECursor_evalIf(nitf_TRE* tre,
             return NITF_FAILURE;
         }
 
-        treData = NITF_ATO32(valPtr);
         if (!nitf_Field_get
                 (field, (char *) &fieldData, NITF_CONV_INT, sizeof(fieldData),
                  error))
@@ -690,23 +667,23 @@ NITFPRIV(int) nitf_TRECursor_evalIf(nitf_TRE* tre,
         }
 
         /* 0 -> equal, <0 -> less true, >0 greater true */
-        status = fieldData - treData;
+        status = fieldData - entry->value;
 
-        if (strcmp(op, ">") == 0)
+        if (entry->op == '>')
             status = (status > 0);
-        else if (strcmp(op, "<") == 0)
+        else if (entry->op == '<')
             status = (status < 0);
-        else if (strcmp(op, ">=") == 0)
+        else if (entry->op == 'G')
             status = (status >= 0);
-        else if (strcmp(op, "<=") == 0)
+        else if (entry->op == 'L')
             status = (status <= 0);
-        else if (strcmp(op, "==") == 0)
+        else if (entry->op == '=')
             status = (status == 0);
-        else if (strcmp(op, "!=") == 0)
+        else
             status = (status != 0);
     }
     /* check if it is a bit-wise operator */
-    else if (strcmp(op, "&") == 0)
+    else if (entry->op == '&')
     {
         /* make sure it is a binary field */
         if (field->type != NITF_BINARY)
@@ -718,7 +695,6 @@ NITFPRIV(int) nitf_TRECursor_evalIf(nitf_TRE* tre,
             return NITF_FAILURE;
         }
 
-        treBitField = NITF_ATOU32_BASE(valPtr, 0);
         if (!nitf_Field_get(field,
                             (char *)&bitFieldData,
                             NITF_CONV_UINT,
@@ -729,7 +705,7 @@ NITFPRIV(int) nitf_TRECursor_evalIf(nitf_TRE* tre,
         }
 
         /* check this bit field */
-        status = ((treBitField & bitFieldData) != 0);
+        status = (((unsigned int) entry->value & bitFieldData) != 0);
     }
     /* otherwise, they used a bad operator */
     else
@@ -742,234 +718,105 @@ NITFPRIV(int) nitf_TRECursor_evalIf(nitf_TRE* tre,
 }
 
 
-
-/**
- * Helper function for evaluating loops
- * Returns the number of loops that will be processed
- */
-NITFPRIV(int) nitf_TRECursor_evalCondLength(nitf_TRE* tre,
-                                           nitf_TREDescription* desc_ptr,
-                                           char idx_str[10][10],
-                                           int looping, 
-                                           nitf_Error* error)
-{
-    int computedLength;
-    /* temp buf used for manipulating the loop label */
-    char str[TAG_BUF_LEN];      
-    nitf_Pair *pair;
-    nitf_Field *field;
-
-    char *op;
-    char *valPtr;
-
-    /* used for the possible data in the description label */
-    int funcVal;
-
-    pair = nitf_TRECursor_getTREPair(tre, desc_ptr->tag, 
-                                     idx_str, looping, error);
-    if (!pair)
-    {
-        nitf_Error_init(error,
-                        "nitf_TRECursor_evalCondLength: invalid TRE reference",
-                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-        return NITF_FAILURE;
-    }
-    field = (nitf_Field *) pair->data;
-
-    /* get the int value */
-    if (!nitf_Field_get
-            (field, (char *) &computedLength, NITF_CONV_INT,
-             sizeof(computedLength), error))
-    {
-        return NITF_FAILURE;
-    }
-
-    /* if the label is not empty, then apply some functionality */
-    if (desc_ptr->label && strlen(desc_ptr->label) != 0)
-    {
-        assert(strlen(desc_ptr->label) < sizeof(str));
-
-        strcpy(str, desc_ptr->label);
-        op = str;
-        while (isspace(*op))
-            op++;
-        if ((*op == '+') ||
-                (*op == '-') || (*op == '*') || (*op == '/') || (*op == '%'))
-        {
-            valPtr = op + 1;
-            while (isspace(*valPtr))
-                valPtr++;
-
-            funcVal = NITF_ATO32(valPtr);
-
-            switch (*op)
-            {
-                case '+':
-                    computedLength += funcVal;
-                    break;
-                case '-':
-                    computedLength -= funcVal;
-                    break;
-                case '*':
-                    computedLength *= funcVal;
-                    break;
-                case '/':
-                    /* check for divide by zero */
-                    if (funcVal == 0)
-                    {
-                        nitf_Error_init(error,
-                                        "nitf_TRECursor_evalCondLength: attempt to divide by zero",
-                                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-                        return NITF_FAILURE;
-                    }
-                    computedLength /= funcVal;
-                    break;
-                case '%':
-                    computedLength %= funcVal;
-                    break;
-                default:
-                    break;
-            }
-        }
-        else
-        {
-            nitf_Error_init(error,
-                            "nitf_TRECursor_evalCondLength: invalid operator",
-                            NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-            return NITF_FAILURE;
-        }
-    }
-    return computedLength < 0 ? 0 : computedLength;
-}
-
 NITFPRIV(int) nitf_TRECursor_evaluatePostfix(nitf_TRE *tre,
-                                             char idx[10][10],
+                                             nitf_TREPlanEntry *entry,
+                                             const int *idx,
                                              int looping,
-                                             char *expression,
                                              nitf_Error *error)
 {
-    nitf_List *parts = NULL;
-    nitf_IntStack *stack = NULL;
-    int expressionValue;
-
-    /* create the postfix stack */
-    stack = nitf_IntStack_construct(error);
-    if (!stack)
-        goto CATCH_ERROR;
-
-    /* split the expression by spaces */
-    parts = nitf_Utils_splitString(expression, 0, error);
-    if (!parts)
-        goto CATCH_ERROR;
+    nitf_TREPlanToken *token;
+    int stack[NITF_INT_STACK_DEPTH];
+    int depth = 0;
+    int i;
 
-    while(!nitf_List_isEmpty(parts))
+    for (i = 0; i < entry->numTokens; ++i)
     {
-        char* expr = (char*) nitf_List_popFront(parts);
-        if (strlen(expr) == 1 &&
-                (expr[0] == '+' || expr[0] == '-' || expr[0] == '*' ||
-                        expr[0] == '/' || expr[0] == '%'))
+        token = &entry->postfix[i];
+        if (token->kind == NITF_TRE_PLAN_OP)
         {
-            int op1, op2, stackSize;
-            stackSize = nitf_IntStack_depth(stack, error) + 1;
+            int op1, op2;
 
-            if (stackSize == 0)
+            if (depth == 0)
             {
                 /* error for postfix... */
                 nitf_Error_init(error,
                         "nitf_TRECursor_evaluatePostfix: invalid expression",
                         NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-                goto CATCH_ERROR;
+                return -1;
             }
 
-            op2 = nitf_IntStack_pop(stack, error);
-            if (stackSize == 1)
+            op2 = stack[--depth];
+            if (depth == 0)
                 op1 = 0; /* assume 0 for the first operand of a unary op */
             else
-                op1 = nitf_IntStack_pop(stack, error);
+                op1 = stack[--depth];
 
-            switch(expr[0])
+            switch(token->value)
             {
             case '+':
-                nitf_IntStack_push(stack, (op1 + op2), error);
+                stack[depth++] = op1 + op2;
                 break;
             case '-':
-                nitf_IntStack_push(stack, (op1 - op2), error);
+                stack[depth++] = op1 - op2;
                 break;
             case '*':
-                nitf_IntStack_push(stack, (op1 * op2), error);
+                stack[depth++] = op1 * op2;
                 break;
             case '/':
+            case '%':
                 /* check for divide by zero */
                 if (op2 == 0)
                 {
                     nitf_Error_init(error,
                             "nitf_TRECursor_evaluatePostfix: attempt to divide by zero",
                             NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-                    goto CATCH_ERROR;
+                    return -1;
                 }
-                nitf_IntStack_push(stack, (op1 / op2), error);
-                break;
-            case '%':
-                nitf_IntStack_push(stack, (op1 % op2), error);
+                stack[depth++] = token->value == '/' ? op1 / op2 : op1 % op2;
                 break;
             }
         }
+        else if (depth == NITF_INT_STACK_DEPTH)
+        {
+            nitf_Error_init(error, "Invalid postfix expression",
+                    NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+            return -1;
+        }
+        else if (token->kind == NITF_TRE_PLAN_CONST)
+        {
+            stack[depth++] = token->value;
+        }
         else
         {
-            /* evaluate as an integer and push onto the stack */
-            if (nitf_Utils_isNumeric(expr))
+            /* must be a dependent field */
+            int intVal;
+            nitf_Field view;
+            nitf_Field *field = nitf_TRECursor_getField(tre, &token->ref,
+                                                        idx, looping, &view);
+            if (!field)
             {
-                nitf_IntStack_push(stack, NITF_ATO32(expr), error);
+                nitf_Error_init(error,
+                        "nitf_TRECursor_evaluatePostfix: invalid TRE field reference",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+                return -1;
             }
-            else
-            {
-                /* must be a dependent field */
-                int intVal;
-                nitf_Field *field = NULL;
-                nitf_Pair *pair = nitf_TRECursor_getTREPair(tre, expr, idx,
-                        looping, error);
 
-                if (!pair)
-                {
-                    nitf_Error_init(error,
-                            "nitf_TRECursor_evaluatePostfix: invalid TRE field reference",
-                            NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-                    goto CATCH_ERROR;
-                }
-                field = (nitf_Field *) pair->data;
-
-                /* get the int value */
-                if (!nitf_Field_get(field, (char*) &intVal, NITF_CONV_INT,
-                         sizeof(intVal), error))
-                {
-                    goto CATCH_ERROR;
-                }
-                nitf_IntStack_push(stack, intVal, error);
+            /* get the int value */
+            if (!nitf_Field_get(field, (char*) &intVal, NITF_CONV_INT,
+                     sizeof(intVal), error))
+            {
+                return -1;
             }
+            stack[depth++] = intVal;
         }
-
-        /* must cleanup after ourselves */
-        if (expr)
-            NITF_FREE(expr);
     }
 
     /* if all is well, the postfix stack should have one value */
-    if (nitf_IntStack_depth(stack, error) != 0)
+    if (depth != 1)
     {
         nitf_Error_init(error, "Invalid postfix expression",
                 NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
-        goto CATCH_ERROR;
+        return -1;
     }
-
-    expressionValue = nitf_IntStack_pop(stack, error);
-
-    nitf_IntStack_destruct(&stack);
-    nitf_List_destruct(&parts);
-
-    return expressionValue;
-
-  CATCH_ERROR:
-    if (stack) nitf_IntStack_destruct(&stack);
-    if (parts) nitf_List_destruct(&parts);
-    return -1;
+    return stack[0];
 }
@@ -0,0 +1,650 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; if not, If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nitf/TREFieldStore.h"
+
+/*  The size of the first key table, a power of two  */
+#define NITF_TRE_FIELD_TABLE_SIZE 16
+
+/*  Loop indices have at most ten digits, and a pair of braces  */
+#define NITF_TRE_FIELD_INDEX_LEN 12
+
+
+/*  An FNV-1a hash of the tag and the loop indices  */
+NITFPRIV(nitf_Uint32) hashKey(const char *tag,
+                              size_t length,
+                              const int *idx,
+                              int depth)
+{
+    nitf_Uint32 hash = 2166136261U;
+    size_t i;
+    int j;
+
+    for (i = 0; i < length; ++i)
+    {
+        hash ^= (unsigned char) tag[i];
+        hash *= 16777619U;
+    }
+    for (j = 0; j < depth; ++j)
+    {
+        hash ^= (nitf_Uint32) idx[j];
+        hash *= 16777619U;
+    }
+    return hash ^ (nitf_Uint32) depth;
+}
+
+
+NITFPRIV(NITF_BOOL) keyMatches(nitf_TREFieldStore * store,
+                               nitf_TREFieldEntry * entry,
+                               nitf_Uint32 hash,
+                               const char *tag,
+                               size_t length,
+                               const int *idx,
+                               int depth)
+{
+    const nitf_Uint32 *indices = store->indices + entry->indices;
+    int i;
+
+    if (entry->hash != hash || entry->depth != depth)
+        return 0;
+
+    /*  the same description entry, or another with the same tag  */
+    if (entry->tag != tag && (strncmp(entry->tag, tag, length) != 0 ||
+                              entry->tag[length] != 0))
+        return 0;
+
+    for (i = 0; i < depth; ++i)
+    {
+        if (indices[i] != (nitf_Uint32) idx[i])
+            return 0;
+    }
+    return 1;
+}
+
+
+NITFPRIV(int) findKey(nitf_TREFieldStore * store,
+                      const char *tag,
+                      size_t length,
+                      const int *idx,
+                      int depth)
+{
+    nitf_Uint32 hash;
+    nitf_Uint32 mask;
+    nitf_Uint32 slot;
+    nitf_Uint32 n;
+
+    if (!store->tableSize)
+        return -1;
+
+    hash = hashKey(tag, length, idx, depth);
+    mask = store->tableSize - 1;
+    slot = hash & mask;
+    while ((n = store->table[slot]) != 0)
+    {
+        if (keyMatches(store, &store->entries[n - 1], hash,
+                       tag, length, idx, depth))
+            return (int) (n - 1);
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+
+NITFPRIV(void) insertKey(nitf_TREFieldStore * store, nitf_Uint32 n)
+{
+    nitf_Uint32 mask = store->tableSize - 1;
+    nitf_Uint32 slot = store->entries[n].hash & mask;
+
+    /*  Later fields with the same key are found after the first  */
+    while (store->table[slot] != 0)
+        slot = (slot + 1) & mask;
+    store->table[slot] = n + 1;
+}
+
+
+/*  Keep the table at most half full  */
+NITFPRIV(NITF_BOOL) growTable(nitf_TREFieldStore * store, nitf_Error * error)
+{
+    nitf_Uint32 size;
+    nitf_Uint32 *table;
+    nitf_Uint32 n;
+
+    if ((store->numEntries + 1) * 2 <= store->tableSize)
+        return NITF_SUCCESS;
+
+    size = store->tableSize ? store->tableSize * 2 : NITF_TRE_FIELD_TABLE_SIZE;
+    table = (nitf_Uint32 *) NITF_MALLOC(size * sizeof(nitf_Uint32));
+    if (!table)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+    memset(table, 0, size * sizeof(nitf_Uint32));
+
+    if (store->table)
+        NITF_FREE(store->table);
+    store->table = table;
+    store->tableSize = size;
+
+    /*  reinsert in order, so the first of any duplicates is still found  */
+    for (n = 0; n < store->numEntries; ++n)
+        insertKey(store, n);
+    return NITF_SUCCESS;
+}
+
+
+/*  Make room for count more items of the given size in an array  */
+NITFPRIV(NITF_BOOL) reserve(void **array,
+                            size_t itemSize,
+                            size_t used,
+                            size_t count,
+                            size_t *capacity,
+                            nitf_Error * error)
+{
+    size_t size;
+    void *grown;
+
+    if (used + count <= *capacity)
+        return NITF_SUCCESS;
+
+    size = *capacity ? *capacity * 2 : 16;
+    if (size < used + count)
+        size = used + count;
+
+    grown = NITF_REALLOC(*array, size * itemSize);
+    if (!grown)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+    *array = grown;
+    *capacity = size;
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(size_t) writeName(nitf_TREFieldStore * store,
+                           nitf_TREFieldEntry * entry,
+                           char *name,
+                           size_t size)
+{
+    const nitf_Uint32 *indices = store->indices + entry->indices;
+    char digits[NITF_TRE_FIELD_INDEX_LEN];
+    const char *tag = entry->tag;
+    size_t pos = 0;
+    size_t n;
+    nitf_Uint32 value;
+    int i;
+
+    if (!size)
+        return 0;
+
+    while (*tag && pos < size - 1)
+        name[pos++] = *tag++;
+
+    for (i = 0; i < entry->depth; ++i)
+    {
+        n = 0;
+        value = indices[i];
+        do
+        {
+            digits[n++] = (char) ('0' + value % 10);
+            value /= 10;
+        }
+        while (value);
+
+        if (pos + n + 2 > size - 1)
+            break;
+        name[pos++] = '[';
+        while (n)
+            name[pos++] = digits[--n];
+        name[pos++] = ']';
+    }
+    name[pos] = 0;
+    return pos;
+}
+
+
+NITFAPI(nitf_TREFieldStore *) nitf_TREFieldStore_construct(nitf_Error * error)
+{
+    nitf_TREFieldStore *store =
+        (nitf_TREFieldStore *) NITF_MALLOC(sizeof(nitf_TREFieldStore));
+    if (!store)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NULL;
+    }
+    memset(store, 0, sizeof(nitf_TREFieldStore));
+
+    /*  The fields are constructed from the arena of the record, if any  */
+    store->arena = nitf_Arena_getCurrent();
+    return store;
+}
+
+
+NITFAPI(nitf_TREFieldStore *) nitf_TREFieldStore_clone(
+        nitf_TREFieldStore * source, nitf_Error * error)
+{
+    nitf_TREFieldStore *store = NULL;
+    nitf_Field view;
+    nitf_Field *field;
+    nitf_TREFieldEntry *entry;
+    int idx[NITF_TRE_FIELD_MAX_DEPTH];
+    nitf_Uint32 n;
+    int i;
+
+    if (!source)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_OBJECT,
+                         "Trying to clone NULL pointer");
+        return NULL;
+    }
+
+    store = nitf_TREFieldStore_construct(error);
+    if (!store)
+        return NULL;
+
+    if (!reserve((void **) &store->raw, 1, 0, source->rawLength,
+                 &store->rawCapacity, error))
+        goto CATCH_ERROR;
+
+    for (n = 0; n < source->numEntries; ++n)
+    {
+        entry = &source->entries[n];
+        for (i = 0; i < entry->depth; ++i)
+            idx[i] = (int) source->indices[entry->indices + i];
+
+        /*  a field that was constructed has the current value  */
+        field = nitf_TREFieldStore_view(source, (int) n, &view);
+        if (nitf_TREFieldStore_add(store, entry->tag, idx, entry->depth,
+                                   field->type, field->raw, field->length,
+                                   error) < 0)
+            goto CATCH_ERROR;
+        store->entries[n].resizable = entry->pair ?
+            (nitf_Uint8) (field->resizable != 0) : entry->resizable;
+    }
+    return store;
+
+  CATCH_ERROR:
+    nitf_TREFieldStore_destruct(&store);
+    return NULL;
+}
+
+
+NITFAPI(void) nitf_TREFieldStore_clear(nitf_TREFieldStore * store)
+{
+    nitf_Field *field;
+    nitf_Uint32 n;
+
+    if (!store)
+        return;
+
+    for (n = 0; n < store->numEntries; ++n)
+    {
+        if (store->entries[n].pair)
+        {
+            field = (nitf_Field *) store->entries[n].pair->data;
+            nitf_Field_destruct(&field);
+            if (!store->arena)
+                NITF_FREE(store->entries[n].pair);
+        }
+    }
+    store->numEntries = 0;
+    store->numIndices = 0;
+    store->rawLength = 0;
+    if (store->table)
+        memset(store->table, 0, store->tableSize * sizeof(nitf_Uint32));
+}
+
+
+NITFAPI(void) nitf_TREFieldStore_destruct(nitf_TREFieldStore ** store)
+{
+    if (*store)
+    {
+        nitf_TREFieldStore_clear(*store);
+        if ((*store)->raw)
+            NITF_FREE((*store)->raw);
+        if ((*store)->entries)
+            NITF_FREE((*store)->entries);
+        if ((*store)->indices)
+            NITF_FREE((*store)->indices);
+        if ((*store)->table)
+            NITF_FREE((*store)->table);
+        NITF_FREE(*store);
+        *store = NULL;
+    }
+}
+
+
+NITFAPI(int) nitf_TREFieldStore_add(nitf_TREFieldStore * store,
+                                    const char *tag,
+                                    const int *idx,
+                                    int depth,
+                                    nitf_FieldType type,
+                                    const char *data,
+                                    size_t length,
+                                    nitf_Error * error)
+{
+    nitf_TREFieldEntry *entry;
+    size_t capacity;
+    char fill;
+    int i;
+
+    if (length == 0)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                         "Cannot create field of size 0");
+        return -1;
+    }
+    if (depth < 0 || depth > NITF_TRE_FIELD_MAX_DEPTH ||
+        store->rawLength + length + 1 > 0xFFFFFFFFU)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                         "Cannot add field [%s] to the TRE", tag);
+        return -1;
+    }
+
+    switch (type)
+    {
+        case NITF_BCS_A:
+            fill = ' ';
+            break;
+        case NITF_BCS_N:
+            fill = '0';
+            break;
+        case NITF_BINARY:
+            fill = 0;
+            break;
+        default:
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                             "Invalid type [%d]", type);
+            return -1;
+    }
+
+    if (!reserve((void **) &store->raw, 1, store->rawLength, length + 1,
+                 &store->rawCapacity, error))
+        return -1;
+
+    capacity = store->entryCapacity;
+    if (!reserve((void **) &store->entries, sizeof(nitf_TREFieldEntry),
+                 store->numEntries, 1, &capacity, error))
+        return -1;
+    store->entryCapacity = (nitf_Uint32) capacity;
+
+    capacity = store->indexCapacity;
+    if (!reserve((void **) &store->indices, sizeof(nitf_Uint32),
+                 store->numIndices, depth, &capacity, error))
+        return -1;
+    store->indexCapacity = (nitf_Uint32) capacity;
+
+    if (!growTable(store, error))
+        return -1;
+
+    entry = &store->entries[store->numEntries];
+    entry->tag = tag;
+    entry->hash = hashKey(tag, strlen(tag), idx, depth);
+    entry->offset = (nitf_Uint32) store->rawLength;
+    entry->length = (nitf_Uint32) length;
+    entry->indices = store->numIndices;
+    entry->depth = (nitf_Uint8) depth;
+    entry->type = (nitf_Uint8) type;
+    entry->resizable = 0;
+    entry->pair = NULL;
+
+    if (data)
+        memcpy(store->raw + store->rawLength, data, length);
+    else
+        memset(store->raw + store->rawLength, fill, length);
+    store->raw[store->rawLength + length] = 0;
+    store->rawLength += length + 1;
+
+    for (i = 0; i < depth; ++i)
+        store->indices[store->numIndices++] = (nitf_Uint32) idx[i];
+
+    insertKey(store, store->numEntries);
+    return (int) store->numEntries++;
+}
+
+
+NITFAPI(int) nitf_TREFieldStore_find(nitf_TREFieldStore * store,
+                                     const char *tag,
+                                     const int *idx,
+                                     int depth)
+{
+    if (!store || !tag)
+        return -1;
+    return findKey(store, tag, strlen(tag), idx, depth);
+}
+
+
+/*
+ *  Split a qualified name into its tag length and loop indices.  Only the
+ *  names the cursor makes can be split: "TAG[1][20]"
+ */
+NITFPRIV(NITF_BOOL) parseName(const char *name,
+                              size_t *length,
+                              int *idx,
+                              int *depth)
+{
+    const char *brace;
+    const char *cur;
+    nitf_Uint32 value;
+    int digits;
+
+    *depth = 0;
+    brace = strchr(name, '[');
+    if (!brace)
+    {
+        *length = strlen(name);
+        return NITF_SUCCESS;
+    }
+    *length = brace - name;
+
+    cur = brace;
+    while (*cur)
+    {
+        if (*cur++ != '[' || *depth == NITF_TRE_FIELD_MAX_DEPTH)
+            return NITF_FAILURE;
+
+        value = 0;
+        digits = 0;
+        while (isdigit((unsigned char) *cur))
+        {
+            if ((digits > 0 && value == 0) || digits == 9)
+                return NITF_FAILURE;
+            value = value * 10 + (nitf_Uint32) (*cur++ - '0');
+            digits++;
+        }
+        if (!digits || *cur++ != ']')
+            return NITF_FAILURE;
+        idx[(*depth)++] = (int) value;
+    }
+    return NITF_SUCCESS;
+}
+
+
+NITFAPI(int) nitf_TREFieldStore_findName(nitf_TREFieldStore * store,
+                                         const char *name)
+{
+    int idx[NITF_TRE_FIELD_MAX_DEPTH];
+    int depth;
+    size_t length;
+
+    if (!store || !name || !parseName(name, &length, idx, &depth))
+        return -1;
+    return findKey(store, name, length, idx, depth);
+}
+
+
+NITFAPI(nitf_Field *) nitf_TREFieldStore_view(nitf_TREFieldStore * store,
+                                              int n,
+                                              nitf_Field * view)
+{
+    nitf_TREFieldEntry *entry = &store->entries[n];
+
+    if (entry->pair)
+        return (nitf_Field *) entry->pair->data;
+
+    view->type = (nitf_FieldType) entry->type;
+    view->raw = store->raw + entry->offset;
+    view->length = entry->length;
+    view->resizable = 0;
+    view->pooled = 0;
+    return view;
+}
+
+
+/*  Make the pair of an entry, with the name following it  */
+NITFPRIV(nitf_Pair *) makePair(nitf_TREFieldStore * store,
+                               nitf_TREFieldEntry * entry,
+                               nitf_Field * field,
+                               nitf_Error * error)
+{
+    nitf_Pair *pair;
+    size_t size;
+
+    size = strlen(entry->tag) + entry->depth * NITF_TRE_FIELD_INDEX_LEN + 1;
+    if (store->arena)
+        pair = (nitf_Pair *) nitf_Arena_alloc(store->arena,
+                                              sizeof(nitf_Pair) + size);
+    else
+        pair = (nitf_Pair *) NITF_MALLOC(sizeof(nitf_Pair) + size);
+    if (!pair)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NULL;
+    }
+    pair->key = (char *) (pair + 1);
+    writeName(store, entry, pair->key, size);
+    pair->data = field;
+
+    entry->pair = pair;
+    return pair;
+}
+
+
+NITFAPI(nitf_Pair *) nitf_TREFieldStore_getPair(nitf_TREFieldStore * store,
+                                                int n,
+                                                nitf_Error * error)
+{
+    nitf_TREFieldEntry *entry = &store->entries[n];
+    nitf_Field *field = NULL;
+    nitf_Arena *arena;
+
+    if (entry->pair)
+        return entry->pair;
+
+    /*  The field comes from the arena of the store, not the current one  */
+    arena = nitf_Arena_setCurrent(store->arena);
+    field = nitf_Field_construct(entry->length,
+                                 (nitf_FieldType) entry->type, error);
+    nitf_Arena_setCurrent(arena);
+    if (!field)
+        return NULL;
+    memcpy(field->raw, store->raw + entry->offset, entry->length);
+    field->resizable = entry->resizable;
+
+    if (!makePair(store, entry, field, error))
+    {
+        nitf_Field_destruct(&field);
+        return NULL;
+    }
+    return entry->pair;
+}
+
+
+NITFAPI(int) nitf_TREFieldStore_adopt(nitf_TREFieldStore * store,
+                                      const char *tag,
+                                      const char *name,
+                                      nitf_Field * field,
+                                      nitf_Error * error)
+{
+    int idx[NITF_TRE_FIELD_MAX_DEPTH];
+    int depth;
+    size_t length;
+    nitf_TREFieldEntry *entry;
+    nitf_Field *old;
+    int n;
+
+    if (!parseName(name, &length, idx, &depth))
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                         "Invalid field name [%s]", name);
+        return -1;
+    }
+
+    n = findKey(store, name, length, idx, depth);
+    if (n < 0)
+    {
+        n = nitf_TREFieldStore_add(store, tag, idx, depth, field->type,
+                                   field->raw, field->length, error);
+        if (n < 0)
+            return -1;
+    }
+
+    entry = &store->entries[n];
+    if (!entry->pair)
+        return makePair(store, entry, field, error) ? n : -1;
+
+    /*  the field replaces the one that was constructed  */
+    old = (nitf_Field *) entry->pair->data;
+    if (old != field)
+    {
+        nitf_Field_destruct(&old);
+        entry->pair->data = field;
+    }
+    return n;
+}
+
+
+NITFAPI(NITF_BOOL) nitf_TREFieldStore_set(nitf_TREFieldStore * store,
+                                          int n,
+                                          NITF_DATA * data,
+                                          size_t dataLength,
+                                          nitf_Error * error)
+{
+    nitf_TREFieldEntry *entry = &store->entries[n];
+    nitf_Field view;
+
+    /*  a field that can change length can not stay in the raw buffer  */
+    if (!entry->pair && entry->resizable && dataLength != entry->length)
+    {
+        if (!nitf_TREFieldStore_getPair(store, n, error))
+            return NITF_FAILURE;
+    }
+
+    return nitf_Field_setRawData(nitf_TREFieldStore_view(store, n, &view),
+                                 data, dataLength, error);
+}
+
+
+NITFAPI(void) nitf_TREFieldStore_getName(nitf_TREFieldStore * store,
+                                         int n,
+                                         char *name,
+                                         size_t size)
+{
+    writeName(store, &store->entries[n], name, size);
+}
@@ -0,0 +1,617 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; if not, If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nitf/TREPlan.h"
+
+#define NITF_TRE_PLAN_BUCKETS 64
+
+/*  Each bucket has its own lock, which is only held to find or insert a
+ *  plan, never to compile one
+ */
+#ifndef WIN32
+#define NITF_TRE_PLAN_LOCKS_4 \
+    NITF_MUTEX_INIT, NITF_MUTEX_INIT, NITF_MUTEX_INIT, NITF_MUTEX_INIT
+#define NITF_TRE_PLAN_LOCKS_16 \
+    NITF_TRE_PLAN_LOCKS_4, NITF_TRE_PLAN_LOCKS_4, \
+    NITF_TRE_PLAN_LOCKS_4, NITF_TRE_PLAN_LOCKS_4
+    static nitf_Mutex __TREPlanLocks[NITF_TRE_PLAN_BUCKETS] = {
+        NITF_TRE_PLAN_LOCKS_16, NITF_TRE_PLAN_LOCKS_16,
+        NITF_TRE_PLAN_LOCKS_16, NITF_TRE_PLAN_LOCKS_16
+    };
+#else
+    static nitf_Mutex __TREPlanLocks[NITF_TRE_PLAN_BUCKETS];
+    static long __TREPlanInitLock = 0;
+#endif
+
+/*  The compiled plans, hashed by the address of their description  */
+static nitf_TREPlan *__TREPlans[NITF_TRE_PLAN_BUCKETS];
+
+/*  The plans replaced in each bucket, which may still be in use  */
+static nitf_TREPlan *__TREPlansRetired[NITF_TRE_PLAN_BUCKETS];
+
+/*  The plan of every description with nothing to compile  */
+static nitf_TREPlan __TREPlanFlat;
+
+#ifdef WIN32
+NITFPRIV(nitf_Mutex*) GET_MUTEX(size_t bucket)
+{
+    if (__TREPlanLocks[bucket] == NULL)
+    {
+        while (InterlockedExchange(&__TREPlanInitLock, 1) == 1)
+            /* loop, another thread own the lock */ ;
+        if (__TREPlanLocks[bucket] == NULL)
+            nitf_Mutex_init(&__TREPlanLocks[bucket]);
+        InterlockedExchange(&__TREPlanInitLock, 0);
+    }
+    return &__TREPlanLocks[bucket];
+}
+#else
+#define GET_MUTEX(bucket) &__TREPlanLocks[bucket]
+#endif
+
+
+NITFPRIV(NITF_BOOL) isField(int dataType)
+{
+    return dataType == NITF_BCS_A || dataType == NITF_BCS_N ||
+           dataType == NITF_BINARY;
+}
+
+
+NITFPRIV(void) destroyPlan(nitf_TREPlan ** plan)
+{
+    int i, j;
+
+    if (!*plan)
+        return;
+
+    if ((*plan)->entries)
+    {
+        for (i = 0; i < (*plan)->numItems; ++i)
+        {
+            nitf_TREPlanEntry *entry = &(*plan)->entries[i];
+            if (entry->ref.tag)
+                NITF_FREE(entry->ref.tag);
+            for (j = 0; j < entry->numTokens; ++j)
+            {
+                if (entry->postfix[j].ref.tag)
+                    NITF_FREE(entry->postfix[j].ref.tag);
+            }
+            if (entry->postfix)
+                NITF_FREE(entry->postfix);
+        }
+        NITF_FREE((*plan)->entries);
+    }
+    NITF_FREE(*plan);
+    *plan = NULL;
+}
+
+
+/*
+ *  Find the loop depth of the field a tag refers to.  The cursor looks
+ *  for an unqualified tag at each depth in turn, and since tags are
+ *  unique, it can only be found at the depth the field is declared.
+ *  If the field is declared at more than one depth, or not at all, or
+ *  the loops and ifs are not properly nested, the cursor still searches.
+ */
+NITFPRIV(int) resolveDepth(nitf_TREPlan * plan,
+                           const char *tag,
+                           int depth,
+                           NITF_BOOL nested)
+{
+    nitf_TREDescription *description = plan->description;
+    int found = -1;
+    int i;
+
+    if (!nested)
+        return -1;
+
+    for (i = 0; i < plan->numItems; ++i)
+    {
+        if (isField(description[i].data_type) && description[i].tag &&
+            strcmp(description[i].tag, tag) == 0)
+        {
+            if (found >= 0 && found != plan->entries[i].depth)
+                return -1;
+            found = plan->entries[i].depth;
+        }
+    }
+    return found <= depth ? found : -1;
+}
+
+
+NITFPRIV(NITF_BOOL) compileRef(nitf_TREPlan * plan,
+                               nitf_TREPlanRef * ref,
+                               const char *tag,
+                               size_t length,
+                               int depth,
+                               NITF_BOOL nested,
+                               nitf_Error * error)
+{
+    const char *brace;
+    size_t i;
+
+    ref->tag = NULL;
+    ref->depth = -1;
+    ref->entry = -1;
+    if (!tag)
+        return NITF_SUCCESS;
+
+    /*  A tag with braces is qualified with one index for each brace  */
+    brace = (const char *) memchr(tag, '[', length);
+    if (brace)
+    {
+        ref->depth = 0;
+        for (i = 0; i < length; ++i)
+        {
+            if (tag[i] == '[')
+                ref->depth++;
+        }
+        length = brace - tag;
+    }
+
+    ref->tag = (char *) NITF_MALLOC(length + 1);
+    if (!ref->tag)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+    memcpy(ref->tag, tag, length);
+    ref->tag[length] = 0;
+
+    if (!brace)
+        ref->depth = resolveDepth(plan, ref->tag, depth, nested);
+
+    /*  The fields of the fixed section are the first in the store  */
+    if (ref->depth == 0)
+    {
+        for (i = 0; i < (size_t) plan->numFixed; ++i)
+        {
+            if (strcmp(plan->description[i].tag, ref->tag) == 0)
+            {
+                ref->entry = (int) i;
+                break;
+            }
+        }
+    }
+    return NITF_SUCCESS;
+}
+
+
+/*  A loop label, an optional operator and operand: "- 1"  */
+NITFPRIV(void) compileArithmetic(nitf_TREPlanEntry * entry, const char *label)
+{
+    const char *op;
+    const char *valPtr;
+
+    entry->op = 0;
+    if (!label || strlen(label) == 0)
+        return;
+
+    op = label;
+    while (isspace(*op))
+        op++;
+
+    if ((*op == '+') ||
+        (*op == '-') || (*op == '*') || (*op == '/') || (*op == '%'))
+    {
+        valPtr = op + 1;
+        while (isspace(*valPtr))
+            valPtr++;
+
+        entry->op = *op;
+        entry->value = NITF_ATO32(valPtr);
+    }
+    else
+        entry->op = -1;
+}
+
+
+/*  An if label, a comparison and an operand: "eq Y", ">= 2", "& 0x10"  */
+NITFPRIV(void) compileCondition(nitf_TREPlanEntry * entry, const char *label)
+{
+    const char *op;
+    const char *valPtr;
+    size_t opLength;
+
+    entry->op = -1;
+    if (!label)
+        return;
+
+    op = label;
+    while (isspace(*op))
+        op++;
+
+    /*  the operand starts after the first space  */
+    valPtr = strchr(op, ' ');
+    if (!valPtr)
+        return;
+    opLength = valPtr - op;
+    valPtr++;
+
+#define NITF_TRE_PLAN_IS_OP(STR) \
+    (opLength == strlen(STR) && strncmp(op, STR, opLength) == 0)
+
+    if (NITF_TRE_PLAN_IS_OP("eq") || NITF_TRE_PLAN_IS_OP("ne"))
+    {
+        entry->op = op[0];
+        entry->string = valPtr;
+    }
+    else if (NITF_TRE_PLAN_IS_OP("<") || NITF_TRE_PLAN_IS_OP(">") ||
+             NITF_TRE_PLAN_IS_OP("==") || NITF_TRE_PLAN_IS_OP("!="))
+    {
+        entry->op = op[0];
+        entry->value = NITF_ATO32(valPtr);
+    }
+    else if (NITF_TRE_PLAN_IS_OP("<=") || NITF_TRE_PLAN_IS_OP(">="))
+    {
+        /*  'L' and 'G', to tell them from < and >  */
+        entry->op = op[0] == '<' ? 'L' : 'G';
+        entry->value = NITF_ATO32(valPtr);
+    }
+    else if (NITF_TRE_PLAN_IS_OP("&"))
+    {
+        entry->op = '&';
+        entry->value = (int) NITF_ATOU32_BASE(valPtr, 0);
+    }
+
+#undef NITF_TRE_PLAN_IS_OP
+}
+
+
+/*  A postfix expression, split on white space: "NUMBITS 7 + 8 /"  */
+NITFPRIV(NITF_BOOL) compilePostfix(nitf_TREPlan * plan,
+                                   nitf_TREPlanEntry * entry,
+                                   const char *expression,
+                                   NITF_BOOL nested,
+                                   nitf_Error * error)
+{
+    const char *cur = expression;
+    const char *end;
+    size_t length;
+    size_t i;
+    NITF_BOOL numeric;
+    nitf_TREPlanToken *token;
+
+    /*  there can be no more tokens than half the characters, rounded up  */
+    entry->postfix = (nitf_TREPlanToken *) NITF_MALLOC(
+            (strlen(expression) / 2 + 1) * sizeof(nitf_TREPlanToken));
+    if (!entry->postfix)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+
+    for (;;)
+    {
+        while (isspace(*cur))
+            ++cur;
+        if (!*cur)
+            break;
+        end = cur;
+        while (*end && !isspace(*end))
+            ++end;
+        length = end - cur;
+
+        token = &entry->postfix[entry->numTokens++];
+        token->ref.tag = NULL;
+        token->ref.depth = -1;
+        token->ref.entry = -1;
+
+        numeric = 1;
+        for (i = 0; i < length && numeric; ++i)
+            numeric = isdigit(cur[i]) != 0;
+
+        if (length == 1 && (*cur == '+' || *cur == '-' || *cur == '*' ||
+                            *cur == '/' || *cur == '%'))
+        {
+            token->kind = NITF_TRE_PLAN_OP;
+            token->value = *cur;
+        }
+        else if (numeric)
+        {
+            token->kind = NITF_TRE_PLAN_CONST;
+            token->value = NITF_ATO32(cur);
+        }
+        else
+        {
+            token->kind = NITF_TRE_PLAN_FIELD;
+            token->value = 0;
+            if (!compileRef(plan, &token->ref, cur, length,
+                            entry->depth, nested, error))
+                return NITF_FAILURE;
+        }
+        cur = end;
+    }
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(nitf_TREPlan *) compilePlan(nitf_TREDescription * description,
+                                     int numItems,
+                                     nitf_Error * error)
+{
+    nitf_TREPlan *plan = NULL;
+    nitf_TREPlanEntry *entry;
+    nitf_TREDescription *dptr;
+    int *loops = NULL;      /* the open loops */
+    int *ifs = NULL;        /* the open ifs */
+    int *open = NULL;       /* the types of the open loops and ifs */
+    int numLoops = 0, numIfs = 0, numOpen = 0;
+    NITF_BOOL nested = 1;
+    int i;
+
+    plan = (nitf_TREPlan *) NITF_MALLOC(sizeof(nitf_TREPlan));
+    if (!plan)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NULL;
+    }
+    memset(plan, 0, sizeof(nitf_TREPlan));
+    plan->description = description;
+    plan->numItems = numItems;
+
+    plan->entries = (nitf_TREPlanEntry *) NITF_MALLOC(
+            numItems * sizeof(nitf_TREPlanEntry));
+    loops = (int *) NITF_MALLOC(3 * numItems * sizeof(int));
+    if (!plan->entries || !loops)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(plan->entries, 0, numItems * sizeof(nitf_TREPlanEntry));
+    plan->first = description[0];
+    ifs = loops + numItems;
+    open = ifs + numItems;
+
+    /*  The fixed section ends at the first loop, if or unknown length  */
+    for (i = 0; i < numItems; ++i)
+    {
+        dptr = &description[i];
+        plan->entries[i].offset = -1;
+        if (i == plan->numFixed && isField(dptr->data_type) &&
+            !dptr->special && dptr->data_count > 0 && dptr->tag)
+        {
+            plan->entries[i].offset = plan->fixedLength;
+            plan->fixedLength += dptr->data_count;
+            plan->numFixed++;
+        }
+    }
+
+    /*  Match up the loops and ifs, the same way the cursor skips them  */
+    for (i = 0; i < numItems; ++i)
+    {
+        entry = &plan->entries[i];
+        entry->end = i;
+        entry->depth = numLoops;
+
+        switch (description[i].data_type)
+        {
+            case NITF_LOOP:
+                entry->end = numItems;
+                loops[numLoops++] = i;
+                open[numOpen++] = NITF_LOOP;
+                break;
+            case NITF_IF:
+                entry->end = numItems;
+                ifs[numIfs++] = i;
+                open[numOpen++] = NITF_IF;
+                break;
+            case NITF_ENDLOOP:
+                if (numLoops > 0)
+                    plan->entries[loops[--numLoops]].end = i;
+                if (numOpen == 0 || open[--numOpen] != NITF_LOOP)
+                    nested = 0;
+                break;
+            case NITF_ENDIF:
+                if (numIfs > 0)
+                    plan->entries[ifs[--numIfs]].end = i;
+                if (numOpen == 0 || open[--numOpen] != NITF_IF)
+                    nested = 0;
+                break;
+            default:
+                break;
+        }
+    }
+
+    for (i = 0; i < numItems; ++i)
+    {
+        entry = &plan->entries[i];
+        dptr = &description[i];
+
+        if (dptr->data_type == NITF_LOOP)
+        {
+            if (dptr->label && strcmp(dptr->label, NITF_CONST_N) == 0)
+            {
+                entry->kind = NITF_TRE_PLAN_CONST;
+                entry->value = NITF_ATO32(dptr->tag);
+            }
+            else if (dptr->label && strcmp(dptr->label, NITF_FUNCTION) == 0)
+            {
+                /*  the tag is the function  */
+                entry->kind = NITF_TRE_PLAN_FUNCTION;
+            }
+            else
+            {
+                entry->kind = NITF_TRE_PLAN_FIELD;
+                if (!compileRef(plan, &entry->ref, dptr->tag,
+                                dptr->tag ? strlen(dptr->tag) : 0,
+                                entry->depth, nested, error))
+                    goto CATCH_ERROR;
+                compileArithmetic(entry, dptr->label);
+            }
+        }
+        else if (dptr->data_type == NITF_IF)
+        {
+            entry->kind = NITF_TRE_PLAN_FIELD;
+            if (!compileRef(plan, &entry->ref, dptr->tag,
+                            dptr->tag ? strlen(dptr->tag) : 0,
+                            entry->depth, nested, error))
+                goto CATCH_ERROR;
+            compileCondition(entry, dptr->label);
+        }
+        else if (isField(dptr->data_type) && dptr->special)
+        {
+            if (!compilePostfix(plan, entry, dptr->special, nested, error))
+                goto CATCH_ERROR;
+        }
+    }
+
+    NITF_FREE(loops);
+    return plan;
+
+  CATCH_ERROR:
+    if (loops)
+        NITF_FREE(loops);
+    destroyPlan(&plan);
+    return NULL;
+}
+
+
+/*
+ *  Whether a cached plan is still the plan of the description at its
+ *  address.  The whole description was compiled once, so only the first
+ *  entry, which every description has, is compared.
+ */
+NITFPRIV(NITF_BOOL) isCompiledFrom(nitf_TREPlan * plan,
+                                   nitf_TREDescription * description)
+{
+    return plan->first.data_type == description->data_type &&
+           plan->first.data_count == description->data_count &&
+           plan->first.label == description->label &&
+           plan->first.tag == description->tag &&
+           plan->first.special == description->special;
+}
+
+
+NITFPRIV(nitf_TREPlan *) findPlan(size_t bucket,
+                                  nitf_TREDescription * description)
+{
+    nitf_TREPlan *plan = __TREPlans[bucket];
+
+    while (plan && plan->description != description)
+        plan = plan->next;
+    return plan;
+}
+
+
+NITFPROT(nitf_TREPlan *) nitf_TREPlan_get(nitf_TREDescription * description,
+                                          int *numItems,
+                                          nitf_Error * error)
+{
+    nitf_TREDescription *dptr;
+    nitf_TREPlan **link;
+    nitf_TREPlan *plan = NULL;
+    nitf_TREPlan *compiled = NULL;
+    NITF_BOOL flat = 1;
+    int count = 0;
+    size_t bucket = ((size_t) description / sizeof(nitf_TREDescription))
+                    % NITF_TRE_PLAN_BUCKETS;
+
+    if (description)
+    {
+        nitf_Mutex_lock(GET_MUTEX(bucket));
+        plan = findPlan(bucket, description);
+        nitf_Mutex_unlock(GET_MUTEX(bucket));
+
+        /*  plans are never freed while they may be in use  */
+        if (plan && isCompiledFrom(plan, description))
+        {
+            *numItems = plan->numItems;
+            return plan;
+        }
+    }
+
+    for (dptr = description; dptr && dptr->data_type != NITF_END; ++dptr)
+    {
+        if (dptr->data_type == NITF_LOOP || dptr->data_type == NITF_IF ||
+            dptr->special)
+            flat = 0;
+        count++;
+    }
+    *numItems = count;
+
+    /*  Fields alone are read straight from the description  */
+    if (flat)
+        return &__TREPlanFlat;
+
+    compiled = compilePlan(description, count, error);
+    if (!compiled)
+        return NULL;
+
+    nitf_Mutex_lock(GET_MUTEX(bucket));
+
+    plan = findPlan(bucket, description);
+    if (plan && isCompiledFrom(plan, description))
+    {
+        /*  another thread compiled it first  */
+        nitf_Mutex_unlock(GET_MUTEX(bucket));
+        destroyPlan(&compiled);
+        return plan;
+    }
+
+    if (plan)
+    {
+        /*  The description it was compiled from has been freed, and this
+         *  one given its address.  A cursor may still hold the old plan.
+         */
+        for (link = &__TREPlans[bucket]; *link != plan;
+             link = &(*link)->next)
+            ;
+        *link = plan->next;
+        plan->next = __TREPlansRetired[bucket];
+        __TREPlansRetired[bucket] = plan;
+    }
+    compiled->next = __TREPlans[bucket];
+    __TREPlans[bucket] = compiled;
+
+    nitf_Mutex_unlock(GET_MUTEX(bucket));
+    return compiled;
+}
+
+
+NITFPROT(void) nitf_TREPlan_cleanup(void)
+{
+    nitf_TREPlan *plan;
+    size_t bucket;
+
+    for (bucket = 0; bucket < NITF_TRE_PLAN_BUCKETS; ++bucket)
+    {
+        nitf_Mutex_lock(GET_MUTEX(bucket));
+        while (__TREPlans[bucket])
+        {
+            plan = __TREPlans[bucket];
+            __TREPlans[bucket] = plan->next;
+            destroyPlan(&plan);
+        }
+        while (__TREPlansRetired[bucket])
+        {
+            plan = __TREPlansRetired[bucket];
+            __TREPlansRetired[bucket] = plan->next;
+            destroyPlan(&plan);
+        }
+        nitf_Mutex_unlock(GET_MUTEX(bucket));
+    }
+}
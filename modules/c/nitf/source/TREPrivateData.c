@@ -23,6 +23,67 @@
 #include "nitf/TREPrivateData.h"
 
 
+/*
+ *  Find the tag of the description entry a qualified name refers to,
+ *  which is what the store keys the field by
+ */
+NITFPRIV(const char *) descriptionTag(nitf_TREPrivateData *priv,
+                                      const char *name)
+{
+    nitf_TREDescription *dptr;
+    size_t length = strcspn(name, "[");
+
+    for (dptr = priv->description; dptr && dptr->data_type != NITF_END;
+         ++dptr)
+    {
+        if ((dptr->data_type == NITF_BCS_A ||
+             dptr->data_type == NITF_BCS_N ||
+             dptr->data_type == NITF_BINARY) && dptr->tag &&
+            strncmp(dptr->tag, name, length) == 0 && dptr->tag[length] == 0)
+            return dptr->tag;
+    }
+    return NULL;
+}
+
+
+/*
+ *  Whether the store owns the field of a pair in the hash
+ */
+NITFPRIV(NITF_BOOL) isAdopted(nitf_TREPrivateData *priv, nitf_Pair *pair)
+{
+    int n = nitf_TREFieldStore_findName(priv->fields, pair->key);
+
+    return n >= 0 && priv->fields->entries[n].pair &&
+           priv->fields->entries[n].pair->data == pair->data;
+}
+
+
+/*
+ *  Empty the hash, destroying the fields the store does not own
+ */
+NITFPRIV(void) clearHash(nitf_TREPrivateData *priv)
+{
+    nitf_Pair *pair;
+    nitf_Field *field;
+    int i;
+
+    for (i = 0; i < priv->hash->nbuckets; i++)
+    {
+        while (!nitf_List_isEmpty(priv->hash->buckets[i]))
+        {
+            pair = (nitf_Pair *) nitf_List_popFront(priv->hash->buckets[i]);
+            if (pair->data && !isAdopted(priv, pair))
+            {
+                field = (nitf_Field *) pair->data;
+                nitf_Field_destruct(&field);
+            }
+            NITF_FREE(pair->key);
+            NITF_FREE(pair);
+        }
+    }
+}
+
+
 NITFAPI(nitf_TREPrivateData *) nitf_TREPrivateData_construct(
         nitf_Error * error)
 {
@@ -40,17 +101,23 @@ NITFAPI(nitf_TREPrivateData *) nitf_TREPrivateData_construct(
     priv->description = NULL;
     priv->userData = NULL;
 
-    /* create the hashtable for the fields */
-    priv->hash = nitf_HashTable_construct(NITF_TRE_HASH_SIZE, error);
+    priv->hash = NULL;
+
+    /* create the store for the fields */
+    priv->fields = nitf_TREFieldStore_construct(error);
+
+    /* and the hash, for handlers that insert fields themselves */
+    if (priv->fields)
+        priv->hash = nitf_HashTable_construct(NITF_TRE_HASH_SIZE, error);
 
-    if (!priv->hash)
+    if (!priv->fields || !priv->hash)
     {
         nitf_TREPrivateData_destruct(&priv);
         return NULL;
     }
 
-    /* ??? change policy? */
-    nitf_HashTable_setPolicy(priv->hash, NITF_DATA_ADOPT);
+    /* the fields in it are destroyed with the store, or by clearHash */
+    nitf_HashTable_setPolicy(priv->hash, NITF_DATA_RETAIN_OWNER);
 
     return priv;
 }
@@ -60,24 +127,12 @@ NITFAPI(nitf_TREPrivateData *)
 nitf_TREPrivateData_clone(nitf_TREPrivateData *source, nitf_Error * error)
 {
     nitf_TREPrivateData *priv = NULL;
-
-    /* temporary nitf_List pointer */
-    nitf_List *lPtr;      
-
-    /* temporary nitf_Field pointer */
-    nitf_Field *field;          
-
-    /* temporary nitf_Pair pointer */
-    nitf_Pair *pair;
-
-    /* iterator to front of list */
-    nitf_ListIterator iter;     
-
-    /* iterator to back of list */
+    nitf_ListIterator iter;
     nitf_ListIterator end;
-
-    /* used for iterating */
-    int i;
+    nitf_Pair *pair;
+    nitf_Pair *copy;
+    nitf_Field *field;
+    int i, n;
 
     if (source)
     {
@@ -91,34 +146,38 @@ nitf_TREPrivateData_clone(nitf_TREPrivateData *source, nitf_Error * error)
             goto CATCH_ERROR;
         }
 
-        /*  Copy the entire contents of the hash  */
+        /*  Copy all of the fields  */
+        if (!nitf_TREPrivateData_sync(source, error))
+            goto CATCH_ERROR;
+        nitf_TREFieldStore_destruct(&priv->fields);
+        priv->fields = nitf_TREFieldStore_clone(source->fields, error);
+        if (!priv->fields)
+            goto CATCH_ERROR;
+
+        /*  and give the copy the same hash  */
         for (i = 0; i < source->hash->nbuckets; i++)
         {
-            /*  Foreach chain in the hash table...  */
-            lPtr = source->hash->buckets[i];
-            iter = nitf_List_begin(lPtr);
-            end = nitf_List_end(lPtr);
-
-            /*  And while they are different...  */
+            iter = nitf_List_begin(source->hash->buckets[i]);
+            end = nitf_List_end(source->hash->buckets[i]);
             while (nitf_ListIterator_notEqualTo(&iter, &end))
             {
-                /*  Retrieve the field at the iterator...  */
                 pair = (nitf_Pair *) nitf_ListIterator_get(&iter);
-
-                /*  Cast it back to a field...  */
-                field = (nitf_Field *) pair->data;
-
-                /* clone the field */
-                field = nitf_Field_clone(field, error);
-
-                /*  If that failed, we need to destruct  */
-                if (!field)
-                    goto CATCH_ERROR;
-
-                /*  Yes, now we can insert the new field!  */
-                if (!nitf_HashTable_insert(priv->hash,
-                                           pair->key, field, error))
+                n = nitf_TREFieldStore_findName(priv->fields, pair->key);
+                if (n >= 0)
+                {
+                    copy = nitf_TREFieldStore_getPair(priv->fields, n, error);
+                    field = copy ? (nitf_Field *) copy->data : NULL;
+                }
+                else
                 {
+                    field = nitf_Field_clone((nitf_Field *) pair->data,
+                                             error);
+                }
+                if (!field || !nitf_HashTable_insert(priv->hash, pair->key,
+                                                     field, error))
+                {
+                    if (field && n < 0)
+                        nitf_Field_destruct(&field);
                     goto CATCH_ERROR;
                 }
                 nitf_ListIterator_increment(&iter);
@@ -141,24 +200,8 @@ nitf_TREPrivateData_clone(nitf_TREPrivateData *source, nitf_Error * error)
 }
 
 
-/**
- * Helper function for destructing the HashTable pairs
- */
-NITFPRIV(int) destructHashValue(nitf_HashTable * ht,
-                                nitf_Pair * pair,
-                                NITF_DATA* userData,
-                                nitf_Error * error)
-{
-    if (pair)
-        if (pair->data)
-            nitf_Field_destruct((nitf_Field **) & pair->data);
-    return NITF_SUCCESS;
-}
-
-
 NITFAPI(void) nitf_TREPrivateData_destruct(nitf_TREPrivateData **priv)
 {
-    nitf_Error e;
     if (*priv)
     {
         if ((*priv)->descriptionName)
@@ -166,16 +209,14 @@ NITFAPI(void) nitf_TREPrivateData_destruct(nitf_TREPrivateData **priv)
             NITF_FREE((*priv)->descriptionName);
             (*priv)->descriptionName = NULL;
         }
+        /* destruct the fields, in the hash and then in the store */
         if ((*priv)->hash)
         {
-            /* destruct each field in the hash */
-            nitf_HashTable_foreach((*priv)->hash,
-                                   (NITF_HASH_FUNCTOR) destructHashValue,
-                                   NULL, &e);
-            /* destruct the hash */
+            if ((*priv)->fields)
+                clearHash(*priv);
             nitf_HashTable_destruct(&((*priv)->hash));
-
         }
+        nitf_TREFieldStore_destruct(&((*priv)->fields));
         NITF_FREE(*priv);
         *priv = NULL;
     }
@@ -185,28 +226,45 @@ NITFAPI(void) nitf_TREPrivateData_destruct(nitf_TREPrivateData **priv)
 NITFPROT(NITF_BOOL) nitf_TREPrivateData_flush(nitf_TREPrivateData *priv,
                                          nitf_Error * error)
 {
-    if (priv && priv->hash)
+    /* remove the fields, keeping the store for the next ones */
+    if (priv)
     {
-        /* destruct each field in the hash */
-        nitf_HashTable_foreach(priv->hash,
-                               (NITF_HASH_FUNCTOR) destructHashValue,
-                               NULL, error);
-        /* destruct the hash */
-        nitf_HashTable_destruct(&(priv->hash));
-
+        clearHash(priv);
+        nitf_TREFieldStore_clear(priv->fields);
     }
+    return NITF_SUCCESS;
+}
+
 
-    /* create the hashtable for the fields */
-    priv->hash = nitf_HashTable_construct(NITF_TRE_HASH_SIZE, error);
+NITFPROT(NITF_BOOL) nitf_TREPrivateData_sync(nitf_TREPrivateData *priv,
+                                             nitf_Error * error)
+{
+    nitf_ListIterator iter;
+    nitf_ListIterator end;
+    nitf_Pair *pair;
+    const char *tag;
+    int i;
 
-    if (!priv->hash)
+    for (i = 0; i < priv->hash->nbuckets; i++)
     {
-        nitf_TREPrivateData_destruct(&priv);
-        return NITF_FAILURE;
+        iter = nitf_List_begin(priv->hash->buckets[i]);
+        end = nitf_List_end(priv->hash->buckets[i]);
+        while (nitf_ListIterator_notEqualTo(&iter, &end))
+        {
+            pair = (nitf_Pair *) nitf_ListIterator_get(&iter);
+            nitf_ListIterator_increment(&iter);
+
+            /* a field the description does not have stays in the hash */
+            if (!pair->data || isAdopted(priv, pair) ||
+                !(tag = descriptionTag(priv, pair->key)))
+                continue;
+
+            if (nitf_TREFieldStore_adopt(priv->fields, tag, pair->key,
+                                         (nitf_Field *) pair->data,
+                                         error) < 0)
+                return NITF_FAILURE;
+        }
     }
-
-    nitf_HashTable_setPolicy(priv->hash, NITF_DATA_ADOPT);
-
     return NITF_SUCCESS;
 }
 
@@ -235,3 +293,82 @@ NITFPROT(NITF_BOOL) nitf_TREPrivateData_setDescriptionName(
     }
     return NITF_SUCCESS;
 }
+
+
+NITFAPI(nitf_Field *) nitf_TREPrivateData_getField(
+        nitf_TREPrivateData *priv, const char* name)
+{
+    nitf_Error error;
+    nitf_Pair *pair;
+    int n;
+
+    if (!nitf_TREPrivateData_sync(priv, &error))
+        return NULL;
+
+    n = nitf_TREFieldStore_findName(priv->fields, name);
+    if (n < 0)
+    {
+        /* it may be a field a handler put in the hash alone */
+        pair = nitf_HashTable_find(priv->hash, name);
+        return pair ? (nitf_Field *) pair->data : NULL;
+    }
+
+    pair = nitf_TREFieldStore_getPair(priv->fields, n, &error);
+    return pair ? (nitf_Field *) pair->data : NULL;
+}
+
+
+NITFAPI(nitf_List *) nitf_TREPrivateData_find(
+        nitf_TREPrivateData *priv, const char* pattern, nitf_Error * error)
+{
+    char name[256];
+    nitf_List *list;
+    nitf_Pair *pair;
+    nitf_ListIterator iter;
+    nitf_ListIterator end;
+    nitf_Uint32 n;
+    int i;
+
+    if (!nitf_TREPrivateData_sync(priv, error))
+        return NULL;
+
+    list = nitf_List_construct(error);
+    if (!list)
+        return NULL;
+
+    for (n = 0; n < priv->fields->numEntries; ++n)
+    {
+        /* only construct the fields that match */
+        nitf_TREFieldStore_getName(priv->fields, (int) n, name, sizeof(name));
+        if (!strstr(name, pattern))
+            continue;
+
+        pair = nitf_TREFieldStore_getPair(priv->fields, (int) n, error);
+        if (!pair || !nitf_List_pushBack(list, pair, error))
+            goto CATCH_ERROR;
+    }
+
+    /* then the fields a handler put in the hash alone */
+    for (i = 0; i < priv->hash->nbuckets; i++)
+    {
+        iter = nitf_List_begin(priv->hash->buckets[i]);
+        end = nitf_List_end(priv->hash->buckets[i]);
+        while (nitf_ListIterator_notEqualTo(&iter, &end))
+        {
+            pair = (nitf_Pair *) nitf_ListIterator_get(&iter);
+            if (strstr(pair->key, pattern) &&
+                nitf_TREFieldStore_findName(priv->fields, pair->key) < 0 &&
+                !nitf_List_pushBack(list, pair, error))
+                goto CATCH_ERROR;
+            nitf_ListIterator_increment(&iter);
+        }
+    }
+    return list;
+
+  CATCH_ERROR:
+    /* the pairs belong to the store and the hash */
+    while (!nitf_List_isEmpty(list))
+        nitf_List_popFront(list);
+    nitf_List_destruct(&list);
+    return NULL;
+}
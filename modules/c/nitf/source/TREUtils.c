@@ -22,8 +22,44 @@
 
 #include "nitf/TREUtils.h"
 #include "nitf/TREPrivateData.h"
+#include "nitf/TREPlan.h"
 
 
+/*
+ *  Add a field read from the TRE data to the store, in host byte order
+ */
+NITFPRIV(NITF_BOOL) addParsedField(nitf_TREFieldStore * fields,
+                                   const char *tag,
+                                   const int *idx,
+                                   int looping,
+                                   nitf_FieldType type,
+                                   char *value,
+                                   int length,
+                                   nitf_Error * error)
+{
+    nitf_Int16 int16;
+    nitf_Int32 int32;
+
+    /* first, check to see if we need to swap bytes */
+    if (type == NITF_BINARY && length == NITF_INT16_SZ)
+    {
+        int16 = (nitf_Int16)NITF_NTOHS(*((nitf_Int16 *) value));
+        value = (char *) &int16;
+    }
+    else if (type == NITF_BINARY && length == NITF_INT32_SZ)
+    {
+        int32 = (nitf_Int32)NITF_NTOHL(*((nitf_Int32 *) value));
+        value = (char *) &int32;
+    }
+    /* TODO what to do about the other binary lengths??? 8 bit is
+     * ok, but what about 64? for now, just let them go through...
+     */
+
+    /* add the field to the store */
+    return nitf_TREFieldStore_add(fields, tag, idx, looping,
+                                  type, value, length, error) >= 0;
+}
+
 NITFAPI(int) nitf_TREUtils_parse(nitf_TRE * tre,
                                  char *bufptr, 
                                  nitf_Error * error)
@@ -32,9 +68,11 @@ NITFAPI(int) nitf_TREUtils_parse(nitf_TRE * tre,
     int iterStatus = NITF_SUCCESS;
     int offset = 0;
     int length;
+    int i;
     nitf_TRECursor cursor;
-    nitf_Field *field = NULL;
     nitf_TREPrivateData *privData = NULL;
+    nitf_TREPlan *plan;
+    nitf_TREDescription *dptr;
 
     /* get out if TRE is null */
     if (!tre)
@@ -46,13 +84,31 @@ NITFAPI(int) nitf_TREUtils_parse(nitf_TRE * tre,
 
     privData = (nitf_TREPrivateData*)tre->priv;
 
-    /* flush the hash first, to protect from duplicate entries */
+    /* flush the fields first, to protect from duplicate entries */
     if (privData)
     {
         nitf_TREPrivateData_flush(privData, error);
     }
 
     cursor = nitf_TRECursor_begin(tre);
+
+    /* the fixed section is read at the offsets in the plan */
+    plan = cursor.plan;
+    if (plan && plan->numFixed > 0 && plan->fixedLength <= privData->length)
+    {
+        for (i = 0; i < plan->numFixed; ++i)
+        {
+            dptr = &privData->description[i];
+            if (!addParsedField(privData->fields, dptr->tag, NULL, 0,
+                                dptr->data_type,
+                                bufptr + plan->entries[i].offset,
+                                dptr->data_count, error))
+                goto CATCH_ERROR;
+        }
+        offset = plan->fixedLength;
+        nitf_TRECursor_skipFixed(&cursor);
+    }
+
     while (offset < privData->length && status)
     {
         if ((iterStatus = 
@@ -64,49 +120,6 @@ NITFAPI(int) nitf_TREUtils_parse(nitf_TRE * tre,
                 length = privData->length - offset;
             }
 
-            /* no need to call setValue, because we already know
-             * it is OK for this one to be in the hash
-             */
-
-            /* construct the field */
-            field = nitf_Field_construct(length,
-                    cursor.desc_ptr->data_type, error);
-            if (!field)
-                goto CATCH_ERROR;
-
-            /* first, check to see if we need to swap bytes */
-            if (field->type == NITF_BINARY
-                    && (length == NITF_INT16_SZ || length == NITF_INT32_SZ))
-            {
-                if (length == NITF_INT16_SZ)
-                {
-                    nitf_Int16 int16 =
-                        (nitf_Int16)NITF_NTOHS(*((nitf_Int16 *) (bufptr + offset)));
-                    status = nitf_Field_setRawData(field,
-                            (NITF_DATA *) & int16, length, error);
-                }
-                else if (length == NITF_INT32_SZ)
-                {
-                    nitf_Int32 int32 =
-                        (nitf_Int32)NITF_NTOHL(*((nitf_Int32 *) (bufptr + offset)));
-                    status = nitf_Field_setRawData(field,
-                            (NITF_DATA *) & int32, length, error);
-                }
-            }
-            else
-            {
-                /* check for the other binary lengths ... */
-                if (field->type == NITF_BINARY)
-                {
-                    /* TODO what to do??? 8 bit is ok, but what about 64? */
-                    /* for now, just let it go through... */
-                }
-
-                /* now, set the data */
-                status = nitf_Field_setRawData(field, (NITF_DATA *) (bufptr + offset),
-                        length, error);
-            }
-
 #ifdef NITF_DEBUG
             {
                 fprintf(stdout, "Adding Field [%s] to TRE [%s]\n",
@@ -114,9 +127,14 @@ NITFAPI(int) nitf_TREUtils_parse(nitf_TRE * tre,
             }
 #endif
 
-            /* add to the hash */
-            nitf_HashTable_insert(((nitf_TREPrivateData*)tre->priv)->hash,
-                    cursor.tag_str, field, error);
+            /* no need to call setValue, because we already know
+             * it is OK for this one to be in the store
+             */
+            if (!addParsedField(privData->fields, cursor.desc_ptr->tag,
+                                cursor.loop_idx->st, cursor.looping,
+                                cursor.desc_ptr->data_type,
+                                bufptr + offset, length, error))
+                goto CATCH_ERROR;
 
             offset += length;
         }
@@ -139,6 +157,7 @@ NITFAPI(int) nitf_TREUtils_parse(nitf_TRE * tre,
 
     /* deal with errors here */
     CATCH_ERROR:
+    nitf_TRECursor_cleanup(&cursor);
     return NITF_FAILURE;
 }
 
@@ -148,18 +167,17 @@ NITFAPI(char *) nitf_TREUtils_getRawData(nitf_TRE * tre, nitf_Uint32* treLength,
     int offset = 0;
     nitf_Uint32 length;
     int tempLength;
+    int n;
 
     /* data buffer - Caller must free this */
     char *data = NULL;
 
-    /* temp data buffer */
-    char *tempBuf = NULL;
+    /* the fields of the TRE */
+    nitf_TREFieldStore *fields = ((nitf_TREPrivateData*)tre->priv)->fields;
 
-    /* temp nitf_Pair */
-    nitf_Pair *pair;
-    
     /* temp nitf_Field */
     nitf_Field *field;
+    nitf_Field view;
 
     /* the cursor */
     nitf_TRECursor cursor;
@@ -190,27 +208,19 @@ NITFAPI(char *) nitf_TREUtils_getRawData(nitf_TRE * tre, nitf_Uint32* treLength,
     {
         if (nitf_TRECursor_iterate(&cursor, error) == NITF_SUCCESS)
         {
-            pair = nitf_HashTable_find(((nitf_TREPrivateData*)tre->priv)->hash,
-                    cursor.tag_str);
-            if (pair && pair->data)
+            n = nitf_TREFieldStore_find(fields, cursor.desc_ptr->tag,
+                                        cursor.loop_idx->st, cursor.looping);
+            if (n >= 0)
             {
                 tempLength = cursor.length;
                 if (tempLength == NITF_TRE_GOBBLE)
                 {
                     tempLength = length - offset;
                 }
-                field = (nitf_Field *) pair->data;
+                field = nitf_TREFieldStore_view(fields, n, &view);
 
-                /* get the raw data */
-                tempBuf = NITF_MALLOC(tempLength);
-                if (!tempBuf)
-                {
-                    nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
-                            NITF_CTXT, NITF_ERR_MEMORY);
-                    goto CATCH_ERROR;
-                }
                 /* get the data as raw buf */
-                nitf_Field_get(field, (NITF_DATA *) tempBuf,
+                nitf_Field_get(field, (NITF_DATA *) (data + offset),
                         NITF_CONV_RAW, tempLength, error);
 
                 /* first, check to see if we need to swap bytes */
@@ -218,15 +228,17 @@ NITFAPI(char *) nitf_TREUtils_getRawData(nitf_TRE * tre, nitf_Uint32* treLength,
                 {
                     if (tempLength == NITF_INT16_SZ)
                     {
-                        nitf_Int16 int16 =
-                            (nitf_Int16)NITF_HTONS(*((nitf_Int16 *) tempBuf));
-                        memcpy(tempBuf, (char*)&int16, tempLength);
+                        nitf_Int16 int16;
+                        memcpy(&int16, data + offset, tempLength);
+                        int16 = (nitf_Int16)NITF_HTONS(int16);
+                        memcpy(data + offset, (char*)&int16, tempLength);
                     }
                     else if (tempLength == NITF_INT32_SZ)
                     {
-                        nitf_Int32 int32 =
-                            (nitf_Int32)NITF_HTONL(*((nitf_Int32 *) tempBuf));
-                        memcpy(tempBuf, (char*)&int32, tempLength);
+                        nitf_Int32 int32;
+                        memcpy(&int32, data + offset, tempLength);
+                        int32 = (nitf_Int32)NITF_HTONL(int32);
+                        memcpy(data + offset, (char*)&int32, tempLength);
                     }
                     else
                     {
@@ -234,19 +246,14 @@ NITFAPI(char *) nitf_TREUtils_getRawData(nitf_TRE * tre, nitf_Uint32* treLength,
                         /* for now, just let it go through... */
                     }
                 }
-
-                /* now, memcpy the data */
-                memcpy(data + offset, tempBuf, tempLength);
                 offset += tempLength;
-
-                /* free the buf */
-                NITF_FREE(tempBuf);
             }
             else
             {
                 nitf_Error_init(error,
                 "Failed due to missing TRE field(s)",
                 NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+                nitf_TRECursor_cleanup(&cursor);
                 goto CATCH_ERROR;
             }
         }
@@ -287,12 +294,15 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_setValue(nitf_TRE * tre,
                                           size_t dataLength, 
                                           nitf_Error * error)
 {
-    nitf_Pair *pair;
+    nitf_TREFieldStore *fields;
     nitf_Field *field = NULL;
+    nitf_Field view;
     nitf_TRECursor cursor;
     NITF_BOOL done = 0;
     NITF_BOOL status = 1;
     nitf_FieldType type = NITF_BCS_A;
+    NITF_BOOL resizable;
+    int n;
 
     /* used temporarily for storing the length */
     int length;
@@ -304,31 +314,26 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_setValue(nitf_TRE * tre,
                 NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
         return NITF_FAILURE;
     }
+    if (!nitf_TREPrivateData_sync((nitf_TREPrivateData*)tre->priv, error))
+        return NITF_FAILURE;
+    fields = ((nitf_TREPrivateData*)tre->priv)->fields;
 
     /* If the field already exists, get it and modify it */
-    if (nitf_HashTable_exists(((nitf_TREPrivateData*)tre->priv)->hash, tag))
+    if ((n = nitf_TREFieldStore_findName(fields, tag)) >= 0)
     {
-        pair = nitf_HashTable_find(
-                ((nitf_TREPrivateData*)tre->priv)->hash, tag);
-        field = (nitf_Field *) pair->data;
-
-        if (!field)
-        {
-            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
-                    "setValue -> invalid field object: %s", tag);
-            return NITF_FAILURE;
-        }
+        field = nitf_TREFieldStore_view(fields, n, &view);
+        resizable = fields->entries[n].pair ?
+            field->resizable : fields->entries[n].resizable;
 
         /* check to see if the data passed in is too large or too small */
-        if ((dataLength > field->length && !field->resizable) || dataLength < 1)
+        if ((dataLength > field->length && !resizable) || dataLength < 1)
         {
             nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
                     "setValue -> invalid dataLength for field: %s", tag);
             return NITF_FAILURE;
         }
 
-        if (!nitf_Field_setRawData
-            (field, (NITF_DATA *) data, dataLength, error))
+        if (!nitf_TREFieldStore_set(fields, n, data, dataLength, error))
         {
             return NITF_FAILURE;
         }
@@ -344,7 +349,7 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_setValue(nitf_TRE * tre,
             return NITF_FAILURE;
 
     }
-    /* it doesn't exist in the hash yet, so we need to find it */
+    /* it doesn't exist in the store yet, so we need to find it */
     else
     {
 
@@ -375,6 +380,7 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_setValue(nitf_TRE * tre,
                                 "setValue -> invalid data type",
                                 NITF_CTXT,
                                 NITF_ERR_INVALID_PARAMETER);
+                        nitf_TRECursor_cleanup(&cursor);
                         return NITF_FAILURE;
                     }
 
@@ -385,27 +391,25 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_setValue(nitf_TRE * tre,
                         length = dataLength;
                     }
 
-                    /* construct the field */
-                    field = nitf_Field_construct(length, type, error);
-
-                    /* now, set the data */
-                    nitf_Field_setRawData(field, (NITF_DATA *) data,
-                            dataLength, error);
-
 #ifdef NITF_DEBUG
                     fprintf(stdout, "Adding (and filling) Field [%s] to TRE [%s]\n",
                             cursor.tag_str, tre->tag);
 #endif
 
-                    /* add to the hash */
-                    nitf_HashTable_insert(
-                            ((nitf_TREPrivateData*)tre->priv)->hash,
-                            cursor.tag_str, field, error);
-
+                    /* add the field to the store, and set the data */
+                    n = nitf_TREFieldStore_add(fields, cursor.desc_ptr->tag,
+                            cursor.loop_idx->st, cursor.looping,
+                            type, NULL, length, error);
+                    if (n >= 0)
+                        nitf_TREFieldStore_set(fields, n, data,
+                                               dataLength, error);
 
                     /* Now we need to fill our data */
                     if (!nitf_TREUtils_fillData(tre, ((nitf_TREPrivateData*)tre->priv)->description, error))
+                    {
+                        nitf_TRECursor_cleanup(&cursor);
                         return NITF_FAILURE;
+                    }
 
                     done = 1; /* set, so we break out of loop */
                 }
@@ -497,6 +501,8 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_fillData(nitf_TRE * tre,
         nitf_Error * error)
 {
     nitf_TRECursor cursor;
+    nitf_TREFieldStore *fields = ((nitf_TREPrivateData*)tre->priv)->fields;
+    int n;
 
     /* set the description so the cursor can use it */
     ((nitf_TREPrivateData*)tre->priv)->description =
@@ -511,12 +517,10 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_fillData(nitf_TRE * tre,
     {
         if (nitf_TRECursor_iterate(&cursor, error))
         {
-            nitf_Pair* pair = nitf_HashTable_find(
-                    ((nitf_TREPrivateData*)tre->priv)->hash, cursor.tag_str);
-
-            if (!pair || !pair->data)
+            if (nitf_TREFieldStore_find(fields, cursor.desc_ptr->tag,
+                                        cursor.loop_idx->st,
+                                        cursor.looping) < 0)
             {
-                nitf_Field* field = NULL;
                 int fieldLength = cursor.length;
 
                 /* If it is a GOBBLE length, there isn't really a standard
@@ -528,53 +532,17 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_fillData(nitf_TRE * tre,
                     fieldLength = 1;
                 }
 
-                field = nitf_Field_construct(fieldLength,
-                        cursor.desc_ptr->data_type,
+                /* the field gets zero/blank filled, by its type */
+                n = nitf_TREFieldStore_add(fields, cursor.desc_ptr->tag,
+                        cursor.loop_idx->st, cursor.looping,
+                        cursor.desc_ptr->data_type, NULL, fieldLength,
                         error);
+                if (n < 0)
+                    goto CATCH_ERROR;
 
                 /* set the field to be resizable later on */
                 if (cursor.length == NITF_TRE_GOBBLE)
-                    field->resizable = 1;
-
-                /* special case if BINARY... must set Raw Data */
-                if (cursor.desc_ptr->data_type == NITF_BINARY)
-                {
-                    char* tempBuf = (char *) NITF_MALLOC(fieldLength);
-                    if (!tempBuf)
-                    {
-                        nitf_Field_destruct(&field);
-                        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
-                                NITF_CTXT, NITF_ERR_MEMORY);
-                        goto CATCH_ERROR;
-                    }
-
-                    memset(tempBuf, 0, fieldLength);
-                    nitf_Field_setRawData(field, (NITF_DATA *) tempBuf,
-                            fieldLength, error);
-                }
-                else if (cursor.desc_ptr->data_type == NITF_BCS_N)
-                {
-                    /* this will get zero/blank filled by the function */
-                    nitf_Field_setString(field, "0", error);
-                }
-                else
-                {
-                    /* this will get zero/blank filled by the function */
-                    nitf_Field_setString(field, " ", error);
-                }
-
-                /* add to hash if there wasn't an entry yet */
-                if (!pair)
-                {
-                    nitf_HashTable_insert(
-                            ((nitf_TREPrivateData*)tre->priv)->hash,
-                            cursor.tag_str, field, error);
-                }
-                /* otherwise, just set the data pointer */
-                else
-                {
-                    pair->data = (NITF_DATA *) field;
-                }
+                    fields->entries[n].resizable = 1;
             }
         }
     }
@@ -585,14 +553,17 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_fillData(nitf_TRE * tre,
     return NITF_SUCCESS;
 
   CATCH_ERROR:
+    nitf_TRECursor_cleanup(&cursor);
     return NITF_FAILURE;
 }
 
 NITFAPI(int) nitf_TREUtils_print(nitf_TRE * tre, nitf_Error * error)
 {
-    nitf_Pair *pair; /* temp pair */
+    nitf_TREFieldStore *fields;
+    nitf_Field view; /* temp field */
     int status = NITF_SUCCESS;
     nitf_TRECursor cursor;
+    int n;
 
     /* get out if TRE is null */
     if (!tre)
@@ -601,15 +572,18 @@ NITFAPI(int) nitf_TREUtils_print(nitf_TRE * tre, nitf_Error * error)
                 NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
         return NITF_FAILURE;
     }
+    if (!nitf_TREPrivateData_sync((nitf_TREPrivateData*)tre->priv, error))
+        return NITF_FAILURE;
+    fields = ((nitf_TREPrivateData*)tre->priv)->fields;
 
     cursor = nitf_TRECursor_begin(tre);
     while (!nitf_TRECursor_isDone(&cursor) && (status == NITF_SUCCESS))
     {
         if ((status = nitf_TRECursor_iterate(&cursor, error)) == NITF_SUCCESS)
         {
-            pair = nitf_HashTable_find(
-                    ((nitf_TREPrivateData*)tre->priv)->hash, cursor.tag_str);
-            if (!pair || !pair->data)
+            n = nitf_TREFieldStore_find(fields, cursor.desc_ptr->tag,
+                                        cursor.loop_idx->st, cursor.looping);
+            if (n < 0)
             {
                 nitf_Error_initf(error, NITF_CTXT, NITF_ERR_UNK,
                 "Unable to find tag, '%s', in TRE hash for TRE '%s'", cursor.tag_str, tre->tag);
@@ -620,7 +594,7 @@ NITFAPI(int) nitf_TREUtils_print(nitf_TRE * tre, nitf_Error * error)
                 printf("%s (%s) = [",
                 cursor.desc_ptr->label == NULL ?
                 "null" : cursor.desc_ptr->label, cursor.tag_str);
-                nitf_Field_print((nitf_Field *) pair->data);
+                nitf_Field_print(nitf_TREFieldStore_view(fields, n, &view));
                 printf("]\n");
             }
         }
@@ -633,14 +607,18 @@ NITFAPI(int) nitf_TREUtils_computeLength(nitf_TRE * tre)
     int length = 0;
     int tempLength;
     nitf_Error error;
-    nitf_Pair *pair; /* temp nitf_Pair */
-    nitf_Field *field; /* temp nitf_Field */
+    nitf_TREFieldStore *fields;
     nitf_TRECursor cursor;
+    int n;
 
     /* get out if TRE is null */
     if (!tre)
         return -1;
 
+    /* the fields a handler put in the hash count too */
+    if (!nitf_TREPrivateData_sync((nitf_TREPrivateData*)tre->priv, &error))
+        return -1;
+
     cursor = nitf_TRECursor_begin(tre);
     while (!nitf_TRECursor_isDone(&cursor))
     {
@@ -650,18 +628,20 @@ NITFAPI(int) nitf_TREUtils_computeLength(nitf_TRE * tre)
             if (tempLength == NITF_TRE_GOBBLE)
             {
                 /* we don't have any other way to know the length of this
-                 * field, other than to see if the field is in the hash
+                 * field, other than to see if the field is in the store
                  * and use the length defined when it was created.
                  * Otherwise, we don't add any length.
                  */
                 tempLength = 0;
-                pair = nitf_HashTable_find(
-                        ((nitf_TREPrivateData*)tre->priv)->hash, cursor.tag_str);
-                if (pair)
+                fields = ((nitf_TREPrivateData*)tre->priv)->fields;
+                n = nitf_TREFieldStore_find(fields, cursor.desc_ptr->tag,
+                                            cursor.loop_idx->st,
+                                            cursor.looping);
+                if (n >= 0)
                 {
-                    field = (nitf_Field *) pair->data;
-                    if (field)
-                        tempLength = field->length;
+                    nitf_Field view;
+                    tempLength = (int)
+                        nitf_TREFieldStore_view(fields, n, &view)->length;
                 }
             }
             length += tempLength;
@@ -766,7 +746,6 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_basicRead(nitf_IOInterface* io,
                 return NITF_FAILURE;
             }
 
-            /*nitf_HashTable_print( ((nitf_TREPrivateData*)tre->priv)->hash );*/
             break;
         }
 
@@ -895,7 +874,7 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_basicClone(nitf_TRE *source,
 
     sourcePriv = (nitf_TREPrivateData*)source->priv;
 
-    /* this clones the hash */
+    /* this clones the fields */
     if (!(trePriv = nitf_TREPrivateData_clone(sourcePriv, error)))
         return NITF_FAILURE;
 
@@ -915,38 +894,12 @@ NITFAPI(void) nitf_TREUtils_basicDestruct(nitf_TRE* tre)
         nitf_TREPrivateData_destruct((nitf_TREPrivateData**)&tre->priv);
 }
 
-/*
- *  TODO: Can DefaultTRE use these now that they're not private?
- *
- */
 NITFAPI(nitf_List*) nitf_TREUtils_basicFind(nitf_TRE* tre,
                                             const char* pattern,
                                             nitf_Error* error)
 {
-    nitf_List* list;
-
-    nitf_HashTableIterator it = nitf_HashTable_begin(
-            ((nitf_TREPrivateData*)tre->priv)->hash);
-    nitf_HashTableIterator end = nitf_HashTable_end(
-            ((nitf_TREPrivateData*)tre->priv)->hash);
-
-    list = nitf_List_construct(error);
-    if (!list) return NULL;
-
-    while (nitf_HashTableIterator_notEqualTo(&it, &end))
-    {
-        nitf_Pair* pair = nitf_HashTableIterator_get(&it);
-
-        if (strstr(pair->key, pattern))
-        {
-            /* Should check this, I suppose */
-            nitf_List_pushBack(list, pair, error);
-
-        }
-        nitf_HashTableIterator_increment(&it);
-    }
-
-    return list;
+    return nitf_TREPrivateData_find((nitf_TREPrivateData*)tre->priv,
+                                    pattern, error);
 }
 
 NITFAPI(NITF_BOOL) nitf_TREUtils_basicSetField(nitf_TRE* tre,
@@ -961,10 +914,7 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_basicSetField(nitf_TRE* tre,
 NITFAPI(nitf_Field*) nitf_TREUtils_basicGetField(nitf_TRE* tre,
                                                  const char* tag)
 {
-    nitf_Pair* pair = nitf_HashTable_find(
-            ((nitf_TREPrivateData*)tre->priv)->hash, tag);
-    if (!pair) return NULL;
-    return (nitf_Field*)pair->data;
+    return nitf_TREPrivateData_getField((nitf_TREPrivateData*)tre->priv, tag);
 }
 
 NITFPRIV(nitf_Pair*) basicIncrement(nitf_TREEnumerator* it, nitf_Error* error)
@@ -972,6 +922,7 @@ NITFPRIV(nitf_Pair*) basicIncrement(nitf_TREEnumerator* it, nitf_Error* error)
     /* get the next value, and increment the cursor */
     nitf_TRECursor* cursor = it ? (nitf_TRECursor*)it->data : NULL;
     nitf_Pair* data;
+    int n;
 
     if (!cursor || !nitf_TRECursor_iterate(cursor, error))
     {
@@ -980,11 +931,14 @@ NITFPRIV(nitf_Pair*) basicIncrement(nitf_TREEnumerator* it, nitf_Error* error)
         return NULL;
     }
 
-    if (!nitf_TRE_exists(cursor->tre, cursor->tag_str))
+    n = nitf_TREFieldStore_find(
+            ((nitf_TREPrivateData*)cursor->tre->priv)->fields,
+            cursor->desc_ptr->tag, cursor->loop_idx->st, cursor->looping);
+    if (n < 0)
         goto CATCH_ERROR;
 
-    data = nitf_HashTable_find(((nitf_TREPrivateData*)cursor->tre->priv)->hash,
-            cursor->tag_str);
+    data = nitf_TREFieldStore_getPair(
+            ((nitf_TREPrivateData*)cursor->tre->priv)->fields, n, error);
     if (!data)
         goto CATCH_ERROR;
 
@@ -1028,8 +982,14 @@ NITFAPI(nitf_TREEnumerator*) nitf_TREUtils_basicBegin(nitf_TRE* tre,
 {
     nitf_TREEnumerator* it =
         (nitf_TREEnumerator*)NITF_MALLOC(sizeof(nitf_TREEnumerator));
-    nitf_TRECursor* cursor =
-        (nitf_TRECursor*)NITF_MALLOC(sizeof(nitf_TRECursor));
+    nitf_TRECursor* cursor = NULL;
+
+    if (!nitf_TREPrivateData_sync((nitf_TREPrivateData*)tre->priv, error))
+    {
+        NITF_FREE(it);
+        return NULL;
+    }
+    cursor = (nitf_TRECursor*)NITF_MALLOC(sizeof(nitf_TRECursor));
     *cursor = nitf_TRECursor_begin(tre);
     /*assert(nitf_TRECursor_iterate(cursor, error));*/
 
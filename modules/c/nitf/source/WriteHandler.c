@@ -33,3 +33,16 @@ NITFAPI(void) nitf_WriteHandler_destruct(nitf_WriteHandler ** writeHandler)
         *writeHandler = NULL;
     }
 }
+
+NITFAPI(nitf_Off) nitf_WriteHandler_getSize(nitf_WriteHandler *writeHandler,
+                                            nitf_Error *error)
+{
+    if (!writeHandler->iface->getSize)
+    {
+        nitf_Error_init(error,
+                        "The length of the data is not known before the write",
+                        NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        return -1;
+    }
+    return writeHandler->iface->getSize(writeHandler->data, error);
+}
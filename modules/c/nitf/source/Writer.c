@@ -653,6 +653,8 @@ NITFAPI(nitf_Writer *) nitf_Writer_construct(nitf_Error * error)
     writer->dataExtensionWriters = NULL;
     writer->output = NULL;
     writer->ownOutput = 0;
+    writer->streaming = 0;
+    writer->writeThreads = 1;
     writer->record = NULL;
     writer->numImageWriters = 0;
     writer->numTextWriters = 0;
@@ -1530,16 +1532,17 @@ CATCH_ERROR:
     return NITF_FAILURE;
 }
 
-NITFPRIV(NITF_BOOL) writeDE(nitf_Writer* writer,
-                            nitf_WriteHandler * deWriter,
-                            nitf_DESubheader *subheader,
-                            nitf_IOInterface* output,
-                            nitf_Error *error)
+/*!
+ *  Check whether a DE segment holds overflowed TREs, which the writer
+ *  writes itself rather than through a WriteHandler
+ */
+NITFPRIV(NITF_BOOL) isOverflowDE(nitf_DESubheader *subheader,
+                                 NITF_BOOL *overflow,
+                                 nitf_Error *error)
 {
     /* DESID for overflow check */
     char desid[NITF_DESTAG_SZ+1];
 
-    /*  Check for overflow segment */
     if(!nitf_Field_get(subheader->NITF_DESTAG,(NITF_DATA *) desid,
                     NITF_CONV_STRING,NITF_DESTAG_SZ+1, error))
     {
@@ -1550,9 +1553,25 @@ NITFPRIV(NITF_BOOL) writeDE(nitf_Writer* writer,
     }
 
     nitf_Field_trimString(desid);
-    if ((strcmp(desid, "TRE_OVERFLOW") == 0) ||
+    *overflow = (strcmp(desid, "TRE_OVERFLOW") == 0) ||
         (strcmp(desid, "Registered Extensions") == 0) ||
-        (strcmp(desid, "Controlled Extensions") == 0))
+        (strcmp(desid, "Controlled Extensions") == 0);
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) writeDE(nitf_Writer* writer,
+                            nitf_WriteHandler * deWriter,
+                            nitf_DESubheader *subheader,
+                            nitf_IOInterface* output,
+                            nitf_Error *error)
+{
+    NITF_BOOL overflow;
+
+    /*  Check for overflow segment */
+    if (!isOverflowDE(subheader, &overflow, error))
+        return NITF_FAILURE;
+
+    if (overflow)
     {
         /* TRE iterator */
         nitf_ExtensionsIterator iter;
@@ -1590,6 +1609,851 @@ NITFPRIV(NITF_BOOL) writeDE(nitf_Writer* writer,
     return NITF_FAILURE;
 }
 
+/*
+ *  The output of a streaming write.  Everything is passed on to the real
+ *  output (if there is one) and counted, since the real output may not be
+ *  able to tell where it is.  The stream only moves forward, so the only
+ *  seek it allows is to where it already is.
+ */
+typedef struct _StreamControl
+{
+    nitf_IOInterface *output;
+    nitf_Off offset;
+} StreamControl;
+
+NITFPRIV(NITF_BOOL) Stream_read(NITF_DATA * data, void *buf, size_t size,
+                                nitf_Error * error)
+{
+    (void) data;
+    (void) buf;
+    (void) size;
+    nitf_Error_init(error, "The output of a streaming write cannot be read",
+                    NITF_CTXT, NITF_ERR_READING_FROM_FILE);
+    return NITF_FAILURE;
+}
+
+NITFPRIV(NITF_BOOL) Stream_write(NITF_DATA * data, const void *buf,
+                                 size_t size, nitf_Error * error)
+{
+    StreamControl *control = (StreamControl *) data;
+
+    if (control->output &&
+        !nitf_IOInterface_write(control->output, buf, size, error))
+        return NITF_FAILURE;
+
+    control->offset += (nitf_Off) size;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) Stream_canSeek(NITF_DATA * data, nitf_Error * error)
+{
+    (void) data;
+    (void) error;
+    return NITF_FAILURE;
+}
+
+NITFPRIV(nitf_Off) Stream_seek(NITF_DATA * data, nitf_Off offset,
+                               int whence, nitf_Error * error)
+{
+    StreamControl *control = (StreamControl *) data;
+
+    /* The current offset is also the end of the stream */
+    if (whence != NITF_SEEK_SET)
+        offset += control->offset;
+
+    if (offset != control->offset)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_SEEKING_IN_FILE,
+                         "A streaming write cannot seek from %lld to %lld",
+                         (long long) control->offset, (long long) offset);
+        return -1;
+    }
+    return offset;
+}
+
+NITFPRIV(nitf_Off) Stream_tell(NITF_DATA * data, nitf_Error * error)
+{
+    (void) error;
+    return ((StreamControl *) data)->offset;
+}
+
+NITFPRIV(nitf_Off) Stream_getSize(NITF_DATA * data, nitf_Error * error)
+{
+    (void) error;
+    return ((StreamControl *) data)->offset;
+}
+
+NITFPRIV(int) Stream_getMode(NITF_DATA * data, nitf_Error * error)
+{
+    (void) data;
+    (void) error;
+    return NITF_ACCESS_WRITEONLY;
+}
+
+NITFPRIV(NITF_BOOL) Stream_close(NITF_DATA * data, nitf_Error * error)
+{
+    (void) data;
+    (void) error;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(void) Stream_destruct(NITF_DATA * data)
+{
+    (void) data;
+}
+
+static nitf_IIOInterface streamInterface =
+{
+    Stream_read,
+    Stream_write,
+    Stream_canSeek,
+    Stream_seek,
+    Stream_tell,
+    Stream_getSize,
+    Stream_getMode,
+    Stream_close,
+    Stream_destruct,
+    NULL,
+    NULL,
+    NULL
+};
+
+/*!
+ *  Get the length of the data a segment WriteHandler is going to write
+ */
+NITFPRIV(NITF_BOOL) getSegmentDataLength(nitf_WriteHandler * handler,
+                                         const char *type,
+                                         nitf_Uint32 index,
+                                         nitf_Off * length,
+                                         nitf_Error * error)
+{
+    if (!handler)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                         "No WriteHandler for %s segment %u", type, index);
+        return NITF_FAILURE;
+    }
+
+    *length = nitf_WriteHandler_getSize(handler, error);
+    return *length >= 0;
+}
+
+/*!
+ *  Make sure a segment wrote what the header said it would, since the
+ *  header is not fixed up afterwards
+ */
+NITFPRIV(NITF_BOOL) checkSegmentDataLength(nitf_Off written,
+                                           nitf_Off length,
+                                           const char *type,
+                                           nitf_Uint32 index,
+                                           nitf_Error * error)
+{
+    if (written != length)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_WRITING_TO_FILE,
+                         "The %s segment %u wrote %lld bytes of data, "
+                         "%lld were expected", type, index,
+                         (long long) written, (long long) length);
+        return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+/*
+ *  The lengths of every segment's subheader and data, images first, then
+ *  graphics, texts and data extensions, in the order they are written
+ */
+typedef struct _WriterLayout
+{
+    nitf_Uint32 numImages;
+    nitf_Uint32 numGraphics;
+    nitf_Uint32 numTexts;
+    nitf_Uint32 numDEs;
+    nitf_Uint32 headerLength;
+    nitf_Off *subheaderLengths;
+    nitf_Off *dataLengths;
+} WriterLayout;
+
+NITFPRIV(void) WriterLayout_destruct(WriterLayout * layout)
+{
+    if (layout->subheaderLengths)
+        NITF_FREE(layout->subheaderLengths);
+    if (layout->dataLengths)
+        NITF_FREE(layout->dataLengths);
+    layout->subheaderLengths = NULL;
+    layout->dataLengths = NULL;
+}
+
+/*!
+ *  Work out the layout of the file before any of it is written.
+ *
+ *  Every header and subheader is written to a counting stream, and each
+ *  WriteHandler is asked how much data it will write.  The lengths, FL,
+ *  HL, CLEVEL and FDT are set in the record, so the file header is complete
+ *  before the write.  This fails if the length of any segment's data is
+ *  only known after it is written.
+ */
+NITFPRIV(NITF_BOOL) measureRecord(nitf_Writer * writer,
+                                  WriterLayout * layout,
+                                  nitf_Error * error)
+{
+    nitf_FileHeader *header = writer->record->header;
+    nitf_IOInterface *output = writer->output;
+    nitf_IOInterface stream;
+    StreamControl control;
+    nitf_ListIterator iter;
+    nitf_ListIterator end;
+    nitf_Version fver;
+    nitf_Uint32 numSegments;
+    nitf_Uint32 i, k;
+    nitf_Uint32 userSublen;
+    nitf_Off fileLenOff;
+    nitf_Off comratOff;
+    nitf_Off fileLen;
+    nitf_Off *subLens;
+    nitf_Off *dataLens;
+    NITF_BOOL overflow;
+
+    memset(layout, 0, sizeof(WriterLayout));
+    fver = nitf_Record_getVersion(writer->record);
+
+    NITF_TRY_GET_UINT32(header->numImages, &layout->numImages, error);
+    NITF_TRY_GET_UINT32(header->numGraphics, &layout->numGraphics, error);
+    NITF_TRY_GET_UINT32(header->numTexts, &layout->numTexts, error);
+    NITF_TRY_GET_UINT32(header->numDataExtensions, &layout->numDEs, error);
+
+    numSegments = layout->numImages + layout->numGraphics +
+        layout->numTexts + layout->numDEs;
+    if (numSegments != 0)
+    {
+        layout->subheaderLengths =
+            (nitf_Off *) NITF_MALLOC(numSegments * sizeof(nitf_Off));
+        layout->dataLengths =
+            (nitf_Off *) NITF_MALLOC(numSegments * sizeof(nitf_Off));
+        if (!layout->subheaderLengths || !layout->dataLengths)
+        {
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                            NITF_CTXT, NITF_ERR_MEMORY);
+            goto CATCH_ERROR;
+        }
+    }
+    subLens = layout->subheaderLengths;
+    dataLens = layout->dataLengths;
+
+    control.output = NULL;
+    control.offset = 0;
+    stream.data = &control;
+    stream.iface = &streamInterface;
+    writer->output = &stream;
+
+    fileLen = 0;
+    k = 0;
+
+    iter = nitf_List_begin(writer->record->images);
+    end = nitf_List_end(writer->record->images);
+    for (i = 0; nitf_ListIterator_notEqualTo(&iter, &end); ++i, ++k)
+    {
+        nitf_ImageSegment *segment =
+            (nitf_ImageSegment *) nitf_ListIterator_get(&iter);
+
+        control.offset = 0;
+        if (!nitf_Writer_writeImageSubheader(writer, segment->subheader,
+                                             fver, &comratOff, error))
+            goto CATCH_ERROR;
+        subLens[k] = control.offset;
+        if (!getSegmentDataLength(writer->imageWriters[i], "image", i,
+                                  &dataLens[k], error))
+            goto CATCH_ERROR;
+        if (!nitf_Field_setUint64(header->NITF_LISH(i), subLens[k], error))
+            goto CATCH_ERROR;
+        if (!nitf_Field_setUint64(header->NITF_LI(i), dataLens[k], error))
+            goto CATCH_ERROR;
+
+        fileLen += subLens[k] + dataLens[k];
+        nitf_ListIterator_increment(&iter);
+    }
+
+    iter = nitf_List_begin(writer->record->graphics);
+    end = nitf_List_end(writer->record->graphics);
+    for (i = 0; nitf_ListIterator_notEqualTo(&iter, &end); ++i, ++k)
+    {
+        nitf_GraphicSegment *segment =
+            (nitf_GraphicSegment *) nitf_ListIterator_get(&iter);
+
+        control.offset = 0;
+        if (!writeGraphicSubheader(writer, segment->subheader, fver, error))
+            goto CATCH_ERROR;
+        subLens[k] = control.offset;
+        if (!getSegmentDataLength(writer->graphicWriters[i], "graphic", i,
+                                  &dataLens[k], error))
+            goto CATCH_ERROR;
+        if (!nitf_Field_setUint64(header->NITF_LSSH(i), subLens[k], error))
+            goto CATCH_ERROR;
+        if (!nitf_Field_setUint64(header->NITF_LS(i), dataLens[k], error))
+            goto CATCH_ERROR;
+
+        fileLen += subLens[k] + dataLens[k];
+        nitf_ListIterator_increment(&iter);
+    }
+
+    iter = nitf_List_begin(writer->record->texts);
+    end = nitf_List_end(writer->record->texts);
+    for (i = 0; nitf_ListIterator_notEqualTo(&iter, &end); ++i, ++k)
+    {
+        nitf_TextSegment *segment =
+            (nitf_TextSegment *) nitf_ListIterator_get(&iter);
+
+        control.offset = 0;
+        if (!writeTextSubheader(writer, segment->subheader, fver, error))
+            goto CATCH_ERROR;
+        subLens[k] = control.offset;
+        if (!getSegmentDataLength(writer->textWriters[i], "text", i,
+                                  &dataLens[k], error))
+            goto CATCH_ERROR;
+        if (!nitf_Field_setUint64(header->NITF_LTSH(i), subLens[k], error))
+            goto CATCH_ERROR;
+        if (!nitf_Field_setUint64(header->NITF_LT(i), dataLens[k], error))
+            goto CATCH_ERROR;
+
+        fileLen += subLens[k] + dataLens[k];
+        nitf_ListIterator_increment(&iter);
+    }
+
+    iter = nitf_List_begin(writer->record->dataExtensions);
+    end = nitf_List_end(writer->record->dataExtensions);
+    for (i = 0; nitf_ListIterator_notEqualTo(&iter, &end); ++i, ++k)
+    {
+        nitf_DESegment *segment =
+            (nitf_DESegment *) nitf_ListIterator_get(&iter);
+
+        control.offset = 0;
+        if (!writeDESubheader(writer, segment->subheader,
+                              &userSublen, fver, error))
+            goto CATCH_ERROR;
+        subLens[k] = control.offset;
+
+        if (!isOverflowDE(segment->subheader, &overflow, error))
+            goto CATCH_ERROR;
+        if (overflow)
+        {
+            /* The writer writes the overflowed TREs itself, so count them */
+            if (!writeDE(writer, NULL, segment->subheader, &stream, error))
+                goto CATCH_ERROR;
+            dataLens[k] = control.offset - subLens[k];
+        }
+        else if (!getSegmentDataLength(writer->dataExtensionWriters[i],
+                                       "data extension", i,
+                                       &dataLens[k], error))
+            goto CATCH_ERROR;
+
+        if (!nitf_Field_setUint64(header->NITF_LDSH(i), subLens[k], error))
+            goto CATCH_ERROR;
+        if (!nitf_Field_setUint64(header->NITF_LD(i), dataLens[k], error))
+            goto CATCH_ERROR;
+
+        fileLen += subLens[k] + dataLens[k];
+        nitf_ListIterator_increment(&iter);
+    }
+
+    control.offset = 0;
+    if (!writeHeader(writer, &fileLenOff, &layout->headerLength, error))
+        goto CATCH_ERROR;
+
+    fileLen += layout->headerLength;
+    if (!nitf_Field_setUint64(header->NITF_FL, fileLen, error))
+        goto CATCH_ERROR;
+    if (!nitf_Field_setUint64(header->NITF_HL, layout->headerLength, error))
+        goto CATCH_ERROR;
+
+    /* The CLEVEL and FDT have to be known before the header goes out too */
+    if (strncmp(header->NITF_CLEVEL->raw, "00", 2) == 0)
+    {
+        NITF_CLEVEL clevel =
+            nitf_ComplexityLevel_measure(writer->record, error);
+
+        if (clevel == NITF_CLEVEL_CHECK_FAILED)
+            goto CATCH_ERROR;
+
+        nitf_ComplexityLevel_toString(clevel, header->NITF_CLEVEL->raw);
+    }
+
+    if (nitf_Utils_isBlank(header->NITF_FDT->raw))
+    {
+        char *dateFormat = (IS_NITF20(fver) ?
+                NITF_DATE_FORMAT_20 : NITF_DATE_FORMAT_21);
+
+        if (!nitf_Field_setDateTime(header->NITF_FDT, NULL, dateFormat, error))
+            goto CATCH_ERROR;
+    }
+
+    writer->output = output;
+    return NITF_SUCCESS;
+
+CATCH_ERROR:
+    writer->output = output;
+    WriterLayout_destruct(layout);
+    return NITF_FAILURE;
+}
+
+/*!
+ *  Write the record strictly front to back (see nitf_Writer_setStreaming),
+ *  once its layout is known
+ */
+NITFPRIV(NITF_BOOL) writeStream(nitf_Writer * writer, nitf_Error * error)
+{
+    nitf_IOInterface *output = writer->output;
+    nitf_IOInterface stream;
+    StreamControl control;
+    WriterLayout layout;
+    nitf_ListIterator iter;
+    nitf_ListIterator end;
+    nitf_Version fver;
+    nitf_Uint32 i, k;
+    nitf_Uint32 hdrLen;
+    nitf_Uint32 userSublen;
+    nitf_Off fileLenOff;
+    nitf_Off comratOff;
+    nitf_Off start;
+
+    if (!measureRecord(writer, &layout, error))
+    {
+        nitf_Writer_destructWriters(writer);
+        return NITF_FAILURE;
+    }
+
+    /* Everything goes through the stream, which keeps count */
+    fver = nitf_Record_getVersion(writer->record);
+    control.output = output;
+    control.offset = 0;
+    stream.data = &control;
+    stream.iface = &streamInterface;
+    writer->output = &stream;
+
+    if (!writeHeader(writer, &fileLenOff, &hdrLen, error))
+        goto CATCH_ERROR;
+
+    k = 0;
+
+    iter = nitf_List_begin(writer->record->images);
+    end = nitf_List_end(writer->record->images);
+    for (i = 0; nitf_ListIterator_notEqualTo(&iter, &end); ++i, ++k)
+    {
+        nitf_ImageSegment *segment =
+            (nitf_ImageSegment *) nitf_ListIterator_get(&iter);
+
+        if (!nitf_Writer_writeImageSubheader(writer, segment->subheader,
+                                             fver, &comratOff, error))
+            goto CATCH_ERROR;
+        start = control.offset;
+        if (!writeImage(writer->imageWriters[i], &stream, error))
+            goto CATCH_ERROR;
+        if (!checkSegmentDataLength(control.offset - start,
+                                    layout.dataLengths[k], "image", i, error))
+            goto CATCH_ERROR;
+        nitf_ListIterator_increment(&iter);
+    }
+
+    iter = nitf_List_begin(writer->record->graphics);
+    end = nitf_List_end(writer->record->graphics);
+    for (i = 0; nitf_ListIterator_notEqualTo(&iter, &end); ++i, ++k)
+    {
+        nitf_GraphicSegment *segment =
+            (nitf_GraphicSegment *) nitf_ListIterator_get(&iter);
+
+        if (!writeGraphicSubheader(writer, segment->subheader, fver, error))
+            goto CATCH_ERROR;
+        start = control.offset;
+        if (!writeGraphic(writer->graphicWriters[i], &stream, error))
+            goto CATCH_ERROR;
+        if (!checkSegmentDataLength(control.offset - start,
+                                    layout.dataLengths[k], "graphic", i,
+                                    error))
+            goto CATCH_ERROR;
+        nitf_ListIterator_increment(&iter);
+    }
+
+    iter = nitf_List_begin(writer->record->texts);
+    end = nitf_List_end(writer->record->texts);
+    for (i = 0; nitf_ListIterator_notEqualTo(&iter, &end); ++i, ++k)
+    {
+        nitf_TextSegment *segment =
+            (nitf_TextSegment *) nitf_ListIterator_get(&iter);
+
+        if (!writeTextSubheader(writer, segment->subheader, fver, error))
+            goto CATCH_ERROR;
+        start = control.offset;
+        if (!writeText(writer->textWriters[i], &stream, error))
+            goto CATCH_ERROR;
+        if (!checkSegmentDataLength(control.offset - start,
+                                    layout.dataLengths[k], "text", i, error))
+            goto CATCH_ERROR;
+        nitf_ListIterator_increment(&iter);
+    }
+
+    iter = nitf_List_begin(writer->record->dataExtensions);
+    end = nitf_List_end(writer->record->dataExtensions);
+    for (i = 0; nitf_ListIterator_notEqualTo(&iter, &end); ++i, ++k)
+    {
+        nitf_DESegment *segment =
+            (nitf_DESegment *) nitf_ListIterator_get(&iter);
+
+        if (!writeDESubheader(writer, segment->subheader,
+                              &userSublen, fver, error))
+            goto CATCH_ERROR;
+        start = control.offset;
+        if (!writeDE(writer, writer->dataExtensionWriters[i],
+                     segment->subheader, &stream, error))
+            goto CATCH_ERROR;
+        if (!checkSegmentDataLength(control.offset - start,
+                                    layout.dataLengths[k], "data extension",
+                                    i, error))
+            goto CATCH_ERROR;
+        nitf_ListIterator_increment(&iter);
+    }
+
+    writer->output = output;
+    WriterLayout_destruct(&layout);
+    nitf_Writer_destructWriters(writer);
+    return NITF_SUCCESS;
+
+CATCH_ERROR:
+    writer->output = output;
+    WriterLayout_destruct(&layout);
+    nitf_Writer_destructWriters(writer);
+    return NITF_FAILURE;
+}
+
+/*
+ *  One image's view of the output in a concurrent write.  Writes are
+ *  positional, at the view's own offset, so the views of several images
+ *  can write to the output at once.
+ */
+typedef struct _PositionControl
+{
+    nitf_IOInterface *output;
+    nitf_Off offset;
+    nitf_Off end;               /* Furthest offset written */
+} PositionControl;
+
+NITFPRIV(NITF_BOOL) Position_write(NITF_DATA * data, const void *buf,
+                                   size_t size, nitf_Error * error)
+{
+    PositionControl *control = (PositionControl *) data;
+
+    if (!nitf_IOInterface_writeAt(control->output, control->offset,
+                                  buf, size, error))
+        return NITF_FAILURE;
+
+    control->offset += (nitf_Off) size;
+    if (control->offset > control->end)
+        control->end = control->offset;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) Position_canSeek(NITF_DATA * data, nitf_Error * error)
+{
+    (void) data;
+    (void) error;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(nitf_Off) Position_seek(NITF_DATA * data, nitf_Off offset,
+                                 int whence, nitf_Error * error)
+{
+    PositionControl *control = (PositionControl *) data;
+
+    (void) error;
+    if (whence == NITF_SEEK_CUR)
+        offset += control->offset;
+    else if (whence == NITF_SEEK_END)
+        offset += control->end;
+
+    control->offset = offset;
+    return offset;
+}
+
+NITFPRIV(nitf_Off) Position_tell(NITF_DATA * data, nitf_Error * error)
+{
+    (void) error;
+    return ((PositionControl *) data)->offset;
+}
+
+NITFPRIV(nitf_Off) Position_getSize(NITF_DATA * data, nitf_Error * error)
+{
+    (void) error;
+    return ((PositionControl *) data)->end;
+}
+
+static nitf_IIOInterface positionInterface =
+{
+    Stream_read,
+    Position_write,
+    Position_canSeek,
+    Position_seek,
+    Position_tell,
+    Position_getSize,
+    Stream_getMode,
+    Stream_close,
+    Stream_destruct,
+    NULL,
+    NULL,
+    NULL
+};
+
+/*
+ *  The images of a concurrent write, which the write threads take in turn
+ */
+typedef struct _WriterImageQueue
+{
+    nitf_Writer *writer;
+    nitf_Off *dataOffsets;
+    nitf_Off *dataLengths;
+    nitf_Uint32 numImages;
+    nitf_Uint32 next;           /* The next image to write */
+    NITF_BOOL failed;           /* Stop taking images */
+    nitf_Mutex mutex;
+} WriterImageQueue;
+
+typedef struct _WriterTask
+{
+    WriterImageQueue *queue;
+    nitf_Thread thread;
+    NITF_BOOL started;          /* Running on its own thread */
+    NITF_BOOL status;
+    nitf_Error error;
+} WriterTask;
+
+NITFPRIV(NITF_DATA *) Writer_writeImages(NITF_DATA * data)
+{
+    WriterTask *task = (WriterTask *) data;
+    WriterImageQueue *queue = task->queue;
+    nitf_IOInterface view;
+    PositionControl control;
+    nitf_Uint32 i;
+
+    view.data = &control;
+    view.iface = &positionInterface;
+    control.output = queue->writer->output;
+
+    task->status = NITF_SUCCESS;
+    for (;;)
+    {
+        nitf_Mutex_lock(&queue->mutex);
+        i = queue->next++;
+        if (queue->failed)
+            i = queue->numImages;
+        nitf_Mutex_unlock(&queue->mutex);
+        if (i >= queue->numImages)
+            break;
+
+        control.offset = queue->dataOffsets[i];
+        control.end = control.offset;
+        if (!writeImage(queue->writer->imageWriters[i], &view, &task->error)
+            || !checkSegmentDataLength(control.end - queue->dataOffsets[i],
+                                       queue->dataLengths[i], "image", i,
+                                       &task->error))
+        {
+            task->status = NITF_FAILURE;
+            nitf_Mutex_lock(&queue->mutex);
+            queue->failed = 1;
+            nitf_Mutex_unlock(&queue->mutex);
+            break;
+        }
+    }
+    return NULL;
+}
+
+/*!
+ *  Write the image data of every image at once (see
+ *  nitf_Writer_setWriteThreads), once the layout of the file is known.
+ *  Each thread takes the next image and writes it with positional writes
+ *  at its offset in the file.  The file header, the subheaders and the
+ *  other segments are written last, in order.
+ */
+NITFPRIV(NITF_BOOL) writeConcurrent(nitf_Writer * writer,
+                                    WriterLayout * layout,
+                                    nitf_Error * error)
+{
+    WriterImageQueue queue;
+    WriterTask *tasks = NULL;
+    nitf_Uint32 numTasks;
+    nitf_ListIterator iter;
+    nitf_ListIterator end;
+    nitf_Version fver;
+    nitf_Uint32 i, k;
+    nitf_Uint32 hdrLen;
+    nitf_Uint32 userSublen;
+    nitf_Off fileLenOff;
+    nitf_Off comratOff;
+    nitf_Off offset;
+    nitf_Off *dataOffsets = NULL;
+    NITF_BOOL rc = NITF_SUCCESS;
+
+    /* The images come first, right after the file header */
+    dataOffsets = (nitf_Off *) NITF_MALLOC(layout->numImages *
+                                           sizeof(nitf_Off));
+    numTasks = writer->writeThreads < layout->numImages ?
+        writer->writeThreads : layout->numImages;
+    tasks = (WriterTask *) NITF_MALLOC(numTasks * sizeof(WriterTask));
+    if (!dataOffsets || !tasks)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        rc = NITF_FAILURE;
+        goto CLEANUP;
+    }
+    memset(tasks, 0, numTasks * sizeof(WriterTask));
+
+    offset = layout->headerLength;
+    for (i = 0; i < layout->numImages; ++i)
+    {
+        dataOffsets[i] = offset + layout->subheaderLengths[i];
+        offset = dataOffsets[i] + layout->dataLengths[i];
+    }
+
+    queue.writer = writer;
+    queue.dataOffsets = dataOffsets;
+    queue.dataLengths = layout->dataLengths;
+    queue.numImages = layout->numImages;
+    queue.next = 0;
+    queue.failed = 0;
+    nitf_Mutex_init(&queue.mutex);
+
+    /* The calling thread is the first writer */
+    for (i = 1; i < numTasks; ++i)
+    {
+        tasks[i].queue = &queue;
+        tasks[i].started = nitf_Thread_create(&tasks[i].thread,
+                                              Writer_writeImages, &tasks[i],
+                                              &tasks[i].error);
+        if (!tasks[i].started)
+            tasks[i].status = NITF_SUCCESS;
+    }
+    tasks[0].queue = &queue;
+    Writer_writeImages(&tasks[0]);
+
+    for (i = 0; i < numTasks; ++i)
+    {
+        if (tasks[i].started)
+            nitf_Thread_join(&tasks[i].thread);
+        if (!tasks[i].status && rc)
+        {
+            memcpy(error, &tasks[i].error, sizeof(nitf_Error));
+            rc = NITF_FAILURE;
+        }
+    }
+    nitf_Mutex_delete(&queue.mutex);
+    if (!rc)
+        goto CLEANUP;
+
+    /* Now the rest, in order, from the start of the file */
+    fver = nitf_Record_getVersion(writer->record);
+    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(writer->output, 0,
+                                               NITF_SEEK_SET, error)))
+        goto CATCH_ERROR;
+    if (!writeHeader(writer, &fileLenOff, &hdrLen, error))
+        goto CATCH_ERROR;
+
+    k = 0;
+
+    iter = nitf_List_begin(writer->record->images);
+    end = nitf_List_end(writer->record->images);
+    for (i = 0; nitf_ListIterator_notEqualTo(&iter, &end); ++i, ++k)
+    {
+        nitf_ImageSegment *segment =
+            (nitf_ImageSegment *) nitf_ListIterator_get(&iter);
+
+        /* Written after the data, so a new COMRAT is included */
+        if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(writer->output,
+                dataOffsets[i] - layout->subheaderLengths[k],
+                NITF_SEEK_SET, error)))
+            goto CATCH_ERROR;
+        if (!nitf_Writer_writeImageSubheader(writer, segment->subheader,
+                                             fver, &comratOff, error))
+            goto CATCH_ERROR;
+        nitf_ListIterator_increment(&iter);
+    }
+
+    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(writer->output, offset,
+                                               NITF_SEEK_SET, error)))
+        goto CATCH_ERROR;
+
+    iter = nitf_List_begin(writer->record->graphics);
+    end = nitf_List_end(writer->record->graphics);
+    for (i = 0; nitf_ListIterator_notEqualTo(&iter, &end); ++i, ++k)
+    {
+        nitf_GraphicSegment *segment =
+            (nitf_GraphicSegment *) nitf_ListIterator_get(&iter);
+
+        if (!writeGraphicSubheader(writer, segment->subheader, fver, error))
+            goto CATCH_ERROR;
+        offset += layout->subheaderLengths[k];
+        if (!writeGraphic(writer->graphicWriters[i], writer->output, error))
+            goto CATCH_ERROR;
+        if (!checkSegmentDataLength(
+                nitf_IOInterface_tell(writer->output, error) - offset,
+                layout->dataLengths[k], "graphic", i, error))
+            goto CATCH_ERROR;
+        offset += layout->dataLengths[k];
+        nitf_ListIterator_increment(&iter);
+    }
+
+    iter = nitf_List_begin(writer->record->texts);
+    end = nitf_List_end(writer->record->texts);
+    for (i = 0; nitf_ListIterator_notEqualTo(&iter, &end); ++i, ++k)
+    {
+        nitf_TextSegment *segment =
+            (nitf_TextSegment *) nitf_ListIterator_get(&iter);
+
+        if (!writeTextSubheader(writer, segment->subheader, fver, error))
+            goto CATCH_ERROR;
+        offset += layout->subheaderLengths[k];
+        if (!writeText(writer->textWriters[i], writer->output, error))
+            goto CATCH_ERROR;
+        if (!checkSegmentDataLength(
+                nitf_IOInterface_tell(writer->output, error) - offset,
+                layout->dataLengths[k], "text", i, error))
+            goto CATCH_ERROR;
+        offset += layout->dataLengths[k];
+        nitf_ListIterator_increment(&iter);
+    }
+
+    iter = nitf_List_begin(writer->record->dataExtensions);
+    end = nitf_List_end(writer->record->dataExtensions);
+    for (i = 0; nitf_ListIterator_notEqualTo(&iter, &end); ++i, ++k)
+    {
+        nitf_DESegment *segment =
+            (nitf_DESegment *) nitf_ListIterator_get(&iter);
+
+        if (!writeDESubheader(writer, segment->subheader,
+                              &userSublen, fver, error))
+            goto CATCH_ERROR;
+        offset += layout->subheaderLengths[k];
+        if (!writeDE(writer, writer->dataExtensionWriters[i],
+                     segment->subheader, writer->output, error))
+            goto CATCH_ERROR;
+        if (!checkSegmentDataLength(
+                nitf_IOInterface_tell(writer->output, error) - offset,
+                layout->dataLengths[k], "data extension", i, error))
+            goto CATCH_ERROR;
+        offset += layout->dataLengths[k];
+        nitf_ListIterator_increment(&iter);
+    }
+    goto CLEANUP;
+
+CATCH_ERROR:
+    rc = NITF_FAILURE;
+
+CLEANUP:
+    if (dataOffsets)
+        NITF_FREE(dataOffsets);
+    if (tasks)
+        NITF_FREE(tasks);
+    WriterLayout_destruct(layout);
+    nitf_Writer_destructWriters(writer);
+    return rc;
+}
+
 NITFAPI(NITF_BOOL) nitf_Writer_write(nitf_Writer * writer,
                                      nitf_Error * error)
 {
@@ -1652,6 +2516,24 @@ NITFAPI(NITF_BOOL) nitf_Writer_write(nitf_Writer * writer,
 
     nitf_FileHeader* header = writer->record->header;
 
+    if (writer->streaming)
+        return writeStream(writer, error);
+
+    /* Several images can be written at once if their layout is known */
+    if (writer->writeThreads > 1 &&
+        nitf_IOInterface_canWriteAt(writer->output) &&
+        nitf_Field_get(header->numImages, &numImgs,
+                       NITF_CONV_INT, NITF_INT32_SZ, error) &&
+        numImgs > 1)
+    {
+        WriterLayout layout;
+
+        if (measureRecord(writer, &layout, error))
+            return writeConcurrent(writer, &layout, error);
+
+        /* Some data lengths are only known after the write */
+    }
+
     if (!writeHeader(writer, &fileLenOff, &hdrLen, error))
         return NITF_FAILURE;
 
@@ -2235,6 +3117,22 @@ CATCH_ERROR:
 }
 
 
+NITFAPI(void) nitf_Writer_setStreaming(nitf_Writer * writer,
+                                       NITF_BOOL enable)
+{
+    writer->streaming = enable ? 1 : 0;
+}
+
+
+NITFAPI(void) nitf_Writer_setWriteThreads(nitf_Writer * writer,
+                                          nitf_Uint32 numThreads)
+{
+    if (numThreads == 0)
+        numThreads = nitf_Thread_getNumCPUs();
+    writer->writeThreads = numThreads;
+}
+
+
 NITFAPI(NITF_BOOL) nitf_Writer_setImageWriteHandler(nitf_Writer *writer,
         int index, nitf_WriteHandler *writeHandler, nitf_Error * error)
 {
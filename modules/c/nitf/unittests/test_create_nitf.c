@@ -1142,13 +1142,15 @@ NITF_BOOL addImageSegment(nitf_Record *record, nitf_Error *error)
 }
 
 
-NITF_BOOL writeNITF(nitf_Record *record, const char* filename, nitf_Error *error)
+NITF_BOOL writeNITF(nitf_Record *record, const char* filename,
+                    NITF_BOOL streaming, nitf_Uint32 numThreads,
+                    nitf_Error *error)
 {
     nitf_IOHandle out;
     nitf_Writer *writer = NULL;
     nitf_ImageWriter *imageWriter = NULL;
     nitf_ImageSource *imageSource;
-    nitf_Uint32 i;
+    nitf_Uint32 i, image, numImages;
 
     /* create the IOHandle */
     out = nitf_IOHandle_create(filename, NITF_ACCESS_WRITEONLY,
@@ -1165,36 +1167,50 @@ NITF_BOOL writeNITF(nitf_Record *record, const char* filename, nitf_Error *error
     if (!nitf_Writer_prepare(writer, record, out, error))
         goto CATCH_ERROR;
 
-    /* get a new ImageWriter for the 1st image (index 0) */
-    imageWriter = nitf_Writer_newImageWriter(writer, 0, NULL, error);
-    if (!imageWriter)
-        goto CATCH_ERROR;
+    /* write front to back, as if to a pipe */
+    nitf_Writer_setStreaming(writer, streaming);
+
+    /* write the images at once, if there are several */
+    nitf_Writer_setWriteThreads(writer, numThreads);
 
-    /* create an ImageSource for our embedded image */
-    imageSource = nitf_ImageSource_construct(error);
-    if (!imageSource)
+    if (!nitf_Field_get(record->header->numImages, &numImages,
+                        NITF_CONV_UINT, NITF_INT32_SZ, error))
         goto CATCH_ERROR;
 
-    /* make one bandSource per band */
-    for (i = 0; i < 3; ++i)
+    /* every image is our embedded image */
+    for (image = 0; image < numImages; ++image)
     {
-        nitf_BandSource *bandSource = nitf_MemorySource_construct(
-            (char*)NITRO_IMAGE.data, NITRO_IMAGE.width * NITRO_IMAGE.height,
-                i, 1, 2, error);
-        if (!bandSource)
+        /* get a new ImageWriter for the image */
+        imageWriter = nitf_Writer_newImageWriter(writer, image, NULL, error);
+        if (!imageWriter)
             goto CATCH_ERROR;
 
-        /* attach the band to the image */
-        if (!nitf_ImageSource_addBand(imageSource, bandSource, error))
+        /* create an ImageSource for our embedded image */
+        imageSource = nitf_ImageSource_construct(error);
+        if (!imageSource)
             goto CATCH_ERROR;
-    }
 
-    /* enable caching within the writer */
-    nitf_ImageWriter_setWriteCaching(imageWriter, 1);
+        /* make one bandSource per band */
+        for (i = 0; i < 3; ++i)
+        {
+            nitf_BandSource *bandSource = nitf_MemorySource_construct(
+                (char*)NITRO_IMAGE.data, NITRO_IMAGE.width * NITRO_IMAGE.height,
+                    i, 1, 2, error);
+            if (!bandSource)
+                goto CATCH_ERROR;
 
-    /* attach the ImageSource to the writer */
-    if (!nitf_ImageWriter_attachSource(imageWriter, imageSource, error))
-        goto CATCH_ERROR;
+            /* attach the band to the image */
+            if (!nitf_ImageSource_addBand(imageSource, bandSource, error))
+                goto CATCH_ERROR;
+        }
+
+        /* enable caching within the writer */
+        nitf_ImageWriter_setWriteCaching(imageWriter, 1);
+
+        /* attach the ImageSource to the writer */
+        if (!nitf_ImageWriter_attachSource(imageWriter, imageSource, error))
+            goto CATCH_ERROR;
+    }
 
     /* finally, write it! */
     if (!nitf_Writer_write(writer, error))
@@ -1217,13 +1233,30 @@ NITF_BOOL writeNITF(nitf_Record *record, const char* filename, nitf_Error *error
 TEST_CASE_ARGS(testCreate)
 {
     nitf_Record *record = NULL;
+    nitf_TRE *tre = NULL;
     nitf_Error error;
     char* outname = argc > 1 ? argv[1] : "test_create.ntf";
 
     TEST_ASSERT((record = nitf_Record_construct(NITF_VER_21, &error)));
     TEST_ASSERT(populateFileHeader(record, outname, &error));
     TEST_ASSERT(addImageSegment(record, &error));
-    TEST_ASSERT(writeNITF(record, outname, &error));
+
+    /* add a TRE of raw data, and one parsed by its plug-in if available */
+    TEST_ASSERT((tre = nitf_TRE_construct("NITROX", NITF_TRE_RAW, &error)));
+    TEST_ASSERT(nitf_TRE_setField(tre, NITF_TRE_RAW, "NITRO", 5, &error));
+    TEST_ASSERT(nitf_Extensions_appendTRE(record->header->userDefinedSection,
+                                          tre, &error));
+    TEST_ASSERT((tre = nitf_TRE_construct("ACFTB", NULL, &error)));
+    if (tre->handler != nitf_DefaultTRE_handler(&error))
+    {
+        TEST_ASSERT(nitf_TRE_setField(tre, "AC_MSN_ID", "NITRO", 5, &error));
+        TEST_ASSERT(nitf_Extensions_appendTRE(
+                record->header->userDefinedSection, tre, &error));
+    }
+    else
+        nitf_TRE_destruct(&tre);
+
+    TEST_ASSERT(writeNITF(record, outname, 0, 1, &error));
     nitf_Record_destruct(&record);
 }
 
@@ -1244,10 +1277,152 @@ TEST_CASE_ARGS(testRead)
     nitf_Record_destruct(&record);
 }
 
+TEST_CASE_ARGS(testReadLazyTREs)
+{
+    nitf_Reader *reader = NULL;
+    nitf_Reader *lazyReader = NULL;
+    nitf_Record *record = NULL;
+    nitf_Record *lazyRecord = NULL;
+    nitf_ExtensionsIterator iter, end, lazyIter;
+    nitf_Error error;
+    nitf_IOHandle io, lazyIO;
+    int numTREs = 0;
+    char* outname = argc > 1 ? argv[1] : "test_create.ntf";
+
+    io = nitf_IOHandle_create(outname, NITF_ACCESS_READONLY, NITF_OPEN_EXISTING, &error);
+    lazyIO = nitf_IOHandle_create(outname, NITF_ACCESS_READONLY, NITF_OPEN_EXISTING, &error);
+    reader = nitf_Reader_construct(&error);
+    lazyReader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    TEST_ASSERT(lazyReader);
+    nitf_Reader_setLazyTREs(lazyReader, 1);
+    record = nitf_Reader_read(reader, io, &error);
+    lazyRecord = nitf_Reader_read(lazyReader, lazyIO, &error);
+    TEST_ASSERT(record);
+    TEST_ASSERT(lazyRecord);
+
+    iter = nitf_Extensions_begin(record->header->userDefinedSection);
+    end = nitf_Extensions_end(record->header->userDefinedSection);
+    lazyIter = nitf_Extensions_begin(lazyRecord->header->userDefinedSection);
+    while (nitf_ExtensionsIterator_notEqualTo(&iter, &end))
+    {
+        nitf_TRE *tre = nitf_ExtensionsIterator_get(&iter);
+        nitf_TRE *lazyTRE = nitf_ExtensionsIterator_get(&lazyIter);
+        nitf_TREEnumerator *it, *lazyIt;
+
+        /* not parsed until it is used */
+        TEST_ASSERT(lazyTRE->handler == nitf_LazyTRE_handler(&error));
+        TEST_ASSERT_EQ_STR(tre->tag, lazyTRE->tag);
+        TEST_ASSERT((lazyIt = nitf_TRE_begin(lazyTRE, &error)));
+        TEST_ASSERT(lazyTRE->handler == tre->handler);
+
+        /* the same fields as the eager parse */
+        TEST_ASSERT((it = nitf_TRE_begin(tre, &error)));
+        while (it->hasNext(&it))
+        {
+            nitf_Pair *pair = it->next(it, &error);
+            nitf_Pair *lazyPair;
+            nitf_Field *field, *lazyField;
+            TEST_ASSERT(lazyIt->hasNext(&lazyIt));
+            lazyPair = lazyIt->next(lazyIt, &error);
+            TEST_ASSERT(pair);
+            TEST_ASSERT(lazyPair);
+            TEST_ASSERT_EQ_STR(pair->key, lazyPair->key);
+            field = (nitf_Field *) pair->data;
+            lazyField = (nitf_Field *) lazyPair->data;
+            TEST_ASSERT_EQ_INT((int) field->length, (int) lazyField->length);
+            TEST_ASSERT_EQ_INT(0, memcmp(field->raw, lazyField->raw,
+                                         field->length));
+        }
+        TEST_ASSERT(!lazyIt->hasNext(&lazyIt));
+
+        nitf_ExtensionsIterator_increment(&iter);
+        nitf_ExtensionsIterator_increment(&lazyIter);
+        ++numTREs;
+    }
+    TEST_ASSERT(numTREs > 0);
+
+    nitf_Reader_destruct(&reader);
+    nitf_Reader_destruct(&lazyReader);
+    nitf_Record_destruct(&record);
+    nitf_Record_destruct(&lazyRecord);
+}
+
+/*
+ *  Compare two files byte for byte
+ */
+NITF_BOOL sameFiles(const char* name, const char* otherName)
+{
+    FILE *file, *other;
+    int c, otherC;
+
+    file = fopen(name, "rb");
+    other = fopen(otherName, "rb");
+    if (!file || !other)
+    {
+        if (file) fclose(file);
+        if (other) fclose(other);
+        return 0;
+    }
+    do
+    {
+        c = fgetc(file);
+        otherC = fgetc(other);
+    }
+    while (c == otherC && c != EOF);
+    fclose(file);
+    fclose(other);
+    return c == otherC;
+}
+
+TEST_CASE(testWriteStream)
+{
+    nitf_Record *record = NULL;
+    nitf_Error error;
+    const char* outname = "test_create_seek.ntf";
+    const char* streamname = "test_create_stream.ntf";
+
+    TEST_ASSERT((record = nitf_Record_construct(NITF_VER_21, &error)));
+    TEST_ASSERT(populateFileHeader(record, outname, &error));
+    TEST_ASSERT(addImageSegment(record, &error));
+
+    /* the second write has the same FDT and CLEVEL as the first */
+    TEST_ASSERT(writeNITF(record, outname, 0, 1, &error));
+    TEST_ASSERT(writeNITF(record, streamname, 1, 1, &error));
+    nitf_Record_destruct(&record);
+
+    /* streaming knows all the lengths up front, it writes the same file */
+    TEST_ASSERT(sameFiles(outname, streamname));
+}
+
+TEST_CASE(testWriteConcurrent)
+{
+    nitf_Record *record = NULL;
+    nitf_Error error;
+    int i;
+    const char* outname = "test_create_serial.ntf";
+    const char* concurrentname = "test_create_concurrent.ntf";
+
+    TEST_ASSERT((record = nitf_Record_construct(NITF_VER_21, &error)));
+    TEST_ASSERT(populateFileHeader(record, outname, &error));
+    for (i = 0; i < 4; ++i)
+        TEST_ASSERT(addImageSegment(record, &error));
+
+    /* the images are written at once, to the same places */
+    TEST_ASSERT(writeNITF(record, outname, 0, 1, &error));
+    TEST_ASSERT(writeNITF(record, concurrentname, 0, 3, &error));
+    nitf_Record_destruct(&record);
+
+    TEST_ASSERT(sameFiles(outname, concurrentname));
+}
+
 int main(int argc, char **argv)
 {
     CHECK_ARGS(testCreate);
     CHECK_ARGS(testRead);
+    CHECK_ARGS(testReadLazyTREs);
+    CHECK(testWriteStream);
+    CHECK(testWriteConcurrent);
     return 0;
 }
 
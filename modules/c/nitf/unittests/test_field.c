@@ -98,8 +98,50 @@ TEST_CASE( testField)
     TEST_ASSERT_NULL(realField);
 }
 
+TEST_CASE( testArenaField)
+{
+    char str[NITF_FHDR_SZ + 1];
+    nitf_Field *pooled = NULL, *copy = NULL;
+    nitf_Arena *arena = NULL, *previous = NULL;
+    nitf_Error error;
+
+    arena = nitf_Arena_construct(0, &error);
+    TEST_ASSERT(arena);
+    previous = nitf_Arena_setCurrent(arena);
+    TEST_ASSERT(nitf_Arena_getCurrent() == arena);
+
+    pooled = nitf_Field_construct(NITF_FHDR_SZ, NITF_BCS_A, &error);
+    TEST_ASSERT(pooled);
+    TEST_ASSERT(pooled->pooled);
+    TEST_ASSERT(arena->allocated > 0);
+    TEST_ASSERT(nitf_Field_setRawData(pooled, "NIT", 3, &error));
+
+    /* clones are never pooled */
+    copy = nitf_Field_clone(pooled, &error);
+    TEST_ASSERT(copy);
+    TEST_ASSERT(!copy->pooled);
+
+    /* resizing a pooled field leaves the old data in the arena */
+    pooled->resizable = 1;
+    TEST_ASSERT(nitf_Field_resizeField(pooled, 8, &error));
+    TEST_ASSERT(nitf_Field_setRawData(pooled, "NITF", 4, &error));
+    nitf_Field_destruct(&pooled);
+    TEST_ASSERT_NULL(pooled);
+
+    nitf_Arena_setCurrent(previous);
+    nitf_Arena_destruct(&arena);
+    TEST_ASSERT_NULL(arena);
+
+    /* the clone outlives the arena */
+    TEST_ASSERT(nitf_Field_get(copy, str, NITF_CONV_STRING, NITF_FHDR_SZ
+            + 1, &error));
+    TEST_ASSERT_EQ_STR(str, "NIT ");
+    nitf_Field_destruct(&copy);
+}
+
 int main(int argc, char **argv)
 {
     CHECK(testField);
+    CHECK(testArenaField);
     return 0;
 }
@@ -0,0 +1,282 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Checks the ImageIO pixel formatters at each vector level (scalar, SSE2
+ * and AVX2, as the processor allows) against a per value reference
+ */
+
+#include <import/nitf.h>
+#include "Test.h"
+
+/* The formatters are internal to ImageIO and have no header */
+typedef void (*FormatFunc)(nitf_Uint8 *buffer, size_t count,
+                           nitf_Uint32 shiftCount);
+
+#define DECLARE_FORMATTERS(N) \
+    void nitf_ImageIO_unformatExtend_##N(nitf_Uint8*, size_t, nitf_Uint32); \
+    void nitf_ImageIO_unformatShift_##N(nitf_Uint8*, size_t, nitf_Uint32); \
+    void nitf_ImageIO_unformatUShift_##N(nitf_Uint8*, size_t, nitf_Uint32); \
+    void nitf_ImageIO_swapOnly_##N(nitf_Uint8*, size_t, nitf_Uint32); \
+    void nitf_ImageIO_unformatSwapExtend_##N(nitf_Uint8*, size_t, nitf_Uint32); \
+    void nitf_ImageIO_unformatSwapShift_##N(nitf_Uint8*, size_t, nitf_Uint32); \
+    void nitf_ImageIO_unformatSwapUShift_##N(nitf_Uint8*, size_t, nitf_Uint32); \
+    void nitf_ImageIO_formatShift_##N(nitf_Uint8*, size_t, nitf_Uint32); \
+    void nitf_ImageIO_formatShiftSwap_##N(nitf_Uint8*, size_t, nitf_Uint32);
+
+DECLARE_FORMATTERS(2)
+DECLARE_FORMATTERS(4)
+DECLARE_FORMATTERS(8)
+
+/* Reference operations, applied in this order */
+#define OP_LSHIFT 0x1
+#define OP_SWAP   0x2
+#define OP_EXTEND 0x4
+#define OP_SHIFT  0x8
+#define OP_USHIFT 0x10
+
+typedef struct _Formatter
+{
+    const char *name;
+    FormatFunc func;
+    int bytes;
+    int op;
+} Formatter;
+
+#define FORMATTERS(N) \
+    { "unformatExtend_" #N, nitf_ImageIO_unformatExtend_##N, N, OP_EXTEND }, \
+    { "unformatShift_" #N, nitf_ImageIO_unformatShift_##N, N, OP_SHIFT }, \
+    { "unformatUShift_" #N, nitf_ImageIO_unformatUShift_##N, N, OP_USHIFT }, \
+    { "swapOnly_" #N, nitf_ImageIO_swapOnly_##N, N, OP_SWAP }, \
+    { "unformatSwapExtend_" #N, nitf_ImageIO_unformatSwapExtend_##N, N, \
+      OP_SWAP | OP_EXTEND }, \
+    { "unformatSwapShift_" #N, nitf_ImageIO_unformatSwapShift_##N, N, \
+      OP_SWAP | OP_SHIFT }, \
+    { "unformatSwapUShift_" #N, nitf_ImageIO_unformatSwapUShift_##N, N, \
+      OP_SWAP | OP_USHIFT }, \
+    { "formatShift_" #N, nitf_ImageIO_formatShift_##N, N, OP_LSHIFT }, \
+    { "formatShiftSwap_" #N, nitf_ImageIO_formatShiftSwap_##N, N, \
+      OP_LSHIFT | OP_SWAP }
+
+static const Formatter formatters[] =
+{
+    FORMATTERS(2),
+    FORMATTERS(4),
+    FORMATTERS(8)
+};
+
+/* Longest run, in values, and guard bytes either side of it */
+#define MAX_COUNT 70
+#define GUARD 8
+
+static nitf_Uint64 swapValue(nitf_Uint64 value, int bytes)
+{
+    nitf_Uint64 swapped = 0;
+    int i;
+
+    for (i = 0; i < bytes; i++)
+    {
+        swapped = (swapped << 8) | (value & 0xff);
+        value >>= 8;
+    }
+    return swapped;
+}
+
+/* Sign extend the low "bits" bits of value */
+static nitf_Int64 signExtend(nitf_Uint64 value, int bits)
+{
+    return (nitf_Int64) (value << (64 - bits)) >> (64 - bits);
+}
+
+static nitf_Uint64 referenceValue(nitf_Uint64 value, int bytes, int op,
+                                  nitf_Uint32 shift)
+{
+    int bits = bytes * 8;
+    nitf_Uint64 mask = (bits == 64) ? (nitf_Uint64) -1
+                                    : (((nitf_Uint64) 1 << bits) - 1);
+
+    if (op & OP_LSHIFT)
+        value = (value << shift) & mask;
+    if (op & OP_SWAP)
+        value = swapValue(value, bytes);
+    if (op & OP_EXTEND)
+        value = (nitf_Uint64) signExtend(value, bits - shift) & mask;
+    else if (op & OP_SHIFT)
+        value = (nitf_Uint64) (signExtend(value, bits) >> shift) & mask;
+    else if (op & OP_USHIFT)
+        value >>= shift;
+    return value;
+}
+
+static nitf_Uint64 loadValue(const nitf_Uint8 *p, int bytes)
+{
+    nitf_Uint64 value;
+
+    if (bytes == 2)
+    {
+        nitf_Uint16 v;
+        memcpy(&v, p, 2);
+        value = v;
+    }
+    else if (bytes == 4)
+    {
+        nitf_Uint32 v;
+        memcpy(&v, p, 4);
+        value = v;
+    }
+    else
+        memcpy(&value, p, 8);
+    return value;
+}
+
+static void storeValue(nitf_Uint8 *p, nitf_Uint64 value, int bytes)
+{
+    if (bytes == 2)
+    {
+        nitf_Uint16 v = (nitf_Uint16) value;
+        memcpy(p, &v, 2);
+    }
+    else if (bytes == 4)
+    {
+        nitf_Uint32 v = (nitf_Uint32) value;
+        memcpy(p, &v, 4);
+    }
+    else
+        memcpy(p, &value, 8);
+}
+
+/*
+ *  Run one formatter over every length up to MAX_COUNT (so every tail
+ *  length of both vector widths) and compare with the reference. The data
+ *  is offset by an odd number of bytes and surrounded by guard bytes,
+ *  which must not change.
+ */
+static int checkFormatter(const Formatter *f, nitf_Uint32 shift,
+                          const nitf_Uint8 *source, int level)
+{
+    nitf_Uint8 buffer[GUARD + 1 + MAX_COUNT * 8 + GUARD];
+    nitf_Uint8 expected[sizeof(buffer)];
+    nitf_Uint8 *data = buffer + GUARD + 1;
+    size_t count;
+    size_t i;
+
+    for (count = 0; count <= MAX_COUNT; count++)
+    {
+        memcpy(buffer, source, sizeof(buffer));
+        memcpy(expected, source, sizeof(buffer));
+        for (i = 0; i < count; i++)
+        {
+            nitf_Uint8 *p = expected + (data - buffer) + i * f->bytes;
+            storeValue(p, referenceValue(loadValue(p, f->bytes), f->bytes,
+                                         f->op, shift), f->bytes);
+        }
+
+        f->func(data, count, shift);
+        if (memcmp(buffer, expected, sizeof(buffer)) != 0)
+        {
+            fprintf(stderr, "%s: level %d, shift %u, count %u differs\n",
+                    f->name, level, (unsigned) shift, (unsigned) count);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+TEST_CASE(testVectorFormatters)
+{
+    nitf_Uint8 source[GUARD + 1 + MAX_COUNT * 8 + GUARD];
+    nitf_Uint32 seed = 12345;
+    nitf_Uint32 shifts[5];
+    int level;
+    int levels = 0;
+    size_t i;
+    size_t j;
+
+    /* Random bytes, so both signs show up in every lane */
+    for (i = 0; i < sizeof(source); i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        source[i] = (nitf_Uint8) (seed >> 16);
+    }
+
+    for (level = 0; level <= 2; level++)
+    {
+        if (nitf_ImageIO_setVectorLevel(level) != level)
+            continue;
+        levels++;
+
+        for (i = 0; i < sizeof(formatters) / sizeof(formatters[0]); i++)
+        {
+            const Formatter *f = &formatters[i];
+            int bits = f->bytes * 8;
+
+            shifts[0] = 0;
+            shifts[1] = 1;
+            shifts[2] = 3;
+            shifts[3] = bits / 2;
+            shifts[4] = bits - 1;
+            for (j = 0; j < 5; j++)
+                TEST_ASSERT(checkFormatter(f, shifts[j], source, level));
+        }
+    }
+
+    /* Back to the best the processor has, the scalar level always runs */
+    nitf_ImageIO_setVectorLevel(2);
+    TEST_ASSERT(levels > 0);
+}
+
+TEST_CASE(testShiftSwapRoundTrip)
+{
+    /*
+     *  A left justified little-endian pixel written with formatShiftSwap
+     *  must read back through unformatSwapShift (SI) and
+     *  unformatSwapUShift (INT)
+     */
+    nitf_Int16 signedValues[37];
+    nitf_Uint16 unsignedValues[37];
+    nitf_Int16 buffer16[37];
+    nitf_Uint16 ubuffer16[37];
+    int i;
+
+    for (i = 0; i < 37; i++)
+    {
+        signedValues[i] = (nitf_Int16) ((i * 97) % 4096 - 2048);
+        unsignedValues[i] = (nitf_Uint16) ((i * 211) % 4096);
+    }
+
+    memcpy(buffer16, signedValues, sizeof(buffer16));
+    nitf_ImageIO_formatShiftSwap_2((nitf_Uint8 *) buffer16, 37, 4);
+    nitf_ImageIO_unformatSwapShift_2((nitf_Uint8 *) buffer16, 37, 4);
+    TEST_ASSERT(memcmp(buffer16, signedValues, sizeof(buffer16)) == 0);
+
+    memcpy(ubuffer16, unsignedValues, sizeof(ubuffer16));
+    nitf_ImageIO_formatShiftSwap_2((nitf_Uint8 *) ubuffer16, 37, 4);
+    nitf_ImageIO_unformatSwapUShift_2((nitf_Uint8 *) ubuffer16, 37, 4);
+    TEST_ASSERT(memcmp(ubuffer16, unsignedValues, sizeof(ubuffer16)) == 0);
+}
+
+int main(int argc, char **argv)
+{
+    CHECK(testVectorFormatters);
+    CHECK(testShiftSwapRoundTrip);
+    return 0;
+}
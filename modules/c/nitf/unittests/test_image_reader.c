@@ -0,0 +1,1433 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Writes small, multi-block, single band images and reads them back
+ * through the ImageReader
+ */
+
+#include <stddef.h>
+#include <import/nitf.h>
+#include "Test.h"
+
+#define TEST_FILE_NAME "test_image_reader.ntf"
+#define TEST_FILE_NAME_1 "test_image_reader_1.ntf"
+#define TEST_FILE_NAME_12 "test_image_reader_12.ntf"
+#define TEST_FILE_NAME_16 "test_image_reader_16.ntf"
+#define TEST_FILE_NAME_NM "test_image_reader_nm.ntf"
+#define TEST_FILE_NAME_RGB "test_image_reader_rgb.ntf"
+#define NUM_ROWS 64
+#define NUM_COLS 64
+#define BLOCK_SIZE 16
+#define NUM_BLOCKS ((NUM_ROWS / BLOCK_SIZE) * (NUM_COLS / BLOCK_SIZE))
+
+/* Not in the headers, a diagnostic function (see test_dump_masks) */
+NITF_BOOL nitf_ImageIO_getMaskInfo(nitf_ImageIO *nitf,
+                                   nitf_Uint32 *imageDataOffset,
+                                   nitf_Uint32 *blockRecordLength,
+                                   nitf_Uint32 *padRecordLength,
+                                   nitf_Uint32 *padPixelValueLength,
+                                   nitf_Uint8 **padValue,
+                                   nitf_Uint64 **blockMask,
+                                   nitf_Uint64 **padMask);
+
+static nitf_Uint16 pixelAt(nitf_Uint32 row, nitf_Uint32 col,
+                           nitf_Uint32 nBits)
+{
+    return (nitf_Uint16) ((row * 3 + col * 5) & ((1 << nBits) - 1));
+}
+
+static void setPixel(nitf_Uint8 *buffer, size_t index, nitf_Uint32 nBits,
+                     nitf_Uint16 value)
+{
+    if (nBits > 8)
+        ((nitf_Uint16 *) buffer)[index] = value;
+    else
+        buffer[index] = (nitf_Uint8) value;
+}
+
+static nitf_Uint16 getPixel(const nitf_Uint8 *buffer, size_t index,
+                            nitf_Uint32 nBits)
+{
+    return (nBits > 8) ? ((const nitf_Uint16 *) buffer)[index] :
+        buffer[index];
+}
+
+static NITF_BOOL writeCompressedImage(const char *filename,
+                                      nitf_Uint32 nBits,
+                                      nitf_Uint32 writeThreads,
+                                      const char *compression,
+                                      nitf_Error *error)
+{
+    nitf_Record *record = NULL;
+    nitf_ImageSegment *segment;
+    nitf_BandInfo **bands;
+    nitf_IOHandle out;
+    nitf_Writer *writer = NULL;
+    nitf_ImageWriter *imageWriter;
+    nitf_ImageSource *imageSource;
+    nitf_BandSource *bandSource;
+    nitf_Uint8 *data = NULL;
+    nitf_Uint32 row, col;
+    nitf_Uint32 bytes = NITF_NBPP_TO_BYTES(nBits);
+    NITF_BOOL status = NITF_FAILURE;
+
+    data = (nitf_Uint8 *) NITF_MALLOC(NUM_ROWS * NUM_COLS * bytes);
+    if (!data)
+        goto CATCH_ERROR;
+    for (row = 0; row < NUM_ROWS; ++row)
+        for (col = 0; col < NUM_COLS; ++col)
+            setPixel(data, row * NUM_COLS + col, nBits,
+                     pixelAt(row, col, nBits));
+
+    record = nitf_Record_construct(NITF_VER_21, error);
+    if (!record)
+        goto CATCH_ERROR;
+
+    segment = nitf_Record_newImageSegment(record, error);
+    if (!segment)
+        goto CATCH_ERROR;
+
+    bands = (nitf_BandInfo **) NITF_MALLOC(sizeof(nitf_BandInfo *));
+    if (!bands)
+        goto CATCH_ERROR;
+    bands[0] = nitf_BandInfo_construct(error);
+    if (!bands[0])
+        goto CATCH_ERROR;
+    if (!nitf_BandInfo_init(bands[0], "M", " ", "N", "   ", 0, 0, NULL, error))
+        goto CATCH_ERROR;
+
+    if (!nitf_ImageSubheader_setPixelInformation(segment->subheader,
+                                                 nBits == 1 ? "B" : "INT",
+                                                 nBits, nBits, "R", "MONO",
+                                                 "VIS", 1, bands, error))
+        goto CATCH_ERROR;
+
+    if (!nitf_ImageSubheader_setBlocking(segment->subheader,
+                                         NUM_ROWS, NUM_COLS,
+                                         BLOCK_SIZE, BLOCK_SIZE,
+                                         "B", error))
+        goto CATCH_ERROR;
+
+    if (!nitf_ImageSubheader_setCompression(segment->subheader, compression,
+                                            "", error))
+        goto CATCH_ERROR;
+
+    out = nitf_IOHandle_create(filename, NITF_ACCESS_WRITEONLY,
+                               NITF_CREATE, error);
+    if (NITF_INVALID_HANDLE(out))
+        goto CATCH_ERROR;
+
+    writer = nitf_Writer_construct(error);
+    if (!writer)
+        goto CATCH_ERROR;
+    if (!nitf_Writer_prepare(writer, record, out, error))
+        goto CATCH_ERROR;
+
+    imageWriter = nitf_Writer_newImageWriter(writer, 0, NULL, error);
+    if (!imageWriter)
+        goto CATCH_ERROR;
+    nitf_ImageWriter_setWriteThreads(imageWriter, writeThreads);
+    imageSource = nitf_ImageSource_construct(error);
+    if (!imageSource)
+        goto CATCH_ERROR;
+    bandSource = nitf_MemorySource_construct(data,
+                                             NUM_ROWS * NUM_COLS * bytes,
+                                             0, bytes, 0, error);
+    if (!bandSource)
+        goto CATCH_ERROR;
+    if (!nitf_ImageSource_addBand(imageSource, bandSource, error))
+        goto CATCH_ERROR;
+    if (!nitf_ImageWriter_attachSource(imageWriter, imageSource, error))
+        goto CATCH_ERROR;
+
+    if (!nitf_Writer_write(writer, error))
+        goto CATCH_ERROR;
+
+    nitf_IOHandle_close(out);
+    status = NITF_SUCCESS;
+
+  CATCH_ERROR:
+    if (writer)
+        nitf_Writer_destruct(&writer);
+    if (record)
+        nitf_Record_destruct(&record);
+    if (data)
+        NITF_FREE(data);
+    return status;
+}
+
+static nitf_Uint8 rgbAt(nitf_Uint32 row, nitf_Uint32 col, nitf_Uint32 band)
+{
+    return (nitf_Uint8) (pixelAt(row, col, 8) + band * 85);
+}
+
+/*
+ *  An uncompressed three band RGB image in IMODE P, which the reader opens
+ *  in its RGB24 mode (one band of three byte pixels)
+ */
+static NITF_BOOL writeRGBImage(const char *filename, nitf_Error *error)
+{
+    nitf_Record *record = NULL;
+    nitf_ImageSegment *segment;
+    nitf_BandInfo **bands;
+    nitf_IOHandle out;
+    nitf_Writer *writer = NULL;
+    nitf_ImageWriter *imageWriter;
+    nitf_ImageSource *imageSource;
+    nitf_BandSource *bandSource;
+    nitf_Uint8 *data = NULL;
+    nitf_Uint32 row, col, band;
+    NITF_BOOL status = NITF_FAILURE;
+
+    data = (nitf_Uint8 *) NITF_MALLOC(3 * NUM_ROWS * NUM_COLS);
+    if (!data)
+        goto CATCH_ERROR;
+    for (band = 0; band < 3; ++band)
+        for (row = 0; row < NUM_ROWS; ++row)
+            for (col = 0; col < NUM_COLS; ++col)
+                data[(band * NUM_ROWS + row) * NUM_COLS + col] =
+                    rgbAt(row, col, band);
+
+    record = nitf_Record_construct(NITF_VER_21, error);
+    if (!record)
+        goto CATCH_ERROR;
+
+    segment = nitf_Record_newImageSegment(record, error);
+    if (!segment)
+        goto CATCH_ERROR;
+
+    bands = (nitf_BandInfo **) NITF_MALLOC(3 * sizeof(nitf_BandInfo *));
+    if (!bands)
+        goto CATCH_ERROR;
+    for (band = 0; band < 3; ++band)
+    {
+        bands[band] = nitf_BandInfo_construct(error);
+        if (!bands[band])
+            goto CATCH_ERROR;
+        if (!nitf_BandInfo_init(bands[band], band == 0 ? "R" :
+                                band == 1 ? "G" : "B", " ", "N", "   ",
+                                0, 0, NULL, error))
+            goto CATCH_ERROR;
+    }
+
+    if (!nitf_ImageSubheader_setPixelInformation(segment->subheader,
+                                                 "INT", 8, 8, "R", "RGB",
+                                                 "VIS", 3, bands, error))
+        goto CATCH_ERROR;
+
+    if (!nitf_ImageSubheader_setBlocking(segment->subheader,
+                                         NUM_ROWS, NUM_COLS,
+                                         BLOCK_SIZE, BLOCK_SIZE,
+                                         "P", error))
+        goto CATCH_ERROR;
+
+    out = nitf_IOHandle_create(filename, NITF_ACCESS_WRITEONLY,
+                               NITF_CREATE, error);
+    if (NITF_INVALID_HANDLE(out))
+        goto CATCH_ERROR;
+
+    writer = nitf_Writer_construct(error);
+    if (!writer)
+        goto CATCH_ERROR;
+    if (!nitf_Writer_prepare(writer, record, out, error))
+        goto CATCH_ERROR;
+
+    imageWriter = nitf_Writer_newImageWriter(writer, 0, NULL, error);
+    if (!imageWriter)
+        goto CATCH_ERROR;
+    imageSource = nitf_ImageSource_construct(error);
+    if (!imageSource)
+        goto CATCH_ERROR;
+    for (band = 0; band < 3; ++band)
+    {
+        bandSource = nitf_MemorySource_construct(data + band * NUM_ROWS
+                                                 * NUM_COLS,
+                                                 NUM_ROWS * NUM_COLS,
+                                                 0, 1, 0, error);
+        if (!bandSource)
+            goto CATCH_ERROR;
+        if (!nitf_ImageSource_addBand(imageSource, bandSource, error))
+            goto CATCH_ERROR;
+    }
+    if (!nitf_ImageWriter_attachSource(imageWriter, imageSource, error))
+        goto CATCH_ERROR;
+
+    if (!nitf_Writer_write(writer, error))
+        goto CATCH_ERROR;
+
+    nitf_IOHandle_close(out);
+    status = NITF_SUCCESS;
+
+  CATCH_ERROR:
+    if (writer)
+        nitf_Writer_destruct(&writer);
+    if (record)
+        nitf_Record_destruct(&record);
+    if (data)
+        NITF_FREE(data);
+    return status;
+}
+
+static NITF_BOOL writeImage(const char *filename, nitf_Uint32 nBits,
+                            nitf_Uint32 writeThreads, nitf_Error *error)
+{
+    return writeCompressedImage(filename, nBits, writeThreads, "NC", error);
+}
+
+static NITF_BOOL checkWindowBits(nitf_ImageReader *imageReader,
+                                 nitf_Uint32 nBits,
+                                 nitf_Uint32 startRow, nitf_Uint32 startCol,
+                                 nitf_Uint32 numRows, nitf_Uint32 numCols,
+                                 nitf_Error *error)
+{
+    nitf_SubWindow *subWindow;
+    nitf_Uint32 bandList[1] = { 0 };
+    nitf_Uint8 *buffer;
+    nitf_Uint32 row, col;
+    int padded;
+    NITF_BOOL status = NITF_SUCCESS;
+
+    subWindow = nitf_SubWindow_construct(error);
+    if (!subWindow)
+        return NITF_FAILURE;
+    subWindow->startRow = startRow;
+    subWindow->startCol = startCol;
+    subWindow->numRows = numRows;
+    subWindow->numCols = numCols;
+    subWindow->bandList = bandList;
+    subWindow->numBands = 1;
+
+    buffer = (nitf_Uint8 *) NITF_MALLOC(numRows * numCols *
+                                        NITF_NBPP_TO_BYTES(nBits));
+    if (!buffer || !nitf_ImageReader_read(imageReader, subWindow, &buffer,
+                                          &padded, error))
+        status = NITF_FAILURE;
+
+    for (row = 0; status && row < numRows; ++row)
+        for (col = 0; col < numCols; ++col)
+            if (getPixel(buffer, row * numCols + col, nBits) !=
+                pixelAt(startRow + row, startCol + col, nBits))
+            {
+                status = NITF_FAILURE;
+                break;
+            }
+
+    if (buffer)
+        NITF_FREE(buffer);
+    nitf_SubWindow_destruct(&subWindow);
+    return status;
+}
+
+static NITF_BOOL checkWindow(nitf_ImageReader *imageReader,
+                             nitf_Uint32 startRow, nitf_Uint32 startCol,
+                             nitf_Uint32 numRows, nitf_Uint32 numCols,
+                             nitf_Error *error)
+{
+    return checkWindowBits(imageReader, 8, startRow, startCol,
+                           numRows, numCols, error);
+}
+
+static nitf_IIOInterface countingInterface;
+static NRT_IO_INTERFACE_READ_AT countedReadAt;
+static int readCount;
+
+static NITF_BOOL countingReadAt(NITF_DATA *data, nitf_Off offset,
+                                void *buf, size_t size, nitf_Error *error)
+{
+    ++readCount;
+    return (*countedReadAt)(data, offset, buf, size, error);
+}
+
+static NRT_IO_INTERFACE_READ countedRead;
+
+static NITF_BOOL countingRead(NITF_DATA *data, void *buf, size_t size,
+                              nitf_Error *error)
+{
+    ++readCount;
+    return (*countedRead)(data, buf, size, error);
+}
+
+TEST_CASE(testReadCache)
+{
+    nitf_Error error;
+    nitf_IOHandle io;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageReader *imageReader;
+    nitf_Uint64 hits, misses;
+
+    TEST_ASSERT(writeImage(TEST_FILE_NAME, 8, 1, &error));
+
+    io = nitf_IOHandle_create(TEST_FILE_NAME, NITF_ACCESS_READONLY,
+                              NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(!NITF_INVALID_HANDLE(io));
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    record = nitf_Reader_read(reader, io, &error);
+    TEST_ASSERT(record);
+
+    /* Default cache of one block, a window over four blocks twice */
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+    nitf_ImageReader_setReadCaching(imageReader);
+    TEST_ASSERT(checkWindow(imageReader, 10, 10, 20, 20, &error));
+    TEST_ASSERT(checkWindow(imageReader, 10, 10, 20, 20, &error));
+    nitf_ImageReader_getReadCacheStats(imageReader, &hits, &misses);
+    TEST_ASSERT_EQ_INT((int) hits, 0);
+    TEST_ASSERT_EQ_INT((int) misses, 8);
+    nitf_ImageReader_destruct(&imageReader);
+
+    /* Room for the four blocks, the second read is all hits */
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+    nitf_ImageReader_setReadCacheSize(imageReader,
+                                      4 * BLOCK_SIZE * BLOCK_SIZE);
+    TEST_ASSERT(checkWindow(imageReader, 10, 10, 20, 20, &error));
+    TEST_ASSERT(checkWindow(imageReader, 10, 10, 20, 20, &error));
+    nitf_ImageReader_getReadCacheStats(imageReader, &hits, &misses);
+    TEST_ASSERT_EQ_INT((int) hits, 4);
+    TEST_ASSERT_EQ_INT((int) misses, 4);
+
+    /* Full image through the cache */
+    TEST_ASSERT(checkWindow(imageReader, 0, 0, NUM_ROWS, NUM_COLS, &error));
+    nitf_ImageReader_destruct(&imageReader);
+
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOHandle_close(io);
+}
+
+TEST_CASE(testPositionalRead)
+{
+    nitf_Error error;
+    nitf_IOInterface *io;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageReader *imageReader;
+    char fhdr[4];
+
+    io = nitf_IOHandleAdapter_open(TEST_FILE_NAME, NITF_ACCESS_READONLY,
+                                   NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(io);
+    TEST_ASSERT(nitf_IOInterface_canReadAt(io));
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    record = nitf_Reader_readIO(reader, io, &error);
+    TEST_ASSERT(record);
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+
+    /* Pixel reads neither use nor move the interface's offset */
+    TEST_ASSERT(nitf_IOInterface_seek(io, 0, NITF_SEEK_SET, &error) == 0);
+    TEST_ASSERT(checkWindow(imageReader, 10, 10, 20, 20, &error));
+    TEST_ASSERT(checkWindow(imageReader, 0, 0, NUM_ROWS, NUM_COLS, &error));
+    TEST_ASSERT(nitf_IOInterface_tell(io, &error) == 0);
+
+    TEST_ASSERT(nitf_IOInterface_readAt(io, 0, fhdr, 4, &error));
+    TEST_ASSERT(memcmp(fhdr, "NITF", 4) == 0);
+    TEST_ASSERT(nitf_IOInterface_tell(io, &error) == 0);
+
+    nitf_ImageReader_destruct(&imageReader);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOInterface_close(io, &error);
+    nitf_IOInterface_destruct(&io);
+}
+
+#define NUM_READ_THREADS 4
+#define READ_SPAN 64
+
+typedef struct _PositionalReadTask
+{
+    nitf_ImageReader *imageReader;
+    nitf_IOInterface *io;
+    nitf_Uint32 startRow;
+    nitf_Off offset;
+    const char *expected;
+    NITF_BOOL status;
+} PositionalReadTask;
+
+static NITF_DATA* positionalReadTask(NITF_DATA *data)
+{
+    PositionalReadTask *task = (PositionalReadTask *) data;
+    nitf_Error error;
+    char buffer[READ_SPAN];
+    int i;
+
+    task->status = NITF_SUCCESS;
+    for (i = 0; task->status && i < 16; ++i)
+    {
+        /* Each thread reads its own rows and its own bytes */
+        if (!checkWindow(task->imageReader, task->startRow, i,
+                         NUM_ROWS / NUM_READ_THREADS, NUM_COLS - i, &error)
+            || !nitf_IOInterface_readAt(task->io, task->offset, buffer,
+                                        READ_SPAN, &error)
+            || memcmp(buffer, task->expected, READ_SPAN) != 0)
+            task->status = NITF_FAILURE;
+    }
+    return NULL;
+}
+
+TEST_CASE(testConcurrentPositionalRead)
+{
+    nitf_Error error;
+    nitf_IOInterface *io;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageReader *imageReader;
+    nitf_Thread threads[NUM_READ_THREADS];
+    PositionalReadTask tasks[NUM_READ_THREADS];
+    char expected[NUM_READ_THREADS * READ_SPAN];
+    int i;
+
+    io = nitf_IOHandleAdapter_open(TEST_FILE_NAME, NITF_ACCESS_READONLY,
+                                   NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(io);
+    TEST_ASSERT(nitf_IOInterface_read(io, expected, sizeof(expected),
+                                      &error));
+    TEST_ASSERT(nitf_IOInterface_seek(io, 0, NITF_SEEK_SET, &error) == 0);
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    record = nitf_Reader_readIO(reader, io, &error);
+    TEST_ASSERT(record);
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+
+    /* Disjoint windows and byte ranges through one reader and handle */
+    for (i = 0; i < NUM_READ_THREADS; ++i)
+    {
+        tasks[i].imageReader = imageReader;
+        tasks[i].io = io;
+        tasks[i].startRow = i * (NUM_ROWS / NUM_READ_THREADS);
+        tasks[i].offset = i * READ_SPAN;
+        tasks[i].expected = expected + i * READ_SPAN;
+        tasks[i].status = NITF_FAILURE;
+        TEST_ASSERT(nitf_Thread_create(&threads[i], positionalReadTask,
+                                       &tasks[i], &error));
+    }
+    for (i = 0; i < NUM_READ_THREADS; ++i)
+        nitf_Thread_join(&threads[i]);
+    for (i = 0; i < NUM_READ_THREADS; ++i)
+        TEST_ASSERT(tasks[i].status);
+
+    nitf_ImageReader_destruct(&imageReader);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOInterface_close(io, &error);
+    nitf_IOInterface_destruct(&io);
+}
+
+TEST_CASE(testMappedRead)
+{
+    nitf_Error error;
+    nitf_IOInterface *io;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageReader *imageReader;
+    const nitf_Uint8 *base;
+    const nitf_Uint8 *block;
+    nitf_Uint64 blockSize, misses;
+    nitf_Off fileSize;
+    nitf_Uint32 row, col;
+
+    io = nitf_MappedAdapter_open(TEST_FILE_NAME, &error);
+    TEST_ASSERT(io);
+    fileSize = nitf_IOInterface_getSize(io, &error);
+    base = (const nitf_Uint8 *) nitf_IOInterface_getBuffer(io, 0,
+                                                           (size_t) fileSize);
+    TEST_ASSERT(base);
+    TEST_ASSERT(nitf_IOInterface_getBuffer(io, 1, (size_t) fileSize) == NULL);
+    TEST_ASSERT(memcmp(base, "NITF", 4) == 0);
+
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    record = nitf_Reader_readIO(reader, io, &error);
+    TEST_ASSERT(record);
+
+    /* Cached reads copy straight from the mapping, nothing is cached */
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+    nitf_ImageReader_setReadCaching(imageReader);
+    TEST_ASSERT(checkWindow(imageReader, 10, 10, 20, 20, &error));
+    TEST_ASSERT(checkWindow(imageReader, 0, 0, NUM_ROWS, NUM_COLS, &error));
+    nitf_ImageReader_getReadCacheStats(imageReader, NULL, &misses);
+    TEST_ASSERT_EQ_INT(misses, 0);
+    nitf_ImageReader_destruct(&imageReader);
+
+    /* Direct block access points into the mapping */
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+    block = nitf_ImageReader_getBlock(imageReader, 5, &blockSize, &error);
+    TEST_ASSERT(block);
+    TEST_ASSERT(block > base && block + blockSize <= base + fileSize);
+    TEST_ASSERT_EQ_INT(blockSize, BLOCK_SIZE * BLOCK_SIZE);
+    for (row = 0; row < BLOCK_SIZE; ++row)
+        for (col = 0; col < BLOCK_SIZE; ++col)
+            TEST_ASSERT_EQ_INT(block[row * BLOCK_SIZE + col],
+                               pixelAt(BLOCK_SIZE + row, BLOCK_SIZE + col, 8));
+    nitf_ImageReader_destruct(&imageReader);
+
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOInterface_close(io, &error);
+    nitf_IOInterface_destruct(&io);
+}
+
+TEST_CASE(testParallelDecompression)
+{
+    nitf_Error error;
+    nitf_IOHandle io;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageReader *imageReader;
+    nitf_Uint64 before, misses;
+
+    /* NBPP 12 images are read through the (built-in) decompressor */
+    TEST_ASSERT(writeImage(TEST_FILE_NAME_12, 12, 1, &error));
+
+    io = nitf_IOHandle_create(TEST_FILE_NAME_12, NITF_ACCESS_READONLY,
+                              NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(!NITF_INVALID_HANDLE(io));
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    record = nitf_Reader_read(reader, io, &error);
+    TEST_ASSERT(record);
+
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+    nitf_ImageReader_setReadThreads(imageReader, 4);
+
+    /* Each block is decoded once, by a worker */
+    TEST_ASSERT(checkWindowBits(imageReader, 12, 0, 0, NUM_ROWS, NUM_COLS,
+                                &error));
+    nitf_ImageReader_getReadCacheStats(imageReader, NULL, &misses);
+    TEST_ASSERT_EQ_INT((int) misses, 16);
+
+    /* Windows that do not start or end on block boundaries */
+    TEST_ASSERT(checkWindowBits(imageReader, 12, 10, 10, 20, 20, &error));
+    TEST_ASSERT(checkWindowBits(imageReader, 12, 17, 3, 40, 61, &error));
+
+    /* With room for the whole image nothing is decoded twice */
+    nitf_ImageReader_setReadCacheSize(imageReader,
+                                      NUM_ROWS * NUM_COLS * 2);
+    TEST_ASSERT(checkWindowBits(imageReader, 12, 0, 0, NUM_ROWS, NUM_COLS,
+                                &error));
+    nitf_ImageReader_getReadCacheStats(imageReader, NULL, &before);
+    TEST_ASSERT(checkWindowBits(imageReader, 12, 5, 5, 50, 50, &error));
+    nitf_ImageReader_getReadCacheStats(imageReader, NULL, &misses);
+    TEST_ASSERT_EQ_INT((int) misses, (int) before);
+    nitf_ImageReader_destruct(&imageReader);
+
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOHandle_close(io);
+}
+
+TEST_CASE(testPipelinedWrite)
+{
+    nitf_Error error;
+    nitf_IOHandle io;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageReader *imageReader;
+
+    /* 16 bit pixels are byte swapped by the format stage */
+    TEST_ASSERT(writeImage(TEST_FILE_NAME_16, 16, 3, &error));
+
+    io = nitf_IOHandle_create(TEST_FILE_NAME_16, NITF_ACCESS_READONLY,
+                              NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(!NITF_INVALID_HANDLE(io));
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    record = nitf_Reader_read(reader, io, &error);
+    TEST_ASSERT(record);
+
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+    TEST_ASSERT(checkWindowBits(imageReader, 16, 0, 0, NUM_ROWS, NUM_COLS,
+                                &error));
+    TEST_ASSERT(checkWindowBits(imageReader, 16, 13, 7, 40, 50, &error));
+    nitf_ImageReader_destruct(&imageReader);
+
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOHandle_close(io);
+}
+
+TEST_CASE(testPackedPixels)
+{
+    nitf_Error error;
+    nitf_IOInterface *io;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageSegment *segment;
+    nitf_ImageReader *imageReader;
+
+    /* NBPP 1 (pixel type B) images are packed eight pixels to a byte */
+    TEST_ASSERT(writeImage(TEST_FILE_NAME_1, 1, 1, &error));
+
+    io = nitf_IOHandleAdapter_open(TEST_FILE_NAME_1, NITF_ACCESS_READONLY,
+                                   NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(io);
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    record = nitf_Reader_readIO(reader, io, &error);
+    TEST_ASSERT(record);
+    segment = (nitf_ImageSegment *) nitf_List_get(record->images, 0, &error);
+    TEST_ASSERT(segment);
+    TEST_ASSERT_EQ_INT((int) (segment->imageEnd - segment->imageOffset),
+                       NUM_ROWS * NUM_COLS / 8);
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+    TEST_ASSERT(checkWindowBits(imageReader, 1, 0, 0, NUM_ROWS, NUM_COLS,
+                                &error));
+    TEST_ASSERT(checkWindowBits(imageReader, 1, 3, 9, 50, 27, &error));
+    nitf_ImageReader_destruct(&imageReader);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOInterface_close(io, &error);
+    nitf_IOInterface_destruct(&io);
+
+    /* 12 bit blocks are unpacked straight from a mapping */
+    TEST_ASSERT(writeImage(TEST_FILE_NAME_12, 12, 1, &error));
+
+    io = nitf_MappedAdapter_open(TEST_FILE_NAME_12, &error);
+    TEST_ASSERT(io);
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    record = nitf_Reader_readIO(reader, io, &error);
+    TEST_ASSERT(record);
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+    TEST_ASSERT(checkWindowBits(imageReader, 12, 0, 0, NUM_ROWS, NUM_COLS,
+                                &error));
+    TEST_ASSERT(checkWindowBits(imageReader, 12, 21, 2, 30, 45, &error));
+    nitf_ImageReader_destruct(&imageReader);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOInterface_close(io, &error);
+    nitf_IOInterface_destruct(&io);
+}
+
+TEST_CASE(testCoalescedRead)
+{
+    nitf_Error error;
+    nitf_IOInterface *io;
+    nitf_IIOInterface *iface;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageReader *imageReader;
+    nitf_Uint32 nBits;
+
+    for (nBits = 8; nBits <= 16; nBits += 8)
+    {
+        TEST_ASSERT(writeImage(TEST_FILE_NAME_16, nBits, 1, &error));
+
+        io = nitf_IOHandleAdapter_open(TEST_FILE_NAME_16,
+                                       NITF_ACCESS_READONLY,
+                                       NITF_OPEN_EXISTING, &error);
+        TEST_ASSERT(io);
+        reader = nitf_Reader_construct(&error);
+        TEST_ASSERT(reader);
+        record = nitf_Reader_readIO(reader, io, &error);
+        TEST_ASSERT(record);
+        imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+        TEST_ASSERT(imageReader);
+
+        /* Count the pixel reads */
+        iface = io->iface;
+        countingInterface = *iface;
+        countedReadAt = iface->readAt;
+        countingInterface.readAt = countingReadAt;
+        io->iface = &countingInterface;
+
+        /* The rows of each block are read at once */
+        readCount = 0;
+        TEST_ASSERT(checkWindowBits(imageReader, nBits, 0, 0,
+                                    NUM_ROWS, NUM_COLS, &error));
+        TEST_ASSERT_EQ_INT(readCount, 16);
+
+        readCount = 0;
+        TEST_ASSERT(checkWindowBits(imageReader, nBits, 10, 10, 20, 20,
+                                    &error));
+        TEST_ASSERT_EQ_INT(readCount, 4);
+
+        TEST_ASSERT(checkWindowBits(imageReader, nBits, 3, 17, 61, 1,
+                                    &error));
+        TEST_ASSERT(checkWindowBits(imageReader, nBits, 63, 0, 1, 64,
+                                    &error));
+
+        io->iface = iface;
+        nitf_ImageReader_destruct(&imageReader);
+        nitf_Record_destruct(&record);
+        nitf_Reader_destruct(&reader);
+        nitf_IOInterface_close(io, &error);
+        nitf_IOInterface_destruct(&io);
+    }
+}
+
+/*
+ *  Header fields compared between a buffered and an unbuffered parse
+ */
+static const size_t fileHeaderFields[] =
+{
+    offsetof(nitf_FileHeader, fileHeader),
+    offsetof(nitf_FileHeader, fileVersion),
+    offsetof(nitf_FileHeader, complianceLevel),
+    offsetof(nitf_FileHeader, systemType),
+    offsetof(nitf_FileHeader, originStationID),
+    offsetof(nitf_FileHeader, fileDateTime),
+    offsetof(nitf_FileHeader, fileTitle),
+    offsetof(nitf_FileHeader, classification),
+    offsetof(nitf_FileHeader, messageCopyNum),
+    offsetof(nitf_FileHeader, messageNumCopies),
+    offsetof(nitf_FileHeader, encrypted),
+    offsetof(nitf_FileHeader, backgroundColor),
+    offsetof(nitf_FileHeader, originatorName),
+    offsetof(nitf_FileHeader, originatorPhone),
+    offsetof(nitf_FileHeader, fileLength),
+    offsetof(nitf_FileHeader, headerLength),
+    offsetof(nitf_FileHeader, numImages),
+    offsetof(nitf_FileHeader, numGraphics),
+    offsetof(nitf_FileHeader, numLabels),
+    offsetof(nitf_FileHeader, numTexts),
+    offsetof(nitf_FileHeader, numDataExtensions),
+    offsetof(nitf_FileHeader, numReservedExtensions),
+    offsetof(nitf_FileHeader, userDefinedHeaderLength),
+    offsetof(nitf_FileHeader, extendedHeaderLength)
+};
+
+static const size_t imageSubheaderFields[] =
+{
+    offsetof(nitf_ImageSubheader, filePartType),
+    offsetof(nitf_ImageSubheader, imageId),
+    offsetof(nitf_ImageSubheader, imageDateAndTime),
+    offsetof(nitf_ImageSubheader, targetId),
+    offsetof(nitf_ImageSubheader, imageTitle),
+    offsetof(nitf_ImageSubheader, imageSecurityClass),
+    offsetof(nitf_ImageSubheader, encrypted),
+    offsetof(nitf_ImageSubheader, imageSource),
+    offsetof(nitf_ImageSubheader, numRows),
+    offsetof(nitf_ImageSubheader, numCols),
+    offsetof(nitf_ImageSubheader, pixelValueType),
+    offsetof(nitf_ImageSubheader, imageRepresentation),
+    offsetof(nitf_ImageSubheader, imageCategory),
+    offsetof(nitf_ImageSubheader, actualBitsPerPixel),
+    offsetof(nitf_ImageSubheader, pixelJustification),
+    offsetof(nitf_ImageSubheader, imageCoordinateSystem),
+    offsetof(nitf_ImageSubheader, numImageComments),
+    offsetof(nitf_ImageSubheader, imageCompression),
+    offsetof(nitf_ImageSubheader, numImageBands),
+    offsetof(nitf_ImageSubheader, imageSyncCode),
+    offsetof(nitf_ImageSubheader, imageMode),
+    offsetof(nitf_ImageSubheader, numBlocksPerRow),
+    offsetof(nitf_ImageSubheader, numBlocksPerCol),
+    offsetof(nitf_ImageSubheader, numPixelsPerHorizBlock),
+    offsetof(nitf_ImageSubheader, numPixelsPerVertBlock),
+    offsetof(nitf_ImageSubheader, numBitsPerPixel),
+    offsetof(nitf_ImageSubheader, imageDisplayLevel),
+    offsetof(nitf_ImageSubheader, imageAttachmentLevel),
+    offsetof(nitf_ImageSubheader, imageLocation),
+    offsetof(nitf_ImageSubheader, imageMagnification),
+    offsetof(nitf_ImageSubheader, userDefinedImageDataLength),
+    offsetof(nitf_ImageSubheader, extendedHeaderLength)
+};
+
+static const size_t bandInfoFields[] =
+{
+    offsetof(nitf_BandInfo, representation),
+    offsetof(nitf_BandInfo, subcategory),
+    offsetof(nitf_BandInfo, imageFilterCondition),
+    offsetof(nitf_BandInfo, imageFilterCode),
+    offsetof(nitf_BandInfo, numLUTs),
+    offsetof(nitf_BandInfo, bandEntriesPerLUT)
+};
+
+static NITF_BOOL sameFields(const void *a, const void *b,
+                            const size_t *offsets, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; ++i)
+    {
+        const nitf_Field *fa = *(nitf_Field * const *)
+            ((const char *) a + offsets[i]);
+        const nitf_Field *fb = *(nitf_Field * const *)
+            ((const char *) b + offsets[i]);
+
+        if (fa->length != fb->length ||
+                memcmp(fa->raw, fb->raw, fa->length) != 0)
+            return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+/*
+ *  Parse the headers through a counting interface, returning the record
+ *  and the number of reads
+ */
+static nitf_Record *countedParse(nitf_Reader *reader, nitf_IOInterface *io,
+                                 int *reads, nitf_Error *error)
+{
+    nitf_IIOInterface *iface = io->iface;
+    nitf_Record *record;
+
+    countingInterface = *iface;
+    countedRead = iface->read;
+    countingInterface.read = countingRead;
+    io->iface = &countingInterface;
+
+    readCount = 0;
+    record = nitf_Reader_readIO(reader, io, error);
+    *reads = readCount;
+
+    io->iface = iface;
+    return record;
+}
+
+TEST_CASE(testBufferedHeaders)
+{
+    nitf_Error error;
+    nitf_IOInterface *io;
+    nitf_IOInterface *mappedIO;
+    nitf_Reader *reader;
+    nitf_Reader *mappedReader;
+    nitf_Record *record;
+    nitf_Record *mappedRecord;
+    nitf_ImageSegment *segment;
+    nitf_ImageSegment *mappedSegment;
+    int reads;
+    int mappedReads;
+
+    TEST_ASSERT(writeImage(TEST_FILE_NAME, 8, 1, &error));
+    io = nitf_IOHandleAdapter_open(TEST_FILE_NAME, NITF_ACCESS_READONLY,
+                                   NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(io);
+
+    /* A mapped input is parsed directly, one read per field */
+    mappedIO = nitf_MappedAdapter_open(TEST_FILE_NAME, &error);
+    TEST_ASSERT(mappedIO);
+    TEST_ASSERT(nitf_IOInterface_getBuffer(mappedIO, 0, 1));
+    mappedReader = nitf_Reader_construct(&error);
+    TEST_ASSERT(mappedReader);
+    mappedRecord = countedParse(mappedReader, mappedIO, &mappedReads, &error);
+    TEST_ASSERT(mappedRecord);
+
+    /*
+     *  A file is parsed through the header buffer: the first fill holds
+     *  the file header and the image subheader, since the read ahead is
+     *  larger than both, and the pixels are not read by the parse
+     */
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    record = countedParse(reader, io, &reads, &error);
+    TEST_ASSERT(record);
+    TEST_ASSERT_EQ_INT(reads, 1);
+    TEST_ASSERT(mappedReads > 50);
+
+    /* Both parses give the same record */
+    TEST_ASSERT(sameFields(record->header, mappedRecord->header,
+                           fileHeaderFields,
+                           sizeof(fileHeaderFields) / sizeof(size_t)));
+    TEST_ASSERT_EQ_STR(record->header->imageInfo[0]->lengthSubheader->raw,
+                       mappedRecord->header->imageInfo[0]->lengthSubheader->raw);
+    TEST_ASSERT_EQ_STR(record->header->imageInfo[0]->lengthData->raw,
+                       mappedRecord->header->imageInfo[0]->lengthData->raw);
+    segment = (nitf_ImageSegment *) nitf_List_get(record->images, 0, &error);
+    mappedSegment = (nitf_ImageSegment *) nitf_List_get(mappedRecord->images,
+                                                        0, &error);
+    TEST_ASSERT(segment);
+    TEST_ASSERT(mappedSegment);
+    TEST_ASSERT(sameFields(segment->subheader, mappedSegment->subheader,
+                           imageSubheaderFields,
+                           sizeof(imageSubheaderFields) / sizeof(size_t)));
+    TEST_ASSERT(sameFields(segment->subheader->bandInfo[0],
+                           mappedSegment->subheader->bandInfo[0],
+                           bandInfoFields,
+                           sizeof(bandInfoFields) / sizeof(size_t)));
+    TEST_ASSERT(segment->imageOffset == mappedSegment->imageOffset);
+    TEST_ASSERT(segment->imageEnd == mappedSegment->imageEnd);
+
+    /* The input is left where the parse ended, past the last header */
+    TEST_ASSERT(nitf_IOInterface_tell(io, &error) ==
+                nitf_IOInterface_tell(mappedIO, &error));
+
+    nitf_Record_destruct(&mappedRecord);
+    nitf_Reader_destruct(&mappedReader);
+    nitf_IOInterface_close(mappedIO, &error);
+    nitf_IOInterface_destruct(&mappedIO);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOInterface_close(io, &error);
+    nitf_IOInterface_destruct(&io);
+}
+
+/*
+ *  Check a down-sampled read against a weighted mean of the full resolution
+ *  pixels in each window (Gaussian with the default sigma if gaussian is
+ *  set, otherwise a box)
+ */
+static NITF_BOOL checkAverage(nitf_ImageReader *imageReader,
+                              nitf_Uint32 nBits, nitf_Uint32 skip,
+                              NITF_BOOL gaussian, nitf_Error *error)
+{
+    nitf_SubWindow *subWindow;
+    nitf_DownSampler *downSampler;
+    nitf_Uint32 bandList[1] = { 0 };
+    nitf_Uint32 numRows = (NUM_ROWS + skip - 1) / skip;
+    nitf_Uint32 numCols = (NUM_COLS + skip - 1) / skip;
+    nitf_Uint8 *buffer;
+    nitf_Uint32 row, col, r, c;
+    int padded;
+    NITF_BOOL status = NITF_SUCCESS;
+
+    subWindow = nitf_SubWindow_construct(error);
+    if (!subWindow)
+        return NITF_FAILURE;
+    downSampler = gaussian ?
+        nitf_GaussianDownSample_construct(skip, skip, 0, error) :
+        nitf_BoxDownSample_construct(skip, skip, error);
+    if (!downSampler)
+        return NITF_FAILURE;
+    subWindow->numRows = numRows;
+    subWindow->numCols = numCols;
+    subWindow->bandList = bandList;
+    subWindow->numBands = 1;
+    if (!nitf_SubWindow_setDownSampler(subWindow, downSampler, error))
+        return NITF_FAILURE;
+
+    buffer = (nitf_Uint8 *) NITF_MALLOC(numRows * numCols *
+                                        NITF_NBPP_TO_BYTES(nBits));
+    if (!buffer || !nitf_ImageReader_read(imageReader, subWindow, &buffer,
+                                          &padded, error))
+        status = NITF_FAILURE;
+
+    for (row = 0; status && row < numRows; ++row)
+        for (col = 0; col < numCols; ++col)
+        {
+            double sum = 0, weights = 0, center = (skip - 1) / 2.0;
+            for (r = row * skip; r < (row + 1) * skip && r < NUM_ROWS; ++r)
+                for (c = col * skip; c < (col + 1) * skip && c < NUM_COLS;
+                     ++c)
+                {
+                    double dr = r - row * skip - center;
+                    double dc = c - col * skip - center;
+                    double w = gaussian ?
+                        exp(-(dr * dr + dc * dc) / (skip * skip / 2.0)) : 1;
+                    sum += w * pixelAt(r, c, nBits);
+                    weights += w;
+                }
+            if (getPixel(buffer, row * numCols + col, nBits) !=
+                (nitf_Uint16) floor(sum / weights + 0.5))
+            {
+                status = NITF_FAILURE;
+                break;
+            }
+        }
+
+    if (buffer)
+        NITF_FREE(buffer);
+    nitf_SubWindow_destruct(&subWindow);
+    nitf_DownSampler_destruct(&downSampler);
+    return status;
+}
+
+TEST_CASE(testAverageDownSample)
+{
+    nitf_Error error;
+    nitf_IOInterface *io;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageReader *imageReader;
+    nitf_Uint32 nBits;
+
+    for (nBits = 8; nBits <= 16; nBits += 8)
+    {
+        TEST_ASSERT(writeImage(TEST_FILE_NAME_16, nBits, 1, &error));
+
+        io = nitf_IOHandleAdapter_open(TEST_FILE_NAME_16,
+                                       NITF_ACCESS_READONLY,
+                                       NITF_OPEN_EXISTING, &error);
+        TEST_ASSERT(io);
+        reader = nitf_Reader_construct(&error);
+        TEST_ASSERT(reader);
+        record = nitf_Reader_readIO(reader, io, &error);
+        TEST_ASSERT(record);
+        imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+        TEST_ASSERT(imageReader);
+
+        /* Windows of 3 leave a partial window at the edges */
+        TEST_ASSERT(checkAverage(imageReader, nBits, 2, 0, &error));
+        TEST_ASSERT(checkAverage(imageReader, nBits, 3, 0, &error));
+        TEST_ASSERT(checkAverage(imageReader, nBits, 3, 1, &error));
+        TEST_ASSERT(checkAverage(imageReader, nBits, 4, 0, &error));
+        TEST_ASSERT(checkAverage(imageReader, nBits, 4, 1, &error));
+        TEST_ASSERT(checkAverage(imageReader, nBits, 8, 0, &error));
+        TEST_ASSERT(checkAverage(imageReader, nBits, 8, 1, &error));
+
+        nitf_ImageReader_destruct(&imageReader);
+        nitf_Record_destruct(&record);
+        nitf_Reader_destruct(&reader);
+        nitf_IOInterface_close(io, &error);
+        nitf_IOInterface_destruct(&io);
+    }
+}
+
+/*
+ *  Reads the whole image with a pixel skip down-sampler and checks the
+ *  samples
+ */
+static NITF_BOOL checkSkip(nitf_ImageReader *imageReader,
+                           nitf_Uint32 nBits, nitf_Uint32 skip,
+                           nitf_Error *error)
+{
+    nitf_SubWindow *subWindow;
+    nitf_DownSampler *downSampler;
+    nitf_Uint32 bandList[1] = { 0 };
+    nitf_Uint32 numRows = NUM_ROWS / skip;
+    nitf_Uint32 numCols = NUM_COLS / skip;
+    nitf_Uint8 *buffer;
+    nitf_Uint32 row, col;
+    int padded;
+    NITF_BOOL status = NITF_SUCCESS;
+
+    subWindow = nitf_SubWindow_construct(error);
+    if (!subWindow)
+        return NITF_FAILURE;
+    downSampler = nitf_PixelSkip_construct(skip, skip, error);
+    if (!downSampler)
+        return NITF_FAILURE;
+    subWindow->numRows = numRows;
+    subWindow->numCols = numCols;
+    subWindow->bandList = bandList;
+    subWindow->numBands = 1;
+    if (!nitf_SubWindow_setDownSampler(subWindow, downSampler, error))
+        return NITF_FAILURE;
+
+    buffer = (nitf_Uint8 *) NITF_MALLOC(numRows * numCols *
+                                        NITF_NBPP_TO_BYTES(nBits));
+    if (!buffer || !nitf_ImageReader_read(imageReader, subWindow, &buffer,
+                                          &padded, error))
+        status = NITF_FAILURE;
+
+    for (row = 0; status && row < numRows; ++row)
+        for (col = 0; col < numCols; ++col)
+            if (getPixel(buffer, row * numCols + col, nBits) !=
+                pixelAt(row * skip, col * skip, nBits))
+            {
+                status = NITF_FAILURE;
+                break;
+            }
+
+    if (buffer)
+        NITF_FREE(buffer);
+    nitf_SubWindow_destruct(&subWindow);
+    nitf_DownSampler_destruct(&downSampler);
+    return status;
+}
+
+TEST_CASE(testScaledDecodeFallback)
+{
+    nitf_Error error;
+    nitf_IOInterface *io;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageReader *imageReader;
+
+    /*
+     *  The NBPP 12 decompressor does not decode at reduced resolution, so
+     *  pixel skip reads still return the full resolution samples
+     */
+    TEST_ASSERT(writeImage(TEST_FILE_NAME_12, 12, 1, &error));
+
+    io = nitf_IOHandleAdapter_open(TEST_FILE_NAME_12, NITF_ACCESS_READONLY,
+                                   NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(io);
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    record = nitf_Reader_readIO(reader, io, &error);
+    TEST_ASSERT(record);
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+    nitf_ImageReader_setReadThreads(imageReader, 2);
+    nitf_ImageReader_setScaledDecode(imageReader, 1);
+
+    /* The second read of a factor uses the declined state */
+    TEST_ASSERT(checkSkip(imageReader, 12, 2, &error));
+    TEST_ASSERT(checkSkip(imageReader, 12, 2, &error));
+    TEST_ASSERT(checkSkip(imageReader, 12, 4, &error));
+    TEST_ASSERT(checkWindowBits(imageReader, 12, 17, 3, 40, 61, &error));
+
+    nitf_ImageReader_setScaledDecode(imageReader, 0);
+    TEST_ASSERT(checkSkip(imageReader, 12, 8, &error));
+
+    nitf_ImageReader_destruct(&imageReader);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOInterface_close(io, &error);
+    nitf_IOInterface_destruct(&io);
+}
+
+TEST_CASE(testPadMask)
+{
+    nitf_Error error;
+    nitf_IOInterface *io;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageSegment *segment;
+    nitf_ImageReader *imageReader;
+    nitf_Uint32 imageDataOffset;
+    nitf_Uint32 blockRecordLength;
+    nitf_Uint32 padRecordLength;
+    nitf_Uint32 padPixelValueLength;
+    nitf_Uint8 *padValue;
+    nitf_Uint64 *blockMask;
+    nitf_Uint64 *padMask;
+    nitf_Uint8 fileMask[NUM_BLOCKS * 4];
+    nitf_Uint32 i;
+    int numPadded = 0;
+
+    /*
+     *  The pixels are 0 (the pad value) along a few lines, so some of the
+     *  blocks of the uncompressed masked image are in the pad mask
+     */
+    TEST_ASSERT(writeCompressedImage(TEST_FILE_NAME_NM, 8, 1, "NM", &error));
+
+    io = nitf_IOHandleAdapter_open(TEST_FILE_NAME_NM, NITF_ACCESS_READONLY,
+                                   NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(io);
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    record = nitf_Reader_readIO(reader, io, &error);
+    TEST_ASSERT(record);
+    segment = (nitf_ImageSegment *) nitf_List_get(record->images, 0, &error);
+    TEST_ASSERT(segment);
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+    TEST_ASSERT(checkWindow(imageReader, 0, 0, NUM_ROWS, NUM_COLS, &error));
+
+    TEST_ASSERT(nitf_ImageIO_getMaskInfo(imageReader->imageDeblocker,
+                                         &imageDataOffset,
+                                         &blockRecordLength,
+                                         &padRecordLength,
+                                         &padPixelValueLength, &padValue,
+                                         &blockMask, &padMask));
+    TEST_ASSERT_EQ_INT(padRecordLength, 4);
+
+    /* The pad mask is the last thing before the pixels, big endian */
+    TEST_ASSERT(nitf_IOInterface_readAt(io, (nitf_Off) (segment->imageOffset
+                                                        + imageDataOffset
+                                                        - sizeof(fileMask)),
+                                        fileMask, sizeof(fileMask), &error));
+    for (i = 0; i < NUM_BLOCKS; ++i)
+    {
+        nitf_Uint8 *entry = fileMask + i * 4;
+        nitf_Uint64 offset = ((nitf_Uint64) entry[0] << 24) |
+            ((nitf_Uint64) entry[1] << 16) | ((nitf_Uint64) entry[2] << 8) |
+            entry[3];
+
+        TEST_ASSERT(padMask[i] == offset);
+        if (offset != NITF_IMAGE_IO_NO_OFFSET)
+        {
+            TEST_ASSERT(padMask[i] == blockMask[i]);
+            ++numPadded;
+        }
+    }
+    TEST_ASSERT(numPadded > 0 && numPadded < NUM_BLOCKS);
+
+    nitf_ImageReader_destruct(&imageReader);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOInterface_close(io, &error);
+    nitf_IOInterface_destruct(&io);
+}
+
+/*
+ *  Holds the first pixel read at a gate until the test opens it, so that
+ *  a second read starts while the first is in progress
+ */
+static NRT_IO_INTERFACE_READ_AT gatedReadAt;
+static nitf_Mutex gateLock;
+static nitf_Condition gateChanged;
+static int gateState;           /* 0 closed, 1 a read is held, 2 open */
+
+static NITF_BOOL holdingReadAt(NITF_DATA *data, nitf_Off offset,
+                               void *buf, size_t size, nitf_Error *error)
+{
+    nitf_Mutex_lock(&gateLock);
+    if (gateState == 0)
+    {
+        gateState = 1;
+        nitf_Condition_broadcast(&gateChanged);
+        while (gateState != 2)
+            nitf_Condition_wait(&gateChanged, &gateLock);
+    }
+    nitf_Mutex_unlock(&gateLock);
+    return (*gatedReadAt)(data, offset, buf, size, error);
+}
+
+typedef struct _RGBReadTask
+{
+    nitf_ImageReader *imageReader;
+    nitf_Uint32 numBands;
+    NITF_BOOL status;
+} RGBReadTask;
+
+/* Reads the whole image as one band of RGB triples or as three bands */
+static NITF_DATA* rgbReadTask(NITF_DATA *data)
+{
+    RGBReadTask *task = (RGBReadTask *) data;
+    nitf_Error error;
+    nitf_SubWindow *subWindow;
+    nitf_Uint32 bandList[3] = { 0, 1, 2 };
+    nitf_Uint8 *buffers[3];
+    nitf_Uint8 *pixels;
+    nitf_Uint32 row, col, band;
+    int padded;
+
+    task->status = NITF_FAILURE;
+    pixels = (nitf_Uint8 *) NITF_MALLOC(3 * NUM_ROWS * NUM_COLS);
+    subWindow = nitf_SubWindow_construct(&error);
+    if (!pixels || !subWindow)
+        goto CATCH_ERROR;
+    for (band = 0; band < 3; ++band)
+        buffers[band] = pixels + band * NUM_ROWS * NUM_COLS;
+    subWindow->numRows = NUM_ROWS;
+    subWindow->numCols = NUM_COLS;
+    subWindow->bandList = bandList;
+    subWindow->numBands = task->numBands;
+
+    if (!nitf_ImageReader_read(task->imageReader, subWindow, buffers,
+                               &padded, &error))
+        goto CATCH_ERROR;
+
+    for (row = 0; row < NUM_ROWS; ++row)
+        for (col = 0; col < NUM_COLS; ++col)
+            for (band = 0; band < 3; ++band)
+                if (pixels[task->numBands == 1 ?
+                           (row * NUM_COLS + col) * 3 + band :
+                           (band * NUM_ROWS + row) * NUM_COLS + col]
+                    != rgbAt(row, col, band))
+                    goto CATCH_ERROR;
+    task->status = NITF_SUCCESS;
+
+  CATCH_ERROR:
+    if (subWindow)
+        nitf_SubWindow_destruct(&subWindow);
+    if (pixels)
+        NITF_FREE(pixels);
+    return NULL;
+}
+
+TEST_CASE(testRevertDuringRead)
+{
+    nitf_Error error;
+    nitf_IOInterface *io;
+    nitf_IIOInterface *iface;
+    nitf_IIOInterface gatedInterface;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageReader *imageReader;
+    nitf_Thread threads[2];
+    RGBReadTask tasks[2];
+    int i;
+
+    TEST_ASSERT(writeRGBImage(TEST_FILE_NAME_RGB, &error));
+
+    io = nitf_IOHandleAdapter_open(TEST_FILE_NAME_RGB, NITF_ACCESS_READONLY,
+                                   NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(io);
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    record = nitf_Reader_readIO(reader, io, &error);
+    TEST_ASSERT(record);
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+
+    /* RGB triples, this also does the one-time set-up */
+    tasks[0].imageReader = imageReader;
+    tasks[0].numBands = 1;
+    rgbReadTask(&tasks[0]);
+    TEST_ASSERT(tasks[0].status);
+
+    iface = io->iface;
+    gatedInterface = *iface;
+    gatedReadAt = iface->readAt;
+    gatedInterface.readAt = holdingReadAt;
+    io->iface = &gatedInterface;
+    nitf_Mutex_init(&gateLock);
+    nitf_Condition_init(&gateChanged);
+    gateState = 0;
+
+    /*
+     *  The three band read reverts the RGB24 mode, it waits for the read of
+     *  RGB triples held at the gate rather than failing
+     */
+    TEST_ASSERT(nitf_Thread_create(&threads[0], rgbReadTask, &tasks[0],
+                                   &error));
+    nitf_Mutex_lock(&gateLock);
+    while (gateState != 1)
+        nitf_Condition_wait(&gateChanged, &gateLock);
+    nitf_Mutex_unlock(&gateLock);
+
+    tasks[1].imageReader = imageReader;
+    tasks[1].numBands = 3;
+    TEST_ASSERT(nitf_Thread_create(&threads[1], rgbReadTask, &tasks[1],
+                                   &error));
+    nitf_Mutex_lock(&gateLock);
+    gateState = 2;
+    nitf_Condition_broadcast(&gateChanged);
+    nitf_Mutex_unlock(&gateLock);
+
+    for (i = 0; i < 2; ++i)
+        nitf_Thread_join(&threads[i]);
+    for (i = 0; i < 2; ++i)
+        TEST_ASSERT(tasks[i].status);
+
+    nitf_Condition_delete(&gateChanged);
+    nitf_Mutex_delete(&gateLock);
+    io->iface = iface;
+    nitf_ImageReader_destruct(&imageReader);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOInterface_close(io, &error);
+    nitf_IOInterface_destruct(&io);
+}
+
+int main(int argc, char **argv)
+{
+    CHECK(testReadCache);
+    CHECK(testPositionalRead);
+    CHECK(testConcurrentPositionalRead);
+    CHECK(testMappedRead);
+    CHECK(testParallelDecompression);
+    CHECK(testPipelinedWrite);
+    CHECK(testPackedPixels);
+    CHECK(testCoalescedRead);
+    CHECK(testBufferedHeaders);
+    CHECK(testAverageDownSample);
+    CHECK(testScaledDecodeFallback);
+    CHECK(testPadMask);
+    CHECK(testRevertDuringRead);
+    return 0;
+}
@@ -0,0 +1,682 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+/*
+ * Writes C3 and M3 images with the JPEG plugins and reads them back. The
+ * plugins are found on the plugin path, and the tests are skipped when
+ * they are not there (libjpeg was not found by the build).
+ */
+
+#include <import/nitf.h>
+#include "Test.h"
+
+#define TEST_FILE_NAME "test_jpeg.ntf"
+#define TEST_FILE_NAME_MT "test_jpeg_mt.ntf"
+#define NUM_ROWS 256
+#define NUM_COLS 256
+#define BLOCK_SIZE 64
+#define NUM_BLOCKS ((NUM_ROWS / BLOCK_SIZE) * (NUM_COLS / BLOCK_SIZE))
+#define QUALITY 95
+#define NO_BLOCK (-1)
+
+/* Not in the headers, a diagnostic function (see test_dump_masks) */
+NITF_BOOL nitf_ImageIO_getMaskInfo(nitf_ImageIO *nitf,
+                                   nitf_Uint32 *imageDataOffset,
+                                   nitf_Uint32 *blockRecordLength,
+                                   nitf_Uint32 *padRecordLength,
+                                   nitf_Uint32 *padPixelValueLength,
+                                   nitf_Uint8 **padValue,
+                                   nitf_Uint64 **blockMask,
+                                   nitf_Uint64 **padMask);
+
+/*
+ *  A smooth image, which JPEG keeps within a few counts, with a stripe in
+ *  the odd columns. The stripe separates a box average (which includes
+ *  half of it) from a pixel skip, which only sees the even columns.
+ */
+static nitf_Uint8 pixelAt(nitf_Uint32 row, nitf_Uint32 col)
+{
+    return (nitf_Uint8) (40 + (row + col) / 4 + (col % 2) * 12);
+}
+
+static NITF_BOOL inBlock(nitf_Uint32 row, nitf_Uint32 col, int block)
+{
+    return block != NO_BLOCK &&
+        (int) ((row / BLOCK_SIZE) * (NUM_COLS / BLOCK_SIZE)
+               + col / BLOCK_SIZE) == block;
+}
+
+static NITF_BOOL haveJPEG(void)
+{
+    nitf_Error error;
+    int bad = 0;
+    nitf_PluginRegistry *reg = nitf_PluginRegistry_getInstance(&error);
+
+    if (!reg ||
+        !nitf_PluginRegistry_retrieveCompConstructor(reg, "C3", &bad, &error)
+        || !nitf_PluginRegistry_retrieveDecompConstructor(reg, "C3", &bad,
+                                                          &error))
+    {
+        fprintf(stderr, "No JPEG plugins on the plugin path, skipping\n");
+        return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+/*
+ *  Write a one band C3 or M3 image. The empty block (if not NO_BLOCK) is
+ *  all pad pixels, and the pad block has a row of them.
+ */
+static NITF_BOOL writeJPEG(const char *filename, const char *compression,
+                           nitf_Uint32 numThreads, int emptyBlock,
+                           int padBlock, nitf_Error *error)
+{
+    nitf_Record *record = NULL;
+    nitf_ImageSegment *segment;
+    nitf_BandInfo **bands;
+    nitf_IOHandle out;
+    nitf_Writer *writer = NULL;
+    nitf_ImageWriter *imageWriter;
+    nitf_ImageSource *imageSource;
+    nitf_BandSource *bandSource;
+    nitf_HashTable *options = NULL;
+    nitf_Uint32 quality = QUALITY;
+    nitf_Uint8 *data = NULL;
+    nitf_Uint8 pad = 0;         /* The default pad pixel */
+    nitf_Uint32 row, col;
+    NITF_BOOL status = NITF_FAILURE;
+
+    data = (nitf_Uint8 *) NITF_MALLOC(NUM_ROWS * NUM_COLS);
+    if (!data)
+        goto CATCH_ERROR;
+    for (row = 0; row < NUM_ROWS; ++row)
+        for (col = 0; col < NUM_COLS; ++col)
+            data[row * NUM_COLS + col] =
+                (inBlock(row, col, emptyBlock) ||
+                 (inBlock(row, col, padBlock) && row % BLOCK_SIZE == 0))
+                ? pad : pixelAt(row, col);
+
+    record = nitf_Record_construct(NITF_VER_21, error);
+    if (!record)
+        goto CATCH_ERROR;
+    segment = nitf_Record_newImageSegment(record, error);
+    if (!segment)
+        goto CATCH_ERROR;
+
+    bands = (nitf_BandInfo **) NITF_MALLOC(sizeof(nitf_BandInfo *));
+    if (!bands)
+        goto CATCH_ERROR;
+    bands[0] = nitf_BandInfo_construct(error);
+    if (!bands[0])
+        goto CATCH_ERROR;
+    if (!nitf_BandInfo_init(bands[0], "M", " ", "N", "   ", 0, 0, NULL, error))
+        goto CATCH_ERROR;
+    if (!nitf_ImageSubheader_setPixelInformation(segment->subheader, "INT",
+                                                 8, 8, "R", "MONO", "VIS",
+                                                 1, bands, error))
+        goto CATCH_ERROR;
+    if (!nitf_ImageSubheader_setBlocking(segment->subheader,
+                                         NUM_ROWS, NUM_COLS,
+                                         BLOCK_SIZE, BLOCK_SIZE, "B", error))
+        goto CATCH_ERROR;
+    if (!nitf_ImageSubheader_setCompression(segment->subheader, compression,
+                                            "", error))
+        goto CATCH_ERROR;
+
+    options = nitf_HashTable_construct(4, error);
+    if (!options)
+        goto CATCH_ERROR;
+    nitf_HashTable_setPolicy(options, NITF_DATA_RETAIN_OWNER);
+    if (!nitf_HashTable_insert(options, C3_QUALITY_KEY, &quality, error) ||
+        !nitf_HashTable_insert(options, C3_NUM_THREADS_KEY, &numThreads,
+                               error))
+        goto CATCH_ERROR;
+
+    out = nitf_IOHandle_create(filename, NITF_ACCESS_WRITEONLY,
+                               NITF_CREATE, error);
+    if (NITF_INVALID_HANDLE(out))
+        goto CATCH_ERROR;
+
+    writer = nitf_Writer_construct(error);
+    if (!writer)
+        goto CATCH_ERROR;
+    if (!nitf_Writer_prepare(writer, record, out, error))
+        goto CATCH_ERROR;
+
+    imageWriter = nitf_Writer_newImageWriter(writer, 0, options, error);
+    if (!imageWriter)
+        goto CATCH_ERROR;
+    imageSource = nitf_ImageSource_construct(error);
+    if (!imageSource)
+        goto CATCH_ERROR;
+    bandSource = nitf_MemorySource_construct(data, NUM_ROWS * NUM_COLS,
+                                             0, 1, 0, error);
+    if (!bandSource)
+        goto CATCH_ERROR;
+    if (!nitf_ImageSource_addBand(imageSource, bandSource, error))
+        goto CATCH_ERROR;
+    if (!nitf_ImageWriter_attachSource(imageWriter, imageSource, error))
+        goto CATCH_ERROR;
+    if (!nitf_Writer_write(writer, error))
+        goto CATCH_ERROR;
+
+    nitf_IOHandle_close(out);
+    status = NITF_SUCCESS;
+
+  CATCH_ERROR:
+    if (writer)
+        nitf_Writer_destruct(&writer);
+    if (record)
+        nitf_Record_destruct(&record);
+    if (options)
+        nitf_HashTable_destruct(&options);
+    if (data)
+        NITF_FREE(data);
+    return status;
+}
+
+/* An open image, for reading */
+typedef struct _JPEGFile
+{
+    nitf_IOInterface *io;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageReader *imageReader;
+}
+JPEGFile;
+
+static void closeJPEG(JPEGFile *file)
+{
+    if (file->imageReader)
+        nitf_ImageReader_destruct(&file->imageReader);
+    if (file->record)
+        nitf_Record_destruct(&file->record);
+    if (file->reader)
+        nitf_Reader_destruct(&file->reader);
+    if (file->io)
+    {
+        nitf_Error error;
+        nitf_IOInterface_close(file->io, &error);
+        nitf_IOInterface_destruct(&file->io);
+    }
+}
+
+static NITF_BOOL openJPEG(JPEGFile *file, const char *filename,
+                          nitf_Error *error)
+{
+    memset(file, 0, sizeof(JPEGFile));
+    file->io = nitf_IOHandleAdapter_open(filename, NITF_ACCESS_READONLY,
+                                         NITF_OPEN_EXISTING, error);
+    if (file->io)
+        file->reader = nitf_Reader_construct(error);
+    if (file->reader)
+        file->record = nitf_Reader_readIO(file->reader, file->io, error);
+    if (file->record)
+        file->imageReader = nitf_Reader_newImageReader(file->reader, 0, NULL,
+                                                       error);
+    if (!file->imageReader)
+    {
+        closeJPEG(file);
+        return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+/*
+ *  Read a window into buffer. With a down-sampler, the window size is
+ *  given in down-sampled rows and columns.
+ */
+static NITF_BOOL readWindow(nitf_ImageReader *imageReader,
+                            nitf_Uint32 startRow, nitf_Uint32 startCol,
+                            nitf_Uint32 numRows, nitf_Uint32 numCols,
+                            nitf_DownSampler *downSampler,
+                            nitf_Uint8 *buffer, nitf_Error *error)
+{
+    nitf_SubWindow *subWindow;
+    nitf_Uint32 bandList[1] = { 0 };
+    int padded;
+    NITF_BOOL status;
+
+    subWindow = nitf_SubWindow_construct(error);
+    if (!subWindow)
+        return NITF_FAILURE;
+    subWindow->startRow = startRow;
+    subWindow->startCol = startCol;
+    subWindow->numRows = numRows;
+    subWindow->numCols = numCols;
+    subWindow->bandList = bandList;
+    subWindow->numBands = 1;
+
+    status = !downSampler ||
+        nitf_SubWindow_setDownSampler(subWindow, downSampler, error);
+    status = status && nitf_ImageReader_read(imageReader, subWindow, &buffer,
+                                             &padded, error);
+    nitf_SubWindow_destruct(&subWindow);
+    return status;
+}
+
+/*
+ *  Check a full resolution read of the whole image against the pixels
+ *  written, allowing for the JPEG error. The empty block reads as pad.
+ *  The DCT blocks holding the pad row of the pad block are not checked,
+ *  the edge rings through them.
+ */
+static NITF_BOOL checkImage(const nitf_Uint8 *buffer, int emptyBlock,
+                            int padBlock, int tolerance)
+{
+    nitf_Uint32 row, col;
+
+    for (row = 0; row < NUM_ROWS; ++row)
+        for (col = 0; col < NUM_COLS; ++col)
+        {
+            int value = buffer[row * NUM_COLS + col];
+            int expected = inBlock(row, col, emptyBlock) ? 0 :
+                pixelAt(row, col);
+
+            if (inBlock(row, col, padBlock) && row % BLOCK_SIZE < 8)
+                continue;
+            if (abs(value - expected) > tolerance)
+            {
+                fprintf(stderr, "Pixel (%u, %u) is %d, not %d\n",
+                        row, col, value, expected);
+                return NITF_FAILURE;
+            }
+        }
+    return NITF_SUCCESS;
+}
+
+/*
+ *  Replace the JFIF header (APP0) after the SOI of each block with a
+ *  comment of the same length that holds SOI markers. The scan for the
+ *  blocks must skip the comment, or it takes them for blocks.
+ */
+static NITF_BOOL addComments(const char *filename, nitf_Uint64 offset,
+                             nitf_Uint64 end)
+{
+    static const nitf_Uint8 app0[] = { 0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x10,
+                                       'J', 'F', 'I', 'F', 0x00 };
+    static const nitf_Uint8 comment[] = { 0xFF, 0xFE, 0x00, 0x10,
+                                          0xFF, 0xD8, 0xFF, 0xD8, 'S', 'O',
+                                          'I', 0xFF, 0xD8, 0xFF, 0xD8, 0 };
+    nitf_Uint8 *data;
+    size_t length = (size_t) (end - offset);
+    size_t i;
+    int found = 0;
+    FILE *file = fopen(filename, "r+b");
+
+    data = (nitf_Uint8 *) NITF_MALLOC(length);
+    if (!file || !data || fseek(file, (long) offset, SEEK_SET) != 0 ||
+        fread(data, 1, length, file) != length)
+    {
+        if (file)
+            fclose(file);
+        if (data)
+            NITF_FREE(data);
+        return NITF_FAILURE;
+    }
+    for (i = 0; i + 2 + sizeof(comment) <= length; ++i)
+    {
+        if (memcmp(data + i, app0, sizeof(app0)) == 0)
+        {
+            memcpy(data + i + 2, comment, sizeof(comment));
+            ++found;
+        }
+    }
+    fseek(file, (long) offset, SEEK_SET);
+    fwrite(data, 1, length, file);
+    fclose(file);
+    NITF_FREE(data);
+    return found == NUM_BLOCKS;
+}
+
+TEST_CASE(testCommentSOI)
+{
+    nitf_Error error;
+    JPEGFile file;
+    nitf_ImageSegment *segment;
+    nitf_Uint64 offset, end;
+    nitf_Uint8 *before, *after;
+    nitf_Uint32 size = NUM_ROWS * NUM_COLS;
+
+    before = (nitf_Uint8 *) NITF_MALLOC(size);
+    after = (nitf_Uint8 *) NITF_MALLOC(size);
+    TEST_ASSERT(before && after);
+
+    TEST_ASSERT(writeJPEG(TEST_FILE_NAME, "C3", 1, NO_BLOCK, NO_BLOCK, &error));
+    TEST_ASSERT(openJPEG(&file, TEST_FILE_NAME, &error));
+    TEST_ASSERT(readWindow(file.imageReader, 0, 0, NUM_ROWS, NUM_COLS,
+                           NULL, before, &error));
+    TEST_ASSERT(checkImage(before, NO_BLOCK, NO_BLOCK, 3));
+    segment = (nitf_ImageSegment *) nitf_List_get(file.record->images, 0,
+                                                  &error);
+    TEST_ASSERT(segment);
+    offset = segment->imageOffset;
+    end = segment->imageEnd;
+    closeJPEG(&file);
+
+    /* The comments change nothing else, so the pixels are the same */
+    TEST_ASSERT(addComments(TEST_FILE_NAME, offset, end));
+    TEST_ASSERT(openJPEG(&file, TEST_FILE_NAME, &error));
+    TEST_ASSERT(readWindow(file.imageReader, 0, 0, NUM_ROWS, NUM_COLS,
+                           NULL, after, &error));
+    TEST_ASSERT(memcmp(before, after, size) == 0);
+    closeJPEG(&file);
+
+    NITF_FREE(before);
+    NITF_FREE(after);
+}
+
+TEST_CASE(testMissingBlocks)
+{
+    nitf_Error error;
+    JPEGFile file;
+    nitf_Uint8 *buffer;
+    int emptyBlock;
+
+    buffer = (nitf_Uint8 *) NITF_MALLOC(NUM_ROWS * NUM_COLS);
+    TEST_ASSERT(buffer);
+
+    /* The first block, one inside, and the last */
+    for (emptyBlock = 0; emptyBlock < NUM_BLOCKS; emptyBlock += 5)
+    {
+        TEST_ASSERT(writeJPEG(TEST_FILE_NAME, "M3", 1, emptyBlock, NO_BLOCK,
+                              &error));
+        TEST_ASSERT(openJPEG(&file, TEST_FILE_NAME, &error));
+        TEST_ASSERT(readWindow(file.imageReader, 0, 0, NUM_ROWS,
+                               NUM_COLS, NULL, buffer, &error));
+        TEST_ASSERT(checkImage(buffer, emptyBlock, NO_BLOCK, 3));
+        closeJPEG(&file);
+    }
+    NITF_FREE(buffer);
+}
+
+/*
+ *  Read a window with a pixel skip and check it against the box average
+ *  of the pixels written. The skip only averages when the blocks are
+ *  decoded at reduced resolution.
+ */
+static NITF_BOOL checkScaled(nitf_ImageReader *imageReader,
+                             nitf_Uint32 skip,
+                             nitf_Uint32 startRow, nitf_Uint32 startCol,
+                             nitf_Uint32 numRows, nitf_Uint32 numCols,
+                             int tolerance, nitf_Error *error)
+{
+    nitf_DownSampler *downSampler;
+    nitf_Uint8 *buffer;
+    nitf_Uint32 row, col, i, j;
+    NITF_BOOL status;
+
+    downSampler = nitf_PixelSkip_construct(skip, skip, error);
+    buffer = (nitf_Uint8 *) NITF_MALLOC(numRows * numCols);
+    status = downSampler && buffer &&
+        readWindow(imageReader, startRow, startCol, numRows, numCols,
+                   downSampler, buffer, error);
+
+    for (row = 0; status && row < numRows; ++row)
+        for (col = 0; col < numCols; ++col)
+        {
+            int value = buffer[row * numCols + col];
+            int sum = 0;
+            int expected;
+
+            for (i = 0; i < skip; ++i)
+                for (j = 0; j < skip; ++j)
+                    sum += pixelAt(startRow + row * skip + i,
+                                   startCol + col * skip + j);
+            expected = (sum + (int) (skip * skip / 2)) / (int) (skip * skip);
+            if (abs(value - expected) > tolerance)
+            {
+                fprintf(stderr, "Skip %u pixel (%u, %u) is %d, not %d\n",
+                        skip, row, col, value, expected);
+                status = NITF_FAILURE;
+                break;
+            }
+        }
+
+    if (buffer)
+        NITF_FREE(buffer);
+    if (downSampler)
+        nitf_DownSampler_destruct(&downSampler);
+    return status;
+}
+
+TEST_CASE(testScaledDecode)
+{
+    nitf_Error error;
+    JPEGFile file;
+    nitf_Uint32 numThreads, skip;
+
+    TEST_ASSERT(writeJPEG(TEST_FILE_NAME, "C3", 1, NO_BLOCK, NO_BLOCK,
+                          &error));
+
+    /* One thread, and decoding on the read workers */
+    for (numThreads = 1; numThreads <= 4; numThreads += 3)
+    {
+        TEST_ASSERT(openJPEG(&file, TEST_FILE_NAME, &error));
+        nitf_ImageReader_setReadThreads(file.imageReader, numThreads);
+        nitf_ImageReader_setScaledDecode(file.imageReader, 1);
+        for (skip = 2; skip <= 8; skip *= 2)
+        {
+            /* The whole image, and a window inside the blocks */
+            TEST_ASSERT(checkScaled(file.imageReader, skip, 0, 0,
+                                    NUM_ROWS / skip, NUM_COLS / skip, 3,
+                                    &error));
+            TEST_ASSERT(checkScaled(file.imageReader, skip, 40, 72,
+                                    96 / skip, 104 / skip, 3, &error));
+        }
+        closeJPEG(&file);
+    }
+}
+
+/* Read a whole file, NULL on failure (length is then not set) */
+static nitf_Uint8 *readFile(const char *filename, size_t *length)
+{
+    nitf_Uint8 *data = NULL;
+    long size = 0;
+    FILE *file = fopen(filename, "rb");
+
+    if (!file)
+        return NULL;
+    if (fseek(file, 0, SEEK_END) == 0)
+        size = ftell(file);
+    if (size > 0 && fseek(file, 0, SEEK_SET) == 0)
+        data = (nitf_Uint8 *) NITF_MALLOC((size_t) size);
+    if (data && fread(data, 1, (size_t) size, file) != (size_t) size)
+    {
+        NITF_FREE(data);
+        data = NULL;
+    }
+    fclose(file);
+    if (data)
+        *length = (size_t) size;
+    return data;
+}
+
+/*
+ *  Check the masks of an M3 image. The empty block is in neither mask,
+ *  the pad block is in both, and every other block is only in the block
+ *  mask, where it starts with an SOI marker.
+ */
+static NITF_BOOL checkMasks(JPEGFile *file, int emptyBlock, int padBlock,
+                            nitf_Error *error)
+{
+    nitf_ImageSegment *segment;
+    nitf_Uint32 imageDataOffset;
+    nitf_Uint32 blockRecordLength;
+    nitf_Uint32 padRecordLength;
+    nitf_Uint32 padPixelValueLength;
+    nitf_Uint8 *padValue;
+    nitf_Uint64 *blockMask;
+    nitf_Uint64 *padMask;
+    nitf_Uint8 soi[2];
+    int block;
+
+    segment = (nitf_ImageSegment *) nitf_List_get(file->record->images, 0,
+                                                  error);
+    if (!segment ||
+        !nitf_ImageIO_getMaskInfo(file->imageReader->imageDeblocker,
+                                  &imageDataOffset, &blockRecordLength,
+                                  &padRecordLength, &padPixelValueLength,
+                                  &padValue, &blockMask, &padMask))
+        return NITF_FAILURE;
+    if (blockRecordLength != 4 || padRecordLength != 4 ||
+        padPixelValueLength != 1 || padValue[0] != 0)
+        return NITF_FAILURE;
+
+    for (block = 0; block < NUM_BLOCKS; ++block)
+    {
+        if (block == emptyBlock)
+        {
+            if (blockMask[block] != NITF_IMAGE_IO_NO_OFFSET ||
+                padMask[block] != NITF_IMAGE_IO_NO_OFFSET)
+                return NITF_FAILURE;
+            continue;
+        }
+        if (blockMask[block] == NITF_IMAGE_IO_NO_OFFSET ||
+            padMask[block] != (block == padBlock ? blockMask[block] :
+                               NITF_IMAGE_IO_NO_OFFSET))
+            return NITF_FAILURE;
+        if (!nitf_IOInterface_readAt(file->io,
+                                     (nitf_Off) (segment->imageOffset +
+                                                 imageDataOffset +
+                                                 blockMask[block]),
+                                     soi, 2, error) ||
+            soi[0] != 0xFF || soi[1] != 0xD8)
+            return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+TEST_CASE(testCompressThreads)
+{
+    static const char *compressions[] = { "C3", "M3" };
+    nitf_Error error;
+    JPEGFile file;
+    nitf_Uint8 *buffer;
+    nitf_Uint8 *single, *multi;
+    size_t singleLength, multiLength;
+    nitf_Uint32 numThreads;
+    int emptyBlock, padBlock;
+    int i;
+
+    buffer = (nitf_Uint8 *) NITF_MALLOC(NUM_ROWS * NUM_COLS);
+    TEST_ASSERT(buffer);
+
+    for (i = 0; i < 2; ++i)
+    {
+        emptyBlock = (i == 0) ? NO_BLOCK : 5;
+        padBlock = (i == 0) ? NO_BLOCK : 10;
+
+        /*
+         *  The encoding does not depend on which thread did it. Two threads
+         *  encode two full batches, three a full batch and a partial one
+         */
+        TEST_ASSERT(writeJPEG(TEST_FILE_NAME, compressions[i], 1,
+                              emptyBlock, padBlock, &error));
+        single = readFile(TEST_FILE_NAME, &singleLength);
+        TEST_ASSERT(single);
+        for (numThreads = 2; numThreads <= 3; ++numThreads)
+        {
+            TEST_ASSERT(writeJPEG(TEST_FILE_NAME_MT, compressions[i],
+                                  numThreads, emptyBlock, padBlock, &error));
+            multi = readFile(TEST_FILE_NAME_MT, &multiLength);
+            TEST_ASSERT(multi);
+            TEST_ASSERT_EQ_INT(singleLength, multiLength);
+            TEST_ASSERT(memcmp(single, multi, singleLength) == 0);
+            NITF_FREE(multi);
+        }
+        NITF_FREE(single);
+
+        TEST_ASSERT(openJPEG(&file, TEST_FILE_NAME_MT, &error));
+        TEST_ASSERT(readWindow(file.imageReader, 0, 0, NUM_ROWS, NUM_COLS,
+                               NULL, buffer, &error));
+        TEST_ASSERT(checkImage(buffer, emptyBlock, padBlock, 3));
+        if (emptyBlock != NO_BLOCK)
+            TEST_ASSERT(checkMasks(&file, emptyBlock, padBlock, &error));
+        closeJPEG(&file);
+    }
+    NITF_FREE(buffer);
+}
+
+TEST_CASE(testRejectBands)
+{
+    nitf_Error error;
+    nitf_Record *record;
+    nitf_ImageSegment *segment;
+    nitf_BandInfo **bands;
+    nitf_IOHandle out;
+    nitf_Writer *writer;
+    int band;
+
+    record = nitf_Record_construct(NITF_VER_21, &error);
+    TEST_ASSERT(record);
+    segment = nitf_Record_newImageSegment(record, &error);
+    TEST_ASSERT(segment);
+    bands = (nitf_BandInfo **) NITF_MALLOC(3 * sizeof(nitf_BandInfo *));
+    TEST_ASSERT(bands);
+    for (band = 0; band < 3; ++band)
+    {
+        bands[band] = nitf_BandInfo_construct(&error);
+        TEST_ASSERT(bands[band]);
+        TEST_ASSERT(nitf_BandInfo_init(bands[band], band == 0 ? "R" :
+                                       band == 1 ? "G" : "B", " ", "N",
+                                       "   ", 0, 0, NULL, &error));
+    }
+    TEST_ASSERT(nitf_ImageSubheader_setPixelInformation(segment->subheader,
+                                                        "INT", 8, 8, "R",
+                                                        "RGB", "VIS", 3,
+                                                        bands, &error));
+    TEST_ASSERT(nitf_ImageSubheader_setBlocking(segment->subheader,
+                                                NUM_ROWS, NUM_COLS,
+                                                BLOCK_SIZE, BLOCK_SIZE, "P",
+                                                &error));
+    TEST_ASSERT(nitf_ImageSubheader_setCompression(segment->subheader, "C3",
+                                                   "", &error));
+
+    out = nitf_IOHandle_create(TEST_FILE_NAME_MT, NITF_ACCESS_WRITEONLY,
+                               NITF_CREATE, &error);
+    TEST_ASSERT(!NITF_INVALID_HANDLE(out));
+    writer = nitf_Writer_construct(&error);
+    TEST_ASSERT(writer);
+    TEST_ASSERT(nitf_Writer_prepare(writer, record, out, &error));
+
+    /* Three band RGB is not supported, the compressor does not open */
+    TEST_ASSERT(nitf_Writer_newImageWriter(writer, 0, NULL, &error) == NULL);
+    TEST_ASSERT_EQ_INT(error.level, NITF_ERR_COMPRESSION);
+
+    nitf_IOHandle_close(out);
+    nitf_Writer_destruct(&writer);
+    nitf_Record_destruct(&record);
+}
+
+int main(int argc, char **argv)
+{
+    if (!haveJPEG())
+        return 0;
+    CHECK(testCommentSOI);
+    CHECK(testMissingBlocks);
+    CHECK(testScaledDecode);
+    CHECK(testCompressThreads);
+    CHECK(testRejectBands);
+    return 0;
+}
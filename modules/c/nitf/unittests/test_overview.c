@@ -0,0 +1,288 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+/*
+ * Writes an image with a pyramid of box averaged overviews and reads the
+ * overviews back through nitf_Overview_select
+ */
+
+#include <import/nitf.h>
+#include "Test.h"
+
+#define TEST_FILE_NAME "test_overview.ntf"
+#define NUM_ROWS 64
+#define NUM_COLS 50
+#define BLOCK_SIZE 16
+
+static nitf_Uint8 pixelAt(nitf_Uint32 row, nitf_Uint32 col)
+{
+    return (nitf_Uint8) ((row * 3 + col * 5) & 0xff);
+}
+
+static NITF_BOOL addSource(nitf_Writer *writer, nitf_Record *record,
+                           nitf_Uint32 index, nitf_Uint32 factor,
+                           const nitf_Uint8 *data,
+                           nitf_DownSampler *downSampler, nitf_Error *error)
+{
+    nitf_ImageWriter *imageWriter;
+    nitf_ImageSource *imageSource;
+    nitf_BandSource *bandSource;
+    nitf_ImageSegment *base =
+        (nitf_ImageSegment *) nitf_List_get(record->images, 0, error);
+
+    imageWriter = nitf_Writer_newImageWriter(writer, index, NULL, error);
+    if (!imageWriter)
+        return NITF_FAILURE;
+    imageSource = nitf_ImageSource_construct(error);
+    if (!imageSource)
+        return NITF_FAILURE;
+    bandSource = nitf_MemorySource_construct(data, NUM_ROWS * NUM_COLS,
+                                             0, 1, 0, error);
+    if (!bandSource)
+        return NITF_FAILURE;
+    if (factor > 1)
+    {
+        nitf_BandSource *overviewSource =
+            nitf_OverviewSource_construct(bandSource, base->subheader,
+                                          downSampler, error);
+        if (!overviewSource)
+        {
+            nitf_BandSource_destruct(&bandSource);
+            return NITF_FAILURE;
+        }
+        bandSource = overviewSource;
+    }
+    if (!nitf_ImageSource_addBand(imageSource, bandSource, error))
+        return NITF_FAILURE;
+    return nitf_ImageWriter_attachSource(imageWriter, imageSource, error);
+}
+
+static NITF_BOOL writeImage(const char *filename, nitf_Error *error)
+{
+    nitf_Record *record = NULL;
+    nitf_ImageSegment *segment;
+    nitf_BandInfo **bands;
+    nitf_IOHandle out;
+    nitf_Writer *writer = NULL;
+    nitf_DownSampler *box2 = NULL;
+    nitf_DownSampler *box4 = NULL;
+    nitf_Uint8 *data = NULL;
+    nitf_Uint32 row, col;
+    NITF_BOOL status = NITF_FAILURE;
+
+    data = (nitf_Uint8 *) NITF_MALLOC(NUM_ROWS * NUM_COLS);
+    if (!data)
+        goto CATCH_ERROR;
+    for (row = 0; row < NUM_ROWS; ++row)
+        for (col = 0; col < NUM_COLS; ++col)
+            data[row * NUM_COLS + col] = pixelAt(row, col);
+
+    record = nitf_Record_construct(NITF_VER_21, error);
+    if (!record)
+        goto CATCH_ERROR;
+
+    segment = nitf_Record_newImageSegment(record, error);
+    if (!segment)
+        goto CATCH_ERROR;
+
+    bands = (nitf_BandInfo **) NITF_MALLOC(sizeof(nitf_BandInfo *));
+    if (!bands)
+        goto CATCH_ERROR;
+    bands[0] = nitf_BandInfo_construct(error);
+    if (!bands[0])
+        goto CATCH_ERROR;
+    if (!nitf_BandInfo_init(bands[0], "M", " ", "N", "   ", 0, 0, NULL, error))
+        goto CATCH_ERROR;
+
+    if (!nitf_ImageSubheader_setPixelInformation(segment->subheader, "INT",
+                                                 8, 8, "R", "MONO", "VIS",
+                                                 1, bands, error))
+        goto CATCH_ERROR;
+    if (!nitf_ImageSubheader_setBlocking(segment->subheader,
+                                         NUM_ROWS, NUM_COLS,
+                                         BLOCK_SIZE, BLOCK_SIZE,
+                                         "B", error))
+        goto CATCH_ERROR;
+
+    if (!nitf_Overview_newSegment(record, 0, 2, error)
+        || !nitf_Overview_newSegment(record, 0, 4, error))
+        goto CATCH_ERROR;
+
+    out = nitf_IOHandle_create(filename, NITF_ACCESS_WRITEONLY,
+                               NITF_CREATE, error);
+    if (NITF_INVALID_HANDLE(out))
+        goto CATCH_ERROR;
+
+    writer = nitf_Writer_construct(error);
+    if (!writer)
+        goto CATCH_ERROR;
+    if (!nitf_Writer_prepare(writer, record, out, error))
+        goto CATCH_ERROR;
+
+    box2 = nitf_BoxDownSample_construct(2, 2, error);
+    box4 = nitf_BoxDownSample_construct(4, 4, error);
+    if (!box2 || !box4)
+        goto CATCH_ERROR;
+    if (!addSource(writer, record, 0, 1, data, NULL, error)
+        || !addSource(writer, record, 1, 2, data, box2, error)
+        || !addSource(writer, record, 2, 4, data, box4, error))
+        goto CATCH_ERROR;
+
+    if (!nitf_Writer_write(writer, error))
+        goto CATCH_ERROR;
+
+    nitf_IOHandle_close(out);
+    status = NITF_SUCCESS;
+
+  CATCH_ERROR:
+    if (writer)
+        nitf_Writer_destruct(&writer);
+    if (box2)
+        nitf_DownSampler_destruct(&box2);
+    if (box4)
+        nitf_DownSampler_destruct(&box4);
+    if (record)
+        nitf_Record_destruct(&record);
+    if (data)
+        NITF_FREE(data);
+    return status;
+}
+
+/*
+ *  Read an overview and compare it with the box average of the pixels in
+ *  each window of the base image
+ */
+static NITF_BOOL checkOverview(nitf_Reader *reader, nitf_Uint32 index,
+                               nitf_Uint32 factor, nitf_Error *error)
+{
+    nitf_ImageReader *imageReader;
+    nitf_SubWindow *subWindow;
+    nitf_Uint32 bandList[1] = { 0 };
+    nitf_Uint32 numRows = (NUM_ROWS + factor - 1) / factor;
+    nitf_Uint32 numCols = (NUM_COLS + factor - 1) / factor;
+    nitf_Uint8 *buffer;
+    nitf_Uint32 row, col, r, c;
+    int padded;
+    NITF_BOOL status = NITF_SUCCESS;
+
+    imageReader = nitf_Reader_newImageReader(reader, index, NULL, error);
+    if (!imageReader)
+        return NITF_FAILURE;
+    subWindow = nitf_SubWindow_construct(error);
+    if (!subWindow)
+        return NITF_FAILURE;
+    subWindow->numRows = numRows;
+    subWindow->numCols = numCols;
+    subWindow->bandList = bandList;
+    subWindow->numBands = 1;
+
+    buffer = (nitf_Uint8 *) NITF_MALLOC(numRows * numCols);
+    if (!buffer || !nitf_ImageReader_read(imageReader, subWindow, &buffer,
+                                          &padded, error))
+        status = NITF_FAILURE;
+
+    for (row = 0; status && row < numRows; ++row)
+        for (col = 0; col < numCols; ++col)
+        {
+            double sum = 0, count = 0;
+            for (r = row * factor; r < (row + 1) * factor && r < NUM_ROWS;
+                 ++r)
+                for (c = col * factor;
+                     c < (col + 1) * factor && c < NUM_COLS; ++c)
+                {
+                    sum += pixelAt(r, c);
+                    count += 1;
+                }
+            if (buffer[row * numCols + col] !=
+                (nitf_Uint8) floor(sum / count + 0.5))
+            {
+                status = NITF_FAILURE;
+                break;
+            }
+        }
+
+    if (buffer)
+        NITF_FREE(buffer);
+    nitf_SubWindow_destruct(&subWindow);
+    nitf_ImageReader_destruct(&imageReader);
+    return status;
+}
+
+TEST_CASE(testOverviews)
+{
+    nitf_Error error;
+    nitf_IOInterface *io;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageSegment *segment;
+    nitf_Uint32 index, factor, level;
+    char imag[NITF_IMAG_SZ + 1];
+
+    TEST_ASSERT(writeImage(TEST_FILE_NAME, &error));
+
+    io = nitf_IOHandleAdapter_open(TEST_FILE_NAME, NITF_ACCESS_READONLY,
+                                   NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(io);
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    record = nitf_Reader_readIO(reader, io, &error);
+    TEST_ASSERT(record);
+    TEST_ASSERT_EQ_INT(nitf_List_size(record->images), 3);
+
+    /* The overviews are attached to the base image */
+    segment = (nitf_ImageSegment *) nitf_List_get(record->images, 2, &error);
+    TEST_ASSERT(segment);
+    TEST_ASSERT(nitf_Field_get(segment->subheader->NITF_IMAG, imag,
+                               NITF_CONV_STRING, NITF_IMAG_SZ + 1, &error));
+    TEST_ASSERT(strcmp(imag, "/4  ") == 0);
+    TEST_ASSERT(nitf_Field_get(segment->subheader->NITF_IALVL, &level,
+                               NITF_CONV_UINT, NITF_INT32_SZ, &error));
+    TEST_ASSERT_EQ_INT(level, 1);
+    TEST_ASSERT(nitf_Field_get(segment->subheader->NITF_IDLVL, &level,
+                               NITF_CONV_UINT, NITF_INT32_SZ, &error));
+    TEST_ASSERT_EQ_INT(level, 3);
+
+    TEST_ASSERT(nitf_Overview_select(record, 0, 1, &index, &factor, &error));
+    TEST_ASSERT_EQ_INT(index, 0);
+    TEST_ASSERT_EQ_INT(factor, 1);
+    TEST_ASSERT(nitf_Overview_select(record, 0, 3, &index, &factor, &error));
+    TEST_ASSERT_EQ_INT(index, 1);
+    TEST_ASSERT_EQ_INT(factor, 2);
+    TEST_ASSERT(nitf_Overview_select(record, 0, 16, &index, &factor, &error));
+    TEST_ASSERT_EQ_INT(index, 2);
+    TEST_ASSERT_EQ_INT(factor, 4);
+
+    TEST_ASSERT(checkOverview(reader, 1, 2, &error));
+    TEST_ASSERT(checkOverview(reader, 2, 4, &error));
+
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOInterface_close(io, &error);
+    nitf_IOInterface_destruct(&io);
+}
+
+int main(int argc, char **argv)
+{
+    CHECK(testOverviews);
+    return 0;
+}
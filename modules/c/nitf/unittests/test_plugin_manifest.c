@@ -0,0 +1,307 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+/*
+ * Writes plugin manifests for directories holding copies of a few TRE
+ * plugins, and checks that the registry reads them, loads each DSO on
+ * first use only, and falls back to loading everything when a manifest
+ * is stale
+ */
+
+#include <import/nitf.h>
+#include <sys/stat.h>
+#include "Test.h"
+
+#ifdef WIN32
+#   include <direct.h>
+#   define makeDir(name) _mkdir(name)
+#else
+#   define makeDir(name) mkdir(name, 0777)
+#endif
+
+#define LAZY_DIR "plugin_manifest_lazy"
+#define STALE_DIR "plugin_manifest_stale"
+#define OVERRIDE_DIR "plugin_manifest_override"
+#define OVERRIDE_MANIFEST "plugin_manifest_override.manifest"
+#define CONCURRENT_DIR "plugin_manifest_concurrent"
+#define NUM_LOAD_THREADS 4
+
+/* The installed plugins, which are copied into the test directories */
+static char pluginPath[NITF_MAX_PATH] = "";
+
+static void setEnv(const char *name, const char *value)
+{
+#ifdef WIN32
+    char buf[NITF_MAX_PATH];
+    NITF_SNPRINTF(buf, NITF_MAX_PATH, "%s=%s", name, value ? value : "");
+    _putenv(buf);
+#else
+    if (value)
+        setenv(name, value, 1);
+    else
+        unsetenv(name);
+#endif
+}
+
+static NITF_BOOL copyFile(const char *from, const char *to)
+{
+    char buf[8192];
+    size_t n;
+    NITF_BOOL ok = NITF_SUCCESS;
+    FILE *in = fopen(from, "rb");
+    FILE *out = in ? fopen(to, "wb") : NULL;
+
+    if (!out)
+    {
+        if (in)
+            fclose(in);
+        return NITF_FAILURE;
+    }
+    while (ok && (n = fread(buf, 1, sizeof(buf), in)) > 0)
+        ok = fwrite(buf, 1, n, out) == n;
+    fclose(in);
+    ok &= fclose(out) == 0;
+    return ok;
+}
+
+/* TRUE if snprintf's result n fit in a path buffer */
+#define PATH_FITS(n) ((n) >= 0 && (n) < NITF_MAX_PATH)
+
+/* Make a plugin directory holding copies of the named plugins */
+static NITF_BOOL makePluginDir(const char *dirName, const char **plugins)
+{
+    char from[NITF_MAX_PATH];
+    char to[NITF_MAX_PATH];
+    int fromLength;
+    int toLength;
+    nitf_Directory *dir;
+    nitf_Error error;
+    const char *name;
+
+    if (!*pluginPath)
+        return NITF_FAILURE;
+
+    /* Empty the directory from an earlier run */
+    makeDir(dirName);
+    dir = nitf_Directory_construct(&error);
+    if (!dir)
+        return NITF_FAILURE;
+    for (name = nitf_Directory_findFirstFile(dir, dirName); name;
+         name = nitf_Directory_findNextFile(dir))
+    {
+        toLength = NITF_SNPRINTF(to, NITF_MAX_PATH, "%s/%s", dirName, name);
+        if (PATH_FITS(toLength))
+            remove(to);
+    }
+    nitf_Directory_destruct(&dir);
+
+    for (; *plugins; ++plugins)
+    {
+        fromLength = NITF_SNPRINTF(from, NITF_MAX_PATH, "%s/%s%s",
+                                   pluginPath, *plugins, NITF_DLL_EXTENSION);
+        toLength = NITF_SNPRINTF(to, NITF_MAX_PATH, "%s/%s%s", dirName,
+                                 *plugins, NITF_DLL_EXTENSION);
+        if (!PATH_FITS(fromLength) || !PATH_FITS(toLength))
+        {
+            fprintf(stderr, "Plugin path too long: %s/%s\n", pluginPath,
+                    *plugins);
+            return NITF_FAILURE;
+        }
+        if (!copyFile(from, to))
+            return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+static NITF_BOOL retrieve(nitf_PluginRegistry *reg, const char *tag)
+{
+    nitf_Error error;
+    int bad = 0;
+    return nitf_PluginRegistry_retrieveTREHandler(reg, tag, &bad,
+                                                  &error) != NULL && !bad;
+}
+
+TEST_CASE(testWriteManifest)
+{
+    const char *plugins[] = { "ACFTB", "BLOCKA", NULL };
+    char manifestName[NITF_MAX_PATH];
+    char line[64] = "";
+    nitf_Error error;
+    FILE *file;
+
+    TEST_ASSERT(makePluginDir(LAZY_DIR, plugins));
+    TEST_ASSERT(nitf_PluginRegistry_writeManifest(LAZY_DIR, NULL, &error));
+
+    NITF_SNPRINTF(manifestName, NITF_MAX_PATH, "%s/%s", LAZY_DIR,
+                  NITF_PLUGIN_MANIFEST_FILE);
+    file = fopen(manifestName, "r");
+    TEST_ASSERT(file);
+    TEST_ASSERT(fgets(line, sizeof(line), file));
+    fclose(file);
+    TEST_ASSERT(strncmp(line, NITF_PLUGIN_MANIFEST,
+                        strlen(NITF_PLUGIN_MANIFEST)) == 0);
+
+    /* There is nothing to write for a missing directory */
+    TEST_ASSERT(!nitf_PluginRegistry_writeManifest(LAZY_DIR "_missing",
+                                                   NULL, &error));
+}
+
+TEST_CASE(testLazyLoad)
+{
+    nitf_Error error;
+    nitf_PluginRegistry *reg;
+
+    /* The registry is made from the manifest, without loading any DSO */
+    setEnv(NITF_PLUGIN_PATH, LAZY_DIR);
+    reg = nitf_PluginRegistry_getInstance(&error);
+    TEST_ASSERT(reg);
+    TEST_ASSERT_EQ_INT(nitf_List_size(reg->dsos), 0);
+    TEST_ASSERT_EQ_INT(nitf_List_size(reg->manifestPlugins), 2);
+
+    /* Each DSO is loaded when it is first used, and only then */
+    TEST_ASSERT(retrieve(reg, "ACFTB"));
+    TEST_ASSERT_EQ_INT(nitf_List_size(reg->dsos), 1);
+    TEST_ASSERT(retrieve(reg, "ACFTB"));
+    TEST_ASSERT_EQ_INT(nitf_List_size(reg->dsos), 1);
+    TEST_ASSERT(retrieve(reg, "BLOCKA"));
+    TEST_ASSERT_EQ_INT(nitf_List_size(reg->dsos), 2);
+
+    /* A tag the manifest does not name loads nothing */
+    TEST_ASSERT(!retrieve(reg, "NOTATRE"));
+    TEST_ASSERT_EQ_INT(nitf_List_size(reg->dsos), 2);
+}
+
+TEST_CASE(testStaleManifest)
+{
+    const char *plugins[] = { "ACCPOB", "ACCHZB", NULL };
+    char pluginName[NITF_MAX_PATH];
+    nitf_Error error;
+    nitf_PluginRegistry *reg = nitf_PluginRegistry_getInstance(&error);
+    nitf_Uint32 numDSOs, numManifestPlugins;
+    FILE *file;
+
+    TEST_ASSERT(reg);
+    TEST_ASSERT(makePluginDir(STALE_DIR, plugins));
+    TEST_ASSERT(nitf_PluginRegistry_writeManifest(STALE_DIR, NULL, &error));
+
+    /* Once a DSO changes size, the manifest no longer describes it */
+    NITF_SNPRINTF(pluginName, NITF_MAX_PATH, "%s/ACCHZB%s", STALE_DIR,
+                  NITF_DLL_EXTENSION);
+    file = fopen(pluginName, "ab");
+    TEST_ASSERT(file);
+    fputc(0, file);
+    fclose(file);
+
+    numDSOs = nitf_List_size(reg->dsos);
+    numManifestPlugins = nitf_List_size(reg->manifestPlugins);
+    TEST_ASSERT(nitf_PluginRegistry_loadDir(STALE_DIR, &error));
+    TEST_ASSERT_EQ_INT(nitf_List_size(reg->dsos), numDSOs + 2);
+    TEST_ASSERT_EQ_INT(nitf_List_size(reg->manifestPlugins),
+                       numManifestPlugins);
+}
+
+TEST_CASE(testManifestOverride)
+{
+    const char *plugins[] = { "ACCVTB", "AIMIDB", NULL };
+    nitf_Error error;
+    nitf_PluginRegistry *reg = nitf_PluginRegistry_getInstance(&error);
+    nitf_Uint32 numDSOs, numManifestPlugins;
+
+    TEST_ASSERT(reg);
+    TEST_ASSERT(makePluginDir(OVERRIDE_DIR, plugins));
+    TEST_ASSERT(nitf_PluginRegistry_writeManifest(OVERRIDE_DIR,
+                                                  OVERRIDE_MANIFEST,
+                                                  &error));
+
+    /* The manifest named by the environment is read for any directory */
+    numDSOs = nitf_List_size(reg->dsos);
+    numManifestPlugins = nitf_List_size(reg->manifestPlugins);
+    setEnv(NITF_PLUGIN_MANIFEST, OVERRIDE_MANIFEST);
+    TEST_ASSERT(nitf_PluginRegistry_loadDir(OVERRIDE_DIR, &error));
+    TEST_ASSERT_EQ_INT(nitf_List_size(reg->dsos), numDSOs);
+    TEST_ASSERT_EQ_INT(nitf_List_size(reg->manifestPlugins),
+                       numManifestPlugins + 2);
+
+    /* An empty name disables the manifest */
+    setEnv(NITF_PLUGIN_MANIFEST, "");
+    TEST_ASSERT(nitf_PluginRegistry_loadDir(OVERRIDE_DIR, &error));
+    TEST_ASSERT_EQ_INT(nitf_List_size(reg->dsos), numDSOs + 2);
+    TEST_ASSERT(!nitf_PluginRegistry_writeManifest(OVERRIDE_DIR, NULL,
+                                                   &error));
+    setEnv(NITF_PLUGIN_MANIFEST, NULL);
+}
+
+static NITF_DATA* retrieveTask(NITF_DATA *data)
+{
+    nitf_Error error;
+    NITF_BOOL *status = (NITF_BOOL *) data;
+    nitf_PluginRegistry *reg = nitf_PluginRegistry_getInstance(&error);
+    *status = reg && retrieve(reg, "ACFTA");
+    return NULL;
+}
+
+TEST_CASE(testConcurrentLoad)
+{
+    const char *plugins[] = { "ACFTA", NULL };
+    nitf_Error error;
+    nitf_PluginRegistry *reg = nitf_PluginRegistry_getInstance(&error);
+    nitf_Thread threads[NUM_LOAD_THREADS];
+    NITF_BOOL status[NUM_LOAD_THREADS];
+    nitf_Uint32 numDSOs;
+    int i;
+
+    TEST_ASSERT(reg);
+    TEST_ASSERT(makePluginDir(CONCURRENT_DIR, plugins));
+    TEST_ASSERT(nitf_PluginRegistry_writeManifest(CONCURRENT_DIR, NULL,
+                                                  &error));
+    TEST_ASSERT(nitf_PluginRegistry_loadDir(CONCURRENT_DIR, &error));
+    numDSOs = nitf_List_size(reg->dsos);
+
+    /* Threads wanting the same DSO at once load it once between them */
+    for (i = 0; i < NUM_LOAD_THREADS; ++i)
+    {
+        status[i] = NITF_FAILURE;
+        TEST_ASSERT(nitf_Thread_create(&threads[i], retrieveTask,
+                                       &status[i], &error));
+    }
+    for (i = 0; i < NUM_LOAD_THREADS; ++i)
+        nitf_Thread_join(&threads[i]);
+    for (i = 0; i < NUM_LOAD_THREADS; ++i)
+        TEST_ASSERT(status[i]);
+    TEST_ASSERT_EQ_INT(nitf_List_size(reg->dsos), numDSOs + 1);
+}
+
+int main(int argc, char **argv)
+{
+    /* The registry is made from our directory, not the installed one */
+    const char *installed = getenv(NITF_PLUGIN_PATH);
+    if (installed)
+        NITF_SNPRINTF(pluginPath, NITF_MAX_PATH, "%s", installed);
+    setEnv(NITF_PLUGIN_MANIFEST, NULL);
+    CHECK(testWriteManifest);
+    CHECK(testLazyLoad);
+    CHECK(testStaleManifest);
+    CHECK(testManifestOverride);
+    CHECK(testConcurrentLoad);
+    return 0;
+}
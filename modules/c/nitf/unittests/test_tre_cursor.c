@@ -0,0 +1,249 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; if not, If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nitf.h>
+#include <nitf/TREPlan.h>
+#include "Test.h"
+
+/*  A description with nested loops, an if and a computed length  */
+static nitf_TREDescription planDescription[] = {
+    {NITF_BCS_N, 2, "Number of items", "NUM" },
+    {NITF_LOOP, 0, NULL, "NUM" },
+        {NITF_BCS_A, 1, "Has text", "FLAG" },
+        {NITF_IF, 0, "eq Y", "FLAG" },
+            {NITF_BCS_N, 1, "Text width", "WIDTH" },
+            {NITF_BCS_A, NITF_TRE_CONDITIONAL_LENGTH, "Text", "TEXT",
+             "WIDTH 2 *" },
+        {NITF_ENDIF, 0, NULL, NULL },
+        {NITF_LOOP, 0, "- 1", "WIDTH" },
+            {NITF_BCS_N, 1, "Digit", "DIGIT" },
+        {NITF_ENDLOOP, 0, NULL, NULL },
+    {NITF_ENDLOOP, 0, NULL, NULL },
+    {NITF_LOOP, 0, NITF_CONST_N, "2" },
+        {NITF_BCS_A, 1, "Tail", "TAIL" },
+    {NITF_ENDLOOP, 0, NULL, NULL },
+    {NITF_END, 0, NULL, NULL }
+};
+
+static nitf_TREDescriptionInfo planDescriptions[] = {
+    { "PLAN", planDescription, NITF_TRE_DESC_NO_LENGTH },
+    { NULL, NULL, NITF_TRE_DESC_NO_LENGTH }
+};
+
+static nitf_TREDescriptionSet planDescriptionSet = { 0, planDescriptions };
+
+/*  A fixed section, ended by a loop over a count in it  */
+static nitf_TREDescription fixedDescription[] = {
+    {NITF_BCS_A, 3, "Name", "NAME" },
+    {NITF_BCS_N, 2, "Number of codes", "COUNT" },
+    {NITF_LOOP, 0, NULL, "COUNT" },
+        {NITF_BCS_A, 1, "Code", "CODE" },
+    {NITF_ENDLOOP, 0, NULL, NULL },
+    {NITF_BCS_N, 1, "Last", "LAST" },
+    {NITF_END, 0, NULL, NULL }
+};
+
+static nitf_TREDescriptionInfo fixedDescriptions[] = {
+    { "FIXED", fixedDescription, NITF_TRE_DESC_NO_LENGTH },
+    { NULL, NULL, NITF_TRE_DESC_NO_LENGTH }
+};
+
+static nitf_TREDescriptionSet fixedDescriptionSet = { 0, fixedDescriptions };
+
+/*  Three items, the second without text, and the tail  */
+static const char planData[] = "03Y2abcd5NY3xyzxyz67AB";
+
+static nitf_TRE* readTRE(nitf_TREHandler* handler, const char* tag,
+                         const char* data, nitf_Error* error)
+{
+    nitf_IOInterface* io = NULL;
+    nitf_TRE* tre = nitf_TRE_createSkeleton(tag, error);
+    if (!tre)
+        return NULL;
+    tre->handler = handler;
+
+    io = nitf_BufferAdapter_construct((char*)data, strlen(data), 0, error);
+    if (!io || !handler->read(io, strlen(data), tre, NULL, error))
+        nitf_TRE_destruct(&tre);
+    if (io)
+        nitf_IOInterface_destruct(&io);
+    return tre;
+}
+
+static nitf_TRE* readPlanTRE(nitf_TREHandler* handler, nitf_Error* error)
+{
+    return readTRE(handler, "PLAN", planData, error);
+}
+
+static void checkPlanField(const char* testName, nitf_TRE* tre,
+                           const char* tag, const char* value)
+{
+    char buf[16];
+    nitf_Error error;
+    nitf_Field* field = nitf_TRE_getField(tre, tag);
+    TEST_ASSERT(field);
+    TEST_ASSERT(nitf_Field_get(field, buf, NITF_CONV_STRING, sizeof(buf),
+                               &error));
+    TEST_ASSERT_EQ_STR(buf, value);
+}
+
+TEST_CASE(testCursorPlan)
+{
+    nitf_Error error;
+    nitf_TREHandler handler;
+    nitf_TRE* tre = NULL;
+    nitf_TRE* again = NULL;
+    nitf_Uint32 length = 0;
+    char* raw = NULL;
+
+    TEST_ASSERT(nitf_TREUtils_createBasicHandler(&planDescriptionSet,
+                                                 &handler, &error));
+    tre = readPlanTRE(&handler, &error);
+    TEST_ASSERT(tre);
+
+    checkPlanField(testName, tre, "NUM", "03");
+    checkPlanField(testName, tre, "FLAG[0]", "Y");
+    checkPlanField(testName, tre, "WIDTH[0]", "2");
+    checkPlanField(testName, tre, "TEXT[0]", "abcd");
+    checkPlanField(testName, tre, "DIGIT[0][0]", "5");
+    checkPlanField(testName, tre, "FLAG[1]", "N");
+    checkPlanField(testName, tre, "FLAG[2]", "Y");
+    checkPlanField(testName, tre, "TEXT[2]", "xyzxyz");
+    checkPlanField(testName, tre, "DIGIT[2][1]", "7");
+    checkPlanField(testName, tre, "TAIL[1]", "B");
+    TEST_ASSERT_NULL(nitf_TRE_getField(tre, "WIDTH[1]"));
+    TEST_ASSERT_NULL(nitf_TRE_getField(tre, "DIGIT[1][0]"));
+    TEST_ASSERT_NULL(nitf_TRE_getField(tre, "DIGIT[2][2]"));
+
+    /*  the write path walks the same plan  */
+    TEST_ASSERT_EQ_INT(nitf_TRE_getCurrentSize(tre, &error),
+                       (int)strlen(planData));
+    raw = nitf_TREUtils_getRawData(tre, &length, &error);
+    TEST_ASSERT(raw);
+    TEST_ASSERT_EQ_INT(length, strlen(planData));
+    TEST_ASSERT(memcmp(raw, planData, length) == 0);
+    NITF_FREE(raw);
+
+    /*  a second TRE with the description uses the compiled plan  */
+    again = readPlanTRE(&handler, &error);
+    TEST_ASSERT(again);
+    checkPlanField(testName, again, "TEXT[2]", "xyzxyz");
+    checkPlanField(testName, again, "TAIL[0]", "A");
+
+    nitf_TRE_destruct(&again);
+    nitf_TRE_destruct(&tre);
+}
+
+TEST_CASE(testFixedSection)
+{
+    nitf_Error error;
+    nitf_TREHandler handler;
+    nitf_TRE* tre = NULL;
+    nitf_TREPlan* plan = NULL;
+    nitf_Uint32 length = 0;
+    char* raw = NULL;
+    int numItems = 0;
+
+    plan = nitf_TREPlan_get(fixedDescription, &numItems, &error);
+    TEST_ASSERT(plan);
+    TEST_ASSERT_EQ_INT(numItems, 6);
+    TEST_ASSERT_EQ_INT(plan->numFixed, 2);
+    TEST_ASSERT_EQ_INT(plan->fixedLength, 5);
+    TEST_ASSERT_EQ_INT(plan->entries[1].offset, 3);
+    TEST_ASSERT_EQ_INT(plan->entries[5].offset, -1);
+
+    /*  the loop count is the second field in the store  */
+    TEST_ASSERT_EQ_INT(plan->entries[2].ref.entry, 1);
+    TEST_ASSERT(nitf_TREPlan_get(fixedDescription, &numItems, &error) ==
+                plan);
+
+    /*  the fixed section is read at its offsets, the rest by the cursor  */
+    TEST_ASSERT(nitf_TREUtils_createBasicHandler(&fixedDescriptionSet,
+                                                 &handler, &error));
+    tre = readTRE(&handler, "FIXED", "abc03xyz9", &error);
+    TEST_ASSERT(tre);
+    checkPlanField(testName, tre, "NAME", "abc");
+    checkPlanField(testName, tre, "COUNT", "03");
+    checkPlanField(testName, tre, "CODE[2]", "z");
+    checkPlanField(testName, tre, "LAST", "9");
+
+    raw = nitf_TREUtils_getRawData(tre, &length, &error);
+    TEST_ASSERT(raw);
+    TEST_ASSERT_EQ_INT(length, 9);
+    TEST_ASSERT(memcmp(raw, "abc03xyz9", length) == 0);
+    NITF_FREE(raw);
+    nitf_TRE_destruct(&tre);
+
+    /*  data shorter than the fixed section is read by the cursor  */
+    tre = readTRE(&handler, "FIXED", "abc", &error);
+    TEST_ASSERT(tre);
+    checkPlanField(testName, tre, "NAME", "abc");
+    TEST_ASSERT_NULL(nitf_TRE_getField(tre, "COUNT"));
+    nitf_TRE_destruct(&tre);
+}
+
+TEST_CASE(testStalePlan)
+{
+    nitf_Error error;
+    nitf_TREDescription* description = NULL;
+    nitf_TREPlan* plan = NULL;
+    nitf_TREPlan* replaced = NULL;
+    int numItems = 0;
+
+    /*  a description built at run time, freed and replaced by another
+     *  at the same address
+     */
+    description = (nitf_TREDescription*)NITF_MALLOC(sizeof(planDescription));
+    TEST_ASSERT(description);
+    memcpy(description, planDescription, sizeof(planDescription));
+    plan = nitf_TREPlan_get(description, &numItems, &error);
+    TEST_ASSERT(plan);
+    TEST_ASSERT_EQ_INT(numItems, 14);
+    TEST_ASSERT(nitf_TREPlan_get(description, &numItems, &error) == plan);
+
+    memcpy(description, fixedDescription, sizeof(fixedDescription));
+    replaced = nitf_TREPlan_get(description, &numItems, &error);
+    TEST_ASSERT(replaced);
+    TEST_ASSERT(replaced != plan);
+    TEST_ASSERT_EQ_INT(numItems, 6);
+    TEST_ASSERT_EQ_INT(replaced->numFixed, 2);
+
+    /*  the old plan is retired, and can still be read  */
+    TEST_ASSERT_EQ_INT(plan->numItems, 14);
+    TEST_ASSERT_EQ_INT(plan->entries[1].end, 10);
+
+    /*  every plan is freed, and compiled again when it is next used  */
+    nitf_TREPlan_cleanup();
+    plan = nitf_TREPlan_get(description, &numItems, &error);
+    TEST_ASSERT(plan);
+    TEST_ASSERT_EQ_INT(plan->numFixed, 2);
+    nitf_TREPlan_cleanup();
+    NITF_FREE(description);
+}
+
+int main(int argc, char **argv)
+{
+    CHECK(testCursorPlan);
+    CHECK(testFixedSection);
+    CHECK(testStalePlan);
+    return 0;
+}
@@ -0,0 +1,415 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; if not, If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nitf.h>
+#include <nitf/TREFieldStore.h>
+#include <nitf/TREPrivateData.h>
+#include "Test.h"
+
+static const char coefTag[] = "COEF";
+
+static nitf_TREDescription legacyDescription[] = {
+    {NITF_BCS_N, 2, "Number of values", "COUNT" },
+    {NITF_LOOP, 0, NULL, "COUNT" },
+        {NITF_BCS_A, 2, "Value", "VALUE" },
+    {NITF_ENDLOOP, 0, NULL, NULL },
+    {NITF_END, 0, NULL, NULL }
+};
+
+static nitf_TREDescriptionInfo legacyDescriptions[] = {
+    { "LEGACY", legacyDescription, NITF_TRE_DESC_NO_LENGTH },
+    { NULL, NULL, NITF_TRE_DESC_NO_LENGTH }
+};
+
+static nitf_TREDescriptionSet legacyDescriptionSet = { 0, legacyDescriptions };
+
+static const char legacyData[] = "03aabbcc";
+
+/*
+ *  Read a TRE the way handlers did before the field store, constructing
+ *  each field and inserting it into the hash by its qualified name
+ */
+static NITF_BOOL legacyRead(nitf_IOInterface* io, nitf_Uint32 length,
+                            nitf_TRE* tre, struct _nitf_Record* record,
+                            nitf_Error* error)
+{
+    char data[sizeof(legacyData)];
+    nitf_TREPrivateData* priv = NULL;
+    nitf_TRECursor cursor;
+    nitf_Field* field;
+    nitf_Uint32 offset = 0;
+
+    if (!nitf_TREUtils_readField(io, data, (int)length, error))
+        return NITF_FAILURE;
+
+    priv = nitf_TREPrivateData_construct(error);
+    if (!priv)
+        return NITF_FAILURE;
+    priv->length = length;
+    priv->description = legacyDescription;
+    tre->priv = priv;
+
+    /*  the loop count is found by the cursor, though it is in the hash  */
+    cursor = nitf_TRECursor_begin(tre);
+    while (offset < length && nitf_TRECursor_iterate(&cursor, error))
+    {
+        field = nitf_Field_construct(cursor.length,
+                                     cursor.desc_ptr->data_type, error);
+        if (!field || !nitf_Field_setRawData(field, data + offset,
+                                             cursor.length, error) ||
+            !nitf_HashTable_insert(priv->hash, cursor.tag_str, field, error))
+            break;
+        offset += cursor.length;
+    }
+    nitf_TRECursor_cleanup(&cursor);
+    return offset == length;
+}
+
+TEST_CASE(testFieldStoreFind)
+{
+    nitf_Error error;
+    nitf_TREFieldStore* store = nitf_TREFieldStore_construct(&error);
+    int idx[2];
+    int i, n;
+
+    TEST_ASSERT(store);
+
+    /*  a field outside of any loop, and a loop of loops  */
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_add(store, "COUNT", NULL, 0,
+                                              NITF_BCS_N, "0300", 4,
+                                              &error), 0);
+    for (i = 0; i < 300; ++i)
+    {
+        idx[0] = i / 10;
+        idx[1] = i % 10;
+        n = nitf_TREFieldStore_add(store, coefTag, idx, 2, NITF_BCS_A,
+                                   NULL, 3, &error);
+        TEST_ASSERT_EQ_INT(n, i + 1);
+    }
+
+    /*  the tag is compared by value, not by address  */
+    idx[0] = 12;
+    idx[1] = 7;
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_find(store, "COEF", idx, 2), 128);
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_find(store, "COEF", idx, 1), -1);
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_find(store, "COUNT", NULL, 0), 0);
+
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_findName(store, "COEF[12][7]"), 128);
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_findName(store, "COEF[0][0]"), 1);
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_findName(store, "COUNT"), 0);
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_findName(store, "COEF[12]"), -1);
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_findName(store, "COEF[012][7]"), -1);
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_findName(store, "COEF[12][7"), -1);
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_findName(store, "COEF[30][0]"), -1);
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_findName(store, "COE[12][7]"), -1);
+
+    /*  clearing keeps nothing  */
+    nitf_TREFieldStore_clear(store);
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_findName(store, "COUNT"), -1);
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_add(store, "COUNT", NULL, 0,
+                                              NITF_BCS_N, "7", 1,
+                                              &error), 0);
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_findName(store, "COUNT"), 0);
+
+    nitf_TREFieldStore_destruct(&store);
+    TEST_ASSERT_NULL(store);
+}
+
+TEST_CASE(testFieldStoreFields)
+{
+    nitf_Error error;
+    nitf_TREFieldStore* store = nitf_TREFieldStore_construct(&error);
+    nitf_TREFieldStore* clone = NULL;
+    nitf_Field view;
+    nitf_Field* field;
+    nitf_Pair* pair;
+    int idx[1] = { 3 };
+    int n;
+
+    TEST_ASSERT(store);
+    n = nitf_TREFieldStore_add(store, coefTag, idx, 1, NITF_BCS_N,
+                               NULL, 4, &error);
+    TEST_ASSERT_EQ_INT(n, 0);
+
+    /*  a new field is filled by its type, and can be set in place  */
+    field = nitf_TREFieldStore_view(store, n, &view);
+    TEST_ASSERT(field == &view);
+    TEST_ASSERT_EQ_STR(field->raw, "0000");
+    TEST_ASSERT(nitf_TREFieldStore_set(store, n, "12", 2, &error));
+    TEST_ASSERT_EQ_STR(view.raw, "0012");
+    TEST_ASSERT(!nitf_TREFieldStore_set(store, n, "12345", 5, &error));
+
+    /*  the field is constructed once, with its qualified name  */
+    pair = nitf_TREFieldStore_getPair(store, n, &error);
+    TEST_ASSERT(pair);
+    TEST_ASSERT_EQ_STR(pair->key, "COEF[3]");
+    TEST_ASSERT(nitf_TREFieldStore_getPair(store, n, &error) == pair);
+    field = (nitf_Field*)pair->data;
+    TEST_ASSERT(nitf_TREFieldStore_view(store, n, &view) == field);
+
+    /*  and from then on, it holds the value  */
+    TEST_ASSERT(nitf_Field_setString(field, "42", &error));
+    clone = nitf_TREFieldStore_clone(store, &error);
+    TEST_ASSERT(clone);
+    n = nitf_TREFieldStore_findName(clone, "COEF[3]");
+    TEST_ASSERT_EQ_INT(n, 0);
+    field = nitf_TREFieldStore_view(clone, n, &view);
+    TEST_ASSERT(field == &view);
+    TEST_ASSERT_EQ_STR(field->raw, "0042");
+
+    /*  a resizable field is constructed to change its length  */
+    clone->entries[n].resizable = 1;
+    TEST_ASSERT(nitf_TREFieldStore_set(clone, n, "123456", 6, &error));
+    TEST_ASSERT(clone->entries[n].pair);
+    field = nitf_TREFieldStore_view(clone, n, &view);
+    TEST_ASSERT_EQ_INT(field->length, 6);
+
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_add(store, coefTag, idx, 1,
+                                              NITF_BCS_A, NULL, 0, &error),
+                       -1);
+
+    nitf_TREFieldStore_destruct(&clone);
+    nitf_TREFieldStore_destruct(&store);
+}
+
+TEST_CASE(testFieldStoreArena)
+{
+    nitf_Error error;
+    nitf_Arena* arena = nitf_Arena_construct(0, &error);
+    nitf_TREFieldStore* store = NULL;
+    nitf_TREFieldStore* clone = NULL;
+    nitf_Field* field;
+    nitf_Pair* pair;
+    nitf_Uint64 allocated;
+
+    TEST_ASSERT(arena);
+
+    /*  the store keeps the arena that was current when it was made  */
+    nitf_Arena_setCurrent(arena);
+    store = nitf_TREFieldStore_construct(&error);
+    nitf_Arena_setCurrent(NULL);
+    TEST_ASSERT(store);
+    TEST_ASSERT(store->arena == arena);
+
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_add(store, "COUNT", NULL, 0,
+                                              NITF_BCS_N, "12", 2,
+                                              &error), 0);
+    allocated = arena->allocated;
+    pair = nitf_TREFieldStore_getPair(store, 0, &error);
+    TEST_ASSERT(pair);
+    field = (nitf_Field*)pair->data;
+    TEST_ASSERT(field->pooled);
+    TEST_ASSERT_EQ_STR(field->raw, "12");
+    TEST_ASSERT(arena->allocated > allocated);
+
+    /*  a copy made without an arena allocates its own  */
+    clone = nitf_TREFieldStore_clone(store, &error);
+    TEST_ASSERT(clone);
+    TEST_ASSERT_NULL(clone->arena);
+    pair = nitf_TREFieldStore_getPair(clone, 0, &error);
+    TEST_ASSERT(pair);
+    TEST_ASSERT(!((nitf_Field*)pair->data)->pooled);
+
+    nitf_TREFieldStore_destruct(&clone);
+    nitf_TREFieldStore_destruct(&store);
+    nitf_Arena_destruct(&arena);
+}
+
+TEST_CASE(testFieldStoreAdopt)
+{
+    nitf_Error error;
+    nitf_TREFieldStore* store = nitf_TREFieldStore_construct(&error);
+    nitf_Field* field;
+    nitf_Field* other;
+    nitf_Field view;
+
+    TEST_ASSERT(store);
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_add(store, "COUNT", NULL, 0,
+                                              NITF_BCS_N, "12", 2,
+                                              &error), 0);
+
+    /*  a new name is added, with the tag given  */
+    field = nitf_Field_construct(3, NITF_BCS_A, &error);
+    TEST_ASSERT(field);
+    TEST_ASSERT(nitf_Field_setString(field, "abc", &error));
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_adopt(store, coefTag, "COEF[4]",
+                                                field, &error), 1);
+    TEST_ASSERT(nitf_TREFieldStore_view(store, 1, &view) == field);
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_findName(store, "COEF[4]"), 1);
+    TEST_ASSERT(nitf_TREFieldStore_adopt(store, coefTag, "COEF[4]",
+                                         field, &error) == 1);
+
+    /*  and an existing one is replaced  */
+    other = nitf_Field_construct(2, NITF_BCS_N, &error);
+    TEST_ASSERT(other);
+    TEST_ASSERT(nitf_Field_setString(other, "34", &error));
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_adopt(store, "COUNT", "COUNT",
+                                                other, &error), 0);
+    TEST_ASSERT(nitf_TREFieldStore_view(store, 0, &view) == other);
+    TEST_ASSERT_EQ_INT(store->numEntries, 2);
+
+    TEST_ASSERT_EQ_INT(nitf_TREFieldStore_adopt(store, coefTag, "COEF[4",
+                                                other, &error), -1);
+    nitf_TREFieldStore_destruct(&store);
+}
+
+TEST_CASE(testHashCompatibility)
+{
+    nitf_Error error;
+    nitf_TREHandler handler;
+    nitf_IOInterface* io = NULL;
+    nitf_TRE* tre = NULL;
+    nitf_TRE* clone = NULL;
+    nitf_TREPrivateData* priv;
+    nitf_Field* field;
+    nitf_Field* extra;
+    nitf_Pair* pair;
+    nitf_List* found;
+    nitf_Uint32 length = 0;
+    char* raw = NULL;
+
+    TEST_ASSERT(nitf_TREUtils_createBasicHandler(&legacyDescriptionSet,
+                                                 &handler, &error));
+    handler.read = legacyRead;
+
+    tre = nitf_TRE_createSkeleton("LEGACY", &error);
+    TEST_ASSERT(tre);
+    tre->handler = &handler;
+    io = nitf_BufferAdapter_construct((char*)legacyData, strlen(legacyData),
+                                      0, &error);
+    TEST_ASSERT(io);
+    TEST_ASSERT(handler.read(io, strlen(legacyData), tre, NULL, &error));
+    nitf_IOInterface_destruct(&io);
+    priv = (nitf_TREPrivateData*)tre->priv;
+
+    /*  a field that is not in the description stays in the hash  */
+    extra = nitf_Field_construct(1, NITF_BCS_A, &error);
+    TEST_ASSERT(extra);
+    TEST_ASSERT(nitf_HashTable_insert(priv->hash, "EXTRA", extra, &error));
+
+    /*  the fields in the hash are the fields of the TRE  */
+    pair = nitf_HashTable_find(priv->hash, "VALUE[1]");
+    TEST_ASSERT(pair);
+    field = nitf_TRE_getField(tre, "VALUE[1]");
+    TEST_ASSERT(field == (nitf_Field*)pair->data);
+    TEST_ASSERT_EQ_STR(field->raw, "bb");
+    TEST_ASSERT(nitf_TRE_getField(tre, "EXTRA") == extra);
+    TEST_ASSERT_NULL(nitf_TRE_getField(tre, "VALUE[3]"));
+
+    found = nitf_TRE_find(tre, "E", &error);
+    TEST_ASSERT(found);
+    TEST_ASSERT_EQ_INT(nitf_List_size(found), 4);
+    while (!nitf_List_isEmpty(found))
+        nitf_List_popFront(found);
+    nitf_List_destruct(&found);
+
+    TEST_ASSERT_EQ_INT(nitf_TRE_getCurrentSize(tre, &error),
+                       (int)strlen(legacyData));
+    raw = nitf_TREUtils_getRawData(tre, &length, &error);
+    TEST_ASSERT(raw);
+    TEST_ASSERT_EQ_INT(length, strlen(legacyData));
+    TEST_ASSERT(memcmp(raw, legacyData, length) == 0);
+    NITF_FREE(raw);
+
+    /*  a value set through the TRE is seen through the hash  */
+    TEST_ASSERT(nitf_TRE_setField(tre, "VALUE[1]", "zz", 2, &error));
+    TEST_ASSERT_EQ_STR(field->raw, "zz");
+
+    /*  and a copy has a hash of its own  */
+    clone = nitf_TRE_clone(tre, &error);
+    TEST_ASSERT(clone);
+    priv = (nitf_TREPrivateData*)clone->priv;
+    pair = nitf_HashTable_find(priv->hash, "VALUE[1]");
+    TEST_ASSERT(pair);
+    TEST_ASSERT(pair->data != field);
+    TEST_ASSERT(nitf_TRE_getField(clone, "VALUE[1]") ==
+                (nitf_Field*)pair->data);
+    TEST_ASSERT_EQ_STR(((nitf_Field*)pair->data)->raw, "zz");
+    TEST_ASSERT(nitf_TRE_getField(clone, "EXTRA") != extra);
+
+    nitf_TRE_destruct(&clone);
+    nitf_TRE_destruct(&tre);
+}
+
+TEST_CASE(testENGRDA)
+{
+    /*  ENGRDA reads its fields into the hash itself  */
+    static const char engrda[] =
+        "ENGINE              001"
+        "04TEMP00010002I2tC00000002\001\002\003\004";
+    const nitf_Uint32 size = sizeof(engrda) - 1;
+    nitf_Error error;
+    nitf_PluginRegistry* reg;
+    nitf_IOInterface* io = NULL;
+    nitf_TRE* tre = NULL;
+    nitf_Field* field;
+    nitf_Pair* pair;
+    nitf_Uint32 length = 0;
+    char* raw = NULL;
+    int hadError = 0;
+
+    reg = nitf_PluginRegistry_getInstance(&error);
+    TEST_ASSERT(reg);
+    tre = nitf_TRE_createSkeleton("ENGRDA", &error);
+    TEST_ASSERT(tre);
+    tre->handler = nitf_PluginRegistry_retrieveTREHandler(reg, "ENGRDA",
+                                                          &hadError, &error);
+    TEST_ASSERT(tre->handler);
+
+    io = nitf_BufferAdapter_construct((char*)engrda, size, 0, &error);
+    TEST_ASSERT(io);
+    TEST_ASSERT(tre->handler->read(io, size, tre, NULL, &error));
+    nitf_IOInterface_destruct(&io);
+
+    field = nitf_TRE_getField(tre, "ENGLBL[0]");
+    TEST_ASSERT(field);
+    TEST_ASSERT_EQ_INT(field->length, 4);
+    TEST_ASSERT(memcmp(field->raw, "TEMP", 4) == 0);
+    pair = nitf_HashTable_find(((nitf_TREPrivateData*)tre->priv)->hash,
+                               "ENGLBL[0]");
+    TEST_ASSERT(pair && pair->data == field);
+
+    field = nitf_TRE_getField(tre, "ENGDATA[0]");
+    TEST_ASSERT(field);
+    TEST_ASSERT_EQ_INT(field->type, NITF_BINARY);
+    TEST_ASSERT_EQ_INT(field->length, 4);
+
+    TEST_ASSERT_EQ_INT(nitf_TRE_getCurrentSize(tre, &error), (int)size);
+    raw = nitf_TREUtils_getRawData(tre, &length, &error);
+    TEST_ASSERT(raw);
+    TEST_ASSERT_EQ_INT(length, size);
+    TEST_ASSERT(memcmp(raw, engrda, size) == 0);
+    NITF_FREE(raw);
+
+    nitf_TRE_destruct(&tre);
+}
+
+int main(int argc, char **argv)
+{
+    CHECK(testFieldStoreFind);
+    CHECK(testFieldStoreFields);
+    CHECK(testFieldStoreArena);
+    CHECK(testFieldStoreAdopt);
+    CHECK(testHashCompatibility);
+    CHECK(testENGRDA);
+    return 0;
+}
@@ -0,0 +1,108 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; if not, If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NRT_ARENA_H__
+#define __NRT_ARENA_H__
+
+#include "nrt/Defines.h"
+#include "nrt/Types.h"
+#include "nrt/Error.h"
+
+NRT_CXX_GUARD
+
+/*!
+ *  \struct nrt_ArenaChunk
+ *  \brief One block of arena memory.  The allocations follow the header.
+ */
+typedef struct _NRT_ArenaChunk
+{
+    struct _NRT_ArenaChunk *next;
+    size_t size;
+    size_t used;
+} nrt_ArenaChunk;
+
+/*!
+ *  \struct nrt_Arena
+ *  \brief A region allocator
+ *
+ *  An arena hands out memory from large chunks and releases all of it
+ *  at once when it is destroyed.  Individual allocations are never
+ *  freed.  This suits the many small objects that are created together
+ *  and destroyed together, such as the fields of a parsed record.
+ */
+typedef struct _NRT_Arena
+{
+    nrt_ArenaChunk *chunks;     /* ! The chunk list, most recent first */
+    size_t chunkSize;           /* ! The default chunk size */
+    nrt_Uint64 allocated;       /* ! The bytes handed out so far */
+} nrt_Arena;
+
+/*! The default chunk size */
+#define NRT_ARENA_CHUNK_SIZE 65536
+
+/*!
+ *  Construct an empty arena.
+ *  \param chunkSize The size of each chunk (0 for NRT_ARENA_CHUNK_SIZE).
+ *  Larger allocations get a chunk of their own.
+ *  \param error An error to populate on failure
+ *  \return The arena, or NULL on failure
+ */
+NRTAPI(nrt_Arena *) nrt_Arena_construct(size_t chunkSize, nrt_Error * error);
+
+/*!
+ *  Allocate from the arena.  The memory is suitably aligned for any type
+ *  and remains valid until the arena is destroyed.
+ *  \param arena The arena
+ *  \param size The number of bytes
+ *  \return The memory, or NULL if the system is out of memory
+ */
+NRTAPI(void *) nrt_Arena_alloc(nrt_Arena * arena, size_t size);
+
+/*!
+ *  Release all of the memory of the arena, and the arena itself.  The
+ *  arena must not be current on any thread (see nrt_Arena_setCurrent).
+ *  \param arena The arena to destroy and NULL-set
+ */
+NRTAPI(void) nrt_Arena_destruct(nrt_Arena ** arena);
+
+/*!
+ *  Make an arena current for the calling thread.  Objects that support
+ *  arena allocation (for example nitf_Field) take their memory from the
+ *  current arena while one is set.  Pass NULL to stop using an arena.
+ *
+ *  On platforms without thread local storage this has no effect, and
+ *  objects are allocated individually.
+ *
+ *  \param arena The arena to use, or NULL
+ *  \return The arena that was current before, to restore afterward
+ */
+NRTAPI(nrt_Arena *) nrt_Arena_setCurrent(nrt_Arena * arena);
+
+/*!
+ *  Get the current arena of the calling thread.
+ *  \return The arena, or NULL if none is set
+ */
+NRTAPI(nrt_Arena *) nrt_Arena_getCurrent(void);
+
+NRT_CXX_ENDGUARD
+
+#endif
@@ -66,6 +66,24 @@ NRTAPI(nrt_IOHandle) nrt_IOHandle_create(const char *fname,
 NRTAPI(NRT_BOOL) nrt_IOHandle_read(nrt_IOHandle handle, void* buf, size_t size,
                                    nrt_Error * error);
 
+/*!
+ *  Read from the IO handle at an absolute offset.  This function does not
+ *  use or change the handle's file position (on Windows the position is
+ *  updated, but is not used), so it may be called from several threads on
+ *  the same handle at once.  Like nrt_IOHandle_read, it is guaranteed to
+ *  return after having read the requisite number of bytes or fail out.
+ *
+ *  \param handle The handle to read from
+ *  \param offset The file offset to read from
+ *  \param buf    The buffer to read into
+ *  \param size   The number of bytes to read
+ *  \param error  Populated if function returns 0
+ *  \return       1 on success and 0 otherwise
+ */
+NRTAPI(NRT_BOOL) nrt_IOHandle_readAt(nrt_IOHandle handle, nrt_Off offset,
+                                     void* buf, size_t size,
+                                     nrt_Error * error);
+
 /*!
  *  Write to the IO handle.  This function attempts to write to the IO handle
  *  until it has written the requisite number of bytes (specified as the size
@@ -80,6 +98,23 @@ NRTAPI(NRT_BOOL) nrt_IOHandle_read(nrt_IOHandle handle, void* buf, size_t size,
 NRTAPI(NRT_BOOL) nrt_IOHandle_write(nrt_IOHandle handle, const void* buf,
                                     size_t size, nrt_Error * error);
 
+/*!
+ *  Write to the IO handle at an absolute offset.  Like nrt_IOHandle_readAt,
+ *  this does not use or change the handle's file position (on Windows the
+ *  position is updated, but is not used), so several threads may write
+ *  different parts of the same handle at once.
+ *
+ *  \param handle The handle to write to
+ *  \param offset The file offset to write at
+ *  \param buf    The buffer to write from
+ *  \param size   The number of bytes to write
+ *  \param error  Populated if function returns 0
+ *  \return       1 on success and 0 otherwise
+ */
+NRTAPI(NRT_BOOL) nrt_IOHandle_writeAt(nrt_IOHandle handle, nrt_Off offset,
+                                      const void* buf, size_t size,
+                                      nrt_Error * error);
+
 /*!
  *  Seek into the handle at this point.  Basically
  *  has the same usage as lseek().  If whence is SEEK_SET, the seek
@@ -120,6 +155,28 @@ NRTAPI(nrt_Off) nrt_IOHandle_tell(nrt_IOHandle handle, nrt_Error * error);
  */
 NRTAPI(nrt_Off) nrt_IOHandle_getSize(nrt_IOHandle handle, nrt_Error * error);
 
+/*!
+ *  Map the first size bytes of the handle's file into memory, read-only.
+ *  The mapping remains valid after the handle is closed and must be
+ *  released with nrt_IOHandle_unmap.  The size must not be zero.
+ *
+ *  \param handle The handle to map
+ *  \param size   The number of bytes to map (normally the file size)
+ *  \param error  Populated if function returns NULL
+ *  \return       The address of the mapping or NULL on error
+ */
+NRTAPI(const void*) nrt_IOHandle_map(nrt_IOHandle handle, size_t size,
+                                     nrt_Error * error);
+
+/*!
+ *  Release a mapping created by nrt_IOHandle_map.
+ *
+ *  \param addr The address returned by nrt_IOHandle_map
+ *  \param size The size that was mapped
+ *  \return void
+ */
+NRTAPI(void) nrt_IOHandle_unmap(const void* addr, size_t size);
+
 /*!
  *  Close the IO handle.
  *
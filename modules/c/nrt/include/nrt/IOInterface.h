@@ -39,6 +39,13 @@ typedef nrt_Off(*NRT_IO_INTERFACE_GET_SIZE) (NRT_DATA *, nrt_Error *);
 typedef int (*NRT_IO_INTERFACE_GET_MODE) (NRT_DATA *, nrt_Error *);
 typedef NRT_BOOL(*NRT_IO_INTERFACE_CLOSE) (NRT_DATA *, nrt_Error *);
 typedef void (*NRT_IO_INTERFACE_DESTRUCT) (NRT_DATA *);
+typedef NRT_BOOL(*NRT_IO_INTERFACE_READ_AT) (NRT_DATA *, nrt_Off, void *,
+                                             size_t, nrt_Error *);
+typedef const void*(*NRT_IO_INTERFACE_GET_BUFFER) (NRT_DATA *, nrt_Off,
+                                                   size_t);
+typedef NRT_BOOL(*NRT_IO_INTERFACE_WRITE_AT) (NRT_DATA *, nrt_Off,
+                                              const void *, size_t,
+                                              nrt_Error *);
 
 typedef struct _NRT_IIOInterface
 {
@@ -51,6 +58,15 @@ typedef struct _NRT_IIOInterface
     NRT_IO_INTERFACE_GET_MODE getMode;
     NRT_IO_INTERFACE_CLOSE close;
     NRT_IO_INTERFACE_DESTRUCT destruct;
+
+    /* Optional, may be NULL (see nrt_IOInterface_readAt) */
+    NRT_IO_INTERFACE_READ_AT readAt;
+
+    /* Optional, may be NULL (see nrt_IOInterface_getBuffer) */
+    NRT_IO_INTERFACE_GET_BUFFER getBuffer;
+
+    /* Optional, may be NULL (see nrt_IOInterface_writeAt) */
+    NRT_IO_INTERFACE_WRITE_AT writeAt;
 } nrt_IIOInterface;
 
 typedef struct _NRT_IOInterface
@@ -65,19 +81,67 @@ typedef struct _NRT_IOInterface
 NRTAPI(NRT_BOOL) nrt_IOInterface_read(nrt_IOInterface *, void* buf, size_t size,
                                       nrt_Error * error);
 
+/**
+ * Reads data from the interface at an absolute offset, without using the
+ * current offset. If the interface provides readAt, the read is positional
+ * and may be made from several threads at once. Otherwise this falls back
+ * to a seek followed by a read, which moves the current offset and is not
+ * safe for concurrent use (see nrt_IOInterface_canReadAt).
+ */
+NRTAPI(NRT_BOOL) nrt_IOInterface_readAt(nrt_IOInterface * io, nrt_Off offset,
+                                        void* buf, size_t size,
+                                        nrt_Error * error);
+
+/**
+ * Returns whether the interface supports positional reads that are safe
+ * to make from several threads at once
+ */
+NRTAPI(NRT_BOOL) nrt_IOInterface_canReadAt(nrt_IOInterface * io);
+
+/**
+ * Returns a pointer to size bytes of the interface's data at offset, for
+ * interfaces whose data is in memory (see nrt_MappedAdapter_open and
+ * nrt_BufferAdapter_construct). The data may be used in place, without a
+ * copy, but must not be modified. It remains valid until the interface is
+ * closed or destroyed (or, for a buffer, written to). NULL is returned if
+ * the interface does not support this or the range is not in the data, in
+ * which case the caller should read the data instead.
+ */
+NRTAPI(const void*) nrt_IOInterface_getBuffer(nrt_IOInterface * io,
+                                              nrt_Off offset, size_t size);
+
 /**
  * Writes data to the interface
  */
 NRTAPI(NRT_BOOL) nrt_IOInterface_write(nrt_IOInterface * io, const void* buf,
                                        size_t size, nrt_Error * error);
 
+/**
+ * Writes data to the interface at an absolute offset, without using the
+ * current offset. If the interface provides writeAt, the write is
+ * positional and several threads may write different parts of the
+ * interface at once. Otherwise this falls back to a seek followed by a
+ * write, which moves the current offset and is not safe for concurrent
+ * use (see nrt_IOInterface_canWriteAt).
+ */
+NRTAPI(NRT_BOOL) nrt_IOInterface_writeAt(nrt_IOInterface * io, nrt_Off offset,
+                                         const void* buf, size_t size,
+                                         nrt_Error * error);
+
+/**
+ * Returns whether the interface supports positional writes that are safe
+ * to make from several threads at once
+ */
+NRTAPI(NRT_BOOL) nrt_IOInterface_canWriteAt(nrt_IOInterface * io);
+
 /**
  * Returns whether the interface is seekable
  */
 NRTAPI(NRT_BOOL) nrt_IOInterface_canSeek(nrt_IOInterface * io, nrt_Error *);
 
 /**
- * Seeks to the offset specified, given the provided seek scenario
+ * Seeks to the offset specified, given the provided seek scenario. If the
+ * interface is not seekable, only a seek to the current offset succeeds
  */
 NRTAPI(nrt_Off) nrt_IOInterface_seek(nrt_IOInterface * io, nrt_Off offset,
                                      int whence, nrt_Error * error);
@@ -131,5 +195,15 @@ NRTAPI(nrt_IOInterface *) nrt_BufferAdapter_construct(char *buf, size_t size,
                                                       NRT_BOOL ownBuf,
                                                       nrt_Error * error);
 
+/**
+ * Creates a read-only IOInterface over a memory mapping of the named file.
+ * Reads are copies from the mapping and nrt_IOInterface_getBuffer gives
+ * direct access to it, so data can be used without read calls or copies.
+ * Positional reads are supported (see nrt_IOInterface_readAt). Closing or
+ * destroying the interface releases the mapping and the file.
+ */
+NRTAPI(nrt_IOInterface *) nrt_MappedAdapter_open(const char *fname,
+                                                 nrt_Error * error);
+
 NRT_CXX_ENDGUARD
 #endif
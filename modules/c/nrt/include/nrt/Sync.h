@@ -26,18 +26,37 @@
 #include "nrt/Defines.h"
 #include "nrt/Types.h"
 #include "nrt/Memory.h"
+#include "nrt/Error.h"
 
 NRT_CXX_GUARD
+
+/*!
+ *  The function run by a thread, it is passed the thread's data and its
+ *  return value is discarded
+ */
+typedef NRT_DATA* (*NRT_THREAD_RUN) (NRT_DATA *);
+
 #if defined(WIN32)
 typedef LPCRITICAL_SECTION nrt_Mutex;
+typedef CONDITION_VARIABLE nrt_Condition;
+typedef struct _NRT_Thread
+{
+    HANDLE handle;
+    NRT_THREAD_RUN run;
+    NRT_DATA *data;
+} nrt_Thread;
 #elif defined(__sgi)
 #   include <sys/atomic_ops.h>
 #   define NRT_MUTEX_INIT 0
 typedef int nrt_Mutex;
+typedef int nrt_Condition;
+typedef int nrt_Thread;
 #else
 #   include <pthread.h>
 #   define NRT_MUTEX_INIT PTHREAD_MUTEX_INITIALIZER
 typedef pthread_mutex_t nrt_Mutex;
+typedef pthread_cond_t nrt_Condition;
+typedef pthread_t nrt_Thread;
 #endif
 
 NRTPROT(void) nrt_Mutex_lock(nrt_Mutex * m);
@@ -45,5 +64,48 @@ NRTPROT(void) nrt_Mutex_unlock(nrt_Mutex * m);
 NRTPROT(void) nrt_Mutex_init(nrt_Mutex * m);
 NRTPROT(void) nrt_Mutex_delete(nrt_Mutex * m);
 
+/*!
+ *  Initialize a condition variable, used with a mutex to wait for a
+ *  change made by another thread
+ */
+NRTPROT(void) nrt_Condition_init(nrt_Condition * c);
+
+/*!
+ *  Release the mutex, which the caller must hold, wait until the condition
+ *  is signalled and take the mutex again. Wake-ups may be spurious, so the
+ *  caller waits in a loop that tests what it is waiting for.
+ */
+NRTPROT(void) nrt_Condition_wait(nrt_Condition * c, nrt_Mutex * m);
+
+/*!
+ *  Wake all threads waiting on the condition
+ */
+NRTPROT(void) nrt_Condition_broadcast(nrt_Condition * c);
+
+NRTPROT(void) nrt_Condition_delete(nrt_Condition * c);
+
+/*!
+ *  Start a thread that runs the given function on the given data.  The
+ *  thread object must remain valid until nrt_Thread_join is called.
+ *
+ *  \param t      The thread object to start
+ *  \param run    The function to run
+ *  \param data   The data passed to the function
+ *  \param error  Populated if the function returns 0
+ *  \return       1 on success and 0 otherwise
+ */
+NRTPROT(NRT_BOOL) nrt_Thread_create(nrt_Thread * t, NRT_THREAD_RUN run,
+                                    NRT_DATA * data, nrt_Error * error);
+
+/*!
+ *  Wait for a thread started by nrt_Thread_create to finish
+ */
+NRTPROT(void) nrt_Thread_join(nrt_Thread * t);
+
+/*!
+ *  Returns the number of processors available, at least 1
+ */
+NRTPROT(int) nrt_Thread_getNumCPUs(void);
+
 NRT_CXX_ENDGUARD
 #endif
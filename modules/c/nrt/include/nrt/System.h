@@ -27,6 +27,7 @@
 #include "nrt/Types.h"
 #include "nrt/Error.h"
 #include "nrt/Memory.h"
+#include "nrt/Arena.h"
 #include "nrt/DLL.h"
 #include "nrt/Sync.h"
 #include "nrt/Directory.h"
@@ -0,0 +1,132 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; if not, If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nrt/Arena.h"
+#include "nrt/Memory.h"
+
+/* Allocations are rounded up to keep every pointer aligned for any type */
+#define NRT_ARENA_ALIGN 16
+#define NRT_ARENA_ROUND(N) (((N) + NRT_ARENA_ALIGN - 1) & \
+                            ~((size_t) NRT_ARENA_ALIGN - 1))
+#define NRT_ARENA_HEADER NRT_ARENA_ROUND(sizeof(nrt_ArenaChunk))
+
+#if defined(_MSC_VER)
+#   define NRT_ARENA_TLS __declspec(thread)
+#elif defined(__GNUC__) || defined(__clang__) || defined(__SUNPRO_C)
+#   define NRT_ARENA_TLS __thread
+#endif
+
+#ifdef NRT_ARENA_TLS
+static NRT_ARENA_TLS nrt_Arena *nrt_Arena_current = NULL;
+#endif
+
+NRTAPI(nrt_Arena *) nrt_Arena_construct(size_t chunkSize, nrt_Error * error)
+{
+    nrt_Arena *arena = (nrt_Arena *) NRT_MALLOC(sizeof(nrt_Arena));
+    if (!arena)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        return NULL;
+    }
+
+    arena->chunks = NULL;
+    arena->chunkSize = chunkSize ? chunkSize : NRT_ARENA_CHUNK_SIZE;
+    arena->allocated = 0;
+    return arena;
+}
+
+NRTAPI(void *) nrt_Arena_alloc(nrt_Arena * arena, size_t size)
+{
+    nrt_ArenaChunk *chunk = arena->chunks;
+    char *ptr;
+
+    size = NRT_ARENA_ROUND(size ? size : 1);
+    if (!chunk || chunk->size - chunk->used < size)
+    {
+        /*
+         *  An oversized request gets a chunk of its own, behind the
+         *  current one so the remainder of that can still be used
+         */
+        size_t chunkSize = size > arena->chunkSize ? size : arena->chunkSize;
+        nrt_ArenaChunk *fresh =
+            (nrt_ArenaChunk *) NRT_MALLOC(NRT_ARENA_HEADER + chunkSize);
+        if (!fresh)
+            return NULL;
+
+        fresh->size = chunkSize;
+        fresh->used = 0;
+        if (chunk && chunkSize > arena->chunkSize)
+        {
+            fresh->next = chunk->next;
+            chunk->next = fresh;
+        }
+        else
+        {
+            fresh->next = chunk;
+            arena->chunks = fresh;
+        }
+        chunk = fresh;
+    }
+
+    ptr = (char *) chunk + NRT_ARENA_HEADER + chunk->used;
+    chunk->used += size;
+    arena->allocated += size;
+    return ptr;
+}
+
+NRTAPI(void) nrt_Arena_destruct(nrt_Arena ** arena)
+{
+    if (*arena)
+    {
+        nrt_ArenaChunk *chunk = (*arena)->chunks;
+        while (chunk)
+        {
+            nrt_ArenaChunk *next = chunk->next;
+            NRT_FREE(chunk);
+            chunk = next;
+        }
+        NRT_FREE(*arena);
+        *arena = NULL;
+    }
+}
+
+NRTAPI(nrt_Arena *) nrt_Arena_setCurrent(nrt_Arena * arena)
+{
+#ifdef NRT_ARENA_TLS
+    nrt_Arena *previous = nrt_Arena_current;
+    nrt_Arena_current = arena;
+    return previous;
+#else
+    (void) arena;
+    return NULL;
+#endif
+}
+
+NRTAPI(nrt_Arena *) nrt_Arena_getCurrent(void)
+{
+#ifdef NRT_ARENA_TLS
+    return nrt_Arena_current;
+#else
+    return NULL;
+#endif
+}
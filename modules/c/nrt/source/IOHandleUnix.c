@@ -22,6 +22,7 @@
 
 #ifndef WIN32
 
+#include <sys/mman.h>
 #include "nrt/IOHandle.h"
 
 NRTAPI(nrt_IOHandle) nrt_IOHandle_create(const char *fname,
@@ -104,6 +105,62 @@ NRTAPI(NRT_BOOL) nrt_IOHandle_read(nrt_IOHandle handle, void* buf, size_t size,
     return NRT_FAILURE;
 }
 
+NRTAPI(NRT_BOOL) nrt_IOHandle_readAt(nrt_IOHandle handle, nrt_Off offset,
+                                     void* buf, size_t size,
+                                     nrt_Error * error)
+{
+    ssize_t bytesRead = 0;      /* Number of bytes read during last read
+                                 * operation */
+    size_t totalBytesRead = 0;  /* Total bytes read thus far */
+    int i;                      /* iterator */
+
+    /* make sure the user actually wants data */
+    if (size <= 0)
+        return NRT_SUCCESS;
+
+    for (i = 1; i <= NRT_MAX_READ_ATTEMPTS; i++)
+    {
+        bytesRead = pread(handle,
+                          (nrt_Uint8*)buf + totalBytesRead,
+                          size - totalBytesRead,
+                          offset + (nrt_Off) totalBytesRead);
+
+        switch (bytesRead)
+        {
+        case -1:               /* Some type of error occured */
+            switch (errno)
+            {
+            case EINTR:
+            case EAGAIN:       /* A non-fatal error occured, keep trying */
+                break;
+
+            default:           /* We failed */
+                goto CATCH_ERROR;
+            }
+            break;
+
+        case 0:                /* EOF (unexpected) */
+            nrt_Error_init(error, "Unexpected end of file", NRT_CTXT,
+                           NRT_ERR_READING_FROM_FILE);
+            return NRT_FAILURE;
+
+        default:               /* We made progress */
+            totalBytesRead += (size_t) bytesRead;
+            break;
+        }
+
+        if (totalBytesRead == size)
+        {
+            return NRT_SUCCESS;
+        }
+    }
+
+    CATCH_ERROR:
+
+    nrt_Error_init(error, strerror(errno), NRT_CTXT, NRT_ERR_READING_FROM_FILE);
+    return NRT_FAILURE;
+}
+
 NRTAPI(NRT_BOOL) nrt_IOHandle_write(nrt_IOHandle handle, const void *buf,
                                     size_t size, nrt_Error * error)
 {
@@ -126,6 +183,32 @@ NRTAPI(NRT_BOOL) nrt_IOHandle_write(nrt_IOHandle handle, const void *buf,
     return NRT_SUCCESS;
 }
 
+NRTAPI(NRT_BOOL) nrt_IOHandle_writeAt(nrt_IOHandle handle, nrt_Off offset,
+                                      const void *buf, size_t size,
+                                      nrt_Error * error)
+{
+    size_t bytesActuallyWritten = 0;
+
+    while (bytesActuallyWritten < size)
+    {
+        const ssize_t bytesThisWrite =
+            pwrite(handle, (const nrt_Uint8*)buf + bytesActuallyWritten,
+                   size - bytesActuallyWritten,
+                   offset + (nrt_Off) bytesActuallyWritten);
+        if (bytesThisWrite == -1)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            nrt_Error_init(error, strerror(errno), NRT_CTXT,
+                           NRT_ERR_WRITING_TO_FILE);
+            return NRT_FAILURE;
+        }
+        bytesActuallyWritten += bytesThisWrite;
+    }
+
+    return NRT_SUCCESS;
+}
+
 NRTAPI(nrt_Off) nrt_IOHandle_seek(nrt_IOHandle handle, nrt_Off offset,
                                   int whence, nrt_Error * error)
 {
@@ -155,6 +238,24 @@ NRTAPI(nrt_Off) nrt_IOHandle_getSize(nrt_IOHandle handle, nrt_Error * error)
     return buf.st_size;
 }
 
+NRTAPI(const void*) nrt_IOHandle_map(nrt_IOHandle handle, size_t size,
+                                     nrt_Error * error)
+{
+    void* addr = mmap(NULL, size, PROT_READ, MAP_SHARED, handle, 0);
+    if (addr == MAP_FAILED)
+    {
+        nrt_Error_init(error, strerror(errno), NRT_CTXT,
+                       NRT_ERR_OPENING_FILE);
+        return NULL;
+    }
+    return addr;
+}
+
+NRTAPI(void) nrt_IOHandle_unmap(const void* addr, size_t size)
+{
+    munmap((void*) addr, size);
+}
+
 NRTAPI(void) nrt_IOHandle_close(nrt_IOHandle handle)
 {
     close(handle);
@@ -96,6 +96,54 @@ NRTAPI(NRT_BOOL) nrt_IOHandle_read(nrt_IOHandle handle, void* buf, size_t size,
     return NRT_SUCCESS;
 }
 
+NRTAPI(NRT_BOOL) nrt_IOHandle_readAt(nrt_IOHandle handle, nrt_Off offset,
+                                     void* buf, size_t size,
+                                     nrt_Error * error)
+{
+    static const DWORD MAX_READ_SIZE = (DWORD)-1;
+    size_t bytesRead = 0;
+    size_t bytesRemaining = size;
+
+    while (bytesRead < size)
+    {
+        /* Determine how many bytes to read */
+        const DWORD bytesToRead = (bytesRemaining > MAX_READ_SIZE) ?
+            MAX_READ_SIZE : (DWORD)bytesRemaining;
+
+        /* The offset is passed in the OVERLAPPED structure */
+        OVERLAPPED overlapped;
+        LARGE_INTEGER largeInt;
+        DWORD bytesThisRead = 0;
+
+        largeInt.QuadPart = offset + (nrt_Off) bytesRead;
+        memset(&overlapped, 0, sizeof(OVERLAPPED));
+        overlapped.Offset = largeInt.LowPart;
+        overlapped.OffsetHigh = largeInt.HighPart;
+
+        if (!ReadFile(handle,
+                      (nrt_Uint8*)buf + bytesRead,
+                      bytesToRead,
+                      &bytesThisRead,
+                      &overlapped))
+        {
+            nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                           NRT_ERR_READING_FROM_FILE);
+            return NRT_FAILURE;
+        }
+        else if (bytesThisRead == 0)
+        {
+            nrt_Error_init(error, "Unexpected end of file", NRT_CTXT,
+                           NRT_ERR_READING_FROM_FILE);
+            return NRT_FAILURE;
+        }
+
+        bytesRead += bytesThisRead;
+        bytesRemaining -= bytesThisRead;
+    }
+
+    return NRT_SUCCESS;
+}
+
 NRTAPI(NRT_BOOL) nrt_IOHandle_write(nrt_IOHandle handle, const void *buf,
                                     size_t size, nrt_Error * error)
 {
@@ -133,6 +181,48 @@ NRTAPI(NRT_BOOL) nrt_IOHandle_write(nrt_IOHandle handle, const void *buf,
     return NRT_SUCCESS;
 }
 
+NRTAPI(NRT_BOOL) nrt_IOHandle_writeAt(nrt_IOHandle handle, nrt_Off offset,
+                                      const void *buf, size_t size,
+                                      nrt_Error * error)
+{
+    static const DWORD MAX_WRITE_SIZE = (DWORD)-1;
+    size_t bytesRemaining = size;
+    size_t bytesWritten = 0;
+
+    while (bytesWritten < size)
+    {
+        /* Determine how many bytes to write */
+        const DWORD bytesToWrite = (bytesRemaining > MAX_WRITE_SIZE) ?
+            MAX_WRITE_SIZE : (DWORD)bytesRemaining;
+
+        /* The offset is passed in the OVERLAPPED structure */
+        OVERLAPPED overlapped;
+        LARGE_INTEGER largeInt;
+        DWORD bytesThisWrite = 0;
+
+        largeInt.QuadPart = offset + (nrt_Off) bytesWritten;
+        memset(&overlapped, 0, sizeof(OVERLAPPED));
+        overlapped.Offset = largeInt.LowPart;
+        overlapped.OffsetHigh = largeInt.HighPart;
+
+        if (!WriteFile(handle,
+                       (const nrt_Uint8*)buf + bytesWritten,
+                       bytesToWrite,
+                       &bytesThisWrite,
+                       &overlapped))
+        {
+            nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                           NRT_ERR_WRITING_TO_FILE);
+            return NRT_FAILURE;
+        }
+
+        bytesRemaining -= bytesThisWrite;
+        bytesWritten += bytesThisWrite;
+    }
+
+    return NRT_SUCCESS;
+}
+
 NRTAPI(nrt_Off) nrt_IOHandle_seek(nrt_IOHandle handle, nrt_Off offset,
                                   int whence, nrt_Error * error)
 {
@@ -175,6 +265,37 @@ NRTAPI(nrt_Off) nrt_IOHandle_getSize(nrt_IOHandle handle, nrt_Error * error)
     return (nrt_Off)((off << 32) + ret);
 }
 
+NRTAPI(const void*) nrt_IOHandle_map(nrt_IOHandle handle, size_t size,
+                                     nrt_Error * error)
+{
+    HANDLE mapping;
+    const void* addr;
+
+    mapping = CreateFileMapping(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_OPENING_FILE);
+        return NULL;
+    }
+
+    /* The view keeps the mapping object alive */
+    addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    if (addr == NULL)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_OPENING_FILE);
+    }
+    CloseHandle(mapping);
+    return addr;
+}
+
+NRTAPI(void) nrt_IOHandle_unmap(const void* addr, size_t size)
+{
+    (void)size;
+    UnmapViewOfFile(addr);
+}
+
 NRTAPI(void) nrt_IOHandle_close(nrt_IOHandle handle)
 {
     CloseHandle(handle);
@@ -15,18 +15,68 @@ typedef struct _BufferIOControl
     NRT_BOOL ownBuf;
 } BufferIOControl;
 
+typedef struct _MappedIOControl
+{
+    nrt_IOHandle handle;
+    const char *buf;            /* The mapping, NULL if the file is empty */
+    size_t size;
+    size_t mark;
+} MappedIOControl;
+
 NRTAPI(NRT_BOOL) nrt_IOInterface_read(nrt_IOInterface * io, void* buf,
                                       size_t size, nrt_Error * error)
 {
     return io->iface->read(io->data, buf, size, error);
 }
 
+NRTAPI(NRT_BOOL) nrt_IOInterface_readAt(nrt_IOInterface * io, nrt_Off offset,
+                                        void* buf, size_t size,
+                                        nrt_Error * error)
+{
+    if (io->iface->readAt)
+        return io->iface->readAt(io->data, offset, buf, size, error);
+
+    if (nrt_IOInterface_seek(io, offset, NRT_SEEK_SET, error) < 0)
+        return NRT_FAILURE;
+    return nrt_IOInterface_read(io, buf, size, error);
+}
+
+NRTAPI(NRT_BOOL) nrt_IOInterface_canReadAt(nrt_IOInterface * io)
+{
+    return io->iface->readAt != NULL;
+}
+
+NRTAPI(const void*) nrt_IOInterface_getBuffer(nrt_IOInterface * io,
+                                              nrt_Off offset, size_t size)
+{
+    if (!io->iface->getBuffer)
+        return NULL;
+    return io->iface->getBuffer(io->data, offset, size);
+}
+
 NRTAPI(NRT_BOOL) nrt_IOInterface_write(nrt_IOInterface * io, const void* buf,
                                        size_t size, nrt_Error * error)
 {
     return io->iface->write(io->data, buf, size, error);
 }
 
+NRTAPI(NRT_BOOL) nrt_IOInterface_writeAt(nrt_IOInterface * io, nrt_Off offset,
+                                         const void* buf, size_t size,
+                                         nrt_Error * error)
+{
+    if (io->iface->writeAt)
+        return io->iface->writeAt(io->data, offset, buf, size, error);
+
+    if (nrt_IOInterface_seek(io, offset, NRT_SEEK_SET, error) < 0)
+        return NRT_FAILURE;
+    return nrt_IOInterface_write(io, buf, size, error);
+}
+
+NRTAPI(NRT_BOOL) nrt_IOInterface_canWriteAt(nrt_IOInterface * io)
+{
+    return io->iface->writeAt != NULL;
+}
+
 NRTAPI(NRT_BOOL) nrt_IOInterface_canSeek(nrt_IOInterface * io,
                                          nrt_Error * error)
 {
@@ -38,6 +88,10 @@ NRTAPI(nrt_Off) nrt_IOInterface_seek(nrt_IOInterface * io, nrt_Off offset,
 {
     if (!nrt_IOInterface_canSeek(io, error) && offset != 0)
     {
+        /* A seek to the current offset does not move, so it is allowed */
+        if (whence == NRT_SEEK_SET && nrt_IOInterface_tell(io, error) == offset)
+            return offset;
+
         nrt_Error_init(error, "IO Interface does not support seeking", NRT_CTXT,
                        NRT_ERR_INVALID_OBJECT);
         return (nrt_Off) - 1;
@@ -92,6 +146,14 @@ NRTPRIV(NRT_BOOL) IOHandleAdapter_read(NRT_DATA * data, void *buf, size_t size,
     return nrt_IOHandle_read(control->handle, buf, size, error);
 }
 
+NRTPRIV(NRT_BOOL) IOHandleAdapter_readAt(NRT_DATA * data, nrt_Off offset,
+                                         void *buf, size_t size,
+                                         nrt_Error * error)
+{
+    IOHandleControl *control = (IOHandleControl *) data;
+    return nrt_IOHandle_readAt(control->handle, offset, buf, size, error);
+}
+
 NRTPRIV(NRT_BOOL) IOHandleAdapter_write(NRT_DATA * data, const void *buf,
                                         size_t size, nrt_Error * error)
 {
@@ -99,6 +161,14 @@ NRTPRIV(NRT_BOOL) IOHandleAdapter_write(NRT_DATA * data, const void *buf,
     return nrt_IOHandle_write(control->handle, buf, size, error);
 }
 
+NRTPRIV(NRT_BOOL) IOHandleAdapter_writeAt(NRT_DATA * data, nrt_Off offset,
+                                          const void *buf, size_t size,
+                                          nrt_Error * error)
+{
+    IOHandleControl *control = (IOHandleControl *) data;
+    return nrt_IOHandle_writeAt(control->handle, offset, buf, size, error);
+}
+
 NRTPRIV(NRT_BOOL) IOHandleAdapter_canSeek(NRT_DATA * data, nrt_Error * error)
 {
     /* Silence compiler warnings about unused variables */
@@ -183,6 +253,37 @@ NRTPRIV(NRT_BOOL) BufferAdapter_read(NRT_DATA * data, void *buf, size_t size,
     return NRT_SUCCESS;
 }
 
+NRTPRIV(NRT_BOOL) BufferAdapter_readAt(NRT_DATA * data, nrt_Off offset,
+                                       void *buf, size_t size,
+                                       nrt_Error * error)
+{
+    BufferIOControl *control = (BufferIOControl *) data;
+
+    if (offset < 0 || (nrt_Uint64) offset > (nrt_Uint64) control->size ||
+        size > control->size - (size_t) offset)
+    {
+        nrt_Error_init(error, "Invalid size requested - EOF", NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        return NRT_FAILURE;
+    }
+
+    if (size > 0)
+        memcpy(buf, (char *) (control->buf + (size_t) offset), size);
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(const void*) BufferAdapter_getBuffer(NRT_DATA * data, nrt_Off offset,
+                                             size_t size)
+{
+    BufferIOControl *control = (BufferIOControl *) data;
+
+    if (offset < 0 || (nrt_Uint64) offset > (nrt_Uint64) control->size ||
+        size > control->size - (size_t) offset)
+        return NULL;
+
+    return control->buf + (size_t) offset;
+}
+
 NRTPRIV(NRT_BOOL) BufferAdapter_write(NRT_DATA * data, const void *buf,
                                       size_t size, nrt_Error * error)
 {
@@ -299,6 +400,160 @@ NRTPRIV(void) BufferAdapter_destruct(NRT_DATA * data)
     }
 }
 
+NRTPRIV(NRT_BOOL) MappedAdapter_readAt(NRT_DATA * data, nrt_Off offset,
+                                       void *buf, size_t size,
+                                       nrt_Error * error)
+{
+    MappedIOControl *control = (MappedIOControl *) data;
+
+    if (offset < 0 || (nrt_Uint64) offset > (nrt_Uint64) control->size ||
+        size > control->size - (size_t) offset)
+    {
+        nrt_Error_init(error, "Unexpected end of file", NRT_CTXT,
+                       NRT_ERR_READING_FROM_FILE);
+        return NRT_FAILURE;
+    }
+
+    if (size > 0)
+        memcpy(buf, control->buf + (size_t) offset, size);
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(NRT_BOOL) MappedAdapter_read(NRT_DATA * data, void *buf, size_t size,
+                                     nrt_Error * error)
+{
+    MappedIOControl *control = (MappedIOControl *) data;
+
+    if (!MappedAdapter_readAt(data, (nrt_Off) control->mark, buf, size, error))
+        return NRT_FAILURE;
+    control->mark += size;
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(const void*) MappedAdapter_getBuffer(NRT_DATA * data, nrt_Off offset,
+                                             size_t size)
+{
+    MappedIOControl *control = (MappedIOControl *) data;
+
+    if (control->buf == NULL || offset < 0 ||
+        (nrt_Uint64) offset > (nrt_Uint64) control->size ||
+        size > control->size - (size_t) offset)
+        return NULL;
+
+    return control->buf + (size_t) offset;
+}
+
+NRTPRIV(NRT_BOOL) MappedAdapter_write(NRT_DATA * data, const void *buf,
+                                      size_t size, nrt_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)buf;
+    (void)size;
+
+    nrt_Error_init(error, "Mapped IO interface is read-only", NRT_CTXT,
+                   NRT_ERR_WRITING_TO_FILE);
+    return NRT_FAILURE;
+}
+
+NRTPRIV(NRT_BOOL) MappedAdapter_canSeek(NRT_DATA * data, nrt_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)error;
+
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(nrt_Off) MappedAdapter_seek(NRT_DATA * data, nrt_Off offset, int whence,
+                                    nrt_Error * error)
+{
+    MappedIOControl *control = (MappedIOControl *) data;
+    nrt_Off mark;
+
+    if (whence == NRT_SEEK_SET)
+        mark = offset;
+    else if (whence == NRT_SEEK_CUR)
+        mark = (nrt_Off) control->mark + offset;
+    else if (whence == NRT_SEEK_END)
+        mark = (nrt_Off) control->size + offset;
+    else
+    {
+        nrt_Error_init(error, "Invalid/unsupported seek directive", NRT_CTXT,
+                       NRT_ERR_SEEKING_IN_FILE);
+        return -1;
+    }
+
+    if (mark < 0 || (nrt_Uint64) mark > (nrt_Uint64) control->size)
+    {
+        nrt_Error_init(error, "Invalid offset requested - EOF", NRT_CTXT,
+                       NRT_ERR_SEEKING_IN_FILE);
+        return -1;
+    }
+    control->mark = (size_t) mark;
+    return mark;
+}
+
+NRTPRIV(nrt_Off) MappedAdapter_tell(NRT_DATA * data, nrt_Error * error)
+{
+    MappedIOControl *control = (MappedIOControl *) data;
+
+    /* Silence compiler warnings about unused variables */
+    (void)error;
+
+    return (nrt_Off) control->mark;
+}
+
+NRTPRIV(nrt_Off) MappedAdapter_getSize(NRT_DATA * data, nrt_Error * error)
+{
+    MappedIOControl *control = (MappedIOControl *) data;
+
+    /* Silence compiler warnings about unused variables */
+    (void)error;
+
+    return (nrt_Off) control->size;
+}
+
+NRTPRIV(int) MappedAdapter_getMode(NRT_DATA * data, nrt_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)error;
+
+    return NRT_ACCESS_READONLY;
+}
+
+NRTPRIV(NRT_BOOL) MappedAdapter_close(NRT_DATA * data, nrt_Error * error)
+{
+    MappedIOControl *control = (MappedIOControl *) data;
+
+    /* Silence compiler warnings about unused variables */
+    (void)error;
+
+    if (control->buf != NULL)
+    {
+        nrt_IOHandle_unmap(control->buf, control->size);
+        control->buf = NULL;
+    }
+    if (!NRT_INVALID_HANDLE(control->handle))
+    {
+        nrt_IOHandle_close(control->handle);
+        control->handle = NRT_INVALID_HANDLE_VALUE;
+    }
+    control->size = 0;
+    control->mark = 0;
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(void) MappedAdapter_destruct(NRT_DATA * data)
+{
+    nrt_Error error;
+
+    /* The adapter owns the mapping and the file, so release them */
+    if (data)
+        MappedAdapter_close(data, &error);
+}
+
 NRTAPI(nrt_IOInterface *) nrt_IOHandleAdapter_construct(nrt_IOHandle handle,
                                                         int accessMode,
                                                         nrt_Error * error)
@@ -312,7 +567,10 @@ NRTAPI(nrt_IOInterface *) nrt_IOHandleAdapter_construct(nrt_IOHandle handle,
         &IOHandleAdapter_getSize,
         &IOHandleAdapter_getMode,
         &IOHandleAdapter_close,
-        &IOHandleAdapter_destruct
+        &IOHandleAdapter_destruct,
+        &IOHandleAdapter_readAt,
+        NULL,
+        &IOHandleAdapter_writeAt
     };
     nrt_IOInterface *impl = NULL;
     IOHandleControl *control = NULL;
@@ -386,7 +644,9 @@ NRTAPI(nrt_IOInterface *) nrt_BufferAdapter_construct(char *buf, size_t size,
         &BufferAdapter_getSize,
         &BufferAdapter_getMode,
         &BufferAdapter_close,
-        &BufferAdapter_destruct
+        &BufferAdapter_destruct,
+        &BufferAdapter_readAt,
+        &BufferAdapter_getBuffer
     };
     nrt_IOInterface *impl = NULL;
     BufferIOControl *control = NULL;
@@ -424,4 +684,87 @@ NRTAPI(nrt_IOInterface *) nrt_BufferAdapter_construct(char *buf, size_t size,
     }
 }
 
+NRTAPI(nrt_IOInterface *) nrt_MappedAdapter_open(const char *fname,
+                                                 nrt_Error * error)
+{
+    static nrt_IIOInterface mappedInterface = {
+        &MappedAdapter_read,
+        &MappedAdapter_write,
+        &MappedAdapter_canSeek,
+        &MappedAdapter_seek,
+        &MappedAdapter_tell,
+        &MappedAdapter_getSize,
+        &MappedAdapter_getMode,
+        &MappedAdapter_close,
+        &MappedAdapter_destruct,
+        &MappedAdapter_readAt,
+        &MappedAdapter_getBuffer
+    };
+    nrt_IOInterface *impl = NULL;
+    MappedIOControl *control = NULL;
+    nrt_IOHandle handle;
+    nrt_Off size;
+
+    handle = nrt_IOHandle_create(fname, NRT_ACCESS_READONLY,
+                                 NRT_OPEN_EXISTING, error);
+    if (NRT_INVALID_HANDLE(handle))
+        return NULL;
+
+    impl = (nrt_IOInterface *) NRT_MALLOC(sizeof(nrt_IOInterface));
+    if (!impl)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(impl, 0, sizeof(nrt_IOInterface));
+
+    control = (MappedIOControl *) NRT_MALLOC(sizeof(MappedIOControl));
+    if (!control)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(control, 0, sizeof(MappedIOControl));
+    control->handle = handle;
+    impl->data = (NRT_DATA *) control;
+    impl->iface = &mappedInterface;
+
+    size = nrt_IOHandle_getSize(handle, error);
+    if (!NRT_IO_SUCCESS(size))
+        goto CATCH_ERROR;
+    if ((nrt_Uint64) size > (nrt_Uint64) ((size_t) -1))
+    {
+        nrt_Error_initf(error, NRT_CTXT, NRT_ERR_OPENING_FILE,
+                        "File %s is too large to map", fname);
+        goto CATCH_ERROR;
+    }
+
+    /* An empty file cannot be mapped, but it has no data to read either */
+    if (size > 0)
+    {
+        control->buf = (const char *) nrt_IOHandle_map(handle, (size_t) size,
+                                                       error);
+        if (control->buf == NULL)
+            goto CATCH_ERROR;
+    }
+    control->size = (size_t) size;
+    return impl;
+
+    CATCH_ERROR:
+    {
+        /* Once the control is attached, destruction releases the file */
+        if (impl && impl->data)
+            nrt_IOInterface_destruct(&impl);
+        else
+        {
+            nrt_IOHandle_close(handle);
+            if (impl)
+                NRT_FREE(impl);
+        }
+        return NULL;
+    }
+}
+
 NRT_CXX_ENDGUARD
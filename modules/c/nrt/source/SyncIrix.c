@@ -47,6 +47,51 @@ NRTPROT(void) nrt_Mutex_delete(nrt_Mutex * m)
 {
     nrt_Debug_flogf(stdout, "***Destroy Mutex*** [sgi] (empty)\n");
 }
+
+/*
+ *  Threads are not supported, so there is never another thread to wait for
+ */
+NRTPROT(void) nrt_Condition_init(nrt_Condition * c)
+{
+    *c = 0;
+}
+
+NRTPROT(void) nrt_Condition_wait(nrt_Condition * c, nrt_Mutex * m)
+{
+    (void)c;
+    (void)m;
+}
+
+NRTPROT(void) nrt_Condition_broadcast(nrt_Condition * c)
+{
+    (void)c;
+}
+
+NRTPROT(void) nrt_Condition_delete(nrt_Condition * c)
+{
+    (void)c;
+}
+
+NRTPROT(NRT_BOOL) nrt_Thread_create(nrt_Thread * t, NRT_THREAD_RUN run,
+                                    NRT_DATA * data, nrt_Error * error)
+{
+    (void)t;
+    (void)run;
+    (void)data;
+    nrt_Error_init(error, "Threads are not supported", NRT_CTXT,
+                   NRT_ERR_UNK);
+    return NRT_FAILURE;
+}
+
+NRTPROT(void) nrt_Thread_join(nrt_Thread * t)
+{
+    (void)t;
+}
+
+NRTPROT(int) nrt_Thread_getNumCPUs(void)
+{
+    return 1;
+}
 #endif
 
 NRT_CXX_ENDGUARD
@@ -20,6 +20,7 @@
  *
  */
 
+#include <unistd.h>
 #include "nrt/Debug.h"
 #include "nrt/Sync.h"
 
@@ -52,6 +53,51 @@ NRTPROT(void) nrt_Mutex_delete(nrt_Mutex * m)
         nrt_Debug_flogf(stdout, "***Destroyed Mutex***\n");
     }
 }
+
+NRTPROT(void) nrt_Condition_init(nrt_Condition * c)
+{
+    pthread_cond_init(c, NULL);
+}
+
+NRTPROT(void) nrt_Condition_wait(nrt_Condition * c, nrt_Mutex * m)
+{
+    pthread_cond_wait(c, (pthread_mutex_t *) m);
+}
+
+NRTPROT(void) nrt_Condition_broadcast(nrt_Condition * c)
+{
+    pthread_cond_broadcast(c);
+}
+
+NRTPROT(void) nrt_Condition_delete(nrt_Condition * c)
+{
+    if (c)
+        pthread_cond_destroy(c);
+}
+
+NRTPROT(NRT_BOOL) nrt_Thread_create(nrt_Thread * t, NRT_THREAD_RUN run,
+                                    NRT_DATA * data, nrt_Error * error)
+{
+    int status = pthread_create((pthread_t *) t, NULL, run, data);
+    if (status != 0)
+    {
+        nrt_Error_init(error, strerror(status), NRT_CTXT,
+                       NRT_ERR_UNK);
+        return NRT_FAILURE;
+    }
+    return NRT_SUCCESS;
+}
+
+NRTPROT(void) nrt_Thread_join(nrt_Thread * t)
+{
+    pthread_join(*((pthread_t *) t), NULL);
+}
+
+NRTPROT(int) nrt_Thread_getNumCPUs(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (int) count : 1;
+}
 #endif
 
 NRT_CXX_ENDGUARD
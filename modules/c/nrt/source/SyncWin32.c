@@ -62,6 +62,64 @@ NRTPROT(void) nrt_Mutex_delete(nrt_Mutex * m)
         NRT_FREE(lpCriticalSection);
     }
 }
+
+NRTPROT(void) nrt_Condition_init(nrt_Condition * c)
+{
+    InitializeConditionVariable(c);
+}
+
+NRTPROT(void) nrt_Condition_wait(nrt_Condition * c, nrt_Mutex * m)
+{
+    SleepConditionVariableCS(c, (LPCRITICAL_SECTION) (*m), INFINITE);
+}
+
+NRTPROT(void) nrt_Condition_broadcast(nrt_Condition * c)
+{
+    WakeAllConditionVariable(c);
+}
+
+NRTPROT(void) nrt_Condition_delete(nrt_Condition * c)
+{
+    /* Windows condition variables are not destroyed */
+    (void)c;
+}
+
+static DWORD WINAPI nrt_Thread_start(LPVOID arg)
+{
+    nrt_Thread *t = (nrt_Thread *) arg;
+    (*(t->run)) (t->data);
+    return 0;
+}
+
+NRTPROT(NRT_BOOL) nrt_Thread_create(nrt_Thread * t, NRT_THREAD_RUN run,
+                                    NRT_DATA * data, nrt_Error * error)
+{
+    t->run = run;
+    t->data = data;
+    t->handle = CreateThread(NULL, 0, nrt_Thread_start, t, 0, NULL);
+    if (t->handle == NULL)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_UNK);
+        return NRT_FAILURE;
+    }
+    return NRT_SUCCESS;
+}
+
+NRTPROT(void) nrt_Thread_join(nrt_Thread * t)
+{
+    WaitForSingleObject(t->handle, INFINITE);
+    CloseHandle(t->handle);
+    t->handle = NULL;
+}
+
+NRTPROT(int) nrt_Thread_getNumCPUs(void)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (info.dwNumberOfProcessors > 0) ?
+        (int) info.dwNumberOfProcessors : 1;
+}
 #endif
 
 NRT_CXX_ENDGUARD
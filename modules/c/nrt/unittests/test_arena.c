@@ -0,0 +1,83 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ * 
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; if not, If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nrt.h>
+#include "Test.h"
+
+TEST_CASE(testAlloc)
+{
+    nrt_Error e;
+    nrt_Arena *arena = nrt_Arena_construct(64, &e);
+    char *small, *next, *big;
+    int i;
+    TEST_ASSERT(arena);
+
+    small = (char *) nrt_Arena_alloc(arena, 3);
+    next = (char *) nrt_Arena_alloc(arena, 5);
+    TEST_ASSERT(small);
+    TEST_ASSERT(next);
+    TEST_ASSERT_EQ_INT(0, (int) ((size_t) small % 16));
+    TEST_ASSERT_EQ_INT(0, (int) ((size_t) next % 16));
+    TEST_ASSERT(next >= small + 3);
+
+    /* larger than a chunk */
+    big = (char *) nrt_Arena_alloc(arena, 1000);
+    TEST_ASSERT(big);
+    for (i = 0; i < 1000; ++i)
+        big[i] = (char) i;
+    memcpy(small, "abc", 3);
+
+    /* the current chunk is still used after an oversized allocation */
+    TEST_ASSERT(nrt_Arena_alloc(arena, 8) == (void *) (next + 16));
+
+    for (i = 0; i < 100; ++i)
+        TEST_ASSERT(nrt_Arena_alloc(arena, 40));
+    TEST_ASSERT_EQ_INT(0, memcmp(small, "abc", 3));
+    TEST_ASSERT_EQ_INT((char) 999, big[999]);
+
+    nrt_Arena_destruct(&arena);
+    TEST_ASSERT_NULL(arena);
+}
+
+TEST_CASE(testCurrent)
+{
+    nrt_Error e;
+    nrt_Arena *arena = nrt_Arena_construct(0, &e);
+    nrt_Arena *previous = NULL;
+    TEST_ASSERT(arena);
+
+    TEST_ASSERT_NULL(nrt_Arena_getCurrent());
+    previous = nrt_Arena_setCurrent(arena);
+    TEST_ASSERT_NULL(previous);
+    TEST_ASSERT(nrt_Arena_getCurrent() == arena);
+    TEST_ASSERT(nrt_Arena_setCurrent(previous) == arena);
+    TEST_ASSERT_NULL(nrt_Arena_getCurrent());
+
+    nrt_Arena_destruct(&arena);
+}
+
+int main(int argc, char **argv)
+{
+    CHECK(testAlloc);
+    CHECK(testCurrent);
+    return 0;
+}
@@ -28,7 +28,7 @@ Python wrapper for the NITRO library
 ##############################################################################
 import nitropy
 from nitropy import NITF_VER_20, NITF_VER_21, NITF_VER_UNKNOWN
-import logging, types, new
+import logging, types, new, sys
 
 from nitropy import nrt_Error as Error
 Error.__repr__=lambda s: s.message
@@ -37,7 +37,7 @@ __all__ = ['BandInfo', 'BandSource', 'ComponentInfo', 'DESegment', 'DESubheader'
            'DataSource', 'DownSampler', 'Error', 'Extensions', 'Field',
            'FieldHeader', 'FileBandSource', 'FileHeader', 'FileSecurity',
            'FileSegmentSource', 'GraphicSegment', 'GraphicSubheader', 'Header',
-           'IOHandle', 'ImageReader', 'ImageSegment', 'ImageSource',
+           'IOHandle', 'ImageData', 'ImageReader', 'ImageSegment', 'ImageSource',
            'ImageSubheader', 'ImageWriter', 'LabelSegment', 'LabelSubheader',
            'MaxDownSampler', 'MemoryBandSource', 'MemorySegmentSource',
            'NITF_VER_20', 'NITF_VER_21', 'NITF_VER_UNKNOWN',
@@ -191,10 +191,11 @@ class ImageReader:
     
     This is created by calling Reader.newImageReader()
     """
-    def __init__(self, ref, nbpp):
+    def __init__(self, ref, nbpp, pvtype='INT'):
         self.ref = ref
         self.error = Error()
         self.nbpp = nbpp
+        self.pvtype = pvtype
     
     def __del__(self):
         logging.debug('destruct ImageReader')
@@ -207,6 +208,55 @@ class ImageReader:
         if self.error.level:
             raise Exception, self.error.message
         return dataBuf
+    
+    def readArray(self, window, downsampler=None):
+        """
+        Reads all bands of the window at once into an ImageData object.
+        numpy.asarray() of the result is a (bands, rows, cols) array of the
+        image pixel type that shares the data (no copy).
+        """
+        win = nitropy.py_SubWindow_construct(window.startRow, window.startCol, window.numRows, 
+            window.numCols, window.bandList, downsampler, self.error)
+        data = nitropy.py_ImageReader_readData(self.ref, win, self.nbpp, self.error)
+        if self.error.level:
+            raise Exception, self.error.message
+        return ImageData(data, (len(window.bandList), window.numRows, window.numCols),
+                         pixelTypeString(self.pvtype, self.nbpp))
+
+
+def pixelTypeString(pvtype, nbpp):
+    """
+    Returns the NumPy array interface type string (e.g. '<u2') of the
+    pixels read for the given PVTYPE and NBPP
+    """
+    kinds = {'INT' : 'u', 'B' : 'u', 'SI' : 'i', 'R' : 'f', 'C' : 'c'}
+    size = (int(nbpp) - 1) / 8 + 1
+    order = '|'
+    if size > 1:
+        order = sys.byteorder == 'little' and '<' or '>'
+    return '%s%s%d' % (order, kinds[str(pvtype).strip()], size)
+
+
+class ImageData:
+    """
+    Image data read by ImageReader.readArray()
+    
+    The bands are held one after the other in a single buffer. The object
+    exposes the NumPy array interface, so numpy.asarray() makes an array
+    of shape (bands, rows, cols) without copying.
+    """
+    def __init__(self, buffer, shape, typestr):
+        self.buffer = buffer
+        self.shape = shape
+        self.typestr = typestr
+        self.__array_interface__ = {'shape' : shape, 'typestr' : typestr,
+                                    'data' : buffer, 'version' : 3}
+    
+    def __len__(self):
+        return len(self.buffer)
+    
+    def __str__(self):
+        return str(self.buffer)
 
 
 class SegmentReader:
@@ -325,9 +375,10 @@ class Reader:
     
     def newImageReader(self, num, options = None):
         nbpp = int(self.record.getImages()[num]['numBitsPerPixel'])
+        pvtype = str(self.record.getImages()[num]['pixelValueType'])
         reader = nitropy.nitf_Reader_newImageReader(self.ref, num, options, self.error)
         if not reader: raise Exception('Unable to get new ImageReader')
-        return ImageReader(reader, nbpp)
+        return ImageReader(reader, nbpp, pvtype)
 
     def newTextReader(self, num):
         reader = nitropy.nitf_Reader_newTextReader(self.ref, num, self.error)
@@ -1964,6 +1964,7 @@ py_nitf_Reader_newImageReader = _nitropy.py_nitf_Reader_newImageReader
 py_nitf_Writer_newImageWriter = _nitropy.py_nitf_Writer_newImageWriter
 py_nitf_MemorySource_construct = _nitropy.py_nitf_MemorySource_construct
 py_SubWindow_construct = _nitropy.py_SubWindow_construct
+py_ImageReader_readData = _nitropy.py_ImageReader_readData
 py_ImageReader_read = _nitropy.py_ImageReader_read
 py_Pair_getFieldData = _nitropy.py_Pair_getFieldData
 py_TREEnumerator_hasNext = _nitropy.py_TREEnumerator_hasNext
@@ -3291,54 +3291,44 @@ SWIG_From_unsigned_SS_int  (unsigned int value)
     }
     
     /**
-     * Helper function for ImageReader_read ... necessary
+     * Reads all bands of the window with a single multi-band read, into one
+     * buffer holding the bands one after the other. The window dimensions
+     * are in output (down-sampled) pixels. The GIL is released during the
+     * read, so other Python threads can run (other reads included).
      */
-    PyObject* py_ImageReader_read(nitf_ImageReader* reader, nitf_SubWindow* window, int nbpp, nitf_Error* error)
+    PyObject* py_ImageReader_readData(nitf_ImageReader* reader, nitf_SubWindow* window, int nbpp, nitf_Error* error)
     {
-        /* TODO somehow get the NUMBITSPERPIXEL in the future */
         nitf_Uint8 **buf = NULL;
         PyObject* result = NULL;
-        int i, padded, rowSkip, colSkip, subimageSize;
-        nitf_SubWindow* newWindow = nitf_SubWindow_construct(error);
+        void* data = NULL;
+        Py_ssize_t bandSize;
+        nitf_Uint32 i;
+        int padded;
+        NITF_BOOL status;
         
-        rowSkip = window->downsampler ? window->downsampler->rowSkip : 1;
-        colSkip = window->downsampler ? window->downsampler->colSkip : 1;
-        subimageSize = (window->numRows/rowSkip) * (window->numCols/colSkip) * NITF_NBPP_TO_BYTES(nbpp);
+        bandSize = (Py_ssize_t) window->numRows * window->numCols * NITF_NBPP_TO_BYTES(nbpp);
         
-        buf = (nitf_Uint8**) NITF_MALLOC(sizeof(nitf_Uint8*));
+        buf = (nitf_Uint8**) NITF_MALLOC(sizeof(nitf_Uint8*) * (window->numBands + 1));
         if (!buf)
         {
             PyErr_NoMemory();
             goto CATCH_ERROR;
         }
         
-        /* copy the window */
-        newWindow->downsampler = window->downsampler;
-        newWindow->startRow = window->startRow;
-        newWindow->startCol = window->startCol;
-        newWindow->numRows = window->numRows;
-        newWindow->numCols = window->numCols;
-        newWindow->numBands = 1;
-        
-        result = PyList_New(window->numBands);
+        result = PyBuffer_New(bandSize * window->numBands);
+        if (!result) goto CATCH_ERROR;
+        result->ob_type->tp_as_buffer->bf_getwritebuffer(result, 0, &data);
         for (i = 0; i < window->numBands; i++)
+            buf[i] = (nitf_Uint8*) data + i * bandSize;
+        
+        Py_BEGIN_ALLOW_THREADS
+        status = nitf_ImageReader_read(reader, window, buf, &padded, error);
+        Py_END_ALLOW_THREADS
+        if (!status)
         {
-            PyObject* buffObj = PyBuffer_New(subimageSize * sizeof(nitf_Uint8));
-            if (!buffObj) goto CATCH_ERROR;
-            buffObj->ob_type->tp_as_buffer->bf_getwritebuffer(buffObj, 0, (void **)&buf[0]);
-            
-            newWindow->bandList = &window->bandList[i];
-            if (!nitf_ImageReader_read(reader, newWindow, buf, &padded, error))
-            {
-                nitf_Error_print(error, stderr, "Read failed");
-                goto CATCH_ERROR;
-            }
-            PyList_SetItem(result, i, buffObj);
+            PyErr_SetString(PyExc_RuntimeError, error->message);
+            goto CATCH_ERROR;
         }
-        /* destroy temp window */
-        newWindow->bandList = NULL;
-        newWindow->downsampler = NULL;
-        nitf_SubWindow_destruct(&newWindow);
         
         NITF_FREE(buf);
         return result;
@@ -3349,6 +3339,35 @@ SWIG_From_unsigned_SS_int  (unsigned int value)
         return NULL;
     }
     
+    /**
+     * Helper function for ImageReader_read ... necessary
+     *
+     * Returns a list with a buffer for each band. The bands are read
+     * together (see py_ImageReader_readData) and each buffer is a view of
+     * its part of the data.
+     */
+    PyObject* py_ImageReader_read(nitf_ImageReader* reader, nitf_SubWindow* window, int nbpp, nitf_Error* error)
+    {
+        PyObject* data = NULL;
+        PyObject* result = NULL;
+        Py_ssize_t bandSize;
+        nitf_Uint32 i;
+        
+        data = py_ImageReader_readData(reader, window, nbpp, error);
+        if (!data) return NULL;
+        bandSize = (Py_ssize_t) window->numRows * window->numCols * NITF_NBPP_TO_BYTES(nbpp);
+        
+        result = PyList_New(window->numBands);
+        for (i = 0; result && i < window->numBands; i++)
+        {
+            PyObject* buffObj = PyBuffer_FromReadWriteObject(data, i * bandSize, bandSize);
+            if (!buffObj) Py_CLEAR(result);
+            else PyList_SET_ITEM(result, i, buffObj);
+        }
+        Py_DECREF(data);
+        return result;
+    }
+    
     
     nitf_Field* py_Pair_getFieldData(nitf_Pair* pair)
     {
@@ -30391,6 +30410,55 @@ fail:
 }
 
 
+SWIGINTERN PyObject *_wrap_py_ImageReader_readData(PyObject *SWIGUNUSEDPARM(self), PyObject *args) {
+  PyObject *resultobj = 0;
+  nitf_ImageReader *arg1 = (nitf_ImageReader *) 0 ;
+  nitf_SubWindow *arg2 = (nitf_SubWindow *) 0 ;
+  int arg3 ;
+  nitf_Error *arg4 = (nitf_Error *) 0 ;
+  void *argp1 = 0 ;
+  int res1 = 0 ;
+  void *argp2 = 0 ;
+  int res2 = 0 ;
+  int val3 ;
+  int ecode3 = 0 ;
+  void *argp4 = 0 ;
+  int res4 = 0 ;
+  PyObject * obj0 = 0 ;
+  PyObject * obj1 = 0 ;
+  PyObject * obj2 = 0 ;
+  PyObject * obj3 = 0 ;
+  PyObject *result = 0 ;
+  
+  if (!PyArg_ParseTuple(args,(char *)"OOOO:py_ImageReader_readData",&obj0,&obj1,&obj2,&obj3)) SWIG_fail;
+  res1 = SWIG_ConvertPtr(obj0, &argp1,SWIGTYPE_p__nitf_ImageReader, 0 |  0 );
+  if (!SWIG_IsOK(res1)) {
+    SWIG_exception_fail(SWIG_ArgError(res1), "in method '" "py_ImageReader_readData" "', argument " "1"" of type '" "nitf_ImageReader *""'"); 
+  }
+  arg1 = (nitf_ImageReader *)(argp1);
+  res2 = SWIG_ConvertPtr(obj1, &argp2,SWIGTYPE_p__nitf_SubWindow, 0 |  0 );
+  if (!SWIG_IsOK(res2)) {
+    SWIG_exception_fail(SWIG_ArgError(res2), "in method '" "py_ImageReader_readData" "', argument " "2"" of type '" "nitf_SubWindow *""'"); 
+  }
+  arg2 = (nitf_SubWindow *)(argp2);
+  ecode3 = SWIG_AsVal_int(obj2, &val3);
+  if (!SWIG_IsOK(ecode3)) {
+    SWIG_exception_fail(SWIG_ArgError(ecode3), "in method '" "py_ImageReader_readData" "', argument " "3"" of type '" "int""'");
+  } 
+  arg3 = (int)(val3);
+  res4 = SWIG_ConvertPtr(obj3, &argp4,SWIGTYPE_p__NRT_Error, 0 |  0 );
+  if (!SWIG_IsOK(res4)) {
+    SWIG_exception_fail(SWIG_ArgError(res4), "in method '" "py_ImageReader_readData" "', argument " "4"" of type '" "nitf_Error *""'"); 
+  }
+  arg4 = (nitf_Error *)(argp4);
+  result = (PyObject *)py_ImageReader_readData(arg1,arg2,arg3,arg4);
+  resultobj = result;
+  return resultobj;
+fail:
+  return NULL;
+}
+
+
 SWIGINTERN PyObject *_wrap_py_ImageReader_read(PyObject *SWIGUNUSEDPARM(self), PyObject *args) {
   PyObject *resultobj = 0;
   nitf_ImageReader *arg1 = (nitf_ImageReader *) 0 ;
@@ -31599,6 +31667,7 @@ static PyMethodDef SwigMethods[] = {
 	 { (char *)"py_nitf_Writer_newImageWriter", _wrap_py_nitf_Writer_newImageWriter, METH_VARARGS, NULL},
 	 { (char *)"py_nitf_MemorySource_construct", _wrap_py_nitf_MemorySource_construct, METH_VARARGS, NULL},
 	 { (char *)"py_SubWindow_construct", _wrap_py_SubWindow_construct, METH_VARARGS, NULL},
+	 { (char *)"py_ImageReader_readData", _wrap_py_ImageReader_readData, METH_VARARGS, NULL},
 	 { (char *)"py_ImageReader_read", _wrap_py_ImageReader_read, METH_VARARGS, NULL},
 	 { (char *)"py_Pair_getFieldData", _wrap_py_Pair_getFieldData, METH_VARARGS, NULL},
 	 { (char *)"py_TREEnumerator_hasNext", _wrap_py_TREEnumerator_hasNext, METH_VARARGS, NULL},
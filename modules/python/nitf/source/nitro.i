@@ -542,54 +542,44 @@
     }
     
     /**
-     * Helper function for ImageReader_read ... necessary
+     * Reads all bands of the window with a single multi-band read, into one
+     * buffer holding the bands one after the other. The window dimensions
+     * are in output (down-sampled) pixels. The GIL is released during the
+     * read, so other Python threads can run (other reads included).
      */
-    PyObject* py_ImageReader_read(nitf_ImageReader* reader, nitf_SubWindow* window, int nbpp, nitf_Error* error)
+    PyObject* py_ImageReader_readData(nitf_ImageReader* reader, nitf_SubWindow* window, int nbpp, nitf_Error* error)
     {
-        /* TODO somehow get the NUMBITSPERPIXEL in the future */
         nitf_Uint8 **buf = NULL;
         PyObject* result = NULL;
-        int i, padded, rowSkip, colSkip, subimageSize;
-        nitf_SubWindow* newWindow = nitf_SubWindow_construct(error);
+        void* data = NULL;
+        Py_ssize_t bandSize;
+        nitf_Uint32 i;
+        int padded;
+        NITF_BOOL status;
         
-        rowSkip = window->downsampler ? window->downsampler->rowSkip : 1;
-        colSkip = window->downsampler ? window->downsampler->colSkip : 1;
-        subimageSize = (window->numRows/rowSkip) * (window->numCols/colSkip) * NITF_NBPP_TO_BYTES(nbpp);
+        bandSize = (Py_ssize_t) window->numRows * window->numCols * NITF_NBPP_TO_BYTES(nbpp);
         
-        buf = (nitf_Uint8**) NITF_MALLOC(sizeof(nitf_Uint8*));
+        buf = (nitf_Uint8**) NITF_MALLOC(sizeof(nitf_Uint8*) * (window->numBands + 1));
         if (!buf)
         {
             PyErr_NoMemory();
             goto CATCH_ERROR;
         }
         
-        /* copy the window */
-        newWindow->downsampler = window->downsampler;
-        newWindow->startRow = window->startRow;
-        newWindow->startCol = window->startCol;
-        newWindow->numRows = window->numRows;
-        newWindow->numCols = window->numCols;
-        newWindow->numBands = 1;
-        
-        result = PyList_New(window->numBands);
+        result = PyBuffer_New(bandSize * window->numBands);
+        if (!result) goto CATCH_ERROR;
+        result->ob_type->tp_as_buffer->bf_getwritebuffer(result, 0, &data);
         for (i = 0; i < window->numBands; i++)
+            buf[i] = (nitf_Uint8*) data + i * bandSize;
+        
+        Py_BEGIN_ALLOW_THREADS
+        status = nitf_ImageReader_read(reader, window, buf, &padded, error);
+        Py_END_ALLOW_THREADS
+        if (!status)
         {
-            PyObject* buffObj = PyBuffer_New(subimageSize * sizeof(nitf_Uint8));
-            if (!buffObj) goto CATCH_ERROR;
-            buffObj->ob_type->tp_as_buffer->bf_getwritebuffer(buffObj, 0, (void **)&buf[0]);
-            
-            newWindow->bandList = &window->bandList[i];
-            if (!nitf_ImageReader_read(reader, newWindow, buf, &padded, error))
-            {
-                nitf_Error_print(error, stderr, "Read failed");
-                goto CATCH_ERROR;
-            }
-            PyList_SetItem(result, i, buffObj);
+            PyErr_SetString(PyExc_RuntimeError, error->message);
+            goto CATCH_ERROR;
         }
-        /* destroy temp window */
-        newWindow->bandList = NULL;
-        newWindow->downsampler = NULL;
-        nitf_SubWindow_destruct(&newWindow);
         
         NITF_FREE(buf);
         return result;
@@ -600,6 +590,35 @@
         return NULL;
     }
     
+    /**
+     * Helper function for ImageReader_read ... necessary
+     *
+     * Returns a list with a buffer for each band. The bands are read
+     * together (see py_ImageReader_readData) and each buffer is a view of
+     * its part of the data.
+     */
+    PyObject* py_ImageReader_read(nitf_ImageReader* reader, nitf_SubWindow* window, int nbpp, nitf_Error* error)
+    {
+        PyObject* data = NULL;
+        PyObject* result = NULL;
+        Py_ssize_t bandSize;
+        nitf_Uint32 i;
+        
+        data = py_ImageReader_readData(reader, window, nbpp, error);
+        if (!data) return NULL;
+        bandSize = (Py_ssize_t) window->numRows * window->numCols * NITF_NBPP_TO_BYTES(nbpp);
+        
+        result = PyList_New(window->numBands);
+        for (i = 0; result && i < window->numBands; i++)
+        {
+            PyObject* buffObj = PyBuffer_FromReadWriteObject(data, i * bandSize, bandSize);
+            if (!buffObj) Py_CLEAR(result);
+            else PyList_SET_ITEM(result, i, buffObj);
+        }
+        Py_DECREF(data);
+        return result;
+    }
+    
     
     nitf_Field* py_Pair_getFieldData(nitf_Pair* pair)
     {